@@ -31,11 +31,111 @@
 namespace bd
 {
 
+namespace
+{
+
+/**
+ *  @brief A cell receiver which writes the cells while they are read
+ *
+ *  After a cell has been written, its content is discarded. Hence the layout
+ *  will only hold the cells currently being read.
+ */
+class StreamingCellReceiver
+  : public db::ReaderCellReceiver
+{
+public:
+  StreamingCellReceiver (const bd::GenericWriterOptions &writer_options, const std::string &format, tl::OutputStream &stream)
+    : mp_writer_options (&writer_options), m_format (format), mp_writer (0), mp_stream (&stream)
+  {
+    //  .. nothing yet ..
+  }
+
+  ~StreamingCellReceiver ()
+  {
+    delete mp_writer;
+    mp_writer = 0;
+  }
+
+  virtual void cell_read (db::Layout &layout, db::cell_index_type cell_index)
+  {
+    start (layout);
+    mp_writer->write_cell_streaming (cell_index);
+
+    //  the content is no longer needed
+    db::Cell &cell = layout.cell (cell_index);
+    cell.clear_shapes ();
+    cell.clear_insts ();
+  }
+
+  void finish (db::Layout &layout)
+  {
+    start (layout);
+    mp_writer->end_cell_streaming ();
+  }
+
+private:
+  const bd::GenericWriterOptions *mp_writer_options;
+  std::string m_format;
+  db::Writer *mp_writer;
+  tl::OutputStream *mp_stream;
+
+  void start (db::Layout &layout)
+  {
+    //  NOTE: streaming is started with the first cell as the header (specifically the
+    //  database unit) has been read then. The writer options are configured only now
+    //  as some of them (e.g. the scaling) depend on the database unit of the input.
+    if (! mp_writer) {
+
+      db::SaveLayoutOptions save_options;
+      mp_writer_options->configure (save_options, layout);
+      save_options.set_format (m_format);
+
+      mp_writer = new db::Writer (save_options);
+      mp_writer->begin_cell_streaming (layout, *mp_stream);
+
+    }
+  }
+};
+
+}
+
+static bool
+convert_streaming (const std::string &infile, const std::string &outfile, const std::string &format, const bd::GenericReaderOptions &generic_reader_options, const bd::GenericWriterOptions &generic_writer_options)
+{
+  db::Layout layout;
+
+  db::LoadLayoutOptions load_options;
+  generic_reader_options.configure (load_options);
+
+  tl::InputStream in_stream (infile, generic_reader_options.map_files ());
+  db::Reader reader (in_stream);
+
+  //  the final writer is created when the header has been read - this one is used for checking the capabilities only
+  db::SaveLayoutOptions probe_options;
+  probe_options.set_format (format);
+  db::Writer probe_writer (probe_options);
+  if (! reader.supports_cell_receiver () || ! probe_writer.supports_cell_streaming ()) {
+    return false;
+  }
+
+  tl::OutputStream out_stream (outfile);
+  StreamingCellReceiver receiver (generic_writer_options, format, out_stream);
+
+  reader.set_cell_receiver (&receiver);
+  reader.read (layout, load_options);
+  reader.set_cell_receiver (0);
+
+  receiver.finish (layout);
+
+  return true;
+}
+
 int converter_main (int argc, char *argv[], const std::string &format)
 {
   bd::GenericWriterOptions generic_writer_options;
   bd::GenericReaderOptions generic_reader_options;
   std::string infile, outfile;
+  bool streaming = false;
 
   tl::CommandLineOptions cmd;
   generic_writer_options.add_options (cmd, format);
@@ -45,12 +145,25 @@ int converter_main (int argc, char *argv[], const std::string &format)
                   "You can use '+' to supply multiple files which will be read after each other into the same layout. "
                   "This provides some cheap, but risky way of merging files. Beware of cell name conflicts.")
       << tl::arg ("output", &outfile, tl::sprintf ("The output file (%s format)", format))
+      << tl::arg ("#--streaming", &streaming, "Converts the layout cell by cell",
+                  "With this option, the cells are written while the input is read and their content is "
+                  "discarded afterwards. This reduces the memory footprint for large layouts. This mode "
+                  "requires a reader and writer supporting it (currently GDS2 to OASIS). It is not available "
+                  "with multiple input files, cell selection or --drop-empty-cells. If streaming is not possible, "
+                  "the normal conversion is used."
+                 )
     ;
 
   cmd.brief (tl::sprintf ("This program will convert the given file to a %s file", format));
 
   cmd.parse (argc, argv);
 
+  if (streaming && generic_writer_options.supports_cell_streaming () && tl::split (infile, "+").size () == 1) {
+    if (convert_streaming (infile, outfile, format, generic_reader_options, generic_writer_options)) {
+      return 0;
+    }
+  }
+
   db::Layout layout;
 
   {
@@ -60,7 +173,7 @@ int converter_main (int argc, char *argv[], const std::string &format)
     std::vector<std::string> files = tl::split (infile, "+");
 
     for (std::vector<std::string>::const_iterator f = files.begin (); f != files.end (); ++f) {
-      tl::InputStream stream (*f);
+      tl::InputStream stream (*f, generic_reader_options.map_files ());
       db::Reader reader (stream);
       reader.read (layout, load_options);
     }
@@ -29,7 +29,7 @@ namespace bd
 
 GenericReaderOptions::GenericReaderOptions ()
   : m_prefix ("i"), m_group_prefix ("Input"), m_layer_map (), m_create_other_layers (true),
-    m_dbu (0.001), m_keep_layer_names (false)
+    m_dbu (0.001), m_keep_layer_names (false), m_map_files (false)
 {
   //  initialize from the default settings
 
@@ -44,6 +44,7 @@ GenericReaderOptions::GenericReaderOptions ()
 
   m_oasis_read_all_properties = load_options.get_option_by_name ("oasis_read_all_properties").to_bool ();
   m_oasis_expect_strict_mode = (load_options.get_option_by_name ("oasis_expect_strict_mode").to_int () > 0);
+  m_oasis_read_threads = load_options.get_option_by_name ("oasis_read_threads").to_int ();
 
   m_create_other_layers = load_options.get_option_by_name ("cif_create_other_layers").to_bool ();
   m_cif_wire_mode = load_options.get_option_by_name ("cif_wire_mode").to_uint ();
@@ -161,6 +162,13 @@ GenericReaderOptions::add_options (tl::CommandLineOptions &cmd)
                     "* A:1/0 B:2/0\n"
                     "  Maps named layer A to 1/0 and named layer B to 2/0"
                    )
+        << tl::arg (group +
+                    "#--" + m_long_prefix + "mmap", &m_map_files, "Maps uncompressed input files into memory",
+                    "With this option, uncompressed local files are mapped into memory and the GDS2 and OASIS "
+                    "readers take the data from there without copying it. The operating system can share the "
+                    "mapped data between concurrent processes reading the same file. The input file must not be "
+                    "truncated or rewritten while it is read - this will terminate the program."
+                   )
       ;
   }
 
@@ -216,6 +224,12 @@ GenericReaderOptions::add_options (tl::CommandLineOptions &cmd)
                     "(mode is 0). By default, both modes are allowed. This is a diagnostic feature and does not "
                     "have any other effect than checking the mode."
                    )
+        << tl::arg (group +
+                    "--" + m_long_prefix + "read-threads=threads", &m_oasis_read_threads, "Specifies the number of threads for decompressing CBLOCKs",
+                    "If this value is larger than 0, compressed blocks (CBLOCKs) are inflated in the background by "
+                    "the given number of threads while the reader builds the layout. By default (value 0), "
+                    "CBLOCKs are decompressed by the reader itself."
+                   )
       ;
   }
 
@@ -634,6 +648,7 @@ GenericReaderOptions::configure (db::LoadLayoutOptions &load_options) const
 
   load_options.set_option_by_name ("oasis_read_all_properties", m_oasis_read_all_properties);
   load_options.set_option_by_name ("oasis_expect_strict_mode", m_oasis_expect_strict_mode ? 1 : 0);
+  load_options.set_option_by_name ("oasis_read_threads", m_oasis_read_threads);
 
   load_options.set_option_by_name ("cif_layer_map", tl::Variant::make_variant (m_layer_map));
   load_options.set_option_by_name ("cif_create_other_layers", m_create_other_layers);
@@ -63,6 +63,15 @@ public:
    */
   void configure (db::LoadLayoutOptions &load_options) const;
 
+  /**
+   *  @brief Gets a value indicating whether input files shall be mapped into memory
+   *  This value is intended for the "map_file" argument of the tl::InputStream constructor.
+   */
+  bool map_files () const
+  {
+    return m_map_files;
+  }
+
   /**
    *  @brief Sets the option prefix for the short option name
    *  By default, the prefix is set to "i", so the short options are
@@ -101,6 +110,7 @@ private:
   bool m_create_other_layers;
   double m_dbu;
   bool m_keep_layer_names;
+  bool m_map_files;
 
   //  common GDS2+OASIS
   bool m_common_enable_text_objects;
@@ -114,6 +124,7 @@ private:
   //  OASIS
   bool m_oasis_read_all_properties;
   int m_oasis_expect_strict_mode;
+  int m_oasis_read_threads;
 
   //  CIF
   unsigned int m_cif_wire_mode;
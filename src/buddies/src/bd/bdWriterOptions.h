@@ -98,6 +98,16 @@ public:
    */
   void configure (db::SaveLayoutOptions &save_options, const db::Layout &layout) const;
 
+  /**
+   *  @brief Returns true, if the options allow writing the layout cell by cell
+   *  Cell selection and dropping of empty cells require the full layout, hence
+   *  cell-by-cell streaming is not possible with these options.
+   */
+  bool supports_cell_streaming () const
+  {
+    return m_cell_selection.empty () && ! m_dont_write_empty_cells;
+  }
+
   static const std::string gds2_format_name;
   static const std::string gds2text_format_name;
   static const std::string oasis_format_name;
@@ -130,6 +140,7 @@ private:
   bool m_oasis_permissive;
   int m_oasis_write_std_properties;
   std::string m_oasis_subst_char;
+  int m_oasis_write_threads;
 
   bool m_cif_dummy_calls;
   bool m_cif_blank_separator;
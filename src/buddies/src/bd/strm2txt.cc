@@ -48,7 +48,7 @@ BD_PUBLIC int strm2txt (int argc, char *argv[])
     db::LoadLayoutOptions load_options;
     generic_reader_options.configure (load_options);
 
-    tl::InputStream stream (infile);
+    tl::InputStream stream (infile, generic_reader_options.map_files ());
     db::Reader reader (stream);
     reader.read (layout, load_options);
   }
@@ -72,7 +72,7 @@ void clip (const ClipData &data)
     db::LoadLayoutOptions load_options;
     data.reader_options.configure (load_options);
 
-    tl::InputStream stream (data.file_in);
+    tl::InputStream stream (data.file_in, data.reader_options.map_files ());
     db::Reader reader (stream);
     reader.read (layout, load_options);
   }
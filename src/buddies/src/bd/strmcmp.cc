@@ -143,7 +143,7 @@ BD_PUBLIC int strmcmp (int argc, char *argv[])
     db::LoadLayoutOptions load_options;
     generic_reader_options_a.configure (load_options);
 
-    tl::InputStream stream (infile_a);
+    tl::InputStream stream (infile_a, generic_reader_options_a.map_files ());
     db::Reader reader (stream);
     reader.read (layout_a, load_options);
   }
@@ -152,7 +152,7 @@ BD_PUBLIC int strmcmp (int argc, char *argv[])
     db::LoadLayoutOptions load_options;
     generic_reader_options_b.configure (load_options);
 
-    tl::InputStream stream (infile_b);
+    tl::InputStream stream (infile_b, generic_reader_options_b.map_files ());
     db::Reader reader (stream);
     reader.read (layout_b, load_options);
   }
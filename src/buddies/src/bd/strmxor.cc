@@ -27,7 +27,9 @@
 #include "dbWriter.h"
 #include "dbSaveLayoutOptions.h"
 #include "dbRegion.h"
+#include "dbEdgeProcessor.h"
 #include "dbDeepShapeStore.h"
+#include "dbDeepXOR.h"
 #include "gsiExpression.h"
 #include "tlCommandLineParser.h"
 
@@ -125,7 +127,7 @@ struct XORData
     : layout_a (0), layout_b (0), cell_a (0), cell_b (0),
       tolerance_bump (0),
       dont_summarize_missing_layers (false), silent (false), no_summary (false),
-      threads (0),
+      skip_identical (false), threads (0),
       tile_size (0.0), output_layout (0), output_cell (0)
   { }
 
@@ -136,6 +138,7 @@ struct XORData
   bool dont_summarize_missing_layers;
   bool silent;
   bool no_summary;
+  bool skip_identical;
   int threads;
   double tile_size;
   db::Layout *output_layout;
@@ -144,6 +147,27 @@ struct XORData
   std::map<std::pair<int, db::LayerProperties>, ResultDescriptor> *results;
 };
 
+/**
+ *  @brief Sets the default number of scanline threads of db::EdgeProcessor for the lifetime of this object
+ */
+class EdgeProcessorThreadsSetter
+{
+public:
+  EdgeProcessorThreadsSetter (unsigned int threads)
+    : m_threads_saved (db::EdgeProcessor::default_threads ())
+  {
+    db::EdgeProcessor::set_default_threads (threads);
+  }
+
+  ~EdgeProcessorThreadsSetter ()
+  {
+    db::EdgeProcessor::set_default_threads (m_threads_saved);
+  }
+
+private:
+  unsigned int m_threads_saved;
+};
+
 static bool run_tiled_xor (const XORData &xor_data);
 static bool run_deep_xor (const XORData &xor_data);
 
@@ -167,6 +191,7 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
   bool silent = false;
   bool no_summary = false;
   bool deep = false;
+  bool skip_identical = false;
   std::vector<double> tolerances;
   int tolerance_bump = 10000;
   int threads = 1;
@@ -194,6 +219,12 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
                   "Enables hierarchical XOR (experimental). In this mode, tiling is not supported "
                   "and the tiling arguments are ignored."
                  )
+      << tl::arg ("-k|--skip-identical",       &skip_identical, "Skips identical cells and placements (deep mode only)",
+                  "With this option, the hierarchies of both layouts are merged before the XOR is computed. "
+                  "Cells are paired by name and shapes or placements present in both layouts are "
+                  "only considered where they interact with differences. This option is effective in deep mode only "
+                  "and requires both layouts to have the same database unit."
+                 )
       << tl::arg ("-s|--silent",               &silent,     "Silent mode",
                   "In silent mode, no summary is printed, but the exit code indicates whether "
                   "the layouts are the same (0) or differences exist (> 0)."
@@ -212,7 +243,7 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
                  )
       << tl::arg ("-n|--threads=threads",      &threads,   "Specifies the number of threads to use",
                   "If given, multiple threads are used for the XOR computation. This way, multiple cores can "
-                  "be utilized."
+                  "be utilized. Without tiling, the threads are used inside the XOR computation of each layer."
                  )
       << tl::arg ("-p|--tiles=size",           &tile_size, "Specifies tiling mode",
                   "In tiling mode, the layout is divided into tiles of the given size. Each tile is computed "
@@ -251,7 +282,7 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
     db::LoadLayoutOptions load_options;
     generic_reader_options_a.configure (load_options);
 
-    tl::InputStream stream (infile_a);
+    tl::InputStream stream (infile_a, generic_reader_options_a.map_files ());
     db::Reader reader (stream);
     reader.read (layout_a, load_options);
   }
@@ -260,7 +291,7 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
     db::LoadLayoutOptions load_options;
     generic_reader_options_b.configure (load_options);
 
-    tl::InputStream stream (infile_b);
+    tl::InputStream stream (infile_b, generic_reader_options_b.map_files ());
     db::Reader reader (stream);
     reader.read (layout_b, load_options);
   }
@@ -328,6 +359,7 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
   xor_data.dont_summarize_missing_layers = dont_summarize_missing_layers;
   xor_data.silent = silent;
   xor_data.no_summary = no_summary;
+  xor_data.skip_identical = skip_identical;
   xor_data.threads = threads;
   xor_data.tile_size = tile_size;
   xor_data.output_layout = output_layout.get ();
@@ -414,13 +446,22 @@ bool run_tiled_xor (const XORData &xor_data)
   db::TilingProcessor proc;
   proc.set_dbu (std::min (xor_data.layout_a->dbu (), xor_data.layout_b->dbu ()));
   proc.set_threads (std::max (1, xor_data.threads));
+
+  //  without tiles, there is a single task only - use the threads for the scanline sweep instead
+  unsigned int ep_threads = db::EdgeProcessor::default_threads ();
   if (xor_data.tile_size > db::epsilon) {
     if (tl::verbosity () >= 20) {
       tl::log << "Tile size: " << xor_data.tile_size;
     }
     proc.tile_size (xor_data.tile_size, xor_data.tile_size);
+  } else if (xor_data.threads > 1) {
+    ep_threads = (unsigned int) xor_data.threads;
   }
 
+  //  the edge processors are created inside the tiling processor's scripts, so the setting
+  //  is passed as the default and restored on exit
+  EdgeProcessorThreadsSetter ep_threads_setter (ep_threads);
+
   proc.tile_border (xor_data.tolerances.back () * 2.0, xor_data.tolerances.back () * 2.0);
   if (tl::verbosity () >= 20) {
     tl::log << "Tile border: " << xor_data.tolerances.back () * 2.0;
@@ -562,6 +603,13 @@ bool run_deep_xor (const XORData &xor_data)
     xor_data.output_layout->dbu (dbu);
   }
 
+  db::DeepXOR xor_engine (&dss, xor_data.layout_a, xor_data.cell_a, xor_data.layout_b, xor_data.cell_b, dbu);
+  xor_engine.set_skip_identical (xor_data.skip_identical);
+
+  if (xor_data.skip_identical && fabs (xor_data.layout_a->dbu () - xor_data.layout_b->dbu ()) > db::epsilon) {
+    tl::warn << "Database units of the layouts differ - identical cells cannot be skipped";
+  }
+
   bool result = true;
 
   int index = 1;
@@ -593,21 +641,7 @@ bool run_deep_xor (const XORData &xor_data)
 
     } else {
 
-      db::RecursiveShapeIterator ri_a, ri_b;
-
-      if (ll->second.first >= 0) {
-        ri_a = db::RecursiveShapeIterator (*xor_data.layout_a, xor_data.layout_a->cell (xor_data.cell_a), ll->second.first);
-      }
-
-      if (ll->second.second >= 0) {
-        ri_b = db::RecursiveShapeIterator (*xor_data.layout_b, xor_data.layout_b->cell (xor_data.cell_b), ll->second.second);
-      }
-
-      db::Region in_a (ri_a, dss, db::ICplxTrans (xor_data.layout_a->dbu () / dbu));
-      db::Region in_b (ri_b, dss, db::ICplxTrans (xor_data.layout_b->dbu () / dbu));
-
-      db::Region xor_res;
-      xor_res = in_a ^ in_b;
+      db::Region xor_res = xor_engine.compute (db::BooleanOp::Xor, ll->second.first, ll->second.second);
 
       int tol_index = 0;
       for (std::vector<double>::const_iterator t = xor_data.tolerances.begin (); t != xor_data.tolerances.end (); ++t) {
@@ -63,7 +63,8 @@ TEST(1)
                    "-ot",
                    "--recompress",
                    "--subst-char=XY",
-                   "--write-std-properties=2"
+                   "--write-std-properties=2",
+                   "--write-threads=4"
                  };
 
   cmd.parse (sizeof (argv) / sizeof (argv[0]), const_cast<char **> (argv));
@@ -91,6 +92,7 @@ TEST(1)
   EXPECT_EQ (stream_opt.get_option_by_name ("oasis_recompress").to_bool (), false);
   EXPECT_EQ (stream_opt.get_option_by_name ("oasis_substitution_char").to_string (), "*");
   EXPECT_EQ (stream_opt.get_option_by_name ("oasis_write_std_properties_ext").to_int (), 1);
+  EXPECT_EQ (stream_opt.get_option_by_name ("oasis_write_threads").to_int (), 0);
 
   opt.configure (stream_opt, layout);
 
@@ -116,6 +118,7 @@ TEST(1)
   EXPECT_EQ (stream_opt.get_option_by_name ("oasis_recompress").to_bool (), true);
   EXPECT_EQ (stream_opt.get_option_by_name ("oasis_substitution_char").to_string (), "X");
   EXPECT_EQ (stream_opt.get_option_by_name ("oasis_write_std_properties_ext").to_int (), 2);
+  EXPECT_EQ (stream_opt.get_option_by_name ("oasis_write_threads").to_int (), 4);
 }
 
 static std::string cells2string (const db::Layout &layout, const std::set<db::cell_index_type> &cells)
@@ -236,7 +239,8 @@ TEST(10)
                          "-im=1/0 3,4/0-255 A:17/0",
                          "-is",
                          //  OASIS
-                         "--expect-strict-mode=1"
+                         "--expect-strict-mode=1",
+                         "--read-threads=4"
                        };
 
   cmd.parse (sizeof (argv) / sizeof (argv[0]), (char **) argv);
@@ -264,6 +268,7 @@ TEST(10)
   EXPECT_EQ (stream_opt.get_option_by_name ("gds2_allow_big_records").to_bool (), true);
   EXPECT_EQ (stream_opt.get_option_by_name ("gds2_allow_multi_xy_records").to_bool (), true);
   EXPECT_EQ (stream_opt.get_option_by_name ("oasis_expect_strict_mode").to_int (), -1);
+  EXPECT_EQ (stream_opt.get_option_by_name ("oasis_read_threads").to_int (), 0);
 
   opt.configure (stream_opt);
 
@@ -289,5 +294,6 @@ TEST(10)
   EXPECT_EQ (stream_opt.get_option_by_name ("gds2_allow_big_records").to_bool (), false);
   EXPECT_EQ (stream_opt.get_option_by_name ("gds2_allow_multi_xy_records").to_bool (), false);
   EXPECT_EQ (stream_opt.get_option_by_name ("oasis_expect_strict_mode").to_int (), 1);
+  EXPECT_EQ (stream_opt.get_option_by_name ("oasis_read_threads").to_int (), 4);
 }
 
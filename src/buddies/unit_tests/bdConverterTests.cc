@@ -186,3 +186,109 @@ TEST(6)
 
   db::compare_layouts (this, layout, input_au, db::WriteGDS2);
 }
+
+//  Testing the converter main implementation (OASIS, cell-by-cell streaming)
+TEST(7)
+{
+  std::string input = tl::testsrc ();
+  input += "/testdata/gds/t10.gds";
+
+  std::string output = this->tmp_file ();
+
+  const char *argv[] = { "x", input.c_str (), output.c_str (), "--streaming" };
+
+  EXPECT_EQ (bd::converter_main (sizeof (argv) / sizeof (argv[0]), (char **) argv, bd::GenericWriterOptions::oasis_format_name), 0);
+
+  db::Layout layout;
+
+  {
+    tl::InputStream stream (output);
+    db::LoadLayoutOptions options;
+    db::Reader reader (stream);
+    reader.read (layout, options);
+    EXPECT_EQ (reader.format (), "OASIS");
+  }
+
+  db::compare_layouts (this, layout, input, db::NoNormalization);
+}
+
+//  Testing the converter main implementation (OASIS, cell-by-cell streaming, strict mode and CBLOCKs)
+TEST(8)
+{
+  std::string input = tl::testsrc ();
+  input += "/testdata/gds/t10.gds";
+
+  std::string output = this->tmp_file ();
+
+  const char *argv[] = { "x", input.c_str (), output.c_str (), "--streaming", "--strict-mode", "--cblocks", "--write-threads=2" };
+
+  EXPECT_EQ (bd::converter_main (sizeof (argv) / sizeof (argv[0]), (char **) argv, bd::GenericWriterOptions::oasis_format_name), 0);
+
+  db::Layout layout;
+
+  {
+    tl::InputStream stream (output);
+    db::LoadLayoutOptions options;
+    db::Reader reader (stream);
+    reader.read (layout, options);
+    EXPECT_EQ (reader.format (), "OASIS");
+  }
+
+  db::compare_layouts (this, layout, input, db::NoNormalization);
+}
+
+//  Testing the converter main implementation (OASIS, cell-by-cell streaming with scaling and output DBU)
+TEST(9)
+{
+  std::string input = tl::testsrc ();
+  input += "/testdata/gds/t10.gds";
+
+  std::string output = this->tmp_file ("streaming.oas");
+  std::string output_au = this->tmp_file ("non_streaming.oas");
+
+  const char *argv[] = { "x", input.c_str (), output.c_str (), "--streaming", "--scale-factor=2", "--dbu-out=0.0005" };
+  EXPECT_EQ (bd::converter_main (sizeof (argv) / sizeof (argv[0]), (char **) argv, bd::GenericWriterOptions::oasis_format_name), 0);
+
+  const char *argv_au[] = { "x", input.c_str (), output_au.c_str (), "--scale-factor=2", "--dbu-out=0.0005" };
+  EXPECT_EQ (bd::converter_main (sizeof (argv_au) / sizeof (argv_au[0]), (char **) argv_au, bd::GenericWriterOptions::oasis_format_name), 0);
+
+  db::Layout layout;
+
+  {
+    tl::InputStream stream (output);
+    db::LoadLayoutOptions options;
+    db::Reader reader (stream);
+    reader.read (layout, options);
+    EXPECT_EQ (reader.format (), "OASIS");
+  }
+
+  EXPECT_EQ (tl::to_string (layout.dbu ()), "0.0005");
+
+  db::compare_layouts (this, layout, output_au, db::NoNormalization);
+}
+
+//  Testing the converter main implementation (OASIS, memory-mapped input)
+TEST(10)
+{
+  std::string input = tl::testsrc ();
+  input += "/testdata/gds/t10.gds";
+
+  std::string output = this->tmp_file ();
+
+  const char *argv[] = { "x", input.c_str (), output.c_str (), "--mmap" };
+
+  EXPECT_EQ (bd::converter_main (sizeof (argv) / sizeof (argv[0]), (char **) argv, bd::GenericWriterOptions::oasis_format_name), 0);
+
+  db::Layout layout;
+
+  {
+    tl::InputStream stream (output, true);
+    EXPECT_EQ (stream.is_direct (), true);
+    db::LoadLayoutOptions options;
+    db::Reader reader (stream);
+    reader.read (layout, options);
+    EXPECT_EQ (reader.format (), "OASIS");
+  }
+
+  db::compare_layouts (this, layout, input, db::NoNormalization);
+}
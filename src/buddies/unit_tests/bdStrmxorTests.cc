@@ -22,6 +22,9 @@
 
 #include "bdCommon.h"
 #include "dbReader.h"
+#include "dbRegion.h"
+#include "dbRecursiveShapeIterator.h"
+#include "dbEdgeProcessor.h"
 #include "dbTestSupport.h"
 #include "tlLog.h"
 #include "tlUnitTest.h"
@@ -624,3 +627,105 @@ TEST(6_Deep)
     "Layer 10/0 is not present in first layout, but in second\n"
   );
 }
+
+TEST(7_DeepSkipIdentical)
+{
+  tl::CaptureChannel cap;
+
+  std::string input_a = tl::testsrc ();
+  input_a += "/testdata/bd/strmxor_in1.gds";
+
+  std::string input_b = tl::testsrc ();
+  input_b += "/testdata/bd/strmxor_in1.gds";
+
+  const char *argv[] = { "x", "-u", "-k", input_a.c_str (), input_b.c_str () };
+
+  EXPECT_EQ (strmxor (sizeof (argv) / sizeof (argv[0]), (char **) argv), 0);
+
+  EXPECT_EQ (cap.captured_text (),
+    "No differences found\n"
+  );
+}
+
+TEST(8_DeepSkipIdenticalDifferentDBU)
+{
+  tl::CaptureChannel cap;
+
+  std::string input_a = tl::testsrc ();
+  input_a += "/testdata/bd/strmxor_in1.gds";
+
+  std::string input_b = tl::testsrc ();
+  input_b += "/testdata/bd/strmxor_in2.gds";
+
+  std::string au = tl::testsrc ();
+  au += "/testdata/bd/strmxor_au1d.oas";
+
+  std::string output = this->tmp_file ("tmp.oas");
+
+  const char *argv[] = { "x", "-u", "-k", "--no-summary", input_a.c_str (), input_b.c_str (), output.c_str () };
+
+  EXPECT_EQ (strmxor (sizeof (argv) / sizeof (argv[0]), (char **) argv), 1);
+
+  db::Layout layout, layout_au;
+
+  {
+    tl::InputStream stream (output);
+    db::Reader reader (stream);
+    reader.read (layout);
+  }
+
+  {
+    tl::InputStream stream (au);
+    db::Reader reader (stream);
+    reader.read (layout_au);
+  }
+
+  //  skipping identical cells is not possible with different database units - the result is the same as without "-k"
+
+  db::cell_index_type top = *layout.begin_top_down ();
+  db::cell_index_type top_au = *layout_au.begin_top_down ();
+
+  for (db::Layout::layer_iterator l = layout_au.begin_layers (); l != layout_au.end_layers (); ++l) {
+
+    db::Region r_au (db::RecursiveShapeIterator (layout_au, layout_au.cell (top_au), (*l).first));
+
+    db::Region r;
+    for (db::Layout::layer_iterator ll = layout.begin_layers (); ll != layout.end_layers (); ++ll) {
+      if ((*ll).second->log_equal (*(*l).second)) {
+        r = db::Region (db::RecursiveShapeIterator (layout, layout.cell (top), (*ll).first));
+      }
+    }
+
+    EXPECT_EQ ((r ^ r_au).to_string (), "");
+
+  }
+
+  EXPECT_EQ (cap.captured_text (),
+    "Database units of the layouts differ - identical cells cannot be skipped\n"
+    "Layer 10/0 is not present in first layout, but in second\n"
+  );
+}
+
+TEST(9_FlatThreadsWithoutTiles)
+{
+  tl::CaptureChannel cap;
+
+  std::string input_a = tl::testsrc ();
+  input_a += "/testdata/bd/strmxor_in1.gds";
+
+  std::string input_b = tl::testsrc ();
+  input_b += "/testdata/bd/strmxor_in1.gds";
+
+  const char *argv[] = { "x", "-n=4", input_a.c_str (), input_b.c_str () };
+
+  unsigned int ep_threads = db::EdgeProcessor::default_threads ();
+
+  EXPECT_EQ (strmxor (sizeof (argv) / sizeof (argv[0]), (char **) argv), 0);
+
+  //  the scanline threads used without tiles must not leak into later edge processors
+  EXPECT_EQ (db::EdgeProcessor::default_threads (), ep_threads);
+
+  EXPECT_EQ (cap.captured_text (),
+    "No differences found\n"
+  );
+}
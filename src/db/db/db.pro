@@ -54,6 +54,7 @@ SOURCES = \
   dbPCellVariant.cc \
   dbPoint.cc \
   dbPolygon.cc \
+  dbPolygonArrays.cc \
   dbPolygonTools.cc \
   dbPolygonGenerators.cc \
   dbPropertiesRepository.cc \
@@ -106,6 +107,7 @@ SOURCES = \
   gsiDeclDbPath.cc \
   gsiDeclDbPoint.cc \
   gsiDeclDbPolygon.cc \
+  gsiDeclDbPolygonArrays.cc \
   gsiDeclDbReader.cc \
   gsiDeclDbRecursiveShapeIterator.cc \
   gsiDeclDbRegion.cc \
@@ -197,7 +199,8 @@ SOURCES = \
     dbNetShape.cc \
     dbShapeCollection.cc \
     gsiDeclDbShapeCollection.cc \
-    dbShapeCollectionUtils.cc
+    dbShapeCollectionUtils.cc \
+    dbDeepXOR.cc
 
 HEADERS = \
   dbArray.h \
@@ -253,6 +256,7 @@ HEADERS = \
   dbPCellVariant.h \
   dbPoint.h \
   dbPolygon.h \
+  dbPolygonArrays.h \
   dbPolygonTools.h \
   dbPolygonGenerators.h \
   dbPropertiesRepository.h \
@@ -355,7 +359,8 @@ HEADERS = \
     dbOriginalLayerTexts.h \
     dbNetShape.h \
     dbShapeCollection.h \
-    dbShapeCollectionUtils.h
+    dbShapeCollectionUtils.h \
+    dbDeepXOR.h
 
 !equals(HAVE_QT, "0") {
 
@@ -29,7 +29,10 @@
 #include "dbBox.h"
 #include "dbMemStatistics.h"
 
+#include "atomic/atomic.h"
+
 #include <limits>
+#include <new>
 #include <vector>
 
 namespace db
@@ -156,6 +159,142 @@ private:
   tl::vector<box_type> m_boxes;
 };
 
+class box_tree_sort_scheduler;
+
+/**
+ *  @brief A task sorting a subtree of a box tree
+ *
+ *  Tasks are created by the box tree's sort method and handed over to a
+ *  box_tree_sort_scheduler. The scheduler is responsible for running and
+ *  deleting the task.
+ */
+class box_tree_sort_task
+{
+public:
+  virtual ~box_tree_sort_task () { }
+
+  /**
+   *  @brief Sorts the subtree
+   *
+   *  Large parts of the subtree are scheduled as new tasks on the given scheduler.
+   */
+  virtual void run (box_tree_sort_scheduler *scheduler) = 0;
+};
+
+/**
+ *  @brief An interface for sorting box trees on multiple threads
+ *
+ *  When a scheduler is passed to the sort method of a box tree, subtrees with more
+ *  than "fork_size" elements are not sorted in place but handed over to the scheduler
+ *  as tasks. These tasks can be executed in parallel as they work on different
+ *  parts of the tree. Tasks may schedule further tasks.
+ *
+ *  The sort method will return before the tasks are executed. The tree must not be
+ *  used before all tasks have been executed.
+ */
+class box_tree_sort_scheduler
+{
+public:
+  virtual ~box_tree_sort_scheduler () { }
+
+  /**
+   *  @brief Schedules a task
+   *
+   *  The scheduler takes over the task.
+   */
+  virtual void schedule (box_tree_sort_task *task) = 0;
+
+  /**
+   *  @brief Gets the minimum number of elements for a subtree to be sorted in a separate task
+   */
+  virtual size_t fork_size () const
+  {
+    return 10000;
+  }
+};
+
+/// @brief a helper class sharing the picker between the sort tasks of one tree
+///
+/// When the last task has released the context, the sorting of the tree is complete
+/// and the tree's nodes are packed.
+
+template <class Tree, class Picker>
+class box_tree_sort_context
+{
+public:
+  template <class A>
+  box_tree_sort_context (Tree *tree, const A &a)
+    : mp_tree (tree), m_picker (a), m_ref_count (1)
+  { }
+
+  template <class A, class B, class C>
+  box_tree_sort_context (Tree *tree, const A &a, const B &b, const C &c)
+    : mp_tree (tree), m_picker (a, b, c), m_ref_count (1)
+  { }
+
+  Picker &picker ()
+  {
+    return m_picker;
+  }
+
+  void add_ref ()
+  {
+    ++m_ref_count;
+  }
+
+  void release ()
+  {
+    if (--m_ref_count == 0) {
+      mp_tree->pack_nodes ();
+      delete this;
+    }
+  }
+
+private:
+  Tree *mp_tree;
+  Picker m_picker;
+  atomic::atomic<int> m_ref_count;
+
+  box_tree_sort_context (const box_tree_sort_context &);
+  box_tree_sort_context &operator= (const box_tree_sort_context &);
+};
+
+/// @brief the task implementation for sorting a subtree of Tree
+
+template <class Tree, class Picker>
+class box_tree_sort_task_impl
+  : public box_tree_sort_task
+{
+public:
+  typedef typename Tree::box_type box_type;
+  typedef typename Tree::box_tree_node box_tree_node;
+  typedef typename Tree::sort_iterator sort_iterator;
+
+  box_tree_sort_task_impl (Tree *tree, box_tree_node *parent, sort_iterator from, sort_iterator to, box_tree_sort_context<Tree, Picker> *context, const box_type &bbox, int quad)
+    : mp_tree (tree), mp_parent (parent), m_from (from), m_to (to), mp_context (context), m_bbox (bbox), m_quad (quad)
+  {
+    mp_context->add_ref ();
+  }
+
+  ~box_tree_sort_task_impl ()
+  {
+    mp_context->release ();
+  }
+
+  virtual void run (box_tree_sort_scheduler *scheduler)
+  {
+    mp_tree->tree_sort (mp_parent, m_from, m_to, mp_context->picker (), m_bbox, m_quad, scheduler, mp_context);
+  }
+
+private:
+  Tree *mp_tree;
+  box_tree_node *mp_parent;
+  sort_iterator m_from, m_to;
+  box_tree_sort_context<Tree, Picker> *mp_context;
+  box_type m_bbox;
+  int m_quad;
+};
+
 /**
  *  @brief The node object
  */
@@ -194,20 +333,72 @@ public:
     }
   }
 
-  box_tree_node *clone (box_tree_node *parent = 0, unsigned int quad = 0) const
-  {
-    box_tree_node *n = new box_tree_node (parent, m_center, m_corner, quad);
-    n->m_lenq = m_lenq;
-    n->m_len = m_len;
-    for (unsigned int i = 0; i < 4; ++i) {
-      box_tree_node *c = child (i);
-      if (c) {
-        c->clone (n, i);
-      } else {
-        n->m_childrefs [i] = m_childrefs [i];
+  /**
+   *  @brief Creates a packed copy of the subtree starting at this node
+   *
+   *  The nodes of the packed copy are stored in a single memory block in
+   *  breadth-first order. Queries through the packed tree visit neighbouring
+   *  nodes in neighbouring memory locations. The packed tree needs to be released
+   *  with "destroy".
+   */
+  box_tree_node *pack () const
+  {
+    std::vector<const box_tree_node *> nodes;
+    nodes.push_back (this);
+    for (size_t i = 0; i < nodes.size (); ++i) {
+      for (int q = 0; q < 4; ++q) {
+        const box_tree_node *c = nodes [i]->child (q);
+        if (c) {
+          nodes.push_back (c);
+        }
+      }
+    }
+
+    box_tree_node *block = static_cast<box_tree_node *> (::operator new (sizeof (box_tree_node) * nodes.size ()));
+
+    for (size_t i = 0; i < nodes.size (); ++i) {
+      new (block + i) box_tree_node (*nodes [i], i == 0);
+    }
+
+    //  the children of node i appear in breadth-first order, so the next child always is at "next"
+    size_t next = 1;
+    for (size_t i = 0; i < nodes.size (); ++i) {
+      box_tree_node *n = block + i;
+      for (int q = 0; q < 4; ++q) {
+        if (nodes [i]->child (q)) {
+          n->m_childrefs [q] = size_t (block + next);
+          block [next].mp_parent = (box_tree_node *)((char *) n + q);
+          ++next;
+        }
       }
     }
-    return n;
+
+    return block;
+  }
+
+  /**
+   *  @brief Returns true, if this node is the root of a packed tree
+   */
+  bool is_packed () const
+  {
+    return mp_parent == packed_root_tag ();
+  }
+
+  /**
+   *  @brief Deletes the tree given by the root node
+   *
+   *  This method deletes both packed and individually allocated trees.
+   */
+  static void destroy (box_tree_node *root)
+  {
+    if (! root) {
+      //  .. nothing to do ..
+    } else if (root->is_packed ()) {
+      //  the nodes do not own resources, so it's sufficient to release the memory block
+      ::operator delete (root);
+    } else {
+      delete root;
+    }
   }
 
   box_tree_node *child (int i) const
@@ -299,6 +490,20 @@ private:
   box_tree_node (const box_tree_node &d);
   box_tree_node &operator= (const box_tree_node &d);
 
+  static box_tree_node *packed_root_tag ()
+  {
+    return reinterpret_cast<box_tree_node *> (size_t (1));
+  }
+
+  //  used by "pack": copies the node without the links to parent and children
+  box_tree_node (const box_tree_node &d, bool root)
+    : mp_parent (root ? packed_root_tag () : 0), m_lenq (d.m_lenq), m_len (d.m_len), m_center (d.m_center), m_corner (d.m_corner)
+  {
+    for (int i = 0; i < 4; ++i) {
+      m_childrefs [i] = d.m_childrefs [i];
+    }
+  }
+
   box_tree_node (box_tree_node *parent, const point_type &center, const point_type &corner, unsigned int quad)
   {
     init (parent, center, corner, quad);
@@ -733,6 +938,7 @@ public:
   typedef size_type element;
   typedef tl::vector<element> element_vector_type;
   typedef typename element_vector_type::iterator element_iterator;
+  typedef element_iterator sort_iterator;
   typedef box_tree<box_type, object_type, box_conv_type, min_bin, min_quads> box_tree_type;
   typedef db::box_tree_node<box_tree_type> box_tree_node;
   typedef box_tree_sel<box_type, object_type, box_conv_type, db::boxes_overlap<box_type> > box_tree_sel_overlap_type;
@@ -755,7 +961,7 @@ public:
    *  @brief Copy constructor
    */
   box_tree (const box_tree &b)
-    : m_objects (b.m_objects), m_elements (b.m_elements), mp_root (b.mp_root ? b.mp_root->clone () : 0)
+    : m_objects (b.m_objects), m_elements (b.m_elements), mp_root (b.mp_root ? b.mp_root->pack () : 0)
   {
     // .. nothing else ..
   }
@@ -769,7 +975,7 @@ public:
     m_objects = b.m_objects;
     m_elements = b.m_elements;
     if (b.mp_root) {
-      mp_root = b.mp_root->clone ();
+      mp_root = b.mp_root->pack ();
     }
     return *this;
   }
@@ -779,9 +985,7 @@ public:
    */
   ~box_tree ()
   {
-    if (mp_root) {
-      delete mp_root;
-    }
+    box_tree_node::destroy (mp_root);
     mp_root = 0;
   }
 
@@ -929,9 +1133,7 @@ public:
   {
     m_objects.clear ();
     m_elements.clear ();
-    if (mp_root) {
-      delete mp_root;
-    }
+    box_tree_node::destroy (mp_root);
     mp_root = 0;
   }
 
@@ -956,11 +1158,15 @@ public:
    *
    *  Only after sorting the query iterators are available.
    *  Sorting complexity is approx O(N*log(N)).
+   *
+   *  If a scheduler is given, large subtrees are sorted in separate tasks
+   *  delivered to the scheduler. In this case, the tree is sorted only after
+   *  all these tasks have been executed. See box_tree_sort_scheduler for details.
    */
-  void sort (const BoxConv &conv)
+  void sort (const BoxConv &conv, box_tree_sort_scheduler *scheduler = 0)
   {
     typename BoxConv::complexity complexity_tag;
-    sort (conv, complexity_tag);
+    sort (conv, complexity_tag, scheduler);
   }
 
   /**
@@ -1158,20 +1364,16 @@ private:
   box_tree_node *mp_root;
 
   /// Sort implementation for simple bboxes - no caching
-  void sort (const BoxConv &conv, const db::simple_bbox_tag &/*complexity*/)
+  void sort (const BoxConv &conv, const db::simple_bbox_tag &/*complexity*/, box_tree_sort_scheduler *scheduler)
   {
     m_elements.clear ();
     m_elements.reserve (m_objects.size ());
 
-    if (mp_root) {
-      delete mp_root;
-    }
+    box_tree_node::destroy (mp_root);
     mp_root = 0;
 
     if (! m_objects.empty ()) {
 
-      box_tree_picker_type picker (conv);
-
       box_type bbox;
       for (typename obj_vector_type::const_iterator o = m_objects.begin (); o != m_objects.end (); ++o) {
         box_type b = conv (*o);
@@ -1181,25 +1383,31 @@ private:
 
       //  TODO: resize m_elements to actual size ?
 
-      tree_sort (0, m_elements.begin (), m_elements.end (), picker, bbox, 0);
+      if (scheduler) {
+        box_tree_sort_context<box_tree, box_tree_picker_type> *context = new box_tree_sort_context<box_tree, box_tree_picker_type> (this, conv);
+        tree_sort (0, m_elements.begin (), m_elements.end (), context->picker (), bbox, 0, scheduler, context);
+        context->release ();
+      } else {
+        box_tree_picker_type picker (conv);
+        tree_sort (0, m_elements.begin (), m_elements.end (), picker, bbox, 0);
+        pack_nodes ();
+      }
 
     }
   }
 
   /// Sort implementation for complex bboxes - with caching
-  void sort (const box_conv_type &conv, const db::complex_bbox_tag &/*complexity*/)
+  void sort (const box_conv_type &conv, const db::complex_bbox_tag &/*complexity*/, box_tree_sort_scheduler *scheduler)
   {
     m_elements.clear ();
     m_elements.reserve (m_objects.size ());
 
-    if (mp_root) {
-      delete mp_root;
-    }
+    box_tree_node::destroy (mp_root);
     mp_root = 0;
 
     if (! m_objects.empty ()) {
 
-      box_tree_cached_picker<object_type, box_type, box_conv_type, obj_vector_type> picker (conv, m_objects.begin (), m_objects.end ());
+      typedef box_tree_cached_picker<object_type, box_type, box_conv_type, obj_vector_type> picker_type;
 
       for (typename obj_vector_type::const_iterator o = m_objects.begin (); o != m_objects.end (); ++o) {
         m_elements.push_back (o.index ());
@@ -1207,13 +1415,34 @@ private:
 
       //  TODO: resize m_elements to actual size ?
 
-      tree_sort (0, m_elements.begin (), m_elements.end (), picker, picker.bbox (), 0);
+      if (scheduler) {
+        box_tree_sort_context<box_tree, picker_type> *context = new box_tree_sort_context<box_tree, picker_type> (this, conv, m_objects.begin (), m_objects.end ());
+        tree_sort (0, m_elements.begin (), m_elements.end (), context->picker (), context->picker ().bbox (), 0, scheduler, context);
+        context->release ();
+      } else {
+        picker_type picker (conv, m_objects.begin (), m_objects.end ());
+        tree_sort (0, m_elements.begin (), m_elements.end (), picker, picker.bbox (), 0);
+        pack_nodes ();
+      }
 
     }
   }
 
+  template <class Tree, class Picker> friend class box_tree_sort_task_impl;
+  template <class Tree, class Picker> friend class box_tree_sort_context;
+
+  /// Replaces the nodes of the sorted tree by a packed copy
+  void pack_nodes ()
+  {
+    if (mp_root && ! mp_root->is_packed ()) {
+      box_tree_node *packed = mp_root->pack ();
+      box_tree_node::destroy (mp_root);
+      mp_root = packed;
+    }
+  }
+
   template <class CoordPicker>
-  void tree_sort (box_tree_node *parent, element_iterator from, element_iterator to, const CoordPicker &picker, const box_type &bbox, int quad)
+  void tree_sort (box_tree_node *parent, element_iterator from, element_iterator to, const CoordPicker &picker, const box_type &bbox, int quad, box_tree_sort_scheduler *scheduler = 0, box_tree_sort_context<box_tree, CoordPicker> *context = 0)
   {
     size_t ntot = size_t (to - from);
     if (ntot <= min_bin || (bbox.width () < 2 && bbox.height () < 2)) {
@@ -1297,7 +1526,11 @@ private:
       for (unsigned int q = 0; q < 4; ++q) {
         if (n[q] > 0) {
           node->lenq (q, n[q]);
-          tree_sort (node, qloc[q], qloc[q + 1], picker, qboxes [q], int (q));
+          if (scheduler && n[q] >= scheduler->fork_size ()) {
+            scheduler->schedule (new box_tree_sort_task_impl<box_tree, CoordPicker> (this, node, qloc[q], qloc[q + 1], context, qboxes [q], int (q)));
+          } else {
+            tree_sort (node, qloc[q], qloc[q + 1], picker, qboxes [q], int (q), scheduler, context);
+          }
         }
       }
 
@@ -1689,6 +1922,7 @@ public:
   typedef db::point<coord_type> point_type;
   typedef tl::vector<object_type> obj_vector_type;
   typedef typename obj_vector_type::iterator obj_iterator;
+  typedef obj_iterator sort_iterator;
   typedef size_t size_type;
   typedef typename obj_vector_type::const_iterator const_iterator;
   typedef typename obj_vector_type::iterator iterator;
@@ -1714,7 +1948,7 @@ public:
    *  @brief Copy constructor
    */
   unstable_box_tree (const unstable_box_tree &b)
-    : m_objects (b.m_objects), mp_root (b.mp_root ? b.mp_root->clone () : 0)
+    : m_objects (b.m_objects), mp_root (b.mp_root ? b.mp_root->pack () : 0)
   {
     // .. nothing else ..
   }
@@ -1727,7 +1961,7 @@ public:
     clear ();
     m_objects = b.m_objects;
     if (b.mp_root) {
-      mp_root = b.mp_root->clone ();
+      mp_root = b.mp_root->pack ();
     }
     return *this;
   }
@@ -1737,9 +1971,7 @@ public:
    */
   ~unstable_box_tree ()
   {
-    if (mp_root) {
-      delete mp_root;
-    }
+    box_tree_node::destroy (mp_root);
     mp_root = 0;
   }
 
@@ -1928,9 +2160,7 @@ public:
   void clear ()
   {
     m_objects.clear ();
-    if (mp_root) {
-      delete mp_root;
-    }
+    box_tree_node::destroy (mp_root);
     mp_root = 0;
   }
 
@@ -1939,11 +2169,15 @@ public:
    *
    *  Only after sorting the query iterators are available.
    *  Sorting complexity is approx O(N*log(N)).
+   *
+   *  If a scheduler is given, large subtrees are sorted in separate tasks
+   *  delivered to the scheduler. In this case, the tree is sorted only after
+   *  all these tasks have been executed. See box_tree_sort_scheduler for details.
    */
-  void sort (const BoxConv &conv)
+  void sort (const BoxConv &conv, box_tree_sort_scheduler *scheduler = 0)
   {
     typename BoxConv::complexity complexity_tag;
-    sort (conv, complexity_tag);
+    sort (conv, complexity_tag, scheduler);
   }
 
   /**
@@ -2093,17 +2327,13 @@ private:
   box_tree_node *mp_root;
 
   /// Sort implementation for simple bboxes - no caching
-  void sort (const BoxConv &conv, const db::simple_bbox_tag &/*complexity*/)
+  void sort (const BoxConv &conv, const db::simple_bbox_tag &/*complexity*/, box_tree_sort_scheduler *scheduler)
   {
     if (m_objects.empty ()) {
       return;
     }
 
-    box_tree_picker_type picker (conv);
-
-    if (mp_root) {
-      delete mp_root;
-    }
+    box_tree_node::destroy (mp_root);
     mp_root = 0;
 
     box_type bbox;
@@ -2114,28 +2344,55 @@ private:
       }
     }
 
-    tree_sort (0, m_objects.begin (), m_objects.end (), picker, bbox, 0);
+    if (scheduler) {
+      box_tree_sort_context<unstable_box_tree, box_tree_picker_type> *context = new box_tree_sort_context<unstable_box_tree, box_tree_picker_type> (this, conv);
+      tree_sort (0, m_objects.begin (), m_objects.end (), context->picker (), bbox, 0, scheduler, context);
+      context->release ();
+    } else {
+      box_tree_picker_type picker (conv);
+      tree_sort (0, m_objects.begin (), m_objects.end (), picker, bbox, 0);
+      pack_nodes ();
+    }
   }
 
   /// Sort implementation for complex bboxes - with caching
-  void sort (const box_conv_type &conv, const db::complex_bbox_tag &/*complexity*/)
+  void sort (const box_conv_type &conv, const db::complex_bbox_tag &/*complexity*/, box_tree_sort_scheduler *scheduler)
   {
     if (m_objects.empty ()) {
       return;
     }
 
-    box_tree_cached_picker<object_type, box_type, box_conv_type, obj_vector_type> picker (conv, m_objects.begin (), m_objects.end ());
+    typedef box_tree_cached_picker<object_type, box_type, box_conv_type, obj_vector_type> picker_type;
 
-    if (mp_root) {
-      delete mp_root;
-    }
+    box_tree_node::destroy (mp_root);
     mp_root = 0;
 
-    tree_sort (0, m_objects.begin (), m_objects.end (), picker, picker.bbox (), 0);
+    if (scheduler) {
+      box_tree_sort_context<unstable_box_tree, picker_type> *context = new box_tree_sort_context<unstable_box_tree, picker_type> (this, conv, m_objects.begin (), m_objects.end ());
+      tree_sort (0, m_objects.begin (), m_objects.end (), context->picker (), context->picker ().bbox (), 0, scheduler, context);
+      context->release ();
+    } else {
+      picker_type picker (conv, m_objects.begin (), m_objects.end ());
+      tree_sort (0, m_objects.begin (), m_objects.end (), picker, picker.bbox (), 0);
+      pack_nodes ();
+    }
+  }
+
+  template <class Tree, class Picker> friend class box_tree_sort_task_impl;
+  template <class Tree, class Picker> friend class box_tree_sort_context;
+
+  /// Replaces the nodes of the sorted tree by a packed copy
+  void pack_nodes ()
+  {
+    if (mp_root && ! mp_root->is_packed ()) {
+      box_tree_node *packed = mp_root->pack ();
+      box_tree_node::destroy (mp_root);
+      mp_root = packed;
+    }
   }
 
   template <class CoordPicker>
-  void tree_sort (box_tree_node *parent, obj_iterator from, obj_iterator to, CoordPicker &picker, const box_type &bbox, int quad)
+  void tree_sort (box_tree_node *parent, obj_iterator from, obj_iterator to, CoordPicker &picker, const box_type &bbox, int quad, box_tree_sort_scheduler *scheduler = 0, box_tree_sort_context<unstable_box_tree, CoordPicker> *context = 0)
   {
     size_t ntot = size_t (to - from);
     if (ntot <= min_bin || (bbox.width () < 2 && bbox.height () < 2)) {
@@ -2224,7 +2481,11 @@ private:
       for (unsigned int q = 0; q < 4; ++q) {
         if (n[q] > 0) {
           node->lenq (q, n[q]);
-          tree_sort (node, qloc[q], qloc[q + 1], picker, qboxes [q], int (q));
+          if (scheduler && n[q] >= scheduler->fork_size ()) {
+            scheduler->schedule (new box_tree_sort_task_impl<unstable_box_tree, CoordPicker> (this, node, qloc[q], qloc[q + 1], context, qboxes [q], int (q)));
+          } else {
+            tree_sort (node, qloc[q], qloc[q + 1], picker, qboxes [q], int (q), scheduler, context);
+          }
         }
       }
 
@@ -31,6 +31,7 @@
 #include "dbCellMapping.h"
 
 #include <limits>
+#include <algorithm>
 
 namespace db
 {
@@ -92,7 +93,7 @@ Cell::box_type Cell::ms_empty_box = Cell::box_type ();
 
 Cell::Cell (cell_index_type ci, db::Layout &l) 
   : db::Object (l.manager ()), 
-    m_cell_index (ci), mp_layout (&l), m_instances (this), m_prop_id (0), m_hier_levels (0), m_bbox_needs_update (false), m_ghost_cell (false), 
+    m_cell_index (ci), mp_layout (&l), m_instances (this), m_prop_id (0), m_hier_levels (0), m_bbox_needs_update (false), m_ghost_cell (false), m_shapes_deferred (false),
     mp_last (0), mp_next (0)
 {
   //  .. nothing yet 
@@ -102,7 +103,7 @@ Cell::Cell (const Cell &d)
   : db::Object (d), 
     gsi::ObjectBase (),
     mp_layout (d.mp_layout), m_instances (this), m_prop_id (d.m_prop_id), m_hier_levels (d.m_hier_levels),
-    mp_last (0), mp_next (0)
+    m_shapes_deferred (false), mp_last (0), mp_next (0)
 {
   m_cell_index = d.m_cell_index;
   operator= (d);
@@ -118,6 +119,9 @@ Cell::operator= (const Cell &d)
 
     invalidate_hier ();
 
+    //  a copy does not have a loader, so the source's shapes are loaded now
+    d.load_deferred_shapes ();
+
     clear_shapes_no_invalidate ();
     for (shapes_map::const_iterator s = d.m_shapes_map.begin (); s != d.m_shapes_map.end (); ++s) {
       shapes (s->first) = s->second;
@@ -151,13 +155,22 @@ Cell::clone (db::Layout &layout) const
 unsigned int
 Cell::layers () const
 {
-  if (m_shapes_map.empty ()) {
-    return 0;
-  } else {
+  unsigned int n = 0;
+  if (! m_shapes_map.empty ()) {
     shapes_map::const_iterator s = m_shapes_map.end ();
     --s;
-    return s->first + 1;
+    n = s->first + 1;
+  }
+
+  //  include the layers of the shapes not loaded yet
+  if (m_shapes_deferred && mp_layout->deferred_cell_loader ()) {
+    const box_map *deferred_bboxes = mp_layout->deferred_cell_loader ()->deferred_bboxes (cell_index ());
+    if (deferred_bboxes && ! deferred_bboxes->empty ()) {
+      n = std::max (n, deferred_bboxes->rbegin ()->first + 1);
+    }
   }
+
+  return n;
 }
 
 bool
@@ -167,6 +180,8 @@ Cell::empty () const
     return false;
   }
 
+  load_deferred_shapes ();
+
   for (shapes_map::const_iterator s = m_shapes_map.begin (); s != m_shapes_map.end (); ++s) {
     if (! s->second.empty ()) {
       return false;
@@ -179,6 +194,8 @@ Cell::empty () const
 void 
 Cell::clear (unsigned int index)
 {
+  load_deferred_shapes ();
+
   shapes_map::iterator s = m_shapes_map.find(index);
   if (s != m_shapes_map.end() && ! s->second.empty ()) {
     mp_layout->invalidate_bboxes (index);  //  HINT: must come before the change is done!
@@ -190,6 +207,8 @@ Cell::clear (unsigned int index)
 Cell::shapes_type &
 Cell::shapes (unsigned int index) 
 {
+  load_deferred_shapes ();
+
   shapes_map::iterator s = m_shapes_map.find(index);
   if (s == m_shapes_map.end()) {
     s = m_shapes_map.insert (std::make_pair(index, shapes_type (0, this, mp_layout ? mp_layout->is_editable () : true))).first;
@@ -201,6 +220,8 @@ Cell::shapes (unsigned int index)
 const Cell::shapes_type &
 Cell::shapes (unsigned int index) const
 {
+  load_deferred_shapes ();
+
   shapes_map::const_iterator s = m_shapes_map.find(index);
   if (s != m_shapes_map.end()) {
     return s->second;
@@ -226,6 +247,63 @@ Cell::index_of_shapes (const Cell::shapes_type *shapes) const
   return std::numeric_limits<unsigned int>::max ();
 }
 
+void
+Cell::set_deferred_shapes (bool d)
+{
+  if (d != m_shapes_deferred) {
+    mp_layout->invalidate_bboxes (std::numeric_limits<unsigned int>::max ());  //  HINT: must come before the change is done!
+    m_shapes_deferred = d;
+    m_bbox_needs_update = true;
+  }
+}
+
+void
+Cell::load_deferred_shapes () const
+{
+  if (m_shapes_deferred && mp_layout) {
+    mp_layout->load_deferred_cell (m_cell_index);
+  }
+}
+
+void
+Cell::begin_load_deferred_shapes (const box_map &bboxes)
+{
+  //  NOTE: the shapes containers are created in "dirty" state and without a manager: this way,
+  //  inserting the shapes neither invalidates the layout's bounding boxes (the bounding boxes
+  //  already include the deferred shapes) nor creates undo entries. This allows loading the
+  //  shapes while other threads are reading the layout.
+  for (box_map::const_iterator b = bboxes.begin (); b != bboxes.end (); ++b) {
+    shapes_map::iterator s = m_shapes_map.find (b->first);
+    if (s == m_shapes_map.end ()) {
+      s = m_shapes_map.insert (std::make_pair (b->first, shapes_type (0, this, mp_layout ? mp_layout->is_editable () : true))).first;
+    }
+    s->second.manager (0);
+    s->second.set_dirty (true);
+  }
+}
+
+void
+Cell::end_load_deferred_shapes (const box_map &bboxes)
+{
+  m_shapes_deferred = false;
+
+  for (shapes_map::iterator s = m_shapes_map.begin (); s != m_shapes_map.end (); ++s) {
+
+    if (s->second.is_dirty ()) {
+      s->second.update ();
+    }
+    s->second.manager (manager ());
+
+    //  the bounding boxes are estimates - if they do not match, we need to update the bounding boxes
+    box_map::const_iterator b = bboxes.find (s->first);
+    if (s->second.bbox () != (b != bboxes.end () ? b->second : box_type ())) {
+      mp_layout->invalidate_bboxes (s->first);
+      m_bbox_needs_update = true;
+    }
+
+  }
+}
+
 void
 Cell::clear_shapes ()
 {
@@ -321,6 +399,17 @@ Cell::update_bbox (unsigned int layers)
    
   }
 
+  //  add the boxes of the shapes not loaded yet
+  if (m_shapes_deferred && mp_layout->deferred_cell_loader ()) {
+    const box_map *deferred_bboxes = mp_layout->deferred_cell_loader ()->deferred_bboxes (cell_index ());
+    if (deferred_bboxes) {
+      for (box_map::const_iterator d = deferred_bboxes->begin (); d != deferred_bboxes->end (); ++d) {
+        m_bbox += d->second;
+        m_bboxes [d->first] += d->second;
+      }
+    }
+  }
+
   //  reset "dirty child instances" flag
   m_bbox_needs_update = false;
 
@@ -375,10 +464,10 @@ Cell::swap (unsigned int i1, unsigned int i2)
 }
 
 void 
-Cell::sort_shapes ()
+Cell::sort_shapes (db::box_tree_sort_scheduler *scheduler)
 {
   for (shapes_map::iterator s = m_shapes_map.begin (); s != m_shapes_map.end (); ++s) {
-    s->second.sort ();
+    s->second.sort (scheduler);
   }
 }
 
@@ -616,6 +705,7 @@ Cell::clear_shapes_no_invalidate ()
   for (shapes_map::iterator s = m_shapes_map.begin (); s != m_shapes_map.end (); ++s) {
     s->second.clear ();
   }
+  m_shapes_deferred = false;
   m_bbox_needs_update = true;
 }
 
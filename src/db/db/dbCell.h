@@ -314,6 +314,7 @@ public:
   template <class Trans>
   void transform (const Trans &t)
   {
+    load_deferred_shapes ();
     m_instances.transform (t);
     for (typename shapes_map::iterator s = m_shapes_map.begin (); s != m_shapes_map.end (); ++s) {
       if (! s->second.empty ()) {
@@ -339,6 +340,7 @@ public:
   template <class Trans>
   void transform_into (const Trans &t)
   {
+    load_deferred_shapes ();
     m_instances.transform_into (t);
     for (typename shapes_map::iterator s = m_shapes_map.begin (); s != m_shapes_map.end (); ++s) {
       if (! s->second.empty ()) {
@@ -503,8 +505,21 @@ public:
    *  on a per-shape basis. Since sorting of the shapes is
    *  guarded against redundant sorting (db::Layer::sort),
    *  we can safely call the sort method in any case.
+   *  If a scheduler is given, large shape trees are sorted in tasks
+   *  executed by the scheduler (see db::box_tree_sort_scheduler).
    */
-  void sort_shapes ();
+  void sort_shapes (db::box_tree_sort_scheduler *scheduler = 0);
+
+  /**
+   *  @brief Sort the cell instance list
+   *
+   *  This will sort the cell instance list. As a prerequesite
+   *  the cell's bounding boxes must have been computed.
+   *  This method is called by the layout's update. It is public to
+   *  make the instances accessible while the layout is still under
+   *  construction.
+   */
+  void sort_inst_tree ();
 
   /**
    *  @brief Retrieve the bounding box of the cell
@@ -878,6 +893,26 @@ public:
     m_ghost_cell = g;
   }
 
+  /**
+   *  @brief Returns a value indicating whether the cell's shapes are still to be loaded
+   *
+   *  Readers supporting lazy loading set this flag for cells whose shapes are
+   *  delivered later by the layout's DeferredCellLoader. The shapes are loaded
+   *  when they are accessed first. The bounding box of the cell includes the
+   *  shapes not loaded yet.
+   */
+  bool has_deferred_shapes () const
+  {
+    return m_shapes_deferred;
+  }
+
+  /**
+   *  @brief Sets the "deferred shapes" flag
+   *
+   *  See "has_deferred_shapes" for a description of this property.
+   */
+  void set_deferred_shapes (bool d);
+
   /**
    *  @brief Returns a value indicating whether the cell is empty
    *
@@ -1054,6 +1089,7 @@ private:
   unsigned int m_hier_levels : 29;
   bool m_bbox_needs_update : 1;
   bool m_ghost_cell : 1;
+  bool m_shapes_deferred : 1;
 
   static box_type ms_empty_box;
 
@@ -1063,6 +1099,15 @@ private:
   //  clear the shapes without telling the graph
   void clear_shapes_no_invalidate ();
 
+  //  loads the shapes if they are deferred
+  void load_deferred_shapes () const;
+
+  //  prepares the shapes containers for receiving the deferred shapes (used by Layout)
+  void begin_load_deferred_shapes (const box_map &bboxes);
+
+  //  finishes loading the deferred shapes (used by Layout)
+  void end_load_deferred_shapes (const box_map &bboxes);
+
   //  helper function for computing the number of hierarchy levels
   //  must be called bottom-up
   unsigned int count_hier_levels () const;
@@ -1115,16 +1160,6 @@ private:
    *  convolution of the displacements bboxes with the object bboxes.
    */
   void sort_child_insts ();
-
-  /**
-   *  @brief Sort the cell instance list
-   *
-   *  This will sort the cell instance list. As a prerequesite
-   *  the cell's bounding boxes must have been computed.
-   *
-   *  @param layers The maximum number of layers in the child cells
-   */
-  void sort_inst_tree ();
 };
 
 /**
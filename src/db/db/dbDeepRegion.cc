@@ -457,6 +457,7 @@ DeepRegion::ensure_merged_polygons_valid () const
       db::Connectivity conn;
       conn.connect (deep_layer ());
       hc.set_base_verbosity (base_verbosity () + 10);
+      hc.set_threads (deep_layer ().store ()->threads ());
       hc.build (layout, deep_layer ().initial_cell (), conn);
 
       //  collect the clusters and merge them into big polygons
@@ -1107,6 +1108,7 @@ DeepRegion::merged (bool min_coherence, unsigned int min_wc) const
   db::Connectivity conn;
   conn.connect (deep_layer ());
   hc.set_base_verbosity (base_verbosity () + 10);
+  hc.set_threads (deep_layer ().store ()->threads ());
   hc.build (layout, deep_layer ().initial_cell (), conn);
 
   //  collect the clusters and merge them into big polygons
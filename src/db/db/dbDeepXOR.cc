@@ -0,0 +1,358 @@
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "dbDeepXOR.h"
+#include "dbDeepShapeStore.h"
+#include "dbRecursiveShapeIterator.h"
+#include "tlLog.h"
+#include "tlTimer.h"
+#include "tlInternational.h"
+#include "tlAssert.h"
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace db
+{
+
+static const db::cell_index_type no_cell = std::numeric_limits<db::cell_index_type>::max ();
+
+// --------------------------------------------------------------------------------------------------
+//  DeepXOR implementation
+
+DeepXOR::DeepXOR (db::DeepShapeStore *dss, const db::Layout *layout_a, db::cell_index_type cell_a, const db::Layout *layout_b, db::cell_index_type cell_b, double dbu)
+  : mp_dss (dss), mp_layout_a (layout_a), mp_layout_b (layout_b), m_cell_a (cell_a), m_cell_b (cell_b),
+    m_dbu (dbu), m_skip_identical (false), m_merged_top (0), m_common_instances (0)
+{
+  //  .. nothing yet ..
+}
+
+DeepXOR::~DeepXOR ()
+{
+  //  .. nothing yet ..
+}
+
+db::Region
+DeepXOR::compute (db::BooleanOp::BoolOp op, int la, int lb)
+{
+  std::vector<unsigned int> lva, lvb;
+  if (la >= 0) {
+    lva.push_back ((unsigned int) la);
+  }
+  if (lb >= 0) {
+    lvb.push_back ((unsigned int) lb);
+  }
+
+  return compute (op, lva, lvb);
+}
+
+db::Region
+DeepXOR::compute (db::BooleanOp::BoolOp op, const std::vector<unsigned int> &la, const std::vector<unsigned int> &lb, const db::Box &region_a, const db::Box &region_b)
+{
+  tl_assert (mp_dss != 0);
+  return compute (*mp_dss, op, la, lb, region_a, region_b);
+}
+
+db::Region
+DeepXOR::compute (db::DeepShapeStore &dss, db::BooleanOp::BoolOp op, const std::vector<unsigned int> &la, const std::vector<unsigned int> &lb, const db::Box &region_a, const db::Box &region_b)
+{
+  if (m_skip_identical && can_skip_identical (region_a, region_b)) {
+    return compute_merged (dss, op, la, lb, region_a);
+  } else {
+    return compute_basic (dss, op, la, lb, region_a, region_b);
+  }
+}
+
+bool
+DeepXOR::can_skip_identical (const db::Box &region_a, const db::Box &region_b) const
+{
+  //  the merged hierarchy requires identical coordinate systems
+  return fabs (mp_layout_a->dbu () - mp_layout_b->dbu ()) < db::epsilon && region_a == region_b;
+}
+
+static db::RecursiveShapeIterator
+make_iter (const db::Layout *layout, db::cell_index_type cell, const std::vector<unsigned int> &layers, const db::Box &region)
+{
+  if (layers.empty ()) {
+    return db::RecursiveShapeIterator ();
+  } else if (region == db::Box::world ()) {
+    if (layers.size () == 1) {
+      return db::RecursiveShapeIterator (*layout, layout->cell (cell), layers.front ());
+    } else {
+      return db::RecursiveShapeIterator (*layout, layout->cell (cell), layers);
+    }
+  } else {
+    if (layers.size () == 1) {
+      return db::RecursiveShapeIterator (*layout, layout->cell (cell), layers.front (), region);
+    } else {
+      return db::RecursiveShapeIterator (*layout, layout->cell (cell), layers, region);
+    }
+  }
+}
+
+static db::Region
+apply_op (db::BooleanOp::BoolOp op, const db::Region &a, const db::Region &b)
+{
+  if (op == db::BooleanOp::ANotB) {
+    return a - b;
+  } else if (op == db::BooleanOp::BNotA) {
+    return b - a;
+  } else {
+    return a ^ b;
+  }
+}
+
+db::Region
+DeepXOR::compute_basic (db::DeepShapeStore &dss, db::BooleanOp::BoolOp op, const std::vector<unsigned int> &la, const std::vector<unsigned int> &lb, const db::Box &region_a, const db::Box &region_b)
+{
+  db::Region in_a (make_iter (mp_layout_a, m_cell_a, la, region_a), dss, db::ICplxTrans (mp_layout_a->dbu () / m_dbu));
+  db::Region in_b (make_iter (mp_layout_b, m_cell_b, lb, region_b), dss, db::ICplxTrans (mp_layout_b->dbu () / m_dbu));
+
+  return apply_op (op, in_a, in_b);
+}
+
+db::Region
+DeepXOR::compute_merged (db::DeepShapeStore &dss, db::BooleanOp::BoolOp op, const std::vector<unsigned int> &la, const std::vector<unsigned int> &lb, const db::Box &region)
+{
+  //  The merged hierarchy is shared by all threads: building it and the working layers
+  //  and copying them into the deep shape store is serialized. The booleans run outside
+  //  the lock on the copies.
+
+  db::Region in_a, in_b;
+  unsigned int l_common = 0;
+  db::ICplxTrans trans;
+
+  {
+    tl::MutexLocker locker (&m_lock);
+
+    if (! mp_merged.get ()) {
+      build_merged_hierarchy ();
+    }
+
+    unsigned int l_a = mp_merged->insert_layer ();
+    unsigned int l_b = mp_merged->insert_layer ();
+    l_common = mp_merged->insert_layer ();
+
+    fill_layers (la, lb, l_a, l_b, l_common);
+
+    trans = db::ICplxTrans (mp_merged->dbu () / m_dbu);
+    const db::Cell &top = mp_merged->cell (m_merged_top);
+
+    in_a = db::Region (db::RecursiveShapeIterator (*mp_merged, top, l_a, region), dss, trans);
+    in_b = db::Region (db::RecursiveShapeIterator (*mp_merged, top, l_b, region), dss, trans);
+
+    //  the working layers have been copied into the deep shape store and are no longer required
+    mp_merged->delete_layer (l_a);
+    mp_merged->delete_layer (l_b);
+  }
+
+  db::Region res = apply_op (op, in_a, in_b);
+  db::Region common;
+
+  {
+    tl::MutexLocker locker (&m_lock);
+
+    //  The common part only needs to be considered if there are differences
+    if (! res.empty ()) {
+      common = db::Region (db::RecursiveShapeIterator (*mp_merged, mp_merged->cell (m_merged_top), l_common, region), dss, trans);
+    }
+
+    mp_merged->delete_layer (l_common);
+  }
+
+  if (! res.empty ()) {
+    res -= common;
+  }
+
+  return res;
+}
+
+void
+DeepXOR::build_merged_hierarchy ()
+{
+  tl::SelfTimer timer (tl::verbosity () >= 21, tl::to_string (tr ("Building merged hierarchy for XOR")));
+
+  mp_merged.reset (new db::Layout ());
+  mp_merged->dbu (mp_layout_a->dbu ());
+
+  m_variants.clear ();
+  m_a2b.clear ();
+  m_b2a.clear ();
+  m_common_instances = 0;
+
+  //  pair cells by name - the top cells are always paired
+
+  for (db::Layout::const_iterator c = mp_layout_a->begin (); c != mp_layout_a->end (); ++c) {
+    if (c->cell_index () == m_cell_a) {
+      continue;
+    }
+    std::pair<bool, db::cell_index_type> cb = mp_layout_b->cell_by_name (mp_layout_a->cell_name (c->cell_index ()));
+    if (cb.first && cb.second != m_cell_b) {
+      m_a2b.insert (std::make_pair (c->cell_index (), cb.second));
+      m_b2a.insert (std::make_pair (cb.second, c->cell_index ()));
+    }
+  }
+
+  m_a2b.insert (std::make_pair (m_cell_a, m_cell_b));
+  m_b2a.insert (std::make_pair (m_cell_b, m_cell_a));
+
+  m_merged_top = variant (cell_pair (m_cell_a, m_cell_b));
+
+  if (tl::verbosity () >= 20) {
+    tl::log << "Merged hierarchy: " << m_variants.size () << " cells, " << m_common_instances << " common instances";
+  }
+}
+
+db::cell_index_type
+DeepXOR::variant (const cell_pair &cp)
+{
+  std::map<cell_pair, db::cell_index_type>::const_iterator v = m_variants.find (cp);
+  if (v != m_variants.end ()) {
+    return v->second;
+  }
+
+  const char *name = cp.first != no_cell ? mp_layout_a->cell_name (cp.first) : mp_layout_b->cell_name (cp.second);
+  db::cell_index_type ci = mp_merged->add_cell (name);
+  m_variants.insert (std::make_pair (cp, ci));
+
+  //  Collects the instances first as creating the child variants will modify the layout
+
+  std::vector<std::pair<db::CellInstArray, cell_pair> > instances;
+
+  //  B instances are kept in terms of the A cells for the matching
+  std::multimap<db::CellInstArray, db::cell_index_type> b_insts;
+
+  if (cp.second != no_cell) {
+
+    const db::Cell &cell_b = mp_layout_b->cell (cp.second);
+    for (db::Cell::const_iterator i = cell_b.begin (); ! i.at_end (); ++i) {
+
+      db::cell_index_type child_b = i->cell_index ();
+      std::map<db::cell_index_type, db::cell_index_type>::const_iterator p = m_b2a.find (child_b);
+
+      if (cp.first != no_cell && p != m_b2a.end ()) {
+        db::CellInstArray key (i->cell_inst ());
+        key.object () = db::CellInst (p->second);
+        b_insts.insert (std::make_pair (key, child_b));
+      } else {
+        instances.push_back (std::make_pair (i->cell_inst (), cell_pair (no_cell, child_b)));
+      }
+
+    }
+
+  }
+
+  if (cp.first != no_cell) {
+
+    const db::Cell &cell_a = mp_layout_a->cell (cp.first);
+    for (db::Cell::const_iterator i = cell_a.begin (); ! i.at_end (); ++i) {
+
+      db::cell_index_type child_a = i->cell_index ();
+
+      std::multimap<db::CellInstArray, db::cell_index_type>::iterator bi = b_insts.find (i->cell_inst ());
+      if (bi != b_insts.end ()) {
+        //  same child, same placement: a common instance
+        instances.push_back (std::make_pair (i->cell_inst (), cell_pair (child_a, bi->second)));
+        b_insts.erase (bi);
+        ++m_common_instances;
+      } else {
+        instances.push_back (std::make_pair (i->cell_inst (), cell_pair (child_a, no_cell)));
+      }
+
+    }
+
+  }
+
+  for (std::multimap<db::CellInstArray, db::cell_index_type>::const_iterator bi = b_insts.begin (); bi != b_insts.end (); ++bi) {
+    instances.push_back (std::make_pair (bi->first, cell_pair (no_cell, bi->second)));
+  }
+
+  //  Creates the instances
+
+  for (std::vector<std::pair<db::CellInstArray, cell_pair> >::const_iterator i = instances.begin (); i != instances.end (); ++i) {
+    db::cell_index_type child = variant (i->second);
+    db::CellInstArray new_inst (i->first, &mp_merged->array_repository ());
+    new_inst.object () = db::CellInst (child);
+    mp_merged->cell (ci).insert (new_inst);
+  }
+
+  return ci;
+}
+
+static void
+collect_polygons (const db::Layout *layout, db::cell_index_type ci, const std::vector<unsigned int> &layers, std::vector<db::Polygon> &polygons)
+{
+  const db::Cell &cell = layout->cell (ci);
+
+  for (std::vector<unsigned int>::const_iterator l = layers.begin (); l != layers.end (); ++l) {
+    for (db::ShapeIterator s = cell.shapes (*l).begin (db::ShapeIterator::Polygons | db::ShapeIterator::Paths | db::ShapeIterator::Boxes); ! s.at_end (); ++s) {
+      polygons.push_back (db::Polygon ());
+      s->polygon (polygons.back ());
+    }
+  }
+
+  std::sort (polygons.begin (), polygons.end ());
+}
+
+void
+DeepXOR::fill_layers (const std::vector<unsigned int> &la, const std::vector<unsigned int> &lb, unsigned int l_a, unsigned int l_b, unsigned int l_common)
+{
+  std::vector<db::Polygon> pa, pb;
+
+  for (std::map<cell_pair, db::cell_index_type>::const_iterator v = m_variants.begin (); v != m_variants.end (); ++v) {
+
+    pa.clear ();
+    pb.clear ();
+
+    if (v->first.first != no_cell) {
+      collect_polygons (mp_layout_a, v->first.first, la, pa);
+    }
+    if (v->first.second != no_cell) {
+      collect_polygons (mp_layout_b, v->first.second, lb, pb);
+    }
+
+    db::Cell &cell = mp_merged->cell (v->second);
+    db::Shapes &shapes_a = cell.shapes (l_a);
+    db::Shapes &shapes_b = cell.shapes (l_b);
+    db::Shapes &shapes_common = cell.shapes (l_common);
+
+    //  sort the shapes into "A only", "B only" and "common"
+
+    std::vector<db::Polygon>::const_iterator ia = pa.begin (), ib = pb.begin ();
+    while (ia != pa.end () || ib != pb.end ()) {
+      if (ib == pb.end () || (ia != pa.end () && *ia < *ib)) {
+        shapes_a.insert (*ia);
+        ++ia;
+      } else if (ia == pa.end () || *ib < *ia) {
+        shapes_b.insert (*ib);
+        ++ib;
+      } else {
+        shapes_common.insert (*ia);
+        ++ia;
+        ++ib;
+      }
+    }
+
+  }
+}
+
+}
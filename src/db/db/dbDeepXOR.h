@@ -0,0 +1,185 @@
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef HDR_dbDeepXOR
+#define HDR_dbDeepXOR
+
+#include "dbCommon.h"
+
+#include "dbLayout.h"
+#include "dbRegion.h"
+#include "dbEdgeProcessor.h"
+#include "tlThreads.h"
+
+#include <memory>
+#include <map>
+#include <vector>
+
+namespace db
+{
+
+class DeepShapeStore;
+
+/**
+ *  @brief A hierarchical XOR engine for two layouts
+ *
+ *  This engine computes XOR (or A NOT B, B NOT A) differences between two
+ *  layouts in deep mode. It is shared by the "strmxor" tool and the XOR tool
+ *  of the layout viewer.
+ *
+ *  In the basic mode, both inputs are turned into deep regions and the
+ *  boolean is computed by the hierarchical processor.
+ *
+ *  If "skip identical" is enabled, both hierarchies are merged first: cells
+ *  are paired by name (the top cells are paired always) and instances
+ *  present in both layouts with the same transformation are combined into
+ *  a single instance. Shapes present in both cells of a pair are collected
+ *  on a "common" layer while the remaining shapes go to "A only" or "B only"
+ *  layers. With A = A' + C and B = B' + C, the result is computed as
+ *  "(A' op B') - C". Hence identical cells and identical placements do not
+ *  contribute except where they interact with differences. This is the
+ *  typical situation for mask revision compares where identical standard
+ *  cell content dominates.
+ *
+ *  "Skip identical" requires both layouts to have the same database unit.
+ *  Otherwise the engine falls back to the basic mode.
+ *
+ *  The merged hierarchy is built on the first "compute" call and reused by
+ *  the following ones. One engine can be shared by several threads computing
+ *  different layers if each thread supplies its own deep shape store.
+ */
+class DB_PUBLIC DeepXOR
+{
+public:
+  /**
+   *  @brief Constructor
+   *
+   *  @param dss The deep shape store which receives the working layouts (can be 0, see below)
+   *  @param layout_a The first layout
+   *  @param cell_a The top cell of the first layout
+   *  @param layout_b The second layout
+   *  @param cell_b The top cell of the second layout
+   *  @param dbu The database unit of the results
+   *
+   *  The layouts must not change and must stay alive while the engine is used.
+   *  If no deep shape store is given, only the "compute" versions taking a
+   *  deep shape store can be used.
+   */
+  DeepXOR (db::DeepShapeStore *dss, const db::Layout *layout_a, db::cell_index_type cell_a, const db::Layout *layout_b, db::cell_index_type cell_b, double dbu);
+
+  /**
+   *  @brief Destructor
+   */
+  ~DeepXOR ();
+
+  /**
+   *  @brief Enables or disables the skipping of identical content
+   */
+  void set_skip_identical (bool f)
+  {
+    m_skip_identical = f;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether identical content is skipped
+   */
+  bool skip_identical () const
+  {
+    return m_skip_identical;
+  }
+
+  /**
+   *  @brief Computes the boolean for a pair of layer sets
+   *
+   *  @param op The operation (Xor, ANotB or BNotA)
+   *  @param la The layers taken from the first layout (empty for "not present")
+   *  @param lb The layers taken from the second layout (empty for "not present")
+   *  @param region_a The region of the first layout to consider
+   *  @param region_b The region of the second layout to consider
+   *
+   *  The returned region is a deep region with the database unit given in the
+   *  constructor.
+   */
+  db::Region compute (db::BooleanOp::BoolOp op, const std::vector<unsigned int> &la, const std::vector<unsigned int> &lb, const db::Box &region_a = db::Box::world (), const db::Box &region_b = db::Box::world ());
+
+  /**
+   *  @brief Computes the boolean for a pair of layer sets using the given deep shape store
+   *
+   *  This version is thread-safe: multiple threads may call it at the same
+   *  time, provided every thread uses its own deep shape store.
+   */
+  db::Region compute (db::DeepShapeStore &dss, db::BooleanOp::BoolOp op, const std::vector<unsigned int> &la, const std::vector<unsigned int> &lb, const db::Box &region_a = db::Box::world (), const db::Box &region_b = db::Box::world ());
+
+  /**
+   *  @brief Convenience version of "compute" for single layers
+   *
+   *  Negative layer indexes indicate "not present".
+   */
+  db::Region compute (db::BooleanOp::BoolOp op, int la, int lb);
+
+  /**
+   *  @brief Gets the number of cells in the merged hierarchy
+   *
+   *  This value is available after "compute" was called in "skip identical" mode.
+   */
+  size_t merged_cells () const
+  {
+    return m_variants.size ();
+  }
+
+  /**
+   *  @brief Gets the number of instances shared by both layouts in the merged hierarchy
+   */
+  size_t common_instances () const
+  {
+    return m_common_instances;
+  }
+
+private:
+  typedef std::pair<db::cell_index_type, db::cell_index_type> cell_pair;
+
+  db::DeepShapeStore *mp_dss;
+  const db::Layout *mp_layout_a, *mp_layout_b;
+  db::cell_index_type m_cell_a, m_cell_b;
+  double m_dbu;
+  bool m_skip_identical;
+  std::auto_ptr<db::Layout> mp_merged;
+  db::cell_index_type m_merged_top;
+  std::map<db::cell_index_type, db::cell_index_type> m_a2b, m_b2a;
+  std::map<cell_pair, db::cell_index_type> m_variants;
+  size_t m_common_instances;
+  tl::Mutex m_lock;
+
+  DeepXOR (const DeepXOR &);
+  DeepXOR &operator= (const DeepXOR &);
+
+  bool can_skip_identical (const db::Box &region_a, const db::Box &region_b) const;
+  db::Region compute_basic (db::DeepShapeStore &dss, db::BooleanOp::BoolOp op, const std::vector<unsigned int> &la, const std::vector<unsigned int> &lb, const db::Box &region_a, const db::Box &region_b);
+  db::Region compute_merged (db::DeepShapeStore &dss, db::BooleanOp::BoolOp op, const std::vector<unsigned int> &la, const std::vector<unsigned int> &lb, const db::Box &region);
+  void build_merged_hierarchy ();
+  db::cell_index_type variant (const cell_pair &cp);
+  void fill_layers (const std::vector<unsigned int> &la, const std::vector<unsigned int> &lb, unsigned int l_a, unsigned int l_b, unsigned int l_common);
+};
+
+}
+
+#endif
+
@@ -23,6 +23,7 @@
 #include "dbDeviceClass.h"
 #include "dbDevice.h"
 #include "tlClassRegistry.h"
+#include "tlString.h"
 
 namespace db
 {
@@ -99,6 +100,18 @@ EqualDeviceParameters &EqualDeviceParameters::operator+= (const EqualDeviceParam
   return *this;
 }
 
+std::string EqualDeviceParameters::to_string () const
+{
+  std::string res;
+  for (std::vector<std::pair<size_t, std::pair<double, double> > >::const_iterator c = m_compare_set.begin (); c != m_compare_set.end (); ++c) {
+    if (! res.empty ()) {
+      res += ";";
+    }
+    res += "#" + tl::to_string (c->first) + ":" + tl::to_string (c->second.first) + "/" + tl::to_string (c->second.second);
+  }
+  return res;
+}
+
 // --------------------------------------------------------------------------------
 //  AllDeviceParametersAreEqual class implementation
 
@@ -134,6 +147,11 @@ bool AllDeviceParametersAreEqual::equal (const db::Device &a, const db::Device &
   return true;
 }
 
+std::string AllDeviceParametersAreEqual::to_string () const
+{
+  return "*:" + tl::to_string (m_relative);
+}
+
 // --------------------------------------------------------------------------------
 //  DeviceClass class implementation
 
@@ -282,6 +282,11 @@ public:
     return pc;
   }
 
+  /**
+   *  @brief Gets a string describing the compare settings
+   */
+  std::string to_string () const;
+
 private:
   std::vector<std::pair<size_t, std::pair<double, double> > > m_compare_set;
 };
@@ -298,6 +303,11 @@ public:
   virtual bool less (const db::Device &a, const db::Device &b) const;
   virtual bool equal (const db::Device &a, const db::Device &b) const;
 
+  /**
+   *  @brief Gets a string describing the compare settings
+   */
+  std::string to_string () const;
+
 private:
   double m_relative;
 };
@@ -27,6 +27,7 @@
 #include "dbLayout.h"
 #include "tlTimer.h"
 #include "tlProgress.h"
+#include "tlThreadedWorkers.h"
 #include "gsi.h"
 
 #include <vector>
@@ -974,8 +975,10 @@ BooleanOp2::compare_ns () const
 // -------------------------------------------------------------------------------
 //  EdgeProcessor implementation
 
+static unsigned int s_default_threads = 0;
+
 EdgeProcessor::EdgeProcessor (bool report_progress, const std::string &progress_desc)
-  : m_report_progress (report_progress), m_progress_desc (progress_desc), m_base_verbosity (30)
+  : m_report_progress (report_progress), m_progress_desc (progress_desc), m_base_verbosity (30), m_threads (s_default_threads)
 {
   mp_work_edges = new std::vector <WorkEdge> ();
   mp_cpvector = new std::vector <CutPoints> ();
@@ -1012,6 +1015,24 @@ EdgeProcessor::set_base_verbosity (int bv)
   m_base_verbosity = bv;
 }
 
+void
+EdgeProcessor::set_threads (unsigned int n)
+{
+  m_threads = n;
+}
+
+void
+EdgeProcessor::set_default_threads (unsigned int n)
+{
+  s_default_threads = n;
+}
+
+unsigned int
+EdgeProcessor::default_threads ()
+{
+  return s_default_threads;
+}
+
 void 
 EdgeProcessor::reserve (size_t n)
 {
@@ -1537,255 +1558,43 @@ get_intersections_per_band_any (std::vector <CutPoints> &cutpoints, std::vector
   }
 }
 
-void 
-EdgeProcessor::process (db::EdgeSink &es, EdgeEvaluatorBase &op)
+/**
+ *  @brief Runs the scanline sweep over the given edges
+ *
+ *  The edges must be sorted by their lower y coordinate. The sweep starts at scanline y
+ *  which must be a scanline of the full sweep. Edges starting below y must be
+ *  included if they end at y or above. The sweep stops before y_end unless y_end is
+ *  the maximum coordinate.
+ */
+static void
+process_scanlines (std::vector <WorkEdge> &work_edges, db::Coord y, db::Coord y_end, db::EdgeSink &es, EdgeEvaluatorBase &op, tl::AbsoluteProgress *progress, size_t progress_from, size_t progress_to)
 {
-  tl::SelfTimer timer (tl::verbosity () >= m_base_verbosity, "EdgeProcessor: process");
-
   bool prefer_touch = op.prefer_touch (); 
   bool selects_edges = op.selects_edges (); 
-  
-  db::Coord y;
-  std::vector <WorkEdge>::iterator future;
-
-  //  step 1: preparation
-
-  if (mp_work_edges->empty ()) {
-    es.start ();
-    es.flush ();
-    return;
-  }
-
-  mp_cpvector->clear ();
-
-  property_type n_props = 0;
-  for (std::vector <WorkEdge>::iterator e = mp_work_edges->begin (); e != mp_work_edges->end (); ++e) {
-    if (e->prop > n_props) {
-      n_props = e->prop;
-    }
-  }
-  ++n_props;
-
-  size_t todo_max = 1000000;
-
-  std::auto_ptr<tl::AbsoluteProgress> progress (0);
-  if (m_report_progress) {
-    if (m_progress_desc.empty ()) {
-      progress.reset (new tl::AbsoluteProgress (tl::to_string (tr ("Processing")), 1000));
-    } else {
-      progress.reset (new tl::AbsoluteProgress (m_progress_desc, 1000));
-    }
-    progress->set_format (tl::to_string (tr ("%.0f%%")));
-    progress->set_unit (todo_max / 100);
-  }
-
-  size_t todo_next = 0;
-  size_t todo = todo_next;
-  todo_next += (todo_max - todo) / 5;
-
-
-  //  step 2: find intersections
-  std::sort (mp_work_edges->begin (), mp_work_edges->end (), edge_ymin_compare<db::Coord> ());
-
-  y = edge_ymin ((*mp_work_edges) [0]);
-  future = mp_work_edges->begin ();
-
-  for (std::vector <WorkEdge>::iterator current = mp_work_edges->begin (); current != mp_work_edges->end (); ) {
-
-    if (m_report_progress) {
-      double p = double (std::distance (mp_work_edges->begin (), current)) / double (mp_work_edges->size ());
-      progress->set (size_t (double (todo_next - todo) * p) + todo);
-    }
-
-    size_t n = std::distance (current, future);
-    db::Coord yy = y;
-
-    //  Use as many scanlines as to fetch approx. 50% new edges into the scanline (this
-    //  is an empirically determined factor)
-    do {
-
-      while (future != mp_work_edges->end () && edge_ymin (*future) <= yy) {
-        ++future;
-      }
-
-      if (future != mp_work_edges->end ()) {
-        yy = edge_ymin (*future);
-      } else {
-        yy = std::numeric_limits <db::Coord>::max ();
-      }
-
-    } while (future != mp_work_edges->end () && std::distance (current, future) < long (n + n / 2));
-
-    bool is90 = true;
-
-    if (current != future) {
-
-      for (std::vector <WorkEdge>::iterator c = current; c != future && is90; ++c) {
-        if (c->dx () != 0 && c->dy () != 0) {
-          is90 = false;
-        }
-      }
-
-      if (is90) {
-        get_intersections_per_band_90 (*mp_cpvector, current, future, y, yy, selects_edges);
-      } else {
-        get_intersections_per_band_any (*mp_cpvector, current, future, y, yy, selects_edges);
-      }
-
-    }
-
-    y = yy;
-    for (std::vector <WorkEdge>::iterator c = current; c != future; ++c) {
-      //  Hint: we have to keep the edges ending a y (the new lower band limit) in the all angle case because these edges
-      //  may receive cutpoints because the enter the -0.5DBU region below the band
-      if ((!is90 && edge_ymax (*c) < y) || (is90 && edge_ymax (*c) <= y)) {
-        if (current != c) {
-          std::swap (*current, *c);
-        }
-        ++current;
-      }
-    }
-    
-  }
-
-  //  step 3: create new edges from the ones with cutpoints
-  //
-  //  Hint: when we create the edges from the cutpoints we use the projection to sort the cutpoints along the
-  //  edge. However, we have some freedom to connect the points which we use to avoid "z" configurations which could
-  //  create new intersections in a 1x1 pixel box.
-  
-  todo = todo_next;
-  todo_next += (todo_max - todo) / 5;
-
-  size_t n_work = mp_work_edges->size ();
-  size_t nw = 0;
-  for (size_t n = 0; n < n_work; ++n) {
-
-    if (m_report_progress) {
-      double p = double (n) / double (n_work);
-      progress->set (size_t (double (todo_next - todo) * p) + todo);
-    }
-
-    WorkEdge &ew = (*mp_work_edges) [n];
-
-    CutPoints *cut_points = ew.data ? & ((*mp_cpvector) [ew.data - 1]) : 0;
-    ew.data = 0;
-
-    if (ew.dy () == 0 && ! selects_edges) {
-
-      //  don't care about horizontal edges 
-
-    } else if (cut_points) {
-
-      if (cut_points->has_cutpoints && ! cut_points->cut_points.empty ()) {
-
-        db::Edge e = ew;
-        property_type p = ew.prop;
-        std::sort (cut_points->cut_points.begin (), cut_points->cut_points.end (), ProjectionCompare (e));
-
-        db::Point pll = e.p1 ();
-        db::Point pl = e.p1 ();
-
-        for (std::vector <db::Point>::iterator cp = cut_points->cut_points.begin (); cp != cut_points->cut_points.end (); ++cp) {
-          if (*cp != pl) {
-            WorkEdge ne = WorkEdge (db::Edge (pl, *cp), p);
-            if (pl.y () == pll.y () && ne.p2 ().x () != pl.x () && ne.p2 ().x () == pll.x ()) {
-              ne = db::Edge (pll, ne.p2 ());
-            } else if (pl.x () == pll.x () && ne.p2 ().y () != pl.y () && ne.p2 ().y () == pll.y ()) {
-              ne = db::Edge (ne.p1 (), pll);
-            } else {
-              pll = pl;
-            }
-            pl = *cp;
-            if (selects_edges || ne.dy () != 0) {
-              if (nw <= n) {
-                (*mp_work_edges) [nw++] = ne;
-              } else {
-                mp_work_edges->push_back (ne);
-              }
-            }
-          }
-        }
-
-        if (cut_points->cut_points.back () != e.p2 ()) {
-          WorkEdge ne = WorkEdge (db::Edge (pl, e.p2 ()), p);
-          if (pl.y () == pll.y () && ne.p2 ().x () != pl.x () && ne.p2 ().x () == pll.x ()) {
-            ne = db::Edge (pll, ne.p2 ());
-          } else if (pl.x () == pll.x () && ne.p2 ().y () != pl.y () && ne.p2 ().y () == pll.y ()) {
-            ne = db::Edge (ne.p1 (), pll);
-          }
-          if (selects_edges || ne.dy () != 0) {
-            if (nw <= n) {
-              (*mp_work_edges) [nw++] = ne;
-            } else {
-              mp_work_edges->push_back (ne);
-            }
-          }
-        }
-
-      } else {
 
-        if (nw < n) {
-          (*mp_work_edges) [nw] = (*mp_work_edges) [n];
-        }
-        ++nw;
-
-      }
-
-    } else {
+  size_t skip_unit = 1;
 
-      if (nw < n) {
-        (*mp_work_edges) [nw] = (*mp_work_edges) [n];
-      }
-      ++nw;
+  std::vector <WorkEdge>::iterator future = work_edges.begin ();
+  for (std::vector <WorkEdge>::iterator current = work_edges.begin (); current != work_edges.end (); ) {
 
+    if (y >= y_end && y_end < std::numeric_limits<db::Coord>::max ()) {
+      break;
     }
 
-  }
-
-  if (nw != n_work) {
-    mp_work_edges->erase (mp_work_edges->begin () + nw, mp_work_edges->begin () + n_work);
-  }
-
-#ifdef DEBUG_EDGE_PROCESSOR
-  printf ("Output edges:\n");
-  for (std::vector <WorkEdge>::iterator c1 = mp_work_edges->begin (); c1 != mp_work_edges->end (); ++c1) { 
-    printf ("%s\n", c1->to_string().c_str ()); 
-  } 
-#endif
-
-
-  tl::SelfTimer timer2 (tl::verbosity () >= m_base_verbosity + 10, "EdgeProcessor: production");
-
-  //  step 4: compute the result edges 
-  
-  es.start (); // call this as late as possible. This way, input containers can be identical with output containers ("clear" is done after the input is read)
-
-  op.reset ();
-  op.reserve (n_props);
-
-  std::sort (mp_work_edges->begin (), mp_work_edges->end (), edge_ymin_compare<db::Coord> ());
-
-  y = edge_ymin ((*mp_work_edges) [0]);
-  size_t skip_unit = 1;
-
-  future = mp_work_edges->begin ();
-  for (std::vector <WorkEdge>::iterator current = mp_work_edges->begin (); current != mp_work_edges->end (); ) {
-
-    if (m_report_progress) {
-      double p = double (std::distance (mp_work_edges->begin (), current)) / double (mp_work_edges->size ());
-      progress->set (size_t (double (todo_max - todo_next) * p) + todo_next);
+    if (progress) {
+      double p = double (std::distance (work_edges.begin (), current)) / double (work_edges.size ());
+      progress->set (size_t (double (progress_to - progress_from) * p) + progress_from);
     }
 
     std::vector <WorkEdge>::iterator f0 = future;
-    while (future != mp_work_edges->end () && edge_ymin (*future) <= y) {
+    while (future != work_edges.end () && edge_ymin (*future) <= y) {
       tl_assert (future->data == 0); // HINT: for development
       ++future;
     }
     std::sort (f0, future, EdgeXAtYCompare2 (y));
 
     db::Coord yy = std::numeric_limits <db::Coord>::max ();
-    if (future != mp_work_edges->end ()) {
+    if (future != work_edges.end ()) {
       yy = edge_ymin (*future);
     }
     for (std::vector <WorkEdge>::const_iterator c = current; c != future; ++c) {
@@ -1864,7 +1673,7 @@ EdgeProcessor::process (db::EdgeSink &es, EdgeEvaluatorBase &op)
             //  treat all edges crossing the scanline in a certain point
             for (std::vector <WorkEdge>::iterator cc = c; cc != f; ) {
 
-              std::vector <WorkEdge>::iterator e = mp_work_edges->end ();
+              std::vector <WorkEdge>::iterator e = work_edges.end ();
 
               int pn = 0, ps = 0;
 
@@ -1893,7 +1702,7 @@ EdgeProcessor::process (db::EdgeSink &es, EdgeEvaluatorBase &op)
 
                 if (cc->dy () != 0) {
 
-                  if (e == mp_work_edges->end () && edge_ymax (*cc) > y) {
+                  if (e == work_edges.end () && edge_ymax (*cc) > y) {
                     e = cc;
                   }
                   
@@ -1962,7 +1771,7 @@ EdgeProcessor::process (db::EdgeSink &es, EdgeEvaluatorBase &op)
 
               }
 
-              if (e != mp_work_edges->end ()) {
+              if (e != work_edges.end ()) {
 
                 db::Edge edge (*e);
 
@@ -2062,6 +1871,513 @@ EdgeProcessor::process (db::EdgeSink &es, EdgeEvaluatorBase &op)
     es.end_scanline (ysl);
 
   }
+}
+
+// -------------------------------------------------------------------------------
+//  Multi-threaded scanline implementation
+
+/**
+ *  @brief The minimum number of edges per band for the multi-threaded sweep
+ */
+const size_t min_edges_per_band = 10000;
+
+/**
+ *  @brief An edge sink recording the events for later delivery
+ *
+ *  Each band of the multi-threaded sweep writes to a recorder. The recorders
+ *  are replayed in band order which gives the same sequence of events as 
+ *  the single-threaded sweep.
+ */
+class EdgeSinkRecorder
+  : public db::EdgeSink
+{
+public:
+  EdgeSinkRecorder ()
+  {
+    //  .. nothing yet ..
+  }
+
+  virtual void put (const db::Edge &e)
+  {
+    m_events.push_back (event (Put, e, 0));
+  }
+
+  virtual void crossing_edge (const db::Edge &e)
+  {
+    m_events.push_back (event (CrossingEdge, e, 0));
+  }
+
+  virtual void skip_n (size_t n)
+  {
+    m_events.push_back (event (SkipN, db::Edge (), n));
+  }
+
+  virtual void begin_scanline (db::Coord y)
+  {
+    m_events.push_back (event (BeginScanline, db::Edge (), size_t (0), y));
+  }
+
+  virtual void end_scanline (db::Coord y)
+  {
+    m_events.push_back (event (EndScanline, db::Edge (), size_t (0), y));
+  }
+
+  void replay (db::EdgeSink &es) const
+  {
+    for (std::vector<event>::const_iterator e = m_events.begin (); e != m_events.end (); ++e) {
+      switch (e->type) {
+      case Put:
+        es.put (e->edge);
+        break;
+      case CrossingEdge:
+        es.crossing_edge (e->edge);
+        break;
+      case SkipN:
+        es.skip_n (e->n);
+        break;
+      case BeginScanline:
+        es.begin_scanline (e->y);
+        break;
+      case EndScanline:
+        es.end_scanline (e->y);
+        break;
+      }
+    }
+  }
+
+private:
+  enum event_type { Put, CrossingEdge, SkipN, BeginScanline, EndScanline };
+
+  struct event
+  {
+    event (event_type _type, const db::Edge &_edge, size_t _n, db::Coord _y = 0)
+      : type (_type), edge (_edge), n (_n), y (_y)
+    { }
+
+    event_type type;
+    db::Edge edge;
+    size_t n;
+    db::Coord y;
+  };
+
+  std::vector<event> m_events;
+};
+
+/**
+ *  @brief A task for the multi-threaded sweep: a band [y1, y2) of scanlines
+ */
+class EdgeProcessorBandTask
+  : public tl::Task
+{
+public:
+  EdgeProcessorBandTask (db::Coord y1, db::Coord y2, EdgeEvaluatorBase *op, EdgeSinkRecorder *recorder)
+    : m_y1 (y1), m_y2 (y2), mp_op (op), mp_recorder (recorder)
+  {
+    //  .. nothing yet ..
+  }
+
+  db::Coord y1 () const { return m_y1; }
+  db::Coord y2 () const { return m_y2; }
+  EdgeEvaluatorBase &op () const { return *mp_op; }
+  EdgeSinkRecorder &recorder () const { return *mp_recorder; }
+
+private:
+  db::Coord m_y1, m_y2;
+  std::auto_ptr<EdgeEvaluatorBase> mp_op;
+  EdgeSinkRecorder *mp_recorder;
+};
+
+/**
+ *  @brief The job for the multi-threaded sweep
+ */
+class EdgeProcessorBandJob
+  : public tl::JobBase
+{
+public:
+  EdgeProcessorBandJob (int nworkers, const std::vector<WorkEdge> *edges)
+    : tl::JobBase (nworkers), mp_edges (edges), m_bands_done (0)
+  {
+    //  .. nothing yet ..
+  }
+
+  const std::vector<WorkEdge> &edges () const
+  {
+    return *mp_edges;
+  }
+
+  void band_done ()
+  {
+    tl::MutexLocker locker (&m_mutex);
+    ++m_bands_done;
+  }
+
+  size_t bands_done ()
+  {
+    tl::MutexLocker locker (&m_mutex);
+    return m_bands_done;
+  }
+
+  virtual tl::Worker *create_worker ();
+
+private:
+  const std::vector<WorkEdge> *mp_edges;
+  size_t m_bands_done;
+  tl::Mutex m_mutex;
+};
+
+/**
+ *  @brief The worker for the multi-threaded sweep
+ */
+class EdgeProcessorBandWorker
+  : public tl::Worker
+{
+public:
+  EdgeProcessorBandWorker (EdgeProcessorBandJob *job)
+    : tl::Worker (), mp_job (job)
+  {
+    //  .. nothing yet ..
+  }
+
+  void perform_task (tl::Task *task)
+  {
+    EdgeProcessorBandTask *band_task = dynamic_cast <EdgeProcessorBandTask *> (task);
+    if (band_task) {
+      do_perform (band_task);
+      mp_job->band_done ();
+    }
+  }
+
+private:
+  EdgeProcessorBandJob *mp_job;
+
+  void do_perform (const EdgeProcessorBandTask *task)
+  {
+    const std::vector<WorkEdge> &edges = mp_job->edges ();
+
+    //  collect the edges crossing the first scanline from below plus the ones starting inside the band
+    std::vector<WorkEdge> band_edges;
+    std::vector<WorkEdge>::const_iterator e = edges.begin ();
+    for ( ; e != edges.end () && edge_ymin (*e) < task->y1 (); ++e) {
+      if (edge_ymax (*e) >= task->y1 ()) {
+        band_edges.push_back (*e);
+      }
+    }
+    for ( ; e != edges.end () && (edge_ymin (*e) < task->y2 () || task->y2 () == std::numeric_limits<db::Coord>::max ()); ++e) {
+      band_edges.push_back (*e);
+    }
+
+    process_scanlines (band_edges, task->y1 (), task->y2 (), task->recorder (), task->op (), 0, 0, 0);
+  }
+};
+
+tl::Worker *
+EdgeProcessorBandJob::create_worker ()
+{
+  return new EdgeProcessorBandWorker (this);
+}
+
+/**
+ *  @brief Runs the scanline sweep on multiple threads
+ *
+ *  The edges (sorted by lower y) are partitioned into horizontal bands. Each band starts
+ *  at a scanline of the full sweep and is computed independently. The results are delivered
+ *  in band order.
+ */
+static void
+process_scanlines_mt (std::vector <WorkEdge> &work_edges, unsigned int threads, db::EdgeSink &es, const EdgeEvaluatorBase &op, size_t n_props, tl::AbsoluteProgress *progress, size_t progress_from, size_t progress_to)
+{
+  size_t n = work_edges.size ();
+  size_t n_bands = std::min (size_t (threads) * 4, n / min_edges_per_band);
+
+  //  band boundaries: each band starts with a scanline (the lower end of some edge)
+  std::vector<db::Coord> band_y;
+  band_y.push_back (edge_ymin (work_edges.front ()));
+  for (size_t i = 1; i < n_bands; ++i) {
+    db::Coord y = edge_ymin (work_edges [i * n / n_bands]);
+    if (y > band_y.back () && y < std::numeric_limits<db::Coord>::max ()) {
+      band_y.push_back (y);
+    }
+  }
+  band_y.push_back (std::numeric_limits<db::Coord>::max ());
+
+  std::vector<EdgeSinkRecorder> recorders;
+  recorders.resize (band_y.size () - 1);
+
+  EdgeProcessorBandJob job (int (threads), &work_edges);
+
+  for (size_t i = 0; i < recorders.size (); ++i) {
+    EdgeEvaluatorBase *band_op = op.clone ();
+    band_op->reset ();
+    band_op->reserve (n_props);
+    job.schedule (new EdgeProcessorBandTask (band_y [i], band_y [i + 1], band_op, &recorders [i]));
+  }
+
+  try {
+
+    job.start ();
+    while (job.is_running ()) {
+      if (progress) {
+        //  This may throw an exception, if the cancel button has been pressed.
+        progress->set (progress_from + (progress_to - progress_from) * job.bands_done () / recorders.size ());
+      }
+      job.wait (100);
+    }
+
+  } catch (...) {
+    job.terminate ();
+    throw;
+  }
+
+  if (job.has_error ()) {
+    throw tl::Exception (tl::to_string (tr ("Errors occurred during processing. First error message says:\n")) + job.error_messages ().front ());
+  }
+
+  for (std::vector<EdgeSinkRecorder>::const_iterator r = recorders.begin (); r != recorders.end (); ++r) {
+    r->replay (es);
+  }
+}
+
+void 
+EdgeProcessor::process (db::EdgeSink &es, EdgeEvaluatorBase &op)
+{
+  tl::SelfTimer timer (tl::verbosity () >= m_base_verbosity, "EdgeProcessor: process");
+
+  bool selects_edges = op.selects_edges (); 
+  
+  db::Coord y;
+  std::vector <WorkEdge>::iterator future;
+
+  //  step 1: preparation
+
+  if (mp_work_edges->empty ()) {
+    es.start ();
+    es.flush ();
+    return;
+  }
+
+  mp_cpvector->clear ();
+
+  property_type n_props = 0;
+  for (std::vector <WorkEdge>::iterator e = mp_work_edges->begin (); e != mp_work_edges->end (); ++e) {
+    if (e->prop > n_props) {
+      n_props = e->prop;
+    }
+  }
+  ++n_props;
+
+  size_t todo_max = 1000000;
+
+  std::auto_ptr<tl::AbsoluteProgress> progress (0);
+  if (m_report_progress) {
+    if (m_progress_desc.empty ()) {
+      progress.reset (new tl::AbsoluteProgress (tl::to_string (tr ("Processing")), 1000));
+    } else {
+      progress.reset (new tl::AbsoluteProgress (m_progress_desc, 1000));
+    }
+    progress->set_format (tl::to_string (tr ("%.0f%%")));
+    progress->set_unit (todo_max / 100);
+  }
+
+  size_t todo_next = 0;
+  size_t todo = todo_next;
+  todo_next += (todo_max - todo) / 5;
+
+
+  //  step 2: find intersections
+  std::sort (mp_work_edges->begin (), mp_work_edges->end (), edge_ymin_compare<db::Coord> ());
+
+  y = edge_ymin ((*mp_work_edges) [0]);
+  future = mp_work_edges->begin ();
+
+  for (std::vector <WorkEdge>::iterator current = mp_work_edges->begin (); current != mp_work_edges->end (); ) {
+
+    if (m_report_progress) {
+      double p = double (std::distance (mp_work_edges->begin (), current)) / double (mp_work_edges->size ());
+      progress->set (size_t (double (todo_next - todo) * p) + todo);
+    }
+
+    size_t n = std::distance (current, future);
+    db::Coord yy = y;
+
+    //  Use as many scanlines as to fetch approx. 50% new edges into the scanline (this
+    //  is an empirically determined factor)
+    do {
+
+      while (future != mp_work_edges->end () && edge_ymin (*future) <= yy) {
+        ++future;
+      }
+
+      if (future != mp_work_edges->end ()) {
+        yy = edge_ymin (*future);
+      } else {
+        yy = std::numeric_limits <db::Coord>::max ();
+      }
+
+    } while (future != mp_work_edges->end () && std::distance (current, future) < long (n + n / 2));
+
+    bool is90 = true;
+
+    if (current != future) {
+
+      for (std::vector <WorkEdge>::iterator c = current; c != future && is90; ++c) {
+        if (c->dx () != 0 && c->dy () != 0) {
+          is90 = false;
+        }
+      }
+
+      if (is90) {
+        get_intersections_per_band_90 (*mp_cpvector, current, future, y, yy, selects_edges);
+      } else {
+        get_intersections_per_band_any (*mp_cpvector, current, future, y, yy, selects_edges);
+      }
+
+    }
+
+    y = yy;
+    for (std::vector <WorkEdge>::iterator c = current; c != future; ++c) {
+      //  Hint: we have to keep the edges ending a y (the new lower band limit) in the all angle case because these edges
+      //  may receive cutpoints because the enter the -0.5DBU region below the band
+      if ((!is90 && edge_ymax (*c) < y) || (is90 && edge_ymax (*c) <= y)) {
+        if (current != c) {
+          std::swap (*current, *c);
+        }
+        ++current;
+      }
+    }
+    
+  }
+
+  //  step 3: create new edges from the ones with cutpoints
+  //
+  //  Hint: when we create the edges from the cutpoints we use the projection to sort the cutpoints along the
+  //  edge. However, we have some freedom to connect the points which we use to avoid "z" configurations which could
+  //  create new intersections in a 1x1 pixel box.
+  
+  todo = todo_next;
+  todo_next += (todo_max - todo) / 5;
+
+  size_t n_work = mp_work_edges->size ();
+  size_t nw = 0;
+  for (size_t n = 0; n < n_work; ++n) {
+
+    if (m_report_progress) {
+      double p = double (n) / double (n_work);
+      progress->set (size_t (double (todo_next - todo) * p) + todo);
+    }
+
+    WorkEdge &ew = (*mp_work_edges) [n];
+
+    CutPoints *cut_points = ew.data ? & ((*mp_cpvector) [ew.data - 1]) : 0;
+    ew.data = 0;
+
+    if (ew.dy () == 0 && ! selects_edges) {
+
+      //  don't care about horizontal edges 
+
+    } else if (cut_points) {
+
+      if (cut_points->has_cutpoints && ! cut_points->cut_points.empty ()) {
+
+        db::Edge e = ew;
+        property_type p = ew.prop;
+        std::sort (cut_points->cut_points.begin (), cut_points->cut_points.end (), ProjectionCompare (e));
+
+        db::Point pll = e.p1 ();
+        db::Point pl = e.p1 ();
+
+        for (std::vector <db::Point>::iterator cp = cut_points->cut_points.begin (); cp != cut_points->cut_points.end (); ++cp) {
+          if (*cp != pl) {
+            WorkEdge ne = WorkEdge (db::Edge (pl, *cp), p);
+            if (pl.y () == pll.y () && ne.p2 ().x () != pl.x () && ne.p2 ().x () == pll.x ()) {
+              ne = db::Edge (pll, ne.p2 ());
+            } else if (pl.x () == pll.x () && ne.p2 ().y () != pl.y () && ne.p2 ().y () == pll.y ()) {
+              ne = db::Edge (ne.p1 (), pll);
+            } else {
+              pll = pl;
+            }
+            pl = *cp;
+            if (selects_edges || ne.dy () != 0) {
+              if (nw <= n) {
+                (*mp_work_edges) [nw++] = ne;
+              } else {
+                mp_work_edges->push_back (ne);
+              }
+            }
+          }
+        }
+
+        if (cut_points->cut_points.back () != e.p2 ()) {
+          WorkEdge ne = WorkEdge (db::Edge (pl, e.p2 ()), p);
+          if (pl.y () == pll.y () && ne.p2 ().x () != pl.x () && ne.p2 ().x () == pll.x ()) {
+            ne = db::Edge (pll, ne.p2 ());
+          } else if (pl.x () == pll.x () && ne.p2 ().y () != pl.y () && ne.p2 ().y () == pll.y ()) {
+            ne = db::Edge (ne.p1 (), pll);
+          }
+          if (selects_edges || ne.dy () != 0) {
+            if (nw <= n) {
+              (*mp_work_edges) [nw++] = ne;
+            } else {
+              mp_work_edges->push_back (ne);
+            }
+          }
+        }
+
+      } else {
+
+        if (nw < n) {
+          (*mp_work_edges) [nw] = (*mp_work_edges) [n];
+        }
+        ++nw;
+
+      }
+
+    } else {
+
+      if (nw < n) {
+        (*mp_work_edges) [nw] = (*mp_work_edges) [n];
+      }
+      ++nw;
+
+    }
+
+  }
+
+  if (nw != n_work) {
+    mp_work_edges->erase (mp_work_edges->begin () + nw, mp_work_edges->begin () + n_work);
+  }
+
+#ifdef DEBUG_EDGE_PROCESSOR
+  printf ("Output edges:\n");
+  for (std::vector <WorkEdge>::iterator c1 = mp_work_edges->begin (); c1 != mp_work_edges->end (); ++c1) { 
+    printf ("%s\n", c1->to_string().c_str ()); 
+  } 
+#endif
+
+
+  tl::SelfTimer timer2 (tl::verbosity () >= m_base_verbosity + 10, "EdgeProcessor: production");
+
+  //  step 4: compute the result edges 
+  
+  std::sort (mp_work_edges->begin (), mp_work_edges->end (), edge_ymin_compare<db::Coord> ());
+
+  if (m_threads > 1 && mp_work_edges->size () >= min_edges_per_band * 2) {
+
+    std::auto_ptr<EdgeEvaluatorBase> op_proto (op.clone ());
+    if (op_proto.get ()) {
+      es.start ();
+      process_scanlines_mt (*mp_work_edges, m_threads, es, *op_proto, n_props, progress.get (), todo_next, todo_max);
+      es.flush ();
+      return;
+    }
+
+  }
+
+  es.start (); // call this as late as possible. This way, input containers can be identical with output containers ("clear" is done after the input is read)
+
+  op.reset ();
+  op.reserve (n_props);
+
+  process_scanlines (*mp_work_edges, edge_ymin ((*mp_work_edges) [0]), std::numeric_limits<db::Coord>::max (), es, op, progress.get (), todo_next, todo_max);
 
   es.flush ();
 
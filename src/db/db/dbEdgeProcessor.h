@@ -209,6 +209,16 @@ public:
   virtual bool is_reset () const { return false; }
   virtual bool prefer_touch () const { return false; }
   virtual bool selects_edges () const { return false; }
+
+  /**
+   *  @brief Creates a copy of this evaluator
+   *
+   *  The multi-threaded scanline uses one copy of the evaluator per band. Evaluators
+   *  which do not carry state from one scanline to the next can implement this
+   *  method. The default implementation returns 0 which makes the edge processor
+   *  use the single-threaded implementation.
+   */
+  virtual EdgeEvaluatorBase *clone () const { return 0; }
 };
 
 /**
@@ -375,6 +385,11 @@ public:
     return (m_wc_n == 0 && m_wc_s == 0);
   }
 
+  virtual EdgeEvaluatorBase *clone () const
+  {
+    return new GenericMerge<F> (*this);
+  }
+
 private:
   int m_wc_n, m_wc_s;
   F m_function;
@@ -459,6 +474,7 @@ public:
   virtual int edge (bool north, bool enter, property_type p);
   virtual int compare_ns () const;
   virtual bool is_reset () const { return m_zeroes == m_wcv_n.size () + m_wcv_s.size (); }
+  virtual EdgeEvaluatorBase *clone () const { return new BooleanOp (*this); }
 
 protected:
   template <class InsideFunc> bool result (int wca, int wcb, const InsideFunc &inside_a, const InsideFunc &inside_b) const;
@@ -502,6 +518,7 @@ public:
   virtual bool is_reset () const;
   virtual bool prefer_touch () const;
   virtual bool selects_edges () const;
+  virtual EdgeEvaluatorBase *clone () const { return new EdgePolygonOp (*this); }
 
 private:
   bool m_outside, m_include_touching;
@@ -531,6 +548,7 @@ public:
 
   virtual int edge (bool north, bool enter, property_type p);
   virtual int compare_ns () const;
+  virtual EdgeEvaluatorBase *clone () const { return new BooleanOp2 (*this); }
 
 private:
   int m_wc_mode_a, m_wc_mode_b;
@@ -561,6 +579,7 @@ public:
   virtual int edge (bool north, bool enter, property_type p);
   virtual int compare_ns () const;
   virtual bool is_reset () const { return m_zeroes == m_wcv_n.size () + m_wcv_s.size (); }
+  virtual EdgeEvaluatorBase *clone () const { return new MergeOp (*this); }
 
 private:
   int m_wc_n, m_wc_s;
@@ -614,6 +633,41 @@ public:
    */
   void set_base_verbosity (int bv);
 
+  /**
+   *  @brief Sets the number of threads to use for the scanline sweep
+   *
+   *  With more than one thread, the edges are partitioned into horizontal bands
+   *  which are swept in parallel. The output of the bands is delivered to the
+   *  edge sink in scanline order, so the result is the same as for the single-threaded
+   *  sweep. This mode requires an evaluator which implements "clone" and is used
+   *  for larger edge sets only.
+   *
+   *  The default value is taken from "default_threads". 0 or 1 disables the
+   *  multi-threaded mode.
+   */
+  void set_threads (unsigned int n);
+
+  /**
+   *  @brief Gets the number of threads to use for the scanline sweep
+   */
+  unsigned int threads () const
+  {
+    return m_threads;
+  }
+
+  /**
+   *  @brief Sets the default number of threads for newly created edge processors
+   *
+   *  This is a global setting which allows enabling the multi-threaded sweep
+   *  for all flat operations. The initial value is 0 (single-threaded).
+   */
+  static void set_default_threads (unsigned int n);
+
+  /**
+   *  @brief Gets the default number of threads for newly created edge processors
+   */
+  static unsigned int default_threads ();
+
   /**
    *  @brief Reserve space for at least n edges
    */
@@ -952,6 +1006,7 @@ private:
   bool m_report_progress;
   std::string m_progress_desc;
   int m_base_verbosity;
+  unsigned int m_threads;
 
   static size_t count_edges (const db::Polygon &q) 
   {
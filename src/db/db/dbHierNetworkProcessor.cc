@@ -38,6 +38,7 @@
 #include <map>
 #include <list>
 #include <set>
+#include <algorithm>
 
 namespace db
 {
@@ -1239,6 +1240,52 @@ private:
   const hier_clusters<T> *mp_tree;
 };
 
+// ------------------------------------------------------------------------------
+//  local_clusters_computation_task implementation
+
+template <class T>
+local_clusters_computation_task<T>::local_clusters_computation_task (hier_clusters<T> *hc, const db::Layout &layout, const db::Cell &cell, const db::Connectivity &conn, const tl::equivalence_clusters<size_t> *attr_equivalence)
+  : mp_hc (hc), mp_layout (&layout), mp_cell (&cell), mp_conn (&conn), mp_attr_equivalence (attr_equivalence)
+{
+  //  .. nothing yet ..
+}
+
+template <class T>
+void
+local_clusters_computation_task<T>::perform ()
+{
+  mp_hc->build_local_cluster (*mp_layout, *mp_cell, *mp_conn, mp_attr_equivalence);
+  mp_hc->next_progress ();
+}
+
+//  explicit instantiations
+template class DB_PUBLIC local_clusters_computation_task<db::NetShape>;
+template class DB_PUBLIC local_clusters_computation_task<db::PolygonRef>;
+template class DB_PUBLIC local_clusters_computation_task<db::Edge>;
+
+// ------------------------------------------------------------------------------
+//  hier_clusters_connection_task implementation
+
+template <class T>
+hier_clusters_connection_task<T>::hier_clusters_connection_task (hier_clusters<T> *hc, cell_clusters_box_converter<T> *cbc, const db::Layout &layout, const db::Cell &cell, const db::Connectivity &conn, const std::set<db::cell_index_type> *breakout_cells)
+  : mp_hc (hc), mp_cbc (cbc), mp_layout (&layout), mp_cell (&cell), mp_conn (&conn), mp_breakout_cells (breakout_cells)
+{
+  //  .. nothing yet ..
+}
+
+template <class T>
+void
+hier_clusters_connection_task<T>::perform (instance_interaction_cache_type &instance_interaction_cache)
+{
+  mp_hc->build_hier_connections (*mp_cbc, *mp_layout, *mp_cell, *mp_conn, mp_breakout_cells, instance_interaction_cache, false);
+  mp_hc->next_progress ();
+}
+
+//  explicit instantiations
+template class DB_PUBLIC hier_clusters_connection_task<db::NetShape>;
+template class DB_PUBLIC hier_clusters_connection_task<db::PolygonRef>;
+template class DB_PUBLIC hier_clusters_connection_task<db::Edge>;
+
 // ------------------------------------------------------------------------------
 //  hier_clusters implementation
 
@@ -1247,7 +1294,7 @@ const db::cell_index_type hier_clusters<T>::top_cell_index = std::numeric_limits
 
 template <class T>
 hier_clusters<T>::hier_clusters ()
-  : m_base_verbosity (20)
+  : m_base_verbosity (20), m_nthreads (0), m_progress (0)
 {
   //  .. nothing yet ..
 }
@@ -1264,6 +1311,45 @@ void hier_clusters<T>::clear ()
   m_per_cell_clusters.clear ();
 }
 
+static tl::Mutex s_progress_lock;
+
+template <class T>
+void hier_clusters<T>::next_progress ()
+{
+  tl::MutexLocker locker (&s_progress_lock);
+  ++m_progress;
+}
+
+template <class T>
+size_t hier_clusters<T>::get_progress () const
+{
+  tl::MutexLocker locker (&s_progress_lock);
+  return m_progress;
+}
+
+template <class T>
+void hier_clusters<T>::run_job (tl::JobBase &job, tl::RelativeProgress &progress)
+{
+  try {
+
+    job.start ();
+    while (! job.wait (10)) {
+      //  This may throw an exception, if the cancel button has been pressed.
+      progress.set (get_progress ());
+    }
+
+  } catch (...) {
+    job.terminate ();
+    throw;
+  }
+
+  if (job.has_error ()) {
+    throw tl::Exception (tl::to_string (tr ("Errors occurred during processing. First error message says:\n")) + job.error_messages ().front ());
+  }
+
+  progress.set (get_progress ());
+}
+
 template <class T>
 void
 hier_clusters<T>::build (const db::Layout &layout, const db::Cell &cell, const db::Connectivity &conn, const std::map<db::cell_index_type, tl::equivalence_clusters<size_t> > *attr_equivalence, const std::set<db::cell_index_type> *breakout_cells)
@@ -2097,6 +2183,13 @@ hier_clusters<T>::do_build (cell_clusters_box_converter<T> &cbc, const db::Layou
     tl::SelfTimer timer (tl::verbosity () > m_base_verbosity + 10, tl::to_string (tr ("Computing local shape clusters")));
     tl::RelativeProgress progress (tl::to_string (tr ("Computing local clusters")), called.size (), 1);
 
+    //  the local clusters of the cells are independent, so they can be computed in parallel
+    std::auto_ptr<tl::Job<local_clusters_computation_worker<T> > > job;
+    if (m_nthreads > 1) {
+      job.reset (new tl::Job<local_clusters_computation_worker<T> > (m_nthreads));
+      m_progress = 0;
+    }
+
     for (std::set<db::cell_index_type>::const_iterator c = called.begin (); c != called.end (); ++c) {
 
       //  look for the net label joining spec - for the top cell the "top_cell_index" entry is looked for.
@@ -2118,10 +2211,19 @@ hier_clusters<T>::do_build (cell_clusters_box_converter<T> &cbc, const db::Layou
         }
       }
 
-      build_local_cluster (layout, layout.cell (*c), conn, ec);
+      if (job.get ()) {
+        //  NOTE: the cluster objects are created here, so the tasks don't need to modify the map
+        m_per_cell_clusters [*c];
+        job->schedule (new local_clusters_computation_task<T> (this, layout, layout.cell (*c), conn, ec));
+      } else {
+        build_local_cluster (layout, layout.cell (*c), conn, ec);
+        ++progress;
+      }
 
-      ++progress;
+    }
 
+    if (job.get ()) {
+      run_job (*job, progress);
     }
   }
 
@@ -2133,6 +2235,23 @@ hier_clusters<T>::do_build (cell_clusters_box_converter<T> &cbc, const db::Layou
     tl::SelfTimer timer (tl::verbosity () > m_base_verbosity + 10, tl::to_string (tr ("Computing hierarchical shape clusters")));
     tl::RelativeProgress progress (tl::to_string (tr ("Computing hierarchical clusters")), called.size (), 1);
 
+    std::auto_ptr<tl::Job<hier_clusters_connection_worker<T> > > job;
+    if (m_nthreads > 1) {
+
+      job.reset (new tl::Job<hier_clusters_connection_worker<T> > (m_nthreads));
+      m_progress = 0;
+
+      //  Building the connections may add clusters to the parents of child cells. As the
+      //  workers must not modify the cluster map, the entries are created here.
+      for (std::set<db::cell_index_type>::const_iterator c = called.begin (); c != called.end (); ++c) {
+        const db::Cell &cell = layout.cell (*c);
+        for (db::Cell::parent_cell_iterator pc = cell.begin_parent_cells (); pc != cell.end_parent_cells (); ++pc) {
+          m_per_cell_clusters [*pc];
+        }
+      }
+
+    }
+
     std::set<db::cell_index_type> done;
     std::vector<db::cell_index_type> todo;
     for (db::Layout::bottom_up_const_iterator c = layout.begin_bottom_up (); c != layout.end_bottom_up (); ++c) {
@@ -2149,7 +2268,7 @@ hier_clusters<T>::do_build (cell_clusters_box_converter<T> &cbc, const db::Layou
           todo.push_back (*c);
         } else {
           tl_assert (! todo.empty ());
-          build_hier_connections_for_cells (cbc, layout, todo, conn, breakout_cells, progress, instance_interaction_cache);
+          build_hier_connections_for_cells (cbc, layout, todo, conn, breakout_cells, progress, instance_interaction_cache, job.get ());
           done.insert (todo.begin (), todo.end ());
           todo.clear ();
           todo.push_back (*c);
@@ -2159,7 +2278,7 @@ hier_clusters<T>::do_build (cell_clusters_box_converter<T> &cbc, const db::Layou
 
     }
 
-    build_hier_connections_for_cells (cbc, layout, todo, conn, breakout_cells, progress, instance_interaction_cache);
+    build_hier_connections_for_cells (cbc, layout, todo, conn, breakout_cells, progress, instance_interaction_cache, job.get ());
   }
 }
 
@@ -2174,16 +2293,88 @@ hier_clusters<T>::build_local_cluster (const db::Layout &layout, const db::Cell
   tl::SelfTimer timer (tl::verbosity () > m_base_verbosity + 20, msg);
 
   connected_clusters<T> &local = m_per_cell_clusters [cell.cell_index ()];
-  local.build_clusters (cell, conn, attr_equivalence, true);
+  local.build_clusters (cell, conn, attr_equivalence, m_nthreads <= 1);
 }
 
 template <class T>
 void
-hier_clusters<T>::build_hier_connections_for_cells (cell_clusters_box_converter<T> &cbc, const db::Layout &layout, const std::vector<db::cell_index_type> &cells, const db::Connectivity &conn, const std::set<db::cell_index_type> *breakout_cells, tl::RelativeProgress &progress, instance_interaction_cache_type &instance_interaction_cache)
+hier_clusters<T>::build_hier_connections_for_cells (cell_clusters_box_converter<T> &cbc, const db::Layout &layout, const std::vector<db::cell_index_type> &cells, const db::Connectivity &conn, const std::set<db::cell_index_type> *breakout_cells, tl::RelativeProgress &progress, instance_interaction_cache_type &instance_interaction_cache, tl::Job<hier_clusters_connection_worker<T> > *job)
 {
+  if (! job) {
+    for (std::vector<db::cell_index_type>::const_iterator c = cells.begin (); c != cells.end (); ++c) {
+      build_hier_connections (cbc, layout, layout.cell (*c), conn, breakout_cells, instance_interaction_cache, true);
+      ++progress;
+    }
+    return;
+  }
+
+  //  Building the connections for a cell modifies the clusters of the cell, of its child cells
+  //  and of the parents of these child cells. Cells modifying the same clusters are put into
+  //  subsequent rounds, so they are computed in the original order. The cells of one round
+  //  are computed in parallel.
+
+  std::vector<std::vector<db::cell_index_type> > rounds;
+  std::map<db::cell_index_type, size_t> next_round;
+
   for (std::vector<db::cell_index_type>::const_iterator c = cells.begin (); c != cells.end (); ++c) {
-    build_hier_connections (cbc, layout, layout.cell (*c), conn, breakout_cells, instance_interaction_cache);
-    ++progress;
+
+    const db::Cell &cell = layout.cell (*c);
+
+    std::set<db::cell_index_type> touched;
+    cell.collect_called_cells (touched);
+    std::vector<db::cell_index_type> called (touched.begin (), touched.end ());
+    for (std::vector<db::cell_index_type>::const_iterator cc = called.begin (); cc != called.end (); ++cc) {
+      const db::Cell &child_cell = layout.cell (*cc);
+      touched.insert (child_cell.begin_parent_cells (), child_cell.end_parent_cells ());
+    }
+    touched.insert (*c);
+
+    size_t round = 0;
+    for (std::set<db::cell_index_type>::const_iterator t = touched.begin (); t != touched.end (); ++t) {
+      std::map<db::cell_index_type, size_t>::const_iterator nr = next_round.find (*t);
+      if (nr != next_round.end ()) {
+        round = std::max (round, nr->second);
+      }
+    }
+
+    for (std::set<db::cell_index_type>::const_iterator t = touched.begin (); t != touched.end (); ++t) {
+      next_round [*t] = round + 1;
+    }
+
+    if (rounds.size () <= round) {
+      rounds.resize (round + 1);
+    }
+    rounds [round].push_back (*c);
+
+  }
+
+  for (std::vector<std::vector<db::cell_index_type> >::const_iterator r = rounds.begin (); r != rounds.end (); ++r) {
+
+    if (r->size () == 1) {
+
+      build_hier_connections (cbc, layout, layout.cell (r->front ()), conn, breakout_cells, instance_interaction_cache, true);
+      next_progress ();
+      progress.set (get_progress ());
+
+    } else {
+
+      //  NOTE: the box converter caches the cell boxes. The boxes of the child cells are computed
+      //  here, so the workers only read from this cache.
+      for (std::vector<db::cell_index_type>::const_iterator c = r->begin (); c != r->end (); ++c) {
+        const db::Cell &cell = layout.cell (*c);
+        for (db::Cell::child_cell_iterator cc = cell.begin_child_cells (); ! cc.at_end (); ++cc) {
+          cbc (*cc);
+        }
+      }
+
+      for (std::vector<db::cell_index_type>::const_iterator c = r->begin (); c != r->end (); ++c) {
+        job->schedule (new hier_clusters_connection_task<T> (this, &cbc, layout, layout.cell (*c), conn, breakout_cells));
+      }
+
+      run_job (*job, progress);
+
+    }
+
   }
 }
 
@@ -2266,7 +2457,7 @@ private:
 
 template <class T>
 void
-hier_clusters<T>::build_hier_connections (cell_clusters_box_converter<T> &cbc, const db::Layout &layout, const db::Cell &cell, const db::Connectivity &conn, const std::set<db::cell_index_type> *breakout_cells, instance_interaction_cache_type &instance_interaction_cache)
+hier_clusters<T>::build_hier_connections (cell_clusters_box_converter<T> &cbc, const db::Layout &layout, const db::Cell &cell, const db::Connectivity &conn, const std::set<db::cell_index_type> *breakout_cells, instance_interaction_cache_type &instance_interaction_cache, bool report_progress)
 {
   std::string msg = tl::to_string (tr ("Computing hierarchical clusters for cell: ")) + std::string (layout.cell_name (cell.cell_index ()));
   if (tl::verbosity () >= m_base_verbosity + 20) {
@@ -2303,7 +2494,7 @@ hier_clusters<T>::build_hier_connections (cell_clusters_box_converter<T> &cbc, c
     static std::string desc = tl::to_string (tr ("Instance to instance treatment"));
     tl::SelfTimer timer (tl::verbosity () > m_base_verbosity + 30, desc);
 
-    db::box_scanner<db::Instance, unsigned int> bs (true, desc);
+    db::box_scanner<db::Instance, unsigned int> bs (report_progress, desc);
 
     for (std::vector<db::Instance>::const_iterator inst = inst_storage.begin (); inst != inst_storage.end (); ++inst) {
       if (! is_breakout_cell (breakout_cells, inst->cell_index ())) {
@@ -2323,7 +2514,7 @@ hier_clusters<T>::build_hier_connections (cell_clusters_box_converter<T> &cbc, c
     static std::string desc = tl::to_string (tr ("Local to instance treatment"));
     tl::SelfTimer timer (tl::verbosity () > m_base_verbosity + 30, desc);
 
-    db::box_scanner2<db::local_cluster<T>, unsigned int, db::Instance, unsigned int> bs2 (true, desc);
+    db::box_scanner2<db::local_cluster<T>, unsigned int, db::Instance, unsigned int> bs2 (report_progress, desc);
 
     for (typename connected_clusters<T>::const_iterator c = local.begin (); c != local.end (); ++c) {
 
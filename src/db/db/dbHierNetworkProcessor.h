@@ -32,6 +32,7 @@
 #include "dbInstElement.h"
 #include "tlEquivalenceClusters.h"
 #include "tlAssert.h"
+#include "tlThreadedWorkers.h"
 
 #include <map>
 #include <list>
@@ -1022,6 +1023,92 @@ private:
 };
 
 template <typename> class cell_clusters_box_converter;
+template <typename> class hier_clusters;
+
+/**
+ *  @brief A task computing the local clusters of one cell
+ */
+template <class T>
+class DB_PUBLIC local_clusters_computation_task
+  : public tl::Task
+{
+public:
+  local_clusters_computation_task (hier_clusters<T> *hc, const db::Layout &layout, const db::Cell &cell, const db::Connectivity &conn, const tl::equivalence_clusters<size_t> *attr_equivalence);
+  void perform ();
+
+private:
+  hier_clusters<T> *mp_hc;
+  const db::Layout *mp_layout;
+  const db::Cell *mp_cell;
+  const db::Connectivity *mp_conn;
+  const tl::equivalence_clusters<size_t> *mp_attr_equivalence;
+};
+
+/**
+ *  @brief The worker for the local cluster computation tasks
+ */
+template <class T>
+class DB_PUBLIC local_clusters_computation_worker
+  : public tl::Worker
+{
+public:
+  local_clusters_computation_worker ()
+    : tl::Worker ()
+  {
+    //  .. nothing yet ..
+  }
+
+  void perform_task (tl::Task *task)
+  {
+    static_cast<local_clusters_computation_task<T> *> (task)->perform ();
+  }
+};
+
+/**
+ *  @brief A task computing the hierarchical connections of one cell
+ */
+template <class T>
+class DB_PUBLIC hier_clusters_connection_task
+  : public tl::Task
+{
+public:
+  hier_clusters_connection_task (hier_clusters<T> *hc, cell_clusters_box_converter<T> *cbc, const db::Layout &layout, const db::Cell &cell, const db::Connectivity &conn, const std::set<db::cell_index_type> *breakout_cells);
+  void perform (instance_interaction_cache_type &instance_interaction_cache);
+
+private:
+  hier_clusters<T> *mp_hc;
+  cell_clusters_box_converter<T> *mp_cbc;
+  const db::Layout *mp_layout;
+  const db::Cell *mp_cell;
+  const db::Connectivity *mp_conn;
+  const std::set<db::cell_index_type> *mp_breakout_cells;
+};
+
+/**
+ *  @brief The worker for the hierarchical connection tasks
+ *
+ *  Each worker keeps its own instance interaction cache, so the workers don't
+ *  need to share it.
+ */
+template <class T>
+class DB_PUBLIC hier_clusters_connection_worker
+  : public tl::Worker
+{
+public:
+  hier_clusters_connection_worker ()
+    : tl::Worker ()
+  {
+    //  .. nothing yet ..
+  }
+
+  void perform_task (tl::Task *task)
+  {
+    static_cast<hier_clusters_connection_task<T> *> (task)->perform (m_instance_interaction_cache);
+  }
+
+private:
+  instance_interaction_cache_type m_instance_interaction_cache;
+};
 
 /**
  *  @brief A hierarchical representation of clusters
@@ -1049,6 +1136,29 @@ public:
    */
   void set_base_verbosity (int bv);
 
+  /**
+   *  @brief Sets the number of threads to use
+   *
+   *  With a thread count of 0 (the default) or 1, the clusters are computed in the calling thread.
+   *  Otherwise, the local clusters of the cells are computed in parallel. The hierarchical
+   *  connections are computed bottom-up, hierarchy level by hierarchy level. Inside a level,
+   *  cells are computed in parallel unless they share child cells. Such cells are computed
+   *  one after another as building the connections of one cell modifies the clusters of
+   *  the child cells and of their parents.
+   */
+  void set_threads (unsigned int nthreads)
+  {
+    m_nthreads = nthreads;
+  }
+
+  /**
+   *  @brief Gets the number of threads to use
+   */
+  unsigned int threads () const
+  {
+    return m_nthreads;
+  }
+
   /**
    *  @brief A constant indicating the top cell for the equivalence cluster key
    */
@@ -1095,13 +1205,21 @@ public:
   size_t propagate_cluster_inst (const db::Layout &layout, const Cell &cell, const ClusterInstance &ci, db::cell_index_type parent_ci, bool with_self);
 
 private:
+  friend class local_clusters_computation_task<T>;
+  friend class hier_clusters_connection_task<T>;
+
   void build_local_cluster (const db::Layout &layout, const db::Cell &cell, const db::Connectivity &conn, const tl::equivalence_clusters<size_t> *attr_equivalence);
-  void build_hier_connections (cell_clusters_box_converter<T> &cbc, const db::Layout &layout, const db::Cell &cell, const db::Connectivity &conn, const std::set<cell_index_type> *breakout_cells, instance_interaction_cache_type &instance_interaction_cache);
-  void build_hier_connections_for_cells (cell_clusters_box_converter<T> &cbc, const db::Layout &layout, const std::vector<db::cell_index_type> &cells, const db::Connectivity &conn, const std::set<cell_index_type> *breakout_cells, tl::RelativeProgress &progress, instance_interaction_cache_type &instance_interaction_cache);
+  void build_hier_connections (cell_clusters_box_converter<T> &cbc, const db::Layout &layout, const db::Cell &cell, const db::Connectivity &conn, const std::set<cell_index_type> *breakout_cells, instance_interaction_cache_type &instance_interaction_cache, bool report_progress);
+  void build_hier_connections_for_cells (cell_clusters_box_converter<T> &cbc, const db::Layout &layout, const std::vector<db::cell_index_type> &cells, const db::Connectivity &conn, const std::set<cell_index_type> *breakout_cells, tl::RelativeProgress &progress, instance_interaction_cache_type &instance_interaction_cache, tl::Job<hier_clusters_connection_worker<T> > *job);
   void do_build (cell_clusters_box_converter<T> &cbc, const db::Layout &layout, const db::Cell &cell, const db::Connectivity &conn, const std::map<cell_index_type, tl::equivalence_clusters<size_t> > *attr_equivalence, const std::set<cell_index_type> *breakout_cells);
+  void run_job (tl::JobBase &job, tl::RelativeProgress &progress);
+  void next_progress ();
+  size_t get_progress () const;
 
   std::map<db::cell_index_type, connected_clusters<T> > m_per_cell_clusters;
   int m_base_verbosity;
+  unsigned int m_nthreads;
+  size_t m_progress;
 };
 
 /**
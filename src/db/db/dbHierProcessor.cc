@@ -30,6 +30,7 @@
 #include "dbLocalOperationUtils.h"
 #include "tlLog.h"
 #include "tlTimer.h"
+#include "tlProfiler.h"
 #include "tlInternational.h"
 
 // ---------------------------------------------------------------------------------------------
@@ -1009,12 +1010,55 @@ template class DB_PUBLIC local_processor_context_computation_task<db::Edge, db::
 template class DB_PUBLIC local_processor_context_computation_task<db::Edge, db::PolygonRef, db::Edge>;
 template class DB_PUBLIC local_processor_context_computation_task<db::Edge, db::Edge, db::EdgePair>;
 
+// ---------------------------------------------------------------------------------------------
+//  LocalProcessorResultComputationDependencies implementation
+
+local_processor_result_computation_dependencies::local_processor_result_computation_dependencies ()
+{
+  //  .. nothing yet ..
+}
+
+void
+local_processor_result_computation_dependencies::add (db::Cell *parent, db::Cell *child)
+{
+  ++m_pending [parent];
+  m_waiting [child].push_back (parent);
+}
+
+bool
+local_processor_result_computation_dependencies::is_waiting (db::Cell *cell) const
+{
+  return m_pending.find (cell) != m_pending.end ();
+}
+
+void
+local_processor_result_computation_dependencies::finished (db::Cell *cell, std::vector<db::Cell *> &ready)
+{
+  tl::MutexLocker locker (&m_lock);
+
+  std::unordered_map<db::Cell *, std::vector<db::Cell *> >::iterator w = m_waiting.find (cell);
+  if (w == m_waiting.end ()) {
+    return;
+  }
+
+  for (std::vector<db::Cell *>::const_iterator p = w->second.begin (); p != w->second.end (); ++p) {
+    std::unordered_map<db::Cell *, size_t>::iterator pending = m_pending.find (*p);
+    tl_assert (pending != m_pending.end ());
+    if (--pending->second == 0) {
+      m_pending.erase (pending);
+      ready.push_back (*p);
+    }
+  }
+
+  m_waiting.erase (w);
+}
+
 // ---------------------------------------------------------------------------------------------
 //  LocalProcessorResultComputationTask implementation
 
 template <class TS, class TI, class TR>
-local_processor_result_computation_task<TS, TI, TR>::local_processor_result_computation_task (const local_processor<TS, TI, TR> *proc, local_processor_contexts<TS, TI, TR> &contexts, db::Cell *cell, local_processor_cell_contexts<TS, TI, TR> *cell_contexts, const local_operation<TS, TI, TR> *op, unsigned int output_layer)
-  : mp_proc (proc), mp_contexts (&contexts), mp_cell (cell), mp_cell_contexts (cell_contexts), mp_op (op), m_output_layer (output_layer)
+local_processor_result_computation_task<TS, TI, TR>::local_processor_result_computation_task (const local_processor<TS, TI, TR> *proc, local_processor_contexts<TS, TI, TR> &contexts, db::Cell *cell, local_processor_cell_contexts<TS, TI, TR> *cell_contexts, const local_operation<TS, TI, TR> *op, unsigned int output_layer, tl::JobBase *job, local_processor_result_computation_dependencies *dependencies)
+  : mp_proc (proc), mp_contexts (&contexts), mp_cell (cell), mp_cell_contexts (cell_contexts), mp_op (op), m_output_layer (output_layer), mp_job (job), mp_dependencies (dependencies)
 {
   //  .. nothing yet ..
 }
@@ -1047,6 +1091,28 @@ local_processor_result_computation_task<TS, TI, TR>::perform ()
 
     mp_contexts->context_map ().erase (mp_cell);
   }
+
+  //  start the computation of the parent cells which are ready now
+  if (mp_dependencies) {
+
+    std::vector<db::Cell *> ready;
+    mp_dependencies->finished (mp_cell, ready);
+
+    for (std::vector<db::Cell *>::const_iterator c = ready.begin (); c != ready.end (); ++c) {
+
+      local_processor_cell_contexts<TS, TI, TR> *cell_contexts = 0;
+      {
+        tl::MutexLocker locker (& mp_contexts->lock ());
+        typename local_processor_contexts<TS, TI, TR>::iterator cpc = mp_contexts->context_map ().find (*c);
+        tl_assert (cpc != mp_contexts->context_map ().end ());
+        cell_contexts = &cpc->second;
+      }
+
+      mp_job->schedule (new local_processor_result_computation_task<TS, TI, TR> (mp_proc, *mp_contexts, *c, cell_contexts, mp_op, m_output_layer, mp_job, mp_dependencies));
+
+    }
+
+  }
 }
 
 template class DB_PUBLIC local_processor_result_computation_task<db::PolygonRef, db::PolygonRef, db::PolygonRef>;
@@ -1114,14 +1180,43 @@ size_t local_processor<TS, TI, TR>::get_progress () const
   return p;
 }
 
+/**
+ *  @brief Gets the number of shapes on the given layer summed over all cells
+ */
+static size_t hier_shape_count (const db::Layout *layout, unsigned int layer)
+{
+  size_t n = 0;
+  for (db::Layout::const_iterator c = layout->begin (); c != layout->end (); ++c) {
+    n += c->shapes (layer).size ();
+  }
+  return n;
+}
+
 template <class TS, class TI, class TR>
 void local_processor<TS, TI, TR>::run (local_operation<TS, TI, TR> *op, unsigned int subject_layer, unsigned int intruder_layer, unsigned int output_layer)
 {
   tl::SelfTimer timer (tl::verbosity () > m_base_verbosity, tl::to_string (tr ("Executing ")) + description (op));
 
+  tl::ProfileScope profile ("local_processor", description (op), m_nthreads);
+  size_t output_count_before = 0;
+  if (profile.is_enabled ()) {
+    size_t input_count = hier_shape_count (mp_subject_layout, subject_layer);
+    if (mp_intruder_layout != mp_subject_layout || intruder_layer != subject_layer) {
+      input_count += hier_shape_count (mp_intruder_layout, intruder_layer);
+    }
+    profile.set_input_count (input_count);
+    output_count_before = hier_shape_count (mp_subject_layout, output_layer);
+  }
+
   local_processor_contexts<TS, TI, TR> contexts;
   compute_contexts (contexts, op, subject_layer, intruder_layer);
   compute_results (contexts, op, output_layer);
+
+  if (profile.is_enabled ()) {
+    //  NOTE: the output layer is not guaranteed to grow, so the difference is clamped at 0
+    size_t output_count_after = hier_shape_count (mp_subject_layout, output_layer);
+    profile.set_output_count (output_count_after > output_count_before ? output_count_after - output_count_before : 0);
+  }
 }
 
 template <class TS, class TI, class TR>
@@ -1476,72 +1571,45 @@ local_processor<TS, TI, TR>::compute_results (local_processor_contexts<TS, TI, T
 
     std::auto_ptr<tl::Job<local_processor_result_computation_worker<TS, TI, TR> > > rc_job (new tl::Job<local_processor_result_computation_worker<TS, TI, TR> > (m_nthreads));
 
-    //  schedule computation jobs in "waves": we need to make sure they are executed
-    //  bottom-up. So we identify a new bunch of cells each time we pass through the cell set
-    //  and proceed until all cells are removed.
-
-    std::vector<db::cell_index_type> cells_bu;
-    cells_bu.reserve (mp_subject_layout->cells ());
-    for (db::Layout::bottom_up_const_iterator bu = mp_subject_layout->begin_bottom_up (); bu != mp_subject_layout->end_bottom_up (); ++bu) {
-      cells_bu.push_back (*bu);
-    }
-
-    int iter = 0;
-    while (true) {
-
-      ++iter;
-      tl::SelfTimer timer (tl::verbosity () > m_base_verbosity + 10, tl::sprintf (tl::to_string (tr ("Computing results iteration #%d")), iter));
-
-      bool any = false;
-      std::unordered_set<db::cell_index_type> later;
-
-      std::vector<db::cell_index_type> next_cells_bu;
-      next_cells_bu.reserve (cells_bu.size ());
-
-      for (std::vector<db::cell_index_type>::const_iterator bu = cells_bu.begin (); bu != cells_bu.end (); ++bu) {
-
-        typename local_processor_contexts<TS, TI, TR>::iterator cpc = contexts.context_map ().find (&mp_subject_layout->cell (*bu));
-        if (cpc != contexts.context_map ().end ()) {
-
-          if (later.find (*bu) == later.end ()) {
-
-            rc_job->schedule (new local_processor_result_computation_task<TS, TI, TR> (this, contexts, cpc->first, &cpc->second, op, output_layer));
-            any = true;
-
-          } else {
-            next_cells_bu.push_back (*bu);
-          }
+    //  the computation must be done bottom-up: a cell's task is started as soon as the
+    //  tasks of all child cells with contexts are finished. The cells without pending
+    //  child cells are started right away, the others are started by the last child cell's task.
 
-          for (db::Cell::parent_cell_iterator pc = cpc->first->begin_parent_cells (); pc != cpc->first->end_parent_cells (); ++pc) {
-            later.insert (*pc);
-          }
+    local_processor_result_computation_dependencies dependencies;
 
+    for (typename local_processor_contexts<TS, TI, TR>::iterator cpc = contexts.begin (); cpc != contexts.end (); ++cpc) {
+      for (db::Cell::child_cell_iterator cc = cpc->first->begin_child_cells (); ! cc.at_end (); ++cc) {
+        db::Cell *child_cell = &mp_subject_layout->cell (*cc);
+        if (contexts.context_map ().find (child_cell) != contexts.context_map ().end ()) {
+          dependencies.add (cpc->first, child_cell);
         }
-
       }
+    }
 
-      cells_bu.swap (next_cells_bu);
+    for (db::Layout::bottom_up_const_iterator bu = mp_subject_layout->begin_bottom_up (); bu != mp_subject_layout->end_bottom_up (); ++bu) {
 
-      if (! any) {
-        break;
+      db::Cell *cell = &mp_subject_layout->cell (*bu);
+      typename local_processor_contexts<TS, TI, TR>::iterator cpc = contexts.context_map ().find (cell);
+      if (cpc != contexts.context_map ().end () && ! dependencies.is_waiting (cell)) {
+        rc_job->schedule (new local_processor_result_computation_task<TS, TI, TR> (this, contexts, cpc->first, &cpc->second, op, output_layer, rc_job.get (), &dependencies));
       }
 
-      if (rc_job.get ()) {
-
-        try {
-
-          rc_job->start ();
-          while (! rc_job->wait (10)) {
-            progress.set (get_progress ());
-          }
+    }
 
-        } catch (...) {
-          rc_job->terminate ();
-          throw;
-        }
+    try {
 
+      rc_job->start ();
+      while (! rc_job->wait (10)) {
+        progress.set (get_progress ());
       }
 
+    } catch (...) {
+      rc_job->terminate ();
+      throw;
+    }
+
+    if (rc_job->has_error ()) {
+      throw tl::Exception (tl::to_string (tr ("Errors occurred during processing. First error message says:\n")) + rc_job->error_messages ().front ());
     }
 
   } else {
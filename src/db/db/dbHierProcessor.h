@@ -330,12 +330,47 @@ public:
   }
 };
 
+/**
+ *  @brief Tracks the dependencies between the result computation tasks
+ *
+ *  The results of a cell can be computed once the results of all its child cells
+ *  are available. This object keeps the number of pending child cells per cell
+ *  and delivers the cells which become ready when a cell is finished.
+ */
+class DB_PUBLIC local_processor_result_computation_dependencies
+{
+public:
+  local_processor_result_computation_dependencies ();
+
+  /**
+   *  @brief Declares that the parent cell needs to wait for the child cell
+   */
+  void add (db::Cell *parent, db::Cell *child);
+
+  /**
+   *  @brief Returns a value indicating whether the cell needs to wait for other cells
+   */
+  bool is_waiting (db::Cell *cell) const;
+
+  /**
+   *  @brief Reports a cell as finished and delivers the cells which can be computed now
+   *
+   *  This method is thread-safe.
+   */
+  void finished (db::Cell *cell, std::vector<db::Cell *> &ready);
+
+private:
+  tl::Mutex m_lock;
+  std::unordered_map<db::Cell *, size_t> m_pending;
+  std::unordered_map<db::Cell *, std::vector<db::Cell *> > m_waiting;
+};
+
 template <class TS, class TI, class TR>
 class DB_PUBLIC local_processor_result_computation_task
   : public tl::Task
 {
 public:
-  local_processor_result_computation_task (const local_processor<TS, TI, TR> *proc, local_processor_contexts<TS, TI, TR> &contexts, db::Cell *cell, local_processor_cell_contexts<TS, TI, TR> *cell_contexts, const local_operation<TS, TI, TR> *op, unsigned int output_layer);
+  local_processor_result_computation_task (const local_processor<TS, TI, TR> *proc, local_processor_contexts<TS, TI, TR> &contexts, db::Cell *cell, local_processor_cell_contexts<TS, TI, TR> *cell_contexts, const local_operation<TS, TI, TR> *op, unsigned int output_layer, tl::JobBase *job = 0, local_processor_result_computation_dependencies *dependencies = 0);
   void perform ();
 
 private:
@@ -345,6 +380,8 @@ private:
   local_processor_cell_contexts<TS, TI, TR> *mp_cell_contexts;
   const local_operation<TS, TI, TR> *mp_op;
   unsigned int m_output_layer;
+  tl::JobBase *mp_job;
+  local_processor_result_computation_dependencies *mp_dependencies;
 };
 
 template <class TS, class TI, class TR>
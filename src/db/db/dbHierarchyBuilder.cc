@@ -40,10 +40,10 @@ int
 compare_iterators_with_respect_to_target_hierarchy (const db::RecursiveShapeIterator &iter1, const db::RecursiveShapeIterator &iter2)
 {
   if ((iter1.layout () == 0) != (iter2.layout () == 0)) {
-    return (iter1.layout () == 0) < (iter2.layout () == 0);
+    return (iter1.layout () == 0) < (iter2.layout () == 0) ? -1 : 1;
   }
   if ((iter1.top_cell () == 0) != (iter2.top_cell () == 0)) {
-    return (iter1.top_cell () == 0) < (iter2.top_cell () == 0);
+    return (iter1.top_cell () == 0) < (iter2.top_cell () == 0) ? -1 : 1;
   }
 
   //  basic source (layout, top_cell) needs to be the same of course
@@ -321,14 +321,17 @@ struct layer
 
   /**
    *  @brief Restore the sorted state
+   *
+   *  If a scheduler is given, the sorting may be finished only after the
+   *  scheduler has executed all tasks (see db::box_tree_sort_scheduler).
    */
-  void sort () 
+  void sort (db::box_tree_sort_scheduler *scheduler = 0)
   {
     //  only sort if not done already
     if (m_tree_dirty) {
       //  and actually sort the tree
       box_convert bc = box_convert ();
-      m_box_tree.sort (bc);
+      m_box_tree.sort (bc, scheduler);
       m_tree_dirty = false;
     }
   }
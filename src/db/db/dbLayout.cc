@@ -43,6 +43,10 @@
 #include "tlInternational.h"
 #include "tlProgress.h"
 #include "tlAssert.h"
+#include "tlThreadedWorkers.h"
+
+#include <memory>
+#include <algorithm>
 
 
 namespace db
@@ -272,7 +276,8 @@ Layout::Layout (db::Manager *manager)
     m_properties_repository (this),
     m_guiding_shape_layer (-1),
     m_waste_layer (-1),
-    m_editable (db::default_editable_mode ())
+    m_editable (db::default_editable_mode ()),
+    mp_deferred_cell_loader (0)
 {
   // .. nothing yet ..
 }
@@ -287,7 +292,8 @@ Layout::Layout (bool editable, db::Manager *manager)
     m_properties_repository (this),
     m_guiding_shape_layer (-1),
     m_waste_layer (-1),
-    m_editable (editable)
+    m_editable (editable),
+    mp_deferred_cell_loader (0)
 {
   // .. nothing yet ..
 }
@@ -306,7 +312,8 @@ Layout::Layout (const db::Layout &layout)
     m_properties_repository (this),
     m_guiding_shape_layer (-1),
     m_waste_layer (-1),
-    m_editable (layout.m_editable)
+    m_editable (layout.m_editable),
+    mp_deferred_cell_loader (0)
 {
   *this = layout;
 }
@@ -339,6 +346,8 @@ Layout::clear ()
 {
   invalidate_hier ();
 
+  mp_deferred_cell_loader = 0;
+
   m_free_cell_indices.clear ();
   m_cells.clear ();
   m_cells_size = 0;
@@ -357,7 +366,10 @@ Layout::clear ()
   m_cell_names.clear ();
   m_cell_map.clear ();
 
+  //  NOTE: the packing mode is a setting of the layout, hence it is kept
+  bool pack_polygons = m_shape_repository.pack_polygons ();
   m_shape_repository = db::GenericRepository ();
+  m_shape_repository.set_pack_polygons (pack_polygons);
   db::PropertiesRepository empty_pr (this);
   m_properties_repository = empty_pr;
   m_array_repository = db::ArrayRepository ();
@@ -375,6 +387,116 @@ Layout::clear ()
   m_meta_info.clear ();
 }
 
+/**
+ *  @brief The layout whose deferred cells are loaded by the current thread
+ *
+ *  This is used to ignore shape requests issued by the loader itself.
+ */
+static tl::ThreadStorage<const Layout *> s_loading_deferred_cells;
+
+static const Layout *layout_loading_deferred_cells ()
+{
+  return s_loading_deferred_cells.hasLocalData () ? s_loading_deferred_cells.localData () : 0;
+}
+
+static void set_layout_loading_deferred_cells (const Layout *layout)
+{
+  if (s_loading_deferred_cells.hasLocalData ()) {
+    s_loading_deferred_cells.localData () = layout;
+  } else {
+    s_loading_deferred_cells.setLocalData (layout);
+  }
+}
+
+void
+Layout::set_deferred_cell_loader (DeferredCellLoader *loader)
+{
+  tl::MutexLocker locker (&m_deferred_cell_lock);
+
+  if (loader != mp_deferred_cell_loader) {
+
+    //  cells waiting for the previous loader will not receive their shapes anymore
+    for (iterator c = begin (); c != end (); ++c) {
+      c->set_deferred_shapes (false);
+    }
+
+    mp_deferred_cell_loader = loader;
+
+  }
+}
+
+void
+Layout::load_deferred_cell (cell_index_type cell_index)
+{
+  std::set<cell_index_type> cells;
+  cells.insert (cell_index);
+  load_deferred_cells (cells);
+}
+
+void
+Layout::load_deferred_cells (const std::set<cell_index_type> &cells)
+{
+  //  shapes requested while loading are delivered by the loader itself
+  if (layout_loading_deferred_cells () == this) {
+    return;
+  }
+
+  tl::MutexLocker locker (&m_deferred_cell_lock);
+
+  if (! mp_deferred_cell_loader) {
+    return;
+  }
+
+  std::vector<std::pair<cell_index_type, Cell::box_map> > to_load;
+  for (std::set<cell_index_type>::const_iterator c = cells.begin (); c != cells.end (); ++c) {
+    if (is_valid_cell_index (*c) && cell (*c).has_deferred_shapes ()) {
+      to_load.push_back (std::make_pair (*c, Cell::box_map ()));
+      const Cell::box_map *bboxes = mp_deferred_cell_loader->deferred_bboxes (*c);
+      if (bboxes) {
+        to_load.back ().second = *bboxes;
+      }
+    }
+  }
+
+  if (to_load.empty ()) {
+    return;
+  }
+
+  std::set<cell_index_type> cells_to_load;
+  for (std::vector<std::pair<cell_index_type, Cell::box_map> >::const_iterator c = to_load.begin (); c != to_load.end (); ++c) {
+    cells_to_load.insert (c->first);
+    cell (c->first).begin_load_deferred_shapes (c->second);
+  }
+
+  set_layout_loading_deferred_cells (this);
+
+  try {
+
+    mp_deferred_cell_loader->load_deferred_cells (*this, cells_to_load);
+
+    set_layout_loading_deferred_cells (0);
+
+    for (std::vector<std::pair<cell_index_type, Cell::box_map> >::const_iterator c = to_load.begin (); c != to_load.end (); ++c) {
+      cell (c->first).end_load_deferred_shapes (c->second);
+    }
+
+  } catch (...) {
+
+    set_layout_loading_deferred_cells (0);
+
+    //  leave the cells with what has been loaded so far - the bounding boxes no longer
+    //  include the shapes which have not been loaded
+    invalidate_bboxes (std::numeric_limits<unsigned int>::max ());
+    for (std::vector<std::pair<cell_index_type, Cell::box_map> >::const_iterator c = to_load.begin (); c != to_load.end (); ++c) {
+      cell (c->first).end_load_deferred_shapes (c->second);
+      cell (c->first).m_bbox_needs_update = true;
+    }
+
+    throw;
+
+  }
+}
+
 Layout &
 Layout::operator= (const Layout &d)
 {
@@ -1361,6 +1483,218 @@ Layout::update () const
   }
 }
 
+// -----------------------------------------------------------------
+//  Multi-threaded sorting of the shapes
+
+static unsigned int s_update_threads = 0;
+
+//  The minimum number of shapes to sort for using the multi-threaded mode
+const size_t min_shapes_for_parallel_sort = 100000;
+
+//  The number of tasks per thread the cells are distributed over
+const size_t sort_tasks_per_thread = 16;
+
+void
+Layout::set_update_threads (unsigned int n)
+{
+  s_update_threads = n;
+}
+
+unsigned int
+Layout::update_threads ()
+{
+  return s_update_threads;
+}
+
+/**
+ *  @brief A task sorting the shapes of a range of cells
+ */
+class LayoutSortCellsTask
+  : public tl::Task
+{
+public:
+  LayoutSortCellsTask (const std::vector<db::Cell *> &cells)
+    : m_cells (cells)
+  {
+    //  .. nothing yet ..
+  }
+
+  const std::vector<db::Cell *> &cells () const
+  {
+    return m_cells;
+  }
+
+private:
+  std::vector<db::Cell *> m_cells;
+};
+
+/**
+ *  @brief A task sorting a subtree of a large shape tree
+ */
+class LayoutSortSubtreeTask
+  : public tl::Task
+{
+public:
+  LayoutSortSubtreeTask (db::box_tree_sort_task *task)
+    : mp_task (task)
+  {
+    //  .. nothing yet ..
+  }
+
+  db::box_tree_sort_task *task () const
+  {
+    return mp_task.get ();
+  }
+
+private:
+  std::auto_ptr<db::box_tree_sort_task> mp_task;
+};
+
+/**
+ *  @brief The job for sorting the shapes
+ *
+ *  The job also acts as the scheduler for the subtrees of large shape trees.
+ *  These are scheduled as tasks from within the worker threads and are executed
+ *  by the worker which created them, unless stolen by an idle worker.
+ */
+class LayoutSortJob
+  : public tl::JobBase
+{
+public:
+  LayoutSortJob (int nworkers)
+    : tl::JobBase (nworkers), m_scheduler (this), m_cells_done (0)
+  {
+    //  .. nothing yet ..
+  }
+
+  db::box_tree_sort_scheduler *scheduler ()
+  {
+    return &m_scheduler;
+  }
+
+  void cells_done (size_t n)
+  {
+    tl::MutexLocker locker (&m_mutex);
+    m_cells_done += n;
+  }
+
+  size_t cells_done ()
+  {
+    tl::MutexLocker locker (&m_mutex);
+    return m_cells_done;
+  }
+
+  virtual tl::Worker *create_worker ();
+
+private:
+  class Scheduler
+    : public db::box_tree_sort_scheduler
+  {
+  public:
+    Scheduler (LayoutSortJob *job)
+      : mp_job (job)
+    { }
+
+    virtual void schedule (db::box_tree_sort_task *task)
+    {
+      mp_job->schedule (new LayoutSortSubtreeTask (task));
+    }
+
+  private:
+    LayoutSortJob *mp_job;
+  };
+
+  Scheduler m_scheduler;
+  size_t m_cells_done;
+  tl::Mutex m_mutex;
+};
+
+/**
+ *  @brief The worker for sorting the shapes
+ */
+class LayoutSortWorker
+  : public tl::Worker
+{
+public:
+  LayoutSortWorker (LayoutSortJob *job)
+    : tl::Worker (), mp_job (job)
+  {
+    //  .. nothing yet ..
+  }
+
+  void perform_task (tl::Task *task)
+  {
+    LayoutSortCellsTask *cells_task = dynamic_cast <LayoutSortCellsTask *> (task);
+    if (cells_task) {
+      for (std::vector<db::Cell *>::const_iterator c = cells_task->cells ().begin (); c != cells_task->cells ().end (); ++c) {
+        (*c)->sort_shapes (mp_job->scheduler ());
+      }
+      mp_job->cells_done (cells_task->cells ().size ());
+      return;
+    }
+
+    LayoutSortSubtreeTask *subtree_task = dynamic_cast <LayoutSortSubtreeTask *> (task);
+    if (subtree_task) {
+      subtree_task->task ()->run (mp_job->scheduler ());
+    }
+  }
+
+private:
+  LayoutSortJob *mp_job;
+};
+
+tl::Worker *
+LayoutSortJob::create_worker ()
+{
+  return new LayoutSortWorker (this);
+}
+
+/**
+ *  @brief Sorts the shapes of all cells on multiple threads
+ *
+ *  The cells are distributed over a number of tasks. Inside these tasks, large shape
+ *  trees are sorted by forking subtree tasks.
+ */
+static void
+sort_shapes_mt (db::Layout &layout, unsigned int threads, tl::RelativeProgress *progress)
+{
+  LayoutSortJob job ((int) threads);
+
+  size_t cells_per_task = std::max (size_t (1), layout.cells () / (size_t (threads) * sort_tasks_per_thread));
+
+  std::vector<db::Cell *> cells;
+  cells.reserve (cells_per_task);
+
+  for (db::Layout::bottom_up_iterator c = layout.begin_bottom_up (); c != layout.end_bottom_up (); ++c) {
+    cells.push_back (&layout.cell (*c));
+    if (cells.size () >= cells_per_task) {
+      job.schedule (new LayoutSortCellsTask (cells));
+      cells.clear ();
+    }
+  }
+  if (! cells.empty ()) {
+    job.schedule (new LayoutSortCellsTask (cells));
+  }
+
+  try {
+
+    job.start ();
+    while (job.is_running ()) {
+      //  This may throw an exception, if the cancel button has been pressed.
+      progress->set (job.cells_done ());
+      job.wait (100);
+    }
+
+  } catch (...) {
+    job.terminate ();
+    throw;
+  }
+
+  if (job.has_error ()) {
+    throw tl::Exception (tl::to_string (tr ("Errors occurred during sorting. First error message says:\n")) + job.error_messages ().front ());
+  }
+}
+
 void 
 Layout::do_update ()
 {
@@ -1394,6 +1728,9 @@ Layout::do_update ()
     //  would probably be much faster!
     std::set<cell_index_type> dirty_parents;
 
+    //  the number of shapes in cells with changed shapes - used to decide whether to sort in parallel
+    size_t dirty_shapes = 0;
+
     //  if something on the bboxes (either on shape level or on 
     //  cell bbox level - i.e. by child instances) has been changed,
     //  update the bbox information. In addition sort the shapes
@@ -1409,6 +1746,11 @@ Layout::do_update ()
         for (bottom_up_iterator c = begin_bottom_up (); c != end_bottom_up (); ++c) {
           ++*pr;
           cell_type &cp (cell (*c));
+          if (s_update_threads > 0 && dirty_shapes < min_shapes_for_parallel_sort && cp.is_shape_bbox_dirty () && ! cp.has_deferred_shapes ()) {
+            for (unsigned int l = 0; l < cp.layers (); ++l) {
+              dirty_shapes += cp.shapes (l).size ();
+            }
+          }
           if (cp.is_shape_bbox_dirty () || dirty_parents.find (*c) != dirty_parents.end ()) {
             if (cp.update_bbox (layers)) {
               //  the bounding box has changed - need to insert parents into "dirty parents" list
@@ -1427,10 +1769,14 @@ Layout::do_update ()
         tl::SelfTimer timer (tl::verbosity () > layout_base_verbosity + 10, "Sorting shapes");
         pr->set (0);
         pr->set_desc (tl::to_string (tr ("Sorting shapes")));
-        for (bottom_up_iterator c = begin_bottom_up (); c != end_bottom_up (); ++c) {
-          ++*pr;
-          cell_type &cp (cell (*c));
-          cp.sort_shapes ();
+        if (s_update_threads > 0 && dirty_shapes >= min_shapes_for_parallel_sort) {
+          sort_shapes_mt (*this, s_update_threads, pr);
+        } else {
+          for (bottom_up_iterator c = begin_bottom_up (); c != end_bottom_up (); ++c) {
+            ++*pr;
+            cell_type &cp (cell (*c));
+            cp.sort_shapes ();
+          }
         }
       }
     }
@@ -1550,6 +1896,29 @@ Layout::clear_layer (unsigned int n)
   }
 }
 
+void
+Layout::pack_polygons (unsigned int n)
+{
+  tl_assert (n < layers () && m_layer_states [n] != Free);
+
+  for (iterator c = begin (); c != end (); ++c) {
+    const db::Cell &cc = *c;
+    if (! cc.shapes (n).empty ()) {
+      c->shapes (n).pack_polygons ();
+    }
+  }
+}
+
+void
+Layout::pack_polygons ()
+{
+  for (unsigned int n = 0; n < layers (); ++n) {
+    if (m_layer_states [n] == Normal) {
+      pack_polygons (n);
+    }
+  }
+}
+
 void 
 Layout::delete_layer (unsigned int n)
 {
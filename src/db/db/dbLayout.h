@@ -456,6 +456,39 @@ public:
   virtual std::pair <bool, unsigned int> map_layer (const LayerProperties &lprops) = 0;
 };
 
+/**
+ *  @brief An interface for objects delivering the shapes of cells on demand
+ *
+ *  Readers supporting lazy loading register an object of this kind with the layout
+ *  (see Layout::set_deferred_cell_loader) and mark the cells whose shapes have not been
+ *  read (see Cell::set_deferred_shapes). The shapes of such a cell are loaded when
+ *  they are accessed first.
+ */
+class DB_PUBLIC DeferredCellLoader
+{
+public:
+  /**
+   *  @brief Destructor
+   */
+  virtual ~DeferredCellLoader () { }
+
+  /**
+   *  @brief Loads the shapes of the given cells into the layout
+   *
+   *  This method is called with the layout's deferred cell lock held. The
+   *  implementation should insert the shapes through Cell::shapes.
+   */
+  virtual void load_deferred_cells (db::Layout &layout, const std::set<db::cell_index_type> &cells) = 0;
+
+  /**
+   *  @brief Gets the per-layer bounding boxes of the shapes not loaded yet
+   *
+   *  These boxes are included in the cell's bounding box, so the bounding boxes
+   *  are available without loading the shapes. A null pointer means there are none.
+   */
+  virtual const std::map<unsigned int, db::Box> *deferred_bboxes (db::cell_index_type cell_index) const = 0;
+};
+
 /**
  *  @brief The layout object
  *
@@ -609,6 +642,38 @@ public:
     return m_lock;
   }
 
+  /**
+   *  @brief Sets the loader delivering the shapes of cells with deferred shapes
+   *
+   *  The layout does not take ownership over the loader. When the loader is replaced
+   *  or reset to 0, cells still waiting for their shapes will stay without them.
+   */
+  void set_deferred_cell_loader (DeferredCellLoader *loader);
+
+  /**
+   *  @brief Gets the loader delivering the shapes of cells with deferred shapes
+   */
+  DeferredCellLoader *deferred_cell_loader () const
+  {
+    return mp_deferred_cell_loader;
+  }
+
+  /**
+   *  @brief Loads the shapes of the given cells if they are deferred
+   *
+   *  This method is thread safe. Loading the shapes does not change the bounding
+   *  boxes and does not invalidate the layout, so it is possible to load the shapes
+   *  while other threads read the layout (e.g. while drawing).
+   */
+  void load_deferred_cells (const std::set<cell_index_type> &cells);
+
+  /**
+   *  @brief Loads the shapes of the given cell if they are deferred
+   *
+   *  This method is called by the cell when the shapes are accessed.
+   */
+  void load_deferred_cell (cell_index_type cell_index);
+
   /**
    *  @brief Collect memory statistics
    */
@@ -1251,6 +1316,47 @@ public:
    */
   void clear_layer (unsigned int n);
 
+  /**
+   *  @brief Packs the polygons on the given layer
+   *
+   *  Packing stores the polygon contours in a delta-encoded form which reduces 
+   *  the memory footprint of polygons with many points (see db::polygon_contour::pack). 
+   *  The polygons remain unchanged otherwise.
+   *
+   *  This is a one-time compaction of the present polygons (see Shapes::pack_polygons).
+   *  Polygons added later are not packed. This method must not be called while other
+   *  threads read the shapes. Use \set_pack_polygons_on_insert to pack polygons
+   *  when they are inserted.
+   */
+  void pack_polygons (unsigned int n);
+
+  /**
+   *  @brief Packs the polygons on all layers
+   */
+  void pack_polygons ();
+
+  /**
+   *  @brief Sets a value indicating whether polygons are packed when they are inserted
+   *
+   *  In this mode, polygons and simple polygons inserted into the shape containers
+   *  of this layout and polygons added to the shape repository (through polygon
+   *  references) are stored in packed form (see db::polygon_contour::pack).
+   *  Polygons present already are not affected - unlike \pack_polygons, this
+   *  mode never modifies stored polygons.
+   */
+  void set_pack_polygons_on_insert (bool f)
+  {
+    m_shape_repository.set_pack_polygons (f);
+  }
+
+  /**
+   *  @brief Gets a value indicating whether polygons are packed when they are inserted
+   */
+  bool pack_polygons_on_insert () const
+  {
+    return m_shape_repository.pack_polygons ();
+  }
+
   /**  
    *  @brief Delete a layer
    *
@@ -1500,6 +1606,22 @@ public:
    */
   void force_update ();
 
+  /**
+   *  @brief Sets the number of threads to use for sorting the shapes in "update"
+   *
+   *  This is a global setting. With more than one thread, the shape trees of
+   *  different cells and layers are sorted in parallel, and large trees are
+   *  sorted on multiple threads too. The parallel mode is used only if there is
+   *  a substantial number of shapes to sort.
+   *  The initial value is 0 (single-threaded).
+   */
+  static void set_update_threads (unsigned int n);
+
+  /**
+   *  @brief Gets the number of threads to use for sorting the shapes in "update"
+   */
+  static unsigned int update_threads ();
+
   /**
    *  @brief Cleans up the layout
    *
@@ -1756,6 +1878,8 @@ private:
   bool m_editable;
   meta_info m_meta_info;
   tl::Mutex m_lock;
+  DeferredCellLoader *mp_deferred_cell_loader;
+  tl::Mutex m_deferred_cell_lock;
 
   /**
    *  @brief Sort the cells topologically
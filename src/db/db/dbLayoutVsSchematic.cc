@@ -74,7 +74,25 @@ bool LayoutVsSchematic::compare_netlists (db::NetlistComparer *compare)
     throw tl::Exception (tl::to_string (tr ("The reference netlist has not been set yet")));
   }
 
-  return compare->compare (netlist (), reference_netlist (), make_cross_ref ());
+  //  a repeated compare replaces the previous results
+  db::NetlistCrossReference *xref = make_cross_ref ();
+  xref->clear ();
+
+  if (compare->cache ()) {
+    return compare->compare (netlist (), reference_netlist (), xref);
+  }
+
+  //  use our own cache temporarily
+  compare->set_cache (&m_compare_cache);
+
+  try {
+    bool res = compare->compare (netlist (), reference_netlist (), xref);
+    compare->set_cache (0);
+    return res;
+  } catch (...) {
+    compare->set_cache (0);
+    throw;
+  }
 }
 
 db::NetlistCrossReference *LayoutVsSchematic::make_cross_ref ()
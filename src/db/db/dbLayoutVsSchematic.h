@@ -114,9 +114,21 @@ public:
 
   /**
    *  @brief Performs the comparison
+   *
+   *  If the comparer does not have a compare cache attached, the compare
+   *  cache of this object is used. Hence repeated comparisons of the same
+   *  object only compare the circuits which have changed.
    */
   bool compare_netlists(NetlistComparer *compare);
 
+  /**
+   *  @brief Gets the compare cache used by compare_netlists
+   */
+  db::NetlistCompareCache &compare_cache ()
+  {
+    return m_compare_cache;
+  }
+
   /**
    *  @brief Gets the cross-reference object
    *
@@ -168,6 +180,7 @@ private:
 
   tl::shared_ptr<db::Netlist> mp_reference_netlist;
   tl::shared_ptr<db::NetlistCrossReference> mp_cross_ref;
+  db::NetlistCompareCache m_compare_cache;
 };
 
 }
@@ -29,8 +29,12 @@
 #include "tlLog.h"
 #include "tlEnv.h"
 #include "tlInternational.h"
+#include "tlThreadedWorkers.h"
+#include "tlStream.h"
 
 #include <cstring>
+#include <typeinfo>
+#include <memory>
 
 namespace {
 
@@ -287,6 +291,22 @@ public:
     return i->second;
   }
 
+  const std::map<size_t, size_t> &pin_map () const
+  {
+    return m_pin_map;
+  }
+
+  const std::map<size_t, size_t> &rev_pin_map () const
+  {
+    return m_rev_pin_map;
+  }
+
+  void assign_pin_maps (const std::map<size_t, size_t> &pin_map, const std::map<size_t, size_t> &rev_pin_map)
+  {
+    m_pin_map = pin_map;
+    m_rev_pin_map = rev_pin_map;
+  }
+
 private:
   const db::Circuit *mp_other;
   std::map<size_t, size_t> m_pin_map, m_rev_pin_map;
@@ -834,7 +854,7 @@ public:
   typedef std::vector<edge_type>::const_iterator edge_iterator;
 
   NetGraphNode ()
-    : mp_net (0)
+    : mp_net (0), m_node_class (0)
   {
     //  .. nothing yet ..
   }
@@ -888,6 +908,23 @@ public:
     m_other_net_index = invalid_id;
   }
 
+  /**
+   *  @brief Gets the node class
+   *
+   *  The node class is a hash value computed from the node's neighborhood (see
+   *  NetGraph::refine_node_classes). Nodes with different classes cannot correspond
+   *  to each other.
+   */
+  size_t node_class () const
+  {
+    return m_node_class;
+  }
+
+  void set_node_class (size_t c)
+  {
+    m_node_class = c;
+  }
+
   bool empty () const
   {
     return m_edges.empty ();
@@ -902,6 +939,7 @@ public:
   {
     std::swap (m_other_net_index, other.m_other_net_index);
     std::swap (mp_net, other.mp_net);
+    std::swap (m_node_class, other.m_node_class);
     m_edges.swap (other.m_edges);
   }
 
@@ -928,6 +966,7 @@ public:
 private:
   const db::Net *mp_net;
   size_t m_other_net_index;
+  size_t m_node_class;
   std::vector<edge_type> m_edges;
 
   /**
@@ -1127,6 +1166,22 @@ public:
    */
   size_t derive_node_identities_from_node_set (std::vector<std::pair<const NetGraphNode *, NetGraphNode::edge_iterator> > &nodes, std::vector<std::pair<const NetGraphNode *, NetGraphNode::edge_iterator> > &other_nodes, size_t depth, size_t n_branch, TentativeNodeMapping *tentative, CompareData *data);
 
+  /**
+   *  @brief Computes the node classes of this graph and the other graph
+   *
+   *  This is an iterative neighborhood hashing (Weisfeiler-Lehman) scheme: initially,
+   *  the node class is derived from the node's edges. In each iteration, the classes of
+   *  the neighbor nodes are hashed into the node class. Nodes which are identified already
+   *  act as anchors and carry the same class in both graphs. The iteration stops when
+   *  the number of distinct classes does not increase any longer or after "max_iterations"
+   *  iterations.
+   *
+   *  Corresponding nodes will always have the same class. Hence the classes can be used
+   *  to split ambiguity groups without backtracking. The return value is the number of
+   *  distinct classes.
+   */
+  size_t refine_node_classes (NetGraph *other, size_t max_iterations);
+
 private:
   std::vector<NetGraphNode> m_nodes;
   std::map<const db::SubCircuit *, NetGraphNode> m_virtual_nodes;
@@ -1141,7 +1196,7 @@ private:
 // --------------------------------------------------------------------------------------------------------------------
 
 NetGraphNode::NetGraphNode (const db::Net *net, DeviceCategorizer &device_categorizer, CircuitCategorizer &circuit_categorizer, const DeviceFilter &device_filter, const std::map<const db::Circuit *, CircuitMapper> *circuit_map, const CircuitPinMapper *pin_map)
-  : mp_net (net), m_other_net_index (invalid_id)
+  : mp_net (net), m_other_net_index (invalid_id), m_node_class (0)
 {
   if (! net) {
     return;
@@ -1247,7 +1302,7 @@ NetGraphNode::NetGraphNode (const db::Net *net, DeviceCategorizer &device_catego
 }
 
 NetGraphNode::NetGraphNode (const db::SubCircuit *sc, CircuitCategorizer &circuit_categorizer, const std::map<const db::Circuit *, CircuitMapper> *circuit_map, const CircuitPinMapper *pin_map)
-  : mp_net (0), m_other_net_index (invalid_id)
+  : mp_net (0), m_other_net_index (invalid_id), m_node_class (0)
 {
   std::map<const db::Net *, size_t> n2entry;
 
@@ -1921,6 +1976,171 @@ static bool edges_are_compatible (const NetGraphNode::edge_type &e, const NetGra
   return true;
 }
 
+static inline size_t
+node_class_hash (size_t h, size_t v)
+{
+  //  the usual "hash combine" scheme
+  h ^= v + size_t (0x9e3779b97f4a7c15ull) + (h << 6) + (h >> 2);
+  return h;
+}
+
+static size_t
+transition_class (const NetGraphNode::Transition &t)
+{
+  size_t h = t.is_for_subcircuit () ? 1 : 2;
+  h = node_class_hash (h, t.is_for_subcircuit () ? t.subcircuit_pair ().second : t.device_pair ().second);
+  h = node_class_hash (h, t.id1 ());
+  h = node_class_hash (h, t.id2 ());
+  return h;
+}
+
+static size_t
+edge_class (const NetGraphNode::edge_type &e)
+{
+  //  NOTE: the transitions are sorted by a criterion which is finer than the
+  //  hash value, hence we need to sort the hash values.
+  std::vector<size_t> tc;
+  tc.reserve (e.first.size ());
+  for (std::vector<NetGraphNode::Transition>::const_iterator t = e.first.begin (); t != e.first.end (); ++t) {
+    tc.push_back (transition_class (*t));
+  }
+  std::sort (tc.begin (), tc.end ());
+
+  size_t h = tc.size ();
+  for (std::vector<size_t>::const_iterator i = tc.begin (); i != tc.end (); ++i) {
+    h = node_class_hash (h, *i);
+  }
+  return h;
+}
+
+static void
+initial_node_classes (const NetGraph *g, bool is_other, std::vector<size_t> &classes, std::vector<std::vector<std::pair<size_t, size_t> > > &neighbors)
+{
+  size_t n = g->end () - g->begin ();
+  classes.resize (n, 0);
+  neighbors.resize (n);
+
+  std::vector<size_t> ecs;
+
+  for (size_t i = 0; i < n; ++i) {
+
+    const NetGraphNode &node = g->node (i);
+
+    ecs.clear ();
+
+    std::vector<std::pair<size_t, size_t> > &nb = neighbors [i];
+    for (NetGraphNode::edge_iterator e = node.begin (); e != node.end (); ++e) {
+
+      size_t ec = edge_class (*e);
+      ecs.push_back (ec);
+
+      if (e->second.second || e->first.empty () || ! e->first.front ().is_for_subcircuit ()) {
+        nb.push_back (std::make_pair (ec, e->second.first));
+      } else {
+        //  subcircuit pin edges lead to the other nets of the subcircuit through the virtual node
+        const NetGraphNode &vn = g->virtual_node (e->first.front ().subcircuit_pair ().first);
+        for (NetGraphNode::edge_iterator ve = vn.begin (); ve != vn.end (); ++ve) {
+          if (ve->second.second != node.net ()) {
+            nb.push_back (std::make_pair (node_class_hash (ec, edge_class (*ve)), ve->second.first));
+          }
+        }
+      }
+
+    }
+
+    if (node.has_other ()) {
+      //  identified nodes are anchors: the class is derived from the node index in the first graph
+      classes [i] = node_class_hash (size_t (0x5bd1e995), is_other ? node.other_net_index () : i);
+    } else {
+      std::sort (ecs.begin (), ecs.end ());
+      size_t h = ecs.size ();
+      for (std::vector<size_t>::const_iterator c = ecs.begin (); c != ecs.end (); ++c) {
+        h = node_class_hash (h, *c);
+      }
+      classes [i] = h;
+    }
+
+  }
+}
+
+static void
+next_node_classes (const NetGraph *g, const std::vector<size_t> &classes, const std::vector<std::vector<std::pair<size_t, size_t> > > &neighbors, std::vector<size_t> &new_classes)
+{
+  size_t n = classes.size ();
+  new_classes.resize (n, 0);
+
+  std::vector<size_t> nc;
+
+  for (size_t i = 0; i < n; ++i) {
+
+    if (g->node (i).has_other ()) {
+      new_classes [i] = classes [i];
+      continue;
+    }
+
+    nc.clear ();
+    for (std::vector<std::pair<size_t, size_t> >::const_iterator nb = neighbors [i].begin (); nb != neighbors [i].end (); ++nb) {
+      nc.push_back (node_class_hash (nb->first, classes [nb->second]));
+    }
+    std::sort (nc.begin (), nc.end ());
+
+    size_t h = classes [i];
+    for (std::vector<size_t>::const_iterator c = nc.begin (); c != nc.end (); ++c) {
+      h = node_class_hash (h, *c);
+    }
+    new_classes [i] = h;
+
+  }
+}
+
+static size_t
+count_classes (const std::vector<size_t> &c1, const std::vector<size_t> &c2)
+{
+  std::vector<size_t> c;
+  c.reserve (c1.size () + c2.size ());
+  c.insert (c.end (), c1.begin (), c1.end ());
+  c.insert (c.end (), c2.begin (), c2.end ());
+  std::sort (c.begin (), c.end ());
+  return std::unique (c.begin (), c.end ()) - c.begin ();
+}
+
+size_t
+NetGraph::refine_node_classes (NetGraph *other, size_t max_iterations)
+{
+  std::vector<size_t> c1, c2, nc1, nc2;
+  std::vector<std::vector<std::pair<size_t, size_t> > > nb1, nb2;
+
+  initial_node_classes (this, false, c1, nb1);
+  initial_node_classes (other, true, c2, nb2);
+
+  size_t n = count_classes (c1, c2);
+
+  for (size_t iter = 0; iter < max_iterations; ++iter) {
+
+    next_node_classes (this, c1, nb1, nc1);
+    next_node_classes (other, c2, nb2, nc2);
+
+    size_t nn = count_classes (nc1, nc2);
+    if (nn <= n) {
+      break;
+    }
+
+    c1.swap (nc1);
+    c2.swap (nc2);
+    n = nn;
+
+  }
+
+  for (size_t i = 0; i < c1.size (); ++i) {
+    m_nodes [i].set_node_class (c1 [i]);
+  }
+  for (size_t i = 0; i < c2.size (); ++i) {
+    other->m_nodes [i].set_node_class (c2 [i]);
+  }
+
+  return n;
+}
+
 size_t
 NetGraph::derive_node_identities_for_edges (NetGraphNode::edge_iterator e, NetGraphNode::edge_iterator ee, NetGraphNode::edge_iterator e_other, NetGraphNode::edge_iterator ee_other, size_t net_index, size_t other_net_index, size_t depth, size_t n_branch, TentativeNodeMapping *tentative, CompareData *data)
 {
@@ -2622,6 +2842,88 @@ NetGraph::derive_node_identities_from_singular_match (const NetGraphNode *n, con
   }
 }
 
+struct CompareNodeClass
+{
+  bool operator() (const std::pair<const NetGraphNode *, NetGraphNode::edge_iterator> &a, const std::pair<const NetGraphNode *, NetGraphNode::edge_iterator> &b) const
+  {
+    //  identified nodes go to the end
+    if (a.first->has_other () != b.first->has_other ()) {
+      return a.first->has_other () < b.first->has_other ();
+    }
+    return a.first->node_class () < b.first->node_class ();
+  }
+};
+
+/**
+ *  @brief Returns true if the node group starting at n and ending before nn includes all equivalent nodes
+ */
+static bool
+is_complete_node_range (std::vector<std::pair<const NetGraphNode *, NetGraphNode::edge_iterator> >::const_iterator n,
+                        std::vector<std::pair<const NetGraphNode *, NetGraphNode::edge_iterator> >::const_iterator nn,
+                        std::vector<std::pair<const NetGraphNode *, NetGraphNode::edge_iterator> >::const_iterator end)
+{
+  for ( ; nn != end; ++nn) {
+    if (! nn->first->has_other ()) {
+      return ! (*nn->first == *n->first);
+    }
+  }
+  return true;
+}
+
+/**
+ *  @brief Splits a group of topologically equivalent nodes by node class
+ *
+ *  Returns false if the group does not split into more than one class or if the
+ *  class populations differ between both sides. In that case, the node ranges are
+ *  not modified. Otherwise, the ranges are sorted by class and the sub-ranges are
+ *  delivered in "ranges" together with their member count.
+ */
+static bool
+split_node_range_by_class (std::vector<std::pair<const NetGraphNode *, NetGraphNode::edge_iterator> >::iterator n1, std::vector<std::pair<const NetGraphNode *, NetGraphNode::edge_iterator> >::iterator nn1,
+                           std::vector<std::pair<const NetGraphNode *, NetGraphNode::edge_iterator> >::iterator n2, std::vector<std::pair<const NetGraphNode *, NetGraphNode::edge_iterator> >::iterator nn2,
+                           std::vector<NodeRange> &ranges)
+{
+  std::vector<size_t> c1, c2;
+  for (std::vector<std::pair<const NetGraphNode *, NetGraphNode::edge_iterator> >::iterator i = n1; i != nn1; ++i) {
+    if (! i->first->has_other ()) {
+      c1.push_back (i->first->node_class ());
+    }
+  }
+  for (std::vector<std::pair<const NetGraphNode *, NetGraphNode::edge_iterator> >::iterator i = n2; i != nn2; ++i) {
+    if (! i->first->has_other ()) {
+      c2.push_back (i->first->node_class ());
+    }
+  }
+
+  std::sort (c1.begin (), c1.end ());
+  std::sort (c2.begin (), c2.end ());
+  if (c1 != c2 || c1.empty () || c1.front () == c1.back ()) {
+    return false;
+  }
+
+  std::stable_sort (n1, nn1, CompareNodeClass ());
+  std::stable_sort (n2, nn2, CompareNodeClass ());
+
+  std::vector<size_t>::const_iterator c = c1.begin ();
+  while (c != c1.end ()) {
+
+    std::vector<size_t>::const_iterator cc = c;
+    while (cc != c1.end () && *cc == *c) {
+      ++cc;
+    }
+
+    size_t num = cc - c;
+    ranges.push_back (NodeRange (num, n1, n1 + num, n2, n2 + num));
+    n1 += num;
+    n2 += num;
+
+    c = cc;
+
+  }
+
+  return true;
+}
+
 size_t
 NetGraph::derive_node_identities_from_node_set (std::vector<std::pair<const NetGraphNode *, NetGraphNode::edge_iterator> > &nodes, std::vector<std::pair<const NetGraphNode *, NetGraphNode::edge_iterator> > &other_nodes, size_t depth, size_t n_branch, TentativeNodeMapping *tentative, CompareData *data)
 {
@@ -2704,14 +3006,44 @@ NetGraph::derive_node_identities_from_node_set (std::vector<std::pair<const NetG
       }
     }
 
-    if (num == 1 || data->with_ambiguous) {
-      node_ranges.push_back (NodeRange (num, n1, nn1, n2, nn2));
-    }
+    //  Large ambiguity groups which exceed the branch complexity are split by node class
+    //  (small ones are left to the backtracking which is precise and cheap enough)
+
+    std::vector<NodeRange> sub_ranges;
+    if (num > 1 && num * n_branch > data->max_n_branch &&
+        is_complete_node_range (n1, nn1, nodes.end ()) && is_complete_node_range (n2, nn2, other_nodes.end ()) &&
+        split_node_range_by_class (n1, nn1, n2, nn2, sub_ranges)) {
+
+      //  the node classes resolve the ambiguity at least partially
+
+      if (options ()->debug_netcompare) {
+        tl::info << indent_s << "ambiguity group with " << num << " members split into " << sub_ranges.size () << " groups by node class";
+      }
+
+      for (std::vector<NodeRange>::const_iterator sr = sub_ranges.begin (); sr != sub_ranges.end (); ++sr) {
+
+        if (sr->num == 1 || data->with_ambiguous) {
+          node_ranges.push_back (*sr);
+        }
+
+        if (sr->num > 1 && tentative && ! data->with_ambiguous) {
+          return failed_match;
+        }
+
+      }
+
+    } else {
+
+      if (num == 1 || data->with_ambiguous) {
+        node_ranges.push_back (NodeRange (num, n1, nn1, n2, nn2));
+      }
+
+      //  in tentative mode ambiguous nodes don't make a match without
+      //  with_ambiguous
+      if (num > 1 && tentative && ! data->with_ambiguous) {
+        return failed_match;
+      }
 
-    //  in tentative mode ambiguous nodes don't make a match without
-    //  with_ambiguous
-    if (num > 1 && tentative && ! data->with_ambiguous) {
-      return failed_match;
     }
 
     n1 = nn1;
@@ -2798,78 +3130,775 @@ NetGraph::derive_node_identities_from_node_set (std::vector<std::pair<const NetG
 
 
 // --------------------------------------------------------------------------------------------------------------------
-//  NetlistComparer implementation
+//  Support for the threaded and incremental compare
 
-NetlistComparer::NetlistComparer (NetlistCompareLogger *logger)
-  : mp_logger (logger)
+/**
+ *  @brief Describes a compare event
+ */
+struct CompareEvent
 {
-  mp_device_categorizer.reset (new DeviceCategorizer ());
-  mp_circuit_categorizer.reset (new CircuitCategorizer ());
-  mp_circuit_pin_mapper.reset (new CircuitPinMapper ());
-
-  m_cap_threshold = -1.0;   //  not set
-  m_res_threshold = -1.0;   //  not set
+  enum event_type {
+    MatchNets, MatchAmbiguousNets, NetMismatch,
+    MatchDevices, MatchDevicesWithDifferentParameters, MatchDevicesWithDifferentDeviceClasses, DeviceMismatch,
+    MatchPins, PinMismatch,
+    MatchSubCircuits, SubCircuitMismatch
+  };
 
-  m_max_depth = 50;
-  m_max_n_branch = 500;
-  m_depth_first = true;
+  CompareEvent (event_type _type, const void *_a, const void *_b)
+    : type (_type), a (_a), b (_b)
+  {
+    //  .. nothing yet ..
+  }
 
-  m_dont_consider_net_names = false;
-}
+  event_type type;
+  const void *a, *b;
+};
 
-NetlistComparer::~NetlistComparer ()
+/**
+ *  @brief A logger recording the circuit-level compare events
+ *
+ *  This logger is used to collect the events inside the worker threads. The events
+ *  are delivered to the actual logger later in the calling thread.
+ */
+class CompareEventRecorder
+  : public NetlistCompareLogger
 {
-  //  .. nothing yet ..
-}
+public:
+  CompareEventRecorder (std::vector<CompareEvent> *events)
+    : mp_events (events)
+  {
+    //  .. nothing yet ..
+  }
 
-void
-NetlistComparer::exclude_caps (double threshold)
-{
-  m_cap_threshold = threshold;
-}
+  virtual void match_nets (const db::Net *a, const db::Net *b) { add (CompareEvent::MatchNets, a, b); }
+  virtual void match_ambiguous_nets (const db::Net *a, const db::Net *b) { add (CompareEvent::MatchAmbiguousNets, a, b); }
+  virtual void net_mismatch (const db::Net *a, const db::Net *b) { add (CompareEvent::NetMismatch, a, b); }
+  virtual void match_devices (const db::Device *a, const db::Device *b) { add (CompareEvent::MatchDevices, a, b); }
+  virtual void match_devices_with_different_parameters (const db::Device *a, const db::Device *b) { add (CompareEvent::MatchDevicesWithDifferentParameters, a, b); }
+  virtual void match_devices_with_different_device_classes (const db::Device *a, const db::Device *b) { add (CompareEvent::MatchDevicesWithDifferentDeviceClasses, a, b); }
+  virtual void device_mismatch (const db::Device *a, const db::Device *b) { add (CompareEvent::DeviceMismatch, a, b); }
+  virtual void match_pins (const db::Pin *a, const db::Pin *b) { add (CompareEvent::MatchPins, a, b); }
+  virtual void pin_mismatch (const db::Pin *a, const db::Pin *b) { add (CompareEvent::PinMismatch, a, b); }
+  virtual void match_subcircuits (const db::SubCircuit *a, const db::SubCircuit *b) { add (CompareEvent::MatchSubCircuits, a, b); }
+  virtual void subcircuit_mismatch (const db::SubCircuit *a, const db::SubCircuit *b) { add (CompareEvent::SubCircuitMismatch, a, b); }
 
-void
-NetlistComparer::exclude_resistors (double threshold)
-{
-  m_res_threshold = threshold;
-}
+  static void replay (const std::vector<CompareEvent> &events, NetlistCompareLogger *logger)
+  {
+    for (std::vector<CompareEvent>::const_iterator e = events.begin (); e != events.end (); ++e) {
+      switch (e->type) {
+      case CompareEvent::MatchNets:
+        logger->match_nets ((const db::Net *) e->a, (const db::Net *) e->b);
+        break;
+      case CompareEvent::MatchAmbiguousNets:
+        logger->match_ambiguous_nets ((const db::Net *) e->a, (const db::Net *) e->b);
+        break;
+      case CompareEvent::NetMismatch:
+        logger->net_mismatch ((const db::Net *) e->a, (const db::Net *) e->b);
+        break;
+      case CompareEvent::MatchDevices:
+        logger->match_devices ((const db::Device *) e->a, (const db::Device *) e->b);
+        break;
+      case CompareEvent::MatchDevicesWithDifferentParameters:
+        logger->match_devices_with_different_parameters ((const db::Device *) e->a, (const db::Device *) e->b);
+        break;
+      case CompareEvent::MatchDevicesWithDifferentDeviceClasses:
+        logger->match_devices_with_different_device_classes ((const db::Device *) e->a, (const db::Device *) e->b);
+        break;
+      case CompareEvent::DeviceMismatch:
+        logger->device_mismatch ((const db::Device *) e->a, (const db::Device *) e->b);
+        break;
+      case CompareEvent::MatchPins:
+        logger->match_pins ((const db::Pin *) e->a, (const db::Pin *) e->b);
+        break;
+      case CompareEvent::PinMismatch:
+        logger->pin_mismatch ((const db::Pin *) e->a, (const db::Pin *) e->b);
+        break;
+      case CompareEvent::MatchSubCircuits:
+        logger->match_subcircuits ((const db::SubCircuit *) e->a, (const db::SubCircuit *) e->b);
+        break;
+      case CompareEvent::SubCircuitMismatch:
+        logger->subcircuit_mismatch ((const db::SubCircuit *) e->a, (const db::SubCircuit *) e->b);
+        break;
+      }
+    }
+  }
 
-void
-NetlistComparer::same_nets (const db::Net *na, const db::Net *nb)
-{
-  m_same_nets [std::make_pair (na->circuit (), nb->circuit ())].push_back (std::make_pair (na, nb));
-}
+private:
+  std::vector<CompareEvent> *mp_events;
 
-void
-NetlistComparer::equivalent_pins (const db::Circuit *cb, size_t pin1_id, size_t pin2_id)
-{
-  mp_circuit_pin_mapper->map_pins (cb, pin1_id, pin2_id);
-}
+  void add (CompareEvent::event_type type, const void *a, const void *b)
+  {
+    mp_events->push_back (CompareEvent (type, a, b));
+  }
+};
 
-void
-NetlistComparer::equivalent_pins (const db::Circuit *cb, const std::vector<size_t> &pin_ids)
+/**
+ *  @brief Provides the translation of compare event objects to indexes and back
+ *
+ *  Nets are identified by their position inside the circuit, the other objects by their ID.
+ */
+class CircuitObjectIndex
 {
-  mp_circuit_pin_mapper->map_pins (cb, pin_ids);
-}
+public:
+  CircuitObjectIndex (const db::Circuit *circuit)
+    : mp_circuit (circuit)
+  {
+    for (db::Circuit::const_net_iterator n = circuit->begin_nets (); n != circuit->end_nets (); ++n) {
+      m_net_index.insert (std::make_pair (n.operator-> (), m_nets.size ()));
+      m_nets.push_back (n.operator-> ());
+    }
+  }
 
-void
-NetlistComparer::same_device_classes (const db::DeviceClass *ca, const db::DeviceClass *cb)
-{
-  mp_device_categorizer->same_class (ca, cb);
-}
+  size_t index_of (CompareEvent::event_type type, const void *obj) const
+  {
+    if (! obj) {
+      return invalid_id;
+    }
 
-void
-NetlistComparer::same_circuits (const db::Circuit *ca, const db::Circuit *cb)
-{
-  mp_circuit_categorizer->same_circuit (ca, cb);
-}
+    switch (type) {
+    case CompareEvent::MatchNets:
+    case CompareEvent::MatchAmbiguousNets:
+    case CompareEvent::NetMismatch:
+      {
+        std::map<const db::Net *, size_t>::const_iterator i = m_net_index.find ((const db::Net *) obj);
+        tl_assert (i != m_net_index.end ());
+        return i->second;
+      }
+    case CompareEvent::MatchPins:
+    case CompareEvent::PinMismatch:
+      return ((const db::Pin *) obj)->id ();
+    case CompareEvent::MatchSubCircuits:
+    case CompareEvent::SubCircuitMismatch:
+      return ((const db::SubCircuit *) obj)->id ();
+    default:
+      return ((const db::Device *) obj)->id ();
+    }
+  }
 
-bool
-NetlistComparer::compare (const db::Netlist *a, const db::Netlist *b, NetlistCompareLogger *logger) const
-{
-  db::NetlistCompareLogger *org_logger = mp_logger;
-  mp_logger = logger;
-  bool res = false;
+  const void *object_for (CompareEvent::event_type type, size_t index) const
+  {
+    if (index == invalid_id) {
+      return 0;
+    }
+
+    switch (type) {
+    case CompareEvent::MatchNets:
+    case CompareEvent::MatchAmbiguousNets:
+    case CompareEvent::NetMismatch:
+      tl_assert (index < m_nets.size ());
+      return m_nets [index];
+    case CompareEvent::MatchPins:
+    case CompareEvent::PinMismatch:
+      return mp_circuit->pin_by_id (index);
+    case CompareEvent::MatchSubCircuits:
+    case CompareEvent::SubCircuitMismatch:
+      return mp_circuit->subcircuit_by_id (index);
+    default:
+      return mp_circuit->device_by_id (index);
+    }
+  }
+
+private:
+  const db::Circuit *mp_circuit;
+  std::vector<const db::Net *> m_nets;
+  std::map<const db::Net *, size_t> m_net_index;
+};
+
+/**
+ *  @brief The compare result for one circuit pair as stored in the NetlistCompareCache
+ */
+class NetlistCompareCacheEntry
+{
+public:
+  struct Event
+  {
+    Event (CompareEvent::event_type _type, size_t _a, size_t _b)
+      : type (_type), a (_a), b (_b)
+    {
+      //  .. nothing yet ..
+    }
+
+    CompareEvent::event_type type;
+    size_t a, b;
+  };
+
+  NetlistCompareCacheEntry ()
+    : id (0), good (false), pin_mismatch (false)
+  {
+    //  .. nothing yet ..
+  }
+
+  size_t id;
+  std::string signature;
+  bool good, pin_mismatch;
+  std::vector<Event> events;
+  std::map<size_t, size_t> pins12, rev_pins12, pins22, rev_pins22;
+};
+
+/**
+ *  @brief Builds the signatures of circuits and compare settings
+ *
+ *  The signature is a byte string which is stored with the cache entries, so
+ *  a cache hit can be verified. The cache key is made from two independent
+ *  64 bit FNV-1a hash values of the signature.
+ */
+class CompareSignature
+{
+public:
+  CompareSignature ()
+  {
+    //  .. nothing yet ..
+  }
+
+  void add (uint64_t v)
+  {
+    //  variable-length encoding
+    while (v >= 0x80) {
+      m_data += char ((v & 0x7f) | 0x80);
+      v >>= 7;
+    }
+    m_data += char (v);
+  }
+
+  void add (double v)
+  {
+    uint64_t u;
+    memcpy (&u, &v, sizeof (u));
+    add (u);
+  }
+
+  void add (const std::string &s)
+  {
+    add (uint64_t (s.size ()));
+    m_data += s;
+  }
+
+  const std::string &data () const
+  {
+    return m_data;
+  }
+
+  NetlistCompareCache::key_type key () const
+  {
+    return key_of (m_data);
+  }
+
+  static NetlistCompareCache::key_type key_of (const std::string &data)
+  {
+    uint64_t h1 = 0xcbf29ce484222325ull, h2 = 0x84222325cbf29ce4ull;
+    for (std::string::const_iterator c = data.begin (); c != data.end (); ++c) {
+      h1 = (h1 ^ (unsigned char) *c) * 0x100000001b3ull;
+      h2 = (h2 ^ (unsigned char) (*c + 0x5b)) * 0x100000001b3ull;
+    }
+    return NetlistCompareCache::key_type (size_t (h1), size_t (h2));
+  }
+
+private:
+  std::string m_data;
+};
+
+/**
+ *  @brief Adds the device classes with their compare settings to the signature
+ *
+ *  Returns false, if the device classes cannot be described - i.e. if they employ
+ *  parameter compare delegates implemented in scripts.
+ */
+static bool
+add_device_class_signature (CompareSignature &h, const db::Netlist *netlist)
+{
+  size_t n = 0;
+
+  for (db::Netlist::const_device_class_iterator dc = netlist->begin_device_classes (); dc != netlist->end_device_classes (); ++dc, ++n) {
+
+    h.add (dc->name ());
+    h.add (uint64_t (dc->is_strict ()));
+
+    const std::vector<db::DeviceTerminalDefinition> &td = dc->terminal_definitions ();
+    h.add (uint64_t (td.size ()));
+    for (std::vector<db::DeviceTerminalDefinition>::const_iterator t = td.begin (); t != td.end (); ++t) {
+      h.add (t->name ());
+      h.add (uint64_t (dc->normalize_terminal_id (t->id ())));
+    }
+
+    const std::vector<db::DeviceParameterDefinition> &pd = dc->parameter_definitions ();
+    h.add (uint64_t (pd.size ()));
+    for (std::vector<db::DeviceParameterDefinition>::const_iterator p = pd.begin (); p != pd.end (); ++p) {
+      h.add (p->name ());
+      h.add (uint64_t (p->is_primary ()));
+    }
+
+    const db::DeviceParameterCompareDelegate *pcd = const_cast<db::DeviceClass *> (dc.operator-> ())->parameter_compare_delegate ();
+    if (! pcd) {
+      h.add (std::string ());
+    } else if (typeid (*pcd) == typeid (db::EqualDeviceParameters)) {
+      h.add (std::string ("=") + static_cast<const db::EqualDeviceParameters *> (pcd)->to_string ());
+    } else if (typeid (*pcd) == typeid (db::AllDeviceParametersAreEqual)) {
+      h.add (std::string ("=") + static_cast<const db::AllDeviceParametersAreEqual *> (pcd)->to_string ());
+    } else {
+      return false;
+    }
+
+  }
+
+  h.add (uint64_t (n));
+  return true;
+}
+
+static void
+add_circuit_signature (CompareSignature &h, const db::Circuit *c, DeviceCategorizer &device_categorizer, CircuitCategorizer &circuit_categorizer, const CircuitPinMapper &circuit_pin_mapper)
+{
+  h.add (c->name ());
+
+  h.add (uint64_t (c->pin_count ()));
+  for (db::Circuit::const_pin_iterator p = c->begin_pins (); p != c->end_pins (); ++p) {
+    h.add (uint64_t (p->id ()));
+    h.add (p->name ());
+    h.add (uint64_t (circuit_pin_mapper.normalize_pin_id (c, p->id ())));
+  }
+
+  for (db::Circuit::const_net_iterator n = c->begin_nets (); n != c->end_nets (); ++n) {
+    h.add (n->name ());
+    h.add (uint64_t (n->pin_count ()));
+    for (db::Net::const_pin_iterator p = n->begin_pins (); p != n->end_pins (); ++p) {
+      h.add (uint64_t (p->pin_id ()));
+    }
+    h.add (uint64_t (n->terminal_count ()));
+    for (db::Net::const_terminal_iterator t = n->begin_terminals (); t != n->end_terminals (); ++t) {
+      h.add (uint64_t (t->device ()->id ()));
+      h.add (uint64_t (t->terminal_id ()));
+    }
+    h.add (uint64_t (n->subcircuit_pin_count ()));
+    for (db::Net::const_subcircuit_pin_iterator p = n->begin_subcircuit_pins (); p != n->end_subcircuit_pins (); ++p) {
+      h.add (uint64_t (p->subcircuit ()->id ()));
+      h.add (uint64_t (p->pin_id ()));
+    }
+  }
+
+  for (db::Circuit::const_device_iterator d = c->begin_devices (); d != c->end_devices (); ++d) {
+    h.add (uint64_t (d->id ()));
+    h.add (d->name ());
+    size_t cat = device_categorizer.cat_for_device (d.operator-> ());
+    h.add (uint64_t (cat));
+    h.add (uint64_t (device_categorizer.is_strict_device_category (cat)));
+    if (d->device_class ()) {
+      const std::vector<db::DeviceParameterDefinition> &pd = d->device_class ()->parameter_definitions ();
+      for (std::vector<db::DeviceParameterDefinition>::const_iterator p = pd.begin (); p != pd.end (); ++p) {
+        h.add (d->parameter_value (p->id ()));
+      }
+    }
+  }
+
+  std::set<const db::Circuit *> refs;
+
+  for (db::Circuit::const_subcircuit_iterator sc = c->begin_subcircuits (); sc != c->end_subcircuits (); ++sc) {
+    h.add (uint64_t (sc->id ()));
+    h.add (sc->name ());
+    h.add (uint64_t (circuit_categorizer.cat_for_subcircuit (sc.operator-> ())));
+    h.add (uint64_t (sc->circuit_ref () ? sc->circuit_ref ()->pin_count () : 0));
+    refs.insert (sc->circuit_ref ());
+  }
+
+  //  the pin equivalences of the child circuits also determine the result
+  for (std::set<const db::Circuit *>::const_iterator r = refs.begin (); r != refs.end (); ++r) {
+    if (*r) {
+      for (db::Circuit::const_pin_iterator p = (*r)->begin_pins (); p != (*r)->end_pins (); ++p) {
+        h.add (uint64_t (circuit_pin_mapper.normalize_pin_id (*r, p->id ())));
+      }
+    }
+  }
+}
+
+/**
+ *  @brief Returns true, if the device classes of the netlist can be compared in multiple threads
+ *
+ *  Compare delegates other than the built-in ones may be implemented in scripts and
+ *  cannot be called from worker threads.
+ */
+static bool
+device_classes_support_threads (const db::Netlist *netlist)
+{
+  for (db::Netlist::const_device_class_iterator dc = netlist->begin_device_classes (); dc != netlist->end_device_classes (); ++dc) {
+    const db::DeviceParameterCompareDelegate *pcd = const_cast<db::DeviceClass *> (dc.operator-> ())->parameter_compare_delegate ();
+    if (pcd && typeid (*pcd) != typeid (db::EqualDeviceParameters) && typeid (*pcd) != typeid (db::AllDeviceParametersAreEqual)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ *  @brief Describes a circuit pair to compare
+ */
+struct CircuitCompareItem
+{
+  CircuitCompareItem (const db::Circuit *_ca, const db::Circuit *_cb, const std::vector<std::pair<const Net *, const Net *> > *_net_identity)
+    : ca (_ca), cb (_cb), net_identity (_net_identity), round (0), entry_id (0), skipped (false), cached (0), good (false), pin_mismatch (false), done (false)
+  {
+    //  .. nothing yet ..
+  }
+
+  const db::Circuit *ca, *cb;
+  const std::vector<std::pair<const Net *, const Net *> > *net_identity;
+  std::set<size_t> deps;
+  size_t round;
+  std::string signature;
+  size_t entry_id;
+  bool skipped;
+  const NetlistCompareCacheEntry *cached;
+  bool good, pin_mismatch;
+  bool done;
+  std::vector<CompareEvent> events;
+};
+
+/**
+ *  @brief Provides the shared compare state for the compare tasks
+ */
+struct CircuitCompareState
+{
+  const NetlistComparer *comparer;
+  DeviceCategorizer *device_categorizer;
+  CircuitCategorizer *circuit_categorizer;
+  CircuitPinMapper *circuit_pin_mapper;
+  std::map<const db::Circuit *, CircuitMapper> *c12_pin_mapping, *c22_pin_mapping;
+  bool record;
+};
+
+/**
+ *  @brief A task comparing one circuit pair
+ */
+class CircuitCompareTask
+  : public tl::Task
+{
+public:
+  CircuitCompareTask (const CircuitCompareState *state, CircuitCompareItem *item)
+    : mp_state (state), mp_item (item)
+  {
+    //  .. nothing yet ..
+  }
+
+  void perform ()
+  {
+    CompareEventRecorder recorder (&mp_item->events);
+    mp_item->good = mp_state->comparer->compare_circuits (mp_item->ca, mp_item->cb, *mp_state->device_categorizer, *mp_state->circuit_categorizer, *mp_state->circuit_pin_mapper, *mp_item->net_identity, mp_item->pin_mismatch, *mp_state->c12_pin_mapping, *mp_state->c22_pin_mapping, mp_state->record ? &recorder : 0);
+  }
+
+private:
+  const CircuitCompareState *mp_state;
+  CircuitCompareItem *mp_item;
+};
+
+/**
+ *  @brief The worker for the circuit compare tasks
+ */
+class CircuitCompareWorker
+  : public tl::Worker
+{
+public:
+  CircuitCompareWorker ()
+    : tl::Worker ()
+  {
+    //  .. nothing yet ..
+  }
+
+  void perform_task (tl::Task *task)
+  {
+    static_cast<CircuitCompareTask *> (task)->perform ();
+  }
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+//  NetlistCompareCache implementation
+
+NetlistCompareCache::NetlistCompareCache ()
+  : m_hits (0), m_next_id (1)
+{
+  //  .. nothing yet ..
+}
+
+NetlistCompareCache::~NetlistCompareCache ()
+{
+  clear ();
+}
+
+void
+NetlistCompareCache::clear ()
+{
+  for (std::map<key_type, NetlistCompareCacheEntry *>::const_iterator e = m_entries.begin (); e != m_entries.end (); ++e) {
+    delete e->second;
+  }
+  m_entries.clear ();
+  m_hits = 0;
+  m_next_id = 1;
+}
+
+const NetlistCompareCacheEntry *
+NetlistCompareCache::find (const key_type &key, const std::string &signature)
+{
+  std::map<key_type, NetlistCompareCacheEntry *>::const_iterator e = m_entries.find (key);
+  //  NOTE: comparing the full signature protects against hash collisions
+  if (e == m_entries.end () || e->second->signature != signature) {
+    return 0;
+  } else {
+    ++m_hits;
+    return e->second;
+  }
+}
+
+void
+NetlistCompareCache::insert (const key_type &key, NetlistCompareCacheEntry *entry)
+{
+  entry->id = m_next_id++;
+
+  std::map<key_type, NetlistCompareCacheEntry *>::iterator e = m_entries.find (key);
+  if (e != m_entries.end ()) {
+    delete e->second;
+    e->second = entry;
+  } else {
+    m_entries.insert (std::make_pair (key, entry));
+  }
+}
+
+static const char *compare_cache_file_header = "KLayout-NetlistCompareCache-1\n";
+
+static void
+write_uint (tl::OutputStream &os, uint64_t v)
+{
+  char b [10];
+  size_t n = 0;
+  while (v >= 0x80) {
+    b [n++] = char ((v & 0x7f) | 0x80);
+    v >>= 7;
+  }
+  b [n++] = char (v);
+  os.put (b, n);
+}
+
+static void
+write_string (tl::OutputStream &os, const std::string &s)
+{
+  write_uint (os, s.size ());
+  os.put (s.c_str (), s.size ());
+}
+
+static void
+write_pin_map (tl::OutputStream &os, const std::map<size_t, size_t> &pm)
+{
+  write_uint (os, pm.size ());
+  for (std::map<size_t, size_t>::const_iterator p = pm.begin (); p != pm.end (); ++p) {
+    write_uint (os, p->first);
+    write_uint (os, p->second);
+  }
+}
+
+static const char *
+read_bytes (tl::InputStream &is, size_t n)
+{
+  const char *b = is.get (n);
+  if (! b) {
+    throw tl::Exception (tl::to_string (tr ("Unexpected end of file in netlist compare cache file: %s")), is.source ());
+  }
+  return b;
+}
+
+static uint64_t
+read_uint (tl::InputStream &is)
+{
+  uint64_t v = 0;
+  for (unsigned int shift = 0; ; shift += 7) {
+    if (shift >= 64) {
+      throw tl::Exception (tl::to_string (tr ("Invalid integer value in netlist compare cache file: %s")), is.source ());
+    }
+    unsigned char c = (unsigned char) *read_bytes (is, 1);
+    v |= uint64_t (c & 0x7f) << shift;
+    if ((c & 0x80) == 0) {
+      return v;
+    }
+  }
+}
+
+static std::string
+read_string (tl::InputStream &is)
+{
+  size_t n = size_t (read_uint (is));
+  return n > 0 ? std::string (read_bytes (is, n), n) : std::string ();
+}
+
+static void
+read_pin_map (tl::InputStream &is, std::map<size_t, size_t> &pm)
+{
+  pm.clear ();
+  for (size_t n = size_t (read_uint (is)); n > 0; --n) {
+    size_t a = size_t (read_uint (is));
+    pm [a] = size_t (read_uint (is));
+  }
+}
+
+void
+NetlistCompareCache::save (const std::string &path) const
+{
+  tl::OutputStream os (path);
+
+  os.put (compare_cache_file_header);
+
+  write_uint (os, m_entries.size ());
+  for (std::map<key_type, NetlistCompareCacheEntry *>::const_iterator e = m_entries.begin (); e != m_entries.end (); ++e) {
+
+    const NetlistCompareCacheEntry *entry = e->second;
+
+    write_uint (os, entry->id);
+    write_string (os, entry->signature);
+    write_uint (os, (entry->good ? 1 : 0) + (entry->pin_mismatch ? 2 : 0));
+
+    write_uint (os, entry->events.size ());
+    for (std::vector<NetlistCompareCacheEntry::Event>::const_iterator ev = entry->events.begin (); ev != entry->events.end (); ++ev) {
+      write_uint (os, (unsigned int) ev->type);
+      write_uint (os, ev->a);
+      write_uint (os, ev->b);
+    }
+
+    write_pin_map (os, entry->pins12);
+    write_pin_map (os, entry->rev_pins12);
+    write_pin_map (os, entry->pins22);
+    write_pin_map (os, entry->rev_pins22);
+
+  }
+}
+
+void
+NetlistCompareCache::load (const std::string &path)
+{
+  clear ();
+
+  tl::InputStream is (path);
+
+  size_t hl = strlen (compare_cache_file_header);
+  if (std::string (read_bytes (is, hl), hl) != compare_cache_file_header) {
+    throw tl::Exception (tl::to_string (tr ("Not a netlist compare cache file: %s")), path);
+  }
+
+  try {
+
+    for (size_t n = size_t (read_uint (is)); n > 0; --n) {
+
+      std::auto_ptr<NetlistCompareCacheEntry> entry (new NetlistCompareCacheEntry ());
+
+      entry->id = size_t (read_uint (is));
+      entry->signature = read_string (is);
+
+      unsigned int flags = (unsigned int) read_uint (is);
+      entry->good = (flags & 1) != 0;
+      entry->pin_mismatch = (flags & 2) != 0;
+
+      for (size_t ne = size_t (read_uint (is)); ne > 0; --ne) {
+        unsigned int type = (unsigned int) read_uint (is);
+        if (type > (unsigned int) CompareEvent::SubCircuitMismatch) {
+          throw tl::Exception (tl::to_string (tr ("Invalid event type in netlist compare cache file: %s")), path);
+        }
+        size_t a = size_t (read_uint (is));
+        size_t b = size_t (read_uint (is));
+        entry->events.push_back (NetlistCompareCacheEntry::Event (CompareEvent::event_type (type), a, b));
+      }
+
+      read_pin_map (is, entry->pins12);
+      read_pin_map (is, entry->rev_pins12);
+      read_pin_map (is, entry->pins22);
+      read_pin_map (is, entry->rev_pins22);
+
+      m_next_id = std::max (m_next_id, entry->id + 1);
+
+      key_type key = CompareSignature::key_of (entry->signature);
+      std::map<key_type, NetlistCompareCacheEntry *>::iterator e = m_entries.find (key);
+      if (e != m_entries.end ()) {
+        delete e->second;
+        e->second = entry.release ();
+      } else {
+        m_entries.insert (std::make_pair (key, entry.release ()));
+      }
+
+    }
+
+  } catch (...) {
+    clear ();
+    throw;
+  }
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+//  NetlistComparer implementation
+
+NetlistComparer::NetlistComparer (NetlistCompareLogger *logger)
+  : mp_logger (logger)
+{
+  mp_device_categorizer.reset (new DeviceCategorizer ());
+  mp_circuit_categorizer.reset (new CircuitCategorizer ());
+  mp_circuit_pin_mapper.reset (new CircuitPinMapper ());
+
+  m_cap_threshold = -1.0;   //  not set
+  m_res_threshold = -1.0;   //  not set
+
+  m_max_depth = 50;
+  m_max_n_branch = 500;
+  m_max_refinement_iterations = 50;
+  m_depth_first = true;
+
+  m_dont_consider_net_names = false;
+
+  m_threads = 0;
+}
+
+NetlistComparer::~NetlistComparer ()
+{
+  //  .. nothing yet ..
+}
+
+void
+NetlistComparer::exclude_caps (double threshold)
+{
+  m_cap_threshold = threshold;
+}
+
+void
+NetlistComparer::exclude_resistors (double threshold)
+{
+  m_res_threshold = threshold;
+}
+
+void
+NetlistComparer::same_nets (const db::Net *na, const db::Net *nb)
+{
+  m_same_nets [std::make_pair (na->circuit (), nb->circuit ())].push_back (std::make_pair (na, nb));
+}
+
+void
+NetlistComparer::equivalent_pins (const db::Circuit *cb, size_t pin1_id, size_t pin2_id)
+{
+  mp_circuit_pin_mapper->map_pins (cb, pin1_id, pin2_id);
+}
+
+void
+NetlistComparer::equivalent_pins (const db::Circuit *cb, const std::vector<size_t> &pin_ids)
+{
+  mp_circuit_pin_mapper->map_pins (cb, pin_ids);
+}
+
+void
+NetlistComparer::same_device_classes (const db::DeviceClass *ca, const db::DeviceClass *cb)
+{
+  mp_device_categorizer->same_class (ca, cb);
+}
+
+void
+NetlistComparer::same_circuits (const db::Circuit *ca, const db::Circuit *cb)
+{
+  mp_circuit_categorizer->same_circuit (ca, cb);
+}
+
+bool
+NetlistComparer::compare (const db::Netlist *a, const db::Netlist *b, NetlistCompareLogger *logger) const
+{
+  db::NetlistCompareLogger *org_logger = mp_logger;
+  mp_logger = logger;
+  bool res = false;
 
   try {
     res = compare (a, b);
@@ -3024,7 +4053,11 @@ NetlistComparer::compare (const db::Netlist *a, const db::Netlist *b) const
 
   std::map<const db::Circuit *, CircuitMapper> c12_pin_mapping, c22_pin_mapping;
 
-  tl::RelativeProgress progress (tl::to_string (tr ("Comparing netlists")), a->circuit_count (), 1);
+  //  collect the circuit pairs to compare in bottom-up order
+
+  std::vector<std::pair<const Net *, const Net *> > empty;
+  std::vector<CircuitCompareItem> items;
+  std::map<const db::Circuit *, size_t> item_for_circuit_a;
 
   for (db::Netlist::const_bottom_up_circuit_iterator c = a->begin_bottom_up (); c != a->end_bottom_up (); ++c) {
 
@@ -3046,50 +4079,327 @@ NetlistComparer::compare (const db::Netlist *a, const db::Netlist *b) const
     tl_assert (i->second.second.size () == size_t (1));
     const db::Circuit *cb = i->second.second.front ();
 
-    std::vector<std::pair<const Net *, const Net *> > empty;
     const std::vector<std::pair<const Net *, const Net *> > *net_identity = &empty;
     std::map<std::pair<const db::Circuit *, const db::Circuit *>, std::vector<std::pair<const Net *, const Net *> > >::const_iterator sn = m_same_nets.find (std::make_pair (ca, cb));
     if (sn != m_same_nets.end ()) {
       net_identity = &sn->second;
     }
 
-    if (all_subcircuits_verified (ca, verified_circuits_a) && all_subcircuits_verified (cb, verified_circuits_b)) {
+    item_for_circuit_a.insert (std::make_pair (ca, items.size ()));
+    items.push_back (CircuitCompareItem (ca, cb, net_identity));
 
-      if (options ()->debug_netcompare) {
-        tl::info << "----------------------------------------------------------------------";
-        tl::info << "treating circuit: " << ca->name () << " vs. " << cb->name ();
+  }
+
+  //  Derive the dependencies: a circuit pair can only be compared when the pairs of the child
+  //  circuits have been compared. Pairs sharing the same schematic circuit are compared in
+  //  the original order. Dependencies on later items (through the partners of the child circuits
+  //  in the schematic) request the compare to happen before these items are finished.
+
+  std::map<const db::Circuit *, size_t> last_item_for_circuit_b;
+
+  for (size_t k = 0; k < items.size (); ++k) {
+
+    CircuitCompareItem &item = items [k];
+
+    for (db::Circuit::const_subcircuit_iterator sc = item.ca->begin_subcircuits (); sc != item.ca->end_subcircuits (); ++sc) {
+      std::map<const db::Circuit *, size_t>::const_iterator d = item_for_circuit_a.find (sc->circuit_ref ());
+      if (d != item_for_circuit_a.end ()) {
+        item.deps.insert (d->second);
       }
-      if (mp_logger) {
-        mp_logger->begin_circuit (ca, cb);
+    }
+
+    for (db::Circuit::const_subcircuit_iterator sc = item.cb->begin_subcircuits (); sc != item.cb->end_subcircuits (); ++sc) {
+      if (! sc->circuit_ref ()) {
+        continue;
+      }
+      size_t cat = circuit_categorizer.cat_for_circuit (sc->circuit_ref ());
+      std::map<size_t, std::pair<std::vector<const db::Circuit *>, std::vector<const db::Circuit *> > >::const_iterator i = cat2circuits.find (cat);
+      if (cat && i != cat2circuits.end ()) {
+        for (std::vector<const db::Circuit *>::const_iterator j = i->second.first.begin (); j != i->second.first.end (); ++j) {
+          std::map<const db::Circuit *, size_t>::const_iterator d = item_for_circuit_a.find (*j);
+          if (d != item_for_circuit_a.end ()) {
+            item.deps.insert (d->second);
+          }
+        }
       }
+    }
 
-      bool pin_mismatch = false;
-      bool g = compare_circuits (ca, cb, device_categorizer, circuit_categorizer, circuit_pin_mapper, *net_identity, pin_mismatch, c12_pin_mapping, c22_pin_mapping);
-      if (! g) {
-        good = false;
+    std::map<const db::Circuit *, size_t>::iterator l = last_item_for_circuit_b.find (item.cb);
+    if (l != last_item_for_circuit_b.end ()) {
+      item.deps.insert (l->second);
+      l->second = k;
+    } else {
+      last_item_for_circuit_b.insert (std::make_pair (item.cb, k));
+    }
+
+    item.deps.erase (k);
+
+  }
+
+  //  Assign the items to rounds. The items of one round are compared in parallel.
+  //  Without threads, every item gets a round of its own.
+
+  bool threaded = (m_threads > 0 && device_classes_support_threads (a) && device_classes_support_threads (b));
+
+  std::vector<size_t> min_round (items.size (), 0);
+  size_t nrounds = 0;
+
+  for (size_t k = 0; k < items.size (); ++k) {
+
+    CircuitCompareItem &item = items [k];
+
+    size_t r = threaded ? min_round [k] : k;
+    for (std::set<size_t>::const_iterator d = item.deps.begin (); d != item.deps.end () && *d < k; ++d) {
+      r = std::max (r, items [*d].round + 1);
+    }
+
+    item.round = r;
+    nrounds = std::max (nrounds, r + 1);
+
+    for (std::set<size_t>::const_iterator d = item.deps.upper_bound (k); d != item.deps.end (); ++d) {
+      min_round [*d] = std::max (min_round [*d], r);
+    }
+
+  }
+
+  std::vector<std::vector<size_t> > rounds (nrounds);
+  for (size_t k = 0; k < items.size (); ++k) {
+    rounds [items [k].round ].push_back (k);
+  }
+
+  //  compute the signatures for the cache - the results of the child circuits are
+  //  added later when the circuit pair is looked up
+
+  NetlistCompareCache *cache = this->cache ();
+
+  if (cache) {
+
+    CompareSignature settings;
+    settings.add (m_cap_threshold);
+    settings.add (m_res_threshold);
+    settings.add (uint64_t (m_max_depth));
+    settings.add (uint64_t (m_max_n_branch));
+    settings.add (uint64_t (m_max_refinement_iterations));
+    settings.add (uint64_t (m_depth_first));
+    settings.add (uint64_t (m_dont_consider_net_names));
+    settings.add (uint64_t (options ()->compare_case_sensitive));
+
+    //  device classes with compare delegates implemented in scripts cannot be described, so the cache is not used
+    if (! add_device_class_signature (settings, a) || ! add_device_class_signature (settings, b)) {
+      cache = 0;
+    }
+
+    for (size_t k = 0; k < items.size () && cache; ++k) {
+
+      CircuitCompareItem &item = items [k];
+
+      CompareSignature h = settings;
+      add_circuit_signature (h, item.ca, device_categorizer, circuit_categorizer, circuit_pin_mapper);
+      add_circuit_signature (h, item.cb, device_categorizer, circuit_categorizer, circuit_pin_mapper);
+
+      for (std::vector<std::pair<const Net *, const Net *> >::const_iterator n = item.net_identity->begin (); n != item.net_identity->end (); ++n) {
+        h.add (n->first ? n->first->expanded_name () : std::string ());
+        h.add (n->second ? n->second->expanded_name () : std::string ());
       }
 
-      if (! pin_mismatch) {
-        verified_circuits_a.insert (ca);
-        verified_circuits_b.insert (cb);
+      item.signature = h.data ();
+
+    }
+
+  }
+
+  //  make sure the global options are initialized before we enter threads
+  options ();
+
+  CircuitCompareState state;
+  state.comparer = this;
+  state.device_categorizer = &device_categorizer;
+  state.circuit_categorizer = &circuit_categorizer;
+  state.circuit_pin_mapper = &circuit_pin_mapper;
+  state.c12_pin_mapping = &c12_pin_mapping;
+  state.c22_pin_mapping = &c22_pin_mapping;
+  state.record = (mp_logger != 0 || cache != 0);
+
+  tl::RelativeProgress progress (tl::to_string (tr ("Comparing netlists")), a->circuit_count (), 1);
+
+  size_t next_to_report = 0;
+
+  for (std::vector<std::vector<size_t> >::const_iterator r = rounds.begin (); r != rounds.end (); ++r) {
+
+    std::vector<CircuitCompareItem *> to_compare;
+
+    for (std::vector<size_t>::const_iterator k = r->begin (); k != r->end (); ++k) {
+
+      CircuitCompareItem &item = items [*k];
+
+      if (! all_subcircuits_verified (item.ca, verified_circuits_a) || ! all_subcircuits_verified (item.cb, verified_circuits_b)) {
+        item.skipped = true;
+        continue;
       }
 
-      derive_pin_equivalence (ca, cb, &circuit_pin_mapper);
+      if (cache) {
 
-      if (mp_logger) {
-        mp_logger->end_circuit (ca, cb, g);
+        //  the child circuit results are identified by the IDs of their cache entries
+        CompareSignature h;
+        for (std::set<size_t>::const_iterator d = item.deps.begin (); d != item.deps.end (); ++d) {
+          //  NOTE: later items are not compared yet
+          h.add (*d < *k ? uint64_t (items [*d].entry_id) : std::numeric_limits<uint64_t>::max ());
+        }
+        item.signature += h.data ();
+
+        item.cached = cache->find (CompareSignature::key_of (item.signature), item.signature);
+
+      }
+
+      if (! item.cached) {
+
+        if (options ()->debug_netcompare) {
+          tl::info << "----------------------------------------------------------------------";
+          tl::info << "treating circuit: " << item.ca->name () << " vs. " << item.cb->name ();
+        }
+
+        //  create the mapper entries here, so the worker threads don't need to
+        c12_pin_mapping [item.ca];
+        c22_pin_mapping [item.cb];
+
+        to_compare.push_back (&item);
+
+      }
+
+    }
+
+    if (threaded && to_compare.size () > 1) {
+
+      tl::Job<CircuitCompareWorker> job (std::min ((unsigned int) to_compare.size (), m_threads));
+      for (std::vector<CircuitCompareItem *>::const_iterator i = to_compare.begin (); i != to_compare.end (); ++i) {
+        job.schedule (new CircuitCompareTask (&state, *i));
+      }
+
+      try {
+        job.start ();
+        job.wait ();
+      } catch (...) {
+        job.terminate ();
+        throw;
+      }
+
+      if (job.has_error ()) {
+        throw tl::Exception (tl::to_string (tr ("Errors occurred during processing. First error message says:\n")) + job.error_messages ().front ());
       }
 
     } else {
 
-      if (mp_logger) {
-        mp_logger->circuit_skipped (ca, cb);
-        good = false;
+      for (std::vector<CircuitCompareItem *>::const_iterator i = to_compare.begin (); i != to_compare.end (); ++i) {
+        CircuitCompareTask (&state, *i).perform ();
       }
 
     }
 
-    ++progress;
+    //  update the compare state in the original order
+
+    for (std::vector<size_t>::const_iterator k = r->begin (); k != r->end (); ++k) {
+
+      CircuitCompareItem &item = items [*k];
+      item.done = true;
+
+      if (item.skipped) {
+        continue;
+      }
+
+      if (item.cached) {
+
+        const NetlistCompareCacheEntry *entry = item.cached;
+
+        item.entry_id = entry->id;
+        item.good = entry->good;
+        item.pin_mismatch = entry->pin_mismatch;
+
+        CircuitMapper &cm12 = c12_pin_mapping [item.ca];
+        cm12.set_other (item.cb);
+        cm12.assign_pin_maps (entry->pins12, entry->rev_pins12);
+
+        CircuitMapper &cm22 = c22_pin_mapping [item.cb];
+        cm22.set_other (item.cb);
+        cm22.assign_pin_maps (entry->pins22, entry->rev_pins22);
+
+        if (mp_logger) {
+          CircuitObjectIndex index_a (item.ca), index_b (item.cb);
+          item.events.reserve (entry->events.size ());
+          for (std::vector<NetlistCompareCacheEntry::Event>::const_iterator e = entry->events.begin (); e != entry->events.end (); ++e) {
+            item.events.push_back (CompareEvent (e->type, index_a.object_for (e->type, e->a), index_b.object_for (e->type, e->b)));
+          }
+        }
+
+      } else if (cache) {
+
+        NetlistCompareCacheEntry *entry = new NetlistCompareCacheEntry ();
+
+        entry->signature.swap (item.signature);
+        entry->good = item.good;
+        entry->pin_mismatch = item.pin_mismatch;
+
+        const CircuitMapper &cm12 = c12_pin_mapping [item.ca];
+        entry->pins12 = cm12.pin_map ();
+        entry->rev_pins12 = cm12.rev_pin_map ();
+
+        const CircuitMapper &cm22 = c22_pin_mapping [item.cb];
+        entry->pins22 = cm22.pin_map ();
+        entry->rev_pins22 = cm22.rev_pin_map ();
+
+        CircuitObjectIndex index_a (item.ca), index_b (item.cb);
+        entry->events.reserve (item.events.size ());
+        for (std::vector<CompareEvent>::const_iterator e = item.events.begin (); e != item.events.end (); ++e) {
+          entry->events.push_back (NetlistCompareCacheEntry::Event (e->type, index_a.index_of (e->type, e->a), index_b.index_of (e->type, e->b)));
+        }
+
+        cache->insert (CompareSignature::key_of (entry->signature), entry);
+        item.entry_id = entry->id;
+
+      }
+
+      if (! item.pin_mismatch) {
+        verified_circuits_a.insert (item.ca);
+        verified_circuits_b.insert (item.cb);
+      }
+
+      derive_pin_equivalence (item.ca, item.cb, &circuit_pin_mapper);
+
+    }
+
+    //  deliver the results in the original order
+
+    while (next_to_report < items.size () && items [next_to_report].done) {
+
+      CircuitCompareItem &item = items [next_to_report];
+
+      if (item.skipped) {
+
+        if (mp_logger) {
+          mp_logger->circuit_skipped (item.ca, item.cb);
+          good = false;
+        }
+
+      } else {
+
+        if (! item.good) {
+          good = false;
+        }
+
+        if (mp_logger) {
+          mp_logger->begin_circuit (item.ca, item.cb);
+          CompareEventRecorder::replay (item.events, mp_logger);
+          mp_logger->end_circuit (item.ca, item.cb, item.good);
+        }
+
+      }
+
+      //  release the memory
+      std::vector<CompareEvent> ().swap (item.events);
+
+      ++progress;
+      ++next_to_report;
+
+    }
 
   }
 
@@ -3423,7 +4733,8 @@ NetlistComparer::compare_circuits (const db::Circuit *c1, const db::Circuit *c2,
                                    const std::vector<std::pair<const Net *, const Net *> > &net_identity,
                                    bool &pin_mismatch,
                                    std::map<const db::Circuit *, CircuitMapper> &c12_circuit_and_pin_mapping,
-                                   std::map<const db::Circuit *, CircuitMapper> &c22_circuit_and_pin_mapping) const
+                                   std::map<const db::Circuit *, CircuitMapper> &c22_circuit_and_pin_mapping,
+                                   NetlistCompareLogger *logger) const
 {
   db::DeviceFilter device_filter (m_cap_threshold, m_res_threshold);
   SubCircuitEquivalenceTracker subcircuit_equivalence;
@@ -3488,7 +4799,7 @@ NetlistComparer::compare_circuits (const db::Circuit *c1, const db::Circuit *c2,
           data.circuit_pin_mapper = &circuit_pin_mapper;
           data.subcircuit_equivalence = &subcircuit_equivalence;
           data.device_equivalence = &device_equivalence;
-          data.logger = mp_logger;
+          data.logger = logger;
           data.progress = &progress;
 
           size_t ni = g1.derive_node_identities (i1 - g1.begin (), 0, 1, 0 /*not tentative*/, &data);
@@ -3543,6 +4854,13 @@ NetlistComparer::compare_circuits (const db::Circuit *c1, const db::Circuit *c2,
         break;
       }
 
+      //  refine the node classes to resolve ambiguities without backtracking
+
+      size_t nclasses = g1.refine_node_classes (&g2, m_max_refinement_iterations);
+      if (options ()->debug_netcompare) {
+        tl::info << "node class refinement: " << nclasses << " classes.";
+      }
+
       std::sort (nodes.begin (), nodes.end (), CompareNodePtr ());
       std::sort (other_nodes.begin (), other_nodes.end (), CompareNodePtr ());
 
@@ -3555,7 +4873,7 @@ NetlistComparer::compare_circuits (const db::Circuit *c1, const db::Circuit *c2,
       data.circuit_pin_mapper = &circuit_pin_mapper;
       data.subcircuit_equivalence = &subcircuit_equivalence;
       data.device_equivalence = &device_equivalence;
-      data.logger = mp_logger;
+      data.logger = logger;
       data.progress = &progress;
 
       size_t ni = g1.derive_node_identities_from_node_set (nodes, other_nodes, 0, 1, 0 /*not tentatively*/, &data);
@@ -3585,11 +4903,11 @@ NetlistComparer::compare_circuits (const db::Circuit *c1, const db::Circuit *c2,
       if (options ()->debug_netcompare) {
         tl::info << "Unresolved net from left: " << i->net ()->expanded_name () << " " << (good ? "(accepted)" : "(not accepted)");
       }
-      if (mp_logger) {
+      if (logger) {
         if (good) {
-          mp_logger->match_nets (i->net (), 0);
+          logger->match_nets (i->net (), 0);
         } else {
-          mp_logger->net_mismatch (i->net (), 0);
+          logger->net_mismatch (i->net (), 0);
         }
       }
       if (good) {
@@ -3604,11 +4922,11 @@ NetlistComparer::compare_circuits (const db::Circuit *c1, const db::Circuit *c2,
       if (options ()->debug_netcompare) {
         tl::info << "Unresolved net from right: " << i->net ()->expanded_name () << " " << (good ? "(accepted)" : "(not accepted)");
       }
-      if (mp_logger) {
+      if (logger) {
         if (good) {
-          mp_logger->match_nets (0, i->net ());
+          logger->match_nets (0, i->net ());
         } else {
-          mp_logger->net_mismatch (0, i->net ());
+          logger->net_mismatch (0, i->net ());
         }
       }
       if (good) {
@@ -3618,15 +4936,15 @@ NetlistComparer::compare_circuits (const db::Circuit *c1, const db::Circuit *c2,
     }
   }
 
-  do_pin_assignment (c1, g1, c2, g2, c12_circuit_and_pin_mapping, c22_circuit_and_pin_mapping, pin_mismatch, good);
-  do_device_assignment (c1, g1, c2, g2, device_filter, device_categorizer, device_equivalence, good);
-  do_subcircuit_assignment (c1, g1, c2, g2, circuit_categorizer, circuit_pin_mapper, c12_circuit_and_pin_mapping, c22_circuit_and_pin_mapping, subcircuit_equivalence, good);
+  do_pin_assignment (c1, g1, c2, g2, c12_circuit_and_pin_mapping, c22_circuit_and_pin_mapping, pin_mismatch, good, logger);
+  do_device_assignment (c1, g1, c2, g2, device_filter, device_categorizer, device_equivalence, good, logger);
+  do_subcircuit_assignment (c1, g1, c2, g2, circuit_categorizer, circuit_pin_mapper, c12_circuit_and_pin_mapping, c22_circuit_and_pin_mapping, subcircuit_equivalence, good, logger);
 
   return good;
 }
 
 bool
-NetlistComparer::handle_pin_mismatch (const db::NetGraph &g1, const db::Circuit *c1, const db::Pin *pin1, const db::NetGraph &g2, const db::Circuit *c2, const db::Pin *pin2) const
+NetlistComparer::handle_pin_mismatch (const db::NetGraph &g1, const db::Circuit *c1, const db::Pin *pin1, const db::NetGraph &g2, const db::Circuit *c2, const db::Pin *pin2, NetlistCompareLogger *logger) const
 {
   const db::Circuit *c = pin1 ? c1 : c2;
   const db::Pin *pin = pin1 ? pin1 : pin2;
@@ -3638,8 +4956,8 @@ NetlistComparer::handle_pin_mismatch (const db::NetGraph &g1, const db::Circuit
   if (net) {
     const db::NetGraphNode &n = graph->node (graph->node_index_for_net (net));
     if (n.has_other () && n.other_net_index () == 0) {
-      if (mp_logger) {
-        mp_logger->match_pins (pin1, pin2);
+      if (logger) {
+        logger->match_pins (pin1, pin2);
       }
       return true;
     }
@@ -3664,20 +4982,20 @@ NetlistComparer::handle_pin_mismatch (const db::NetGraph &g1, const db::Circuit
   }
 
   if (is_not_connected) {
-    if (mp_logger) {
-      mp_logger->match_pins (pin1, pin2);
+    if (logger) {
+      logger->match_pins (pin1, pin2);
     }
     return true;
   } else {
-    if (mp_logger) {
-      mp_logger->pin_mismatch (pin1, pin2);
+    if (logger) {
+      logger->pin_mismatch (pin1, pin2);
     }
     return false;
   }
 }
 
 void
-NetlistComparer::do_pin_assignment (const db::Circuit *c1, const db::NetGraph &g1, const db::Circuit *c2, const db::NetGraph &g2, std::map<const db::Circuit *, CircuitMapper> &c12_circuit_and_pin_mapping, std::map<const db::Circuit *, CircuitMapper> &c22_circuit_and_pin_mapping, bool &pin_mismatch, bool &good) const
+NetlistComparer::do_pin_assignment (const db::Circuit *c1, const db::NetGraph &g1, const db::Circuit *c2, const db::NetGraph &g2, std::map<const db::Circuit *, CircuitMapper> &c12_circuit_and_pin_mapping, std::map<const db::Circuit *, CircuitMapper> &c22_circuit_and_pin_mapping, bool &pin_mismatch, bool &good, NetlistCompareLogger *logger) const
 {
   //  Report pin assignment
   //  This step also does the pin identity mapping.
@@ -3743,8 +5061,8 @@ NetlistComparer::do_pin_assignment (const db::Circuit *c1, const db::NetGraph &g
 
         //  assign an abstract pin - this is a dummy assignment which is mitigated
         //  by declaring the pins equivalent in derive_pin_equivalence
-        if (mp_logger) {
-          mp_logger->match_pins (p.operator-> (), fp->second);
+        if (logger) {
+          logger->match_pins (p.operator-> (), fp->second);
         }
         c12_pin_mapping.map_pin (p->id (), fp->second->id ());
         c22_pin_mapping.map_pin (fp->second->id (), p->id ());
@@ -3753,8 +5071,8 @@ NetlistComparer::do_pin_assignment (const db::Circuit *c1, const db::NetGraph &g
 
         //  assign an abstract pin - this is a dummy assignment which is mitigated
         //  by declaring the pins equivalent in derive_pin_equivalence
-        if (mp_logger) {
-          mp_logger->match_pins (p.operator-> (), *next_abstract);
+        if (logger) {
+          logger->match_pins (p.operator-> (), *next_abstract);
         }
         c12_pin_mapping.map_pin (p->id (), (*next_abstract)->id ());
         c22_pin_mapping.map_pin ((*next_abstract)->id (), p->id ());
@@ -3764,7 +5082,7 @@ NetlistComparer::do_pin_assignment (const db::Circuit *c1, const db::NetGraph &g
       } else {
 
         //  otherwise this is an error for subcircuits or worth a report for top-level circuits
-        if (! handle_pin_mismatch (g1, c1, p.operator-> (), g2, c2, 0)) {
+        if (! handle_pin_mismatch (g1, c1, p.operator-> (), g2, c2, 0, logger)) {
           good = false;
           pin_mismatch = true;
         }
@@ -3788,8 +5106,8 @@ NetlistComparer::do_pin_assignment (const db::Circuit *c1, const db::NetGraph &g
 
       if (np != net2pin2.end () && np->first == n.other_net_index ()) {
 
-        if (mp_logger) {
-          mp_logger->match_pins (pi->pin (), np->second);
+        if (logger) {
+          logger->match_pins (pi->pin (), np->second);
         }
         c12_pin_mapping.map_pin (pi->pin ()->id (), np->second->id ());
         //  dummy mapping: we show this pin is used.
@@ -3811,14 +5129,14 @@ NetlistComparer::do_pin_assignment (const db::Circuit *c1, const db::NetGraph &g
   }
 
   for (std::multimap<size_t, const db::Pin *>::iterator np = net2pin1.begin (); np != net2pin1.end (); ++np) {
-    if (! handle_pin_mismatch (g1, c1, np->second, g2, c2, 0)) {
+    if (! handle_pin_mismatch (g1, c1, np->second, g2, c2, 0, logger)) {
       good = false;
       pin_mismatch = true;
     }
   }
 
   for (std::multimap<size_t, const db::Pin *>::iterator np = net2pin2.begin (); np != net2pin2.end (); ++np) {
-    if (! handle_pin_mismatch (g1, c1, 0, g2, c2, np->second)) {
+    if (! handle_pin_mismatch (g1, c1, 0, g2, c2, np->second, logger)) {
       good = false;
       pin_mismatch = true;
     }
@@ -3826,7 +5144,7 @@ NetlistComparer::do_pin_assignment (const db::Circuit *c1, const db::NetGraph &g
 
   //  abstract pins must match.
   while (next_abstract != abstract_pins2.end ()) {
-    if (! handle_pin_mismatch (g1, c1, 0, g2, c2, *next_abstract)) {
+    if (! handle_pin_mismatch (g1, c1, 0, g2, c2, *next_abstract, logger)) {
       good = false;
       pin_mismatch = true;
     }
@@ -3835,7 +5153,7 @@ NetlistComparer::do_pin_assignment (const db::Circuit *c1, const db::NetGraph &g
 }
 
 void
-NetlistComparer::do_device_assignment (const db::Circuit *c1, const db::NetGraph &g1, const db::Circuit *c2, const db::NetGraph &g2, const db::DeviceFilter &device_filter, db::DeviceCategorizer &device_categorizer, DeviceEquivalenceTracker &device_eq, bool &good) const
+NetlistComparer::do_device_assignment (const db::Circuit *c1, const db::NetGraph &g1, const db::Circuit *c2, const db::NetGraph &g2, const db::DeviceFilter &device_filter, db::DeviceCategorizer &device_categorizer, DeviceEquivalenceTracker &device_eq, bool &good, NetlistCompareLogger *logger) const
 {
   //  Report device assignment
 
@@ -3866,7 +5184,7 @@ NetlistComparer::do_device_assignment (const db::Circuit *c1, const db::NetGraph
     std::vector<std::pair<size_t, size_t> > k = compute_device_key_for_this (*d, g1, device_categorizer.is_strict_device_category (device_cat), mapped);
 
     if (! mapped) {
-      if (mp_logger) {
+      if (logger) {
         unmatched_a.push_back (std::make_pair (k, std::make_pair (d.operator-> (), device_cat)));
       }
       good = false;
@@ -3908,8 +5226,8 @@ NetlistComparer::do_device_assignment (const db::Circuit *c1, const db::NetGraph
       if (! mapped1 || ! mapped2 || k != k_this) {
 
         //  topological mismatch
-        if (mp_logger) {
-          mp_logger->device_mismatch (d_this, d.operator-> ());
+        if (logger) {
+          logger->device_mismatch (d_this, d.operator-> ());
         }
         good = false;
 
@@ -3929,7 +5247,7 @@ NetlistComparer::do_device_assignment (const db::Circuit *c1, const db::NetGraph
 
       if (! mapped || dm == device_map.end () || dm->first != k) {
 
-        if (mp_logger) {
+        if (logger) {
           unmatched_b.push_back (std::make_pair (k, std::make_pair (d.operator-> (), device_cat)));
         }
         good = false;
@@ -3951,19 +5269,19 @@ NetlistComparer::do_device_assignment (const db::Circuit *c1, const db::NetGraph
 
       if (! dc.equals (std::make_pair (c1_device, c1_device_cat), std::make_pair (d.operator-> (), device_cat))) {
         if (c1_device_cat != device_cat) {
-          if (mp_logger) {
-            mp_logger->match_devices_with_different_device_classes (c1_device, d.operator-> ());
+          if (logger) {
+            logger->match_devices_with_different_device_classes (c1_device, d.operator-> ());
           }
           good = false;
         } else {
-          if (mp_logger) {
-            mp_logger->match_devices_with_different_parameters (c1_device, d.operator-> ());
+          if (logger) {
+            logger->match_devices_with_different_parameters (c1_device, d.operator-> ());
           }
           good = false;
         }
       } else {
-        if (mp_logger) {
-          mp_logger->match_devices (c1_device, d.operator-> ());
+        if (logger) {
+          logger->match_devices (c1_device, d.operator-> ());
         }
       }
 
@@ -3972,7 +5290,7 @@ NetlistComparer::do_device_assignment (const db::Circuit *c1, const db::NetGraph
   }
 
   for (std::multimap<std::vector<std::pair<size_t, size_t> >, std::pair<const db::Device *, size_t> >::const_iterator dm = device_map.begin (); dm != device_map.end (); ++dm) {
-    if (mp_logger) {
+    if (logger) {
       unmatched_a.push_back (*dm);
     }
     good = false;
@@ -3981,17 +5299,17 @@ NetlistComparer::do_device_assignment (const db::Circuit *c1, const db::NetGraph
   //  try to do some better mapping of unmatched devices - they will still be reported as mismatching, but their pairing gives some hint
   //  what to fix.
 
-  if (mp_logger) {
+  if (logger) {
 
     size_t max_analysis_set = 1000;
     if (unmatched_a.size () + unmatched_b.size () > max_analysis_set) {
 
       //  don't try too much analysis - this may be a waste of time
       for (unmatched_list::const_iterator i = unmatched_a.begin (); i != unmatched_a.end (); ++i) {
-        mp_logger->device_mismatch (i->second.first, 0);
+        logger->device_mismatch (i->second.first, 0);
       }
       for (unmatched_list::const_iterator i = unmatched_b.begin (); i != unmatched_b.end (); ++i) {
-        mp_logger->device_mismatch (0, i->second.first);
+        logger->device_mismatch (0, i->second.first);
       }
 
     } else {
@@ -4004,12 +5322,12 @@ NetlistComparer::do_device_assignment (const db::Circuit *c1, const db::NetGraph
       for (unmatched_list::iterator i = unmatched_a.begin (), j = unmatched_b.begin (); i != unmatched_a.end () || j != unmatched_b.end (); ) {
 
         while (j != unmatched_b.end () && (i == unmatched_a.end () || !cmp.equals (*j, *i))) {
-          mp_logger->device_mismatch (0, j->second.first);
+          logger->device_mismatch (0, j->second.first);
           ++j;
         }
 
         while (i != unmatched_a.end () && (j == unmatched_b.end () || !cmp.equals (*i, *j))) {
-          mp_logger->device_mismatch (i->second.first, 0);
+          logger->device_mismatch (i->second.first, 0);
           ++i;
         }
 
@@ -4031,15 +5349,15 @@ NetlistComparer::do_device_assignment (const db::Circuit *c1, const db::NetGraph
         align (ii, i, jj, j, DeviceConnectionDistance ());
 
         for ( ; ii != i && jj != j; ++ii, ++jj) {
-          mp_logger->device_mismatch (ii->second.first, jj->second.first);
+          logger->device_mismatch (ii->second.first, jj->second.first);
         }
 
         for ( ; jj != j; ++jj) {
-          mp_logger->device_mismatch (0, jj->second.first);
+          logger->device_mismatch (0, jj->second.first);
         }
 
         for ( ; ii != i; ++ii) {
-          mp_logger->device_mismatch (ii->second.first, 0);
+          logger->device_mismatch (ii->second.first, 0);
         }
 
       }
@@ -4050,7 +5368,7 @@ NetlistComparer::do_device_assignment (const db::Circuit *c1, const db::NetGraph
 }
 
 void
-NetlistComparer::do_subcircuit_assignment (const db::Circuit *c1, const db::NetGraph &g1, const db::Circuit *c2, const db::NetGraph &g2, CircuitCategorizer &circuit_categorizer, const CircuitPinMapper &circuit_pin_mapper, std::map<const Circuit *, CircuitMapper> &c12_circuit_and_pin_mapping, std::map<const Circuit *, CircuitMapper> &c22_circuit_and_pin_mapping, SubCircuitEquivalenceTracker &subcircuit_eq, bool &good) const
+NetlistComparer::do_subcircuit_assignment (const db::Circuit *c1, const db::NetGraph &g1, const db::Circuit *c2, const db::NetGraph &g2, CircuitCategorizer &circuit_categorizer, const CircuitPinMapper &circuit_pin_mapper, std::map<const Circuit *, CircuitMapper> &c12_circuit_and_pin_mapping, std::map<const Circuit *, CircuitMapper> &c22_circuit_and_pin_mapping, SubCircuitEquivalenceTracker &subcircuit_eq, bool &good, NetlistCompareLogger *logger) const
 {
   //  Report subcircuit assignment
 
@@ -4072,8 +5390,8 @@ NetlistComparer::do_subcircuit_assignment (const db::Circuit *c1, const db::NetG
     std::vector<std::pair<size_t, size_t> > k = compute_subcircuit_key_for_this (*sc, g1, &c12_circuit_and_pin_mapping, &circuit_pin_mapper, mapped, valid);
 
     if (! mapped) {
-      if (mp_logger) {
-        mp_logger->subcircuit_mismatch (sc.operator-> (), 0);
+      if (logger) {
+        logger->subcircuit_mismatch (sc.operator-> (), 0);
       }
       good = false;
     } else if (valid) {
@@ -4109,13 +5427,13 @@ NetlistComparer::do_subcircuit_assignment (const db::Circuit *c1, const db::NetG
       std::vector<std::pair<size_t, size_t> > k = compute_subcircuit_key_for_other (*sc, g2, &c22_circuit_and_pin_mapping, &circuit_pin_mapper, mapped2, valid2);
 
       if (! valid1 || ! valid2 || ! mapped1 || ! mapped2 || k_this != k || sc_cat != sc_cat_this) {
-        if (mp_logger) {
-          mp_logger->subcircuit_mismatch (sc_this, sc.operator-> ());
+        if (logger) {
+          logger->subcircuit_mismatch (sc_this, sc.operator-> ());
         }
         good = false;
       } else {
-        if (mp_logger) {
-          mp_logger->match_subcircuits (sc_this, sc.operator-> ());
+        if (logger) {
+          logger->match_subcircuits (sc_this, sc.operator-> ());
         }
       }
 
@@ -4128,7 +5446,7 @@ NetlistComparer::do_subcircuit_assignment (const db::Circuit *c1, const db::NetG
 
       if (! mapped || scm == subcircuit_map.end () || scm->first != k) {
 
-        if (mp_logger) {
+        if (logger) {
           unmatched_b.push_back (std::make_pair (k, sc.operator-> ()));
         }
         good = false;
@@ -4153,8 +5471,8 @@ NetlistComparer::do_subcircuit_assignment (const db::Circuit *c1, const db::NetG
           if (nscm == 1) {
 
             //  unique match, but doesn't fit: report this one as paired, but mismatching:
-            if (mp_logger) {
-              mp_logger->subcircuit_mismatch (scm_start->second.first, sc.operator-> ());
+            if (logger) {
+              logger->subcircuit_mismatch (scm_start->second.first, sc.operator-> ());
             }
 
             //  no longer look for this one
@@ -4163,8 +5481,8 @@ NetlistComparer::do_subcircuit_assignment (const db::Circuit *c1, const db::NetG
           } else {
 
             //  no unqiue match
-            if (mp_logger) {
-              mp_logger->subcircuit_mismatch (0, sc.operator-> ());
+            if (logger) {
+              logger->subcircuit_mismatch (0, sc.operator-> ());
             }
 
           }
@@ -4173,8 +5491,8 @@ NetlistComparer::do_subcircuit_assignment (const db::Circuit *c1, const db::NetG
 
         } else {
 
-          if (mp_logger) {
-            mp_logger->match_subcircuits (scm->second.first, sc.operator-> ());
+          if (logger) {
+            logger->match_subcircuits (scm->second.first, sc.operator-> ());
           }
 
           //  no longer look for this one
@@ -4189,7 +5507,7 @@ NetlistComparer::do_subcircuit_assignment (const db::Circuit *c1, const db::NetG
   }
 
   for (std::multimap<std::vector<std::pair<size_t, size_t> >, std::pair<const db::SubCircuit *, size_t> >::const_iterator scm = subcircuit_map.begin (); scm != subcircuit_map.end (); ++scm) {
-    if (mp_logger) {
+    if (logger) {
       unmatched_a.push_back (std::make_pair (scm->first, scm->second.first));
     }
     good = false;
@@ -4198,17 +5516,17 @@ NetlistComparer::do_subcircuit_assignment (const db::Circuit *c1, const db::NetG
   //  try to do some pairing between the mismatching subcircuits - even though we will still report them as
   //  mismatches it will give some better hint about what needs to be fixed
 
-  if (mp_logger) {
+  if (logger) {
 
     size_t max_analysis_set = 1000;
     if (unmatched_a.size () + unmatched_b.size () > max_analysis_set) {
 
       //  don't try too much analysis - this may be a waste of time
       for (unmatched_list::const_iterator i = unmatched_a.begin (); i != unmatched_a.end (); ++i) {
-        mp_logger->subcircuit_mismatch (i->second, 0);
+        logger->subcircuit_mismatch (i->second, 0);
       }
       for (unmatched_list::const_iterator i = unmatched_b.begin (); i != unmatched_b.end (); ++i) {
-        mp_logger->subcircuit_mismatch (0, i->second);
+        logger->subcircuit_mismatch (0, i->second);
       }
 
     } else {
@@ -4219,12 +5537,12 @@ NetlistComparer::do_subcircuit_assignment (const db::Circuit *c1, const db::NetG
       for (unmatched_list::iterator i = unmatched_a.begin (), j = unmatched_b.begin (); i != unmatched_a.end () || j != unmatched_b.end (); ) {
 
         while (j != unmatched_b.end () && (i == unmatched_a.end () || j->first.size () < i->first.size ())) {
-          mp_logger->subcircuit_mismatch (0, j->second);
+          logger->subcircuit_mismatch (0, j->second);
           ++j;
         }
 
         while (i != unmatched_a.end () && (j == unmatched_b.end () || i->first.size () < j->first.size ())) {
-          mp_logger->subcircuit_mismatch (i->second, 0);
+          logger->subcircuit_mismatch (i->second, 0);
           ++i;
         }
 
@@ -4248,15 +5566,15 @@ NetlistComparer::do_subcircuit_assignment (const db::Circuit *c1, const db::NetG
         align (ii, i, jj, j, KeyDistance ());
 
         for ( ; ii != i && jj != j; ++ii, ++jj) {
-          mp_logger->subcircuit_mismatch (ii->second, jj->second);
+          logger->subcircuit_mismatch (ii->second, jj->second);
         }
 
         for ( ; jj != j; ++jj) {
-          mp_logger->subcircuit_mismatch (0, jj->second);
+          logger->subcircuit_mismatch (0, jj->second);
         }
 
         for ( ; ii != i; ++ii) {
-          mp_logger->subcircuit_mismatch (ii->second, 0);
+          logger->subcircuit_mismatch (ii->second, 0);
         }
 
       }
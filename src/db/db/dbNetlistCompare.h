@@ -25,9 +25,11 @@
 
 #include "dbCommon.h"
 #include "dbNetlist.h"
+#include "tlObject.h"
 
 #include <set>
 #include <map>
+#include <string>
 
 namespace db
 {
@@ -40,6 +42,7 @@ class CircuitMapper;
 class NetGraph;
 class SubCircuitEquivalenceTracker;
 class DeviceEquivalenceTracker;
+class NetlistCompareCacheEntry;
 
 /**
  * @brief A receiver for netlist compare events
@@ -158,6 +161,92 @@ private:
   NetlistCompareLogger &operator= (const NetlistCompareLogger &);
 };
 
+/**
+ *  @brief A cache for circuit compare results
+ *
+ *  If a cache is attached to a NetlistComparer, the results of the circuit
+ *  comparisons are kept in the cache. A later compare using the same cache will
+ *  reuse these results for circuit pairs which did not change. A circuit pair is
+ *  considered unchanged if both circuits, the circuits they depend on and the
+ *  compare settings are the same. Hence, after a small modification, only the
+ *  modified circuits and the circuits above them need to be compared again.
+ *
+ *  The compare settings include the device classes with their parameter compare
+ *  tolerances. Parameter compare delegates implemented in scripts cannot be
+ *  described - with such delegates, the cache is not used.
+ *
+ *  The entries are looked up by a hash value, but the full signature is stored
+ *  with each entry and compared, so a hash collision will not deliver a wrong result.
+ *
+ *  The cache can be saved to a file and loaded again, so the results can be
+ *  reused across sessions.
+ */
+class DB_PUBLIC NetlistCompareCache
+  : public tl::Object
+{
+public:
+  typedef std::pair<size_t, size_t> key_type;
+
+  /**
+   *  @brief Constructor
+   */
+  NetlistCompareCache ();
+
+  /**
+   *  @brief Destructor
+   */
+  ~NetlistCompareCache ();
+
+  /**
+   *  @brief Clears the cache
+   */
+  void clear ();
+
+  /**
+   *  @brief Gets the number of circuit pairs stored in the cache
+   */
+  size_t size () const
+  {
+    return m_entries.size ();
+  }
+
+  /**
+   *  @brief Gets the number of circuit compare results taken from the cache
+   *  This counter is reset by "clear".
+   */
+  size_t hits () const
+  {
+    return m_hits;
+  }
+
+  /**
+   *  @brief Saves the cache to the given file
+   */
+  void save (const std::string &path) const;
+
+  /**
+   *  @brief Loads the cache from the given file
+   *
+   *  The present entries are replaced by the ones from the file.
+   *  The hit counter is reset.
+   */
+  void load (const std::string &path);
+
+private:
+  friend class NetlistComparer;
+
+  std::map<key_type, NetlistCompareCacheEntry *> m_entries;
+  size_t m_hits;
+  size_t m_next_id;
+
+  //  No copying
+  NetlistCompareCache (const NetlistCompareCache &);
+  NetlistCompareCache &operator= (const NetlistCompareCache &);
+
+  const NetlistCompareCacheEntry *find (const key_type &key, const std::string &signature);
+  void insert (const key_type &key, NetlistCompareCacheEntry *entry);
+};
+
 /**
  *  @brief The netlist comparer
  */
@@ -247,6 +336,26 @@ public:
     return m_max_depth;
   }
 
+  /**
+   *  @brief Sets the maximum number of node class refinement iterations
+   *
+   *  Before backtracking, the node classes of both net graphs are refined
+   *  iteratively from the neighborhood of the nodes. This value limits the number
+   *  of iterations. The refinement stops earlier if the classes are stable.
+   */
+  void set_max_refinement_iterations (size_t n)
+  {
+    m_max_refinement_iterations = n;
+  }
+
+  /**
+   *  @brief Gets the maximum number of node class refinement iterations
+   */
+  size_t max_refinement_iterations () const
+  {
+    return m_max_refinement_iterations;
+  }
+
   /**
    *  @brief Sets a value indicating whether not to consider net names
    *  This feature is mainly intended for testing.
@@ -307,6 +416,49 @@ public:
     return m_depth_first;
   }
 
+  /**
+   *  @brief Sets the number of threads to use
+   *
+   *  With a thread count of 0 (the default), the circuits are compared in the calling thread.
+   *  Otherwise, circuits which don't depend on each other are compared in parallel.
+   *  The compare events are delivered to the logger in the calling thread and in the
+   *  same order as in the single-threaded case. Hence the result does not depend on
+   *  the number of threads.
+   */
+  void set_threads (unsigned int n)
+  {
+    m_threads = n;
+  }
+
+  /**
+   *  @brief Gets the number of threads to use
+   */
+  unsigned int threads () const
+  {
+    return m_threads;
+  }
+
+  /**
+   *  @brief Attaches a compare cache
+   *
+   *  With a cache, the compare results of unchanged circuit pairs are taken from
+   *  previous compare runs with the same cache. See NetlistCompareCache for details.
+   *  The cache is not owned by the comparer. Passing 0 will detach the cache.
+   *  The cache is detached automatically when it is deleted.
+   */
+  void set_cache (NetlistCompareCache *cache)
+  {
+    mp_cache = cache;
+  }
+
+  /**
+   *  @brief Gets the compare cache or 0 if no cache is attached
+   */
+  NetlistCompareCache *cache () const
+  {
+    return const_cast<NetlistCompareCache *> (mp_cache.get ());
+  }
+
   /**
    *  @brief Gets the list of circuits without matching circuit in the other netlist
    *  The result can be used to flatten these circuits prior to compare.
@@ -339,18 +491,20 @@ public:
   void join_symmetric_nets (db::Circuit *circuit);
 
 private:
+  friend class CircuitCompareTask;
+
   //  No copying
   NetlistComparer (const NetlistComparer &);
   NetlistComparer &operator= (const NetlistComparer &);
 
 protected:
-  bool compare_circuits (const db::Circuit *c1, const db::Circuit *c2, db::DeviceCategorizer &device_categorizer, db::CircuitCategorizer &circuit_categorizer, db::CircuitPinMapper &circuit_pin_mapper, const std::vector<std::pair<const Net *, const Net *> > &net_identity, bool &pin_mismatch, std::map<const db::Circuit *, CircuitMapper> &c12_circuit_and_pin_mapping, std::map<const db::Circuit *, CircuitMapper> &c22_circuit_and_pin_mapping) const;
+  bool compare_circuits (const db::Circuit *c1, const db::Circuit *c2, db::DeviceCategorizer &device_categorizer, db::CircuitCategorizer &circuit_categorizer, db::CircuitPinMapper &circuit_pin_mapper, const std::vector<std::pair<const Net *, const Net *> > &net_identity, bool &pin_mismatch, std::map<const db::Circuit *, CircuitMapper> &c12_circuit_and_pin_mapping, std::map<const db::Circuit *, CircuitMapper> &c22_circuit_and_pin_mapping, NetlistCompareLogger *logger) const;
   bool all_subcircuits_verified (const db::Circuit *c, const std::set<const db::Circuit *> &verified_circuits) const;
   static void derive_pin_equivalence (const db::Circuit *ca, const db::Circuit *cb, CircuitPinMapper *circuit_pin_mapper);
-  void do_pin_assignment (const db::Circuit *c1, const db::NetGraph &g1, const db::Circuit *c2, const db::NetGraph &g2, std::map<const db::Circuit *, CircuitMapper> &c12_circuit_and_pin_mapping, std::map<const db::Circuit *, CircuitMapper> &c22_circuit_and_pin_mapping, bool &pin_mismatch, bool &good) const;
-  void do_device_assignment (const db::Circuit *c1, const db::NetGraph &g1, const db::Circuit *c2, const db::NetGraph &g2, const db::DeviceFilter &device_filter, DeviceCategorizer &device_categorizer, db::DeviceEquivalenceTracker &device_eq, bool &good) const;
-  void do_subcircuit_assignment (const db::Circuit *c1, const db::NetGraph &g1, const db::Circuit *c2, const db::NetGraph &g2, CircuitCategorizer &circuit_categorizer, const db::CircuitPinMapper &circuit_pin_mapper, std::map<const db::Circuit *, CircuitMapper> &c12_circuit_and_pin_mapping, std::map<const db::Circuit *, CircuitMapper> &c22_circuit_and_pin_mapping, db::SubCircuitEquivalenceTracker &subcircuit_eq, bool &good) const;
-  bool handle_pin_mismatch (const NetGraph &g1, const db::Circuit *c1, const db::Pin *pin1, const NetGraph &g2, const db::Circuit *c2, const db::Pin *p2) const;
+  void do_pin_assignment (const db::Circuit *c1, const db::NetGraph &g1, const db::Circuit *c2, const db::NetGraph &g2, std::map<const db::Circuit *, CircuitMapper> &c12_circuit_and_pin_mapping, std::map<const db::Circuit *, CircuitMapper> &c22_circuit_and_pin_mapping, bool &pin_mismatch, bool &good, NetlistCompareLogger *logger) const;
+  void do_device_assignment (const db::Circuit *c1, const db::NetGraph &g1, const db::Circuit *c2, const db::NetGraph &g2, const db::DeviceFilter &device_filter, DeviceCategorizer &device_categorizer, db::DeviceEquivalenceTracker &device_eq, bool &good, NetlistCompareLogger *logger) const;
+  void do_subcircuit_assignment (const db::Circuit *c1, const db::NetGraph &g1, const db::Circuit *c2, const db::NetGraph &g2, CircuitCategorizer &circuit_categorizer, const db::CircuitPinMapper &circuit_pin_mapper, std::map<const db::Circuit *, CircuitMapper> &c12_circuit_and_pin_mapping, std::map<const db::Circuit *, CircuitMapper> &c22_circuit_and_pin_mapping, db::SubCircuitEquivalenceTracker &subcircuit_eq, bool &good, NetlistCompareLogger *logger) const;
+  bool handle_pin_mismatch (const NetGraph &g1, const db::Circuit *c1, const db::Pin *pin1, const NetGraph &g2, const db::Circuit *c2, const db::Pin *p2, NetlistCompareLogger *logger) const;
 
   mutable NetlistCompareLogger *mp_logger;
   std::map<std::pair<const db::Circuit *, const db::Circuit *>, std::vector<std::pair<const Net *, const Net *> > > m_same_nets;
@@ -361,8 +515,11 @@ protected:
   double m_res_threshold;
   size_t m_max_n_branch;
   size_t m_max_depth;
+  size_t m_max_refinement_iterations;
   bool m_depth_first;
   bool m_dont_consider_net_names;
+  unsigned int m_threads;
+  tl::weak_ptr<NetlistCompareCache> mp_cache;
 };
 
 }
@@ -377,6 +534,11 @@ template<> struct type_traits<db::NetlistComparer> : public tl::type_traits<void
   typedef tl::false_tag has_default_constructor;
 };
 
+template<> struct type_traits<db::NetlistCompareCache> : public tl::type_traits<void>
+{
+  typedef tl::false_tag has_copy_constructor;
+};
+
 template<> struct type_traits<db::NetlistCompareLogger> : public tl::type_traits<void>
 {
   //  mark "NetlistDeviceExtractor" as having a default ctor and no copy ctor
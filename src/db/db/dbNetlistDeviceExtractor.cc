@@ -27,6 +27,8 @@
 
 #include "tlProgress.h"
 #include "tlTimer.h"
+#include "tlThreads.h"
+#include "tlThreadedWorkers.h"
 #include "tlInternational.h"
 
 namespace db
@@ -187,13 +189,13 @@ void NetlistDeviceExtractor::extract (db::DeepShapeStore &dss, unsigned int layo
 
   }
 
-  extract_without_initialize (dss.layout (layout_index), dss.initial_cell (layout_index), clusters, layers, device_scaling, dss.breakout_cells (layout_index));
+  extract_without_initialize (dss.layout (layout_index), dss.initial_cell (layout_index), clusters, layers, device_scaling, dss.breakout_cells (layout_index), (unsigned int) std::max (0, dss.threads ()));
 }
 
 void NetlistDeviceExtractor::extract (db::Layout &layout, db::Cell &cell, const std::vector<unsigned int> &layers, db::Netlist *nl, hier_clusters_type &clusters, double device_scaling, const std::set<db::cell_index_type> *breakout_cells)
 {
   initialize (nl);
-  extract_without_initialize (layout, cell, clusters, layers, device_scaling, breakout_cells);
+  extract_without_initialize (layout, cell, clusters, layers, device_scaling, breakout_cells, 0);
 }
 
 namespace {
@@ -204,9 +206,162 @@ struct ExtractorCacheValueType {
   tl::vector<db::Device *> devices;
 };
 
+typedef std::map<std::vector<db::Region>, ExtractorCacheValueType> extractor_cache_type;
+
+}
+
+// ---------------------------------------------------------------------------------
+//  Support for the threaded device extraction
+
+/**
+ *  @brief Collects the results of "extract_devices" when running inside a worker thread
+ *
+ *  Inside the worker threads, devices are not entered into the circuit and terminal
+ *  shapes are not entered into the layout. This happens when the context is transferred
+ *  in the calling thread.
+ */
+class NetlistDeviceExtractorContext
+{
+public:
+  typedef std::map<unsigned int, std::vector<db::Polygon> > polygons_per_layer_type;
+  typedef std::map<size_t, polygons_per_layer_type> polygons_per_terminal_type;
+
+  NetlistDeviceExtractorContext (db::cell_index_type ci)
+    : cell_index (ci)
+  {
+    //  .. nothing yet ..
+  }
+
+  ~NetlistDeviceExtractorContext ()
+  {
+    //  delete the devices which have not been transferred
+    for (std::vector<db::Device *>::const_iterator d = devices.begin (); d != devices.end (); ++d) {
+      delete *d;
+    }
+  }
+
+  polygons_per_terminal_type &terminals_for (const db::Device *device)
+  {
+    std::map<const db::Device *, size_t>::const_iterator i = device_index.find (device);
+    tl_assert (i != device_index.end ());
+    return terminals [i->second];
+  }
+
+  db::cell_index_type cell_index;
+  std::vector<db::Device *> devices;
+  std::map<const db::Device *, size_t> device_index;
+  std::map<size_t, polygons_per_terminal_type> terminals;
+  NetlistDeviceExtractor::error_list errors;
+};
+
+/**
+ *  @brief The context of the "extract_devices" call executed by the current thread
+ */
+static tl::ThreadStorage<NetlistDeviceExtractorContext *> s_current_context;
+
+static NetlistDeviceExtractorContext *current_context ()
+{
+  return s_current_context.hasLocalData () ? s_current_context.localData () : 0;
+}
+
+static void set_current_context (NetlistDeviceExtractorContext *context)
+{
+  if (s_current_context.hasLocalData ()) {
+    s_current_context.localData () = context;
+  } else {
+    s_current_context.setLocalData (context);
+  }
+}
+
+/**
+ *  @brief Describes one device cluster in the threaded extraction
+ */
+struct DeviceClusterItem
+{
+  DeviceClusterItem (db::cell_index_type ci, size_t id)
+    : cell_index (ci), cluster_id (id), cache_entry (0), extract_from (0), context (0)
+  {
+    //  .. nothing yet ..
+  }
+
+  db::cell_index_type cell_index;
+  size_t cluster_id;
+  std::vector<db::Region> layer_geometry;
+  db::Vector disp;
+  ExtractorCacheValueType *cache_entry;
+  //  non-null for the first cluster with the given geometry
+  const std::vector<db::Region> *extract_from;
+  NetlistDeviceExtractorContext *context;
+};
+
+/**
+ *  @brief A task of the threaded device extraction
+ *
+ *  The task either collects the geometry of a cluster or extracts the devices from it.
+ */
+class NetlistDeviceExtractorTask
+  : public tl::Task
+{
+public:
+  NetlistDeviceExtractorTask (NetlistDeviceExtractor *extractor, const NetlistDeviceExtractor::hier_clusters_type *device_clusters, DeviceClusterItem *item)
+    : mp_extractor (extractor), mp_device_clusters (device_clusters), mp_item (item)
+  {
+    //  .. nothing yet ..
+  }
+
+  void perform ()
+  {
+    if (mp_item->context) {
+      mp_extractor->extract_devices_in_context (*mp_item->context, *mp_item->extract_from);
+    } else {
+      mp_extractor->collect_layer_geometry (*mp_device_clusters, mp_item->cell_index, mp_item->cluster_id, mp_item->layer_geometry, mp_item->disp);
+    }
+  }
+
+private:
+  NetlistDeviceExtractor *mp_extractor;
+  const NetlistDeviceExtractor::hier_clusters_type *mp_device_clusters;
+  DeviceClusterItem *mp_item;
+};
+
+/**
+ *  @brief The worker for the threaded device extraction
+ */
+class NetlistDeviceExtractorWorker
+  : public tl::Worker
+{
+public:
+  NetlistDeviceExtractorWorker ()
+    : tl::Worker ()
+  {
+    //  .. nothing yet ..
+  }
+
+  void perform_task (tl::Task *task)
+  {
+    static_cast<NetlistDeviceExtractorTask *> (task)->perform ();
+  }
+};
+
+static void run_job (tl::Job<NetlistDeviceExtractorWorker> &job)
+{
+  try {
+    job.start ();
+    job.wait ();
+  } catch (...) {
+    job.terminate ();
+    throw;
+  }
+
+  if (job.has_error ()) {
+    throw tl::Exception (tl::to_string (tr ("Errors occurred during processing. First error message says:\n")) + job.error_messages ().front ());
+  }
 }
 
-void NetlistDeviceExtractor::extract_without_initialize (db::Layout &layout, db::Cell &cell, hier_clusters_type &clusters, const std::vector<unsigned int> &layers, double device_scaling, const std::set<db::cell_index_type> *breakout_cells)
+// ---------------------------------------------------------------------------------
+//  NetlistDeviceExtractor implementation (continued)
+
+void NetlistDeviceExtractor::extract_without_initialize (db::Layout &layout, db::Cell &cell, hier_clusters_type &clusters, const std::vector<unsigned int> &layers, double device_scaling, const std::set<db::cell_index_type> *breakout_cells, unsigned int threads)
 {
   tl_assert (layers.size () == m_layer_definitions.size ());
 
@@ -249,6 +404,7 @@ void NetlistDeviceExtractor::extract_without_initialize (db::Layout &layout, db:
 
   db::Connectivity device_conn = get_connectivity (layout, layers);
   db::hier_clusters<shape_type> device_clusters;
+  device_clusters.set_threads (threads);
   device_clusters.build (layout, cell, device_conn, 0, breakout_cells);
 
   tl::SelfTimer timer (tl::verbosity () >= 21, tl::to_string (tr ("Extracting devices")));
@@ -257,7 +413,7 @@ void NetlistDeviceExtractor::extract_without_initialize (db::Layout &layout, db:
 
   size_t n = 0;
   for (std::set<db::cell_index_type>::const_iterator ci = called_cells.begin (); ci != called_cells.end (); ++ci) {
-    db::connected_clusters<shape_type> cc = device_clusters.clusters_per_cell (*ci);
+    const db::connected_clusters<shape_type> &cc = device_clusters.clusters_per_cell (*ci);
     for (db::connected_clusters<shape_type>::all_iterator c = cc.begin_all (); !c.at_end(); ++c) {
       if (cc.is_root (*c)) {
         ++n;
@@ -267,30 +423,21 @@ void NetlistDeviceExtractor::extract_without_initialize (db::Layout &layout, db:
 
   tl::RelativeProgress progress (tl::to_string (tr ("Extracting devices")), n, 1);
 
-  typedef std::map<std::vector<db::Region>, ExtractorCacheValueType> extractor_cache_type;
+  if (threads > 0) {
+    extract_threaded (threads, device_clusters, called_cells, circuits_by_cell, progress);
+    return;
+  }
+
   extractor_cache_type extractor_cache;
 
   //  for each cell investigate the clusters
   for (std::set<db::cell_index_type>::const_iterator ci = called_cells.begin (); ci != called_cells.end (); ++ci) {
 
     m_cell_index = *ci;
-
-    std::map<db::cell_index_type, db::Circuit *>::const_iterator c2c = circuits_by_cell.find (*ci);
-    if (c2c != circuits_by_cell.end ()) {
-
-      //  reuse existing circuit
-      mp_circuit = c2c->second;
-
-    } else {
-
-      //  create a new circuit for this cell
-      mp_circuit = new db::Circuit (layout, *ci);
-      m_netlist->add_circuit (mp_circuit);
-
-    }
+    mp_circuit = circuit_for_cell (circuits_by_cell, *ci);
 
     //  investigate each cluster
-    db::connected_clusters<shape_type> cc = device_clusters.clusters_per_cell (*ci);
+    const db::connected_clusters<shape_type> &cc = device_clusters.clusters_per_cell (*ci);
     for (db::connected_clusters<shape_type>::all_iterator c = cc.begin_all (); !c.at_end(); ++c) {
 
       //  take only root clusters - others have upward connections and are not "whole"
@@ -300,28 +447,9 @@ void NetlistDeviceExtractor::extract_without_initialize (db::Layout &layout, db:
 
       ++progress;
 
-      //  build layer geometry from the cluster found
-
       std::vector<db::Region> layer_geometry;
-      layer_geometry.resize (layers.size ());
-
-      for (std::vector<unsigned int>::const_iterator l = layers.begin (); l != layers.end (); ++l) {
-        db::Region &r = layer_geometry [l - layers.begin ()];
-        for (db::recursive_cluster_shape_iterator<shape_type> si (device_clusters, *l, *ci, *c); ! si.at_end(); ++si) {
-          insert_into_region (*si, si.trans (), r);
-        }
-        r.set_base_verbosity (50);
-      }
-
-      db::Box box;
-      for (std::vector<db::Region>::const_iterator g = layer_geometry.begin (); g != layer_geometry.end (); ++g) {
-        box += g->bbox ();
-      }
-
-      db::Vector disp = box.p1 () - db::Point ();
-      for (std::vector<db::Region>::iterator g = layer_geometry.begin (); g != layer_geometry.end (); ++g) {
-        g->transform (db::Disp (-disp));
-      }
+      db::Vector disp;
+      collect_layer_geometry (device_clusters, *ci, *c, layer_geometry, disp);
 
       extractor_cache_type::const_iterator ec = extractor_cache.find (layer_geometry);
       if (ec == extractor_cache.end ()) {
@@ -352,6 +480,219 @@ void NetlistDeviceExtractor::extract_without_initialize (db::Layout &layout, db:
   }
 }
 
+void NetlistDeviceExtractor::extract_threaded (unsigned int threads, const hier_clusters_type &device_clusters, const std::set<db::cell_index_type> &called_cells, std::map<db::cell_index_type, db::Circuit *> &circuits_by_cell, tl::RelativeProgress &progress)
+{
+  typedef db::NetShape shape_type;
+
+  //  the number of clusters processed in one batch - this limits the memory required
+  //  for keeping the cluster geometries
+  const size_t batch_size = 1000;
+
+  bool parallel_extraction = supports_threads ();
+
+  extractor_cache_type extractor_cache;
+
+  std::set<db::cell_index_type>::const_iterator ci = called_cells.begin ();
+  while (ci != called_cells.end ()) {
+
+    //  collect the root clusters of the next cells
+
+    std::vector<db::cell_index_type> batch_cells;
+    std::vector<DeviceClusterItem> items;
+
+    while (ci != called_cells.end () && items.size () < batch_size) {
+
+      batch_cells.push_back (*ci);
+
+      const db::connected_clusters<shape_type> &cc = device_clusters.clusters_per_cell (*ci);
+      for (db::connected_clusters<shape_type>::all_iterator c = cc.begin_all (); !c.at_end(); ++c) {
+        //  take only root clusters - others have upward connections and are not "whole"
+        if (cc.is_root (*c)) {
+          items.push_back (DeviceClusterItem (*ci, *c));
+        }
+      }
+
+      ++ci;
+
+    }
+
+    //  collect the cluster geometries in parallel
+
+    {
+      tl::Job<NetlistDeviceExtractorWorker> job (threads);
+      for (std::vector<DeviceClusterItem>::iterator i = items.begin (); i != items.end (); ++i) {
+        job.schedule (new NetlistDeviceExtractorTask (this, &device_clusters, i.operator-> ()));
+      }
+      run_job (job);
+    }
+
+    //  identify identical geometries - only the first cluster of a kind is extracted
+
+    for (std::vector<DeviceClusterItem>::iterator i = items.begin (); i != items.end (); ++i) {
+
+      extractor_cache_type::iterator ec = extractor_cache.find (i->layer_geometry);
+      if (ec == extractor_cache.end ()) {
+        ec = extractor_cache.insert (std::make_pair (i->layer_geometry, ExtractorCacheValueType ())).first;
+        i->extract_from = &ec->first;
+      }
+
+      i->cache_entry = &ec->second;
+      i->layer_geometry.clear ();
+
+    }
+
+    //  extract the devices in parallel if possible
+
+    std::list<NetlistDeviceExtractorContext> contexts;
+
+    if (parallel_extraction) {
+
+      tl::Job<NetlistDeviceExtractorWorker> job (threads);
+      for (std::vector<DeviceClusterItem>::iterator i = items.begin (); i != items.end (); ++i) {
+        if (i->extract_from) {
+          contexts.push_back (NetlistDeviceExtractorContext (i->cell_index));
+          i->context = &contexts.back ();
+          job.schedule (new NetlistDeviceExtractorTask (this, &device_clusters, i.operator-> ()));
+        }
+      }
+      run_job (job);
+
+    }
+
+    //  produce the devices in the original order, so the result is independent of the thread count
+
+    std::vector<DeviceClusterItem>::const_iterator i = items.begin ();
+    for (std::vector<db::cell_index_type>::const_iterator bc = batch_cells.begin (); bc != batch_cells.end (); ++bc) {
+
+      m_cell_index = *bc;
+      mp_circuit = circuit_for_cell (circuits_by_cell, *bc);
+
+      for ( ; i != items.end () && i->cell_index == *bc; ++i) {
+
+        ++progress;
+
+        if (i->extract_from) {
+
+          if (i->context) {
+            transfer_context (*i->context);
+          } else {
+            extract_devices (*i->extract_from);
+          }
+
+          push_new_devices (i->disp);
+
+          ExtractorCacheValueType &ecv = *i->cache_entry;
+          ecv.disp = i->disp;
+
+          for (std::map<size_t, std::pair<db::Device *, geometry_per_terminal_type> >::const_iterator d = m_new_devices.begin (); d != m_new_devices.end (); ++d) {
+            ecv.devices.push_back (d->second.first);
+          }
+
+          m_new_devices.clear ();
+
+        } else {
+
+          push_cached_devices (i->cache_entry->devices, i->cache_entry->disp, i->disp);
+
+        }
+
+      }
+
+    }
+
+  }
+}
+
+void NetlistDeviceExtractor::collect_layer_geometry (const hier_clusters_type &device_clusters, db::cell_index_type ci, size_t cluster_id, std::vector<db::Region> &layer_geometry, db::Vector &disp) const
+{
+  //  build layer geometry from the cluster found
+
+  layer_geometry.clear ();
+  layer_geometry.resize (m_layers.size ());
+
+  for (std::vector<unsigned int>::const_iterator l = m_layers.begin (); l != m_layers.end (); ++l) {
+    db::Region &r = layer_geometry [l - m_layers.begin ()];
+    for (db::recursive_cluster_shape_iterator<db::NetShape> si (device_clusters, *l, ci, cluster_id); ! si.at_end(); ++si) {
+      insert_into_region (*si, si.trans (), r);
+    }
+    r.set_base_verbosity (50);
+  }
+
+  db::Box box;
+  for (std::vector<db::Region>::const_iterator g = layer_geometry.begin (); g != layer_geometry.end (); ++g) {
+    box += g->bbox ();
+  }
+
+  disp = box.p1 () - db::Point ();
+  for (std::vector<db::Region>::iterator g = layer_geometry.begin (); g != layer_geometry.end (); ++g) {
+    g->transform (db::Disp (-disp));
+  }
+}
+
+db::Circuit *NetlistDeviceExtractor::circuit_for_cell (std::map<db::cell_index_type, db::Circuit *> &circuits_by_cell, db::cell_index_type ci)
+{
+  std::map<db::cell_index_type, db::Circuit *>::const_iterator c2c = circuits_by_cell.find (ci);
+  if (c2c != circuits_by_cell.end ()) {
+    //  reuse existing circuit
+    return c2c->second;
+  }
+
+  //  create a new circuit for this cell
+  db::Circuit *circuit = new db::Circuit (*mp_layout, ci);
+  m_netlist->add_circuit (circuit);
+  return circuit;
+}
+
+void NetlistDeviceExtractor::extract_devices_in_context (NetlistDeviceExtractorContext &context, const std::vector<db::Region> &layer_geometry)
+{
+  set_current_context (&context);
+  try {
+    extract_devices (layer_geometry);
+    set_current_context (0);
+  } catch (...) {
+    set_current_context (0);
+    throw;
+  }
+}
+
+void NetlistDeviceExtractor::transfer_context (NetlistDeviceExtractorContext &context)
+{
+  for (std::vector<db::Device *>::iterator d = context.devices.begin (); d != context.devices.end (); ++d) {
+
+    db::Device *device = *d;
+    size_t index = d - context.devices.begin ();
+
+    //  the circuit takes over the device
+    *d = 0;
+    mp_circuit->add_device (device);
+
+    std::map<size_t, NetlistDeviceExtractorContext::polygons_per_terminal_type>::const_iterator t = context.terminals.find (index);
+    if (t == context.terminals.end ()) {
+      continue;
+    }
+
+    std::pair<db::Device *, geometry_per_terminal_type> &dd = m_new_devices [device->id ()];
+    dd.first = device;
+
+    for (NetlistDeviceExtractorContext::polygons_per_terminal_type::const_iterator pt = t->second.begin (); pt != t->second.end (); ++pt) {
+      geometry_per_layer_type &gl = dd.second [pt->first];
+      for (NetlistDeviceExtractorContext::polygons_per_layer_type::const_iterator pl = pt->second.begin (); pl != pt->second.end (); ++pl) {
+        std::vector<db::NetShape> &geo = gl [pl->first];
+        for (std::vector<db::Polygon>::const_iterator p = pl->second.begin (); p != pl->second.end (); ++p) {
+          geo.push_back (db::NetShape (*p, mp_layout->shape_repository ()));
+        }
+      }
+    }
+
+  }
+
+  context.devices.clear ();
+
+  for (error_list::const_iterator e = context.errors.begin (); e != context.errors.end (); ++e) {
+    add_error (*e);
+  }
+}
+
 void NetlistDeviceExtractor::push_new_devices (const db::Vector &disp_cache)
 {
   db::CplxTrans dbu = db::CplxTrans (mp_layout->dbu ());
@@ -481,6 +822,11 @@ void NetlistDeviceExtractor::extract_devices (const std::vector<db::Region> & /*
   //  .. the default implementation does nothing ..
 }
 
+bool NetlistDeviceExtractor::supports_threads () const
+{
+  return false;
+}
+
 void NetlistDeviceExtractor::register_device_class (DeviceClass *device_class)
 {
   std::auto_ptr<DeviceClass> holder (device_class);
@@ -530,8 +876,17 @@ Device *NetlistDeviceExtractor::create_device ()
     throw tl::Exception (tl::to_string (tr ("No device class registered")));
   }
 
-  tl_assert (mp_circuit != 0);
   Device *device = new Device (mp_device_class);
+
+  NetlistDeviceExtractorContext *context = current_context ();
+  if (context) {
+    //  the device is entered into the circuit when the context is transferred
+    context->device_index.insert (std::make_pair (device, context->devices.size ()));
+    context->devices.push_back (device);
+    return device;
+  }
+
+  tl_assert (mp_circuit != 0);
   mp_circuit->add_device (device);
   return device;
 }
@@ -542,6 +897,15 @@ void NetlistDeviceExtractor::define_terminal (Device *device, size_t terminal_id
   tl_assert (geometry_index < m_layers.size ());
   unsigned int layer_index = m_layers [geometry_index];
 
+  NetlistDeviceExtractorContext *context = current_context ();
+  if (context) {
+    std::vector<db::Polygon> &geo = context->terminals_for (device) [terminal_id][layer_index];
+    for (db::Region::const_iterator p = region.begin_merged (); !p.at_end (); ++p) {
+      geo.push_back (*p);
+    }
+    return;
+  }
+
   std::pair<db::Device *, geometry_per_terminal_type> &dd = m_new_devices[device->id ()];
   dd.first = device;
   std::vector<db::NetShape> &geo = dd.second[terminal_id][layer_index];
@@ -557,6 +921,12 @@ void NetlistDeviceExtractor::define_terminal (Device *device, size_t terminal_id
   tl_assert (geometry_index < m_layers.size ());
   unsigned int layer_index = m_layers [geometry_index];
 
+  NetlistDeviceExtractorContext *context = current_context ();
+  if (context) {
+    context->terminals_for (device) [terminal_id][layer_index].push_back (polygon);
+    return;
+  }
+
   db::NetShape pr (polygon, mp_layout->shape_repository ());
   std::pair<db::Device *, geometry_per_terminal_type> &dd = m_new_devices[device->id ()];
   dd.first = device;
@@ -575,6 +945,12 @@ void NetlistDeviceExtractor::define_terminal (Device *device, size_t terminal_id
   define_terminal (device, terminal_id, layer_index, db::Polygon (db::Box (point - dv, point + dv)));
 }
 
+db::cell_index_type NetlistDeviceExtractor::cell_index () const
+{
+  NetlistDeviceExtractorContext *context = current_context ();
+  return context ? context->cell_index : m_cell_index;
+}
+
 std::string NetlistDeviceExtractor::cell_name () const
 {
   if (layout ()) {
@@ -584,46 +960,49 @@ std::string NetlistDeviceExtractor::cell_name () const
   }
 }
 
-void NetlistDeviceExtractor::error (const std::string &msg)
+void NetlistDeviceExtractor::add_error (const db::NetlistDeviceExtractorError &error)
 {
-  m_errors.push_back (db::NetlistDeviceExtractorError (cell_name (), msg));
+  NetlistDeviceExtractorContext *context = current_context ();
+  if (context) {
+    //  reported when the context is transferred
+    context->errors.push_back (error);
+    return;
+  }
+
+  m_errors.push_back (error);
 
   if (tl::verbosity () >= 20) {
     tl::error << m_errors.back ().to_string ();
   }
 }
 
-void NetlistDeviceExtractor::error (const std::string &msg, const db::DPolygon &poly)
+void NetlistDeviceExtractor::error (const std::string &msg)
 {
-  m_errors.push_back (db::NetlistDeviceExtractorError (cell_name (), msg));
-  m_errors.back ().set_geometry (poly);
+  add_error (db::NetlistDeviceExtractorError (cell_name (), msg));
+}
 
-  if (tl::verbosity () >= 20) {
-    tl::error << m_errors.back ().to_string ();
-  }
+void NetlistDeviceExtractor::error (const std::string &msg, const db::DPolygon &poly)
+{
+  db::NetlistDeviceExtractorError e (cell_name (), msg);
+  e.set_geometry (poly);
+  add_error (e);
 }
 
 void NetlistDeviceExtractor::error (const std::string &category_name, const std::string &category_description, const std::string &msg)
 {
-  m_errors.push_back (db::NetlistDeviceExtractorError (cell_name (), msg));
-  m_errors.back ().set_category_name (category_name);
-  m_errors.back ().set_category_description (category_description);
-
-  if (tl::verbosity () >= 20) {
-    tl::error << m_errors.back ().to_string ();
-  }
+  db::NetlistDeviceExtractorError e (cell_name (), msg);
+  e.set_category_name (category_name);
+  e.set_category_description (category_description);
+  add_error (e);
 }
 
 void NetlistDeviceExtractor::error (const std::string &category_name, const std::string &category_description, const std::string &msg, const db::DPolygon &poly)
 {
-  m_errors.push_back (db::NetlistDeviceExtractorError (cell_name (), msg));
-  m_errors.back ().set_category_name (category_name);
-  m_errors.back ().set_category_description (category_description);
-  m_errors.back ().set_geometry (poly);
-
-  if (tl::verbosity () >= 20) {
-    tl::error << m_errors.back ().to_string ();
-  }
+  db::NetlistDeviceExtractorError e (cell_name (), msg);
+  e.set_category_name (category_name);
+  e.set_category_description (category_description);
+  e.set_geometry (poly);
+  add_error (e);
 }
 
 }
@@ -33,6 +33,11 @@
 
 #include "gsiObject.h"
 
+namespace tl
+{
+  class RelativeProgress;
+}
+
 namespace db
 {
 
@@ -191,6 +196,8 @@ public:
   size_t fallback_index;
 };
 
+class NetlistDeviceExtractorContext;
+
 /**
  *  @brief Implements the device extraction for a specific setup
  *
@@ -354,6 +361,20 @@ public:
    */
   virtual void extract_devices (const std::vector<db::Region> &layer_geometry);
 
+  /**
+   *  @brief Returns a value indicating whether "extract_devices" may be called from multiple threads
+   *
+   *  If this method returns true, "extract_devices" is executed in parallel for different
+   *  clusters when the extraction is run with multiple threads (see DeepShapeStore::set_threads).
+   *  In this case, "extract_devices" must not modify the extractor or the layout other than
+   *  through "create_device", "define_terminal" and "error". Devices and terminals are
+   *  transferred to the netlist and layout afterwards in the same order a single-threaded
+   *  extraction would use, so the result does not depend on the number of threads.
+   *
+   *  The default implementation returns false.
+   */
+  virtual bool supports_threads () const;
+
   /**
    *  @brief Registers a device class
    *  The device class object will become owned by the netlist and must not be deleted by
@@ -447,10 +468,7 @@ public:
    *  @brief Gets the cell index of the current cell
    *  NOTE: this method is provided for testing purposes mainly.
    */
-  db::cell_index_type cell_index () const
-  {
-    return m_cell_index;
-  }
+  db::cell_index_type cell_index () const;
 
   /**
    *  @brief Issues an error with the given message
@@ -494,6 +512,8 @@ public:
   std::string cell_name () const;
 
 private:
+  friend class NetlistDeviceExtractorTask;
+
   struct DeviceCellKey
   {
     DeviceCellKey () { }
@@ -553,7 +573,13 @@ private:
    */
   void initialize (db::Netlist *nl);
 
-  void extract_without_initialize (db::Layout &layout, db::Cell &cell, hier_clusters_type &clusters, const std::vector<unsigned int> &layers, double device_scaling, const std::set<cell_index_type> *breakout_cells);
+  void extract_without_initialize (db::Layout &layout, db::Cell &cell, hier_clusters_type &clusters, const std::vector<unsigned int> &layers, double device_scaling, const std::set<cell_index_type> *breakout_cells, unsigned int threads);
+  void extract_threaded (unsigned int threads, const hier_clusters_type &device_clusters, const std::set<db::cell_index_type> &called_cells, std::map<db::cell_index_type, db::Circuit *> &circuits_by_cell, tl::RelativeProgress &progress);
+  void collect_layer_geometry (const hier_clusters_type &device_clusters, db::cell_index_type ci, size_t cluster_id, std::vector<db::Region> &layer_geometry, db::Vector &disp) const;
+  db::Circuit *circuit_for_cell (std::map<db::cell_index_type, db::Circuit *> &circuits_by_cell, db::cell_index_type ci);
+  void extract_devices_in_context (NetlistDeviceExtractorContext &context, const std::vector<db::Region> &layer_geometry);
+  void transfer_context (NetlistDeviceExtractorContext &context);
+  void add_error (const db::NetlistDeviceExtractorError &error);
   void push_new_devices (const Vector &disp_cache);
   void push_cached_devices (const tl::vector<Device *> &cached_devices, const db::Vector &disp_cache, const db::Vector &new_disp);
 };
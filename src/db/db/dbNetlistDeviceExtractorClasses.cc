@@ -113,6 +113,11 @@ db::Connectivity NetlistDeviceExtractorMOS3Transistor::get_connectivity (const d
   }
 }
 
+bool NetlistDeviceExtractorMOS3Transistor::supports_threads () const
+{
+  return true;
+}
+
 void NetlistDeviceExtractorMOS3Transistor::extract_devices (const std::vector<db::Region> &layer_geometry)
 {
   if (! is_strict ()) {
@@ -410,6 +415,11 @@ db::Connectivity NetlistDeviceExtractorResistor::get_connectivity (const db::Lay
   return conn;
 }
 
+bool NetlistDeviceExtractorResistor::supports_threads () const
+{
+  return true;
+}
+
 void NetlistDeviceExtractorResistor::extract_devices (const std::vector<db::Region> &layer_geometry)
 {
   size_t res_geometry_index = 0;
@@ -542,6 +552,11 @@ db::Connectivity NetlistDeviceExtractorCapacitor::get_connectivity (const db::La
   return conn;
 }
 
+bool NetlistDeviceExtractorCapacitor::supports_threads () const
+{
+  return true;
+}
+
 void NetlistDeviceExtractorCapacitor::extract_devices (const std::vector<db::Region> &layer_geometry)
 {
   size_t plate1_geometry_index = 0;
@@ -647,6 +662,11 @@ db::Connectivity NetlistDeviceExtractorBJT3Transistor::get_connectivity (const d
   return conn;
 }
 
+bool NetlistDeviceExtractorBJT3Transistor::supports_threads () const
+{
+  return true;
+}
+
 void NetlistDeviceExtractorBJT3Transistor::extract_devices (const std::vector<db::Region> &layer_geometry)
 {
   unsigned int collector_geometry_index = 0;
@@ -805,6 +825,11 @@ db::Connectivity NetlistDeviceExtractorDiode::get_connectivity (const db::Layout
   return conn;
 }
 
+bool NetlistDeviceExtractorDiode::supports_threads () const
+{
+  return true;
+}
+
 void NetlistDeviceExtractorDiode::extract_devices (const std::vector<db::Region> &layer_geometry)
 {
   size_t pregion_geometry_index = 0;
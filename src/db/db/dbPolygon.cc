@@ -23,6 +23,8 @@
 
 #include "dbPolygon.h"
 
+#include <limits>
+
 namespace db
 {
 
@@ -469,6 +471,99 @@ void polygon_contour<C>::size (C dx, C dy, unsigned int mode)
 
 }
 
+static inline void
+encode_delta (std::vector<unsigned char> &data, int64_t c, int64_t cl)
+{
+  //  NOTE: computing the difference in unsigned arithmetics avoids overflows
+  uint64_t d = uint64_t (c) - uint64_t (cl);
+  uint64_t z = (d << 1) ^ (uint64_t) (-(int64_t) (d >> 63));
+  while (z >= 0x80) {
+    data.push_back ((unsigned char) (z | 0x80));
+    z >>= 7;
+  }
+  data.push_back ((unsigned char) z);
+}
+
+template <class C>
+bool polygon_contour<C>::pack ()
+{
+  if (is_packed ()) {
+    return true;
+  }
+
+  size_type n = stored_size ();
+  if (! packing_supported<C> () || n == 0) {
+    return false;
+  }
+
+  const point_type *pts = (const point_type *) ((size_t) mp_points & ~3);
+
+  size_type nblocks = packed_blocks ();
+  size_t header_bytes = sizeof (point_type) * (nblocks + 1) + sizeof (uint32_t) * nblocks;
+
+  std::vector<uint32_t> offsets;
+  offsets.reserve (nblocks);
+
+  std::vector<unsigned char> deltas;
+  for (size_type i = 0; i < n; ++i) {
+    if (i % packed_block_size == 0) {
+      offsets.push_back (uint32_t (header_bytes + deltas.size ()));
+    } else {
+      encode_delta (deltas, int64_t (pts [i].x ()), int64_t (pts [i - 1].x ()));
+      encode_delta (deltas, int64_t (pts [i].y ()), int64_t (pts [i - 1].y ()));
+    }
+  }
+
+  size_t bytes = header_bytes + deltas.size ();
+  size_type words = (bytes + sizeof (point_type) - 1) / sizeof (point_type);
+
+  //  pack only if that saves memory and the offsets can be represented
+  if (words >= n || bytes > size_t (std::numeric_limits<uint32_t>::max ())) {
+    return false;
+  }
+
+  point_type *packed = new point_type [words];
+  unsigned char *data = (unsigned char *) packed;
+
+  uint32_t w = uint32_t (words);
+  memcpy (data, &w, sizeof (w));
+  for (size_type b = 0; b < nblocks; ++b) {
+    packed [b + 1] = pts [b * packed_block_size];
+  }
+  memcpy (data + sizeof (point_type) * (nblocks + 1), &offsets.front (), sizeof (uint32_t) * nblocks);
+  if (! deltas.empty ()) {
+    memcpy (data + header_bytes, &deltas.front (), deltas.size ());
+  }
+
+  delete [] pts;
+
+  mp_points = (point_type *) ((size_t) packed | ((size_t) mp_points & 3));
+  m_size = n | packed_flag;
+
+  return true;
+}
+
+template <class C>
+void polygon_contour<C>::unpack ()
+{
+  if (! is_packed ()) {
+    return;
+  }
+
+  size_type n = stored_size ();
+  point_type *pts = new point_type [n];
+
+  cursor_type c;
+  for (size_type i = 0; i < n; ++i) {
+    pts [i] = stored_point (i, &c);
+  }
+
+  delete [] (point_type *) ((size_t) mp_points & ~3);
+
+  mp_points = (point_type *) ((size_t) pts | ((size_t) mp_points & 3));
+  m_size = n;
+}
+
 // explicit instantiations for polygon<T> and simple_polygon<T>
 template class polygon_contour<db::Coord>;
 template class polygon_contour<db::DCoord>;
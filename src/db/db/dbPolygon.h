@@ -45,6 +45,7 @@
 #include <vector>
 #include <iterator>
 #include <algorithm>
+#include <cstring>
 
 namespace db {
 
@@ -74,6 +75,21 @@ inline bool default_compression<db::DCoord> ()
   return false;
 }
 
+// define whether contours can be packed:
+// packing employs delta encoding which is available for integer coordinates only
+
+template<class X>
+inline bool packing_supported ()
+{
+  return false;
+}
+
+template<>
+inline bool packing_supported<db::Coord> ()
+{
+  return true;
+}
+
 /**
  *  @brief A "closed" contour type 
  *
@@ -105,6 +121,26 @@ public:
   typedef typename container_type::const_iterator const_iterator;
   typedef polygon_contour_iterator<polygon_contour, db::unit_trans<C> > simple_iterator;
 
+  /**
+   *  @brief A decoding cursor for packed contours
+   *
+   *  The cursor remembers the last point decoded. With a cursor, sequential
+   *  access to the points of a packed contour is a constant-time operation.
+   */
+  struct cursor_type
+  {
+    cursor_type ()
+      : data (0), index (0), ptr (0)
+    {
+      //  .. nothing yet ..
+    }
+
+    const unsigned char *data;
+    size_type index;
+    point_type point;
+    const unsigned char *ptr;
+  };
+
 private:
   /**
    *  @brief A helper predicate function that returns true if p1-p2 is colinear with p2-p3
@@ -140,10 +176,11 @@ public:
     if (d.mp_points == 0) {
       mp_points = 0;
     } else {
-      point_type *p = new point_type [m_size];
+      size_type n = d.allocated_size ();
+      point_type *p = new point_type [n];
       point_type *pp = (point_type *) ((size_t) d.mp_points & ~3);
       mp_points = (point_type *)((size_t) p | ((size_t) d.mp_points & 3));
-      for (unsigned int i = 0; i < m_size; ++i) {
+      for (size_type i = 0; i < n; ++i) {
         p[i] = pp[i];
       }
     }
@@ -607,8 +644,17 @@ public:
   polygon_contour<C> &move (const vector_type &d)
   {
     point_type *p = (point_type *) ((size_t) mp_points & ~3);
-    for (size_type i = 0; i < m_size; ++i, ++p) {
-      *p += d;
+    if (is_packed ()) {
+      //  the deltas are invariant against displacement - only the anchor points need to be moved
+      size_type n = packed_blocks ();
+      ++p;
+      for (size_type i = 0; i < n; ++i, ++p) {
+        *p += d;
+      }
+    } else {
+      for (size_type i = 0; i < m_size; ++i, ++p) {
+        *p += d;
+      }
     }
     return *this;
   }
@@ -729,12 +775,14 @@ public:
     if (((size_t) mp_points & 1) != 0) {
       return true;
     }
-    if (m_size < 2) {
+    size_type n = stored_size ();
+    if (n < 2) {
       return false;
     }
-    point_type pl = mp_points [m_size - 1];
-    for (size_t i = 0; i < m_size; ++i) {
-      point_type p = mp_points [i];
+    cursor_type c;
+    point_type pl = stored_point (n - 1, 0);
+    for (size_type i = 0; i < n; ++i) {
+      point_type p = stored_point (i, &c);
       if (! coord_traits::equals (p.x (), pl.x ()) && ! coord_traits::equals (p.y (), pl.y ())) {
         return false;
       }
@@ -811,21 +859,33 @@ public:
    *  The time for the access operation is guaranteed to be constant.
    */
   point_type operator[] (size_type index) const
+  {
+    return point_at (index, 0);
+  }
+
+  /**
+   *  @brief Random access with a decoding cursor
+   *
+   *  This method is equivalent to the random access operator. For packed contours,
+   *  the cursor is used to speed up sequential access. The cursor may be 0.
+   */
+  point_type point_at (size_type index, cursor_type *c) const
   {
     size_t f = (size_t) mp_points;
-    point_type *pts = (point_type *) (f & ~3);
     if ((f & 1) != 0) {
       if ((index & 1) != 0) {
+        point_type p1 = stored_point ((index - 1) / 2, c);
+        point_type p2 = stored_point (((index + 1) / 2) % stored_size (), c);
         if ((f & 2) != 0) {
-          return point_type (pts [((index + 1) / 2) % m_size].x (), pts [(index - 1) / 2].y ());
+          return point_type (p2.x (), p1.y ());
         } else {
-          return point_type (pts [(index - 1) / 2].x (), pts [((index + 1) / 2) % m_size].y ());
+          return point_type (p1.x (), p2.y ());
         }
       } else {
-        return pts [index / 2];
+        return stored_point (index / 2, c);
       }
     } else {
-      return pts [index];
+      return stored_point (index, c);
     }
   }
 
@@ -854,12 +914,44 @@ public:
   size_type size () const 
   {
     if ((size_t) mp_points & 1) {
-      return m_size * 2;
+      return stored_size () * 2;
     } else {
-      return m_size;
+      return stored_size ();
     }
   }
 
+  /**
+   *  @brief Packs the contour
+   *
+   *  A packed contour stores the points as delta-encoded, variable-length integers.
+   *  This reduces the memory footprint substantially for contours with many points
+   *  and small distances between the points, such as curvilinear or OPC shapes.
+   *  Point access is somewhat slower on packed contours, but sequential access
+   *  through the iterators is still a constant-time operation. 
+   *
+   *  Packing is supported for integer coordinates only and is done only if it 
+   *  saves memory. Moving a contour preserves the packed state, all other 
+   *  modifications will deliver an unpacked contour.
+   *
+   *  @return True, if the contour is packed
+   */
+  bool pack ();
+
+  /**
+   *  @brief Unpacks the contour
+   *
+   *  This method restores the plain representation of a packed contour.
+   */
+  void unpack ();
+
+  /**
+   *  @brief Returns true, if the contour is packed
+   */
+  bool is_packed () const
+  {
+    return (m_size & packed_flag) != 0;
+  }
+
   /**
    *  @brief Compute the bounding box
    *
@@ -871,9 +963,17 @@ public:
   box_type bbox () const
   {
     box_type box;
-    point_type *p = (point_type *) ((size_t) mp_points & ~3);
-    for (size_type i = 0; i < m_size; ++i, ++p) {
-      box += *p;
+    if (is_packed ()) {
+      cursor_type c;
+      size_type n = stored_size ();
+      for (size_type i = 0; i < n; ++i) {
+        box += stored_point (i, &c);
+      }
+    } else {
+      point_type *p = (point_type *) ((size_t) mp_points & ~3);
+      for (size_type i = 0; i < m_size; ++i, ++p) {
+        box += *p;
+      }
     }
     return box;
   }
@@ -1003,13 +1103,102 @@ public:
     if (! no_self) {
       stat->add (typeid (*this), (void *) this, sizeof (*this), sizeof (*this), parent, purpose, cat);
     }
-    stat->add (typeid (point_type []), (void *) mp_points, sizeof (point_type) * m_size, sizeof (point_type) * m_size, (void *) this, purpose, cat);
+    stat->add (typeid (point_type []), (void *) mp_points, sizeof (point_type) * allocated_size (), sizeof (point_type) * allocated_size (), (void *) this, purpose, cat);
   }
 
 private:
+  //  The number of points per block of a packed contour
+  static const size_type packed_block_size = 16;
+  //  The flag in m_size indicating a packed contour
+  static const size_type packed_flag = size_type (1) << (sizeof (size_type) * 8 - 1);
+
+  //  In packed mode, mp_points points to a buffer consisting of a header word
+  //  (the number of words allocated), one anchor point per block, the byte offsets 
+  //  of the delta sequences per block and the delta sequences. The deltas are 
+  //  zigzag-encoded, variable-length integers (x and y).
   point_type *mp_points;
   size_type m_size;
 
+  size_type stored_size () const
+  {
+    return m_size & ~packed_flag;
+  }
+
+  size_type packed_blocks () const
+  {
+    return (stored_size () + packed_block_size - 1) / packed_block_size;
+  }
+
+  size_type allocated_size () const
+  {
+    if (is_packed ()) {
+      uint32_t n = 0;
+      memcpy (&n, (const void *) ((size_t) mp_points & ~3), sizeof (n));
+      return n;
+    } else {
+      return m_size;
+    }
+  }
+
+  point_type stored_point (size_type index, cursor_type *c) const
+  {
+    const point_type *pts = (const point_type *) ((size_t) mp_points & ~3);
+    if (! is_packed ()) {
+      return pts [index];
+    }
+
+    size_type b = index / packed_block_size;
+    if (index % packed_block_size == 0) {
+      return pts [b + 1];
+    }
+
+    const unsigned char *data = (const unsigned char *) pts;
+    point_type p;
+    const unsigned char *ptr;
+    size_type i;
+
+    if (c && c->data == data && c->index <= index && c->index / packed_block_size == b) {
+      p = c->point;
+      ptr = c->ptr;
+      i = c->index;
+    } else {
+      uint32_t offset = 0;
+      memcpy (&offset, data + sizeof (point_type) * (packed_blocks () + 1) + sizeof (uint32_t) * b, sizeof (offset));
+      p = pts [b + 1];
+      ptr = data + offset;
+      i = b * packed_block_size;
+    }
+
+    for ( ; i < index; ++i) {
+      coord_type x = decode_delta (p.x (), ptr);
+      coord_type y = decode_delta (p.y (), ptr);
+      p = point_type (x, y);
+    }
+
+    if (c) {
+      c->data = data;
+      c->index = index;
+      c->point = p;
+      c->ptr = ptr;
+    }
+
+    return p;
+  }
+
+  static coord_type decode_delta (coord_type c, const unsigned char *&ptr)
+  {
+    uint64_t z = 0;
+    unsigned int s = 0;
+    unsigned char b;
+    do {
+      b = *ptr++;
+      z |= uint64_t (b & 0x7f) << s;
+      s += 7;
+    } while ((b & 0x80) != 0);
+    uint64_t d = (z >> 1) ^ (uint64_t) (-(int64_t) (z & 1));
+    return coord_type (int64_t (uint64_t (int64_t (c)) + d));
+  }
+
   void release ()
   {
     point_type *p = (point_type *) ((size_t) mp_points & ~3);
@@ -1088,7 +1277,7 @@ public:
    */
   template <class T> 
   polygon_contour_iterator (const polygon_contour_iterator<Contour, T> &d, const trans_type &trans, bool reverse = false) 
-    : mp_contour (d.mp_contour), m_index (d.m_index), m_trans (trans), m_reverse (reverse)
+    : mp_contour (d.mp_contour), m_index (d.m_index), m_trans (trans), m_reverse (reverse), m_cursor (d.m_cursor)
   {
     //  .. nothing yet .. 
   }
@@ -1122,7 +1311,7 @@ public:
    */
   point_type operator* () const 
   {
-    return m_trans ((*mp_contour) [m_index]);
+    return m_trans (mp_contour->point_at (m_index, &m_cursor));
   }
 
   /**
@@ -1221,6 +1410,7 @@ private:
   size_t m_index;
   trans_type m_trans;
   bool m_reverse;
+  mutable typename contour_type::cursor_type m_cursor;
 };
 
 /**
@@ -1326,8 +1516,8 @@ public:
   {
     const contour_type *c = get_ctr ();
     
-    point_type p1 (m_trans ((*c) [m_pt]));
-    point_type p2 (m_trans ((*c) [m_pt + 1 >= c->size () ? 0 : m_pt + 1]));
+    point_type p1 (m_trans (c->point_at (m_pt, &m_cursor)));
+    point_type p2 (m_trans (c->point_at (m_pt + 1 >= c->size () ? 0 : m_pt + 1, &m_cursor)));
 
     //  to maintain the edge orientation we need to swap start end end point
     //  if the transformation is mirroring
@@ -1376,6 +1566,7 @@ private:
   unsigned int m_ctr, m_num_ctr;
   size_t m_pt;
   trans_type m_trans;
+  mutable typename contour_type::cursor_type m_cursor;
 
   //  fetch the contour pointer to the current contour
   const contour_type *get_ctr () const
@@ -1671,6 +1862,32 @@ public:
     return true;
   }
 
+  /**
+   *  @brief Packs the contours of the polygon
+   *
+   *  See polygon_contour::pack for details about packed contours.
+   *  The polygon remains equivalent to the unpacked one.
+   */
+  void pack ()
+  {
+    for (typename contour_list_type::iterator h = m_ctrs.begin (); h != m_ctrs.end (); ++h) {
+      h->pack ();
+    }
+  }
+
+  /**
+   *  @brief Returns true, if any contour of the polygon is packed
+   */
+  bool is_packed () const
+  {
+    for (typename contour_list_type::const_iterator h = m_ctrs.begin (); h != m_ctrs.end (); ++h) {
+      if (h->is_packed ()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   /**
    *  @brief Returns the number of points in the polygon
    */
@@ -2801,6 +3018,25 @@ public:
     return m_hull.is_rectilinear ();
   }
 
+  /**
+   *  @brief Packs the hull of the polygon
+   *
+   *  See polygon_contour::pack for details about packed contours.
+   *  The polygon remains equivalent to the unpacked one.
+   */
+  void pack ()
+  {
+    m_hull.pack ();
+  }
+
+  /**
+   *  @brief Returns true, if the hull of the polygon is packed
+   */
+  bool is_packed () const
+  {
+    return m_hull.is_packed ();
+  }
+
   /**
    *  @brief The number of holes
    *
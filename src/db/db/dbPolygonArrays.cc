@@ -0,0 +1,280 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "dbPolygonArrays.h"
+#include "tlException.h"
+#include "tlInternational.h"
+#include "tlAssert.h"
+
+#include <limits>
+
+namespace db
+{
+
+PolygonArrays::PolygonArrays ()
+{
+  clear ();
+}
+
+PolygonArrays::PolygonArrays (const coordinates_type &coordinates, const offsets_type &contour_offsets, const offsets_type &polygon_offsets)
+  : m_coordinates (coordinates), m_contour_offsets (contour_offsets), m_polygon_offsets (polygon_offsets)
+{
+  validate ();
+}
+
+void
+PolygonArrays::validate ()
+{
+  //  an empty offset array is taken for "no polygons"
+  if (m_contour_offsets.empty ()) {
+    m_contour_offsets.push_back (0);
+  }
+  if (m_polygon_offsets.empty ()) {
+    m_polygon_offsets.push_back (0);
+  }
+
+  if (m_coordinates.size () % 2 != 0) {
+    throw tl::Exception (tl::to_string (tr ("The number of coordinates must be even")));
+  }
+  if (m_contour_offsets.front () != 0 || m_contour_offsets.back () != m_coordinates.size () / 2) {
+    throw tl::Exception (tl::to_string (tr ("Contour offsets must start with 0 and end with the number of points")));
+  }
+  if (m_polygon_offsets.front () != 0 || m_polygon_offsets.back () != m_contour_offsets.size () - 1) {
+    throw tl::Exception (tl::to_string (tr ("Polygon offsets must start with 0 and end with the number of contours")));
+  }
+
+  for (size_t i = 1; i < m_contour_offsets.size (); ++i) {
+    if (m_contour_offsets [i] < m_contour_offsets [i - 1]) {
+      throw tl::Exception (tl::to_string (tr ("Contour offsets must not decrease")));
+    }
+  }
+  for (size_t i = 1; i < m_polygon_offsets.size (); ++i) {
+    if (m_polygon_offsets [i] <= m_polygon_offsets [i - 1]) {
+      throw tl::Exception (tl::to_string (tr ("Each polygon needs at least one contour")));
+    }
+  }
+}
+
+namespace
+{
+
+inline void put_int32 (char *&cp, int32_t v)
+{
+  uint32_t u = uint32_t (v);
+  *cp++ = char (u & 0xff);
+  *cp++ = char ((u >> 8) & 0xff);
+  *cp++ = char ((u >> 16) & 0xff);
+  *cp++ = char ((u >> 24) & 0xff);
+}
+
+inline int32_t get_int32 (const char *&cp)
+{
+  const unsigned char *ucp = (const unsigned char *) cp;
+  uint32_t u = uint32_t (ucp [0]) | (uint32_t (ucp [1]) << 8) | (uint32_t (ucp [2]) << 16) | (uint32_t (ucp [3]) << 24);
+  cp += 4;
+  return int32_t (u);
+}
+
+inline int32_t offset_to_int32 (size_t v)
+{
+  if (v > size_t (0x7fffffff)) {
+    throw tl::Exception (tl::to_string (tr ("Polygon arrays are too large for the packed form")));
+  }
+  return int32_t (v);
+}
+
+inline int32_t coord_to_int32 (db::Coord v)
+{
+  if (v < db::Coord (std::numeric_limits<int32_t>::min ()) || v > db::Coord (std::numeric_limits<int32_t>::max ())) {
+    throw tl::Exception (tl::to_string (tr ("Coordinate value does not fit into the 32 bit packed form: %s")), v);
+  }
+  return int32_t (v);
+}
+
+inline size_t int32_to_offset (int32_t v)
+{
+  if (v < 0) {
+    throw tl::Exception (tl::to_string (tr ("Negative count or offset in packed polygon arrays")));
+  }
+  return size_t (v);
+}
+
+}
+
+std::vector<char>
+pack_int32 (const std::vector<db::Coord> &values)
+{
+  std::vector<char> data;
+  data.resize (values.size () * 4);
+
+  char *cp = data.empty () ? 0 : &data.front ();
+  for (std::vector<db::Coord>::const_iterator v = values.begin (); v != values.end (); ++v) {
+    put_int32 (cp, coord_to_int32 (*v));
+  }
+
+  return data;
+}
+
+std::vector<db::Coord>
+unpack_int32 (const std::vector<char> &data)
+{
+  if (data.size () % 4 != 0) {
+    throw tl::Exception (tl::to_string (tr ("The length of the packed data must be a multiple of 4")));
+  }
+
+  std::vector<db::Coord> values;
+  values.reserve (data.size () / 4);
+
+  const char *cp = data.empty () ? 0 : &data.front ();
+  for (size_t i = 0; i < data.size (); i += 4) {
+    values.push_back (db::Coord (get_int32 (cp)));
+  }
+
+  return values;
+}
+
+PolygonArrays
+PolygonArrays::from_packed (const std::vector<char> &data)
+{
+  if (data.size () < 12 || data.size () % 4 != 0) {
+    throw tl::Exception (tl::to_string (tr ("Invalid length of the packed polygon arrays")));
+  }
+
+  const char *cp = &data.front ();
+  size_t npolygons = int32_to_offset (get_int32 (cp));
+  size_t ncontours = int32_to_offset (get_int32 (cp));
+  size_t npoints = int32_to_offset (get_int32 (cp));
+
+  //  NOTE: the comparison is done on the number of 32 bit words to avoid overflows
+  size_t nwords = data.size () / 4 - 3;
+  if (npolygons >= nwords || ncontours >= nwords || npoints > nwords / 2 || npolygons + 1 + ncontours + 1 + npoints * 2 != nwords) {
+    throw tl::Exception (tl::to_string (tr ("Invalid length of the packed polygon arrays")));
+  }
+
+  PolygonArrays pa;
+
+  pa.m_polygon_offsets.clear ();
+  pa.m_polygon_offsets.reserve (npolygons + 1);
+  for (size_t i = 0; i <= npolygons; ++i) {
+    pa.m_polygon_offsets.push_back (int32_to_offset (get_int32 (cp)));
+  }
+
+  pa.m_contour_offsets.clear ();
+  pa.m_contour_offsets.reserve (ncontours + 1);
+  for (size_t i = 0; i <= ncontours; ++i) {
+    pa.m_contour_offsets.push_back (int32_to_offset (get_int32 (cp)));
+  }
+
+  pa.m_coordinates.reserve (npoints * 2);
+  for (size_t i = 0; i < npoints * 2; ++i) {
+    pa.m_coordinates.push_back (db::Coord (get_int32 (cp)));
+  }
+
+  pa.validate ();
+  return pa;
+}
+
+std::vector<char>
+PolygonArrays::to_packed () const
+{
+  std::vector<char> data;
+  data.resize ((3 + m_polygon_offsets.size () + m_contour_offsets.size () + m_coordinates.size ()) * 4);
+
+  char *cp = &data.front ();
+
+  put_int32 (cp, offset_to_int32 (size ()));
+  put_int32 (cp, offset_to_int32 (m_contour_offsets.size () - 1));
+  put_int32 (cp, offset_to_int32 (m_coordinates.size () / 2));
+
+  for (offsets_type::const_iterator i = m_polygon_offsets.begin (); i != m_polygon_offsets.end (); ++i) {
+    put_int32 (cp, offset_to_int32 (*i));
+  }
+  for (offsets_type::const_iterator i = m_contour_offsets.begin (); i != m_contour_offsets.end (); ++i) {
+    put_int32 (cp, offset_to_int32 (*i));
+  }
+  for (coordinates_type::const_iterator i = m_coordinates.begin (); i != m_coordinates.end (); ++i) {
+    put_int32 (cp, coord_to_int32 (*i));
+  }
+
+  return data;
+}
+
+void
+PolygonArrays::clear ()
+{
+  m_coordinates.clear ();
+  m_contour_offsets.clear ();
+  m_contour_offsets.push_back (0);
+  m_polygon_offsets.clear ();
+  m_polygon_offsets.push_back (0);
+}
+
+void
+PolygonArrays::add_contour (const db::Polygon::contour_type &contour)
+{
+  for (size_t i = 0; i < contour.size (); ++i) {
+    db::Point p = contour [i];
+    m_coordinates.push_back (p.x ());
+    m_coordinates.push_back (p.y ());
+  }
+  m_contour_offsets.push_back (m_coordinates.size () / 2);
+}
+
+void
+PolygonArrays::add (const db::Polygon &polygon)
+{
+  add_contour (polygon.hull ());
+  for (unsigned int h = 0; h < polygon.holes (); ++h) {
+    add_contour (polygon.hole (h));
+  }
+  m_polygon_offsets.push_back (m_contour_offsets.size () - 1);
+}
+
+db::Polygon
+PolygonArrays::polygon (size_t index) const
+{
+  tl_assert (index < size ());
+
+  std::vector<db::Point> pts;
+
+  db::Polygon poly;
+  for (size_t c = m_polygon_offsets [index]; c < m_polygon_offsets [index + 1]; ++c) {
+
+    pts.clear ();
+    for (size_t i = m_contour_offsets [c]; i < m_contour_offsets [c + 1]; ++i) {
+      pts.push_back (db::Point (m_coordinates [i * 2], m_coordinates [i * 2 + 1]));
+    }
+
+    if (c == m_polygon_offsets [index]) {
+      poly.assign_hull (pts.begin (), pts.end ());
+    } else {
+      poly.insert_hole (pts.begin (), pts.end ());
+    }
+
+  }
+
+  return poly;
+}
+
+}
+
@@ -0,0 +1,168 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_dbPolygonArrays
+#define HDR_dbPolygonArrays
+
+#include "dbCommon.h"
+#include "dbPolygon.h"
+
+#include <vector>
+#include <string>
+
+namespace db
+{
+
+/**
+ *  @brief A flat representation of a sequence of polygons
+ *
+ *  The polygons are stored in three plain arrays which can be handed over
+ *  to scripts in bulk:
+ *
+ *  "coordinates" holds the x and y coordinates of all points of all contours
+ *  (x0, y0, x1, y1, ...). "contour_offsets" holds the index of the first point
+ *  of each contour plus a final entry with the total number of points.
+ *  "polygon_offsets" holds the index of the first contour of each polygon plus
+ *  a final entry with the total number of contours. The first contour of a
+ *  polygon is the hull, the following ones are the holes.
+ *
+ *  The arrays can also be converted into a packed binary form (see to_packed).
+ */
+class DB_PUBLIC PolygonArrays
+{
+public:
+  typedef std::vector<db::Coord> coordinates_type;
+  typedef std::vector<size_t> offsets_type;
+
+  /**
+   *  @brief Creates an empty polygon array set
+   */
+  PolygonArrays ();
+
+  /**
+   *  @brief Creates a polygon array set from the given arrays
+   *
+   *  This constructor will throw an exception if the arrays are not consistent.
+   */
+  PolygonArrays (const coordinates_type &coordinates, const offsets_type &contour_offsets, const offsets_type &polygon_offsets);
+
+  /**
+   *  @brief Creates a polygon array set from the packed binary form
+   *
+   *  See "to_packed" for a description of the format. This method will throw
+   *  an exception if the data is not consistent.
+   */
+  static PolygonArrays from_packed (const std::vector<char> &data);
+
+  /**
+   *  @brief Gets the arrays in packed binary form
+   *
+   *  The packed form is a sequence of 32 bit signed little-endian integers:
+   *  the number of polygons, contours and points followed by the polygon offsets,
+   *  the contour offsets and the coordinates. Scripts can map this form directly
+   *  to native arrays (e.g. with String#unpack or numpy.frombuffer).
+   */
+  std::vector<char> to_packed () const;
+
+  /**
+   *  @brief Clears the arrays
+   */
+  void clear ();
+
+  /**
+   *  @brief Adds a polygon
+   */
+  void add (const db::Polygon &polygon);
+
+  /**
+   *  @brief Gets the number of polygons stored
+   */
+  size_t size () const
+  {
+    return m_polygon_offsets.size () - 1;
+  }
+
+  /**
+   *  @brief Returns true if no polygon is stored
+   */
+  bool empty () const
+  {
+    return size () == 0;
+  }
+
+  /**
+   *  @brief Gets the polygon with the given index
+   */
+  db::Polygon polygon (size_t index) const;
+
+  /**
+   *  @brief Gets the coordinate array
+   */
+  const coordinates_type &coordinates () const
+  {
+    return m_coordinates;
+  }
+
+  /**
+   *  @brief Gets the contour offsets array
+   */
+  const offsets_type &contour_offsets () const
+  {
+    return m_contour_offsets;
+  }
+
+  /**
+   *  @brief Gets the polygon offsets array
+   */
+  const offsets_type &polygon_offsets () const
+  {
+    return m_polygon_offsets;
+  }
+
+private:
+  coordinates_type m_coordinates;
+  offsets_type m_contour_offsets;
+  offsets_type m_polygon_offsets;
+
+  void add_contour (const db::Polygon::contour_type &contour);
+  void validate ();
+};
+
+/**
+ *  @brief Converts an integer array into a byte array of 32 bit little-endian integers
+ *
+ *  This function will throw an exception if a value does not fit into 32 bits.
+ */
+DB_PUBLIC std::vector<char> pack_int32 (const std::vector<db::Coord> &values);
+
+/**
+ *  @brief Converts a byte array of 32 bit little-endian integers into an integer array
+ *
+ *  This function will throw an exception if the length of the data is not a multiple of 4.
+ */
+DB_PUBLIC std::vector<db::Coord> unpack_int32 (const std::vector<char> &data);
+
+}
+
+#endif
+
@@ -27,14 +27,107 @@
 #include "tlString.h"
 #include "tlAssert.h"
 
+#include <limits>
+
 namespace db
 {
 
+// ----------------------------------------------------------------------------------
+//  Hash functions for property sets
+
+static inline size_t
+hash_combine (size_t h, size_t v)
+{
+  return (h << 4) ^ (h >> 4) ^ v;
+}
+
+/**
+ *  @brief Maps a hash value to a bucket of a table with 2^bits entries
+ *
+ *  The combined hash values are weak in the low bits, so the bucket index is taken
+ *  from the high bits of a multiplicative mix.
+ */
+static inline size_t
+hash_bucket (size_t h, unsigned int bits)
+{
+  return bits == 0 ? 0 : size_t ((uint64_t (h) * 0x9e3779b97f4a7c15ull) >> (64 - bits));
+}
+
+static size_t
+hash_string (const char *cp)
+{
+  size_t h = 0;
+  while (*cp) {
+    h = (h << 4) ^ (h >> 4) ^ (size_t) (unsigned char) *cp++;
+  }
+  return h;
+}
+
+/**
+ *  @brief Computes a hash value for a variant
+ *
+ *  Variants which compare equal need to have the same hash value. As integer and
+ *  floating-point values of different types may be equal, all numerical values are
+ *  hashed through their double representation.
+ */
+static size_t
+hash_variant (const tl::Variant &v)
+{
+  if (v.is_nil ()) {
+    return 0;
+  } else if (v.is_bool ()) {
+    return v.to_bool () ? 2 : 1;
+  } else if (v.is_double () || v.is_char () || v.is_long () || v.is_ulong () || v.is_longlong () || v.is_ulonglong ()) {
+    double d = v.to_double ();
+    if (d == 0.0) {
+      //  normalizes -0.0
+      d = 0.0;
+    }
+    size_t h = 3;
+    const unsigned char *cp = (const unsigned char *) &d;
+    for (size_t i = 0; i < sizeof (d); ++i) {
+      h = hash_combine (h, size_t (cp [i]));
+    }
+    return h;
+  } else if (v.is_id ()) {
+    return hash_combine (4, v.to_id ());
+  } else if (v.is_a_string ()) {
+    return hash_combine (5, hash_string (v.to_string ()));
+  } else if (v.is_list ()) {
+    size_t h = 6;
+    for (tl::Variant::const_iterator i = v.begin (); i != v.end (); ++i) {
+      h = hash_combine (h, hash_variant (*i));
+    }
+    return h;
+  } else if (v.is_array ()) {
+    size_t h = 7;
+    for (tl::Variant::const_array_iterator i = v.begin_array (); i != v.end_array (); ++i) {
+      h = hash_combine (h, hash_combine (hash_variant (i->first), hash_variant (i->second)));
+    }
+    return h;
+  } else {
+    //  user types and others are not hashed individually
+    return 8;
+  }
+}
+
+static size_t
+hash_properties_set (const PropertiesRepository::properties_set &props)
+{
+  size_t h = props.size ();
+  for (PropertiesRepository::properties_set::const_iterator nv = props.begin (); nv != props.end (); ++nv) {
+    h = hash_combine (h, hash_combine (size_t (nv->first), hash_variant (nv->second)));
+  }
+  return h;
+}
+
+static const properties_id_type no_properties_id = std::numeric_limits<properties_id_type>::max ();
+
 // ----------------------------------------------------------------------------------
 //  PropertiesRepository implementation
 
 PropertiesRepository::PropertiesRepository (db::LayoutStateModel *state_model)
-  : mp_state_model (state_model)
+  : m_bucket_bits (0), m_index_dirty (false), mp_state_model (state_model)
 {
   //  install empty property set
   properties_set empty_set;
@@ -49,12 +142,75 @@ PropertiesRepository::operator= (const PropertiesRepository &d)
     m_propnames_by_id            = d.m_propnames_by_id;
     m_propname_ids_by_name       = d.m_propname_ids_by_name;
     m_properties_by_id           = d.m_properties_by_id;
-    m_properties_ids_by_set      = d.m_properties_ids_by_set;
+    m_properties_hashes          = d.m_properties_hashes;
+    m_properties_next            = d.m_properties_next;
+    m_properties_buckets         = d.m_properties_buckets;
+    m_bucket_bits                = d.m_bucket_bits;
+    m_index_dirty                = d.m_index_dirty;
     m_properties_component_table = d.m_properties_component_table;
   }
   return *this;
 }
 
+void
+PropertiesRepository::add_to_index (properties_id_type id)
+{
+  if (m_properties_buckets.empty ()) {
+    return;
+  }
+
+  size_t b = hash_bucket (m_properties_hashes [id], m_bucket_bits);
+  m_properties_next [id] = m_properties_buckets [b];
+  m_properties_buckets [b] = id;
+}
+
+void
+PropertiesRepository::remove_from_index (properties_id_type id)
+{
+  size_t b = hash_bucket (m_properties_hashes [id], m_bucket_bits);
+
+  properties_id_type *pid = &m_properties_buckets [b];
+  while (*pid != no_properties_id) {
+    if (*pid == id) {
+      *pid = m_properties_next [id];
+      m_properties_next [id] = no_properties_id;
+      return;
+    }
+    pid = &m_properties_next [*pid];
+  }
+}
+
+void
+PropertiesRepository::ensure_index ()
+{
+  size_t n = m_properties_by_id.size ();
+
+  if (m_index_dirty) {
+    //  the sets may have been modified: recompute the hash values
+    for (size_t id = 0; id < n; ++id) {
+      m_properties_hashes [id] = hash_properties_set (m_properties_by_id [id].second);
+    }
+  } else if (! m_properties_buckets.empty () && n * 2 <= m_properties_buckets.size ()) {
+    return;
+  }
+
+  //  rebuild the buckets with a load factor of 0.5 at most
+  size_t nb = 16;
+  m_bucket_bits = 4;
+  while (nb < n * 2) {
+    nb *= 2;
+    ++m_bucket_bits;
+  }
+
+  m_properties_buckets.clear ();
+  m_properties_buckets.resize (nb, no_properties_id);
+  for (size_t id = 0; id < n; ++id) {
+    add_to_index (id);
+  }
+
+  m_index_dirty = false;
+}
+
 std::pair<bool, property_names_id_type>
 PropertiesRepository::get_id_of_name (const tl::Variant &name) const
 {
@@ -72,7 +228,7 @@ PropertiesRepository::prop_name_id (const tl::Variant &name)
   std::map <tl::Variant, property_names_id_type>::const_iterator pi = m_propname_ids_by_name.find (name);
   if (pi == m_propname_ids_by_name.end ()) {
     property_names_id_type id = m_propnames_by_id.size ();
-    m_propnames_by_id.insert (std::make_pair (id, name));
+    m_propnames_by_id.push_back (name);
     m_propname_ids_by_name.insert (std::make_pair (name, id));
     return id;
   } else {
@@ -83,10 +239,11 @@ PropertiesRepository::prop_name_id (const tl::Variant &name)
 void 
 PropertiesRepository::change_properties (property_names_id_type id, const properties_set &new_props)
 {
-  const properties_set &old_props = properties (id);
+  if (id < m_properties_by_id.size ()) {
 
-  std::map <properties_set, properties_id_type>::const_iterator pi = m_properties_ids_by_set.find (old_props);
-  if (pi != m_properties_ids_by_set.end ()) {
+    ensure_index ();
+
+    const properties_set &old_props = m_properties_by_id [id].second;
 
     //  erase the id from the component table
     for (properties_set::const_iterator nv = old_props.begin (); nv != old_props.end (); ++nv) {
@@ -103,10 +260,12 @@ PropertiesRepository::change_properties (property_names_id_type id, const proper
     }
 
     //  and insert again
-    m_properties_ids_by_set.erase (old_props);
-    m_properties_ids_by_set.insert (std::make_pair (new_props, id));
+    remove_from_index (id);
+
+    m_properties_by_id [id].second = new_props;
+    m_properties_hashes [id] = hash_properties_set (new_props);
 
-    m_properties_by_id [id] = new_props;
+    add_to_index (id);
 
     for (properties_set::const_iterator nv = new_props.begin (); nv != new_props.end (); ++nv) {
       m_properties_component_table.insert (std::make_pair (*nv, properties_id_vector ())).first->second.push_back (id);
@@ -124,9 +283,8 @@ PropertiesRepository::change_properties (property_names_id_type id, const proper
 void 
 PropertiesRepository::change_name (property_names_id_type id, const tl::Variant &new_name)
 {
-  std::map <property_names_id_type, tl::Variant>::iterator pi = m_propnames_by_id.find (id);
-  tl_assert (pi != m_propnames_by_id.end ());
-  pi->second = new_name;
+  tl_assert (id < m_propnames_by_id.size ());
+  m_propnames_by_id [id] = new_name;
 
   m_propname_ids_by_name.insert (std::make_pair (new_name, id));
 }
@@ -134,41 +292,52 @@ PropertiesRepository::change_name (property_names_id_type id, const tl::Variant
 const tl::Variant &
 PropertiesRepository::prop_name (property_names_id_type id) const
 {
-  return m_propnames_by_id.find (id)->second;
+  return m_propnames_by_id [id];
 }
 
 properties_id_type 
 PropertiesRepository::properties_id (const properties_set &props)
 {
-  std::map <properties_set, properties_id_type>::const_iterator pi = m_properties_ids_by_set.find (props);
-  if (pi == m_properties_ids_by_set.end ()) {
+  ensure_index ();
 
-    properties_id_type id = m_properties_ids_by_set.size ();
-    m_properties_ids_by_set.insert (std::make_pair (props, id));
-    m_properties_by_id.insert (std::make_pair (id, props));
-    for (properties_set::const_iterator nv = props.begin (); nv != props.end (); ++nv) {
-      m_properties_component_table.insert (std::make_pair (*nv, properties_id_vector ())).first->second.push_back (id);
-    }
+  size_t h = hash_properties_set (props);
 
-    //  signal the change of the properties ID's. This way for example, the layer views
-    //  can recompute the property selectors
-    if (mp_state_model) {
-      mp_state_model->prop_ids_changed ();
+  for (properties_id_type id = m_properties_buckets [hash_bucket (h, m_bucket_bits)]; id != no_properties_id; id = m_properties_next [id]) {
+    if (m_properties_hashes [id] == h && m_properties_by_id [id].second == props) {
+      return id;
     }
+  }
 
-    return id;
+  properties_id_type id = m_properties_by_id.size ();
+  m_properties_by_id.push_back (std::make_pair (id, props));
+  m_properties_hashes.push_back (h);
+  m_properties_next.push_back (no_properties_id);
 
+  if (m_properties_by_id.size () * 2 <= m_properties_buckets.size ()) {
+    add_to_index (id);
   } else {
-    return pi->second;
+    //  grows the bucket table and adds the new entry
+    ensure_index ();
+  }
+
+  for (properties_set::const_iterator nv = props.begin (); nv != props.end (); ++nv) {
+    m_properties_component_table.insert (std::make_pair (*nv, properties_id_vector ())).first->second.push_back (id);
+  }
+
+  //  signal the change of the properties ID's. This way for example, the layer views
+  //  can recompute the property selectors
+  if (mp_state_model) {
+    mp_state_model->prop_ids_changed ();
   }
+
+  return id;
 }
 
 const PropertiesRepository::properties_set &
 PropertiesRepository::properties (properties_id_type id) const
 {
-  iterator p = m_properties_by_id.find (id);
-  if (p != m_properties_by_id.end ()) {
-    return p->second;
+  if (id < m_properties_by_id.size ()) {
+    return m_properties_by_id [id].second;
   } else {
     static PropertiesRepository::properties_set empty_set;
     return empty_set;
@@ -178,7 +347,7 @@ PropertiesRepository::properties (properties_id_type id) const
 bool
 PropertiesRepository::is_valid_properties_id (properties_id_type id) const
 {
-  return m_properties_by_id.find (id) != m_properties_by_id.end ();
+  return id < m_properties_by_id.size ();
 }
 
 const PropertiesRepository::properties_id_vector &
@@ -46,15 +46,19 @@ class LayoutStateModel;
  *  an unique Id which can be stored with a object_with_properties element.
  *  For performance reasons property names (which are strings) are not
  *  stored as such but as integers.
+ *
+ *  Property sets are stored once, in a vector indexed by the properties Id.
+ *  The lookup of the Id for a given set employs a hash table which refers
+ *  to this vector.
  */
 
 class DB_PUBLIC PropertiesRepository
 {
 public:
   typedef std::multimap <property_names_id_type, tl::Variant> properties_set;
-  typedef std::map <properties_id_type, properties_set> properties_map;
-  typedef std::map <properties_id_type, properties_set>::const_iterator iterator;
-  typedef std::map <properties_id_type, properties_set>::iterator non_const_iterator;
+  typedef std::vector <std::pair <properties_id_type, properties_set> > properties_map;
+  typedef properties_map::const_iterator iterator;
+  typedef properties_map::iterator non_const_iterator;
   typedef std::pair <property_names_id_type, tl::Variant> name_value_pair;
   typedef std::vector <properties_id_type> properties_id_vector;
 
@@ -143,6 +147,8 @@ public:
    */
   non_const_iterator begin_non_const () 
   {
+    //  the property sets may be modified, hence the hash index needs to be rebuilt
+    m_index_dirty = true;
     return m_properties_by_id.begin ();
   }
 
@@ -219,21 +225,32 @@ public:
     db::mem_stat (stat, purpose, cat, m_propnames_by_id, true, parent);
     db::mem_stat (stat, purpose, cat, m_propname_ids_by_name, true, parent);
     db::mem_stat (stat, purpose, cat, m_properties_by_id, true, parent);
-    db::mem_stat (stat, purpose, cat, m_properties_ids_by_set, true, parent);
+    db::mem_stat (stat, purpose, cat, m_properties_hashes, true, parent);
+    db::mem_stat (stat, purpose, cat, m_properties_next, true, parent);
+    db::mem_stat (stat, purpose, cat, m_properties_buckets, true, parent);
     db::mem_stat (stat, purpose, cat, m_properties_component_table, true, parent);
   }
 
 private:
-  std::map <property_names_id_type, tl::Variant> m_propnames_by_id;
+  std::vector <tl::Variant> m_propnames_by_id;
   std::map <tl::Variant, property_names_id_type> m_propname_ids_by_name;
 
-  std::map <properties_id_type, properties_set> m_properties_by_id;
-  std::map <properties_set, properties_id_type> m_properties_ids_by_set;
+  properties_map m_properties_by_id;
+  //  the hash index: the hash value and the next Id in the bucket's chain per Id and the first Id per bucket
+  std::vector <size_t> m_properties_hashes;
+  properties_id_vector m_properties_next;
+  properties_id_vector m_properties_buckets;
+  unsigned int m_bucket_bits;
+  bool m_index_dirty;
   std::map <name_value_pair, properties_id_vector> m_properties_component_table;
 
   db::LayoutStateModel *mp_state_model;
 
   PropertiesRepository (const PropertiesRepository &d);
+
+  void ensure_index ();
+  void add_to_index (properties_id_type id);
+  void remove_from_index (properties_id_type id);
 };
 
 /**
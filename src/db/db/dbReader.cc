@@ -34,7 +34,7 @@ namespace db
 //  ReaderBase implementation
 
 ReaderBase::ReaderBase () 
-  : m_warnings_as_errors (false)
+  : m_warnings_as_errors (false), mp_cell_receiver (0)
 { 
 }
 
@@ -48,6 +48,12 @@ ReaderBase::set_warnings_as_errors (bool f)
   m_warnings_as_errors = f;
 }
 
+void
+ReaderBase::set_cell_receiver (ReaderCellReceiver *receiver)
+{
+  mp_cell_receiver = receiver;
+}
+
 // ---------------------------------------------------------------
 //  Reader implementation
 
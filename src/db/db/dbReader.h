@@ -26,6 +26,7 @@
 #define HDR_dbReader
 
 #include "dbCommon.h"
+#include "dbTypes.h"
 
 #include "tlException.h"
 #include "tlInternational.h"
@@ -54,6 +55,29 @@ public:
   { }
 };
 
+/**
+ *  @brief An interface for receiving cells while they are read
+ *
+ *  Readers supporting this interface (see ReaderBase::supports_cell_receiver)
+ *  will deliver each cell once it has been read completely. This enables
+ *  streaming applications which process and discard cells while reading.
+ *  Child cells may be delivered after their parents.
+ */
+class DB_PUBLIC ReaderCellReceiver
+{
+public:
+  ReaderCellReceiver () { }
+  virtual ~ReaderCellReceiver () { }
+
+  /**
+   *  @brief Called when a cell has been read completely
+   *
+   *  The cell's instances can be iterated, although the layout is still under construction.
+   *  The receiver may modify the cell - specifically it may clear its shapes and instances.
+   */
+  virtual void cell_read (db::Layout &layout, db::cell_index_type cell_index) = 0;
+};
+
 /**
  *  @brief The generic reader base class
  */
@@ -81,8 +105,66 @@ public:
     return m_warnings_as_errors;
   }
 
+  /**
+   *  @brief Returns true, if the reader is able to deliver cells to a ReaderCellReceiver
+   */
+  virtual bool supports_cell_receiver () const
+  {
+    return false;
+  }
+
+  /**
+   *  @brief Sets the cell receiver
+   *  The receiver is not owned by the reader. Pass 0 to reset the receiver.
+   */
+  void set_cell_receiver (ReaderCellReceiver *receiver);
+
+  /**
+   *  @brief Gets the cell receiver or 0 if no receiver is set
+   */
+  ReaderCellReceiver *cell_receiver () const
+  {
+    return mp_cell_receiver;
+  }
+
+  /**
+   *  @brief Returns true, if there are cells whose content has not been loaded yet
+   *
+   *  Readers supporting deferred loading (e.g. the OASIS reader with the "lazy_loading"
+   *  option) build the cell hierarchy first and load the cell contents on request.
+   *  The reader and its stream need to stay alive for this purpose.
+   */
+  virtual bool has_deferred_cells () const
+  {
+    return false;
+  }
+
+  /**
+   *  @brief Returns true, if the content of the given cell has not been loaded yet
+   */
+  virtual bool is_deferred_cell (db::cell_index_type /*cell_index*/) const
+  {
+    return false;
+  }
+
+  /**
+   *  @brief Loads the content of the given cell if it has not been loaded yet
+   */
+  virtual void load_cell (db::Layout & /*layout*/, db::cell_index_type /*cell_index*/) { }
+
+  /**
+   *  @brief Loads the content of the given cell and all cells called by it
+   */
+  virtual void load_cell_tree (db::Layout & /*layout*/, db::cell_index_type /*cell_index*/) { }
+
+  /**
+   *  @brief Loads the content of all cells not loaded yet
+   */
+  virtual void load_all_cells (db::Layout & /*layout*/) { }
+
 private:
   bool m_warnings_as_errors;
+  ReaderCellReceiver *mp_cell_receiver;
 };
 
 /**
@@ -167,6 +249,64 @@ public:
     return mp_actual_reader->warnings_as_errors ();
   }
 
+  /**
+   *  @brief Returns true, if the actual reader is able to deliver cells to a ReaderCellReceiver
+   */
+  bool supports_cell_receiver () const
+  {
+    return mp_actual_reader->supports_cell_receiver ();
+  }
+
+  /**
+   *  @brief Sets the cell receiver
+   *  This receiver is only used if the reader supports cell receivers.
+   */
+  void set_cell_receiver (ReaderCellReceiver *receiver)
+  {
+    mp_actual_reader->set_cell_receiver (receiver);
+  }
+
+  /**
+   *  @brief Returns true, if there are cells whose content has not been loaded yet
+   *  See ReaderBase::has_deferred_cells for details.
+   */
+  bool has_deferred_cells () const
+  {
+    return mp_actual_reader->has_deferred_cells ();
+  }
+
+  /**
+   *  @brief Returns true, if the content of the given cell has not been loaded yet
+   */
+  bool is_deferred_cell (db::cell_index_type cell_index) const
+  {
+    return mp_actual_reader->is_deferred_cell (cell_index);
+  }
+
+  /**
+   *  @brief Loads the content of the given cell if it has not been loaded yet
+   */
+  void load_cell (db::Layout &layout, db::cell_index_type cell_index)
+  {
+    mp_actual_reader->load_cell (layout, cell_index);
+  }
+
+  /**
+   *  @brief Loads the content of the given cell and all cells called by it
+   */
+  void load_cell_tree (db::Layout &layout, db::cell_index_type cell_index)
+  {
+    mp_actual_reader->load_cell_tree (layout, cell_index);
+  }
+
+  /**
+   *  @brief Loads the content of all cells not loaded yet
+   */
+  void load_all_cells (db::Layout &layout)
+  {
+    mp_actual_reader->load_all_cells (layout);
+  }
+
 private:
   ReaderBase *mp_actual_reader;
   tl::InputStream &m_stream;
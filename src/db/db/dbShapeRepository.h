@@ -32,6 +32,11 @@
 #include "dbMemStatistics.h"
 
 #include <set>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <cmath>
+#include <new>
 
 namespace db {
 
@@ -42,12 +47,136 @@ template <class C> class edge;
 template <class C> class text;
 template <class C> class user_object;
 
+/**
+ *  @brief Hash functions for the repository
+ *
+ *  NOTE: dbHash.h can't be used here as it depends on the shape headers which
+ *  include this header. The hash functions are compatible with the fuzzy
+ *  compare of floating-point coordinates as far as possible.
+ */
+
+inline size_t repository_hash_combine (size_t h, size_t v)
+{
+  return (h << 4) ^ (h >> 4) ^ v;
+}
+
+/**
+ *  @brief Maps a hash value to a slot of a table with 2^bits entries
+ *
+ *  The combined hash values are weak in the low bits for shapes on a regular grid.
+ *  The multiplicative mixing spreads all bits of the hash value into the high bits
+ *  of the product which are taken as the slot index.
+ */
+inline size_t repository_hash_slot (size_t h, unsigned int bits)
+{
+  return bits == 0 ? 0 : size_t ((uint64_t (h) * 0x9e3779b97f4a7c15ull) >> (64 - bits));
+}
+
+inline size_t repository_hash_coord (db::Coord c)
+{
+  return size_t (c);
+}
+
+inline size_t repository_hash_coord (db::DCoord c)
+{
+  return size_t (int64_t (floor (0.5 + c / db::coord_traits<db::DCoord>::prec ())));
+}
+
+template <class Iter>
+inline size_t repository_hash_points (size_t h, Iter from, Iter to)
+{
+  for (Iter p = from; p != to; ++p) {
+    h = repository_hash_combine (h, repository_hash_combine (repository_hash_coord ((*p).x ()), repository_hash_coord ((*p).y ())));
+  }
+  return h;
+}
+
+template <class Sh> struct repository_hash;
+
+/**
+ *  @brief Packs the stored objects of a repository if requested (see repository::set_pack)
+ *
+ *  Only polygons can be packed - for other objects this is a no-op.
+ */
+template <class Sh>
+struct repository_pack
+{
+  static void pack (Sh & /*obj*/) { }
+};
+
+template <class C>
+struct repository_pack<db::polygon<C> >
+{
+  static void pack (db::polygon<C> &obj) { obj.pack (); }
+};
+
+template <class C>
+struct repository_pack<db::simple_polygon<C> >
+{
+  static void pack (db::simple_polygon<C> &obj) { obj.pack (); }
+};
+
+template <class C>
+struct repository_hash<db::polygon<C> >
+{
+  size_t operator() (const db::polygon<C> &o) const
+  {
+    size_t h = repository_hash_points (0, o.hull ().begin (), o.hull ().end ());
+    for (unsigned int i = 0; i < o.holes (); ++i) {
+      h = repository_hash_points (h, o.hole (i).begin (), o.hole (i).end ());
+    }
+    return h;
+  }
+};
+
+template <class C>
+struct repository_hash<db::simple_polygon<C> >
+{
+  size_t operator() (const db::simple_polygon<C> &o) const
+  {
+    return repository_hash_points (0, o.hull ().begin (), o.hull ().end ());
+  }
+};
+
+template <class C>
+struct repository_hash<db::path<C> >
+{
+  size_t operator() (const db::path<C> &o) const
+  {
+    size_t h = size_t (o.round ());
+    h = repository_hash_combine (h, repository_hash_coord (o.width ()));
+    h = repository_hash_combine (h, repository_hash_coord (o.bgn_ext ()));
+    h = repository_hash_combine (h, repository_hash_coord (o.end_ext ()));
+    return repository_hash_points (h, o.begin (), o.end ());
+  }
+};
+
+template <class C>
+struct repository_hash<db::text<C> >
+{
+  size_t operator() (const db::text<C> &o) const
+  {
+    size_t h = size_t (o.trans ().rot ());
+    h = repository_hash_combine (h, repository_hash_coord (o.trans ().disp ().x ()));
+    h = repository_hash_combine (h, repository_hash_coord (o.trans ().disp ().y ()));
+    for (const char *c = o.string (); *c; ++c) {
+      h = repository_hash_combine (h, size_t ((unsigned char) *c));
+    }
+    return h;
+  }
+};
+
 /**
  *  @brief A repository for a certain shape type
  *
  *  The repository is basically a set of shapes that
  *  can be used to store duplicates of shapes in an
  *  efficient way.
+ *
+ *  The shapes are kept in blocks of memory (an arena) so their addresses
+ *  are stable and there is no allocation per shape. A hash table with cached
+ *  hash values is used to find identical shapes. The shapes are delivered in
+ *  the order they have been inserted.
  */
 
 template <class Sh>
@@ -55,18 +184,103 @@ class repository
 {
 public:
   typedef typename Sh::coord_type coord_type;
-  typedef std::set<Sh> set_type;
-  typedef typename set_type::const_iterator iterator;
+
+  /**
+   *  @brief The iterator delivering the shapes of the repository
+   */
+  class iterator
+  {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Sh value_type;
+    typedef const Sh &reference;
+    typedef const Sh *pointer;
+    typedef ptrdiff_t difference_type;
+
+    iterator ()
+      : mp_rep (0), m_block (0), m_index (0)
+    { }
+
+    iterator (const repository<Sh> *rep, size_t block, size_t index)
+      : mp_rep (rep), m_block (block), m_index (index)
+    { }
+
+    bool operator== (const iterator &other) const
+    {
+      return m_block == other.m_block && m_index == other.m_index;
+    }
+
+    bool operator!= (const iterator &other) const
+    {
+      return ! operator== (other);
+    }
+
+    const Sh &operator* () const
+    {
+      return mp_rep->m_blocks [m_block][m_index];
+    }
+
+    const Sh *operator-> () const
+    {
+      return mp_rep->m_blocks [m_block] + m_index;
+    }
+
+    iterator &operator++ ()
+    {
+      if (++m_index == mp_rep->block_size (m_block)) {
+        m_index = 0;
+        ++m_block;
+      }
+      return *this;
+    }
+
+  private:
+    const repository<Sh> *mp_rep;
+    size_t m_block, m_index;
+  };
 
   /** 
    *  @brief The standard constructor
    */
   repository ()
-    : m_set ()
+    : m_table_bits (0), m_size (0), m_tail_block (0), m_tail_fill (0), m_pack (false)
   {
     //  .. nothing yet ..
   }
 
+  /**
+   *  @brief Copy constructor
+   */
+  repository (const repository<Sh> &other)
+    : m_table_bits (0), m_size (0), m_tail_block (0), m_tail_fill (0), m_pack (false)
+  {
+    operator= (other);
+  }
+
+  /**
+   *  @brief Assignment
+   */
+  repository &operator= (const repository<Sh> &other)
+  {
+    if (&other != this) {
+      clear ();
+      m_pack = other.m_pack;
+      reserve_table (other.size ());
+      for (iterator i = other.begin (); i != other.end (); ++i) {
+        insert (*i);
+      }
+    }
+    return *this;
+  }
+
+  /**
+   *  @brief Destructor
+   */
+  ~repository ()
+  {
+    clear ();
+  }
+
   /**
    *  @brief Insert a shape into the repository
    *
@@ -76,8 +290,43 @@ public:
    */
   const Sh *insert (const Sh &shape)
   {
-    typename std::set<Sh>::iterator f = m_set.insert (shape).first;
-    return &(*f);
+    if ((m_size + 1) * 2 > m_table.size ()) {
+      rehash (m_table.empty () ? 16 : m_table.size () * 2);
+    }
+
+    size_t h = repository_hash<Sh> () (shape);
+    size_t mask = m_table.size () - 1;
+
+    for (size_t i = repository_hash_slot (h, m_table_bits); ; i = (i + 1) & mask) {
+      entry &e = m_table [i];
+      if (! e.obj) {
+        e.hash = h;
+        e.obj = new_object (shape);
+        return e.obj;
+      } else if (e.hash == h && *e.obj == shape) {
+        return e.obj;
+      }
+    }
+  }
+
+  /**
+   *  @brief Sets a value indicating whether new objects are packed
+   *
+   *  If this flag is set, objects which are added to the repository are stored
+   *  in packed form (see db::polygon_contour::pack). This applies to polygons only.
+   *  Objects already present are not affected.
+   */
+  void set_pack (bool f)
+  {
+    m_pack = f;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether new objects are packed
+   */
+  bool pack () const
+  {
+    return m_pack;
   }
 
   /**
@@ -85,7 +334,7 @@ public:
    */
   size_t size () const
   {
-    return m_set.size ();
+    return m_size;
   }
 
   /**
@@ -93,7 +342,7 @@ public:
    */
   iterator begin () const
   {
-    return m_set.begin ();
+    return iterator (this, 0, 0);
   }
 
   /**
@@ -101,16 +350,132 @@ public:
    */
   iterator end () const
   {
-    return m_set.end ();
+    return iterator (this, m_tail_block, m_tail_fill);
   }
 
   void mem_stat (MemStatistics *stat, MemStatistics::purpose_t purpose, int cat, bool no_self, void *parent) const
   {
-    db::mem_stat (stat, purpose, cat, m_set, no_self, parent);
+    if (! no_self) {
+      stat->add (typeid (*this), (void *) this, sizeof (*this), sizeof (*this), parent, purpose, cat);
+    }
+    db::mem_stat (stat, purpose, cat, m_table, true, (void *) this);
+    db::mem_stat (stat, purpose, cat, m_blocks, true, (void *) this);
+    size_t n = m_size;
+    for (size_t b = 0; b < m_blocks.size (); ++b) {
+      size_t bs = block_size (b);
+      size_t nb = std::min (n, bs);
+      stat->add (typeid (Sh []), (void *) m_blocks [b], sizeof (Sh) * bs, sizeof (Sh) * nb, (void *) this, purpose, cat);
+      for (size_t i = 0; i < nb; ++i) {
+        db::mem_stat (stat, purpose, cat, m_blocks [b][i], true, (void *) m_blocks [b]);
+      }
+      n -= nb;
+    }
   }
 
 private:
-  set_type m_set;
+  friend class iterator;
+
+  struct entry
+  {
+    entry () : hash (0), obj (0) { }
+    size_t hash;
+    Sh *obj;
+  };
+
+  std::vector<entry> m_table;
+  unsigned int m_table_bits;
+  std::vector<Sh *> m_blocks;
+  size_t m_size;
+  //  The block the next object goes to and the number of objects already stored there
+  size_t m_tail_block, m_tail_fill;
+  bool m_pack;
+
+  //  The blocks grow in size from 16 to 4096 objects
+  static size_t block_size (size_t b)
+  {
+    return b < 8 ? (size_t (16) << b) : size_t (4096);
+  }
+
+  Sh *new_object (const Sh &shape)
+  {
+    if (m_tail_block == m_blocks.size ()) {
+      m_blocks.push_back (static_cast<Sh *> (::operator new (sizeof (Sh) * block_size (m_tail_block))));
+    }
+
+    Sh *obj = new (m_blocks [m_tail_block] + m_tail_fill) Sh (shape);
+    if (m_pack) {
+      //  NOTE: packing does not change the value nor the hash value
+      repository_pack<Sh>::pack (*obj);
+    }
+    ++m_size;
+
+    if (++m_tail_fill == block_size (m_tail_block)) {
+      m_tail_fill = 0;
+      ++m_tail_block;
+    }
+
+    return obj;
+  }
+
+  void reserve_table (size_t n)
+  {
+    if (n == 0) {
+      return;
+    }
+
+    size_t ts = 16;
+    while (n * 2 > ts) {
+      ts *= 2;
+    }
+    if (ts > m_table.size ()) {
+      rehash (ts);
+    }
+  }
+
+  void rehash (size_t n)
+  {
+    std::vector<entry> table;
+    table.resize (n);
+
+    unsigned int bits = 0;
+    while ((size_t (1) << bits) < n) {
+      ++bits;
+    }
+
+    size_t mask = n - 1;
+    for (typename std::vector<entry>::const_iterator e = m_table.begin (); e != m_table.end (); ++e) {
+      if (e->obj) {
+        size_t i = repository_hash_slot (e->hash, bits);
+        while (table [i].obj) {
+          i = (i + 1) & mask;
+        }
+        table [i] = *e;
+      }
+    }
+
+    m_table.swap (table);
+    m_table_bits = bits;
+  }
+
+  void clear ()
+  {
+    size_t n = m_size;
+    for (size_t b = 0; b < m_blocks.size (); ++b) {
+      size_t nb = std::min (n, block_size (b));
+      for (size_t i = 0; i < nb; ++i) {
+        m_blocks [b][i].~Sh ();
+      }
+      ::operator delete (m_blocks [b]);
+      n -= nb;
+    }
+
+    m_blocks.clear ();
+    m_table.clear ();
+    m_table_bits = 0;
+    m_size = 0;
+    m_tail_block = 0;
+    m_tail_fill = 0;
+  }
 };
 
 /**
@@ -176,6 +541,23 @@ public:
     return const_cast<generic_repository<C> *> (this)->repository (tag);
   }
 
+  /**
+   *  @brief Sets a value indicating whether polygons are packed when they are added
+   */
+  void set_pack_polygons (bool f)
+  {
+    m_polygon_repository.set_pack (f);
+    m_simple_polygon_repository.set_pack (f);
+  }
+
+  /**
+   *  @brief Gets a value indicating whether polygons are packed when they are added
+   */
+  bool pack_polygons () const
+  {
+    return m_polygon_repository.pack ();
+  }
+
   void mem_stat (MemStatistics *stat, MemStatistics::purpose_t purpose, int cat, bool no_self, void *parent) const
   {
     db::mem_stat (stat, purpose, cat, m_polygon_repository, no_self, parent);
@@ -155,6 +155,13 @@ Shapes::layout () const
   return c ? c->layout () : 0;
 }
 
+bool
+Shapes::pack_polygons_on_insert () const
+{
+  db::Layout *l = layout ();
+  return l && l->pack_polygons_on_insert ();
+}
+
 void
 Shapes::insert (const Shapes &d)
 {
@@ -934,6 +941,48 @@ Shapes::clear ()
   }
 }
 
+template <class Sh>
+static inline void
+pack_polygon (const Sh *sh)
+{
+  //  NOTE: packing changes the representation only, not the value (including the hash value
+  //  used by the shape repository). Hence it is safe to pack the polygon in-place, even if it
+  //  is a shared one from the shape repository. This is not safe against concurrent readers
+  //  however - see the documentation of pack_polygons.
+  const_cast<Sh *> (sh)->pack ();
+}
+
+void
+Shapes::pack_polygons ()
+{
+  for (shape_iterator s = begin (shape_iterator::Polygons); ! s.at_end (); ++s) {
+    switch (s->type ()) {
+    case shape_type::Polygon:
+      pack_polygon (s->basic_ptr (shape_type::polygon_type::tag ()));
+      break;
+    case shape_type::PolygonRef:
+      pack_polygon (s->basic_ptr (shape_type::polygon_ref_type::tag ())->ptr ());
+      break;
+    case shape_type::PolygonPtrArray:
+    case shape_type::PolygonPtrArrayMember:
+      pack_polygon (s->basic_ptr (shape_type::polygon_ptr_array_type::tag ())->object ().ptr ());
+      break;
+    case shape_type::SimplePolygon:
+      pack_polygon (s->basic_ptr (shape_type::simple_polygon_type::tag ()));
+      break;
+    case shape_type::SimplePolygonRef:
+      pack_polygon (s->basic_ptr (shape_type::simple_polygon_ref_type::tag ())->ptr ());
+      break;
+    case shape_type::SimplePolygonPtrArray:
+    case shape_type::SimplePolygonPtrArrayMember:
+      pack_polygon (s->basic_ptr (shape_type::simple_polygon_ptr_array_type::tag ())->object ().ptr ());
+      break;
+    default:
+      break;
+    }
+  }
+}
+
 void Shapes::update_bbox ()
 {
   for (tl::vector<LayerBase *>::const_iterator l = m_layers.begin (); l != m_layers.end (); ++l) {
@@ -945,7 +994,7 @@ void Shapes::update_bbox ()
 void Shapes::update () 
 {
   for (tl::vector<LayerBase *>::const_iterator l = m_layers.begin (); l != m_layers.end (); ++l) {
-    (*l)->sort ();
+    (*l)->sort (0);
     (*l)->update_bbox ();
   }
   set_dirty (false);
@@ -973,10 +1022,10 @@ Shapes::box_type Shapes::bbox () const
   return box;
 }
 
-void Shapes::sort () 
+void Shapes::sort (db::box_tree_sort_scheduler *scheduler) 
 {
   for (tl::vector<LayerBase *>::const_iterator l = m_layers.begin (); l != m_layers.end (); ++l) {
-    (*l)->sort ();
+    (*l)->sort (scheduler);
   }
 }
 
@@ -484,7 +484,7 @@ public:
   virtual bool is_bbox_dirty () const = 0;
   virtual size_t size () const = 0;
   virtual bool empty () const = 0;
-  virtual void sort () = 0;
+  virtual void sort (db::box_tree_sort_scheduler *scheduler) = 0;
   virtual void clear (Shapes *target, db::Manager *manager) = 0;
   virtual LayerBase *clone (Shapes *target, db::Manager *manager) const = 0;
   virtual void translate_into (Shapes *target, GenericRepository &rep, ArrayRepository &array_rep) const = 0;
@@ -504,6 +504,44 @@ public:
   virtual void mem_stat (MemStatistics *stat, MemStatistics::purpose_t purpose, int cat, bool no_self, void *parent) const;
 };
 
+/**
+ *  @brief Tells whether a shape type is packed on insert (see Layout::set_pack_polygons_on_insert)
+ */
+template <class Sh>
+struct shape_pack_traits
+{
+  static bool packable () { return false; }
+  static void pack (Sh & /*sh*/) { }
+};
+
+template <>
+struct shape_pack_traits<db::Polygon>
+{
+  static bool packable () { return true; }
+  static void pack (db::Polygon &sh) { sh.pack (); }
+};
+
+template <>
+struct shape_pack_traits<db::PolygonWithProperties>
+{
+  static bool packable () { return true; }
+  static void pack (db::PolygonWithProperties &sh) { sh.pack (); }
+};
+
+template <>
+struct shape_pack_traits<db::SimplePolygon>
+{
+  static bool packable () { return true; }
+  static void pack (db::SimplePolygon &sh) { sh.pack (); }
+};
+
+template <>
+struct shape_pack_traits<db::SimplePolygonWithProperties>
+{
+  static bool packable () { return true; }
+  static void pack (db::SimplePolygonWithProperties &sh) { sh.pack (); }
+};
+
 /**
  *  @brief A "shapes" collection
  *  
@@ -795,6 +833,8 @@ public:
    *  already existed.
    *  Inserting a shape will invalidate the bbox and the sorting
    *  state.
+   *  Polygons are stored in packed form if the layout has
+   *  "pack polygons on insert" mode enabled.
    *
    *  @param sh The shape to insert (copy)
    *  
@@ -803,18 +843,12 @@ public:
   template <class Sh>
   shape_type insert (const Sh &sh)
   {
-    if (manager () && manager ()->transacting ()) {
-      if (is_editable ()) {
-        db::layer_op<Sh, db::stable_layer_tag>::queue_or_append (manager (), this, true /*insert*/, sh);
-      } else {
-        db::layer_op<Sh, db::unstable_layer_tag>::queue_or_append (manager (), this, true /*insert*/, sh);
-      }
-    }
-    invalidate_state ();  //  HINT: must come before the change is done!
-    if (is_editable ()) {
-      return shape_type (this, get_layer<Sh, db::stable_layer_tag> ().insert (sh));
+    if (shape_pack_traits<Sh>::packable () && pack_polygons_on_insert ()) {
+      Sh packed (sh);
+      shape_pack_traits<Sh>::pack (packed);
+      return insert_shape (packed);
     } else {
-      return shape_type (this, *get_layer<Sh, db::unstable_layer_tag> ().insert (sh));
+      return insert_shape (sh);
     }
   }
 
@@ -903,6 +937,12 @@ public:
   void insert (Iter from, Iter to)
   {
     typedef typename std::iterator_traits <Iter>::value_type value_type;
+    if (shape_pack_traits<value_type>::packable () && pack_polygons_on_insert ()) {
+      for (Iter i = from; i != to; ++i) {
+        insert (*i);
+      }
+      return;
+    }
     if (manager () && manager ()->transacting ()) {
       if (is_editable ()) {
         db::layer_op<value_type, db::stable_layer_tag>::queue_or_append (manager (), this, true /*insert*/, from, to);
@@ -1200,8 +1240,28 @@ public:
    *
    *  Sorting the trees is required after insert operations
    *  and is performed only as far as necessary.
+   *  If a scheduler is given, large trees are sorted in tasks executed by the
+   *  scheduler. The shapes must not be used before these tasks have finished.
+   */
+  void sort (db::box_tree_sort_scheduler *scheduler = 0);
+
+  /**
+   *  @brief Packs the polygons 
+   *
+   *  This will pack the contours of all polygons and simple polygons stored
+   *  in this container, including the ones referenced by polygon references.
+   *  Packing reduces the memory footprint but leaves the polygons unchanged
+   *  (see db::polygon_contour::pack).
+   *
+   *  This is a one-time compaction, not a property of the container: polygons
+   *  inserted later are not packed and modifying a polygon unpacks it again.
+   *  Polygons referenced by polygon references live in the shared shape
+   *  repository and are packed in-place for all their users. Hence this method
+   *  must not be called while other threads read the shapes of the layout.
+   *  To store polygons in packed form right away, use
+   *  Layout::set_pack_polygons_on_insert instead.
    */
-  void sort ();
+  void pack_polygons ();
 
   /**
    *  @brief Clears the collection
@@ -1464,6 +1524,7 @@ public:
 
 private:
   friend class ShapeIterator;
+  friend class Cell;
 
   tl::vector<LayerBase *> m_layers;
   db::Cell *mp_cell;  //  HINT: contains "dirty" in bit 0 and "editable" in bit 1
@@ -1471,6 +1532,27 @@ private:
   void invalidate_state ();
   void do_insert (const Shapes &d);
 
+  //  gets a value indicating whether polygons are packed on insert (see Layout::set_pack_polygons_on_insert)
+  bool pack_polygons_on_insert () const;
+
+  template <class Sh>
+  shape_type insert_shape (const Sh &sh)
+  {
+    if (manager () && manager ()->transacting ()) {
+      if (is_editable ()) {
+        db::layer_op<Sh, db::stable_layer_tag>::queue_or_append (manager (), this, true /*insert*/, sh);
+      } else {
+        db::layer_op<Sh, db::unstable_layer_tag>::queue_or_append (manager (), this, true /*insert*/, sh);
+      }
+    }
+    invalidate_state ();  //  HINT: must come before the change is done!
+    if (is_editable ()) {
+      return shape_type (this, get_layer<Sh, db::stable_layer_tag> ().insert (sh));
+    } else {
+      return shape_type (this, *get_layer<Sh, db::unstable_layer_tag> ().insert (sh));
+    }
+  }
+
   //  extract dirty flag from mp_cell
   bool is_dirty () const 
   {
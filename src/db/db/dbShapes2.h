@@ -136,9 +136,9 @@ public:
     return m_layer.empty ();
   }
 
-  virtual void sort () 
+  virtual void sort (db::box_tree_sort_scheduler *scheduler) 
   {
-    m_layer.sort ();
+    m_layer.sort (scheduler);
   }
 
   virtual void clear (Shapes *target, db::Manager *manager);
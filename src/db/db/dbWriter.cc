@@ -32,6 +32,30 @@
 namespace db
 {
 
+// ---------------------------------------------------------------
+//  WriterBase implementation
+
+void
+WriterBase::begin_cell_streaming (db::Layout & /*layout*/, tl::OutputStream & /*stream*/, const db::SaveLayoutOptions &options)
+{
+  throw tl::Exception (tl::to_string (tr ("Cell streaming is not supported for format: %s")), options.format ());
+}
+
+void
+WriterBase::write_cell_streaming (db::cell_index_type /*cell_index*/)
+{
+  throw tl::Exception (tl::to_string (tr ("Cell streaming is not supported by this writer")));
+}
+
+void
+WriterBase::end_cell_streaming ()
+{
+  throw tl::Exception (tl::to_string (tr ("Cell streaming is not supported by this writer")));
+}
+
+// ---------------------------------------------------------------
+//  Writer implementation
+
 Writer::Writer (const db::SaveLayoutOptions &options)
   : mp_writer (0), m_options (options)
 {
@@ -62,5 +86,32 @@ Writer::write (db::Layout &layout, tl::OutputStream &stream)
   mp_writer->write (layout, stream, m_options);
 }
 
+bool
+Writer::supports_cell_streaming () const
+{
+  return mp_writer != 0 && mp_writer->supports_cell_streaming ();
+}
+
+void
+Writer::begin_cell_streaming (db::Layout &layout, tl::OutputStream &stream)
+{
+  tl_assert (mp_writer != 0);
+  mp_writer->begin_cell_streaming (layout, stream, m_options);
+}
+
+void
+Writer::write_cell_streaming (db::cell_index_type cell_index)
+{
+  tl_assert (mp_writer != 0);
+  mp_writer->write_cell_streaming (cell_index);
+}
+
+void
+Writer::end_cell_streaming ()
+{
+  tl_assert (mp_writer != 0);
+  mp_writer->end_cell_streaming ();
+}
+
 }
 
@@ -61,6 +61,41 @@ public:
    *  The layout is non-const since the writer may modify the meta information of the layout.
    */
   virtual void write (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options) = 0;
+
+  /**
+   *  @brief Returns true, if the writer supports cell-by-cell streaming
+   *
+   *  Writers supporting this mode can write cells one by one while the layout is
+   *  still being built (e.g. by a reader). Once a cell has been written it is not
+   *  needed any longer and its content may be discarded.
+   */
+  virtual bool supports_cell_streaming () const
+  {
+    return false;
+  }
+
+  /**
+   *  @brief Starts cell-by-cell streaming
+   *
+   *  This method will write the header. The layout's database unit must be set already.
+   *  The layout must stay alive until "end_cell_streaming" has been called.
+   */
+  virtual void begin_cell_streaming (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options);
+
+  /**
+   *  @brief Writes a single cell in streaming mode
+   *
+   *  The cell needs to be complete - i.e. all shapes and instances must be present. Child cells
+   *  do not need to be written before.
+   */
+  virtual void write_cell_streaming (db::cell_index_type cell_index);
+
+  /**
+   *  @brief Finishes cell-by-cell streaming
+   *
+   *  This method will write the remaining cells and the trailer.
+   */
+  virtual void end_cell_streaming ();
 };
 
 /**
@@ -96,6 +131,27 @@ public:
     return mp_writer != 0;
   }
 
+  /**
+   *  @brief Returns true, if the writer supports cell-by-cell streaming
+   *  See WriterBase::supports_cell_streaming for details.
+   */
+  bool supports_cell_streaming () const;
+
+  /**
+   *  @brief Starts cell-by-cell streaming
+   */
+  void begin_cell_streaming (db::Layout &layout, tl::OutputStream &stream);
+
+  /**
+   *  @brief Writes a single cell in cell-by-cell streaming mode
+   */
+  void write_cell_streaming (db::cell_index_type cell_index);
+
+  /**
+   *  @brief Finishes cell-by-cell streaming
+   */
+  void end_cell_streaming ();
+
 private:
   WriterBase *mp_writer;
   db::SaveLayoutOptions m_options;
@@ -566,6 +566,33 @@ Class<db::EdgeProcessor> decl_EdgeProcessor ("db", "EdgeProcessor",
     "\n"
     "This method has been introduced in version 0.23.\n"
   ) +
+  method ("threads=", &db::EdgeProcessor::set_threads, gsi::arg ("n"),
+    "@brief Sets the number of threads to use for the scanline sweep\n"
+    "With more than one thread, the edges are partitioned into horizontal bands which are processed in parallel. "
+    "The results are identical to the single-threaded processing. Small edge sets are always processed on a single thread.\n"
+    "The initial value is taken from \\default_threads.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
+  method ("threads", &db::EdgeProcessor::threads,
+    "@brief Gets the number of threads to use for the scanline sweep\n"
+    "See \\threads= for details.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
+  method ("default_threads=", &db::EdgeProcessor::set_default_threads, gsi::arg ("n"),
+    "@brief Sets the number of threads used by newly created edge processors\n"
+    "This is a global setting which also applies to the flat operations of \\Region and \\Edges. "
+    "0 or 1 (the default) means single-threaded processing.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
+  method ("default_threads", &db::EdgeProcessor::default_threads,
+    "@brief Gets the number of threads used by newly created edge processors\n"
+    "See \\default_threads= for details.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
   method ("ModeAnd|#mode_and", &gsi::mode_and, "@brief boolean method's mode value for AND operation") +
   method ("ModeOr|#mode_or", &gsi::mode_or, "@brief boolean method's mode value for OR operation") +
   method ("ModeXor|#mode_xor", &gsi::mode_xor, "@brief boolean method's mode value for XOR operation") +
@@ -30,6 +30,7 @@
 #include "dbRegion.h"
 #include "dbOriginalLayerRegion.h"
 #include "dbLayoutUtils.h"
+#include "dbPolygonArrays.h"
 
 namespace gsi
 {
@@ -369,6 +370,38 @@ static void insert_e (db::Edges *e, const db::Edges &a)
   }
 }
 
+static void insert_coordinates (db::Edges *e, const std::vector<db::Coord> &c)
+{
+  if (c.size () % 4 != 0) {
+    throw tl::Exception (tl::to_string (tr ("The number of coordinates must be a multiple of 4")));
+  }
+  for (size_t i = 0; i < c.size (); i += 4) {
+    e->insert (db::Edge (c [i], c [i + 1], c [i + 2], c [i + 3]));
+  }
+}
+
+static std::vector<db::Coord> coordinates (const db::Edges *e)
+{
+  std::vector<db::Coord> c;
+  for (db::Edges::const_iterator p = e->begin (); ! p.at_end (); ++p) {
+    c.push_back (p->x1 ());
+    c.push_back (p->y1 ());
+    c.push_back (p->x2 ());
+    c.push_back (p->y2 ());
+  }
+  return c;
+}
+
+static void insert_coordinates_packed (db::Edges *e, const std::vector<char> &data)
+{
+  insert_coordinates (e, db::unpack_int32 (data));
+}
+
+static std::vector<char> coordinates_packed (const db::Edges *e)
+{
+  return db::pack_int32 (coordinates (e));
+}
+
 template <class Trans>
 static void insert_st (db::Edges *e, const db::Shapes &a, const Trans &t)
 {
@@ -653,6 +686,34 @@ Class<db::Edges> dec_Edges (decl_dbShapeCollection, "db", "Edges",
     "@brief Inserts all edges from the other edge collection into this one\n"
     "This method has been introduced in version 0.25."
   ) +
+  method_ext ("insert_coordinates", &insert_coordinates, gsi::arg ("coordinates"),
+    "@brief Inserts edges given by a flat coordinate array\n"
+    "The array holds four values per edge: x1, y1, x2 and y2. This method is the counterpart of \\coordinates "
+    "and allows supplying edges in bulk.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  method_ext ("coordinates", &coordinates,
+    "@brief Gets the edges in the form of a flat coordinate array\n"
+    "The array holds four values per edge: x1, y1, x2 and y2. The edges are the same than delivered by \\each. "
+    "This is much faster than iterating the edges if the coordinates are required in bulk.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  method_ext ("insert_coordinates_packed", &insert_coordinates_packed, gsi::arg ("data"),
+    "@brief Inserts edges given by a packed coordinate array\n"
+    "The packed form is a byte string of 32 bit signed little-endian integers with four values per edge: x1, y1, x2 and y2. "
+    "This method is the counterpart of \\coordinates_packed.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  method_ext ("coordinates_packed", &coordinates_packed,
+    "@brief Gets the edges in the form of a packed coordinate array\n"
+    "This method delivers the same values than \\coordinates, but as a byte string of 32 bit signed little-endian integers. "
+    "See \\PolygonArrays#packed for details about the packed form.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
   method_ext ("insert", &insert_r, gsi::arg ("region"),
     "@brief Inserts a region\n"
     "Inserts the edges that form the contours of the polygons from the region into the edge collection.\n"
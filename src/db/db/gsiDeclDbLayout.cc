@@ -1332,6 +1332,21 @@ Class<db::Layout> decl_Layout ("db", "Layout",
     "This method is provided to ensure this explicitly. This can be useful while using \\start_changes and \\end_changes to wrap a performance-critical operation. "
     "See \\start_changes for more details."
   ) +
+  gsi::method ("update_threads=", &db::Layout::set_update_threads, gsi::arg ("n"),
+    "@brief Sets the number of threads used for sorting the shapes when the layout is updated\n"
+    "This is a global setting. With more than one thread, the shapes of different cells and layers are sorted in parallel "
+    "and large shape containers are sorted on multiple threads too. This is useful after reading or creating large layouts. "
+    "The multi-threaded mode is only used if there is a substantial number of shapes to sort. "
+    "0 (the default) means single-threaded sorting.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
+  gsi::method ("update_threads", &db::Layout::update_threads,
+    "@brief Gets the number of threads used for sorting the shapes when the layout is updated\n"
+    "See \\update_threads= for details.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
   gsi::method ("cleanup", &db::Layout::cleanup,
     "@brief Cleans up the layout\n"
     "This method will remove proxy objects that are no longer in use. After changing PCell parameters such "
@@ -1554,6 +1569,40 @@ Class<db::Layout> decl_Layout ("db", "Layout",
     "\n"
     "@param layer_index The index of the layer to delete.\n"
   ) +
+  gsi::method ("pack_polygons", (void (db::Layout::*) (unsigned int)) &db::Layout::pack_polygons, gsi::arg ("layer_index"),
+    "@brief Packs the polygons on the given layer\n"
+    "\n"
+    "Packing stores the polygon contours in a delta-encoded form. This reduces the memory footprint of "
+    "polygons with many points and small distances between the points - for example curvilinear or OPC shapes. "
+    "The polygons remain unchanged otherwise. Modifying a polygon will unpack it again.\n"
+    "\n"
+    "Packing is a one-time compaction of the polygons present on the layer. It is not a property of the layer: "
+    "polygons added later are not packed. Call this method again after the layer has been populated.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
+  gsi::method ("pack_polygons", (void (db::Layout::*) ()) &db::Layout::pack_polygons,
+    "@brief Packs the polygons on all layers\n"
+    "\n"
+    "See \\pack_polygons with a layer index argument for details.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
+  gsi::method ("pack_polygons_on_insert=", &db::Layout::set_pack_polygons_on_insert, gsi::arg ("flag"),
+    "@brief Sets a value indicating whether polygons are packed when they are inserted\n"
+    "\n"
+    "If this flag is set, polygons and simple polygons inserted into the layout are stored in the packed form "
+    "(see \\pack_polygons). Polygons already present are not affected. Setting this flag before a layout is "
+    "populated - e.g. before reading a file into it - avoids a separate packing step.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
+  gsi::method ("pack_polygons_on_insert?", &db::Layout::pack_polygons_on_insert,
+    "@brief Gets a value indicating whether polygons are packed when they are inserted\n"
+    "See \\pack_polygons_on_insert= for details.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
   gsi::method ("delete_layer", &db::Layout::delete_layer, gsi::arg ("layer_index"),
     "@brief Deletes a layer\n"
     "\n"
@@ -194,6 +194,9 @@ Class<db::LayoutToNetlist> decl_dbLayoutToNetlist ("db", "LayoutToNetlist",
   ) +
   gsi::method ("threads=", &db::LayoutToNetlist::set_threads, gsi::arg ("n"),
     "@brief Sets the number of threads to use for operations which support multiple threads\n"
+    "\n"
+    "Since version 0.27, the number of threads also applies to the net extraction: the shape clusters "
+    "of the cells are computed in parallel then.\n"
   ) +
   gsi::method ("threads", &db::LayoutToNetlist::threads,
     "@brief Gets the number of threads to use for operations which support multiple threads\n"
@@ -100,6 +100,14 @@ Class<db::LayoutVsSchematic> decl_dbLayoutVsSchematic (decl_dbLayoutToNetlist, "
   ) +
   gsi::method ("compare", &db::LayoutVsSchematic::compare_netlists, gsi::arg ("comparer"),
     "@brief Compare the layout-extracted netlist against the reference netlist using the given netlist comparer.\n"
+    "If the comparer does not have a compare cache attached (see \\NetlistComparer#cache=), the cache of this "
+    "object is used (see \\compare_cache). Hence when comparing again, only the circuits which have changed are "
+    "compared again. The compare cache has been introduced in version 0.27.\n"
+  ) +
+  gsi::method ("compare_cache", &db::LayoutVsSchematic::compare_cache,
+    "@brief Gets the compare cache used by \\compare\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
   ) +
   gsi::method ("xref", (db::NetlistCrossReference *(db::LayoutVsSchematic::*) ()) &db::LayoutVsSchematic::cross_ref,
     "@brief Gets the cross-reference object\n"
@@ -442,6 +442,41 @@ Class<GenericNetlistCompareLogger> decl_GenericNetlistCompareLogger (decl_dbNetl
   "This class has been introduced in version 0.26.\n"
 );
 
+Class<db::NetlistCompareCache> decl_dbNetlistCompareCache ("db", "NetlistCompareCache",
+  gsi::method ("clear", &db::NetlistCompareCache::clear,
+    "@brief Clears the cache\n"
+    "This method also resets the hit counter."
+  ) +
+  gsi::method ("size", &db::NetlistCompareCache::size,
+    "@brief Gets the number of circuit pairs stored in the cache\n"
+  ) +
+  gsi::method ("hits", &db::NetlistCompareCache::hits,
+    "@brief Gets the number of circuit compare results taken from the cache\n"
+  ) +
+  gsi::method ("save", &db::NetlistCompareCache::save, gsi::arg ("path"),
+    "@brief Saves the cache to the given file\n"
+    "With \\load, the cache can be restored in a later session, so unchanged circuits do not need to be compared again."
+  ) +
+  gsi::method ("load", &db::NetlistCompareCache::load, gsi::arg ("path"),
+    "@brief Loads the cache from the given file\n"
+    "The present entries are replaced by the ones from the file. The hit counter is reset."
+  ),
+  "@brief A cache for netlist compare results\n"
+  "Attach this object to one or more \\NetlistComparer objects with \\NetlistComparer#cache=. "
+  "The comparer will then store the compare results per circuit pair in the cache. When the netlists are "
+  "compared again, the results of unchanged circuit pairs are taken from the cache. A circuit pair is "
+  "considered unchanged if both circuits, the results of their child circuits and the compare settings "
+  "did not change. Hence after a local modification, only the modified circuits and the circuits above them "
+  "are compared again.\n"
+  "\n"
+  "The compare settings include the device classes and their parameter compare tolerances. With parameter "
+  "compare delegates implemented in scripts (see \\GenericDeviceParameterCompare), the cache is not used.\n"
+  "\n"
+  "The cache can be saved to a file and loaded again with \\save and \\load.\n"
+  "\n"
+  "This class has been introduced in version 0.27.\n"
+);
+
 static db::NetlistComparer *make_comparer0 ()
 {
   return new db::NetlistComparer ();
@@ -524,6 +559,21 @@ Class<db::NetlistComparer> decl_dbNetlistComparer ("db", "NetlistComparer",
     "@brief Gets the maximum seach depth\n"
     "See \\max_depth= for details."
   ) +
+  gsi::method ("max_refinement_iterations=", &db::NetlistComparer::set_max_refinement_iterations, gsi::arg ("n"),
+    "@brief Sets the maximum number of node class refinement iterations\n"
+    "Before the backtracking algorithm is employed, the nets of both netlists are classified\n"
+    "iteratively by their neighborhood. Nets of different classes are not considered\n"
+    "as matching candidates. This value limits the number of iterations. The iteration stops earlier\n"
+    "if the classification does not change any longer.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
+  gsi::method ("max_refinement_iterations", &db::NetlistComparer::max_refinement_iterations,
+    "@brief Gets the maximum number of node class refinement iterations\n"
+    "See \\max_refinement_iterations= for details.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
   gsi::method ("max_branch_complexity=", &db::NetlistComparer::set_max_branch_complexity, gsi::arg ("n"),
     "@brief Sets the maximum branch complexity\n"
     "This value limits the maximum branch complexity of the backtracking algorithm.\n"
@@ -550,6 +600,36 @@ Class<db::NetlistComparer> decl_dbNetlistComparer ("db", "NetlistComparer",
     "@brief Gets a value indicating whether net names shall not be considered\n"
     "See \\dont_consider_net_names= for details."
   ) +
+  gsi::method ("threads=", &db::NetlistComparer::set_threads, gsi::arg ("n"),
+    "@brief Sets the number of threads to use for the compare\n"
+    "With a thread count of 0 (the default), the circuits are compared in the calling thread. "
+    "Otherwise, circuits which don't depend on each other are compared in parallel. "
+    "The compare events are delivered to the logger in the calling thread and in the same order as "
+    "without threads. Hence the result does not depend on the number of threads.\n"
+    "\n"
+    "If device classes use parameter compare delegates implemented in a script, the circuits are compared "
+    "in the calling thread always.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
+  gsi::method ("threads", &db::NetlistComparer::threads,
+    "@brief Gets the number of threads to use for the compare\n"
+    "See \\threads= for details.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
+  gsi::method ("cache=", &db::NetlistComparer::set_cache, gsi::arg ("cache"),
+    "@brief Attaches a compare cache\n"
+    "With a cache, the compare results of unchanged circuit pairs are taken from previous compare runs "
+    "using the same cache. See \\NetlistCompareCache for details. Pass nil to detach the cache.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
+  gsi::method ("cache", &db::NetlistComparer::cache,
+    "@brief Gets the compare cache or nil if no cache is attached\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
   gsi::method_ext ("unmatched_circuits_a", &unmatched_circuits_a, gsi::arg ("a"), gsi::arg ("b"),
     "@brief Returns a list of circuits in A for which there is not corresponding circuit in B\n"
     "This list can be used to flatten these circuits so they do not participate in the compare process.\n"
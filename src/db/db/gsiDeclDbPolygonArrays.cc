@@ -0,0 +1,142 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "gsiDecl.h"
+#include "dbPolygonArrays.h"
+
+namespace gsi
+{
+
+static db::PolygonArrays *new_arrays (const db::PolygonArrays::coordinates_type &coordinates, const db::PolygonArrays::offsets_type &contour_offsets, const db::PolygonArrays::offsets_type &polygon_offsets)
+{
+  return new db::PolygonArrays (coordinates, contour_offsets, polygon_offsets);
+}
+
+static db::PolygonArrays *new_arrays_from_packed (const std::vector<char> &data)
+{
+  return new db::PolygonArrays (db::PolygonArrays::from_packed (data));
+}
+
+static void add_polygons (db::PolygonArrays *arrays, const std::vector<db::Polygon> &polygons)
+{
+  for (std::vector<db::Polygon>::const_iterator p = polygons.begin (); p != polygons.end (); ++p) {
+    arrays->add (*p);
+  }
+}
+
+static db::Polygon polygon_at (const db::PolygonArrays *arrays, size_t index)
+{
+  if (index >= arrays->size ()) {
+    throw tl::Exception (tl::to_string (tr ("Polygon index out of range")));
+  }
+  return arrays->polygon (index);
+}
+
+Class<db::PolygonArrays> decl_PolygonArrays ("db", "PolygonArrays",
+  gsi::constructor ("new", &new_arrays, gsi::arg ("coordinates"), gsi::arg ("contour_offsets"), gsi::arg ("polygon_offsets"),
+    "@brief Creates a polygon array object from the given arrays\n"
+    "\n"
+    "@param coordinates The x and y coordinates of all points (x0, y0, x1, y1, ...)\n"
+    "@param contour_offsets The index of the first point of each contour plus the total number of points\n"
+    "@param polygon_offsets The index of the first contour of each polygon plus the total number of contours\n"
+    "\n"
+    "An error is raised if the arrays are not consistent."
+  ) +
+  gsi::constructor ("from_packed", &new_arrays_from_packed, gsi::arg ("data"),
+    "@brief Creates a polygon array object from the packed binary form\n"
+    "\n"
+    "@param data The packed form as delivered by \\packed\n"
+    "\n"
+    "See \\packed for a description of the format. An error is raised if the data is not consistent."
+  ) +
+  gsi::method ("packed", &db::PolygonArrays::to_packed,
+    "@brief Gets the arrays in packed binary form\n"
+    "\n"
+    "The packed form is a byte string of 32 bit signed little-endian integers. The first three "
+    "values are the number of polygons, contours and points. They are followed by the polygon offsets "
+    "(number of polygons plus one values), the contour offsets (number of contours plus one values) and "
+    "the coordinates (two values per point).\n"
+    "\n"
+    "The packed form avoids creating one script object per coordinate. In Ruby, "
+    "it is a binary string which can be converted with 'String#unpack(\"l<*\")' and created with 'Array#pack(\"l<*\")'. "
+    "In Python, it is a 'bytes' object which can be mapped to a native array with 'numpy.frombuffer(data, dtype = \"<i4\")'. "
+    "'bytes' and 'bytearray' objects (e.g. from 'numpy.ndarray.tobytes') are accepted as input. "
+    "An error is raised if a coordinate does not fit into 32 bits."
+  ) +
+  gsi::method ("clear", &db::PolygonArrays::clear,
+    "@brief Removes all polygons\n"
+  ) +
+  gsi::method ("add", &db::PolygonArrays::add, gsi::arg ("polygon"),
+    "@brief Adds a polygon\n"
+  ) +
+  gsi::method_ext ("add", &add_polygons, gsi::arg ("polygons"),
+    "@brief Adds the polygons from the given array\n"
+  ) +
+  gsi::method ("size", &db::PolygonArrays::size,
+    "@brief Gets the number of polygons\n"
+  ) +
+  gsi::method ("is_empty?", &db::PolygonArrays::empty,
+    "@brief Returns true if no polygon is stored\n"
+  ) +
+  gsi::method_ext ("polygon", &polygon_at, gsi::arg ("index"),
+    "@brief Gets the polygon with the given index\n"
+  ) +
+  gsi::method ("coordinates", &db::PolygonArrays::coordinates,
+    "@brief Gets the coordinates of all points\n"
+    "\n"
+    "The coordinates are given in pairs of x and y values: x0, y0, x1, y1, ..."
+  ) +
+  gsi::method ("contour_offsets", &db::PolygonArrays::contour_offsets,
+    "@brief Gets the contour offsets\n"
+    "\n"
+    "Element n of this array is the index of the first point of contour n. "
+    "The array has one extra element holding the total number of points. "
+    "Hence the points of contour n are the points from contour_offsets[n] to contour_offsets[n+1]-1."
+  ) +
+  gsi::method ("polygon_offsets", &db::PolygonArrays::polygon_offsets,
+    "@brief Gets the polygon offsets\n"
+    "\n"
+    "Element n of this array is the index of the first contour of polygon n. "
+    "The array has one extra element holding the total number of contours. "
+    "The first contour of a polygon is the hull, the others are the holes."
+  ),
+  "@brief A flat, array-based representation of a sequence of polygons\n"
+  "\n"
+  "This object holds polygons in three plain integer arrays. It is intended for exchanging "
+  "large numbers of polygons with scripts: instead of creating one \\Polygon object per "
+  "polygon, the coordinates can be obtained or supplied in bulk. "
+  "Use \\Region#polygon_arrays and \\Shapes#polygon_arrays to obtain the polygons of a region "
+  "or a shape container in this form and \\Region#insert or \\Shapes#insert to insert them.\n"
+  "\n"
+  "@code\n"
+  "pa = region.polygon_arrays\n"
+  "c = pa.coordinates\n"
+  "co = pa.contour_offsets\n"
+  "po = pa.polygon_offsets\n"
+  "# hull of polygon 0: points co[po[0]] to co[po[0]+1]-1\n"
+  "@/code\n"
+  "\n"
+  "This class has been introduced in version 0.27."
+);
+
+}
@@ -22,6 +22,7 @@
 
 
 #include "gsiDecl.h"
+#include "gsiObject.h"
 #include "dbReader.h"
 #include "dbLoadLayoutOptions.h"
 
@@ -247,7 +248,10 @@ namespace gsi
   {
     tl::InputStream stream (filename);
     db::Reader reader (stream);
-    return reader.read (*layout, options);
+    db::LayerMap lm = reader.read (*layout, options);
+    //  the reader does not survive this call, so deferred cells need to be loaded now
+    reader.load_all_cells (*layout);
+    return lm;
   }
 
   //  extend the layout class by two reader methods
@@ -275,4 +279,150 @@ namespace gsi
     ""
   );
 
+  /**
+   *  @brief A reader which keeps the file open after reading
+   *
+   *  This object is required for deferred loading of cells: the reader and the
+   *  stream need to stay alive until the cells are loaded.
+   */
+  class LayoutReader
+    : public gsi::ObjectBase
+  {
+  public:
+    LayoutReader (const std::string &filename)
+      : m_stream (filename), m_reader (m_stream)
+    { }
+
+    db::Reader &reader ()
+    {
+      return m_reader;
+    }
+
+    const db::Reader &reader () const
+    {
+      return m_reader;
+    }
+
+  private:
+    tl::InputStream m_stream;
+    db::Reader m_reader;
+  };
+
+}
+
+namespace tl
+{
+  template<> struct type_traits<gsi::LayoutReader> : public tl::type_traits<void>
+  {
+    //  mark "LayoutReader" as not having a default ctor and no copy ctor
+    typedef tl::false_tag has_copy_constructor;
+    typedef tl::false_tag has_default_constructor;
+  };
+}
+
+namespace gsi
+{
+
+  static LayoutReader *new_layout_reader (const std::string &filename)
+  {
+    return new LayoutReader (filename);
+  }
+
+  static db::LayerMap lr_read (LayoutReader *lr, db::Layout *layout, const db::LoadLayoutOptions &options)
+  {
+    return lr->reader ().read (*layout, options);
+  }
+
+  static std::string lr_format (const LayoutReader *lr)
+  {
+    return std::string (lr->reader ().format ());
+  }
+
+  static bool lr_has_deferred_cells (const LayoutReader *lr)
+  {
+    return lr->reader ().has_deferred_cells ();
+  }
+
+  static bool lr_is_deferred_cell (const LayoutReader *lr, db::cell_index_type cell_index)
+  {
+    return lr->reader ().is_deferred_cell (cell_index);
+  }
+
+  static void check_cell_index (const db::Layout *layout, db::cell_index_type cell_index)
+  {
+    if (! layout->is_valid_cell_index (cell_index)) {
+      throw tl::Exception (tl::to_string (tr ("Not a valid cell index: ")) + tl::to_string (cell_index));
+    }
+  }
+
+  static void lr_load_cell (LayoutReader *lr, db::Layout *layout, db::cell_index_type cell_index)
+  {
+    check_cell_index (layout, cell_index);
+    lr->reader ().load_cell (*layout, cell_index);
+  }
+
+  static void lr_load_cell_tree (LayoutReader *lr, db::Layout *layout, db::cell_index_type cell_index)
+  {
+    check_cell_index (layout, cell_index);
+    lr->reader ().load_cell_tree (*layout, cell_index);
+  }
+
+  static void lr_load_all_cells (LayoutReader *lr, db::Layout *layout)
+  {
+    lr->reader ().load_all_cells (*layout);
+  }
+
+  Class<LayoutReader> decl_LayoutReader ("db", "LayoutReader",
+    gsi::constructor ("new", &new_layout_reader, gsi::arg ("filename"),
+      "@brief Opens the given file for reading\n"
+      "The format of the file is determined automatically."
+    ) +
+    gsi::method_ext ("read", &lr_read, gsi::arg ("layout"), gsi::arg ("options", db::LoadLayoutOptions (), "default"),
+      "@brief Reads the file into the given layout\n"
+      "@return A layer map that contains the mapping used by the reader including the layers that have been created."
+    ) +
+    gsi::method_ext ("format", &lr_format,
+      "@brief Gets the format of the file\n"
+    ) +
+    gsi::method_ext ("has_deferred_cells?", &lr_has_deferred_cells,
+      "@brief Returns true, if there are cells whose content has not been loaded yet\n"
+    ) +
+    gsi::method_ext ("is_deferred_cell?", &lr_is_deferred_cell, gsi::arg ("cell_index"),
+      "@brief Returns true, if the content of the given cell has not been loaded yet\n"
+    ) +
+    gsi::method_ext ("load_cell", &lr_load_cell, gsi::arg ("layout"), gsi::arg ("cell_index"),
+      "@brief Loads the content of the given cell if it has not been loaded yet\n"
+      "The layout must be the one the file has been read into."
+    ) +
+    gsi::method_ext ("load_cell_tree", &lr_load_cell_tree, gsi::arg ("layout"), gsi::arg ("cell_index"),
+      "@brief Loads the content of the given cell and all cells called by it\n"
+      "The layout must be the one the file has been read into."
+    ) +
+    gsi::method_ext ("load_all_cells", &lr_load_all_cells, gsi::arg ("layout"),
+      "@brief Loads the content of all cells which have not been loaded yet\n"
+      "The layout must be the one the file has been read into."
+    ),
+    "@brief A layout reader supporting deferred loading of cells\n"
+    "\n"
+    "Unlike \\Layout#read, this object keeps the file open after reading. Some formats "
+    "support loading the cell contents on request (currently OASIS with \\LoadLayoutOptions#oasis_lazy_loading= set). "
+    "In this case, \\read builds the cell hierarchy and the layers only. The shapes of a cell are "
+    "loaded when they are accessed first (e.g. through \\Cell#shapes or a \\RecursiveShapeIterator) or "
+    "explicitly with \\load_cell, \\load_cell_tree or \\load_all_cells. The bounding boxes of the "
+    "cells are available without loading the shapes. When the reader is destroyed, cells not loaded "
+    "until then stay without shapes.\n"
+    "\n"
+    "@code\n"
+    "opt = RBA::LoadLayoutOptions::new\n"
+    "opt.oasis_lazy_loading = true\n"
+    "ly = RBA::Layout::new\n"
+    "reader = RBA::LayoutReader::new(\"input.oas\")\n"
+    "reader.read(ly, opt)\n"
+    "# load the shapes of cell TOP and its children\n"
+    "reader.load_cell_tree(ly, ly.cell(\"TOP\").cell_index)\n"
+    "@/code\n"
+    "\n"
+    "This class has been introduced in version 0.27."
+  );
+
 }
@@ -32,6 +32,7 @@
 #include "dbDeepShapeStore.h"
 #include "dbRegion.h"
 #include "dbRegionProcessors.h"
+#include "dbPolygonArrays.h"
 #include "tlGlobPattern.h"
 
 #include <memory>
@@ -184,6 +185,32 @@ static void insert_r (db::Region *r, const db::Region &a)
   }
 }
 
+static void insert_pa (db::Region *r, const db::PolygonArrays &a)
+{
+  for (size_t i = 0; i < a.size (); ++i) {
+    r->insert (a.polygon (i));
+  }
+}
+
+static db::PolygonArrays polygon_arrays (const db::Region *r)
+{
+  db::PolygonArrays pa;
+  for (db::Region::const_iterator p = r->begin (); ! p.at_end (); ++p) {
+    pa.add (*p);
+  }
+  return pa;
+}
+
+static void insert_pa_packed (db::Region *r, const std::vector<char> &data)
+{
+  insert_pa (r, db::PolygonArrays::from_packed (data));
+}
+
+static std::vector<char> polygon_arrays_packed (const db::Region *r)
+{
+  return polygon_arrays (r).to_packed ();
+}
+
 template <class Trans>
 static void insert_st (db::Region *r, const db::Shapes &a, const Trans &t)
 {
@@ -1044,6 +1071,34 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "@brief Inserts all polygons from the other region into this region\n"
     "This method has been introduced in version 0.25."
   ) +
+  method_ext ("insert", &insert_pa, gsi::arg ("arrays"),
+    "@brief Inserts all polygons from the polygon arrays object into this region\n"
+    "This method is the counterpart of \\polygon_arrays. It allows supplying polygons in bulk "
+    "in the form of coordinate and offset arrays. See \\PolygonArrays for details.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  method_ext ("polygon_arrays", &polygon_arrays,
+    "@brief Gets the polygons of the region in the form of coordinate and offset arrays\n"
+    "This method delivers the same polygons than \\each, but in a flat array representation. "
+    "This is much faster than iterating the polygons if the coordinates are required in bulk, for example "
+    "by scripts doing statistical analysis. See \\PolygonArrays for details.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  method_ext ("insert_polygon_arrays_packed", &insert_pa_packed, gsi::arg ("data"),
+    "@brief Inserts the polygons from the packed binary form into this region\n"
+    "This method is the counterpart of \\polygon_arrays_packed. See \\PolygonArrays#packed for a description of the format.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  method_ext ("polygon_arrays_packed", &polygon_arrays_packed,
+    "@brief Gets the polygons of the region in packed binary form\n"
+    "This method is equivalent to 'polygon_arrays.packed'. The packed form is a byte string of 32 bit little-endian integers "
+    "which can be converted to a native array quickly. See \\PolygonArrays#packed for a description of the format.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
   method_ext ("insert", &insert_s, gsi::arg ("shapes"),
     "@brief Inserts all polygons from the shape collection into this region\n"
     "This method takes each \"polygon-like\" shape from the shape collection and "
@@ -30,6 +30,7 @@
 #include "dbRegion.h"
 #include "dbEdgePairs.h"
 #include "dbEdges.h"
+#include "dbPolygonArrays.h"
 
 namespace gsi
 {
@@ -296,6 +297,35 @@ static void insert_region (db::Shapes *sh, const db::Region &r)
   }
 }
 
+static void insert_polygon_arrays (db::Shapes *sh, const db::PolygonArrays &a)
+{
+  for (size_t i = 0; i < a.size (); ++i) {
+    sh->insert (a.polygon (i));
+  }
+}
+
+static db::PolygonArrays polygon_arrays (const db::Shapes *sh, unsigned int flags)
+{
+  db::PolygonArrays pa;
+  db::Polygon poly;
+  for (db::Shapes::shape_iterator s = sh->begin (flags & (db::ShapeIterator::Polygons | db::ShapeIterator::Boxes | db::ShapeIterator::Paths)); ! s.at_end (); ++s) {
+    if (s->polygon (poly)) {
+      pa.add (poly);
+    }
+  }
+  return pa;
+}
+
+static void insert_polygon_arrays_packed (db::Shapes *sh, const std::vector<char> &data)
+{
+  insert_polygon_arrays (sh, db::PolygonArrays::from_packed (data));
+}
+
+static std::vector<char> polygon_arrays_packed (const db::Shapes *sh, unsigned int flags)
+{
+  return polygon_arrays (sh, flags).to_packed ();
+}
+
 static void insert_region_with_trans (db::Shapes *sh, const db::Region &r, const db::ICplxTrans &trans)
 {
   //  NOTE: if the source (r) is from the same layout than the shapes live in, we better
@@ -551,6 +581,41 @@ Class<db::Shapes> decl_Shapes ("db", "Shapes",
     "\n"
     "This method has been introduced in version 0.23.\n"
   ) +
+  gsi::method_ext ("insert", &insert_polygon_arrays, gsi::arg ("arrays"),
+    "@brief Inserts the polygons from the polygon arrays object into this shape container\n"
+    "@param arrays The polygons to insert in the form of coordinate and offset arrays\n"
+    "\n"
+    "This method is the counterpart of \\polygon_arrays. It allows supplying polygons in bulk. "
+    "See \\PolygonArrays for details.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
+  gsi::method_ext ("polygon_arrays", &polygon_arrays, gsi::arg ("flags"),
+    "@brief Gets the polygon-like shapes in the form of coordinate and offset arrays\n"
+    "@param flags An \"or\"-ed combination of the S... constants\n"
+    "\n"
+    "This method delivers the boxes, polygons and paths selected by the flags as polygons in a flat array "
+    "representation. Other shapes are ignored. This is much faster than iterating the shapes if the "
+    "coordinates are required in bulk. See \\PolygonArrays for details.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
+  gsi::method_ext ("insert_polygon_arrays_packed", &insert_polygon_arrays_packed, gsi::arg ("data"),
+    "@brief Inserts the polygons from the packed binary form into this shape container\n"
+    "@param data The polygons in the packed form\n"
+    "\n"
+    "This method is the counterpart of \\polygon_arrays_packed. See \\PolygonArrays#packed for a description of the format.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
+  gsi::method_ext ("polygon_arrays_packed", &polygon_arrays_packed, gsi::arg ("flags"),
+    "@brief Gets the polygon-like shapes in packed binary form\n"
+    "@param flags An \"or\"-ed combination of the S... constants\n"
+    "\n"
+    "This method is equivalent to 'polygon_arrays(flags).packed'. See \\PolygonArrays#packed for a description of the format.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
   gsi::method_ext ("insert", &insert_region_with_trans, gsi::arg ("region"), gsi::arg ("trans"),
     "@brief Inserts the polygons from the region into this shape container with a transformation\n"
     "@param region The region to insert\n"
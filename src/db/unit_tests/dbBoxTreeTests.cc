@@ -29,6 +29,7 @@
 
 #include <iostream>
 #include <set>
+#include <list>
 #include <stdlib.h>
 
 template <class Box>
@@ -1120,3 +1121,181 @@ TEST(7U)
     EXPECT_EQ (n, t.size () * 10);
   }
 }
+
+namespace
+{
+
+//  A scheduler executing the tasks in the order of scheduling (FIFO)
+class TestSortScheduler
+  : public db::box_tree_sort_scheduler
+{
+public:
+  TestSortScheduler ()
+    : tasks_run (0)
+  { }
+
+  ~TestSortScheduler ()
+  {
+    for (std::list<db::box_tree_sort_task *>::const_iterator t = m_tasks.begin (); t != m_tasks.end (); ++t) {
+      delete *t;
+    }
+  }
+
+  virtual void schedule (db::box_tree_sort_task *task)
+  {
+    m_tasks.push_back (task);
+  }
+
+  virtual size_t fork_size () const
+  {
+    return 50;
+  }
+
+  void run ()
+  {
+    while (! m_tasks.empty ()) {
+      db::box_tree_sort_task *task = m_tasks.front ();
+      m_tasks.pop_front ();
+      task->run (this);
+      delete task;
+      ++tasks_run;
+    }
+  }
+
+  size_t tasks_run;
+
+private:
+  std::list<db::box_tree_sort_task *> m_tasks;
+};
+
+}
+
+template <class Tree, class BoxConv>
+static void test_sort_with_scheduler (tl::TestBase *_this, BoxConv conv)
+{
+  Tree t1, t2;
+
+  srand (1);
+  for (unsigned int i = 0; i < 10000; ++i) {
+    db::Box b = rbox ();
+    t1.insert (b);
+    t2.insert (b);
+  }
+
+  t1.sort (conv);
+
+  TestSortScheduler scheduler;
+  t2.sort (conv, &scheduler);
+  scheduler.run ();
+
+  EXPECT_EQ (scheduler.tasks_run > 0, true);
+  EXPECT_EQ (t1.root ()->is_packed (), true);
+  EXPECT_EQ (t2.root ()->is_packed (), true);
+
+  //  the trees must be identical
+  db::Coord m = std::numeric_limits<db::Coord>::max ();
+  typename Tree::touching_iterator i1 = t1.begin_touching (db::Box (db::Point (-m, -m), db::Point (m, m)), conv);
+  typename Tree::touching_iterator i2 = t2.begin_touching (db::Box (db::Point (-m, -m), db::Point (m, m)), conv);
+  size_t n = 0;
+  while (! i1.at_end () && ! i2.at_end ()) {
+    EXPECT_EQ (i1->to_string (), i2->to_string ());
+    ++i1;
+    ++i2;
+    ++n;
+  }
+  EXPECT_EQ (i1.at_end (), true);
+  EXPECT_EQ (i2.at_end (), true);
+  EXPECT_EQ (n, size_t (10000));
+
+  for (unsigned int i = 0; i < 100; ++i) {
+    test_tree_touching (_this, t2, rbox (), conv);
+    test_tree_overlap (_this, t2, rbox (), conv);
+  }
+}
+
+TEST(8)
+{
+  test_sort_with_scheduler<TestTree> (_this, Box2Box ());
+  test_sort_with_scheduler<TestTreeCmplx> (_this, Box2BoxCmplx ());
+}
+
+TEST(8U)
+{
+  test_sort_with_scheduler<UnstableTestTree> (_this, Box2Box ());
+  test_sort_with_scheduler<UnstableTestTreeCmplx> (_this, Box2BoxCmplx ());
+}
+
+template <class Tree, class BoxConv>
+static void test_packed_nodes (tl::TestBase *_this, BoxConv conv)
+{
+  typedef typename Tree::box_tree_node node_type;
+
+  Tree t;
+
+  srand (1);
+  for (unsigned int i = 0; i < 10000; ++i) {
+    t.insert (rbox ());
+  }
+
+  t.sort (conv);
+
+  const node_type *root = t.root ();
+  EXPECT_EQ (root != 0, true);
+  EXPECT_EQ (root->is_packed (), true);
+
+  //  breadth-first order: the nodes are consecutive and children follow their parents
+  std::vector<const node_type *> nodes;
+  nodes.push_back (root);
+  for (size_t i = 0; i < nodes.size (); ++i) {
+    for (int q = 0; q < 4; ++q) {
+      const node_type *c = nodes [i]->child (q);
+      if (c) {
+        EXPECT_EQ (c->parent () == nodes [i], true);
+        EXPECT_EQ (c->quad (), q);
+        EXPECT_EQ (c->is_packed (), false);
+        nodes.push_back (c);
+      }
+    }
+  }
+  EXPECT_EQ (nodes.size () > 1, true);
+  for (size_t i = 0; i < nodes.size (); ++i) {
+    EXPECT_EQ (nodes [i] == root + i, true);
+  }
+
+  //  copies are packed too
+  Tree tc (t);
+  EXPECT_EQ (tc.root ()->is_packed (), true);
+  EXPECT_EQ (tc.root () != t.root (), true);
+
+  for (unsigned int i = 0; i < 100; ++i) {
+    test_tree_touching (_this, t, rbox (), conv);
+    test_tree_overlap (_this, t, rbox (), conv);
+    test_tree_touching (_this, tc, rbox (), conv);
+    test_tree_overlap (_this, tc, rbox (), conv);
+  }
+
+  //  modification and re-sorting gives a new packed tree
+  t.insert (db::Box (-10000, -10000, 10000, 10000));
+  t.sort (conv);
+  EXPECT_EQ (t.root ()->is_packed (), true);
+  test_tree_touching (_this, t, db::Box (0, 0, 100, 100), conv);
+
+  tc = t;
+  EXPECT_EQ (tc.root ()->is_packed (), true);
+  EXPECT_EQ (tc.size (), size_t (10001));
+
+  t.clear ();
+  EXPECT_EQ (t.root () == 0, true);
+}
+
+TEST(9)
+{
+  test_packed_nodes<TestTree> (_this, Box2Box ());
+  test_packed_nodes<TestTreeCmplx> (_this, Box2BoxCmplx ());
+}
+
+TEST(9U)
+{
+  test_packed_nodes<UnstableTestTree> (_this, Box2Box ());
+  test_packed_nodes<UnstableTestTreeCmplx> (_this, Box2BoxCmplx ());
+}
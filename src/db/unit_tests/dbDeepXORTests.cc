@@ -0,0 +1,247 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "dbDeepXOR.h"
+#include "dbDeepShapeStore.h"
+#include "dbReader.h"
+#include "dbTestSupport.h"
+#include "tlUnitTest.h"
+#include "tlStream.h"
+#include "tlThreads.h"
+
+static void read_layout (db::Layout &ly, const char *file)
+{
+  std::string fn (tl::testsrc ());
+  fn += "/testdata/";
+  fn += file;
+  tl::InputStream stream (fn);
+  db::Reader reader (stream);
+  reader.read (ly);
+}
+
+static db::Region flat (const db::Region &r)
+{
+  db::Region res (r);
+  res.flatten ();
+  res.merge ();
+  return res;
+}
+
+//  builds a layout with a 10x10 grid of "C" cells plus a box in the top cell
+static db::cell_index_type make_layout (db::Layout &ly, unsigned int l, bool modify)
+{
+  db::cell_index_type top = ly.add_cell ("TOP");
+  db::cell_index_type c = ly.add_cell ("C");
+
+  ly.cell (c).shapes (l).insert (db::Box (0, 0, 500, 500));
+  ly.cell (c).shapes (l).insert (db::Box (600, 0, 800, 1000));
+
+  for (int i = 0; i < 10; ++i) {
+    for (int j = 0; j < 10; ++j) {
+      db::Vector d (i * 1000, j * 1200);
+      if (modify && i == 3 && j == 4) {
+        d += db::Vector (100, 0);
+      }
+      ly.cell (top).insert (db::CellInstArray (db::CellInst (c), db::Trans (d)));
+    }
+  }
+
+  ly.cell (top).shapes (l).insert (db::Box (-1000, -1000, 0, 0));
+  if (modify) {
+    ly.cell (top).shapes (l).insert (db::Box (20000, 0, 21000, 500));
+  }
+
+  return top;
+}
+
+TEST(1_SkipIdenticalSynthetic)
+{
+  db::Layout la, lb;
+  unsigned int l1a = la.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l1b = lb.insert_layer (db::LayerProperties (1, 0));
+  db::cell_index_type ta = make_layout (la, l1a, false);
+  db::cell_index_type tb = make_layout (lb, l1b, true);
+
+  db::DeepShapeStore dss;
+
+  db::DeepXOR basic (&dss, &la, ta, &lb, tb, la.dbu ());
+  db::DeepXOR skip (&dss, &la, ta, &lb, tb, la.dbu ());
+  skip.set_skip_identical (true);
+  EXPECT_EQ (skip.skip_identical (), true);
+
+  db::Region rbasic = flat (basic.compute (db::BooleanOp::Xor, int (l1a), int (l1b)));
+  db::Region rskip = flat (skip.compute (db::BooleanOp::Xor, int (l1a), int (l1b)));
+
+  EXPECT_EQ (rbasic.empty (), false);
+  EXPECT_EQ ((rbasic ^ rskip).empty (), true);
+  EXPECT_EQ (rskip.to_string (), "(20000,0;20000,500;21000,500;21000,0);(3000,4800;3000,5300;3100,5300;3100,4800);(3500,4800;3500,5300;3600,5300;3600,5800;3700,5800;3700,4800);(3800,4800;3800,5800;3900,5800;3900,4800)");
+
+  //  99 of the 100 instances are shared, the moved instance produces "A only" and "B only" variants of "C"
+  EXPECT_EQ (skip.merged_cells (), size_t (4));
+  EXPECT_EQ (skip.common_instances (), size_t (99));
+
+  EXPECT_EQ ((flat (basic.compute (db::BooleanOp::ANotB, int (l1a), int (l1b))) ^ flat (skip.compute (db::BooleanOp::ANotB, int (l1a), int (l1b)))).empty (), true);
+  EXPECT_EQ ((flat (basic.compute (db::BooleanOp::BNotA, int (l1a), int (l1b))) ^ flat (skip.compute (db::BooleanOp::BNotA, int (l1a), int (l1b)))).empty (), true);
+
+  //  layer not present in one layout
+  EXPECT_EQ ((flat (basic.compute (db::BooleanOp::Xor, -1, int (l1b))) ^ flat (skip.compute (db::BooleanOp::Xor, -1, int (l1b)))).empty (), true);
+  EXPECT_EQ (flat (skip.compute (db::BooleanOp::Xor, int (l1a), -1)).area (), flat (basic.compute (db::BooleanOp::Xor, int (l1a), -1)).area ());
+}
+
+TEST(2_SkipIdenticalIdentical)
+{
+  db::Layout la, lb;
+  unsigned int l1a = la.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l1b = lb.insert_layer (db::LayerProperties (1, 0));
+  db::cell_index_type ta = make_layout (la, l1a, false);
+  db::cell_index_type tb = make_layout (lb, l1b, false);
+
+  db::DeepShapeStore dss;
+
+  db::DeepXOR skip (&dss, &la, ta, &lb, tb, la.dbu ());
+  skip.set_skip_identical (true);
+
+  EXPECT_EQ (skip.compute (db::BooleanOp::Xor, int (l1a), int (l1b)).empty (), true);
+  EXPECT_EQ (skip.merged_cells (), size_t (2));
+  EXPECT_EQ (skip.common_instances (), size_t (100));
+}
+
+TEST(3_SkipIdenticalRealData)
+{
+  db::Layout la, lb (true);
+  read_layout (la, "bd/strmxor_in1.gds");
+  read_layout (lb, "bd/strmxor_in1.gds");
+
+  db::cell_index_type ta = *la.begin_top_down ();
+  db::cell_index_type tb = *lb.begin_top_down ();
+
+  //  modifies one child cell and the top cell of the second layout
+  for (db::Layout::iterator c = lb.begin (); c != lb.end (); ++c) {
+    db::ShapeIterator s = c->shapes (0).begin (db::ShapeIterator::Polygons | db::ShapeIterator::Paths | db::ShapeIterator::Boxes);
+    if (c->cell_index () != tb && ! s.at_end ()) {
+      c->shapes (0).erase_shape (*s);
+      break;
+    }
+  }
+  lb.cell (tb).shapes (0).insert (db::Box (0, 0, 1000, 1000));
+
+  db::DeepShapeStore dss;
+
+  db::DeepXOR basic (&dss, &la, ta, &lb, tb, la.dbu ());
+  db::DeepXOR skip (&dss, &la, ta, &lb, tb, la.dbu ());
+  skip.set_skip_identical (true);
+
+  for (db::Layout::layer_iterator l = la.begin_layers (); l != la.end_layers (); ++l) {
+
+    int lb_index = -1;
+    for (db::Layout::layer_iterator ll = lb.begin_layers (); ll != lb.end_layers (); ++ll) {
+      if ((*ll).second->log_equal (*(*l).second)) {
+        lb_index = int ((*ll).first);
+      }
+    }
+
+    db::Region rbasic = flat (basic.compute (db::BooleanOp::Xor, int ((*l).first), lb_index));
+    db::Region rskip = flat (skip.compute (db::BooleanOp::Xor, int ((*l).first), lb_index));
+
+    EXPECT_EQ ((rbasic ^ rskip).empty (), true);
+    EXPECT_EQ (rskip.empty (), (*l).first != 0);
+
+  }
+
+  EXPECT_EQ (skip.common_instances () > 0, true);
+}
+
+namespace
+{
+
+//  computes the XOR of one layer with its own deep shape store and a shared engine
+class XORThread
+  : public tl::Thread
+{
+public:
+  XORThread (db::DeepXOR *engine, unsigned int l)
+    : mp_engine (engine), m_layer (l)
+  { }
+
+  void run ()
+  {
+    db::DeepShapeStore dss;
+    std::vector<unsigned int> la, lb;
+    la.push_back (m_layer);
+    lb.push_back (m_layer);
+    result = flat (mp_engine->compute (dss, db::BooleanOp::Xor, la, lb));
+  }
+
+  db::Region result;
+
+private:
+  db::DeepXOR *mp_engine;
+  unsigned int m_layer;
+};
+
+}
+
+TEST(4_SharedEngineMultiThreaded)
+{
+  db::Layout la, lb;
+  std::vector<unsigned int> layers_a, layers_b;
+  for (int i = 0; i < 4; ++i) {
+    layers_a.push_back (la.insert_layer (db::LayerProperties (i + 1, 0)));
+    layers_b.push_back (lb.insert_layer (db::LayerProperties (i + 1, 0)));
+  }
+
+  db::cell_index_type ta = make_layout (la, layers_a [0], false);
+  db::cell_index_type tb = make_layout (lb, layers_b [0], true);
+  for (size_t i = 1; i < layers_a.size (); ++i) {
+    la.copy_layer (layers_a [0], layers_a [i]);
+    lb.copy_layer (layers_b [0], layers_b [i]);
+  }
+
+  //  one engine without a deep shape store of its own, shared by all threads
+  db::DeepXOR skip (0, &la, ta, &lb, tb, la.dbu ());
+  skip.set_skip_identical (true);
+
+  std::vector<XORThread *> threads;
+  for (size_t i = 0; i < layers_a.size (); ++i) {
+    threads.push_back (new XORThread (&skip, layers_a [i]));
+  }
+  for (size_t i = 0; i < threads.size (); ++i) {
+    threads [i]->start ();
+  }
+  for (size_t i = 0; i < threads.size (); ++i) {
+    threads [i]->wait ();
+  }
+
+  db::DeepShapeStore dss;
+  db::DeepXOR basic (&dss, &la, ta, &lb, tb, la.dbu ());
+  db::Region rbasic = flat (basic.compute (db::BooleanOp::Xor, int (layers_a [0]), int (layers_b [0])));
+  EXPECT_EQ (rbasic.empty (), false);
+
+  for (size_t i = 0; i < threads.size (); ++i) {
+    EXPECT_EQ ((threads [i]->result ^ rbasic).empty (), true);
+    delete threads [i];
+  }
+
+  //  all threads used the same merged hierarchy
+  EXPECT_EQ (skip.merged_cells (), size_t (4));
+  EXPECT_EQ (skip.common_instances (), size_t (99));
+}
@@ -2483,3 +2483,91 @@ TEST(135b)
   EXPECT_EQ (run_test135b (_this, db::Trans (db::Trans::m90)), "(-78,25;-33,34;-36,33;-37,33)");
   EXPECT_EQ (run_test135b (_this, db::Trans (db::Trans::m135)), "(-26,-78;-35,-33;-33,-36;-33,-37)");
 }
+
+static void make_random_polygons (std::vector<db::Polygon> &polygons, unsigned int seed, size_t n)
+{
+  //  a simple LCG makes the test independent of the platform's random generator
+  unsigned int r = seed;
+
+  for (size_t i = 0; i < n; ++i) {
+
+    r = r * 1103515245 + 12345;
+    db::Coord x = db::Coord ((r >> 8) % 100000);
+    r = r * 1103515245 + 12345;
+    db::Coord y = db::Coord ((r >> 8) % 100000);
+    r = r * 1103515245 + 12345;
+    db::Coord w = db::Coord ((r >> 8) % 2000 + 10);
+    r = r * 1103515245 + 12345;
+    db::Coord h = db::Coord ((r >> 8) % 2000 + 10);
+
+    if (i % 3 == 0) {
+      db::Point pts[] = { db::Point (x, y), db::Point (x + w / 2, y + h), db::Point (x + w, y + h / 3) };
+      db::Polygon p;
+      p.assign_hull (&pts[0], &pts[sizeof(pts) / sizeof(pts[0])]);
+      polygons.push_back (p);
+    } else {
+      polygons.push_back (db::Polygon (db::Box (x, y, x + w, y + h)));
+    }
+
+  }
+}
+
+TEST(200)
+{
+  //  multi-threaded sweep delivers the same results as the single-threaded one
+  std::vector<db::Polygon> a, b;
+  make_random_polygons (a, 1, 4000);
+  make_random_polygons (b, 2, 4000);
+
+  db::EdgeProcessor ep_st;
+  db::EdgeProcessor ep_mt;
+  EXPECT_EQ (ep_st.threads (), (unsigned int) 0);
+  ep_mt.set_threads (4);
+  EXPECT_EQ (ep_mt.threads (), (unsigned int) 4);
+
+  std::vector<db::Polygon> out_st, out_mt;
+
+  ep_st.boolean (a, b, out_st, db::BooleanOp::Xor, false, true);
+  ep_mt.boolean (a, b, out_mt, db::BooleanOp::Xor, false, true);
+  EXPECT_EQ (out_st.size () > 100, true);
+  EXPECT_EQ (out_st == out_mt, true);
+
+  out_st.clear ();
+  out_mt.clear ();
+  ep_st.boolean (a, b, out_st, db::BooleanOp::ANotB, true, false);
+  ep_mt.boolean (a, b, out_mt, db::BooleanOp::ANotB, true, false);
+  EXPECT_EQ (out_st == out_mt, true);
+
+  out_st.clear ();
+  out_mt.clear ();
+  ep_st.merge (a, out_st, 1, false, true);
+  ep_mt.merge (a, out_mt, 1, false, true);
+  EXPECT_EQ (out_st.size () > 100, true);
+  EXPECT_EQ (out_st == out_mt, true);
+
+  out_st.clear ();
+  out_mt.clear ();
+  ep_st.simple_merge (b, out_st, false, false);
+  ep_mt.simple_merge (b, out_mt, false, false);
+  EXPECT_EQ (out_st == out_mt, true);
+
+  out_st.clear ();
+  out_mt.clear ();
+  ep_st.size (a, 50, 20, out_st, 2, false, true);
+  ep_mt.size (a, 50, 20, out_mt, 2, false, true);
+  EXPECT_EQ (out_st == out_mt, true);
+
+  std::vector<db::Edge> edges_st, edges_mt;
+  ep_st.boolean (a, b, edges_st, db::BooleanOp::And);
+  ep_mt.boolean (a, b, edges_mt, db::BooleanOp::And);
+  std::sort (edges_st.begin (), edges_st.end ());
+  std::sort (edges_mt.begin (), edges_mt.end ());
+  EXPECT_EQ (edges_st.size () > 100, true);
+  EXPECT_EQ (edges_st == edges_mt, true);
+
+  //  the default is used for new edge processors
+  db::EdgeProcessor::set_default_threads (2);
+  EXPECT_EQ (db::EdgeProcessor ().threads (), (unsigned int) 2);
+  db::EdgeProcessor::set_default_threads (0);
+  EXPECT_EQ (db::EdgeProcessor ().threads (), (unsigned int) 0);
+}
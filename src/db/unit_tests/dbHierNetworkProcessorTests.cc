@@ -944,7 +944,7 @@ static void copy_cluster_shapes (const std::string *&attrs, db::Shapes &out, db:
   }
 }
 
-static void run_hc_test (tl::TestBase *_this, const std::string &file, const std::string &au_file)
+static void run_hc_test (tl::TestBase *_this, const std::string &file, const std::string &au_file, unsigned int threads = 0)
 {
   db::Layout ly;
   unsigned int l1 = 0, l2 = 0, l3 = 0, l4 = 0, l5 = 0, l6 = 0;
@@ -1020,6 +1020,7 @@ static void run_hc_test (tl::TestBase *_this, const std::string &file, const std
   conn.connect_global (l6, "BULK2");
 
   db::hier_clusters<db::PolygonRef> hc;
+  hc.set_threads (threads);
   hc.build (ly, ly.cell (*ly.begin_top_down ()), conn);
 
   std::vector<std::pair<db::Polygon::area_type, unsigned int> > net_layers;
@@ -1288,6 +1289,19 @@ TEST(120_HierClustersCombArrays)
   run_hc_test_with_backannotation (_this, "comb2.gds", "comb2_au2.gds");
 }
 
+TEST(121_HierClustersMultiThreaded)
+{
+  //  one thread uses the serial path
+  run_hc_test (_this, "hc_test_l1.gds", "hc_test_au1.gds", 1);
+
+  for (int i = 1; i <= 17; ++i) {
+    run_hc_test (_this, "hc_test_l" + tl::to_string (i) + ".gds", "hc_test_au" + tl::to_string (i) + ".gds", 4);
+  }
+
+  run_hc_test (_this, "comb.gds", "comb_au1.gds", 4);
+  run_hc_test (_this, "comb2.gds", "comb2_au1.gds", 4);
+}
+
 static size_t root_nets (const db::connected_clusters<db::PolygonRef> &cc)
 {
   size_t n = 0;
@@ -28,6 +28,8 @@
 #include "dbReader.h"
 #include "dbCommonReader.h"
 
+#include <algorithm>
+
 static std::string testdata (const std::string &fn)
 {
   return tl::testsrc () + "/testdata/algo/" + fn;
@@ -1119,3 +1121,93 @@ TEST(RedundantHierarchyNot2)
   run_test_bool2 (_this, "hlp16.gds", TMNot, 101);
 }
 
+
+/**
+ *  @brief Creates a deep and unbalanced hierarchy
+ *
+ *  A chain of cells nested 12 levels deep with shapes on both layers which overlap the
+ *  shapes of the child cells, plus a shallow branch with an array of leaf cells.
+ */
+static void make_deep_unbalanced_layout (db::Layout &layout, unsigned int l1, unsigned int l2)
+{
+  db::cell_index_type top = layout.add_cell ("TOP");
+
+  db::cell_index_type parent = top;
+  for (int i = 0; i < 12; ++i) {
+
+    db::cell_index_type ci = layout.add_cell (tl::sprintf ("CHAIN%d", i).c_str ());
+    layout.cell (parent).insert (db::CellInstArray (db::CellInst (ci), db::Trans (db::Vector (100, 50))));
+    if (i % 3 == 0) {
+      //  a second placement with rotation produces different contexts
+      layout.cell (parent).insert (db::CellInstArray (db::CellInst (ci), db::Trans (db::Trans::r90, db::Vector (5000, 0))));
+    }
+
+    layout.cell (ci).shapes (l1).insert (db::PolygonRef (db::Polygon (db::Box (0, 0, 1000 + i * 100, 400)), layout.shape_repository ()));
+    layout.cell (ci).shapes (l2).insert (db::PolygonRef (db::Polygon (db::Box (300, -100, 500, 1200 - i * 50)), layout.shape_repository ()));
+    layout.cell (parent).shapes (l2).insert (db::PolygonRef (db::Polygon (db::Box (i * 30, 200, 700 + i * 30, 300)), layout.shape_repository ()));
+
+    parent = ci;
+
+  }
+
+  db::cell_index_type leaf = layout.add_cell ("LEAF");
+  layout.cell (leaf).shapes (l1).insert (db::PolygonRef (db::Polygon (db::Box (0, 0, 200, 200)), layout.shape_repository ()));
+  layout.cell (top).insert (db::CellInstArray (db::CellInst (leaf), db::Trans (db::Vector (-2000, -2000)), db::Vector (150, 0), db::Vector (0, 150), 20, 20));
+  layout.cell (top).shapes (l2).insert (db::PolygonRef (db::Polygon (db::Box (-2000, -2000, 1000, 0)), layout.shape_repository ()));
+}
+
+static std::string deep_bool_result (bool is_and, unsigned int nthreads)
+{
+  db::Layout layout;
+  unsigned int l1 = layout.insert_layer ();
+  unsigned int l2 = layout.insert_layer ();
+  unsigned int lout = layout.insert_layer ();
+  make_deep_unbalanced_layout (layout, l1, l2);
+
+  db::BoolAndOrNotLocalOperation op (is_and);
+  db::local_processor<db::PolygonRef, db::PolygonRef, db::PolygonRef> proc (&layout, &layout.cell (*layout.begin_top_down ()));
+  proc.set_threads (nthreads);
+  proc.set_area_ratio (3.0);
+  proc.set_max_vertex_count (16);
+  proc.run (&op, l1, l2, lout);
+
+  //  a cell-by-cell dump of the result which does not depend on the order of the shapes
+  std::string res;
+  for (db::Layout::top_down_const_iterator c = layout.begin_top_down (); c != layout.end_top_down (); ++c) {
+
+    std::vector<std::string> polygons;
+    for (db::Shapes::shape_iterator s = layout.cell (*c).shapes (lout).begin (db::ShapeIterator::All); ! s.at_end (); ++s) {
+      db::Polygon poly;
+      s->polygon (poly);
+      polygons.push_back (poly.to_string ());
+    }
+    std::sort (polygons.begin (), polygons.end ());
+
+    res += layout.cell_name (*c);
+    res += ":";
+    for (std::vector<std::string>::const_iterator p = polygons.begin (); p != polygons.end (); ++p) {
+      res += " ";
+      res += *p;
+    }
+    res += "\n";
+
+  }
+
+  return res;
+}
+
+TEST(DeepUnbalancedHierarchyMultiThreaded)
+{
+  //  the results of the multi-threaded runs need to be identical to the single-threaded one
+  for (int is_and = 0; is_and < 2; ++is_and) {
+
+    std::string ref = deep_bool_result (is_and != 0, 0);
+    EXPECT_EQ (ref.find ("(") != std::string::npos, true);
+
+    EXPECT_EQ (deep_bool_result (is_and != 0, 1), ref);
+    EXPECT_EQ (deep_bool_result (is_and != 0, 2), ref);
+    EXPECT_EQ (deep_bool_result (is_and != 0, 4), ref);
+    EXPECT_EQ (deep_bool_result (is_and != 0, 8), ref);
+
+  }
+}
@@ -550,6 +550,21 @@ TEST(5_CompareRecursiveShapeIterators)
     EXPECT_EQ (db::compare_iterators_with_respect_to_target_hierarchy (iter1, iter2) != 0, true);
     EXPECT_EQ (db::compare_iterators_with_respect_to_target_hierarchy (iter1, iter2) != db::compare_iterators_with_respect_to_target_hierarchy (iter2, iter1), true);
   }
+
+  {
+    //  an iterator without a layout must not compare equal to one with a layout
+    db::RecursiveShapeIterator iter1;
+    db::RecursiveShapeIterator iter2 (ly, ly.cell (ci), 0);
+    EXPECT_EQ (db::compare_iterators_with_respect_to_target_hierarchy (iter1, iter2) != 0, true);
+    EXPECT_EQ (db::compare_iterators_with_respect_to_target_hierarchy (iter2, iter1) != 0, true);
+    EXPECT_EQ (db::compare_iterators_with_respect_to_target_hierarchy (iter1, iter2) != db::compare_iterators_with_respect_to_target_hierarchy (iter2, iter1), true);
+  }
+
+  {
+    db::RecursiveShapeIterator iter1;
+    db::RecursiveShapeIterator iter2;
+    EXPECT_EQ (db::compare_iterators_with_respect_to_target_hierarchy (iter1, iter2), 0);
+  }
 }
 
 TEST(6_DisjunctLayersPerHierarchyBranch)
@@ -464,3 +464,184 @@ TEST(4)
   prop_id = g.properties_repository ().properties_id (ps);
   EXPECT_EQ (el.property_ids_dirty, true);
 }
+
+TEST(5)
+{
+  //  pack_polygons
+
+  db::Layout g;
+  unsigned int l1 = g.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = g.insert_layer (db::LayerProperties (2, 0));
+  db::Cell &top = g.cell (g.add_cell ("TOP"));
+
+  std::vector<db::Point> pts;
+  for (int i = 0; i < 100; ++i) {
+    pts.push_back (db::Point (i * 3, (i % 2) * 5));
+  }
+  pts.push_back (db::Point (300, 1000));
+  pts.push_back (db::Point (0, 1000));
+
+  db::Polygon poly;
+  poly.assign_hull (pts.begin (), pts.end ());
+
+  top.shapes (l1).insert (poly);
+  top.shapes (l1).insert (db::PolygonRef (poly.moved (db::Vector (0, 2000)), g.shape_repository ()));
+  top.shapes (l1).insert (db::SimplePolygon (db::Box (0, 0, 10, 10)));
+  top.shapes (l2).insert (poly);
+
+  g.pack_polygons (l1);
+
+  db::Shapes::shape_iterator s;
+
+  s = top.shapes (l1).begin (db::ShapeIterator::Polygons);
+  EXPECT_EQ (s->is_polygon () && s->polygon ().is_packed (), true);
+  EXPECT_EQ (s->polygon () == poly, true);
+  ++s;
+  EXPECT_EQ (s->is_polygon () && s->polygon_ref ().obj ().is_packed (), true);
+  db::Polygon pr;
+  s->polygon (pr);
+  EXPECT_EQ (pr == poly.moved (db::Vector (0, 2000)), true);
+  ++s;
+  EXPECT_EQ (s->simple_polygon ().to_string (), "(0,0;0,10;10,10;10,0)");
+  ++s;
+  EXPECT_EQ (s.at_end (), true);
+
+  s = top.shapes (l2).begin (db::ShapeIterator::Polygons);
+  EXPECT_EQ (s->polygon ().is_packed (), false);
+
+  g.pack_polygons ();
+
+  s = top.shapes (l2).begin (db::ShapeIterator::Polygons);
+  EXPECT_EQ (s->polygon ().is_packed (), true);
+  EXPECT_EQ (s->polygon () == poly, true);
+  EXPECT_EQ (top.bbox ().to_string (), "(0,0;300,3000)");
+}
+
+static void make_sort_test_layout (db::Layout &g)
+{
+  unsigned int l1 = g.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = g.insert_layer (db::LayerProperties (2, 0));
+  db::Cell &top = g.cell (g.add_cell ("TOP"));
+  db::Cell &a = g.cell (g.add_cell ("A"));
+
+  for (int i = 0; i < 200000; ++i) {
+    db::Coord x = (i % 500) * 20 + (i * 7) % 13, y = (i / 500) * 20 + (i * 11) % 17;
+    top.shapes (l1).insert (db::Box (x, y, x + 10 + i % 7, y + 10 + i % 5));
+  }
+
+  for (int i = 0; i < 20000; ++i) {
+    db::Coord x = (i % 100) * 100, y = (i / 100) * 100;
+    a.shapes (l2).insert (db::Polygon (db::Box (x, y, x + 50, y + 70)));
+  }
+
+  top.insert (db::CellInstArray (db::CellInst (a.cell_index ()), db::Trans (db::Vector (1000, 2000))));
+}
+
+static std::string sort_test_query (const db::Layout &g, unsigned int l, const db::Box &box)
+{
+  size_t n = 0;
+  db::Box bx;
+  for (db::Layout::const_iterator c = g.begin (); c != g.end (); ++c) {
+    for (db::ShapeIterator s = c->shapes (l).begin_touching (box, db::ShapeIterator::All); ! s.at_end (); ++s) {
+      ++n;
+      bx += s->bbox ();
+    }
+  }
+  return tl::to_string (n) + ":" + bx.to_string ();
+}
+
+TEST(6)
+{
+  //  multi-threaded sorting of the shapes
+
+  db::Layout g1;
+  make_sort_test_layout (g1);
+  g1.update ();
+
+  db::Layout::set_update_threads (4);
+
+  try {
+
+    db::Layout g2;
+    make_sort_test_layout (g2);
+    g2.update ();
+
+    for (unsigned int l = 0; l < 2; ++l) {
+      EXPECT_EQ (sort_test_query (g2, l, db::Box (100, 200, 1000, 1200)), sort_test_query (g1, l, db::Box (100, 200, 1000, 1200)));
+      EXPECT_EQ (sort_test_query (g2, l, db::Box (5000, 0, 5001, 10000)), sort_test_query (g1, l, db::Box (5000, 0, 5001, 10000)));
+      EXPECT_EQ (sort_test_query (g2, l, g1.cell (0).bbox ()), sort_test_query (g1, l, g1.cell (0).bbox ()));
+    }
+
+    EXPECT_EQ (sort_test_query (g2, 0, db::Box (100, 200, 1000, 1200)), "2305:(84,187;1015,1214)");
+
+    //  changing shapes after sorting
+    g2.cell (0).shapes (0).insert (db::Box (-100, -100, 0, 0));
+    g2.update ();
+    EXPECT_EQ (sort_test_query (g2, 0, db::Box (-50, -50, 0, 0)), "2:(-100,-100;10,10)");
+
+  } catch (...) {
+    db::Layout::set_update_threads (0);
+    throw;
+  }
+
+  db::Layout::set_update_threads (0);
+}
+
+TEST(7)
+{
+  //  pack_polygons_on_insert
+
+  db::Layout g;
+  EXPECT_EQ (g.pack_polygons_on_insert (), false);
+
+  unsigned int l1 = g.insert_layer (db::LayerProperties (1, 0));
+  db::Cell &top = g.cell (g.add_cell ("TOP"));
+
+  std::vector<db::Point> pts;
+  for (int i = 0; i < 100; ++i) {
+    pts.push_back (db::Point (i * 3, (i % 2) * 5));
+  }
+  pts.push_back (db::Point (300, 1000));
+  pts.push_back (db::Point (0, 1000));
+
+  db::Polygon poly;
+  poly.assign_hull (pts.begin (), pts.end ());
+
+  top.shapes (l1).insert (poly);
+
+  g.set_pack_polygons_on_insert (true);
+  EXPECT_EQ (g.pack_polygons_on_insert (), true);
+
+  top.shapes (l1).insert (poly.moved (db::Vector (0, 2000)));
+  top.shapes (l1).insert (db::PolygonRef (poly.moved (db::Vector (0, 4000)), g.shape_repository ()));
+  std::vector<db::Polygon> polys;
+  polys.push_back (poly.moved (db::Vector (0, 6000)));
+  top.shapes (l1).insert (polys.begin (), polys.end ());
+
+  //  the polygon inserted before is not affected
+  db::Shapes::shape_iterator s = top.shapes (l1).begin (db::ShapeIterator::Polygons);
+  EXPECT_EQ (s->polygon ().is_packed (), false);
+  ++s;
+  EXPECT_EQ (s->polygon ().is_packed (), true);
+  EXPECT_EQ (s->polygon () == poly.moved (db::Vector (0, 2000)), true);
+  ++s;
+  EXPECT_EQ (s->polygon ().is_packed (), true);
+  EXPECT_EQ (s->polygon () == poly.moved (db::Vector (0, 6000)), true);
+  ++s;
+  EXPECT_EQ (s->polygon_ref ().obj ().is_packed (), true);
+  db::Polygon pr;
+  s->polygon (pr);
+  EXPECT_EQ (pr == poly.moved (db::Vector (0, 4000)), true);
+  ++s;
+  EXPECT_EQ (s.at_end (), true);
+
+  //  the mode is kept when the layout is cleared
+  g.clear ();
+  EXPECT_EQ (g.pack_polygons_on_insert (), true);
+
+  g.set_pack_polygons_on_insert (false);
+  l1 = g.insert_layer (db::LayerProperties (1, 0));
+  db::Cell &top2 = g.cell (g.add_cell ("TOP"));
+  top2.shapes (l1).insert (poly);
+  EXPECT_EQ (top2.shapes (l1).begin (db::ShapeIterator::Polygons)->polygon ().is_packed (), false);
+}
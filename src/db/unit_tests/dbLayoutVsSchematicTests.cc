@@ -236,6 +236,24 @@ TEST(1_BasicFlow)
 
   compare_lvsdbs (_this, path, au_path);
 
+  //  a second compare takes the results from the compare cache
+
+  EXPECT_NE (lvs.compare_cache ().size (), size_t (0));
+  EXPECT_EQ (lvs.compare_cache ().hits (), size_t (0));
+
+  {
+    db::NetlistComparer comparer;
+    EXPECT_EQ (lvs.compare_netlists (&comparer), true);
+    EXPECT_EQ (comparer.cache () == 0, true);
+  }
+
+  EXPECT_EQ (lvs.compare_cache ().hits (), lvs.compare_cache ().size ());
+
+  std::string path_cached = tmp_file ("tmp_lvstest1_cached.lvsdb");
+  lvs.save (path_cached, false);
+
+  compare_lvsdbs (_this, path_cached, au_path);
+
   //  load, save and compare
 
   db::LayoutVsSchematic lvs2;
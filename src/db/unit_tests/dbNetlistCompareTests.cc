@@ -24,6 +24,7 @@
 #include "dbNetlistDeviceClasses.h"
 #include "dbNetlistCompare.h"
 #include "dbNetlistCrossReference.h"
+#include "tlStream.h"
 
 class NetlistCompareTestLogger
   : public db::NetlistCompareLogger
@@ -4536,3 +4537,309 @@ TEST(28_JoinSymmetricNets)
   )
 }
 
+
+static const char *nls_hier =
+  "circuit INV ($0=A,$1=Q,$2=VDD,$3=VSS);\n"
+  "  device PMOS $1 (S=VDD,G=A,D=Q) (L=0.25,W=0.95,AS=0,AD=0,PS=0,PD=0);\n"
+  "  device NMOS $2 (S=VSS,G=A,D=Q) (L=0.25,W=0.95,AS=0,AD=0,PS=0,PD=0);\n"
+  "end;\n"
+  "circuit NAND ($0=A,$1=B,$2=OUT,$3=VDD,$4=VSS);\n"
+  "  device PMOS $1 (S=VDD,G=A,D=OUT) (L=0.25,W=0.95,AS=0,AD=0,PS=0,PD=0);\n"
+  "  device PMOS $2 (S=VDD,G=B,D=OUT) (L=0.25,W=0.95,AS=0,AD=0,PS=0,PD=0);\n"
+  "  device NMOS $3 (S=VSS,G=A,D=INT) (L=0.25,W=0.95,AS=0,AD=0,PS=0,PD=0);\n"
+  "  device NMOS $4 (S=INT,G=B,D=OUT) (L=0.25,W=0.95,AS=0,AD=0,PS=0,PD=0);\n"
+  "end;\n"
+  "circuit BUF ($0=A,$1=Q,$2=VDD,$3=VSS);\n"
+  "  subcircuit INV $1 ($0=A,$1=INT,$2=VDD,$3=VSS);\n"
+  "  subcircuit INV $2 ($0=INT,$1=Q,$2=VDD,$3=VSS);\n"
+  "end;\n"
+  "circuit TOP ($0=IN1,$1=IN2,$2=OUT,$3=VDD,$4=VSS);\n"
+  "  subcircuit BUF $1 ($0=IN1,$1=INT1,$2=VDD,$3=VSS);\n"
+  "  subcircuit NAND $2 ($0=INT1,$1=IN2,$2=INT2,$3=VDD,$4=VSS);\n"
+  "  subcircuit INV $3 ($0=INT2,$1=OUT,$2=VDD,$3=VSS);\n"
+  "end;\n";
+
+static std::string compare_hier (const db::Netlist &nl1, const db::Netlist &nl2, unsigned int threads, db::NetlistCompareCache *cache, bool &good)
+{
+  NetlistCompareTestLogger logger;
+  db::NetlistComparer comp (&logger);
+  comp.set_threads (threads);
+  comp.set_cache (cache);
+
+  good = comp.compare (&nl1, &nl2);
+  return logger.text ();
+}
+
+TEST(29_MultiThreadedCompare)
+{
+  db::Netlist nl1, nl2;
+  prep_nl (nl1, nls_hier);
+  prep_nl (nl2, nls_hier);
+
+  //  make NAND mismatch
+  nl2.circuit_by_name ("NAND")->device_by_id (4)->set_parameter_value (db::DeviceClassMOS3Transistor::param_id_W, 1.5);
+
+  bool good0 = true, good4 = true;
+  std::string au = compare_hier (nl1, nl2, 0, 0, good0);
+  std::string res = compare_hier (nl1, nl2, 4, 0, good4);
+
+  EXPECT_EQ (res, au);
+  EXPECT_EQ (good4, good0);
+  EXPECT_EQ (good4, false);
+  EXPECT_EQ (au.find ("end_circuit NAND NAND NOMATCH") != std::string::npos, true);
+  EXPECT_EQ (au.find ("end_circuit BUF BUF MATCH") != std::string::npos, true);
+}
+
+TEST(30_CompareCache)
+{
+  db::Netlist nl1, nl2;
+  prep_nl (nl1, nls_hier);
+  prep_nl (nl2, nls_hier);
+
+  db::NetlistCompareCache cache;
+
+  bool good = false;
+  std::string au = compare_hier (nl1, nl2, 0, 0, good);
+  EXPECT_EQ (good, true);
+
+  EXPECT_EQ (compare_hier (nl1, nl2, 0, &cache, good), au);
+  EXPECT_EQ (good, true);
+  EXPECT_EQ (cache.size (), size_t (4));
+  EXPECT_EQ (cache.hits (), size_t (0));
+
+  //  second run: everything is taken from the cache
+  EXPECT_EQ (compare_hier (nl1, nl2, 0, &cache, good), au);
+  EXPECT_EQ (good, true);
+  EXPECT_EQ (cache.size (), size_t (4));
+  EXPECT_EQ (cache.hits (), size_t (4));
+
+  //  modify NAND: NAND and TOP need to be compared again
+  nl2.circuit_by_name ("NAND")->device_by_id (4)->set_parameter_value (db::DeviceClassMOS3Transistor::param_id_W, 1.5);
+
+  bool good_ref = true;
+  au = compare_hier (nl1, nl2, 0, 0, good_ref);
+  EXPECT_EQ (good_ref, false);
+
+  EXPECT_EQ (compare_hier (nl1, nl2, 4, &cache, good), au);
+  EXPECT_EQ (good, false);
+  EXPECT_EQ (cache.size (), size_t (6));
+  EXPECT_EQ (cache.hits (), size_t (6));
+
+  EXPECT_EQ (compare_hier (nl1, nl2, 4, &cache, good), au);
+  EXPECT_EQ (good, false);
+  EXPECT_EQ (cache.hits (), size_t (10));
+
+  cache.clear ();
+  EXPECT_EQ (cache.size (), size_t (0));
+  EXPECT_EQ (cache.hits (), size_t (0));
+}
+
+TEST(31_NodeClassRefinement)
+{
+  //  Inverter chains of different length: the nets form large ambiguity groups
+  //  which exceed the branch complexity. The node class refinement resolves them.
+
+  const char *nls1 =
+    "circuit INV (IN=IN,OUT=OUT,VDD=VDD,VSS=VSS);\n"
+    "  device PMOS $1 (S=VDD,G=IN,D=OUT) (L=0.25,W=0.95,AS=0,AD=0,PS=0,PD=0);\n"
+    "  device NMOS $2 (S=VSS,G=IN,D=OUT) (L=0.25,W=0.95,AS=0,AD=0,PS=0,PD=0);\n"
+    "end;\n"
+    "circuit TOP (VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV I11 (IN=A1,OUT=B1,VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV I21 (IN=A2,OUT=B2,VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV I22 (IN=B2,OUT=C2,VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV I31 (IN=A3,OUT=B3,VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV I32 (IN=B3,OUT=C3,VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV I33 (IN=C3,OUT=D3,VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV I41 (IN=A4,OUT=B4,VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV I42 (IN=B4,OUT=C4,VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV I43 (IN=C4,OUT=D4,VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV I44 (IN=D4,OUT=E4,VDD=VDD,VSS=VSS);\n"
+    "end;\n"
+  ;
+
+  const char *nls2 =
+    "circuit INV (IN=IN,OUT=OUT,VDD=VDD,VSS=VSS);\n"
+    "  device PMOS $1 (S=VDD,G=IN,D=OUT) (L=0.25,W=0.95,AS=0,AD=0,PS=0,PD=0);\n"
+    "  device NMOS $2 (S=VSS,G=IN,D=OUT) (L=0.25,W=0.95,AS=0,AD=0,PS=0,PD=0);\n"
+    "end;\n"
+    "circuit TOP (VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV J43 (IN=Z3,OUT=Z4,VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV J11 (IN=X0,OUT=X1,VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV J31 (IN=Y0,OUT=Y1,VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV J42 (IN=Z2,OUT=Z3,VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV J21 (IN=W0,OUT=W1,VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV J32 (IN=Y1,OUT=Y2,VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV J41 (IN=Z1,OUT=Z2,VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV J22 (IN=W1,OUT=W2,VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV J33 (IN=Y2,OUT=Y3,VDD=VDD,VSS=VSS);\n"
+    "  subcircuit INV J44 (IN=Z4,OUT=Z5,VDD=VDD,VSS=VSS);\n"
+    "end;\n"
+  ;
+
+  db::Netlist nl1, nl2;
+  prep_nl (nl1, nls1);
+  prep_nl (nl2, nls2);
+
+  NetlistCompareTestLogger logger;
+  db::NetlistComparer comp (&logger);
+  comp.set_dont_consider_net_names (true);
+  comp.set_max_branch_complexity (2);
+
+  bool good = comp.compare (&nl1, &nl2);
+
+  EXPECT_EQ (logger.text (),
+    "begin_circuit INV INV\n"
+    "match_nets VDD VDD\n"
+    "match_nets OUT OUT\n"
+    "match_nets IN IN\n"
+    "match_nets VSS VSS\n"
+    "match_pins IN IN\n"
+    "match_pins OUT OUT\n"
+    "match_pins VDD VDD\n"
+    "match_pins VSS VSS\n"
+    "match_devices $1 $1\n"
+    "match_devices $2 $2\n"
+    "end_circuit INV INV MATCH\n"
+    "begin_circuit TOP TOP\n"
+    "match_nets B1 X1\n"
+    "match_nets VSS VSS\n"
+    "match_nets VDD VDD\n"
+    "match_nets D3 Y3\n"
+    "match_nets C3 Y2\n"
+    "match_nets B3 Y1\n"
+    "match_nets A3 Y0\n"
+    "match_nets E4 Z5\n"
+    "match_nets D4 Z4\n"
+    "match_nets C4 Z3\n"
+    "match_nets B4 Z2\n"
+    "match_nets A4 Z1\n"
+    "match_nets C2 W2\n"
+    "match_nets B2 W1\n"
+    "match_nets A2 W0\n"
+    "match_nets A1 X0\n"
+    "match_pins VDD VDD\n"
+    "match_pins VSS VSS\n"
+    "match_subcircuits I43 J43\n"
+    "match_subcircuits I11 J11\n"
+    "match_subcircuits I31 J31\n"
+    "match_subcircuits I42 J42\n"
+    "match_subcircuits I21 J21\n"
+    "match_subcircuits I32 J32\n"
+    "match_subcircuits I41 J41\n"
+    "match_subcircuits I22 J22\n"
+    "match_subcircuits I33 J33\n"
+    "match_subcircuits I44 J44\n"
+    "end_circuit TOP TOP MATCH"
+  );
+  EXPECT_EQ (good, true);
+
+  //  the refinement is controlled independently from the backtracking depth
+  db::NetlistComparer comp2;
+  EXPECT_EQ (comp2.max_refinement_iterations (), size_t (50));
+  comp2.set_dont_consider_net_names (true);
+  comp2.set_max_branch_complexity (2);
+  comp2.set_max_depth (1);
+  EXPECT_EQ (comp2.compare (&nl1, &nl2), true);
+
+  //  without refinement iterations the ambiguities can't be resolved
+  db::NetlistComparer comp3;
+  comp3.set_dont_consider_net_names (true);
+  comp3.set_max_branch_complexity (2);
+  comp3.set_max_refinement_iterations (0);
+  EXPECT_EQ (comp3.compare (&nl1, &nl2), false);
+}
+
+namespace
+{
+
+/**
+ *  @brief A parameter compare delegate which stands for one implemented in a script
+ */
+class CustomDeviceParameterCompare
+  : public db::EqualDeviceParameters
+{
+public:
+  CustomDeviceParameterCompare ()
+    : db::EqualDeviceParameters (db::DeviceClassMOS3Transistor::param_id_W)
+  {
+    //  .. nothing yet ..
+  }
+};
+
+}
+
+TEST(32_CompareCacheFileAndSettings)
+{
+  db::Netlist nl1, nl2;
+  prep_nl (nl1, nls_hier);
+  prep_nl (nl2, nls_hier);
+
+  //  make NAND mismatch
+  nl2.circuit_by_name ("NAND")->device_by_id (4)->set_parameter_value (db::DeviceClassMOS3Transistor::param_id_W, 1.0);
+
+  bool good = true;
+  std::string au = compare_hier (nl1, nl2, 0, 0, good);
+  EXPECT_EQ (good, false);
+
+  std::string path = tmp_file ("tmp_compare_cache.bin");
+
+  {
+    db::NetlistCompareCache cache;
+    EXPECT_EQ (compare_hier (nl1, nl2, 0, &cache, good), au);
+    EXPECT_EQ (cache.size (), size_t (4));
+    cache.save (path);
+  }
+
+  //  the results are restored from the file
+  db::NetlistCompareCache cache;
+  cache.load (path);
+  EXPECT_EQ (cache.size (), size_t (4));
+  EXPECT_EQ (cache.hits (), size_t (0));
+
+  EXPECT_EQ (compare_hier (nl1, nl2, 0, &cache, good), au);
+  EXPECT_EQ (good, false);
+  EXPECT_EQ (cache.size (), size_t (4));
+  EXPECT_EQ (cache.hits (), size_t (4));
+
+  //  the tolerances are part of the compare settings: a tolerance makes NAND match
+  db::EqualDeviceParameters *eqp = new db::EqualDeviceParameters (db::DeviceClassMOS3Transistor::param_id_W, 0.0, 0.1);
+  nl1.device_class_by_name ("NMOS")->set_parameter_compare_delegate (eqp);
+
+  bool good_ref = false;
+  au = compare_hier (nl1, nl2, 0, 0, good_ref);
+  EXPECT_EQ (good_ref, true);
+
+  EXPECT_EQ (compare_hier (nl1, nl2, 0, &cache, good), au);
+  EXPECT_EQ (good, true);
+  EXPECT_EQ (cache.size (), size_t (8));
+  EXPECT_EQ (cache.hits (), size_t (4));
+
+  EXPECT_EQ (compare_hier (nl1, nl2, 0, &cache, good), au);
+  EXPECT_EQ (good, true);
+  EXPECT_EQ (cache.hits (), size_t (8));
+
+  //  a compare delegate which cannot be described disables the cache
+  nl1.device_class_by_name ("NMOS")->set_parameter_compare_delegate (new CustomDeviceParameterCompare ());
+
+  au = compare_hier (nl1, nl2, 0, 0, good_ref);
+  EXPECT_EQ (compare_hier (nl1, nl2, 0, &cache, good), au);
+  EXPECT_EQ (good, good_ref);
+  EXPECT_EQ (cache.size (), size_t (8));
+  EXPECT_EQ (cache.hits (), size_t (8));
+
+  //  loading an invalid file fails and leaves an empty cache
+  {
+    tl::OutputStream os (path);
+    os << "xyz";
+  }
+
+  bool error = false;
+  try {
+    cache.load (path);
+  } catch (tl::Exception &) {
+    error = true;
+  }
+  EXPECT_EQ (error, true);
+  EXPECT_EQ (cache.size (), size_t (0));
+}
@@ -803,3 +803,93 @@ TEST(42_DMOS4DeviceExtractorTestCircular)
   EXPECT_EQ (o3.to_string (), "(-100,-500;-100,900;1000,900;1000,-500/200,-200;700,-200;700,600;200,600)");
   EXPECT_EQ (o4.to_string (), "(-100,-500;-100,900;1000,900;1000,-500/200,-200;700,-200;700,600;200,600)");
 }
+
+static std::string extract_mos3_array (int threads, std::string &terminals, std::string &errors)
+{
+  db::Layout ly;
+  unsigned int l1 = ly.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = ly.insert_layer (db::LayerProperties (2, 0));
+
+  db::Cell &tc = ly.cell (ly.add_cell ("TOP"));
+  db::Cell &tr = ly.cell (ly.add_cell ("T"));
+
+  tr.shapes (l1).insert (db::Box (0, 0, 400, 400));
+  tr.shapes (l1).insert (db::Box (600, 0, 1000, 400));
+  tr.shapes (l2).insert (db::Box (400, 0, 600, 400));
+
+  for (int i = 0; i < 10; ++i) {
+    tc.insert (db::CellInstArray (db::CellInst (tr.cell_index ()), db::Trans (db::Vector (i * 2000, 0))));
+  }
+
+  //  flat devices with different gate lengths and a few with the same geometry
+  for (int i = 0; i < 50; ++i) {
+    db::Coord x = i * 2000, y = 5000;
+    db::Coord w = 100 + (i % 20) * 10;
+    tc.shapes (l1).insert (db::Box (x, y, x + 400, y + 400));
+    tc.shapes (l1).insert (db::Box (x + 400 + w, y, x + 1000, y + 400));
+    tc.shapes (l2).insert (db::Box (x + 400, y, x + 400 + w, y + 400));
+  }
+
+  //  gates without diffusion produce errors
+  for (int i = 0; i < 5; ++i) {
+    db::Coord x = i * 2000, y = 10000;
+    tc.shapes (l2).insert (db::Box (x, y, x + 100 + i * 10, y + 500));
+  }
+
+  db::DeepShapeStore dss;
+  dss.set_threads (threads);
+
+  db::Region r1 (db::RecursiveShapeIterator (ly, tc, l1), dss);
+  db::Region r2 (db::RecursiveShapeIterator (ly, tc, l2), dss);
+  db::Region o1 (dss);
+  db::Region o2 (dss);
+  db::Region o3 (dss);
+
+  db::Netlist nl;
+  db::hier_clusters<db::NetShape> cl;
+
+  db::NetlistDeviceExtractorMOS3Transistor ex ("MOS3");
+
+  db::NetlistDeviceExtractor::input_layers dl;
+
+  dl["SD"] = &r1;
+  dl["G"] = &r2;
+  dl["tS"] = &o1;
+  dl["tD"] = &o2;
+  dl["tG"] = &o3;
+  ex.extract (dss, 0, dl, nl, cl);
+
+  terminals = o1.to_string (1000) + "\n" + o2.to_string (1000) + "\n" + o3.to_string (1000);
+
+  errors.clear ();
+  for (db::NetlistDeviceExtractor::error_iterator e = ex.begin_errors (); e != ex.end_errors (); ++e) {
+    errors += error2string (*e);
+    errors += "\n";
+  }
+
+  return nl.to_string ();
+}
+
+TEST(50_MOS3DeviceExtractorMultiThreaded)
+{
+  std::string terminals_st, errors_st;
+  std::string nl_st = extract_mos3_array (0, terminals_st, errors_st);
+
+  std::string terminals_mt, errors_mt;
+  std::string nl_mt = extract_mos3_array (4, terminals_mt, errors_mt);
+
+  //  the threaded extraction delivers the same devices in the same order
+  EXPECT_EQ (nl_mt, nl_st);
+  EXPECT_EQ (terminals_mt, terminals_st);
+  EXPECT_EQ (errors_mt, errors_st);
+
+  EXPECT_EQ (std::count (errors_mt.begin (), errors_mt.end (), '\n'), 5);
+  EXPECT_EQ (errors_mt.find ("TOP:::(0,0;0,0.5;0.1,0.5;0.1,0):Gate shape touches no diffusion - ignored\n") != std::string::npos, true);
+
+  //  50 devices in TOP and one in T
+  size_t n = 0;
+  for (size_t p = nl_mt.find ("device MOS3"); p != std::string::npos; p = nl_mt.find ("device MOS3", p + 1)) {
+    ++n;
+  }
+  EXPECT_EQ (n, size_t (51));
+}
@@ -0,0 +1,243 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "dbPolygonArrays.h"
+#include "tlUnitTest.h"
+#include "tlString.h"
+#include "tlTimer.h"
+
+template <class Iter>
+static std::string join (Iter from, Iter to)
+{
+  std::string r;
+  for (Iter i = from; i != to; ++i) {
+    if (! r.empty ()) {
+      r += ",";
+    }
+    r += tl::to_string (*i);
+  }
+  return r;
+}
+
+TEST(1)
+{
+  db::PolygonArrays pa;
+  EXPECT_EQ (pa.size (), size_t (0));
+  EXPECT_EQ (pa.empty (), true);
+  EXPECT_EQ (pa.contour_offsets ().size (), size_t (1));
+  EXPECT_EQ (pa.polygon_offsets ().size (), size_t (1));
+
+  db::Polygon p1 (db::Box (0, 0, 100, 200));
+
+  db::Polygon p2 (db::Box (0, 0, 1000, 1000));
+  db::Point hole [] = { db::Point (100, 100), db::Point (100, 200), db::Point (200, 200), db::Point (200, 100) };
+  p2.insert_hole (hole + 0, hole + sizeof (hole) / sizeof (hole [0]));
+
+  pa.add (p1);
+  pa.add (p2);
+
+  EXPECT_EQ (pa.size (), size_t (2));
+  EXPECT_EQ (pa.empty (), false);
+  EXPECT_EQ (pa.coordinates ().size (), size_t (24));
+  EXPECT_EQ (join (pa.contour_offsets ().begin (), pa.contour_offsets ().end ()), "0,4,8,12");
+  EXPECT_EQ (join (pa.polygon_offsets ().begin (), pa.polygon_offsets ().end ()), "0,1,3");
+  EXPECT_EQ (join (pa.coordinates ().begin (), pa.coordinates ().begin () + 8), "0,0,0,200,100,200,100,0");
+
+  EXPECT_EQ (pa.polygon (0).to_string (), p1.to_string ());
+  EXPECT_EQ (pa.polygon (1).to_string (), p2.to_string ());
+
+  db::PolygonArrays pa2 (pa.coordinates (), pa.contour_offsets (), pa.polygon_offsets ());
+  EXPECT_EQ (pa2.size (), size_t (2));
+  EXPECT_EQ (pa2.polygon (1).to_string (), p2.to_string ());
+
+  pa.clear ();
+  EXPECT_EQ (pa.size (), size_t (0));
+  EXPECT_EQ (pa.coordinates ().empty (), true);
+}
+
+TEST(2)
+{
+  //  empty offset arrays are accepted
+  db::PolygonArrays::coordinates_type no_coordinates;
+  db::PolygonArrays::offsets_type no_offsets;
+  db::PolygonArrays pa (no_coordinates, no_offsets, no_offsets);
+  EXPECT_EQ (pa.size (), size_t (0));
+
+  db::PolygonArrays::coordinates_type c;
+  c.push_back (0); c.push_back (0);
+  c.push_back (0); c.push_back (100);
+  c.push_back (100); c.push_back (100);
+
+  db::PolygonArrays::offsets_type co;
+  co.push_back (0);
+  co.push_back (3);
+
+  db::PolygonArrays::offsets_type po;
+  po.push_back (0);
+  po.push_back (1);
+
+  db::PolygonArrays pa2 (c, co, po);
+  EXPECT_EQ (pa2.size (), size_t (1));
+  EXPECT_EQ (pa2.polygon (0).to_string (), "(0,0;0,100;100,100)");
+
+  //  inconsistent arrays
+  co.back () = 2;
+  try {
+    db::PolygonArrays pa3 (c, co, po);
+    EXPECT_EQ (true, false);
+  } catch (tl::Exception &) {
+    //  .. expected ..
+  }
+
+  co.back () = 3;
+  po.back () = 2;
+  try {
+    db::PolygonArrays pa3 (c, co, po);
+    EXPECT_EQ (true, false);
+  } catch (tl::Exception &) {
+    //  .. expected ..
+  }
+
+  c.pop_back ();
+  po.back () = 1;
+  try {
+    db::PolygonArrays pa3 (c, co, po);
+    EXPECT_EQ (true, false);
+  } catch (tl::Exception &) {
+    //  .. expected ..
+  }
+}
+
+//  packed form
+TEST(3)
+{
+  db::PolygonArrays pa;
+  EXPECT_EQ (pa.to_packed ().size (), size_t (5 * 4));
+  EXPECT_EQ (db::PolygonArrays::from_packed (pa.to_packed ()).size (), size_t (0));
+
+  db::Polygon p1 (db::Box (-1, 0, 100, 200));
+  db::Point hole [] = { db::Point (10, 20), db::Point (10, 40), db::Point (30, 40), db::Point (30, 20) };
+  p1.insert_hole (hole + 0, hole + sizeof (hole) / sizeof (hole [0]));
+  pa.add (p1);
+  pa.add (db::Polygon (db::Box (-100000, -200000, 2000000000, 300)));
+
+  std::vector<char> data = pa.to_packed ();
+  //  3 counts, 3 polygon offsets, 4 contour offsets, 24 coordinates
+  EXPECT_EQ (data.size (), size_t ((3 + 3 + 4 + 24) * 4));
+
+  //  little-endian: the number of polygons first
+  EXPECT_EQ (int (data [0]), 2);
+  EXPECT_EQ (int (data [1]), 0);
+  EXPECT_EQ (int (data [2]), 0);
+  EXPECT_EQ (int (data [3]), 0);
+  //  the first coordinate is -1
+  EXPECT_EQ (int ((unsigned char) data [40]), 0xff);
+  EXPECT_EQ (int ((unsigned char) data [43]), 0xff);
+
+  db::PolygonArrays pa2 = db::PolygonArrays::from_packed (data);
+  EXPECT_EQ (pa2.size (), size_t (2));
+  EXPECT_EQ (pa2.polygon (0).to_string (), "(-1,0;-1,200;100,200;100,0/10,20;30,20;30,40;10,40)");
+  EXPECT_EQ (pa2.polygon (1).to_string (), "(-100000,-200000;-100000,300;2000000000,300;2000000000,-200000)");
+  EXPECT_EQ (join (pa2.coordinates ().begin (), pa2.coordinates ().end ()), join (pa.coordinates ().begin (), pa.coordinates ().end ()));
+
+  //  inconsistent data
+  try {
+    db::PolygonArrays::from_packed (std::vector<char> (data.begin (), data.end () - 4));
+    EXPECT_EQ (true, false);
+  } catch (tl::Exception &) {
+    //  .. expected ..
+  }
+
+  try {
+    db::PolygonArrays::from_packed (std::vector<char> (data.begin (), data.end () - 1));
+    EXPECT_EQ (true, false);
+  } catch (tl::Exception &) {
+    //  .. expected ..
+  }
+
+  std::vector<char> bad = data;
+  bad [12 + 4] = 5;  //  second polygon offset
+  try {
+    db::PolygonArrays::from_packed (bad);
+    EXPECT_EQ (true, false);
+  } catch (tl::Exception &) {
+    //  .. expected ..
+  }
+
+  //  plain integer arrays
+  std::vector<db::Coord> c;
+  c.push_back (1);
+  c.push_back (-2);
+  c.push_back (0x12345678);
+  std::vector<char> cp = db::pack_int32 (c);
+  EXPECT_EQ (cp.size (), size_t (12));
+  EXPECT_EQ (int ((unsigned char) cp [8]), 0x78);
+  EXPECT_EQ (int ((unsigned char) cp [11]), 0x12);
+  std::vector<db::Coord> c2 = db::unpack_int32 (cp);
+  EXPECT_EQ (join (c2.begin (), c2.end ()), "1,-2,305419896");
+
+  try {
+    db::unpack_int32 (std::vector<char> (3, 'a'));
+    EXPECT_EQ (true, false);
+  } catch (tl::Exception &) {
+    //  .. expected ..
+  }
+
+#if defined(HAVE_64BIT_COORD)
+  //  coordinates beyond the 32 bit range can't be packed
+  c.push_back (db::Coord (1) << 40);
+  try {
+    db::pack_int32 (c);
+    EXPECT_EQ (true, false);
+  } catch (tl::Exception &) {
+    //  .. expected ..
+  }
+#endif
+}
+
+//  packed form versus the list form with many polygons
+TEST(4)
+{
+  db::PolygonArrays pa;
+  for (int i = 0; i < 100000; ++i) {
+    pa.add (db::Polygon (db::Box (i, -i, i + 10 + (i % 17), 20)));
+  }
+
+  std::vector<char> data;
+  {
+    tl::SelfTimer timer ("Packing 100000 polygons");
+    data = pa.to_packed ();
+  }
+
+  db::PolygonArrays pa2;
+  {
+    tl::SelfTimer timer ("Unpacking 100000 polygons");
+    pa2 = db::PolygonArrays::from_packed (data);
+  }
+
+  EXPECT_EQ (pa2.size (), pa.size ());
+  EXPECT_EQ (pa2.coordinates () == pa.coordinates (), true);
+  EXPECT_EQ (pa2.contour_offsets () == pa.contour_offsets (), true);
+  EXPECT_EQ (pa2.polygon_offsets () == pa.polygon_offsets (), true);
+  EXPECT_EQ (pa2.polygon (99999).to_string (), pa.polygon (99999).to_string ());
+}
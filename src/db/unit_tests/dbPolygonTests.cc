@@ -1349,3 +1349,141 @@ TEST(28)
   db::Polygon b (db::Box (-1000000000, -1000000000, 1000000000, 1000000000));
   EXPECT_EQ (b.perimeter (), 8000000000.0);
 }
+
+static std::vector<db::Point> curvy_points (int n, int r, int dx = 0)
+{
+  std::vector<db::Point> pts;
+  for (int i = 0; i < n; ++i) {
+    double a = 2.0 * M_PI * i / n;
+    pts.push_back (db::Point (dx + int (floor (r * cos (a) + 0.5)), int (floor (r * sin (a) + 0.5))));
+  }
+  return pts;
+}
+
+TEST(29)
+{
+  //  packed polygon contours
+  std::vector<db::Point> pts = curvy_points (1000, 100000);
+
+  db::Polygon poly;
+  poly.assign_hull (pts.begin (), pts.end ());
+  std::vector<db::Point> hole = curvy_points (500, 10000, 50000);
+  poly.insert_hole (hole.begin (), hole.end ());
+
+  db::Polygon packed (poly);
+  EXPECT_EQ (packed.is_packed (), false);
+  packed.pack ();
+  EXPECT_EQ (packed.is_packed (), true);
+  EXPECT_EQ (packed.hull ().is_packed (), true);
+  EXPECT_EQ (packed.hole (0).is_packed (), true);
+
+  EXPECT_EQ (packed == poly, true);
+  EXPECT_EQ (packed.to_string (), poly.to_string ());
+  EXPECT_EQ (packed.vertices (), poly.vertices ());
+  EXPECT_EQ (packed.hull ().bbox ().to_string (), poly.hull ().bbox ().to_string ());
+  EXPECT_EQ (packed.area (), poly.area ());
+  EXPECT_EQ (packed.perimeter (), poly.perimeter ());
+  EXPECT_EQ (packed.is_rectilinear (), false);
+  EXPECT_EQ (packed.hole (0).is_hole (), true);
+
+  //  random access
+  for (size_t i = 0; i < poly.hull ().size (); i += 7) {
+    EXPECT_EQ (packed.hull () [i].to_string (), poly.hull () [i].to_string ());
+  }
+
+  //  edges
+  db::Polygon::polygon_edge_iterator e1 = packed.begin_edge (), e2 = poly.begin_edge ();
+  while (! e1.at_end () && ! e2.at_end ()) {
+    EXPECT_EQ ((*e1).to_string (), (*e2).to_string ());
+    ++e1;
+    ++e2;
+  }
+  EXPECT_EQ (e1.at_end (), true);
+  EXPECT_EQ (e2.at_end (), true);
+
+  //  copy and swap keep the packed state
+  db::Polygon copy (packed);
+  EXPECT_EQ (copy.is_packed (), true);
+  EXPECT_EQ (copy == poly, true);
+  db::Polygon swapped;
+  swapped.swap (copy);
+  EXPECT_EQ (swapped.is_packed (), true);
+  EXPECT_EQ (swapped == poly, true);
+
+  //  move keeps the packed state too
+  db::Polygon moved = packed.moved (db::Vector (-1000, 2000));
+  EXPECT_EQ (moved.is_packed (), true);
+  EXPECT_EQ (moved == poly.moved (db::Vector (-1000, 2000)), true);
+
+  //  other transformations unpack
+  db::Polygon transformed = packed.transformed (db::Trans (db::Trans::r90));
+  EXPECT_EQ (transformed.is_packed (), false);
+  EXPECT_EQ (transformed == poly.transformed (db::Trans (db::Trans::r90)), true);
+
+  //  unpacking
+  db::Polygon::contour_type c (packed.hull ());
+  c.unpack ();
+  EXPECT_EQ (c.is_packed (), false);
+  EXPECT_EQ (c == poly.hull (), true);
+}
+
+TEST(30)
+{
+  //  packed contours: special cases
+
+  //  boxes are not packed as this does not save memory
+  db::Polygon box (db::Box (0, 0, 100, 200));
+  box.pack ();
+  EXPECT_EQ (box.is_packed (), false);
+  EXPECT_EQ (box.to_string (), "(0,0;0,200;100,200;100,0)");
+
+  //  floating-point polygons are not packed
+  db::DPolygon dpoly;
+  std::vector<db::Point> pts = curvy_points (100, 100000);
+  std::vector<db::DPoint> dpts (pts.begin (), pts.end ());
+  dpoly.assign_hull (dpts.begin (), dpts.end ());
+  dpoly.pack ();
+  EXPECT_EQ (dpoly.is_packed (), false);
+
+  //  rectilinear ("compressed") contours: a staircase
+  std::vector<db::Point> stairs;
+  for (int i = 0; i < 200; ++i) {
+    stairs.push_back (db::Point (i * 10, i * 5));
+    stairs.push_back (db::Point ((i + 1) * 10, i * 5));
+  }
+  stairs.push_back (db::Point (2000, 2000));
+  stairs.push_back (db::Point (0, 2000));
+
+  db::SimplePolygon sp;
+  sp.assign_hull (stairs.begin (), stairs.end ());
+  db::SimplePolygon spp (sp);
+  spp.pack ();
+  EXPECT_EQ (spp.is_packed (), true);
+  EXPECT_EQ (spp.is_rectilinear (), true);
+  EXPECT_EQ (spp == sp, true);
+  EXPECT_EQ (spp.to_string (), sp.to_string ());
+  EXPECT_EQ (spp.box ().to_string (), sp.box ().to_string ());
+  EXPECT_EQ (spp.area2 (), sp.area2 ());
+
+  //  reverse access
+  for (size_t i = sp.hull ().size (); i > 0; i -= 3) {
+    EXPECT_EQ (spp.hull () [i - 1].to_string (), sp.hull () [i - 1].to_string ());
+    if (i < 3) {
+      break;
+    }
+  }
+
+  //  big deltas
+  std::vector<db::Point> big;
+  for (int i = 0; i < 40; ++i) {
+    big.push_back (db::Point (i * 10, (i % 2) == 0 ? -1000000000 : 1000000000));
+  }
+  big.push_back (db::Point (400, 1000000000));
+  big.push_back (db::Point (0, 1000000000));
+  db::Polygon bp;
+  bp.assign_hull (big.begin (), big.end ());
+  db::Polygon bpp (bp);
+  bpp.pack ();
+  EXPECT_EQ (bpp.is_packed (), true);
+  EXPECT_EQ (bpp == bp, true);
+}
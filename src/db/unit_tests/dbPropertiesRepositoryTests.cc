@@ -259,3 +259,74 @@ TEST(6)
   EXPECT_EQ (pid2, size_t (2));
 }
 
+
+TEST(7) 
+{
+  db::PropertiesRepository rep;
+
+  db::property_names_id_type n1 = rep.prop_name_id (tl::Variant ("A"));
+  db::property_names_id_type n2 = rep.prop_name_id (tl::Variant (17));
+
+  //  many sets: ids are assigned consecutively and found again
+  for (unsigned int i = 0; i < 10000; ++i) {
+    db::PropertiesRepository::properties_set set;
+    set.insert (std::make_pair (n1, tl::Variant (i)));
+    if (i % 3 == 0) {
+      set.insert (std::make_pair (n2, tl::Variant (tl::sprintf ("v%u", i))));
+    }
+    EXPECT_EQ (rep.properties_id (set), size_t (i + 1));
+  }
+
+  for (unsigned int i = 0; i < 10000; i += 7) {
+    db::PropertiesRepository::properties_set set;
+    set.insert (std::make_pair (n1, tl::Variant (i)));
+    if (i % 3 == 0) {
+      set.insert (std::make_pair (n2, tl::Variant (tl::sprintf ("v%u", i))));
+    }
+    EXPECT_EQ (rep.properties_id (set), size_t (i + 1));
+    EXPECT_EQ (rep.properties (i + 1) == set, true);
+  }
+
+  EXPECT_EQ (rep.end_id (), size_t (10001));
+  EXPECT_EQ (rep.is_valid_properties_id (10000), true);
+  EXPECT_EQ (rep.is_valid_properties_id (10001), false);
+  EXPECT_EQ (rep.properties (10001).empty (), true);
+
+  //  values of different numerical types which compare equal give the same set
+  db::PropertiesRepository::properties_set sd;
+  sd.insert (std::make_pair (n1, tl::Variant (17.0)));
+  EXPECT_EQ (rep.properties_id (sd), size_t (18));
+
+  //  signed and unsigned values are not equal
+  db::PropertiesRepository::properties_set sl;
+  sl.insert (std::make_pair (n1, tl::Variant ((long) 17)));
+  EXPECT_EQ (rep.properties_id (sl), size_t (10001));
+
+  //  changing a set: the new set is found under the old id, the old set is not found anymore
+  db::PropertiesRepository::properties_set snew;
+  snew.insert (std::make_pair (n2, tl::Variant ("new")));
+  rep.change_properties (18, snew);
+  EXPECT_EQ (rep.properties_id (snew), size_t (18));
+  //  (the double value is equal to the long value too)
+  EXPECT_EQ (rep.properties_id (sd), size_t (10001));
+
+  //  in-place modification through the non-const iterator
+  for (db::PropertiesRepository::non_const_iterator p = rep.begin_non_const (); p != rep.end_non_const (); ++p) {
+    if (p->first == 18) {
+      p->second.clear ();
+      p->second.insert (std::make_pair (n2, tl::Variant ("modified")));
+    }
+  }
+
+  db::PropertiesRepository::properties_set smod;
+  smod.insert (std::make_pair (n2, tl::Variant ("modified")));
+  EXPECT_EQ (rep.properties_id (smod), size_t (18));
+  EXPECT_EQ (rep.properties_id (snew), size_t (10002));
+
+  //  copies
+  db::PropertiesRepository rep2;
+  rep2 = rep;
+  EXPECT_EQ (rep2.properties_id (smod), size_t (18));
+  EXPECT_EQ (rep2.properties_id (sl), size_t (10001));
+  EXPECT_EQ (rep2.end_id (), size_t (10003));
+}
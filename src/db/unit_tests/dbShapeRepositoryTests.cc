@@ -408,3 +408,118 @@ TEST(4)
 
 }
 
+
+TEST(5)
+{
+  //  many shapes, duplicates and copying
+
+  db::repository<db::Polygon> rep;
+
+  std::vector<const db::Polygon *> ptrs;
+  for (int i = 0; i < 10000; ++i) {
+    db::Polygon p (db::Box (0, 0, 10 + i, 20 + (i % 7)));
+    ptrs.push_back (rep.insert (p));
+  }
+
+  EXPECT_EQ (rep.size (), size_t (10000));
+
+  //  the shapes don't move while the repository grows and duplicates are found
+  for (int i = 0; i < 10000; ++i) {
+    db::Polygon p (db::Box (0, 0, 10 + i, 20 + (i % 7)));
+    EXPECT_EQ (rep.insert (p) == ptrs [i], true);
+    EXPECT_EQ (*ptrs [i] == p, true);
+  }
+
+  EXPECT_EQ (rep.size (), size_t (10000));
+
+  //  packed polygons are identical to unpacked ones
+  db::Polygon pp (db::Box (0, 0, 110, 20 + (100 % 7)));
+  pp.pack ();
+  EXPECT_EQ (rep.insert (pp) == ptrs [100], true);
+
+  //  the shapes are delivered in the order of insertion
+  size_t n = 0;
+  for (db::repository<db::Polygon>::iterator i = rep.begin (); i != rep.end (); ++i, ++n) {
+    if (&*i != ptrs [n]) {
+      EXPECT_EQ (n, size_t (0));
+      break;
+    }
+  }
+  EXPECT_EQ (n, size_t (10000));
+
+  db::repository<db::Polygon> rep2 (rep);
+  EXPECT_EQ (rep2.size (), size_t (10000));
+  EXPECT_EQ (rep2.insert (*ptrs [42]) == ptrs [42], false);
+  EXPECT_EQ (*rep2.insert (*ptrs [42]) == *ptrs [42], true);
+  EXPECT_EQ (rep2.size (), size_t (10000));
+
+  db::repository<db::Text> trep;
+  const db::Text *t1 = trep.insert (db::Text ("A", db::Trans (db::Vector (1, 2))));
+  const db::Text *t2 = trep.insert (db::Text ("B", db::Trans (db::Vector (1, 2))));
+  const db::Text *t3 = trep.insert (db::Text ("A", db::Trans (db::Vector (1, 2))));
+  EXPECT_EQ (t1 == t3, true);
+  EXPECT_EQ (t1 == t2, false);
+  EXPECT_EQ (trep.size (), size_t (2));
+}
+
+//  end iterator and insertion at the block boundaries
+TEST(6)
+{
+  db::repository<db::Polygon> rep;
+  EXPECT_EQ (rep.begin () == rep.end (), true);
+
+  //  16, 48 and 112 are the block boundaries
+  size_t checks[] = { 1, 15, 16, 17, 47, 48, 49, 112, 113, 5000 };
+  size_t c = 0;
+
+  for (int i = 0; i < 5000; ++i) {
+
+    rep.insert (db::Polygon (db::Box (0, 0, i + 1, 1)));
+
+    if (rep.size () == checks [c]) {
+
+      ++c;
+
+      size_t n = 0;
+      int w = 0;
+      for (db::repository<db::Polygon>::iterator s = rep.begin (); s != rep.end (); ++s, ++n) {
+        if (db::Coord (s->box ().width ()) != ++w) {
+          break;
+        }
+      }
+      EXPECT_EQ (n, rep.size ());
+
+      db::repository<db::Polygon> rep2;
+      rep2 = rep;
+      EXPECT_EQ (rep2.size (), rep.size ());
+      EXPECT_EQ (size_t (std::distance (rep2.begin (), rep2.end ())), rep.size ());
+
+    }
+
+  }
+
+  EXPECT_EQ (c, sizeof (checks) / sizeof (checks [0]));
+}
+
+//  hash slot distribution for shapes on a regular grid
+TEST(7)
+{
+  const unsigned int bits = 13;
+  std::vector<bool> used (size_t (1) << bits, false);
+
+  size_t n = 0;
+  for (int i = 0; i < 64; ++i) {
+    for (int j = 0; j < 64; ++j) {
+      db::Polygon poly (db::Box (i * 1000, j * 1000, i * 1000 + 500, j * 1000 + 500));
+      size_t slot = db::repository_hash_slot (db::repository_hash<db::Polygon> () (poly), bits);
+      EXPECT_EQ (slot < used.size (), true);
+      if (! used [slot]) {
+        used [slot] = true;
+        ++n;
+      }
+    }
+  }
+
+  //  4096 random values occupy about 3200 of 8192 slots
+  EXPECT_EQ (n > 3000, true);
+}
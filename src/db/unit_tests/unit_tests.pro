@@ -47,6 +47,7 @@ SOURCES = \
     dbRegionTests.cc \
     dbPropertiesRepositoryTests.cc \
     dbPolygonTests.cc \
+    dbPolygonArraysTests.cc \
     dbPointTests.cc \
     dbPCellsTests.cc \
     dbPathTests.cc \
@@ -76,7 +77,8 @@ SOURCES = \
     dbBoxTests.cc \
     dbArrayTests.cc \
     dbDeepTextsTests.cc \
-    dbNetShapeTests.cc
+    dbNetShapeTests.cc \
+    dbDeepXORTests.cc
 
 INCLUDEPATH += $$TL_INC $$DB_INC $$GSI_INC
 DEPENDPATH += $$TL_INC $$DB_INC $$GSI_INC
@@ -51,6 +51,11 @@ module DRC
 
       @verbose = false
 
+      @profile = false
+      @profile_n = 0
+      @profile_sort = "wall"
+      @profile_file = nil
+
     end
     
     def joined
@@ -351,6 +356,53 @@ module DRC
       @verbose = f
     end
     
+    # %DRC%
+    # @name profile
+    # @brief Enables profiling of the DRC operations
+    # @synopsis profile
+    # @synopsis profile(n)
+    # @synopsis profile(n, sort_key)
+    # In profiling mode, the wall and CPU time, the thread utilization, the memory 
+    # allocated, the peak memory and the number of input and output shapes are 
+    # recorded for every layer operation. In deep mode, the individual hierarchical 
+    # processor runs are recorded as well.
+    #
+    # At the end of the run, a summary table listing the "n" most expensive 
+    # operations is printed to the log. If "n" is 0 (the default), all operations
+    # are listed. "sort_key" specifies the sort order: "wall" (wall time, the default),
+    # "cpu" (CPU time), "memory" (memory allocated), "peak" (peak memory), "inputs" 
+    # and "outputs" (input and output shape count) or "order" (order of execution).
+    #
+    # Use \profile_report to write the full report to a file.
+    #
+    # @code
+    # profile(10)
+    # deep
+    # ...
+    # @/code
+    
+    def profile(n = 0, sort_key = "wall")
+      @profile = true
+      @profile_n = n.to_i
+      @profile_sort = sort_key.to_s
+      RBA::Profiler::clear
+      RBA::Profiler::enabled = true
+    end
+    
+    # %DRC%
+    # @name profile_report
+    # @brief Writes the profiling report to a file
+    # @synopsis profile_report(filename)
+    # This function enables profiling (see \profile) and specifies a file to which
+    # the full profiling report is written at the end of the run. The format is 
+    # derived from the file's suffix: ".json" produces JSON and ".csv" produces CSV.
+    # Other suffixes will produce the summary table in text form.
+    
+    def profile_report(filename)
+      @profile || profile(@profile_n, @profile_sort)
+      @profile_file = filename
+    end
+    
     # %DRC%
     # @name info 
     # @brief Outputs as message to the logger window
@@ -1423,7 +1475,22 @@ CODE
       t = RBA::Timer::new
       t.start
       GC.start # force a garbage collection before the operation to free unused memory
-      res = yield
+
+      if @profile
+        input_count = _profile_count(obj)
+        ps = RBA::ProfileScope::new("drc", desc, @tt || 1)
+        ps.input_count = input_count
+      end
+
+      begin
+        res = yield
+        if ps
+          ps.output_count = _profile_count(res)
+        end
+      ensure
+        ps && ps.finish
+      end
+
       t.stop
 
       info("Elapsed: #{'%.3f'%(t.sys+t.user)}s")
@@ -1437,6 +1504,16 @@ CODE
 
     end
     
+    def _profile_count(obj)
+      if obj.is_a?(RBA::Region) || obj.is_a?(RBA::Edges) || obj.is_a?(RBA::EdgePairs) || obj.is_a?(RBA::Texts)
+        obj.size
+      elsif obj.is_a?(Array)
+        obj.inject(0) { |n,o| n + _profile_count(o) }
+      else
+        0
+      end
+    end
+    
     def _cmd(obj, method, *args)
       run_timed("\"#{method}\" in: #{src_line}", obj) do
         obj.send(method, *args)
@@ -1549,6 +1626,21 @@ CODE
       end
     end
     
+    def _profile_report
+
+      RBA::Profiler::enabled = false
+      @profile = false
+
+      log(RBA::Profiler::summary(@profile_n, @profile_sort))
+
+      if @profile_file
+        profile_file = _make_path(@profile_file)
+        info("Writing profile report: #{profile_file} ..")
+        RBA::Profiler::write(profile_file, @profile_sort)
+      end
+
+    end
+
     def _start
     
       # clearing the selection avoids some nasty problems
@@ -1571,6 +1663,11 @@ CODE
       begin
 
         _flush    
+
+        # report the profile if requested
+        if @profile && final
+          _profile_report
+        end
         
         view = RBA::LayoutView::current
 
@@ -64,6 +64,7 @@ static int t_double () { return T_double; }
 static int t_float () { return T_float; }
 static int t_var () { return T_var; }
 static int t_string () { return T_string; }
+static int t_byte_array () { return T_byte_array; }
 static int t_void_ptr () { return T_void_ptr; }
 static int t_object () { return T_object; }
 static int t_vector () { return T_vector; }
@@ -112,6 +113,10 @@ Class<ArgType> decl_ArgType ("tl", "ArgType",
   gsi::method ("TypeFloat|#t_float", &t_float) +
   gsi::method ("TypeVar|#t_var", &t_var) +
   gsi::method ("TypeString|#t_string", &t_string) +
+  gsi::method ("TypeByteArray|#t_byte_array", &t_byte_array,
+    "@brief Represents binary data (a byte string)\n"
+    "This constant has been introduced in version 0.27."
+  ) +
   gsi::method ("TypeVoidPtr|#t_void_ptr", &t_void_ptr) +
   gsi::method ("TypeObject|#t_object", &t_object) +
   gsi::method ("TypeVector|#t_vector", &t_vector) +
@@ -24,6 +24,7 @@
 #include "gsiDecl.h"
 #include "tlLog.h"
 #include "tlTimer.h"
+#include "tlProfiler.h"
 #include "tlProgress.h"
 #include "tlExpression.h"
 #include "tlGlobPattern.h"
@@ -171,6 +172,18 @@ Class<tl::Timer> decl_Timer ("tl", "Timer",
   ) +
   gsi::method ("stop", &tl::Timer::stop, 
     "@brief Stops the timer\n"
+  ) +
+  gsi::method ("memory_size", &tl::Timer::memory_size,
+    "@brief Gets the current memory usage of the process in bytes\n"
+    "This is the resident set size of the process. If this value is not available on the platform, 0 is returned.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method ("peak_memory_size", &tl::Timer::peak_memory_size,
+    "@brief Gets the peak memory usage of the process in bytes\n"
+    "This is the maximum resident set size of the process so far. If this value is not available on the platform, 0 is returned.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
   ),
   "@brief A timer (stop watch)\n"
   "\n"
@@ -193,6 +206,170 @@ Class<tl::Timer> decl_Timer ("tl", "Timer",
 
 }
 
+// ----------------------------------------------------------------
+//  Profiler binding
+
+namespace gsi
+{
+
+/**
+ *  @brief A pseudo class that wraps the profiler functionality
+ */
+class Profiler
+{
+public:
+  static bool is_enabled ()
+  {
+    return tl::Profiler::instance ().is_enabled ();
+  }
+
+  static void set_enabled (bool f)
+  {
+    tl::Profiler::instance ().set_enabled (f);
+  }
+
+  static void clear ()
+  {
+    tl::Profiler::instance ().clear ();
+  }
+
+  static size_t count ()
+  {
+    return tl::Profiler::instance ().records ("order").size ();
+  }
+
+  static std::string to_csv (const std::string &sort_key)
+  {
+    return tl::Profiler::instance ().to_csv (sort_key);
+  }
+
+  static std::string to_json (const std::string &sort_key)
+  {
+    return tl::Profiler::instance ().to_json (sort_key);
+  }
+
+  static std::string summary (size_t n, const std::string &sort_key)
+  {
+    return tl::Profiler::instance ().summary (n, sort_key);
+  }
+
+  static void write (const std::string &path, const std::string &sort_key)
+  {
+    tl::Profiler::instance ().write (path, sort_key);
+  }
+};
+
+}
+
+namespace tl {
+  template <> struct type_traits<gsi::Profiler> : public type_traits<void> {
+    typedef tl::false_tag has_copy_constructor;
+    typedef tl::false_tag has_default_constructor;
+  };
+  template <> struct type_traits<tl::ProfileScope> : public type_traits<void> {
+    typedef tl::false_tag has_copy_constructor;
+    typedef tl::false_tag has_default_constructor;
+  };
+}
+
+namespace gsi
+{
+
+Class<Profiler> decl_Profiler ("tl", "Profiler",
+  gsi::method ("enabled?", &Profiler::is_enabled,
+    "@brief Gets a value indicating whether the profiler is enabled\n"
+  ) +
+  gsi::method ("enabled=", &Profiler::set_enabled, gsi::arg ("f"),
+    "@brief Enables or disables the profiler\n"
+    "If the profiler is enabled, profiled operations will produce profile records. "
+    "Disabling the profiler does not clear the records taken so far."
+  ) +
+  gsi::method ("clear", &Profiler::clear,
+    "@brief Clears all profile records\n"
+  ) +
+  gsi::method ("count", &Profiler::count,
+    "@brief Gets the number of profile records taken so far\n"
+  ) +
+  gsi::method ("to_csv", &Profiler::to_csv, gsi::arg ("sort_key", std::string ("wall")),
+    "@brief Gets the profile records in CSV format\n"
+    "See the class description for the sort keys available."
+  ) +
+  gsi::method ("to_json", &Profiler::to_json, gsi::arg ("sort_key", std::string ("wall")),
+    "@brief Gets the profile records in JSON format\n"
+    "See the class description for the sort keys available."
+  ) +
+  gsi::method ("summary", &Profiler::summary, gsi::arg ("n", size_t (0)), gsi::arg ("sort_key", std::string ("wall")),
+    "@brief Gets a summary table of the first n records\n"
+    "If n is 0, all records are listed. See the class description for the sort keys available."
+  ) +
+  gsi::method ("write", &Profiler::write, gsi::arg ("path"), gsi::arg ("sort_key", std::string ("wall")),
+    "@brief Writes the profile report to the given file\n"
+    "The format is determined from the file's suffix: \".json\" will produce JSON, \".csv\" will produce CSV. "
+    "Other suffixes will produce the summary table."
+  ),
+  "@brief The operation profiler\n"
+  "\n"
+  "The profiler collects profile records of expensive operations such as DRC operations and "
+  "hierarchical processor invocations. Each record provides the wall and CPU time, the thread utilization, "
+  "the memory allocated by the operation, the peak memory of the process and the number of input and output objects.\n"
+  "\n"
+  "The profiler is disabled by default. Profile records can be produced from scripts using \\ProfileScope.\n"
+  "\n"
+  "The records can be sorted by the following keys: \"wall\" (wall time), \"cpu\" (CPU time), \"memory\" (memory allocated "
+  "by the operation), \"peak\" (peak memory), \"inputs\" (input count), \"outputs\" (output count) or \"order\" (the order the records were taken).\n"
+  "\n"
+  "@code\n"
+  "RBA::Profiler::enabled = true\n"
+  "# ... do something\n"
+  "puts RBA::Profiler::summary(10)\n"
+  "RBA::Profiler::write(\"profile.json\")\n"
+  "@/code\n"
+  "\n"
+  "This class has been introduced in version 0.27.\n"
+);
+
+static tl::ProfileScope *new_profile_scope (const std::string &category, const std::string &description, unsigned int threads)
+{
+  return new tl::ProfileScope (category, description, threads);
+}
+
+Class<tl::ProfileScope> decl_ProfileScope ("tl", "ProfileScope",
+  gsi::constructor ("new", &new_profile_scope, gsi::arg ("category"), gsi::arg ("description"), gsi::arg ("threads", (unsigned int) 1),
+    "@brief Creates a new profile scope and starts taking the time\n"
+    "@param category The category of the operation (i.e. \"drc\")\n"
+    "@param description The description of the operation\n"
+    "@param threads The number of threads the operation is allowed to use\n"
+  ) +
+  gsi::method ("enabled?", &tl::ProfileScope::is_enabled,
+    "@brief Gets a value indicating whether the scope produces a record\n"
+    "This value is false if the profiler was disabled when the scope was created or if the scope was finished already."
+  ) +
+  gsi::method ("input_count=", &tl::ProfileScope::set_input_count, gsi::arg ("n"),
+    "@brief Sets the number of input objects\n"
+  ) +
+  gsi::method ("output_count=", &tl::ProfileScope::set_output_count, gsi::arg ("n"),
+    "@brief Sets the number of output objects\n"
+  ) +
+  gsi::method ("finish", &tl::ProfileScope::finish,
+    "@brief Finishes the scope and produces the profile record\n"
+  ),
+  "@brief A profile scope\n"
+  "\n"
+  "A profile scope measures time and memory from its creation until \\finish is called and produces "
+  "a profile record in the \\Profiler if the profiler is enabled.\n"
+  "\n"
+  "@code\n"
+  "scope = RBA::ProfileScope::new(\"script\", \"my operation\")\n"
+  "# ... do something\n"
+  "scope.output_count = result.count\n"
+  "scope.finish\n"
+  "@/code\n"
+  "\n"
+  "This class has been introduced in version 0.27.\n"
+);
+
+}
+
 // ----------------------------------------------------------------
 //  Progress reporter objects
 
@@ -297,6 +297,16 @@ struct test_arg_func<gsi::ObjectType>
   }
 };
 
+template <>
+struct test_arg_func<gsi::ByteArrayType>
+{
+  void operator () (bool *ret, const tl::Variant &arg, const gsi::ArgType & /*atype*/, bool /*loose*/)
+  {
+    //  byte arrays are represented as strings in expressions
+    *ret = arg.is_nil () || arg.is_a_string ();
+  }
+};
+
 template <>
 struct test_arg_func<gsi::VectorType>
 {
@@ -544,6 +554,38 @@ struct writer<StringType>
   }
 };
 
+/**
+ *  @brief Serialization for byte arrays
+ *
+ *  Byte arrays are represented as strings in expressions.
+ */
+template <>
+struct writer<ByteArrayType>
+{
+  void operator() (gsi::SerialArgs *aa, tl::Variant *arg, const gsi::ArgType &atype, tl::Heap *)
+  {
+    //  Cannot pass ownership currently
+    tl_assert (!atype.pass_obj ());
+
+    if (arg->is_nil ()) {
+
+      if (! (atype.is_ptr () || atype.is_cptr ())) {
+        //  nil is treated as an empty byte array for references
+        aa->write<void *> ((void *)new ByteArrayAdaptorImpl<std::vector<char> > (std::vector<char> ()));
+      } else {
+        aa->write<void *> ((void *)0);
+      }
+
+    } else {
+
+      //  NOTE: by convention we pass the ownership to the receiver for adaptors.
+      std::string s = arg->to_stdstring ();
+      aa->write<void *> ((void *)new ByteArrayAdaptorImpl<std::vector<char> > (std::vector<char> (s.begin (), s.end ())));
+
+    }
+  }
+};
+
 /**
  *  @brief Specialization for Variant
  */
@@ -774,6 +816,24 @@ struct reader<gsi::StringType>
   }
 };
 
+/**
+ *  @brief A reader specialization for byte arrays
+ */
+template <> 
+struct reader<gsi::ByteArrayType>
+{
+  void
+  operator() (tl::Variant *out, gsi::SerialArgs *rr, const gsi::ArgType &, tl::Heap *heap)
+  {
+    std::auto_ptr<ByteArrayAdaptor> a ((ByteArrayAdaptor *) rr->read<void *>(*heap));
+    if (!a.get ()) {
+      *out = tl::Variant ();
+    } else {
+      *out = tl::Variant (std::string (a->c_str (), a->size ()));
+    }
+  }
+};
+
 /**
  *  @brief A reader specialization for variants
  */
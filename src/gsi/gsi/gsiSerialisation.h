@@ -1102,6 +1102,133 @@ public:
   StringAdaptorImpl (const char_type *s) : StringAdaptorImplCCP<const char_type *> (s) { }
 };
 
+// ------------------------------------------------------------
+//  Byte array adaptor framework
+
+/**
+ *  @brief A generic adaptor for byte arrays
+ *  This is the base class for implementing generic access to binary data.
+ *  In contrast to strings, byte arrays are not subject to any encoding.
+ */
+class GSI_PUBLIC ByteArrayAdaptor
+  : public AdaptorBase
+{
+public:
+  /**
+   *  @brief Default constructor
+   */
+  ByteArrayAdaptor () { }
+
+  /**
+   *  @brief Destructor
+   */
+  virtual ~ByteArrayAdaptor () { }
+
+  /**
+   *  @brief Returns the size of the byte array
+   */
+  virtual size_t size () const = 0;
+
+  /**
+   *  @brief Returns a pointer to the data with size size()
+   */
+  virtual const char *c_str () const = 0;
+
+  /**
+   *  @brief Sets the byte array to the given data with length s
+   */
+  virtual void set (const char *c_str, size_t s, tl::Heap &heap) = 0;
+
+  /**
+   *  @brief copy_to implementation
+   */
+  virtual void copy_to (AdaptorBase *target, tl::Heap &heap) const
+  {
+    ByteArrayAdaptor *s = dynamic_cast<ByteArrayAdaptor *>(target);
+    tl_assert (s);
+    s->set (c_str (), size (), heap);
+  }
+};
+
+/**
+ *  @brief Generic byte array adaptor implementation
+ */
+template <class X>
+class GSI_PUBLIC_TEMPLATE ByteArrayAdaptorImpl
+  : public ByteArrayAdaptor
+{
+};
+
+/**
+ *  @brief Specialization for std::vector<char>
+ */
+template <>
+class GSI_PUBLIC ByteArrayAdaptorImpl<std::vector<char> >
+  : public ByteArrayAdaptor
+{
+public:
+  ByteArrayAdaptorImpl (std::vector<char> *s)
+    : mp_s (s), m_is_const (false)
+  {
+    //  .. nothing yet ..
+  }
+
+  ByteArrayAdaptorImpl (const std::vector<char> *s)
+    : mp_s (const_cast<std::vector<char> *> (s)), m_is_const (true)
+  {
+    //  .. nothing yet ..
+  }
+
+  ByteArrayAdaptorImpl (const std::vector<char> &s)
+    : m_is_const (false), m_s (s)
+  {
+    mp_s = &m_s;
+  }
+
+  ByteArrayAdaptorImpl ()
+    : m_is_const (false)
+  {
+    mp_s = &m_s;
+  }
+
+  virtual ~ByteArrayAdaptorImpl ()
+  {
+    //  .. nothing yet ..
+  }
+
+  virtual size_t size () const
+  {
+    return mp_s->size ();
+  }
+
+  virtual const char *c_str () const
+  {
+    return mp_s->empty () ? "" : &mp_s->front ();
+  }
+
+  virtual void set (const char *c_str, size_t s, tl::Heap &)
+  {
+    if (! m_is_const) {
+      mp_s->assign (c_str, c_str + s);
+    }
+  }
+
+  virtual void copy_to (AdaptorBase *target, tl::Heap &heap) const
+  {
+    ByteArrayAdaptorImpl<std::vector<char> > *s = dynamic_cast<ByteArrayAdaptorImpl<std::vector<char> > *>(target);
+    if (s) {
+      *s->mp_s = *mp_s;
+    } else {
+      ByteArrayAdaptor::copy_to (target, heap);
+    }
+  }
+
+private:
+  std::vector<char> *mp_s;
+  bool m_is_const;
+  std::vector<char> m_s;
+};
+
 // ------------------------------------------------------------
 //  Variant adaptor framework
 
@@ -1909,6 +2036,12 @@ inline AdaptorBase *create_adaptor_by_category(const string_adaptor_tag & /*tag*
   return new StringAdaptorImpl<X> (v);
 }
 
+template <class X, class V>
+inline AdaptorBase *create_adaptor_by_category(const byte_array_adaptor_tag & /*tag*/, V v)
+{
+  return new ByteArrayAdaptorImpl<X> (v);
+}
+
 template <class X, class V>
 inline AdaptorBase *create_adaptor_by_category(const variant_adaptor_tag & /*tag*/, const V &v)
 {
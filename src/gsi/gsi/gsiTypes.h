@@ -61,6 +61,7 @@ class GSI_PUBLIC SerialArgs;
 class GSI_PUBLIC VectorAdaptor;
 class GSI_PUBLIC MapAdaptor;
 class GSI_PUBLIC StringAdaptor;
+class GSI_PUBLIC ByteArrayAdaptor;
 class GSI_PUBLIC VariantAdaptor;
 class GSI_PUBLIC ClassBase;
 struct NoAdaptorTag;
@@ -115,7 +116,8 @@ enum BasicType
   T_void_ptr = 19,
   T_object = 20,
   T_vector = 21,
-  T_map = 22
+  T_map = 22,
+  T_byte_array = 23
 };
 
 /**
@@ -124,6 +126,7 @@ enum BasicType
  *  "pod" are the POD types (bool, char, short, int, long, long long, double, float, unsigned variants)
  *  "npod" types are strings, vectors, maps and variants and all other objects
  *    - strings   use StringAdaptor implementations
+ *    - byte arrays use ByteArrayAdaptor implementations
  *    - vectors   use VectorAdaptor implementations
  *    - maps      use MapAdaptor implementations
  *    - variants  use VariantAdaptor implementations
@@ -175,6 +178,7 @@ struct adaptor_category_tag { };
 struct vector_adaptor_tag   : public adaptor_category_tag { };
 struct map_adaptor_tag      : public adaptor_category_tag { };
 struct string_adaptor_tag   : public adaptor_category_tag { };
+struct byte_array_adaptor_tag : public adaptor_category_tag { };
 struct variant_adaptor_tag  : public adaptor_category_tag { };
 
 struct basic_type_tag       : public type_tag_base { };
@@ -224,6 +228,7 @@ struct adaptor_ptr_tag      : public npod_ptr_tag { };
 struct vector_tag           : public adaptor_direct_tag, public vector_adaptor_tag { }; 
 struct map_tag              : public adaptor_direct_tag, public map_adaptor_tag { }; 
 struct string_tag           : public adaptor_direct_tag, public string_adaptor_tag { };
+struct byte_array_tag : public adaptor_direct_tag, public byte_array_adaptor_tag { };
 struct var_tag              : public adaptor_direct_tag, public variant_adaptor_tag { };
 
 struct bool_cref_tag        : public pod_cref_tag { };
@@ -247,6 +252,7 @@ struct float_cref_tag       : public pod_cref_tag { };
 struct vector_cref_tag      : public adaptor_cref_tag, public vector_adaptor_tag { };
 struct map_cref_tag         : public adaptor_cref_tag, public map_adaptor_tag { };
 struct string_cref_tag      : public adaptor_cref_tag, public string_adaptor_tag { };
+struct byte_array_cref_tag : public adaptor_cref_tag, public byte_array_adaptor_tag { };
 struct var_cref_tag         : public adaptor_cref_tag, public variant_adaptor_tag { };
 
 struct bool_ref_tag         : public pod_ref_tag { };
@@ -270,6 +276,7 @@ struct float_ref_tag        : public pod_ref_tag { };
 struct vector_ref_tag       : public adaptor_ref_tag, public vector_adaptor_tag { };
 struct map_ref_tag          : public adaptor_ref_tag, public map_adaptor_tag { };
 struct string_ref_tag       : public adaptor_ref_tag, public string_adaptor_tag { };
+struct byte_array_ref_tag : public adaptor_ref_tag, public byte_array_adaptor_tag { };
 struct var_ref_tag          : public adaptor_ref_tag, public variant_adaptor_tag { };
 
 struct bool_cptr_tag        : public pod_cptr_tag { };
@@ -293,6 +300,7 @@ struct float_cptr_tag       : public pod_cptr_tag { };
 struct vector_cptr_tag      : public adaptor_cptr_tag, public vector_adaptor_tag { };
 struct map_cptr_tag         : public adaptor_cptr_tag, public map_adaptor_tag { };
 struct string_cptr_tag      : public adaptor_cptr_tag, public string_adaptor_tag { };
+struct byte_array_cptr_tag : public adaptor_cptr_tag, public byte_array_adaptor_tag { };
 struct var_cptr_tag         : public adaptor_cptr_tag, public variant_adaptor_tag { };
 
 struct bool_ptr_tag         : public pod_ptr_tag { };
@@ -316,6 +324,7 @@ struct float_ptr_tag        : public pod_ptr_tag { };
 struct vector_ptr_tag       : public adaptor_ptr_tag, public vector_adaptor_tag { };
 struct map_ptr_tag          : public adaptor_ptr_tag, public map_adaptor_tag { };
 struct string_ptr_tag       : public adaptor_ptr_tag, public string_adaptor_tag { };
+struct byte_array_ptr_tag : public adaptor_ptr_tag, public byte_array_adaptor_tag { };
 struct var_ptr_tag          : public adaptor_ptr_tag, public variant_adaptor_tag { };
 
 //  all other objects
@@ -556,6 +565,13 @@ template <> struct type_traits<const char * *>              : generic_type_trait
 template <> struct type_traits<const unsigned char * *>     : generic_type_traits<string_ptr_tag, StringAdaptor, T_string> { };
 template <> struct type_traits<const signed char * *>       : generic_type_traits<string_ptr_tag, StringAdaptor, T_string> { };
 
+//  std::vector<char> is not a list of characters but binary data
+template <> struct type_traits<std::vector<char> >          : generic_type_traits<byte_array_tag, ByteArrayAdaptor, T_byte_array> { };
+template <> struct type_traits<const std::vector<char> &>   : generic_type_traits<byte_array_cref_tag, ByteArrayAdaptor, T_byte_array> { };
+template <> struct type_traits<std::vector<char> &>         : generic_type_traits<byte_array_ref_tag, ByteArrayAdaptor, T_byte_array> { };
+template <> struct type_traits<const std::vector<char> *>   : generic_type_traits<byte_array_cptr_tag, ByteArrayAdaptor, T_byte_array> { };
+template <> struct type_traits<std::vector<char> *>         : generic_type_traits<byte_array_ptr_tag, ByteArrayAdaptor, T_byte_array> { };
+
 template <class X>
 struct type_traits<const X>
   : generic_type_traits<typename type_traits<X>::tag, typename type_traits<X>::value_type, T_void>
@@ -1976,6 +1992,11 @@ struct ObjectType { };
  */
 struct StringType { };
 
+/**
+ *  @brief Represents "T_byte_array" as a C++ type
+ */
+struct ByteArrayType { };
+
 /**
  *  @brief Represents "T_var" as a C++ type
  */
@@ -2053,6 +2074,9 @@ void do_on_type_impl (gsi::BasicType type, const A1 *arg1, const A2 *arg2, const
   case gsi::T_string:   
     call_variadic_function<F<StringType>, A1, A2, A3, A4, A5> () (arg1, arg2, arg3, arg4, arg5);
     break;
+  case gsi::T_byte_array:   
+    call_variadic_function<F<ByteArrayType>, A1, A2, A3, A4, A5> () (arg1, arg2, arg3, arg4, arg5);
+    break;
   case gsi::T_var:   
     call_variadic_function<F<VariantType>, A1, A2, A3, A4, A5> () (arg1, arg2, arg3, arg4, arg5);
     break;
@@ -2130,6 +2154,9 @@ void do_on_type_impl_second (gsi::BasicType type, const A1 *arg1, const A2 *arg2
   case gsi::T_string:   
     call_variadic_function<F<T1, StringType>, A1, A2, A3, A4, A5> () (arg1, arg2, arg3, arg4, arg5);
     break;
+  case gsi::T_byte_array:   
+    call_variadic_function<F<T1, ByteArrayType>, A1, A2, A3, A4, A5> () (arg1, arg2, arg3, arg4, arg5);
+    break;
   case gsi::T_var:   
     call_variadic_function<F<T1, VariantType>, A1, A2, A3, A4, A5> () (arg1, arg2, arg3, arg4, arg5);
     break;
@@ -2207,6 +2234,9 @@ void do_on_type_impl2 (gsi::BasicType type1, gsi::BasicType type2, const A1 *arg
   case gsi::T_string:   
     do_on_type_impl_second<StringType, F, A1, A2, A3, A4, A5> (type2, arg1, arg2, arg3, arg4, arg5);
     break;
+  case gsi::T_byte_array:   
+    do_on_type_impl_second<ByteArrayType, F, A1, A2, A3, A4, A5> (type2, arg1, arg2, arg3, arg4, arg5);
+    break;
   case gsi::T_var:   
     do_on_type_impl_second<VariantType, F, A1, A2, A3, A4, A5> (type2, arg1, arg2, arg3, arg4, arg5);
     break;
@@ -828,6 +828,7 @@ static gsi::Class<A> decl_a ("", "A",
   gsi::method ("a1c", &A::a1c) +
   gsi::method ("a2", &A::a2) +
   gsi::method ("a3", &A::a3) +
+  gsi::method ("a3_ba", &A::a3_ba) +
 #if defined(HAVE_QT)
   gsi::method ("a3_qba", &A::a3_qba) +
   gsi::method ("a3_qstr", &A::a3_qstr) +
@@ -836,6 +837,7 @@ static gsi::Class<A> decl_a ("", "A",
   gsi::method ("a4", &A::a4) +
   gsi::method ("a5|n=", &A::a5) +
   gsi::method ("a10_d", &A::a10_d) +
+  gsi::method ("a10_d_ba", &A::a10_d_ba) +
 #if defined(HAVE_QT)
   gsi::method ("a10_d_qba", &A::a10_d_qba) +
   gsi::method ("a10_d_qstr", &A::a10_d_qstr) +
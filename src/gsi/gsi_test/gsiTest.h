@@ -115,6 +115,9 @@ struct A
   int a3 (const std::string &x) { 
     return int (x.size ());
   }
+  int a3_ba (const std::vector<char> &x) {
+    return int (x.size ());
+  }
 #if defined(HAVE_QT)
   int a3_qstr (const QString &x) { 
     return x.size (); 
@@ -165,6 +168,7 @@ struct A
   unsigned long long a11_ull (double f) { return (unsigned long long)(f); }
 
   std::string a10_d (double f) { return tl::to_string (f); }
+  std::vector<char> a10_d_ba (double f) { std::string s = tl::to_string (f); return std::vector<char> (s.begin (), s.end ()); }
 #if defined(HAVE_QT)
   QByteArray a10_d_qba (double f) { return tl::to_qstring (tl::to_string (f)).toUtf8 (); }
   QString a10_d_qstr (double f) { return tl::to_qstring (tl::to_string (f)); }
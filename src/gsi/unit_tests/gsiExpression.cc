@@ -91,6 +91,12 @@ TEST(1)
   EXPECT_EQ (v.to_string (), std::string ("2"));
   v = e.parse ("a.a3('')").execute ();
   EXPECT_EQ (v.to_string (), std::string ("0"));
+  v = e.parse ("a.a3_ba('abc')").execute ();
+  EXPECT_EQ (v.to_string (), std::string ("3"));
+  v = e.parse ("a.a3_ba(nil)").execute ();
+  EXPECT_EQ (v.to_string (), std::string ("0"));
+  v = e.parse ("a.a10_d_ba(5.25)").execute ();
+  EXPECT_EQ (v.to_string (), std::string ("5.25"));
   v = e.parse ("a.a4([1])").execute ();
   EXPECT_EQ (v.to_string (), std::string ("1"));
   v = e.parse ("a.a4([1, 125e-3])").execute ();
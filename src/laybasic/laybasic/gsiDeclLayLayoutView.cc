@@ -338,6 +338,18 @@ static void save_image_with_options (lay::LayoutView *view, const std::string &f
   view->save_image_with_options (fn, width, height, linewidth, oversampling, resolution, QColor (), QColor (), QColor (), target_box, monochrome); 
 }
 
+#if defined(HAVE_QTBINDINGS)
+static std::vector<QImage> get_images_with_options (lay::LayoutView *view, unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, const std::vector<db::DBox> &target_boxes, bool monochrome, int threads)
+{
+  return view->get_images_with_options (target_boxes, width, height, linewidth, oversampling, resolution, QColor (), QColor (), QColor (), monochrome, threads);
+}
+#endif
+
+static void save_images_with_options (lay::LayoutView *view, const std::vector<std::string> &fns, unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, const std::vector<db::DBox> &target_boxes, bool monochrome, int threads)
+{
+  view->save_images_with_options (fns, target_boxes, width, height, linewidth, oversampling, resolution, QColor (), QColor (), QColor (), monochrome, threads);
+}
+
 static std::vector<std::string> 
 get_config_names (lay::LayoutView *view)
 {
@@ -1106,6 +1118,24 @@ Class<lay::LayoutView> decl_LayoutView (QT_EXTERNAL_BASE (QWidget) "lay", "Layou
     "\n"
     "This method has been introduced in 0.23.10.\n"
   ) +
+  gsi::method_ext ("get_images_with_options", &get_images_with_options, gsi::arg ("width"), gsi::arg ("height"), gsi::arg ("linewidth"), gsi::arg ("oversampling"), gsi::arg ("resolution"), gsi::arg ("targets"), gsi::arg ("monochrome"), gsi::arg ("threads", 0),
+    "@brief Gets layout images for multiple target boxes as \\QImage objects\n"
+    "\n"
+    "@param width The width of the images to render in pixel.\n"
+    "@param height The height of the images to render in pixel.\n"
+    "@param linewidth The width of a line in pixels (usually 1) or 0 for default.\n"
+    "@param oversampling The oversampling factor (1..3) or 0 for default.\n"
+    "@param resolution The resolution (pixel size compared to a screen pixel size, i.e 1/oversampling) or 0 for default.\n"
+    "@param targets The boxes to draw. An empty box stands for the current view.\n"
+    "@param monochrome If true, monochrome images will be produced.\n"
+    "@param threads The number of images drawn concurrently or 0 to use the number of drawing workers.\n"
+    "\n"
+    "This is the batch version of \\get_image_with_options. One image is returned per target box. "
+    "The layout drawing of multiple images happens in parallel which is much faster than rendering "
+    "the images one by one.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
 #endif
   gsi::method ("save_screenshot", &lay::LayoutView::save_screenshot, gsi::arg ("filename"),
     "@brief Saves a screenshot to the given file\n"
@@ -1147,6 +1177,26 @@ Class<lay::LayoutView> decl_LayoutView (QT_EXTERNAL_BASE (QWidget) "lay", "Layou
     "\n"
     "This method has been introduced in 0.23.10.\n"
   ) +
+  gsi::method_ext ("save_images_with_options", &save_images_with_options, gsi::arg ("filenames"), gsi::arg ("width"), gsi::arg ("height"), gsi::arg ("linewidth"), gsi::arg ("oversampling"), gsi::arg ("resolution"), gsi::arg ("targets"), gsi::arg ("monochrome"), gsi::arg ("threads", 0),
+    "@brief Saves layout images for multiple target boxes to the given files\n"
+    "\n"
+    "@param filenames The files to which to write the images to. There needs to be one file name per target box.\n"
+    "@param width The width of the images to render in pixel.\n"
+    "@param height The height of the images to render in pixel.\n"
+    "@param linewidth The width of a line in pixels (usually 1) or 0 for default.\n"
+    "@param oversampling The oversampling factor (1..3) or 0 for default.\n"
+    "@param resolution The resolution (pixel size compared to a screen pixel, i.e 1/oversampling) or 0 for default.\n"
+    "@param targets The boxes to draw. An empty box stands for the current view.\n"
+    "@param monochrome If true, monochrome images will be produced.\n"
+    "@param threads The number of images drawn concurrently or 0 to use the number of drawing workers.\n"
+    "\n"
+    "This is the batch version of \\save_image_with_options. It is intended for producing many snapshots "
+    "of the same layout, e.g. for review reports or marker thumbnails. The layout drawing of multiple images happens "
+    "in parallel. The images are written as PNG files. Rendering and writing happens in chunks of 'threads' images, so "
+    "only the images of one chunk are held in memory.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
   gsi::method_ext ("#save_as", &save_as2, gsi::arg ("index"), gsi::arg ("filename"), gsi::arg ("gzip"), gsi::arg ("options"),
     "@brief Saves a layout to the given stream file\n"
     "\n"
@@ -26,6 +26,10 @@
 #include "layFixedFont.h"
 #include "tlAlgorithm.h"
 
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
 namespace lay {
 
 Bitmap::Bitmap ()
@@ -349,6 +353,24 @@ static const uint32_t masks [32] = {
 
 static const uint32_t all_ones = 0xffffffff;
 
+//  Sets n words to all ones and returns the pointer behind the last word.
+//  NOTE: long spans are typical for dense layers at low zoom levels, so the bulk
+//  is written with 128 bit stores where available.
+static uint32_t *
+fill_words (uint32_t *sl, unsigned int n)
+{
+#if defined(__SSE2__)
+  const __m128i ones = _mm_set1_epi32 (-1);
+  for ( ; n >= 4; n -= 4, sl += 4) {
+    _mm_storeu_si128 ((__m128i *) sl, ones);
+  }
+#endif
+  for ( ; n > 0; --n) {
+    *sl++ = all_ones;
+  }
+  return sl;
+}
+
 void 
 Bitmap::fill (unsigned int y, unsigned int x1, unsigned int x2)
 {
@@ -365,10 +387,7 @@ Bitmap::fill (unsigned int y, unsigned int x1, unsigned int x2)
   } else if (b > 0) {
 
     *sl++ |= ~masks [x1 % 32];
-    while (b > 1) {
-      *sl++ |= all_ones;
-      b--;
-    }
+    sl = fill_words (sl, b - 1);
 
     unsigned int m = masks [x2 % 32];
     //  Hint: if x2==width and width%32==0, sl must not be accessed. This is guaranteed by
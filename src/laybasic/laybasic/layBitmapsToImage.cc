@@ -31,6 +31,12 @@
 #include <QMutex>
 #include <QImage>
 
+#include <algorithm>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
 namespace lay
 {
 
@@ -41,6 +47,17 @@ render_scanline_std (const uint32_t *dp, unsigned int ds, const lay::Bitmap *pbi
   const uint32_t *dm = dp;
 
   unsigned int x = w;
+
+#if defined(__SSE2__)
+  //  the common case is a dither pattern of 32 pixels width which repeats every word
+  if (ds == 1) {
+    const __m128i m = _mm_set1_epi32 (int (*dp));
+    for ( ; x >= 4 * lay::wordlen; x -= 4 * lay::wordlen, ps += 4, data += 4) {
+      _mm_storeu_si128 ((__m128i *) data, _mm_and_si128 (_mm_loadu_si128 ((const __m128i *) ps), m));
+    }
+  }
+#endif
+
   while (x >= lay::wordlen) {
     *data++ = *ps++ & *dm++;
     if (dm == dp + ds) {
@@ -54,6 +71,64 @@ render_scanline_std (const uint32_t *dp, unsigned int ds, const lay::Bitmap *pbi
   }
 }
 
+//  Combines one plane word into the pixel buffers of 32 pixels: for each bit set in d,
+//  the pixel k receives the "set" bits which are not masked by z [k] yet and the mask z [k]
+//  is reduced to the "keep" bits. "fill" is OR'ed into the pixels touched (the alpha value
+//  for transparent mode).
+//  NOTE: the SSE2 version expands the bits of d into lane masks and processes 4 pixels at once.
+static void
+composite_word (uint32_t d, lay::color_t set, lay::color_t keep, lay::color_t fill, lay::color_t *y, lay::color_t *z)
+{
+#if defined(__SSE2__)
+
+  const __m128i vd = _mm_set1_epi32 (int (d));
+  const __m128i vset = _mm_set1_epi32 (int (set));
+  const __m128i vkeep = _mm_set1_epi32 (int (keep));
+  const __m128i vfill = _mm_set1_epi32 (int (fill));
+  __m128i bits = _mm_set_epi32 (0x08, 0x04, 0x02, 0x01);
+
+  for (unsigned int k = 0; k < 32; k += 4, bits = _mm_slli_epi32 (bits, 4)) {
+    __m128i m = _mm_cmpeq_epi32 (_mm_and_si128 (vd, bits), bits);
+    __m128i vy = _mm_loadu_si128 ((const __m128i *) (y + k));
+    __m128i vz = _mm_loadu_si128 ((const __m128i *) (z + k));
+    vy = _mm_or_si128 (vy, _mm_and_si128 (m, _mm_or_si128 (_mm_and_si128 (vset, vz), vfill)));
+    vz = _mm_or_si128 (_mm_and_si128 (vz, vkeep), _mm_andnot_si128 (m, vz));
+    _mm_storeu_si128 ((__m128i *) (y + k), vy);
+    _mm_storeu_si128 ((__m128i *) (z + k), vz);
+  }
+
+#else
+
+  uint32_t m = 1;
+  for (unsigned int k = 0; k < 32; ++k, m <<= 1) {
+    if ((d & m) != 0) {
+      y [k] |= (set & z [k]) | fill;
+      z [k] &= keep;
+    }
+  }
+
+#endif
+}
+
+//  Transfers n pixels to the image: pt = (pt & z) | y
+static void
+transfer_pixels (lay::color_t *pt, const lay::color_t *y, const lay::color_t *z, unsigned int n)
+{
+  unsigned int k = 0;
+
+#if defined(__SSE2__)
+  for ( ; k + 4 <= n; k += 4) {
+    __m128i vp = _mm_loadu_si128 ((const __m128i *) (pt + k));
+    vp = _mm_or_si128 (_mm_and_si128 (vp, _mm_loadu_si128 ((const __m128i *) (z + k))), _mm_loadu_si128 ((const __m128i *) (y + k)));
+    _mm_storeu_si128 ((__m128i *) (pt + k), vp);
+  }
+#endif
+
+  for ( ; k < n; ++k) {
+    pt [k] = (pt [k] & z [k]) | y [k];
+  }
+}
+
 static void
 render_scanline_std_edge (const uint32_t *dp, unsigned int ds, const lay::Bitmap *pbitmap, unsigned int y, unsigned int w, unsigned int h, uint32_t *data)
 {
@@ -616,40 +691,22 @@ bitmaps_to_image_rgb (const std::vector<lay::ViewOp> &view_ops_in,
           lay::wordones, lay::wordones, lay::wordones, lay::wordones, 
         };
 
+        //  NOTE: pixels beyond the width are computed too, but not transferred
         dptr = dptr_end - nwords + i;
         for (int j = int (masks.size () - 1); j >= 0; --j) {
 
           uint32_t d = *dptr;
           if (d != 0) {
-
-            if (transparent) {
-              uint32_t m = 1;
-              for (unsigned int k = 0; k < 32 && x + k < width; ++k, m <<= 1) {
-                if ((d & m) != 0) {
-                  y [k] |= (masks [j].first & z [k]) | fill_bits;
-                  z [k] &= masks [j].second;
-                }
-              }
-            } else {
-              uint32_t m = 1;
-              for (unsigned int k = 0; k < 32 && x + k < width; ++k, m <<= 1) {
-                if ((d & m) != 0) {
-                  y [k] |= masks [j].first & z [k];
-                  z [k] &= masks [j].second;
-                }
-              }
-            }
-
+            composite_word (d, masks [j].first, masks [j].second, transparent ? fill_bits : 0, y, z);
           }
 
           dptr -= nwords;
 
         }
 
-        for (unsigned int k = 0; k < 32 && x + k < width; ++k) {
-          *pt = (*pt & z[k]) | y[k];
-          ++pt;
-        }
+        unsigned int n = std::min (width - x, (unsigned int) 32);
+        transfer_pixels (pt, y, z, n);
+        pt += n;
 
       }
 
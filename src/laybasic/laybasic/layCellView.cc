@@ -54,6 +54,7 @@ filename_for_caption (const std::string &fn)
 
 LayoutHandle::LayoutHandle (db::Layout *layout, const std::string &filename)
   : mp_layout (layout),
+    m_coverage_cache (layout),
     m_ref_count (0),
     m_filename (filename),
     m_dirty (false),
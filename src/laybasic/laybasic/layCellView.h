@@ -32,6 +32,7 @@
 #include "tlObject.h"
 #include "tlFileSystemWatcher.h"
 #include "layTechnology.h"
+#include "layCoverageCache.h"
 #include "dbLayout.h"
 #include "dbMetaInfo.h"
 #include "dbReader.h"
@@ -95,6 +96,16 @@ public:
    */
   db::Layout &layout () const;
 
+  /**
+   *  @brief Gets the cache for the coverage summaries of the layout
+   *
+   *  The summaries are used to draw cells which appear very small on the screen.
+   */
+  CoverageCache &coverage_cache ()
+  {
+    return m_coverage_cache;
+  }
+
   /**
    *  @brief Sets the file name associated with this handle
    */
@@ -297,6 +308,7 @@ public:
 
 private:
   db::Layout *mp_layout;
+  CoverageCache m_coverage_cache;
   int m_ref_count;
   std::string m_name;
   std::string m_filename;
@@ -0,0 +1,313 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "layCoverageCache.h"
+#include "dbBoxConvert.h"
+
+#include <limits>
+
+namespace lay
+{
+
+//  Arrays with more elements than this are represented by their bounding box.
+//  As the array is inside the cell's bounding box, this means there are
+//  several elements per tile on average.
+const size_t max_array_elements = 4 * CellCoverage::resolution * CellCoverage::resolution;
+
+// -------------------------------------------------------------
+//  CellCoverage implementation
+
+CellCoverage::CellCoverage ()
+  : m_weight (0)
+{
+  for (unsigned int i = 0; i < resolution; ++i) {
+    m_rows [i] = 0;
+  }
+}
+
+CellCoverage::CellCoverage (const db::Box &bbox)
+  : m_bbox (bbox), m_weight (0)
+{
+  for (unsigned int i = 0; i < resolution; ++i) {
+    m_rows [i] = 0;
+  }
+}
+
+void
+CellCoverage::add_weight (size_t w, size_t n)
+{
+  if (n > 0 && w > (std::numeric_limits<size_t>::max () - m_weight) / n) {
+    m_weight = std::numeric_limits<size_t>::max ();
+  } else {
+    m_weight += w * n;
+  }
+}
+
+bool
+CellCoverage::empty () const
+{
+  for (unsigned int i = 0; i < resolution; ++i) {
+    if (m_rows [i] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool
+CellCoverage::full () const
+{
+  for (unsigned int i = 0; i < resolution; ++i) {
+    if (m_rows [i] != ~row_type (0)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+unsigned int
+CellCoverage::x_index (db::Coord x) const
+{
+  int64_t w = m_bbox.width ();
+  if (w <= 0 || x <= m_bbox.left ()) {
+    return 0;
+  }
+  int64_t i = ((int64_t (x) - int64_t (m_bbox.left ())) * resolution) / w;
+  return i >= resolution ? resolution - 1 : (unsigned int) i;
+}
+
+unsigned int
+CellCoverage::y_index (db::Coord y) const
+{
+  int64_t h = m_bbox.height ();
+  if (h <= 0 || y <= m_bbox.bottom ()) {
+    return 0;
+  }
+  int64_t i = ((int64_t (y) - int64_t (m_bbox.bottom ())) * resolution) / h;
+  return i >= resolution ? resolution - 1 : (unsigned int) i;
+}
+
+db::Coord
+CellCoverage::x_coord (unsigned int i) const
+{
+  return db::Coord (int64_t (m_bbox.left ()) + (int64_t (m_bbox.width ()) * i) / resolution);
+}
+
+db::Coord
+CellCoverage::y_coord (unsigned int i) const
+{
+  return db::Coord (int64_t (m_bbox.bottom ()) + (int64_t (m_bbox.height ()) * i) / resolution);
+}
+
+db::Box
+CellCoverage::tile (unsigned int x, unsigned int y) const
+{
+  return db::Box (x_coord (x), y_coord (y), x_coord (x + 1), y_coord (y + 1));
+}
+
+void
+CellCoverage::add (const db::Box &box)
+{
+  if (m_bbox.empty () || box.empty () || ! box.touches (m_bbox)) {
+    return;
+  }
+
+  unsigned int x1 = x_index (box.left ()), x2 = x_index (box.right ());
+  unsigned int y1 = y_index (box.bottom ()), y2 = y_index (box.top ());
+
+  row_type mask = (x2 + 1 >= resolution ? ~row_type (0) : ((row_type (1) << (x2 + 1)) - 1)) & ~((row_type (1) << x1) - 1);
+  for (unsigned int y = y1; y <= y2; ++y) {
+    m_rows [y] |= mask;
+  }
+}
+
+void
+CellCoverage::get_boxes (std::vector<db::Box> &boxes) const
+{
+  unsigned int y = 0;
+  while (y < resolution) {
+
+    //  rows with identical content are combined
+    unsigned int y1 = y;
+    row_type r = m_rows [y];
+    while (y < resolution && m_rows [y] == r) {
+      ++y;
+    }
+
+    unsigned int x = 0;
+    while (r != 0 && x < resolution) {
+
+      while (x < resolution && (r & (row_type (1) << x)) == 0) {
+        ++x;
+      }
+
+      unsigned int x1 = x;
+      while (x < resolution && (r & (row_type (1) << x)) != 0) {
+        r &= ~(row_type (1) << x);
+        ++x;
+      }
+
+      if (x > x1) {
+        boxes.push_back (db::Box (x_coord (x1), y_coord (y1), x_coord (x), y_coord (y)));
+      }
+
+    }
+
+  }
+}
+
+// -------------------------------------------------------------
+//  CoverageCache implementation
+
+CoverageCache::CoverageCache (const db::Layout *layout)
+  : mp_layout (layout), m_generation (0)
+{
+  if (mp_layout) {
+    const_cast<db::Layout *> (mp_layout)->hier_changed_event.add (this, &CoverageCache::clear);
+    const_cast<db::Layout *> (mp_layout)->bboxes_changed_event.add (this, &CoverageCache::bboxes_changed);
+  }
+}
+
+void
+CoverageCache::clear ()
+{
+  tl::MutexLocker locker (&m_lock);
+  m_cache.clear ();
+  ++m_generation;
+}
+
+void
+CoverageCache::bboxes_changed (unsigned int layer)
+{
+  if (layer == std::numeric_limits<unsigned int>::max ()) {
+    clear ();
+    return;
+  }
+
+  tl::MutexLocker locker (&m_lock);
+  m_cache.erase (m_cache.lower_bound (CacheKey (0, layer, std::numeric_limits<int>::min ())), m_cache.lower_bound (CacheKey (0, layer + 1, std::numeric_limits<int>::min ())));
+  ++m_generation;
+}
+
+size_t
+CoverageCache::size () const
+{
+  tl::MutexLocker locker (&m_lock);
+  return m_cache.size ();
+}
+
+CellCoverage
+CoverageCache::coverage (db::cell_index_type ci, unsigned int layer, int levels)
+{
+  CacheKey key (ci, layer, levels);
+  size_t generation = 0;
+
+  {
+    tl::MutexLocker locker (&m_lock);
+    cache_t::const_iterator c = m_cache.find (key);
+    if (c != m_cache.end ()) {
+      return c->second;
+    }
+    generation = m_generation;
+  }
+
+  //  NOTE: the summary is computed without holding the lock, so other threads can
+  //  use the cache meanwhile. If the cache got invalidated in between, the result
+  //  is not stored.
+  CellCoverage cov = compute (ci, layer, levels);
+
+  {
+    tl::MutexLocker locker (&m_lock);
+    if (generation == m_generation) {
+      m_cache.insert (std::make_pair (key, cov));
+    }
+  }
+
+  return cov;
+}
+
+CellCoverage
+CoverageCache::compute (db::cell_index_type ci, unsigned int layer, int levels)
+{
+  const db::Cell &cell = mp_layout->cell (ci);
+
+  CellCoverage cov (cell.bbox (layer));
+  if (levels <= 0 || cov.bbox ().empty ()) {
+    return cov;
+  }
+
+  size_t n = 0;
+  for (db::ShapeIterator s = cell.shapes (layer).begin (db::ShapeIterator::Polygons | db::ShapeIterator::Edges | db::ShapeIterator::Paths | db::ShapeIterator::Boxes); ! s.at_end (); ++s) {
+    ++n;
+    if (! cov.full ()) {
+      cov.add (s->bbox ());
+    }
+  }
+  cov.add_weight (n);
+
+  if (levels > 1) {
+
+    db::box_convert<db::CellInst> bc (*mp_layout, layer);
+
+    for (db::Cell::const_iterator i = cell.begin (); ! i.at_end (); ++i) {
+
+      const db::CellInstArray &cia = i->cell_inst ();
+      db::cell_index_type cci = cia.object ().cell_index ();
+      if (mp_layout->cell (cci).bbox (layer).empty ()) {
+        continue;
+      }
+
+      CellCoverage child = coverage (cci, layer, levels - 1);
+
+      size_t na = cia.size ();
+      cov.add_weight (child.weight (), na);
+
+      if (cov.full ()) {
+        continue;
+      }
+
+      if (na > max_array_elements) {
+        cov.add (cia.bbox (bc));
+      } else {
+
+        std::vector<db::Box> boxes;
+        child.get_boxes (boxes);
+
+        for (db::CellInstArray::iterator a = cia.begin (); ! a.at_end () && ! cov.full (); ++a) {
+          db::ICplxTrans t = cia.complex_trans (*a);
+          for (std::vector<db::Box>::const_iterator b = boxes.begin (); b != boxes.end (); ++b) {
+            cov.add (b->transformed (t));
+          }
+        }
+
+      }
+
+    }
+
+  }
+
+  return cov;
+}
+
+}
+
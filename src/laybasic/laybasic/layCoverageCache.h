@@ -0,0 +1,213 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+
+#ifndef HDR_layCoverageCache
+#define HDR_layCoverageCache
+
+#include "laybasicCommon.h"
+
+#include "dbLayout.h"
+#include "tlObject.h"
+#include "tlThreads.h"
+
+#include <map>
+#include <vector>
+
+namespace lay {
+
+/**
+ *  @brief A low-resolution coverage summary of a cell on a layer
+ *
+ *  The summary divides the bounding box of the cell on the layer into a grid of
+ *  resolution x resolution tiles. A tile is marked if any shape (including the
+ *  shapes of the child cells) touches it. The summary is conservative - i.e. it
+ *  may mark tiles which are not touched, but never misses a shape.
+ *
+ *  The "weight" is the number of shapes represented by the summary. The drawing
+ *  code uses the summary instead of the shapes when the cell is drawn so small
+ *  that a tile is not larger than a pixel and the weight is larger than the
+ *  number of boxes required to render the summary.
+ */
+class LAYBASIC_PUBLIC CellCoverage
+{
+public:
+  enum { resolution = 32 };
+
+  /**
+   *  @brief Creates an empty summary
+   */
+  CellCoverage ();
+
+  /**
+   *  @brief Creates an empty summary for the given bounding box
+   */
+  CellCoverage (const db::Box &bbox);
+
+  /**
+   *  @brief Gets the bounding box the grid is laid over
+   */
+  const db::Box &bbox () const
+  {
+    return m_bbox;
+  }
+
+  /**
+   *  @brief Gets the number of shapes represented by this summary
+   */
+  size_t weight () const
+  {
+    return m_weight;
+  }
+
+  /**
+   *  @brief Adds n times the given weight
+   *
+   *  The weight saturates at the maximum value of size_t.
+   */
+  void add_weight (size_t w, size_t n = 1);
+
+  /**
+   *  @brief Gets a value indicating whether the given tile is marked
+   */
+  bool is_set (unsigned int x, unsigned int y) const
+  {
+    return (m_rows [y] & (row_type (1) << x)) != 0;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether no tile is marked
+   */
+  bool empty () const;
+
+  /**
+   *  @brief Gets a value indicating whether all tiles are marked
+   */
+  bool full () const;
+
+  /**
+   *  @brief Marks all tiles touched by the given box
+   */
+  void add (const db::Box &box);
+
+  /**
+   *  @brief Gets the box of the given tile
+   */
+  db::Box tile (unsigned int x, unsigned int y) const;
+
+  /**
+   *  @brief Produces the boxes representing the marked tiles
+   *
+   *  Horizontal runs of marked tiles are combined into one box.
+   */
+  void get_boxes (std::vector<db::Box> &boxes) const;
+
+private:
+  typedef uint32_t row_type;
+
+  db::Box m_bbox;
+  size_t m_weight;
+  row_type m_rows [resolution];
+
+  unsigned int x_index (db::Coord x) const;
+  unsigned int y_index (db::Coord y) const;
+  db::Coord x_coord (unsigned int i) const;
+  db::Coord y_coord (unsigned int i) const;
+};
+
+/**
+ *  @brief A cache for cell coverage summaries of a layout
+ *
+ *  Summaries are built on request and kept until the layout changes. Changes of
+ *  the bounding boxes on a layer invalidate the summaries for that layer, hierarchy
+ *  changes invalidate all summaries.
+ *
+ *  The cache can be used by multiple drawing threads at the same time.
+ */
+class LAYBASIC_PUBLIC CoverageCache
+  : public tl::Object
+{
+public:
+  /**
+   *  @brief Creates a cache for the given layout
+   */
+  CoverageCache (const db::Layout *layout);
+
+  /**
+   *  @brief Gets the coverage summary for the given cell and layer
+   *
+   *  @param levels The number of hierarchy levels to include (1: the cell only)
+   */
+  CellCoverage coverage (db::cell_index_type ci, unsigned int layer, int levels);
+
+  /**
+   *  @brief Clears the cache
+   */
+  void clear ();
+
+  /**
+   *  @brief Gets the number of cached summaries
+   */
+  size_t size () const;
+
+private:
+  struct CacheKey
+  {
+    CacheKey (db::cell_index_type _ci, unsigned int _layer, int _levels)
+      : ci (_ci), layer (_layer), levels (_levels)
+    { }
+
+    bool operator< (const CacheKey &other) const
+    {
+      if (layer != other.layer) {
+        return layer < other.layer;
+      }
+      if (ci != other.ci) {
+        return ci < other.ci;
+      }
+      return levels < other.levels;
+    }
+
+    db::cell_index_type ci;
+    unsigned int layer;
+    int levels;
+  };
+
+  typedef std::map<CacheKey, CellCoverage> cache_t;
+
+  const db::Layout *mp_layout;
+  cache_t m_cache;
+  size_t m_generation;
+  mutable tl::Mutex m_lock;
+
+  CoverageCache (const CoverageCache &);
+  CoverageCache &operator= (const CoverageCache &);
+
+  CellCoverage compute (db::cell_index_type ci, unsigned int layer, int levels);
+  void bboxes_changed (unsigned int layer);
+};
+
+}
+
+#endif
+
@@ -41,6 +41,7 @@
 #include "layBitmapsToImage.h"
 
 #include <sstream>
+#include <cmath>
 #include <algorithm>
 
 namespace lay
@@ -277,7 +278,7 @@ invert (unsigned char *data, unsigned int width, unsigned int height)
 LayoutCanvas::LayoutCanvas (QWidget *parent, lay::LayoutView *view, const char *name)
   : lay::ViewObjectWidget (parent, name), 
     mp_view (view),
-    mp_image (0), mp_image_bg (0), mp_pixmap (0), 
+    mp_image (0), mp_image_bg (0), mp_image_preview (0), mp_pixmap (0), 
     m_background (0), m_foreground (0), m_active (0),
     m_oversampling (1),
     m_dpr (1),
@@ -287,7 +288,8 @@ LayoutCanvas::LayoutCanvas (QWidget *parent, lay::LayoutView *view, const char *
     m_update_image (true),
     m_do_update_image_dm (this, &LayoutCanvas::do_update_image),
     m_do_end_of_drawing_dm (this, &LayoutCanvas::do_end_of_drawing),
-    m_image_cache_size (1)
+    m_image_cache_size (1),
+    m_preview_pending (false)
 {
 #if QT_VERSION > 0x050000
   m_dpr = devicePixelRatio ();
@@ -322,6 +324,10 @@ LayoutCanvas::~LayoutCanvas ()
     delete mp_image_bg;
     mp_image_bg = 0;
   }
+  if (mp_image_preview) {
+    delete mp_image_preview;
+    mp_image_preview = 0;
+  }
   if (mp_pixmap) {
     delete mp_pixmap;
     mp_pixmap = 0;
@@ -373,6 +379,7 @@ LayoutCanvas::set_oversampling (unsigned int os)
     m_image_cache.clear ();
     m_oversampling = os;
     m_viewport_l.set_size (m_viewport.width () * m_oversampling, m_viewport.height () * m_oversampling);
+    update_preview_settings ();
     do_redraw_all ();
   }
 }
@@ -390,6 +397,7 @@ LayoutCanvas::set_colors (QColor background, QColor foreground, QColor active)
   }
   mp_image_bg = 0;
 
+  update_preview_settings ();
   update_image ();
 }
 
@@ -398,6 +406,7 @@ LayoutCanvas::set_view_ops (std::vector <lay::ViewOp> &view_ops)
 {
   if (view_ops != m_view_ops) {
     m_view_ops.swap (view_ops);
+    update_preview_settings ();
     update_image ();
   }
 }
@@ -407,6 +416,7 @@ LayoutCanvas::set_dither_pattern (const lay::DitherPattern &p)
 {
   if (p != m_dither_pattern) {
     m_dither_pattern = p;
+    update_preview_settings ();
     update_image ();
   }
 }
@@ -416,6 +426,7 @@ LayoutCanvas::set_line_styles (const lay::LineStyles &s)
 {
   if (s != m_line_styles) {
     m_line_styles = s;
+    update_preview_settings ();
     update_image ();
   }
 }
@@ -445,6 +456,9 @@ LayoutCanvas::prepare_drawing ()
 
     mp_image->fill (m_background);
 
+    clear_preview ();
+    m_preview_pending = false;
+
     //  Cancel any pending "finish" event so there is no race between finish and restart (important for caching)
     m_do_end_of_drawing_dm.cancel (); 
 
@@ -470,9 +484,16 @@ LayoutCanvas::prepare_drawing ()
         tl::info << "Restored image from cache";
       }
       restore_data (c->data ());
+      m_preview_pending = true;
 
     } else {
 
+      //  while drawing, show what we have from a previous pan or zoom state
+      //  (before the old entries are retired)
+      if (m_redraw_clearing) {
+        prepare_preview ();
+      }
+
       bool precious = m_viewport_l.target_box ().equal (m_precious_box); 
 
       //  discard all open cache entries and reset all previously precious ones
@@ -533,6 +554,61 @@ LayoutCanvas::prepare_drawing ()
   }
 }
 
+void
+LayoutCanvas::prepare_preview ()
+{
+  db::DCplxTrans t;
+  const QImage *image = m_preview_cache.find (m_viewport_l, m_layers, t);
+  if (! image) {
+    return;
+  }
+
+  mp_image_preview = new QImage (m_viewport_l.width (), m_viewport_l.height (), QImage::Format_ARGB32);
+  mp_image_preview->fill (0);
+#if QT_VERSION > 0x050000
+  mp_image_preview->setDevicePixelRatio (double (m_dpr));
+#endif
+
+  //  NOTE: the painter works in device independent coordinates
+  db::DBox box = db::DCplxTrans (1.0 / double (m_dpr)) * t * db::DBox (0.0, 0.0, double (image->width ()), double (image->height ()));
+
+  QPainter painter (mp_image_preview);
+  painter.setRenderHint (QPainter::SmoothPixmapTransform, false);
+  painter.drawImage (QRectF (box.left (), box.bottom (), box.width (), box.height ()), *image);
+
+  if (tl::verbosity () >= 20) {
+    tl::info << "Using cached image as preview while drawing";
+  }
+}
+
+void
+LayoutCanvas::clear_preview ()
+{
+  if (mp_image_preview) {
+    delete mp_image_preview;
+    mp_image_preview = 0;
+  }
+}
+
+void
+LayoutCanvas::update_preview_settings ()
+{
+  lay::PreviewImageSettings settings;
+  settings.background = m_background;
+  settings.foreground = m_foreground;
+  settings.active = m_active;
+  settings.oversampling = m_oversampling;
+  settings.view_ops = m_view_ops;
+  settings.dither_pattern = m_dither_pattern;
+  settings.line_styles = m_line_styles;
+
+  if (settings != m_preview_cache.settings ()) {
+    //  the images kept were drawn with other settings - the current one needs to be taken again
+    m_preview_cache.set_settings (settings);
+    m_preview_pending = ! mp_redraw_thread->is_running () && ! m_need_redraw;
+  }
+}
+
 void
 LayoutCanvas::update_image ()
 {
@@ -583,9 +659,26 @@ LayoutCanvas::paintEvent (QPaintEvent *)
         *mp_image = *mp_image_bg;
       }
 
+      //  while drawing, the preview shows the previous state under the new shapes
+      if (mp_image_preview) {
+        QPainter painter (mp_image);
+        painter.drawImage (QPoint (0, 0), *mp_image_preview);
+      }
+
       //  render the main bitmaps
       to_image (m_view_ops, dither_pattern (), line_styles (), background_color (), foreground_color (), active_color (), this, *mp_image, m_viewport_l.width (), m_viewport_l.height ());
 
+      //  keep the final layer image so it can serve as a preview later. The image is rendered
+      //  without the background objects (e.g. grid) and without the background color - the
+      //  preview is drawn over the current background later.
+      if (m_preview_pending && ! mp_redraw_thread->is_running ()) {
+        QImage layer_image (m_viewport_l.width (), m_viewport_l.height (), QImage::Format_ARGB32);
+        layer_image.fill (0);
+        to_image (m_view_ops, dither_pattern (), line_styles (), background_color (), foreground_color (), active_color (), this, layer_image, m_viewport_l.width (), m_viewport_l.height ());
+        m_preview_cache.insert (m_viewport_l, m_layers, layer_image);
+        m_preview_pending = false;
+      }
+
       if (mp_pixmap) {
         delete mp_pixmap;
         mp_pixmap = 0;
@@ -778,6 +871,88 @@ LayoutCanvas::image (unsigned int width, unsigned int height)
 
 QImage 
 LayoutCanvas::image_with_options (unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, QColor background, QColor foreground, QColor active, const db::DBox &target_box, bool is_mono) 
+{
+  normalize_image_options (linewidth, oversampling, resolution, background, foreground, active);
+
+  lay::Viewport vp = image_viewport (width, height, oversampling, target_box);
+
+  //  render the layout
+  BitmapRedrawThreadCanvas rd_canvas;
+  lay::RedrawThread redraw_thread (&rd_canvas, mp_view);
+
+  redraw_thread.start (0 /*synchroneous*/, m_layers, vp, resolution, true);
+  redraw_thread.stop (); // safety
+
+  return finish_image (rd_canvas, vp, width, height, linewidth, oversampling, resolution, background, foreground, active, is_mono);
+}
+
+std::vector<QImage>
+LayoutCanvas::images_with_options (const std::vector<db::DBox> &target_boxes, unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, QColor background, QColor foreground, QColor active, bool is_mono, int threads)
+{
+  normalize_image_options (linewidth, oversampling, resolution, background, foreground, active);
+
+  if (threads <= 0) {
+    threads = std::max (1, mp_view->drawing_workers ());
+  }
+
+  std::vector<QImage> images;
+  images.reserve (target_boxes.size ());
+
+  //  The layout drawing happens for chunks of "threads" images concurrently. Each image gets
+  //  a redraw thread with a single worker. The layouts are only read while drawing.
+  //  Background and foreground objects are rendered in the main thread afterwards.
+
+  for (size_t i0 = 0; i0 < target_boxes.size (); i0 += size_t (threads)) {
+
+    size_t n = std::min (target_boxes.size () - i0, size_t (threads));
+
+    std::vector<lay::Viewport> viewports;
+    std::vector<BitmapRedrawThreadCanvas *> rd_canvases;
+    std::vector<lay::RedrawThread *> redraw_threads;
+
+    try {
+
+      for (size_t i = 0; i < n; ++i) {
+        viewports.push_back (image_viewport (width, height, oversampling, target_boxes [i0 + i]));
+        rd_canvases.push_back (new BitmapRedrawThreadCanvas ());
+        redraw_threads.push_back (new lay::RedrawThread (rd_canvases.back (), mp_view));
+        redraw_threads.back ()->start (1, m_layers, viewports.back (), resolution, true);
+      }
+
+      for (size_t i = 0; i < n; ++i) {
+        redraw_threads [i]->wait ();
+        redraw_threads [i]->stop (); // safety
+      }
+
+      for (size_t i = 0; i < n; ++i) {
+        images.push_back (finish_image (*rd_canvases [i], viewports [i], width, height, linewidth, oversampling, resolution, background, foreground, active, is_mono));
+      }
+
+    } catch (...) {
+      for (size_t i = 0; i < redraw_threads.size (); ++i) {
+        delete redraw_threads [i];
+      }
+      for (size_t i = 0; i < rd_canvases.size (); ++i) {
+        delete rd_canvases [i];
+      }
+      throw;
+    }
+
+    //  the redraw threads refer to the canvases, so they need to go first
+    for (size_t i = 0; i < redraw_threads.size (); ++i) {
+      delete redraw_threads [i];
+    }
+    for (size_t i = 0; i < rd_canvases.size (); ++i) {
+      delete rd_canvases [i];
+    }
+
+  }
+
+  return images;
+}
+
+void
+LayoutCanvas::normalize_image_options (int &linewidth, int &oversampling, double &resolution, QColor &background, QColor &foreground, QColor &active) const
 {
   if (oversampling <= 0) {
     oversampling = m_oversampling;
@@ -797,7 +972,24 @@ LayoutCanvas::image_with_options (unsigned int width, unsigned int height, int l
   if (active == QColor ()) {
     active = active_color ();
   }
+}
+
+lay::Viewport
+LayoutCanvas::image_viewport (unsigned int width, unsigned int height, int oversampling, const db::DBox &target_box) const
+{
+  //  compute the new viewport 
+  db::DBox tb (target_box);
+  if (tb.empty ()) {
+    tb = m_viewport.target_box ();
+  }
+  Viewport vp (width * oversampling, height * oversampling, tb);
+  vp.set_global_trans (m_viewport.global_trans ());
+  return vp;
+}
 
+QImage
+LayoutCanvas::finish_image (lay::BitmapRedrawThreadCanvas &rd_canvas, const lay::Viewport &vp, unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, QColor background, QColor foreground, QColor active, bool is_mono)
+{
   //  TODO: for other architectures MonoLSB may not be the right format
   QImage img (width, height, is_mono ? QImage::Format_MonoLSB : QImage::Format_RGB32);
 
@@ -813,18 +1005,9 @@ LayoutCanvas::image_with_options (unsigned int width, unsigned int height, int l
     img.fill (background.rgb ());
   }
 
-  //  provide canvas objects for the layout bitmaps and the foreground/background objects
-  BitmapRedrawThreadCanvas rd_canvas;
+  //  provide a canvas object for the foreground/background objects
   DetachedViewObjectCanvas vo_canvas (background, foreground, active, width * oversampling, height * oversampling, resolution, &img);
 
-  //  compute the new viewport 
-  db::DBox tb (target_box);
-  if (tb.empty ()) {
-    tb = m_viewport.target_box ();
-  }
-  Viewport vp (width * oversampling, height * oversampling, tb);
-  vp.set_global_trans (m_viewport.global_trans ());
-
   std::vector<lay::ViewOp> view_ops (m_view_ops); 
   if (linewidth > 1) {
     for (std::vector<lay::ViewOp>::iterator vo = view_ops.begin (); vo != view_ops.end (); ++vo) {
@@ -832,12 +1015,6 @@ LayoutCanvas::image_with_options (unsigned int width, unsigned int height, int l
     }
   }
 
-  lay::RedrawThread redraw_thread (&rd_canvas, mp_view);
-
-  //  render the layout
-  redraw_thread.start (0 /*synchroneous*/, m_layers, vp, resolution, true);
-  redraw_thread.stop (); // safety
-
   //  paint the background objects. It uses "img" to paint on.
   if (! is_mono) {
 
@@ -970,6 +1147,12 @@ LayoutCanvas::do_end_of_drawing ()
     } 
   }
 
+  //  the drawing is complete - the preview is no longer required and the final image
+  //  is taken into the preview cache on the next update
+  clear_preview ();
+  m_preview_pending = true;
+  update_image ();
+
   set_default_cursor (lay::Cursor::none);
 }
 
@@ -1029,6 +1212,7 @@ void
 LayoutCanvas::redraw_new (std::vector<lay::RedrawLayerInfo> &layers)
 {
   m_image_cache.clear ();
+  m_preview_cache.clear ();
   m_layers.swap (layers);
   do_redraw_all (true);
 }
@@ -1039,6 +1223,7 @@ LayoutCanvas::redraw_selected (const std::vector<int> &layers)
   stop_redraw ();
 
   m_image_cache.clear ();
+  m_preview_cache.clear ();
 
   if (! m_need_redraw) {
     m_redraw_clearing = false;
@@ -1084,6 +1269,7 @@ LayoutCanvas::stop_redraw ()
     }
   }
 
+  m_preview_pending = false;
   mp_redraw_thread->stop ();
 }
 
@@ -30,6 +30,7 @@
 #include <utility>
 
 #include <QMutex>
+#include <QImage>
 
 #include "dbTrans.h"
 #include "dbBox.h"
@@ -42,6 +43,7 @@
 #include "layLineStyles.h"
 #include "layRedrawThreadCanvas.h"
 #include "layRedrawLayerInfo.h"
+#include "layPreviewImageCache.h"
 #include "tlDeferredExecution.h"
 
 namespace lay
@@ -169,6 +171,15 @@ public:
   QImage image (unsigned int width, unsigned int height);
   QImage image_with_options (unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, QColor background, QColor foreground, QColor active_color, const db::DBox &target_box, bool monochrome);
 
+  /**
+   *  @brief Renders images for multiple target boxes
+   *
+   *  The images are rendered like "image_with_options" does, but the layout drawing of up to
+   *  "threads" images is done concurrently. If "threads" is 0 or less, the number of drawing
+   *  workers of the view is used.
+   */
+  std::vector<QImage> images_with_options (const std::vector<db::DBox> &target_boxes, unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, QColor background, QColor foreground, QColor active_color, bool monochrome, int threads);
+
   void update_image ();
 
   virtual void paintEvent (QPaintEvent *);
@@ -357,6 +368,7 @@ private:
   lay::LayoutView *mp_view;
   QImage *mp_image;
   QImage *mp_image_bg;
+  QImage *mp_image_preview;
   QPixmap *mp_pixmap;
   db::DBox m_precious_box;
   lay::Viewport m_viewport, m_viewport_l;
@@ -383,6 +395,8 @@ private:
 
   std::vector<ImageCacheEntry> m_image_cache;
   size_t m_image_cache_size;
+  lay::PreviewImageCache m_preview_cache;
+  bool m_preview_pending;
 
   QMutex m_mutex;
 
@@ -401,6 +415,12 @@ private:
   void do_redraw_all (bool force_redraw = true);
 
   void prepare_drawing ();
+  void normalize_image_options (int &linewidth, int &oversampling, double &resolution, QColor &background, QColor &foreground, QColor &active) const;
+  lay::Viewport image_viewport (unsigned int width, unsigned int height, int oversampling, const db::DBox &target_box) const;
+  QImage finish_image (lay::BitmapRedrawThreadCanvas &rd_canvas, const lay::Viewport &vp, unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, QColor background, QColor foreground, QColor active, bool is_mono);
+  void prepare_preview ();
+  void clear_preview ();
+  void update_preview_settings ();
 };
 
 } //  namespace lay
@@ -2925,6 +2925,18 @@ LayoutView::get_image_with_options (unsigned int width, unsigned int height, int
   return mp_canvas->image_with_options (width, height, linewidth, oversampling, resolution, background, foreground, active, target_box, monochrome);
 }
 
+std::vector<QImage>
+LayoutView::get_images_with_options (const std::vector<db::DBox> &target_boxes, unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution,
+                                     QColor background, QColor foreground, QColor active, bool monochrome, int threads)
+{
+  tl::SelfTimer timer (tl::verbosity () >= 11, tl::to_string (QObject::tr ("Save images")));
+
+  //  Execute all deferred methods - ensure there are no pending tasks
+  tl::DeferredMethodScheduler::execute ();
+
+  return mp_canvas->images_with_options (target_boxes, width, height, linewidth, oversampling, resolution, background, foreground, active, monochrome, threads);
+}
+
 void 
 LayoutView::save_image (const std::string &fn, unsigned int width, unsigned int height)
 {
@@ -2987,6 +2999,68 @@ LayoutView::save_image_with_options (const std::string &fn,
   tl::log << "Saved screen shot to " << fn;
 }
 
+void
+LayoutView::save_images_with_options (const std::vector<std::string> &fns, const std::vector<db::DBox> &target_boxes,
+                                      unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution,
+                                      QColor background, QColor foreground, QColor active, bool monochrome, int threads)
+{
+  if (fns.size () != target_boxes.size ()) {
+    throw tl::Exception (tl::to_string (QObject::tr ("The number of file names (%d) does not match the number of target boxes (%d)")), int (fns.size ()), int (target_boxes.size ()));
+  }
+
+  tl::SelfTimer timer (tl::verbosity () >= 11, tl::to_string (QObject::tr ("Save images")));
+
+  //  Execute all deferred methods - ensure there are no pending tasks
+  tl::DeferredMethodScheduler::execute ();
+
+  if (threads <= 0) {
+    threads = std::max (1, drawing_workers ());
+  }
+
+  //  Render and write the images in chunks of "threads" images, so only the images
+  //  of one chunk are kept in memory
+
+  for (size_t i0 = 0; i0 < fns.size (); i0 += size_t (threads)) {
+
+    size_t n = std::min (fns.size () - i0, size_t (threads));
+
+    std::vector<db::DBox> chunk_boxes (target_boxes.begin () + i0, target_boxes.begin () + (i0 + n));
+    std::vector<QImage> images = mp_canvas->images_with_options (chunk_boxes, width, height, linewidth, oversampling, resolution, background, foreground, active, monochrome, threads);
+
+    for (size_t i = 0; i < n; ++i) {
+
+      const std::string &fn = fns [i0 + i];
+
+      QImageWriter writer (tl::to_qstring (fn), QByteArray ("PNG"));
+
+      //  Unfortunately the PNG writer does not allow writing of long strings.
+      //  We separate the description into a set of keys:
+
+      for (unsigned int j = 0; j < cellviews (); ++j) {
+        if (cellview (j).is_valid ()) {
+          std::string name = cellview (j)->layout ().cell_name (cellview (j).cell_index ());
+          writer.setText (tl::to_qstring ("Cell" + tl::to_string (int (j) + 1)), tl::to_qstring (name));
+        }
+      }
+
+      db::DBox tb (chunk_boxes [i]);
+      if (tb.empty ()) {
+        tb = mp_canvas->viewport ().target_box ();
+      }
+      lay::Viewport vp (width, height, tb);
+      writer.setText (QString::fromUtf8 ("Rect"), tl::to_qstring (vp.box ().to_string ()));
+
+      if (! writer.write (images [i])) {
+        throw tl::Exception (tl::to_string (QObject::tr ("Unable to write screenshot to file: %s (%s)")), fn, tl::to_string (writer.errorString ()));
+      }
+
+      tl::log << "Saved screen shot to " << fn;
+
+    }
+
+  }
+}
+
 void
 LayoutView::reload_layout (unsigned int cv_index)
 {
@@ -900,6 +900,25 @@ public:
    */
   QImage get_image_with_options (unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, QColor background, QColor foreground, QColor active_color, const db::DBox &target_box, bool monochrome);
 
+  /**
+   *  @brief Gets images for multiple target boxes
+   *
+   *  This method renders one image per target box with the options as explained for
+   *  "get_image_with_options". The layout drawing of up to "threads" images is done
+   *  concurrently. If "threads" is 0 or less, the number of drawing workers is used.
+   */
+  std::vector<QImage> get_images_with_options (const std::vector<db::DBox> &target_boxes, unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, QColor background, QColor foreground, QColor active_color, bool monochrome, int threads);
+
+  /**
+   *  @brief Saves images for multiple target boxes
+   *
+   *  This is the batch version of "save_image_with_options". One PNG file is written for each
+   *  target box. "fns" and "target_boxes" need to have the same length.
+   *  The images are rendered and written in chunks of "threads" images, so only one chunk
+   *  of images is held in memory.
+   */
+  void save_images_with_options (const std::vector<std::string> &fns, const std::vector<db::DBox> &target_boxes, unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, QColor background, QColor foreground, QColor active_color, bool monochrome, int threads);
+
   /**
    *  @brief Hierarchy level selection setter
    */
@@ -0,0 +1,189 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "layPreviewImageCache.h"
+#include "dbBox.h"
+
+#include <cmath>
+
+namespace lay
+{
+
+// ----------------------------------------------------------------------------
+//  PreviewImageSettings implementation
+
+PreviewImageSettings::PreviewImageSettings ()
+  : background (0), foreground (0), active (0), oversampling (1)
+{
+  //  .. nothing yet ..
+}
+
+bool
+PreviewImageSettings::operator== (const PreviewImageSettings &other) const
+{
+  return background == other.background &&
+         foreground == other.foreground &&
+         active == other.active &&
+         oversampling == other.oversampling &&
+         view_ops == other.view_ops &&
+         dither_pattern == other.dither_pattern &&
+         line_styles == other.line_styles;
+}
+
+// ----------------------------------------------------------------------------
+//  PreviewImageCache implementation
+
+/**
+ *  @brief Returns a value indicating whether two layer lists render the same image
+ */
+static bool
+same_layers (const std::vector<lay::RedrawLayerInfo> &a, const std::vector<lay::RedrawLayerInfo> &b)
+{
+  if (a.size () != b.size ()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < a.size (); ++i) {
+
+    const lay::RedrawLayerInfo &la = a [i];
+    const lay::RedrawLayerInfo &lb = b [i];
+
+    if (la.visible != lb.visible ||
+        la.cell_frame != lb.cell_frame ||
+        la.xfill != lb.xfill ||
+        la.layer_index != lb.layer_index ||
+        la.cellview_index != lb.cellview_index ||
+        la.hier_levels != lb.hier_levels ||
+        la.prop_sel != lb.prop_sel ||
+        la.inverse_prop_sel != lb.inverse_prop_sel ||
+        la.trans.size () != lb.trans.size ()) {
+      return false;
+    }
+
+    for (size_t j = 0; j < la.trans.size (); ++j) {
+      if (! la.trans [j].equal (lb.trans [j])) {
+        return false;
+      }
+    }
+
+  }
+
+  return true;
+}
+
+PreviewImageCache::PreviewImageCache (size_t max_entries)
+  : m_max_entries (max_entries)
+{
+  //  .. nothing yet ..
+}
+
+void
+PreviewImageCache::set_settings (const PreviewImageSettings &settings)
+{
+  if (settings != m_settings) {
+    m_settings = settings;
+    clear ();
+  }
+}
+
+void
+PreviewImageCache::clear ()
+{
+  m_entries.clear ();
+}
+
+void
+PreviewImageCache::insert (const lay::Viewport &vp, const std::vector<lay::RedrawLayerInfo> &layers, const QImage &image)
+{
+  if (m_max_entries == 0 || image.isNull ()) {
+    return;
+  }
+
+  for (std::list<Entry>::iterator e = m_entries.begin (); e != m_entries.end (); ++e) {
+    if (e->trans.equal (vp.trans ()) && e->width == vp.width () && e->height == vp.height () && same_layers (e->layers, layers)) {
+      m_entries.erase (e);
+      break;
+    }
+  }
+
+  while (m_entries.size () >= m_max_entries) {
+    m_entries.pop_back ();
+  }
+
+  m_entries.push_front (Entry ());
+  Entry &entry = m_entries.front ();
+  entry.trans = vp.trans ();
+  entry.width = vp.width ();
+  entry.height = vp.height ();
+  entry.layers = layers;
+  entry.image = image;
+}
+
+const QImage *
+PreviewImageCache::find (const lay::Viewport &vp, const std::vector<lay::RedrawLayerInfo> &layers, db::DCplxTrans &trans) const
+{
+  const Entry *best = 0;
+  double best_area = 0.0;
+
+  db::DBox vp_box (0.0, 0.0, double (vp.width ()), double (vp.height ()));
+  const db::DCplxTrans &vt = vp.trans ();
+
+  for (std::list<Entry>::const_iterator e = m_entries.begin (); e != m_entries.end (); ++e) {
+
+    //  only pan and zoom are supported
+    if (vt.is_mirror () != e->trans.is_mirror () || fabs (vt.angle () - e->trans.angle ()) > 1e-6) {
+      continue;
+    }
+
+    if (! same_layers (e->layers, layers)) {
+      continue;
+    }
+
+    //  pixel coordinates of the entry to pixel coordinates of the viewport (y axis up)
+    db::DCplxTrans t = vt * e->trans.inverted ();
+
+    //  strong magnification changes are not considered as the preview would not be meaningful
+    double m = t.mag ();
+    if (m > 16.0 || m < 1.0 / 16.0) {
+      continue;
+    }
+
+    //  convert to image coordinates (y axis down)
+    db::DVector d = t.disp ();
+    t = db::DCplxTrans (m, 0.0, false, db::DVector (d.x (), double (vp.height ()) - m * double (e->height) - d.y ()));
+
+    db::DBox box = t * db::DBox (0.0, 0.0, double (e->image.width ()), double (e->image.height ()));
+    double a = (box & vp_box).area ();
+    if (a > best_area) {
+      best = e.operator-> ();
+      best_area = a;
+      trans = t;
+    }
+
+  }
+
+  return best ? &best->image : 0;
+}
+
+}
+
@@ -0,0 +1,159 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_layPreviewImageCache
+#define HDR_layPreviewImageCache
+
+#include "laybasicCommon.h"
+
+#include "dbTrans.h"
+#include "layViewport.h"
+#include "layViewOp.h"
+#include "layDitherPattern.h"
+#include "layLineStyles.h"
+#include "layRedrawLayerInfo.h"
+
+#include <QImage>
+
+#include <vector>
+#include <list>
+
+namespace lay
+{
+
+/**
+ *  @brief The view settings a preview image was rendered with
+ *
+ *  Images rendered with different settings can't be used as previews for each other.
+ */
+struct LAYBASIC_PUBLIC PreviewImageSettings
+{
+  PreviewImageSettings ();
+
+  bool operator== (const PreviewImageSettings &other) const;
+
+  bool operator!= (const PreviewImageSettings &other) const
+  {
+    return ! operator== (other);
+  }
+
+  lay::color_t background, foreground, active;
+  unsigned int oversampling;
+  std::vector<lay::ViewOp> view_ops;
+  lay::DitherPattern dither_pattern;
+  lay::LineStyles line_styles;
+};
+
+/**
+ *  @brief An in-memory cache of rendered view images
+ *
+ *  The cache keeps the final layer images of previous viewports together with the
+ *  viewport transformation and the layers drawn. For a new viewport, "find" delivers the
+ *  image which covers most of the new viewport after panning and zooming. The canvas
+ *  shows that image as a preview while the new image is drawn.
+ *
+ *  The images are expected to show the layers only, on a transparent background
+ *  (ARGB32 format). Background objects such as the grid depend on the viewport and are
+ *  drawn by the canvas under the preview.
+ *
+ *  The cache holds whole viewport images only. It is not a tiled multi-resolution
+ *  cache and it is filled by the canvas when a drawing is complete, not by the
+ *  redraw workers.
+ *
+ *  The cache is keyed by the view settings: changing the settings with "set_settings"
+ *  discards all images. Within the same settings, an image is found only if
+ *  it shows the same layers with the same rotation and mirroring and if the
+ *  magnification differs by less than a factor of 16.
+ */
+class LAYBASIC_PUBLIC PreviewImageCache
+{
+public:
+  /**
+   *  @brief Creates a cache holding up to "max_entries" images
+   */
+  PreviewImageCache (size_t max_entries = 8);
+
+  /**
+   *  @brief Sets the view settings
+   *
+   *  If the settings differ from the current ones, all images are discarded.
+   */
+  void set_settings (const PreviewImageSettings &settings);
+
+  /**
+   *  @brief Gets the view settings
+   */
+  const PreviewImageSettings &settings () const
+  {
+    return m_settings;
+  }
+
+  /**
+   *  @brief Stores the image rendered for the given viewport and layers
+   *
+   *  "image" is the layer image without the background (see class description).
+   *  An image stored before for the same viewport and layers is replaced. If
+   *  the cache is full, the least recently stored image is discarded.
+   */
+  void insert (const lay::Viewport &vp, const std::vector<lay::RedrawLayerInfo> &layers, const QImage &image);
+
+  /**
+   *  @brief Finds the image serving best as a preview for the given viewport and layers
+   *
+   *  Returns 0 if there is no suitable image. Otherwise "trans" receives the
+   *  transformation from the cached image into the image for the new viewport.
+   *  This transformation is given in image coordinates (y axis pointing down).
+   */
+  const QImage *find (const lay::Viewport &vp, const std::vector<lay::RedrawLayerInfo> &layers, db::DCplxTrans &trans) const;
+
+  /**
+   *  @brief Discards all images
+   */
+  void clear ();
+
+  /**
+   *  @brief Gets the number of images stored
+   */
+  size_t size () const
+  {
+    return m_entries.size ();
+  }
+
+private:
+  struct Entry
+  {
+    db::DCplxTrans trans;
+    unsigned int width, height;
+    std::vector<lay::RedrawLayerInfo> layers;
+    QImage image;
+  };
+
+  size_t m_max_entries;
+  PreviewImageSettings m_settings;
+  std::list<Entry> m_entries;
+};
+
+}
+
+#endif
+
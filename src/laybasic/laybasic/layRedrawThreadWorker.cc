@@ -1849,6 +1849,50 @@ private:
   lay::CanvasPlane *mp_text;
 };
 
+/**
+ *  @brief Draws a small cell from the coverage summary
+ *
+ *  The summary is used if a tile of the summary is not larger than a pixel and if
+ *  the summary represents more shapes than the number of boxes required to draw it.
+ *
+ *  @return True, if the cell was drawn
+ */
+bool
+RedrawThreadWorker::draw_coverage (db::cell_index_type ci, const db::CplxTrans &trans, const db::DBox &dbbox, const db::Box &cell_bbox, const db::Box &vp, int levels,
+                                   lay::CanvasPlane *fill, lay::CanvasPlane *frame, lay::CanvasPlane *vertex)
+{
+  if (dbbox.width () > double (lay::CellCoverage::resolution) || dbbox.height () > double (lay::CellCoverage::resolution)) {
+    return false;
+  }
+
+  //  the summary does not know about property selections and hidden cells
+  if (mp_prop_sel || m_cv_index < 0 || m_cv_index >= int (m_cellviews.size ())) {
+    return false;
+  }
+  if (m_cv_index < int (m_hidden_cells.size ()) && ! m_hidden_cells [m_cv_index].empty ()) {
+    return false;
+  }
+
+  //  partially visible cells are drawn the normal way
+  if (! cell_bbox.inside (vp)) {
+    return false;
+  }
+
+  lay::CellCoverage coverage = m_cellviews [m_cv_index]->coverage_cache ().coverage (ci, m_layer, levels);
+
+  std::vector<db::Box> boxes;
+  coverage.get_boxes (boxes);
+  if (coverage.weight () <= boxes.size ()) {
+    return false;
+  }
+
+  for (std::vector<db::Box>::const_iterator b = boxes.begin (); b != boxes.end (); ++b) {
+    mp_renderer->draw (*b, trans, fill, frame, vertex, 0);
+  }
+
+  return true;
+}
+
 void
 RedrawThreadWorker::draw_layer (int from_level, int to_level, db::cell_index_type ci, const db::CplxTrans &trans, const std::vector<db::Box> &vp, int level,
                                 lay::CanvasPlane *fill, lay::CanvasPlane *frame, lay::CanvasPlane *vertex, lay::CanvasPlane *text, const UpdateSnapshotCallback *update_snapshot)
@@ -1912,7 +1956,7 @@ RedrawThreadWorker::draw_layer (int from_level, int to_level, db::cell_index_typ
         mp_renderer->draw (dbbox, 0, frame, vertex, 0);
       } 
 
-    } else {
+    } else if (! draw_coverage (ci, trans, dbbox, cell_bbox, vp, to_level - level, fill, frame, vertex)) {
 
       //  create a set of boxes to look into
       std::vector<db::Box> vv = search_regions (cell_bbox, vp, level);
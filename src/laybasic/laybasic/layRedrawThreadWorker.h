@@ -199,6 +199,7 @@ private:
   bool any_shapes (db::cell_index_type cell_index, unsigned int levels);
   bool any_text_shapes (db::cell_index_type cell_index, unsigned int levels);
   bool any_cell_box (db::cell_index_type cell_index, unsigned int levels);
+  bool draw_coverage (db::cell_index_type ci, const db::CplxTrans &trans, const db::DBox &dbbox, const db::Box &cell_bbox, const db::Box &vp, int levels, lay::CanvasPlane *fill, lay::CanvasPlane *frame, lay::CanvasPlane *vertex);
 
   RedrawThread *mp_redraw_thread;
   std::vector <db::Box> m_redraw_region;
@@ -107,6 +107,7 @@ SOURCES = \
   layColorPalette.cc \
   layConfigurationDialog.cc \
   layConverters.cc \
+  layCoverageCache.cc \
   layCursor.cc \
   layDialogs.cc \
   layDisplayState.cc \
@@ -136,6 +137,7 @@ SOURCES = \
   layObjectInstPath.cc \
   layParsedLayerSource.cc \
   layPlugin.cc \
+  layPreviewImageCache.cc \
   layProperties.cc \
   layPropertiesDialog.cc \
   layQtTools.cc \
@@ -207,6 +209,7 @@ HEADERS = \
   layColorPalette.h \
   layConfigurationDialog.h \
   layConverters.h \
+  layCoverageCache.h \
   layCursor.h \
   layDialogs.h \
   layDisplayState.h \
@@ -236,6 +239,7 @@ HEADERS = \
   layObjectInstPath.h \
   layParsedLayerSource.h \
   layPlugin.h \
+  layPreviewImageCache.h \
   layPropertiesDialog.h \
   layProperties.h \
   layQtTools.h \
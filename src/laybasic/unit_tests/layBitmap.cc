@@ -26,6 +26,8 @@
 #include "layBitmap.h"
 #include "tlUnitTest.h"
 
+#include <vector>
+
 static std::string 
 to_string (const lay::Bitmap &bm)
 {
@@ -203,3 +205,41 @@ TEST(2)
 
 }
 
+
+static uint32_t rnd_word ()
+{
+  static uint32_t s = 12345;
+  s = s * 1103515245u + 12345u;
+  uint32_t hi = s >> 16;
+  s = s * 1103515245u + 12345u;
+  return (hi << 16) ^ (s >> 16);
+}
+
+//  The vectorized span fill vs. a pixel-by-pixel reference
+TEST(3)
+{
+  //  random spans with all alignments, widths which are not multiples of 32 and
+  //  overlapping fills
+  for (unsigned int width = 1; width < 300; width += 7) {
+
+    lay::Bitmap bm (width, 1, 1.0);
+    std::vector<bool> ref (width, false);
+
+    for (unsigned int i = 0; i < 10; ++i) {
+      unsigned int x1 = rnd_word () % width;
+      unsigned int x2 = x1 + rnd_word () % (width - x1 + 1);
+      bm.fill (0, x1, x2);
+      for (unsigned int x = x1; x < x2; ++x) {
+        ref [x] = true;
+      }
+    }
+
+    std::string s, s_ref;
+    for (unsigned int x = 0; x < width; ++x) {
+      s += (bm.scanline (0) [x / 32] & (1 << (x % 32))) != 0 ? "#" : "-";
+      s_ref += ref [x] ? "#" : "-";
+    }
+    EXPECT_EQ (s, s_ref);
+
+  }
+}
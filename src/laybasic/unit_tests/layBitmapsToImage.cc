@@ -27,6 +27,8 @@
 #include "layLineStyles.h"
 #include "tlUnitTest.h"
 
+#include <vector>
+
 #include <QImage>
 #include <QColor>
 #include <QMutex>
@@ -940,3 +942,107 @@ TEST(1)
 
 }
 
+
+static uint32_t rnd_word ()
+{
+  static uint32_t s = 4711;
+  s = s * 1103515245u + 12345u;
+  uint32_t hi = s >> 16;
+  s = s * 1103515245u + 12345u;
+  return (hi << 16) ^ (s >> 16);
+}
+
+//  The rendering of random bitmaps vs. a pixel-by-pixel reference. This covers the
+//  vectorized code paths with partial words and widths which are not multiples of 32.
+TEST(2)
+{
+  lay::DitherPattern dp;
+  lay::LineStyles ls;
+
+  const unsigned int dither_indexes [] = { 0, 2, 5, 9 };
+  const lay::ViewOp::Mode modes [] = { lay::ViewOp::Copy, lay::ViewOp::Or, lay::ViewOp::And, lay::ViewOp::Xor };
+
+  unsigned int height = 3;
+
+  for (unsigned int width = 1; width < 300; width += 11) {
+
+    for (int transparent = 0; transparent < 2; ++transparent) {
+
+      std::vector<lay::ViewOp> view_ops;
+      std::vector<lay::Bitmap> bitmaps;
+
+      for (unsigned int i = 0; i < 4; ++i) {
+
+        view_ops.push_back (lay::ViewOp (rnd_word () & 0xffffff, modes [(i + width) % 4], 0, dither_indexes [i], i));
+
+        bitmaps.push_back (lay::Bitmap (width, height, 1.0));
+        for (unsigned int y = 0; y < height; ++y) {
+          for (unsigned int j = 0; j < 3; ++j) {
+            unsigned int x1 = rnd_word () % width;
+            bitmaps.back ().fill (y, x1, x1 + rnd_word () % (width - x1 + 1));
+          }
+        }
+
+      }
+
+      std::vector<lay::Bitmap *> pbitmaps;
+      for (std::vector<lay::Bitmap>::iterator b = bitmaps.begin (); b != bitmaps.end (); ++b) {
+        pbitmaps.push_back (b.operator-> ());
+      }
+
+      QImage img (width, height, transparent ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+      std::vector<lay::color_t> ref;
+      for (unsigned int y = 0; y < height; ++y) {
+        lay::color_t *pt = (lay::color_t *) img.scanLine (y);
+        for (unsigned int x = 0; x < width; ++x) {
+          pt [x] = rnd_word () | 0xff000000;
+          ref.push_back (pt [x]);
+        }
+      }
+
+      //  pixel-by-pixel reference
+      for (unsigned int y = 0; y < height; ++y) {
+
+        for (unsigned int x = 0; x < width; ++x) {
+
+          lay::color_t py = transparent ? 0 : 0xff000000;
+          lay::color_t pz = 0xffffffff;
+
+          for (int i = int (view_ops.size ()) - 1; i >= 0; --i) {
+
+            const lay::ViewOp &op = view_ops [i];
+            const lay::DitherPatternInfo &dp_info = dp.pattern (op.dither_index ());
+            uint32_t dither = dp_info.pattern () [(y + op.dither_offset ()) % dp_info.height ()] [(x / 32) % dp_info.pattern_stride ()];
+
+            if ((bitmaps [i].scanline (y) [x / 32] & dither & (1u << (x % 32))) != 0) {
+              py |= (op.ormask () & 0x00ffffff & pz) | (transparent ? 0xff000000 : 0);
+              pz &= ~op.ormask () & op.andmask () & 0x00ffffff;
+            }
+
+          }
+
+          lay::color_t &p = ref [(height - 1 - y) * width + x];
+          p = (p & pz) | py;
+
+        }
+
+      }
+
+      lay::bitmaps_to_image (view_ops, pbitmaps, dp, ls, &img, width, height, false, 0);
+
+      bool equal = true;
+      for (unsigned int y = 0; y < height && equal; ++y) {
+        const lay::color_t *pt = (const lay::color_t *) img.scanLine (y);
+        for (unsigned int x = 0; x < width && equal; ++x) {
+          lay::color_t mask = transparent ? 0xffffffff : 0x00ffffff;
+          if ((pt [x] & mask) != (ref [y * width + x] & mask)) {
+            EXPECT_EQ (tl::sprintf ("%08x", pt [x] & mask), tl::sprintf ("%08x", ref [y * width + x] & mask));
+            equal = false;
+          }
+        }
+      }
+
+    }
+
+  }
+}
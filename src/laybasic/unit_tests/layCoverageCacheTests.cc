@@ -0,0 +1,129 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "layCoverageCache.h"
+#include "tlUnitTest.h"
+
+static std::string boxes2string (const lay::CellCoverage &cov)
+{
+  std::vector<db::Box> boxes;
+  cov.get_boxes (boxes);
+
+  std::string s;
+  for (std::vector<db::Box>::const_iterator b = boxes.begin (); b != boxes.end (); ++b) {
+    if (! s.empty ()) {
+      s += ";";
+    }
+    s += b->to_string ();
+  }
+  return s;
+}
+
+TEST(1_Basic)
+{
+  lay::CellCoverage cov (db::Box (0, 0, 3200, 3200));
+  EXPECT_EQ (cov.empty (), true);
+  EXPECT_EQ (cov.full (), false);
+  EXPECT_EQ (cov.tile (1, 2).to_string (), "(100,200;200,300)");
+
+  cov.add (db::Box (10, 10, 50, 50));
+  EXPECT_EQ (cov.empty (), false);
+  EXPECT_EQ (cov.is_set (0, 0), true);
+  EXPECT_EQ (cov.is_set (1, 0), false);
+  EXPECT_EQ (boxes2string (cov), "(0,0;100,100)");
+
+  cov.add (db::Box (150, 0, 350, 10));
+  EXPECT_EQ (boxes2string (cov), "(0,0;400,100)");
+
+  cov.add (db::Box (3150, 3150, 3200, 3200));
+  EXPECT_EQ (cov.is_set (31, 31), true);
+  EXPECT_EQ (boxes2string (cov), "(0,0;400,100);(3100,3100;3200,3200)");
+
+  //  outside
+  cov.add (db::Box (4000, 0, 5000, 100));
+  EXPECT_EQ (boxes2string (cov), "(0,0;400,100);(3100,3100;3200,3200)");
+
+  cov.add (db::Box (-100, -100, 4000, 4000));
+  EXPECT_EQ (cov.full (), true);
+
+  cov.add_weight (10);
+  EXPECT_EQ (cov.weight (), size_t (10));
+  cov.add_weight (5, 3);
+  EXPECT_EQ (cov.weight (), size_t (25));
+  cov.add_weight (std::numeric_limits<size_t>::max () / 2, 3);
+  EXPECT_EQ (cov.weight () == std::numeric_limits<size_t>::max (), true);
+}
+
+TEST(2_Cache)
+{
+  db::Layout ly;
+  unsigned int l1 = ly.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = ly.insert_layer (db::LayerProperties (2, 0));
+
+  db::Cell &top = ly.cell (ly.add_cell ("TOP"));
+  db::Cell &child = ly.cell (ly.add_cell ("CHILD"));
+
+  child.shapes (l1).insert (db::Box (0, 0, 100, 100));
+  child.shapes (l1).insert (db::Box (200, 200, 300, 300));
+  child.shapes (l2).insert (db::Box (0, 0, 300, 300));
+  top.shapes (l1).insert (db::Box (3100, 0, 3200, 100));
+
+  //  2x1 array
+  top.insert (db::CellInstArray (db::CellInst (child.cell_index ()), db::Trans (), db::Vector (1000, 0), db::Vector (0, 1000), 2, 1));
+  ly.update ();
+
+  lay::CoverageCache cache (&ly);
+
+  lay::CellCoverage cov = cache.coverage (top.cell_index (), l1, 10);
+  EXPECT_EQ (cov.bbox ().to_string (), "(0,0;3200,300)");
+  EXPECT_EQ (cov.weight (), size_t (5));
+  EXPECT_EQ (cache.size (), size_t (2));
+
+  //  cell only
+  cov = cache.coverage (top.cell_index (), l1, 1);
+  EXPECT_EQ (cov.weight (), size_t (1));
+  EXPECT_EQ (cov.is_set (31, 0), true);
+  EXPECT_EQ (cov.is_set (0, 0), false);
+  EXPECT_EQ (cache.size (), size_t (3));
+
+  cov = cache.coverage (top.cell_index (), l2, 10);
+  EXPECT_EQ (cov.weight (), size_t (2));
+  EXPECT_EQ (cache.size (), size_t (5));
+
+  cov = cache.coverage (child.cell_index (), l1, 10);
+  EXPECT_EQ (boxes2string (cov), "(0,0;103,103);(196,196;300,300)");
+
+  EXPECT_EQ (boxes2string (cache.coverage (top.cell_index (), l2, 10)), "(0,0;325,300);(975,0;1300,300)");
+
+  //  changing shapes on a layer invalidates the summaries for that layer
+  child.shapes (l1).insert (db::Box (0, 0, 10, 10));
+  EXPECT_EQ (cache.size (), size_t (2));
+
+  ly.update ();
+  cov = cache.coverage (top.cell_index (), l1, 10);
+  EXPECT_EQ (cov.weight (), size_t (7));
+
+  //  hierarchy changes invalidate all
+  ly.add_cell ("NEW");
+  EXPECT_EQ (cache.size (), size_t (0));
+}
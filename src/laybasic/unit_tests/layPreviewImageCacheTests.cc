@@ -0,0 +1,191 @@
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "layPreviewImageCache.h"
+#include "layLayerProperties.h"
+#include "tlUnitTest.h"
+
+static lay::Viewport make_viewport (const db::DCplxTrans &trans)
+{
+  lay::Viewport vp;
+  vp.set_size (100, 100);
+  vp.set_trans (trans);
+  return vp;
+}
+
+static std::vector<lay::RedrawLayerInfo> make_layers (size_t n)
+{
+  std::vector<lay::RedrawLayerInfo> layers;
+  for (size_t i = 0; i < n; ++i) {
+    lay::LayerProperties lp;
+    layers.push_back (lay::RedrawLayerInfo (lp));
+    layers.back ().visible = true;
+    layers.back ().layer_index = int (i);
+  }
+  return layers;
+}
+
+static QImage make_image (unsigned int w, unsigned int h, unsigned int color)
+{
+  QImage img (w, h, QImage::Format_RGB32);
+  img.fill (color);
+  return img;
+}
+
+TEST(1_HitAndMiss)
+{
+  lay::PreviewImageCache cache;
+  std::vector<lay::RedrawLayerInfo> layers = make_layers (2);
+  db::DCplxTrans t;
+
+  EXPECT_EQ (cache.find (make_viewport (db::DCplxTrans ()), layers, t) == 0, true);
+
+  cache.insert (make_viewport (db::DCplxTrans ()), layers, make_image (100, 100, 0xff0000));
+  EXPECT_EQ (cache.size (), size_t (1));
+
+  //  same viewport
+  const QImage *img = cache.find (make_viewport (db::DCplxTrans ()), layers, t);
+  EXPECT_EQ (img != 0, true);
+  EXPECT_EQ (img->pixel (0, 0), 0xffff0000);
+  EXPECT_EQ (t.to_string (), "r0 *1 0,0");
+
+  //  pan
+  img = cache.find (make_viewport (db::DCplxTrans (db::DVector (-50.0, 0.0))), layers, t);
+  EXPECT_EQ (img != 0, true);
+  EXPECT_EQ (t.to_string (), "r0 *1 -50,0");
+
+  img = cache.find (make_viewport (db::DCplxTrans (db::DVector (0.0, 20.0))), layers, t);
+  EXPECT_EQ (img != 0, true);
+  EXPECT_EQ (t.to_string (), "r0 *1 0,-20");
+
+  //  zoom out
+  img = cache.find (make_viewport (db::DCplxTrans (0.5)), layers, t);
+  EXPECT_EQ (img != 0, true);
+  EXPECT_EQ (t.to_string (), "r0 *0.5 0,50");
+
+  //  no overlap
+  EXPECT_EQ (cache.find (make_viewport (db::DCplxTrans (db::DVector (-200.0, 0.0))), layers, t) == 0, true);
+
+  //  magnification too large
+  EXPECT_EQ (cache.find (make_viewport (db::DCplxTrans (20.0)), layers, t) == 0, true);
+  EXPECT_EQ (cache.find (make_viewport (db::DCplxTrans (0.05)), layers, t) == 0, true);
+
+  //  rotation or mirror
+  EXPECT_EQ (cache.find (make_viewport (db::DCplxTrans (db::DFTrans::r90)), layers, t) == 0, true);
+  EXPECT_EQ (cache.find (make_viewport (db::DCplxTrans (db::DFTrans::m0)), layers, t) == 0, true);
+
+  //  different layers
+  std::vector<lay::RedrawLayerInfo> other_layers = layers;
+  other_layers [1].visible = false;
+  EXPECT_EQ (cache.find (make_viewport (db::DCplxTrans ()), other_layers, t) == 0, true);
+
+  other_layers = layers;
+  other_layers [1].layer_index = 17;
+  EXPECT_EQ (cache.find (make_viewport (db::DCplxTrans ()), other_layers, t) == 0, true);
+
+  EXPECT_EQ (cache.find (make_viewport (db::DCplxTrans ()), make_layers (1), t) == 0, true);
+}
+
+TEST(2_BestCoverage)
+{
+  lay::PreviewImageCache cache;
+  std::vector<lay::RedrawLayerInfo> layers = make_layers (1);
+  db::DCplxTrans t;
+
+  cache.insert (make_viewport (db::DCplxTrans ()), layers, make_image (100, 100, 0xff0000));
+  cache.insert (make_viewport (db::DCplxTrans (db::DVector (-100.0, 0.0))), layers, make_image (100, 100, 0x00ff00));
+  EXPECT_EQ (cache.size (), size_t (2));
+
+  const QImage *img = cache.find (make_viewport (db::DCplxTrans (db::DVector (-30.0, 0.0))), layers, t);
+  EXPECT_EQ (img != 0, true);
+  EXPECT_EQ (img->pixel (0, 0), 0xffff0000);
+  EXPECT_EQ (t.to_string (), "r0 *1 -30,0");
+
+  img = cache.find (make_viewport (db::DCplxTrans (db::DVector (-70.0, 0.0))), layers, t);
+  EXPECT_EQ (img != 0, true);
+  EXPECT_EQ (img->pixel (0, 0), 0xff00ff00);
+  EXPECT_EQ (t.to_string (), "r0 *1 30,0");
+
+  //  the same viewport replaces the image
+  cache.insert (make_viewport (db::DCplxTrans ()), layers, make_image (100, 100, 0x0000ff));
+  EXPECT_EQ (cache.size (), size_t (2));
+
+  img = cache.find (make_viewport (db::DCplxTrans (db::DVector (-30.0, 0.0))), layers, t);
+  EXPECT_EQ (img != 0, true);
+  EXPECT_EQ (img->pixel (0, 0), 0xff0000ff);
+}
+
+TEST(3_Invalidation)
+{
+  lay::PreviewImageCache cache (2);
+  std::vector<lay::RedrawLayerInfo> layers = make_layers (1);
+  db::DCplxTrans t;
+
+  lay::PreviewImageSettings settings;
+  settings.background = 0xffffff;
+  cache.set_settings (settings);
+
+  cache.insert (make_viewport (db::DCplxTrans ()), layers, make_image (100, 100, 0xff0000));
+  EXPECT_EQ (cache.size (), size_t (1));
+
+  //  same settings keep the images
+  cache.set_settings (settings);
+  EXPECT_EQ (cache.size (), size_t (1));
+  EXPECT_EQ (cache.find (make_viewport (db::DCplxTrans ()), layers, t) != 0, true);
+
+  //  other settings discard them
+  settings.background = 0x000000;
+  cache.set_settings (settings);
+  EXPECT_EQ (cache.size (), size_t (0));
+  EXPECT_EQ (cache.find (make_viewport (db::DCplxTrans ()), layers, t) == 0, true);
+
+  cache.insert (make_viewport (db::DCplxTrans ()), layers, make_image (100, 100, 0xff0000));
+  EXPECT_EQ (cache.size (), size_t (1));
+
+  settings.oversampling = 2;
+  cache.set_settings (settings);
+  EXPECT_EQ (cache.size (), size_t (0));
+
+  cache.insert (make_viewport (db::DCplxTrans ()), layers, make_image (100, 100, 0xff0000));
+  settings.view_ops.push_back (lay::ViewOp (0x808080, lay::ViewOp::Copy, 0, 0, 0));
+  cache.set_settings (settings);
+  EXPECT_EQ (cache.size (), size_t (0));
+
+  //  clear
+  cache.insert (make_viewport (db::DCplxTrans ()), layers, make_image (100, 100, 0xff0000));
+  EXPECT_EQ (cache.size (), size_t (1));
+  cache.clear ();
+  EXPECT_EQ (cache.size (), size_t (0));
+  EXPECT_EQ (cache.find (make_viewport (db::DCplxTrans ()), layers, t) == 0, true);
+
+  //  the oldest image is dropped when the capacity is exceeded
+  cache.insert (make_viewport (db::DCplxTrans ()), layers, make_image (100, 100, 0xff0000));
+  cache.insert (make_viewport (db::DCplxTrans (db::DVector (-100.0, 0.0))), layers, make_image (100, 100, 0x00ff00));
+  cache.insert (make_viewport (db::DCplxTrans (db::DVector (-200.0, 0.0))), layers, make_image (100, 100, 0x0000ff));
+  EXPECT_EQ (cache.size (), size_t (2));
+
+  EXPECT_EQ (cache.find (make_viewport (db::DCplxTrans (db::DVector (20.0, 0.0))), layers, t) == 0, true);
+  const QImage *img = cache.find (make_viewport (db::DCplxTrans (db::DVector (-120.0, 0.0))), layers, t);
+  EXPECT_EQ (img != 0, true);
+  EXPECT_EQ (img->pixel (0, 0), 0xff00ff00);
+}
+
@@ -10,6 +10,8 @@ SOURCES = \
   layAnnotationShapes.cc \
   layBitmap.cc \
   layBitmapsToImage.cc \
+  layCoverageCacheTests.cc \
+  layPreviewImageCacheTests.cc \
   layLayerProperties.cc \
   layParsedLayerSource.cc \
   layRenderer.cc \
@@ -155,6 +155,12 @@ module LVS
     # @synopsis max_depth(n)
     # See \Netter#max_depth for a description of that function.
 
+    # %LVS%
+    # @name compare_cache
+    # @brief Keeps the netlist compare results in a file for later runs
+    # @synopsis compare_cache(filename)
+    # See \Netter#compare_cache for a description of that function.
+
     # %LVS%
     # @name consider_net_names
     # @brief Indicates whether the netlist comparer shall use net names
@@ -168,7 +174,7 @@ module LVS
     # @synopsis tolerance(device_class_name, parameter_name [, :absolute => absolute_tolerance] [, :relative => relative_tolerance])
     # See \Netter#tolerance for a description of that function.
 
-    %w(schematic compare join_symmetric_nets tolerance align same_nets same_circuits same_device_classes equivalent_pins min_caps max_res max_depth max_branch_complexity consider_net_names).each do |f|
+    %w(schematic compare compare_cache join_symmetric_nets tolerance align same_nets same_circuits same_device_classes equivalent_pins min_caps max_res max_depth max_branch_complexity consider_net_names).each do |f|
       eval <<"CODE"
         def #{f}(*args)
           _netter.#{f}(*args)
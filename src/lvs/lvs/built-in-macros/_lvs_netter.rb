@@ -49,6 +49,7 @@ module LVS
     def initialize(engine)
       super
       @comparer_config = []
+      @compare_cache_file = nil
     end
 
     def _make_data
@@ -216,14 +217,56 @@ module LVS
     #
     # This method will return true, if the netlists are equivalent and false
     # otherwise.
+    #
+    # With \compare_cache, the compare results are kept in a file, so a 
+    # later run only needs to compare the circuits which have changed.
 
     def compare
 
       nl = _ensure_two_netlists
       lvs_data.reference = nl[1]
 
-      lvs_data.compare(self._comparer)
+      cache_file = @compare_cache_file
+      if cache_file && File.exist?(cache_file)
+        begin
+          lvs_data.compare_cache.load(cache_file)
+          @engine.info("Using netlist compare cache: #{cache_file}")
+        rescue => ex
+          @engine.log("Netlist compare cache #{cache_file} cannot be used: #{ex.to_s}")
+          lvs_data.compare_cache.clear
+        end
+      end
+
+      res = lvs_data.compare(self._comparer)
+
+      if cache_file
+        @engine.info("Writing netlist compare cache: #{cache_file} (#{lvs_data.compare_cache.hits} of #{lvs_data.compare_cache.size} circuit results reused)")
+        lvs_data.compare_cache.save(cache_file)
+      end
+
+      res
+
+    end
+
+    # %LVS%
+    # @name compare_cache
+    # @brief Keeps the netlist compare results in a file for later runs
+    # @synopsis compare_cache(filename)
+    # With a compare cache file, \compare saves the compare results per circuit 
+    # to this file. When the script is run again, the results of the circuits which 
+    # did not change are taken from the file. Hence after a small modification,
+    # only the modified circuits and the circuits above them are compared again.
+    #
+    # A circuit is considered unchanged if the layout and schematic circuits, their
+    # child circuits and the compare settings (including the tolerances) are the same.
+    # If the file does not exist or cannot be read, the netlists are compared 
+    # completely.
+    #
+    # A relative path is taken relative to the layout source.
 
+    def compare_cache(filename)
+      filename.is_a?(String) || raise("Argument of 'compare_cache' must be a string (a file name)")
+      @compare_cache_file = @engine._make_path(filename)
     end
 
     # %LVS%
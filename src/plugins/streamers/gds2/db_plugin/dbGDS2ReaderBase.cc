@@ -440,6 +440,14 @@ GDS2ReaderBase::do_read (db::Layout &layout)
         cell->prop_id (layout.properties_repository ().properties_id (cell_properties));
       }
 
+      //  deliver the cell to the receiver (if there is one) - as the layout is still
+      //  under construction, the instance tree needs to be sorted explicitly to make
+      //  the instances accessible
+      if (cell_receiver ()) {
+        cell->sort_inst_tree ();
+        cell_receiver ()->cell_read (layout, cell_index);
+      }
+
     }
 
     m_cellname = "";
@@ -67,6 +67,11 @@ public:
    */
   const std::string &libname () const { return m_libname; }
 
+  /**
+   *  @brief The GDS2 reader delivers each cell to the cell receiver after reading it
+   */
+  virtual bool supports_cell_receiver () const { return true; }
+
 protected:
   /** 
    *  @brief The basic read method 
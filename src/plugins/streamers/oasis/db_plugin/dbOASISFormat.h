@@ -43,7 +43,7 @@ public:
    *  @brief The constructor
    */
   OASISReaderOptions ()
-    : read_all_properties (false), expect_strict_mode (-1)
+    : read_all_properties (false), expect_strict_mode (-1), read_threads (0), lazy_loading (false)
   {
     //  .. nothing yet ..
   }
@@ -70,6 +70,28 @@ public:
    */
   int expect_strict_mode;
 
+  /**
+   *  @brief The number of threads used for decompressing CBLOCKs
+   *
+   *  If this value is larger than 0, CBLOCKs are inflated in the background by the 
+   *  given number of worker threads while the reader is processing the records.
+   *  A value of 0 (the default) will make the reader inflate the CBLOCKs inline.
+   */
+  int read_threads;
+
+  /**
+   *  @brief Lazy loading of shapes
+   *
+   *  If this flag is set, the reader builds the cell hierarchy, the layers and the
+   *  name tables, but does not create the shapes of the cells. Instead it remembers
+   *  where the cell bodies are located in the stream. For cells inside CBLOCKs, the
+   *  CBLOCK and the offset inside the inflated data are remembered. The shapes of a
+   *  cell are loaded when they are accessed first (see db::DeferredCellLoader) or
+   *  through ReaderBase::load_cell and related methods. This requires the reader and
+   *  the stream to stay alive. Streams which cannot be reset are read completely.
+   */
+  bool lazy_loading;
+
   /**
    *  @brief Implementation of FormatSpecificReaderOptions
    */
@@ -101,7 +123,7 @@ public:
    *  @brief The constructor
    */
   OASISWriterOptions ()
-    : compression_level (2), write_cblocks (false), strict_mode (false), recompress (false), permissive (false), write_std_properties (1), subst_char ("*")
+    : compression_level (2), write_cblocks (false), strict_mode (false), recompress (false), permissive (false), write_std_properties (1), subst_char ("*"), write_threads (0)
   {
     //  .. nothing yet ..
   }
@@ -166,6 +188,15 @@ public:
    */
   std::string subst_char;
 
+  /**
+   *  @brief Number of threads for CBLOCK compression
+   *
+   *  If this value is larger than 0 and CBLOCKs are written, the cell CBLOCKs are
+   *  compressed by the given number of worker threads while the writer continues
+   *  with the next cells. The output is identical to the single-threaded case.
+   */
+  int write_threads;
+
   /** 
    *  @brief Implementation of FormatSpecificWriterOptions
    */
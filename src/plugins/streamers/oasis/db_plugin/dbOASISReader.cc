@@ -32,6 +32,8 @@
 #include "tlException.h"
 #include "tlString.h"
 #include "tlClassRegistry.h"
+#include "tlDeflate.h"
+#include "tlThreadedWorkers.h"
 
 namespace db
 {
@@ -67,6 +69,347 @@ private:
   bool m_create;
 };
 
+// ---------------------------------------------------------------
+//  OASISCBlockPrefetcher definition and implementation
+
+/**
+ *  @brief Describes a CBLOCK which is inflated in the background
+ *
+ *  If "copy" is false, the compressed data is not copied. This requires the data
+ *  to stay valid while the block is processed (direct stream mode).
+ */
+struct OASISCBlock
+{
+  OASISCBlock (size_t _uncomp_bytes, const char *data, size_t comp_bytes, bool copy)
+    : uncomp_bytes (_uncomp_bytes), compressed_data (data), compressed_size (comp_bytes), done (false), valid (false)
+  {
+    if (copy) {
+      compressed.assign (data, data + comp_bytes);
+      compressed_data = compressed.data ();
+    }
+  }
+
+  size_t uncomp_bytes;
+  const char *compressed_data;
+  size_t compressed_size;
+  std::vector<char> compressed;
+  std::vector<char> inflated;
+  bool done, valid;
+};
+
+/**
+ *  @brief The task for inflating one CBLOCK
+ */
+class OASISCBlockInflateTask
+  : public tl::Task
+{
+public:
+  OASISCBlockInflateTask (OASISCBlockPrefetcher *prefetcher, OASISCBlock *block)
+    : mp_prefetcher (prefetcher), mp_block (block)
+  {
+    //  .. nothing yet ..
+  }
+
+  void perform ();
+
+private:
+  OASISCBlockPrefetcher *mp_prefetcher;
+  OASISCBlock *mp_block;
+};
+
+/**
+ *  @brief The worker for inflating CBLOCKs
+ */
+class OASISCBlockInflateWorker
+  : public tl::Worker
+{
+public:
+  OASISCBlockInflateWorker ()
+    : tl::Worker ()
+  {
+    //  .. nothing yet ..
+  }
+
+  void perform_task (tl::Task *task)
+  {
+    static_cast<OASISCBlockInflateTask *> (task)->perform ();
+  }
+};
+
+/**
+ *  @brief A look-ahead decompressor for CBLOCKs
+ *
+ *  When the reader encounters a CBLOCK, this object scans the raw stream behind it
+ *  for further CBLOCKs, only skipping over the records typically found between
+ *  compressed cell bodies (CELL and PAD). The CBLOCKs found this way are
+ *  inflated by worker threads while the reader is still busy with the current one.
+ *  When the reader arrives at one of these CBLOCKs, the inflated data is taken
+ *  instead of decompressing the data inline.
+ *  Blocks which fail to decompress in the background are handed back to the reader
+ *  which will decompress them inline and report errors in the usual way.
+ */
+class OASISCBlockPrefetcher
+{
+public:
+  OASISCBlockPrefetcher (tl::InputStream &stream, int threads)
+    : mp_stream (&stream), m_job (threads), m_scan_pos (0), m_scan_valid (false),
+      m_max_blocks (size_t (threads) * 4), m_max_window (64 * 1024 * 1024)
+  {
+    //  .. nothing yet ..
+  }
+
+  ~OASISCBlockPrefetcher ()
+  {
+    clear ();
+  }
+
+  /**
+   *  @brief Fetches the inflated data for the CBLOCK starting at the current stream position
+   *
+   *  The stream is expected to be positioned after the CBLOCK header.
+   *  Returns false, if the block could not be decoded in the background. In that case
+   *  the reader is supposed to inflate the data itself.
+   */
+  bool fetch (size_t uncomp_bytes, size_t comp_bytes, std::vector<char> &inflated)
+  {
+    size_t pos = mp_stream->pos ();
+
+    std::map<size_t, OASISCBlock *>::iterator b = m_blocks.find (pos);
+    if (b == m_blocks.end ()) {
+
+      //  a CBLOCK we did not find in the look-ahead: restart the scan from here
+      clear ();
+
+      const char *data = mp_stream->peek (comp_bytes);
+      if (! data) {
+        return false;
+      }
+
+      b = m_blocks.insert (std::make_pair (pos, new OASISCBlock (uncomp_bytes, data, comp_bytes, ! mp_stream->is_direct ()))).first;
+      schedule (b->second);
+
+      m_scan_pos = pos + comp_bytes;
+      m_scan_valid = true;
+
+    }
+
+    //  keep the workers busy while we consume this block
+    scan_ahead ();
+
+    OASISCBlock *block = b->second;
+    wait_for (block);
+
+    bool valid = block->valid && block->inflated.size () == uncomp_bytes;
+    if (valid) {
+      inflated.swap (block->inflated);
+    }
+
+    //  blocks up to this one are no longer needed
+    while (! m_blocks.empty () && m_blocks.begin ()->first <= pos) {
+      wait_for (m_blocks.begin ()->second);
+      delete m_blocks.begin ()->second;
+      m_blocks.erase (m_blocks.begin ());
+    }
+
+    return valid;
+  }
+
+  /**
+   *  @brief Called by the worker when a block has been processed
+   */
+  void block_done (OASISCBlock *block, bool valid)
+  {
+    tl::MutexLocker locker (&m_lock);
+    block->valid = valid;
+    block->done = true;
+    m_done_condition.wakeAll ();
+  }
+
+private:
+  tl::InputStream *mp_stream;
+  tl::Job<OASISCBlockInflateWorker> m_job;
+  std::map<size_t, OASISCBlock *> m_blocks;
+  size_t m_scan_pos;
+  bool m_scan_valid;
+  size_t m_max_blocks, m_max_window;
+  tl::Mutex m_lock;
+  tl::WaitCondition m_done_condition;
+
+  void wait_for (OASISCBlock *block)
+  {
+    tl::MutexLocker locker (&m_lock);
+    while (! block->done) {
+      m_done_condition.wait (&m_lock);
+    }
+  }
+
+  void clear ()
+  {
+    //  stops the workers before the blocks are deleted
+    m_job.stop ();
+
+    for (std::map<size_t, OASISCBlock *>::const_iterator b = m_blocks.begin (); b != m_blocks.end (); ++b) {
+      delete b->second;
+    }
+    m_blocks.clear ();
+
+    m_scan_valid = false;
+  }
+
+  void schedule (OASISCBlock *block)
+  {
+    m_job.schedule (new OASISCBlockInflateTask (this, block));
+    if (! m_job.is_running ()) {
+      m_job.start ();
+    }
+  }
+
+  bool peek_byte (size_t p, unsigned char &b)
+  {
+    const char *data = mp_stream->peek (p + 1 - mp_stream->pos ());
+    if (! data) {
+      return false;
+    }
+    b = (unsigned char) data [p - mp_stream->pos ()];
+    return true;
+  }
+
+  bool peek_ulong (size_t &p, size_t &v)
+  {
+    v = 0;
+    unsigned int shift = 0;
+    unsigned char b = 0;
+    do {
+      if (shift >= sizeof (size_t) * 8 || ! peek_byte (p++, b)) {
+        return false;
+      }
+      v |= size_t (b & 0x7f) << shift;
+      shift += 7;
+    } while ((b & 0x80) != 0);
+    return true;
+  }
+
+  /**
+   *  @brief Looks for further CBLOCKs after the ones known already
+   *
+   *  Scanning only happens when the look-ahead falls below half of its capacity.
+   *  This way, the stream buffer is not reorganized on every block.
+   */
+  void scan_ahead ()
+  {
+    if (! m_scan_valid || m_blocks.size () > m_max_blocks / 2) {
+      return;
+    }
+
+    while (m_blocks.size () < m_max_blocks) {
+
+      size_t p = m_scan_pos;
+
+      unsigned char r = 0;
+      if (! peek_byte (p++, r)) {
+        m_scan_valid = false;
+        break;
+      }
+
+      size_t v = 0;
+
+      if (r == 0 /*PAD*/) {
+
+        //  skip PAD
+
+      } else if (r == 13 /*CELL*/) {
+
+        if (! peek_ulong (p, v)) {
+          m_scan_valid = false;
+          break;
+        }
+
+      } else if (r == 14 /*CELL*/) {
+
+        if (! peek_ulong (p, v)) {
+          m_scan_valid = false;
+          break;
+        }
+        p += v;
+
+      } else if (r == 34 /*CBLOCK*/) {
+
+        size_t uncomp_bytes = 0, comp_bytes = 0;
+        if (! peek_ulong (p, v) || v != 0 || ! peek_ulong (p, uncomp_bytes) || ! peek_ulong (p, comp_bytes)) {
+          m_scan_valid = false;
+          break;
+        }
+
+        //  in direct mode, peeking does not need buffer memory
+        size_t window = p + comp_bytes - mp_stream->pos ();
+        if (window > m_max_window && ! m_blocks.empty () && ! mp_stream->is_direct ()) {
+          //  continue later
+          break;
+        }
+
+        const char *data = mp_stream->peek (window);
+        if (! data) {
+          m_scan_valid = false;
+          break;
+        }
+
+        OASISCBlock *block = new OASISCBlock (uncomp_bytes, data + (p - mp_stream->pos ()), comp_bytes, ! mp_stream->is_direct ());
+        m_blocks.insert (std::make_pair (p, block));
+        schedule (block);
+
+        p += comp_bytes;
+
+      } else {
+
+        //  any other record terminates the look-ahead
+        m_scan_valid = false;
+        break;
+
+      }
+
+      m_scan_pos = p;
+
+    }
+  }
+};
+
+void
+OASISCBlockInflateTask::perform ()
+{
+  bool valid = false;
+
+  try {
+
+    tl::InputMemoryStream ims (mp_block->compressed_data, mp_block->compressed_size);
+    tl::InputStream is (ims);
+    tl::InflateFilter inflate (is);
+
+    const size_t chunk_size = 16384;
+
+    mp_block->inflated.reserve (mp_block->uncomp_bytes);
+    for (size_t n = mp_block->uncomp_bytes; n > 0; ) {
+      size_t chunk = std::min (n, chunk_size);
+      const char *data = inflate.get (chunk);
+      mp_block->inflated.insert (mp_block->inflated.end (), data, data + chunk);
+      n -= chunk;
+    }
+
+    //  the compressed data must be consumed entirely
+    valid = inflate.at_end () && is.pos () == mp_block->compressed_size;
+
+  } catch (...) {
+    //  errors will be reported when the reader inflates the block inline
+  }
+
+  mp_block->compressed_data = 0;
+  std::vector<char> ().swap (mp_block->compressed);
+  if (! valid) {
+    std::vector<char> ().swap (mp_block->inflated);
+  }
+
+  mp_prefetcher->block_done (mp_block, valid);
+}
+
 // ---------------------------------------------------------------
 //  OASISReader
 
@@ -105,6 +448,13 @@ OASISReader::OASISReader (tl::InputStream &s)
     m_read_texts (true),
     m_read_properties (true),
     m_read_all_properties (false),
+    m_read_threads (0),
+    mp_cblock_prefetcher (0),
+    m_lazy_loading (false),
+    m_skip_shapes (false),
+    m_skip_instances (false),
+    m_cblock_pos (0),
+    mp_deferred_bboxes (0),
     m_s_gds_property_name_id (0),
     m_klayout_context_property_name_id (0)
 {
@@ -126,7 +476,9 @@ OASISReader::OASISReader (tl::InputStream &s)
 
 OASISReader::~OASISReader ()
 {
-  //  .. nothing yet ..
+  detach_deferred_cells ();
+  delete mp_cblock_prefetcher;
+  mp_cblock_prefetcher = 0;
 }
 
 const LayerMap &
@@ -143,16 +495,42 @@ OASISReader::read (db::Layout &layout, const db::LoadLayoutOptions &options)
   m_create_layers = common_options.create_other_layers;
   m_read_all_properties = oasis_options.read_all_properties;
   m_expect_strict_mode = oasis_options.expect_strict_mode;
+  m_read_threads = oasis_options.read_threads;
+  m_lazy_loading = oasis_options.lazy_loading;
+
+  //  cells loaded lazily from a previous read stay as they are
+  detach_deferred_cells ();
+
+  //  lazy loading needs to come back to the cell bodies later
+  if (m_lazy_loading && ! m_stream.is_resettable ()) {
+    tl::warn << tl::sprintf (tl::to_string (tr ("Lazy loading is not available for %s as this input cannot be read twice - loading all shapes now")), m_stream.source ());
+    m_lazy_loading = false;
+  }
+
+  delete mp_cblock_prefetcher;
+  mp_cblock_prefetcher = 0;
+  if (m_read_threads > 0) {
+    mp_cblock_prefetcher = new OASISCBlockPrefetcher (m_stream, m_read_threads);
+  }
 
   layout.start_changes ();
   try {
     do_read (layout);
+    attach_deferred_cells (layout);
     layout.end_changes ();
   } catch (...) {
     layout.end_changes ();
+    delete mp_cblock_prefetcher;
+    mp_cblock_prefetcher = 0;
+    m_skip_shapes = false;
+    mp_deferred_bboxes = 0;
+    m_deferred_cells.clear ();
     throw;
   }
 
+  delete mp_cblock_prefetcher;
+  mp_cblock_prefetcher = 0;
+
   return m_layer_map;
 }
 
@@ -684,6 +1062,32 @@ OASISReader::read_offset_table ()
   get_ulong ();
 }
 
+void
+OASISReader::read_cblock ()
+{
+  //  remember where the CBLOCK starts, so we can come back for lazy loading
+  m_cblock_pos = m_stream.pos ();
+
+  unsigned int type = get_uint ();
+  if (type != 0) {
+    error (tl::sprintf (tl::to_string (tr ("Invalid CBLOCK compression type %d")), type));
+  }
+
+  size_t uncomp_bytes = get_ulong ();
+  size_t comp_bytes = get_ulong ();
+
+  //  use the data inflated in the background if available
+  if (mp_cblock_prefetcher) {
+    std::vector<char> inflated;
+    if (mp_cblock_prefetcher->fetch (uncomp_bytes, comp_bytes, inflated) && m_stream.inflate (comp_bytes, inflated)) {
+      return;
+    }
+  }
+
+  //  put the stream into deflating mode
+  m_stream.inflate ();
+}
+
 static const char magic_bytes[] = { "%SEMI-OASIS\015\012" };
 
 void 
@@ -769,6 +1173,7 @@ OASISReader::do_read (db::Layout &layout)
   m_defined_cells_by_id.clear ();
   m_defined_cells_by_name.clear ();
   m_mapped_cellnames.clear ();
+  m_deferred_cells.clear ();
 
   m_instances.clear ();
   m_instances_with_props.clear ();
@@ -1211,20 +1616,30 @@ OASISReader::do_read (db::Layout &layout)
       reset_modal_variables ();
       mark_start_table ();
 
-      do_read_cell (cell_index, layout);
+      if (m_lazy_loading) {
 
-    } else if (r == 34 /*CBLOCK*/) {
+        //  lazy mode: read the instances only and remember where the cell body starts
+        //  and where the shapes are
+        DeferredCellBody &body = m_deferred_cells [cell_index];
+        if (m_stream.is_inflating ()) {
+          body = DeferredCellBody (m_cblock_pos, true, m_stream.inflated_pos ());
+        } else {
+          body = DeferredCellBody (m_stream.pos (), false, 0);
+        }
+
+        m_skip_shapes = true;
+        mp_deferred_bboxes = &body.bboxes;
+        do_read_cell (cell_index, layout);
+        mp_deferred_bboxes = 0;
+        m_skip_shapes = false;
 
-      unsigned int type = get_uint ();
-      if (type != 0) {
-        error (tl::sprintf (tl::to_string (tr ("Invalid CBLOCK compression type %d")), type));
+      } else {
+        do_read_cell (cell_index, layout);
       }
 
-      get_uint ();  // uncomp-byte-count - not needed
-      get_uint ();  // comp-byte-count - not needed
+    } else if (r == 34 /*CBLOCK*/) {
 
-      //  put the stream into deflating mode
-      m_stream.inflate ();
+      read_cblock ();
 
     } else {
       error (tl::sprintf (tl::to_string (tr ("Invalid record type on global level %d")), int (r)));
@@ -1371,6 +1786,13 @@ OASISReader::do_read (db::Layout &layout)
           layout.cell (p->first).replace (p->second, ia);
         }
 
+        //  a cell loaded later needs to go into the original cell
+        std::map <db::cell_index_type, DeferredCellBody>::iterator dc = m_deferred_cells.find (new_cell.cell_index ());
+        if (dc != m_deferred_cells.end ()) {
+          m_deferred_cells [org_cell.cell_index ()] = dc->second;
+          m_deferred_cells.erase (dc);
+        }
+
         //  finally delete the new cell
         layout.delete_cell (new_cell.cell_index ());
 
@@ -1469,16 +1891,7 @@ OASISReader::read_element_properties (db::PropertiesRepository &rep, bool ignore
      
     } else if (m == 34 /*CBLOCK*/) {
 
-      unsigned int type = get_uint ();
-      if (type != 0) {
-        error (tl::sprintf (tl::to_string (tr ("Invalid CBLOCK compression type %d")), type));
-      }
-
-      get_uint ();  // uncomp-byte-count - not needed
-      get_uint ();  // comp-byte-count - not needed
-
-      //  put the stream into deflating mode
-      m_stream.inflate ();
+      read_cblock ();
 
     } else if (m == 28 /*PROPERTY*/) {
 
@@ -2124,6 +2537,28 @@ OASISReader::do_read_placement (unsigned char r,
   }
 }
 
+template <class Iter>
+static db::Box
+points_bbox (Iter from, Iter to)
+{
+  db::Box box;
+  for (Iter p = from; p != to; ++p) {
+    box += *p;
+  }
+  return box;
+}
+
+static db::Box
+path_bbox (const std::vector<db::Point> &points, db::Coord hw, db::Coord bgn_ext, db::Coord end_ext, bool round)
+{
+  db::Path path;
+  path.width (2 * hw);
+  path.extensions (bgn_ext, end_ext);
+  path.round (round);
+  path.assign (points.begin (), points.end ());
+  return path.box ();
+}
+
 void 
 OASISReader::do_read_text (bool xy_absolute,
                            db::cell_index_type cell_index, 
@@ -2204,7 +2639,7 @@ OASISReader::do_read_text (bool xy_absolute,
 
   std::pair<bool, unsigned int> ll (false, 0);
   if (m_read_texts) {
-    ll = open_dl (layout, LDPair (mm_textlayer.get (), mm_texttype.get ()), m_create_layers);
+    ll = open_shape_dl (layout, LDPair (mm_textlayer.get (), mm_texttype.get ()));
   }
 
   if ((m & 0x4) && read_repetition ()) {
@@ -2212,7 +2647,13 @@ OASISReader::do_read_text (bool xy_absolute,
     //  TODO: should not read properties if layer is not enabled!
     std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
 
-    if (ll.first) {
+    if (m_skip_shapes) {
+
+      if (ll.first) {
+        add_deferred_bbox (ll.second, db::Box (db::Point () + pos, db::Point () + pos), true);
+      }
+
+    } else if (ll.first) {
 
       db::Text text;
       if (mm_text_string_id.is_set ()) {
@@ -2277,7 +2718,13 @@ OASISReader::do_read_text (bool xy_absolute,
 
     std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
 
-    if (ll.first) {
+    if (m_skip_shapes) {
+
+      if (ll.first) {
+        add_deferred_bbox (ll.second, db::Box (db::Point () + pos, db::Point () + pos), false);
+      }
+
+    } else if (ll.first) {
 
       db::Text text;
       if (mm_text_string_id.is_set ()) {
@@ -2346,13 +2793,19 @@ OASISReader::do_read_rectangle (bool xy_absolute,
   db::Box box (db::Point (mm_geometry_x.get (), mm_geometry_y.get ()),
                db::Point (mm_geometry_x.get () + mm_geometry_w.get (), mm_geometry_y.get () + mm_geometry_h.get ()));
 
-  std::pair<bool, unsigned int> ll = open_dl (layout, LDPair (mm_layer.get (), mm_datatype.get ()), m_create_layers);
+  std::pair<bool, unsigned int> ll = open_shape_dl (layout, LDPair (mm_layer.get (), mm_datatype.get ()));
 
   if ((m & 0x4) && read_repetition ()) {
 
     std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
 
-    if (ll.first) {
+    if (m_skip_shapes) {
+
+      if (ll.first) {
+        add_deferred_bbox (ll.second, box, true);
+      }
+
+    } else if (ll.first) {
 
       db::Cell &cell = layout.cell (cell_index);
 
@@ -2407,7 +2860,13 @@ OASISReader::do_read_rectangle (bool xy_absolute,
     
     std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
 
-    if (ll.first) {
+    if (m_skip_shapes) {
+
+      if (ll.first) {
+        add_deferred_bbox (ll.second, box, false);
+      }
+
+    } else if (ll.first) {
 
       db::Cell &cell = layout.cell (cell_index);
       if (pp.first) {
@@ -2460,13 +2919,19 @@ OASISReader::do_read_polygon (bool xy_absolute, db::cell_index_type cell_index,
 
   db::Vector pos (mm_geometry_x.get (), mm_geometry_y.get ());
 
-  std::pair<bool, unsigned int> ll = open_dl (layout, LDPair (mm_layer.get (), mm_datatype.get ()), m_create_layers);
+  std::pair<bool, unsigned int> ll = open_shape_dl (layout, LDPair (mm_layer.get (), mm_datatype.get ()));
 
   if ((m & 0x4) && read_repetition ()) {
 
     std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
 
-    if (ll.first) {
+    if (m_skip_shapes) {
+
+      if (ll.first && mm_polygon_point_list.get ().size () >= 3) {
+        add_deferred_bbox (ll.second, points_bbox (mm_polygon_point_list.get ().begin (), mm_polygon_point_list.get ().end ()).moved (pos), true);
+      }
+
+    } else if (ll.first) {
 
       db::Cell &cell = layout.cell (cell_index);
 
@@ -2540,7 +3005,13 @@ OASISReader::do_read_polygon (bool xy_absolute, db::cell_index_type cell_index,
 
     std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
 
-    if (ll.first) {
+    if (m_skip_shapes) {
+
+      if (ll.first && mm_polygon_point_list.get ().size () >= 3) {
+        add_deferred_bbox (ll.second, points_bbox (mm_polygon_point_list.get ().begin (), mm_polygon_point_list.get ().end ()).moved (pos), false);
+      }
+
+    } else if (ll.first) {
 
       if (mm_polygon_point_list.get ().size () < 3) {
         warn (tl::to_string (tr ("POLYGON with less than 3 points ignored")));
@@ -2627,13 +3098,19 @@ OASISReader::do_read_path (bool xy_absolute, db::cell_index_type cell_index, db:
 
   db::Vector pos (mm_geometry_x.get (), mm_geometry_y.get ());
 
-  std::pair<bool, unsigned int> ll = open_dl (layout, LDPair (mm_layer.get (), mm_datatype.get ()), m_create_layers);
+  std::pair<bool, unsigned int> ll = open_shape_dl (layout, LDPair (mm_layer.get (), mm_datatype.get ()));
 
   if ((m & 0x4) && read_repetition ()) {
 
     std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
 
-    if (ll.first) {
+    if (m_skip_shapes) {
+
+      if (ll.first && mm_path_point_list.get ().size () >= 2) {
+        add_deferred_bbox (ll.second, path_bbox (mm_path_point_list.get (), mm_path_halfwidth.get (), mm_path_start_extension.get (), mm_path_end_extension.get (), false).moved (pos), true);
+      }
+
+    } else if (ll.first) {
 
       if (mm_path_point_list.get ().size () < 2) {
         warn (tl::to_string (tr ("POLYGON with less than 2 points ignored")));
@@ -2709,7 +3186,13 @@ OASISReader::do_read_path (bool xy_absolute, db::cell_index_type cell_index, db:
 
     std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
 
-    if (ll.first) {
+    if (m_skip_shapes) {
+
+      if (ll.first && mm_path_point_list.get ().size () >= 2) {
+        add_deferred_bbox (ll.second, path_bbox (mm_path_point_list.get (), mm_path_halfwidth.get (), mm_path_start_extension.get (), mm_path_end_extension.get (), false).moved (pos), false);
+      }
+
+    } else if (ll.first) {
 
       if (mm_path_point_list.get ().size () < 2) {
         warn (tl::to_string (tr ("PATH with less than 2 points ignored")));
@@ -2786,7 +3269,7 @@ OASISReader::do_read_trapezoid (unsigned char r, bool xy_absolute,db::cell_index
 
   db::Vector pos (mm_geometry_x.get (), mm_geometry_y.get ());
 
-  std::pair<bool, unsigned int> ll = open_dl (layout, LDPair (mm_layer.get (), mm_datatype.get ()), m_create_layers);
+  std::pair<bool, unsigned int> ll = open_shape_dl (layout, LDPair (mm_layer.get (), mm_datatype.get ()));
 
   db::Point pts [4];
 
@@ -2808,7 +3291,13 @@ OASISReader::do_read_trapezoid (unsigned char r, bool xy_absolute,db::cell_index
 
     std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
 
-    if (ll.first) {
+    if (m_skip_shapes) {
+
+      if (ll.first) {
+        add_deferred_bbox (ll.second, points_bbox (pts, pts + 4).moved (pos), true);
+      }
+
+    } else if (ll.first) {
 
       //  convert the OASIS record into the polygon.
       db::SimplePolygon poly;
@@ -2876,7 +3365,13 @@ OASISReader::do_read_trapezoid (unsigned char r, bool xy_absolute,db::cell_index
 
     std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
 
-    if (ll.first) {
+    if (m_skip_shapes) {
+
+      if (ll.first) {
+        add_deferred_bbox (ll.second, points_bbox (pts, pts + 4).moved (pos), false);
+      }
+
+    } else if (ll.first) {
 
       //  convert the OASIS record into the polygon.
       db::SimplePolygon poly;
@@ -2941,7 +3436,7 @@ OASISReader::do_read_ctrapezoid (bool xy_absolute,db::cell_index_type cell_index
 
   db::Vector pos (mm_geometry_x.get (), mm_geometry_y.get ());
 
-  std::pair<bool, unsigned int> ll = open_dl (layout, LDPair (mm_layer.get (), mm_datatype.get ()), m_create_layers);
+  std::pair<bool, unsigned int> ll = open_shape_dl (layout, LDPair (mm_layer.get (), mm_datatype.get ()));
 
   db::Point pts [4];
 
@@ -3168,7 +3663,13 @@ OASISReader::do_read_ctrapezoid (bool xy_absolute,db::cell_index_type cell_index
 
     std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
 
-    if (ll.first) {
+    if (m_skip_shapes) {
+
+      if (ll.first) {
+        add_deferred_bbox (ll.second, points_bbox (pts, pts + npts).moved (pos), true);
+      }
+
+    } else if (ll.first) {
 
       //  convert the OASIS record into the polygon.
       db::SimplePolygon poly;
@@ -3235,7 +3736,13 @@ OASISReader::do_read_ctrapezoid (bool xy_absolute,db::cell_index_type cell_index
 
     std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
 
-    if (ll.first) {
+    if (m_skip_shapes) {
+
+      if (ll.first) {
+        add_deferred_bbox (ll.second, points_bbox (pts, pts + npts).moved (pos), false);
+      }
+
+    } else if (ll.first) {
 
       //  convert the OASIS record into the polygon.
       db::SimplePolygon poly;
@@ -3292,7 +3799,7 @@ OASISReader::do_read_circle (bool xy_absolute, db::cell_index_type cell_index, d
 
   db::Vector pos (mm_geometry_x.get (), mm_geometry_y.get ());
 
-  std::pair<bool, unsigned int> ll = open_dl (layout, LDPair (mm_layer.get (), mm_datatype.get ()), m_create_layers);
+  std::pair<bool, unsigned int> ll = open_shape_dl (layout, LDPair (mm_layer.get (), mm_datatype.get ()));
 
   //  ignore this circle if the radius is zero
   if (mm_circle_radius.get () <= 0) {
@@ -3303,7 +3810,13 @@ OASISReader::do_read_circle (bool xy_absolute, db::cell_index_type cell_index, d
 
     std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
 
-    if (ll.first) {
+    if (m_skip_shapes) {
+
+      if (ll.first) {
+        add_deferred_bbox (ll.second, path_bbox (std::vector<db::Point> (1, db::Point ()), mm_circle_radius.get (), mm_circle_radius.get (), mm_circle_radius.get (), true).moved (pos), true);
+      }
+
+    } else if (ll.first) {
 
       //  convert the OASIS circle into a single-point path.
       db::Path path;
@@ -3371,7 +3884,13 @@ OASISReader::do_read_circle (bool xy_absolute, db::cell_index_type cell_index, d
 
     std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
 
-    if (ll.first) {
+    if (m_skip_shapes) {
+
+      if (ll.first) {
+        add_deferred_bbox (ll.second, path_bbox (std::vector<db::Point> (1, db::Point ()), mm_circle_radius.get (), mm_circle_radius.get (), mm_circle_radius.get (), true).moved (pos), false);
+      }
+
+    } else if (ll.first) {
 
       //  convert the OASIS circle into a single-point path.
       db::Path path;
@@ -3572,16 +4091,7 @@ OASISReader::do_read_cell (db::cell_index_type cell_index, db::Layout &layout)
 
     } else if (r == 34 /*CBLOCK*/) {
 
-      unsigned int type = get_uint ();
-      if (type != 0) {
-        error (tl::sprintf (tl::to_string (tr ("Invalid CBLOCK compression type %d")), type));
-      }
-
-      get_uint ();  // uncomp-byte-count - not needed
-      get_uint ();  // comp-byte-count - not needed
-
-      //  put the stream into deflating mode
-      m_stream.inflate ();
+      read_cblock ();
 
     } else {
       //  put the byte back into the stream
@@ -3591,6 +4101,16 @@ OASISReader::do_read_cell (db::cell_index_type cell_index, db::Layout &layout)
 
   }
 
+  if (m_skip_instances) {
+
+    //  loading the shapes of a deferred cell: the instances and cell properties are there already
+    m_instances.clear ();
+    m_instances_with_props.clear ();
+    m_cellname = "";
+    return;
+
+  }
+
   if (! cell_properties.empty ()) {
     layout.cell (cell_index).prop_id (layout.properties_repository ().properties_id (cell_properties));
   }
@@ -3618,5 +4138,221 @@ OASISReader::do_read_cell (db::cell_index_type cell_index, db::Layout &layout)
   m_cellname = "";
 }
 
+bool
+OASISReader::has_deferred_cells () const
+{
+  for (std::map <db::cell_index_type, DeferredCellBody>::const_iterator dc = m_deferred_cells.begin (); dc != m_deferred_cells.end (); ++dc) {
+    if (! dc->second.loaded) {
+      return true;
+    }
+  }
+  return false;
 }
 
+bool
+OASISReader::is_deferred_cell (db::cell_index_type cell_index) const
+{
+  std::map <db::cell_index_type, DeferredCellBody>::const_iterator dc = m_deferred_cells.find (cell_index);
+  return dc != m_deferred_cells.end () && ! dc->second.loaded;
+}
+
+void
+OASISReader::load_cell (db::Layout &layout, db::cell_index_type cell_index)
+{
+  std::set<db::cell_index_type> cells;
+  cells.insert (cell_index);
+  layout.load_deferred_cells (cells);
+}
+
+void
+OASISReader::load_cell_tree (db::Layout &layout, db::cell_index_type cell_index)
+{
+  std::set<db::cell_index_type> cells;
+  cells.insert (cell_index);
+  layout.cell (cell_index).collect_called_cells (cells);
+  layout.load_deferred_cells (cells);
+}
+
+void
+OASISReader::load_all_cells (db::Layout &layout)
+{
+  std::set<db::cell_index_type> cells;
+  for (std::map <db::cell_index_type, DeferredCellBody>::const_iterator dc = m_deferred_cells.begin (); dc != m_deferred_cells.end (); ++dc) {
+    if (! dc->second.loaded) {
+      cells.insert (dc->first);
+    }
+  }
+  layout.load_deferred_cells (cells);
+}
+
+void
+OASISReader::load_deferred_cells (db::Layout &layout, const std::set<db::cell_index_type> &cells)
+{
+  load_cells (layout, cells);
+}
+
+const std::map<unsigned int, db::Box> *
+OASISReader::deferred_bboxes (db::cell_index_type cell_index) const
+{
+  std::map <db::cell_index_type, DeferredCellBody>::const_iterator dc = m_deferred_cells.find (cell_index);
+  return dc != m_deferred_cells.end () ? &dc->second.bboxes : 0;
+}
+
+void
+OASISReader::attach_deferred_cells (db::Layout &layout)
+{
+  if (m_deferred_cells.empty ()) {
+    return;
+  }
+
+  //  from now on, the layout asks us for the shapes when a cell is accessed
+  mp_deferred_layout.reset (&layout);
+  layout.set_deferred_cell_loader (this);
+
+  for (std::map <db::cell_index_type, DeferredCellBody>::const_iterator dc = m_deferred_cells.begin (); dc != m_deferred_cells.end (); ++dc) {
+    if (layout.is_valid_cell_index (dc->first)) {
+      layout.cell (dc->first).set_deferred_shapes (true);
+    }
+  }
+}
+
+void
+OASISReader::detach_deferred_cells ()
+{
+  if (mp_deferred_layout.get () && mp_deferred_layout->deferred_cell_loader () == this) {
+    mp_deferred_layout->set_deferred_cell_loader (0);
+  }
+
+  mp_deferred_layout.reset (0);
+  m_deferred_cells.clear ();
+}
+
+void
+OASISReader::add_deferred_bbox (unsigned int layer, const db::Box &box, bool with_repetition)
+{
+  if (! mp_deferred_bboxes || box.empty ()) {
+    return;
+  }
+
+  db::Box bbox = box;
+
+  if (with_repetition) {
+
+    db::Vector a, b;
+    size_t na = 0, nb = 0;
+    if (mm_repetition.get ().is_regular (a, b, na, nb)) {
+
+      //  for a regular array, the corners are sufficient
+      if (na > 0 && nb > 0) {
+        db::Vector va (a.x () * db::Coord (na - 1), a.y () * db::Coord (na - 1));
+        db::Vector vb (b.x () * db::Coord (nb - 1), b.y () * db::Coord (nb - 1));
+        bbox += box.moved (va);
+        bbox += box.moved (vb);
+        bbox += box.moved (va + vb);
+      }
+
+    } else {
+
+      for (RepetitionIterator p = mm_repetition.get ().begin (); ! p.at_end (); ++p) {
+        bbox += box.moved (*p);
+      }
+
+    }
+
+  }
+
+  (*mp_deferred_bboxes) [layer] += bbox;
+}
+
+void
+OASISReader::load_cells (db::Layout &layout, const std::set<db::cell_index_type> &cells)
+{
+  //  load in the order of the cell bodies in the stream, so we don't need to go back
+  //  NOTE: the entries are not erased as other threads may read the deferred bounding boxes
+  std::vector<std::pair<DeferredCellBody, db::cell_index_type> > bodies;
+  for (std::set<db::cell_index_type>::const_iterator c = cells.begin (); c != cells.end (); ++c) {
+    std::map <db::cell_index_type, DeferredCellBody>::iterator dc = m_deferred_cells.find (*c);
+    if (dc != m_deferred_cells.end () && ! dc->second.loaded) {
+      bodies.push_back (std::make_pair (DeferredCellBody (dc->second.pos, dc->second.in_cblock, dc->second.inflated_pos), dc->first));
+      dc->second.loaded = true;
+    }
+  }
+
+  if (bodies.empty ()) {
+    return;
+  }
+
+  std::sort (bodies.begin (), bodies.end ());
+
+  m_skip_instances = true;
+
+  try {
+
+    for (std::vector<std::pair<DeferredCellBody, db::cell_index_type> >::const_iterator b = bodies.begin (); b != bodies.end (); ++b) {
+
+      const DeferredCellBody &body = b->first;
+
+      if (body.in_cblock) {
+
+        //  continue inflating if the body is further down in the current CBLOCK, otherwise
+        //  position on the CBLOCK and start inflating again
+        if (! m_stream.is_inflating () || m_cblock_pos != body.pos || m_stream.inflated_pos () > body.inflated_pos) {
+          seek (body.pos);
+          read_cblock ();
+        }
+
+        skip_inflated (body.inflated_pos - m_stream.inflated_pos ());
+
+      } else {
+        seek (body.pos);
+      }
+
+      reset_modal_variables ();
+      do_read_cell (b->second, layout);
+    }
+
+    m_skip_instances = false;
+
+  } catch (...) {
+    m_skip_instances = false;
+    throw;
+  }
+}
+
+void
+OASISReader::skip_inflated (size_t n)
+{
+  //  the inflate filter delivers limited chunks only
+  const size_t chunk_size = 16384;
+
+  while (n > 0) {
+    size_t nn = std::min (n, chunk_size);
+    if (! m_stream.get (nn)) {
+      error (tl::to_string (tr ("Unexpected end-of-file")));
+    }
+    n -= nn;
+  }
+}
+
+void
+OASISReader::seek (size_t pos)
+{
+  if (m_stream.is_inflating () || m_stream.pos () > pos) {
+    m_stream.reset ();
+  }
+
+  //  without direct access, skip in chunks to keep the buffer small
+  const size_t chunk_size = 65536;
+
+  while (m_stream.pos () < pos) {
+    size_t n = pos - m_stream.pos ();
+    if (! m_stream.is_direct ()) {
+      n = std::min (n, chunk_size);
+    }
+    if (! m_stream.get (n, true)) {
+      error (tl::to_string (tr ("Unexpected end-of-file")));
+    }
+  }
+}
+
+}
@@ -46,6 +46,8 @@
 namespace db
 {
 
+class OASISCBlockPrefetcher;
+
 /**
  *  @brief Generic base class of OASIS reader exceptions
  */
@@ -58,12 +60,47 @@ public:
   { }
 };
 
+/**
+ *  @brief Describes the location of a cell body whose shapes are loaded later
+ *
+ *  If the cell body is located inside a CBLOCK, "pos" is the position of the
+ *  CBLOCK in the stream and "inflated_pos" is the offset of the cell body
+ *  within the inflated data. Otherwise "pos" is the position of the cell body.
+ *  "bboxes" holds the per-layer bounding boxes of the shapes in the cell body.
+ *  "loaded" is set once the shapes have been loaded.
+ */
+struct DeferredCellBody
+{
+  DeferredCellBody ()
+    : pos (0), in_cblock (false), inflated_pos (0), loaded (false)
+  { }
+
+  DeferredCellBody (size_t _pos, bool _in_cblock, size_t _inflated_pos)
+    : pos (_pos), in_cblock (_in_cblock), inflated_pos (_inflated_pos), loaded (false)
+  { }
+
+  bool operator< (const DeferredCellBody &other) const
+  {
+    if (pos != other.pos) {
+      return pos < other.pos;
+    }
+    return inflated_pos < other.inflated_pos;
+  }
+
+  size_t pos;
+  bool in_cblock;
+  size_t inflated_pos;
+  bool loaded;
+  std::map<unsigned int, db::Box> bboxes;
+};
+
 /**
  *  @brief The OASIS format stream reader
  */
 class DB_PLUGIN_PUBLIC OASISReader
   : public ReaderBase, 
-    public OASISDiagnostics
+    public OASISDiagnostics,
+    public DeferredCellLoader
 {
 public: 
   typedef std::vector<tl::Variant> property_value_list;
@@ -118,6 +155,45 @@ public:
    */
   virtual const char *format () const { return "OASIS"; }
 
+  /**
+   *  @brief Returns true, if there are cells whose shapes have not been loaded yet
+   *
+   *  Cells are not loaded initially if the "lazy_loading" option is set.
+   */
+  virtual bool has_deferred_cells () const;
+
+  /**
+   *  @brief Returns true, if the shapes of the given cell have not been loaded yet
+   */
+  virtual bool is_deferred_cell (db::cell_index_type cell_index) const;
+
+  /**
+   *  @brief Loads the shapes of the given cell if they have not been loaded yet
+   *
+   *  The layout needs to be the one the reader has read into with "lazy_loading" enabled.
+   */
+  virtual void load_cell (db::Layout &layout, db::cell_index_type cell_index);
+
+  /**
+   *  @brief Loads the shapes of the given cell and all cells called by it
+   */
+  virtual void load_cell_tree (db::Layout &layout, db::cell_index_type cell_index);
+
+  /**
+   *  @brief Loads the shapes of all cells not loaded yet
+   */
+  virtual void load_all_cells (db::Layout &layout);
+
+  /**
+   *  @brief Implementation of DeferredCellLoader: loads the shapes of the given cells
+   */
+  virtual void load_deferred_cells (db::Layout &layout, const std::set<db::cell_index_type> &cells);
+
+  /**
+   *  @brief Implementation of DeferredCellLoader: gets the bounding boxes of the shapes not loaded yet
+   */
+  virtual const std::map<unsigned int, db::Box> *deferred_bboxes (db::cell_index_type cell_index) const;
+
   /**
    *  @brief Issue an error with positional information
    *
@@ -212,6 +288,15 @@ private:
   bool m_read_texts;
   bool m_read_properties;
   bool m_read_all_properties;
+  int m_read_threads;
+  OASISCBlockPrefetcher *mp_cblock_prefetcher;
+  bool m_lazy_loading;
+  bool m_skip_shapes;
+  bool m_skip_instances;
+  size_t m_cblock_pos;
+  std::map <db::cell_index_type, DeferredCellBody> m_deferred_cells;
+  std::map <unsigned int, db::Box> *mp_deferred_bboxes;
+  tl::weak_ptr<db::Layout> mp_deferred_layout;
 
   std::set <unsigned long> m_defined_cells_by_id;
   std::set <std::string> m_defined_cells_by_name;
@@ -224,6 +309,12 @@ private:
 
   void do_read (db::Layout &layout);
   void do_read_cell (db::cell_index_type cell_index, db::Layout &layout);
+  void load_cells (db::Layout &layout, const std::set<db::cell_index_type> &cells);
+  void seek (size_t pos);
+  void skip_inflated (size_t n);
+  void add_deferred_bbox (unsigned int layer, const db::Box &box, bool with_repetition);
+  void attach_deferred_cells (db::Layout &layout);
+  void detach_deferred_cells ();
 
   void do_read_placement (unsigned char r,
                           bool xy_absolute,
@@ -245,6 +336,7 @@ private:
   void mark_start_table ();
 
   void read_offset_table ();
+  void read_cblock ();
   bool read_repetition ();
   void read_pointlist (modal_variable <std::vector <db::Point> > &pointlist, bool for_polygon);
   void read_properties (db::PropertiesRepository &rep);
@@ -316,6 +408,11 @@ private:
   distance_type get_ucoord_as_distance (unsigned long grid = 1);
 
   std::pair <bool, unsigned int> open_dl (db::Layout &layout, const LDPair &dl, bool create);
+
+  std::pair <bool, unsigned int> open_shape_dl (db::Layout &layout, const LDPair &dl)
+  {
+    return open_dl (layout, dl, m_create_layers);
+  }
 };
 
 }
@@ -26,8 +26,10 @@
 
 #include "tlDeflate.h"
 #include "tlMath.h"
+#include "tlThreadedWorkers.h"
 
 #include <math.h>
+#include <list>
 
 namespace db
 {
@@ -657,6 +659,295 @@ Compressor<Obj>::flush (db::OASISWriter *writer)
   }
 }
 
+// ---------------------------------------------------------------------------------
+//  OASISCBlockCompressor definition and implementation
+
+// 1M CBLOCK buffer size
+const size_t cblock_buffer_size = 1024 * 1024;
+
+/**
+ *  @brief A piece of output held back by the CBLOCK compressor
+ *
+ *  A segment is either a CBLOCK body which is compressed in the background or
+ *  plain bytes which are written as they are once the preceding segments are done.
+ */
+struct OASISCBlockSegment
+{
+  OASISCBlockSegment (bool _is_cblock)
+    : is_cblock (_is_cblock), uncomp_bytes (0), done (! _is_cblock)
+  {
+    //  .. nothing yet ..
+  }
+
+  bool is_cblock;
+  size_t uncomp_bytes;
+  std::vector<char> data;
+  std::vector<size_t *> positions;
+  std::string error;
+  bool done;
+};
+
+/**
+ *  @brief The task for compressing one CBLOCK
+ */
+class OASISCBlockCompressTask
+  : public tl::Task
+{
+public:
+  OASISCBlockCompressTask (OASISCBlockCompressor *compressor, OASISCBlockSegment *segment)
+    : mp_compressor (compressor), mp_segment (segment)
+  {
+    //  .. nothing yet ..
+  }
+
+  void perform ();
+
+private:
+  OASISCBlockCompressor *mp_compressor;
+  OASISCBlockSegment *mp_segment;
+
+  static void write_uint (std::vector<char> &buffer, unsigned long long n);
+};
+
+/**
+ *  @brief The worker for compressing CBLOCKs
+ */
+class OASISCBlockCompressWorker
+  : public tl::Worker
+{
+public:
+  OASISCBlockCompressWorker ()
+    : tl::Worker ()
+  {
+    //  .. nothing yet ..
+  }
+
+  void perform_task (tl::Task *task)
+  {
+    static_cast<OASISCBlockCompressTask *> (task)->perform ();
+  }
+};
+
+/**
+ *  @brief A pipelined CBLOCK compressor
+ *
+ *  The writer hands over the CBLOCK bodies to this object which has them deflated
+ *  by worker threads while the writer continues with the next cell. Bytes written
+ *  outside CBLOCKs are queued behind the pending blocks, so the output is written
+ *  in the original order. Stream positions requested while data is held back are
+ *  filled in when the corresponding output is written.
+ */
+class OASISCBlockCompressor
+{
+public:
+  OASISCBlockCompressor (tl::OutputStream &stream, int threads)
+    : mp_stream (&stream), m_job (threads), m_pending_bytes (0),
+      m_max_pending_bytes (size_t (threads) * 4 * cblock_buffer_size)
+  {
+    //  .. nothing yet ..
+  }
+
+  ~OASISCBlockCompressor ()
+  {
+    //  stops the workers before the segments are deleted
+    m_job.stop ();
+
+    for (std::list<OASISCBlockSegment *>::const_iterator s = m_segments.begin (); s != m_segments.end (); ++s) {
+      delete *s;
+    }
+    m_segments.clear ();
+  }
+
+  /**
+   *  @brief Writes plain bytes
+   */
+  void put (const char *b, size_t n)
+  {
+    if (m_segments.empty ()) {
+      mp_stream->put (b, n);
+    } else {
+      if (m_segments.back ()->is_cblock) {
+        m_segments.push_back (new OASISCBlockSegment (false));
+      }
+      m_segments.back ()->data.insert (m_segments.back ()->data.end (), b, b + n);
+    }
+  }
+
+  /**
+   *  @brief Delivers the stream position of the next byte written into "pos"
+   *
+   *  If output is held back, the position is delivered later, but latest on "flush".
+   */
+  void tell (size_t &pos)
+  {
+    if (m_segments.empty ()) {
+      pos = mp_stream->pos ();
+    } else {
+      if (m_segments.back ()->is_cblock || ! m_segments.back ()->data.empty ()) {
+        m_segments.push_back (new OASISCBlockSegment (false));
+      }
+      m_segments.back ()->positions.push_back (&pos);
+    }
+  }
+
+  /**
+   *  @brief Schedules a CBLOCK body for compression
+   */
+  void add_cblock (const char *data, size_t n)
+  {
+    OASISCBlockSegment *segment = new OASISCBlockSegment (true);
+    segment->data.assign (data, data + n);
+    segment->uncomp_bytes = n;
+    m_segments.push_back (segment);
+    m_pending_bytes += n;
+
+    m_job.schedule (new OASISCBlockCompressTask (this, segment));
+    if (! m_job.is_running ()) {
+      m_job.start ();
+    }
+
+    //  write what is available already and limit the amount of data held back
+    flush (false);
+  }
+
+  /**
+   *  @brief Writes the segments finished so far
+   *
+   *  If "all" is true, this method waits for all pending blocks and writes them.
+   */
+  void flush (bool all)
+  {
+    while (! m_segments.empty ()) {
+
+      OASISCBlockSegment *segment = m_segments.front ();
+
+      if (all || m_pending_bytes > m_max_pending_bytes) {
+        wait_for (segment);
+      } else if (! is_done (segment)) {
+        break;
+      }
+
+      if (! segment->error.empty ()) {
+        throw tl::Exception (segment->error);
+      }
+
+      for (std::vector<size_t *>::const_iterator p = segment->positions.begin (); p != segment->positions.end (); ++p) {
+        **p = mp_stream->pos ();
+      }
+
+      //  Reasoning for if(...): we don't want to access data from an empty vector through data()
+      if (! segment->data.empty ()) {
+        mp_stream->put (segment->data.data (), segment->data.size ());
+      }
+
+      if (segment->is_cblock) {
+        m_pending_bytes -= segment->uncomp_bytes;
+      }
+
+      m_segments.pop_front ();
+      delete segment;
+
+    }
+  }
+
+  /**
+   *  @brief Called by the worker when a block has been compressed
+   */
+  void block_done (OASISCBlockSegment *segment)
+  {
+    tl::MutexLocker locker (&m_lock);
+    segment->done = true;
+    m_done_condition.wakeAll ();
+  }
+
+private:
+  tl::OutputStream *mp_stream;
+  tl::Job<OASISCBlockCompressWorker> m_job;
+  std::list<OASISCBlockSegment *> m_segments;
+  size_t m_pending_bytes, m_max_pending_bytes;
+  tl::Mutex m_lock;
+  tl::WaitCondition m_done_condition;
+
+  bool is_done (OASISCBlockSegment *segment)
+  {
+    tl::MutexLocker locker (&m_lock);
+    return segment->done;
+  }
+
+  void wait_for (OASISCBlockSegment *segment)
+  {
+    tl::MutexLocker locker (&m_lock);
+    while (! segment->done) {
+      m_done_condition.wait (&m_lock);
+    }
+  }
+};
+
+void
+OASISCBlockCompressTask::perform ()
+{
+  try {
+
+    tl::OutputMemoryStream compressed;
+
+    {
+      tl::OutputStream deflated_stream (compressed);
+      tl::DeflateFilter deflate (deflated_stream);
+
+      //  Reasoning for if(...): we don't want to access data from an empty vector through data()
+      if (! mp_segment->data.empty ()) {
+        deflate.put (mp_segment->data.data (), mp_segment->data.size ());
+      }
+
+      deflate.flush ();
+    }
+
+    //  same decision as in OASISWriter::end_cblock: keep the block uncompressed if that is shorter
+    const size_t compression_overhead = 4;
+
+    if (mp_segment->data.size () > compressed.size () + compression_overhead) {
+
+      std::vector<char> cblock;
+      cblock.reserve (compressed.size () + 32);
+
+      cblock.push_back (34);  // CBLOCK
+
+      //  RFC1951 compression:
+      cblock.push_back (0);
+
+      write_uint (cblock, mp_segment->data.size ());
+      write_uint (cblock, compressed.size ());
+
+      cblock.insert (cblock.end (), compressed.data (), compressed.data () + compressed.size ());
+
+      mp_segment->data.swap (cblock);
+
+    }
+
+  } catch (tl::Exception &ex) {
+    mp_segment->error = ex.msg ();
+  } catch (std::exception &ex) {
+    mp_segment->error = ex.what ();
+  } catch (...) {
+    mp_segment->error = tl::to_string (tr ("Unspecific error while compressing CBLOCK"));
+  }
+
+  mp_compressor->block_done (mp_segment);
+}
+
+void
+OASISCBlockCompressTask::write_uint (std::vector<char> &buffer, unsigned long long n)
+{
+  do {
+    unsigned char b = n & 0x7f;
+    n >>= 7;
+    if (n > 0) {
+      b |= 0x80;
+    }
+    buffer.push_back ((char) b);
+  } while (n > 0);
+}
+
 // ---------------------------------------------------------------------------------
 //  OASISWriter implementation
 
@@ -667,17 +958,27 @@ OASISWriter::OASISWriter ()
     mp_cell (0),
     m_layer (0), m_datatype (0),
     m_in_cblock (false),
+    mp_cblock_compressor (0),
     m_propname_id (0),
     m_propstring_id (0),
     m_proptables_written (false),
+    m_streaming (false),
+    m_cellnames_table_pos (0),
+    m_textstrings_table_pos (0),
+    m_propnames_table_pos (0),
+    m_propstrings_table_pos (0),
+    m_layernames_table_pos (0),
     m_progress (tl::to_string (tr ("Writing OASIS file")), 10000)
 {
   m_progress.set_format (tl::to_string (tr ("%.0f MB")));
   m_progress.set_unit (1024 * 1024);
 }
 
-// 1M CBLOCK buffer size
-const size_t cblock_buffer_size = 1024 * 1024;
+OASISWriter::~OASISWriter ()
+{
+  delete mp_cblock_compressor;
+  mp_cblock_compressor = 0;
+}
 
 void 
 OASISWriter::write_record_id (char b)
@@ -688,6 +989,8 @@ OASISWriter::write_record_id (char b)
       begin_cblock ();
     } 
     m_cblock_buffer.write ((const char *) &b, 1);
+  } else if (mp_cblock_compressor) {
+    mp_cblock_compressor->put ((const char *) &b, 1);
   } else {
     mp_stream->put ((const char *) &b, 1);
   }
@@ -698,6 +1001,8 @@ OASISWriter::write_byte (char b)
 {
   if (m_in_cblock) {
     m_cblock_buffer.write ((const char *) &b, 1);
+  } else if (mp_cblock_compressor) {
+    mp_cblock_compressor->put ((const char *) &b, 1);
   } else {
     mp_stream->put ((const char *) &b, 1);
   }
@@ -708,6 +1013,8 @@ OASISWriter::write_bytes (const char *b, size_t n)
 {
   if (m_in_cblock) {
     m_cblock_buffer.write (b, n);
+  } else if (mp_cblock_compressor) {
+    mp_cblock_compressor->put (b, n);
   } else {
     mp_stream->put (b, n);
   }
@@ -1066,6 +1373,18 @@ OASISWriter::end_cblock ()
 {
   tl_assert (m_in_cblock);
 
+  if (mp_cblock_compressor) {
+
+    //  pipelined mode: the compressor takes care of the CBLOCK
+    m_in_cblock = false;
+    if (m_cblock_buffer.size () > 0) {
+      mp_cblock_compressor->add_cblock (m_cblock_buffer.data (), m_cblock_buffer.size ());
+    }
+    m_cblock_buffer.clear ();
+    return;
+
+  }
+
   m_cblock_compressed.clear ();
   tl::OutputStream deflated_stream (m_cblock_compressed);
   tl::DeflateFilter deflate (deflated_stream);
@@ -1150,17 +1469,18 @@ OASISWriter::reset_modal_variables ()
   mm_last_value_list.reset ();
 }
 
-void 
-OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options)
+double
+OASISWriter::prepare_write (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options)
 {
-  typedef db::coord_traits<db::Coord>::distance_type coord_distance_type;
-
   mp_layout = &layout;
   mp_cell = 0;
   m_layer = m_datatype = 0;
   m_in_cblock = false;
   m_cblock_buffer.clear ();
 
+  delete mp_cblock_compressor;
+  mp_cblock_compressor = 0;
+
   m_options = options.get_options<OASISWriterOptions> ();
   mp_stream = &stream;
 
@@ -1171,6 +1491,56 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
     m_sf = 1.0;
   }
 
+  m_streaming = false;
+
+  m_cellnames_table_pos = 0;
+  m_textstrings_table_pos = 0;
+  m_propnames_table_pos = 0;
+  m_propstrings_table_pos = 0;
+  m_layernames_table_pos = 0;
+  m_cell_positions.clear ();
+
+  //  Prepare name tables
+
+  m_textstrings.clear ();
+  m_propnames.clear ();
+  m_propstrings.clear ();
+
+  m_propstring_id = m_propname_id = 0;
+  m_proptables_written = false;
+
+  return dbu;
+}
+
+void
+OASISWriter::write_start_record (double dbu, bool offsets_at_end)
+{
+  char magic[] = "%SEMI-OASIS\015\012";
+  write_bytes (magic, sizeof (magic) - 1);
+
+  //  START record
+  write_record_id (1); 
+  write_bstring ("1.0");
+  write (1.0 / dbu);
+  write_byte (offsets_at_end ? 1 : 0);  //  offset-flag (1: at the end, 0: at the beginning)
+
+  if (! offsets_at_end) {
+
+    //  offset table:
+    for (unsigned int i = 0; i < 12; ++i) {
+      write_byte (0);
+    }
+
+  }
+}
+
+void 
+OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options)
+{
+  typedef db::coord_traits<db::Coord>::distance_type coord_distance_type;
+
+  double dbu = prepare_write (layout, stream, options);
+
   std::vector <std::pair <unsigned int, db::LayerProperties> > layers;
   options.get_valid_layers (layout, layers, db::SaveLayoutOptions::LP_AssignNumber);
 
@@ -1197,47 +1567,12 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
 
   //  write header
 
-  char magic[] = "%SEMI-OASIS\015\012";
-  write_bytes (magic, sizeof (magic) - 1);
-
-  //  START record
-  write_record_id (1); 
-  write_bstring ("1.0");
-  write (1.0 / dbu);
-  write_byte (m_options.strict_mode ? 1 : 0);  //  offset-flag (strict mode: at the end, non-strict mode: at the beginning)
-
-  size_t cellnames_table_pos = 0;
-  size_t textstrings_table_pos = 0;
-  size_t propnames_table_pos = 0;
-  size_t propstrings_table_pos = 0;
-  size_t layernames_table_pos = 0;
-  std::map<db::cell_index_type, size_t> cell_positions;
-
-  if (! m_options.strict_mode) {
-
-    //  offset table:
-    for (unsigned int i = 0; i < 12; ++i) {
-      write_byte (0);
-    }
-
-  }
+  write_start_record (dbu, m_options.strict_mode);
 
   //  Reset the global variables
 
   reset_modal_variables ();
 
-  //  Prepare name tables
- 
-  m_textstrings.clear ();
-  m_propnames.clear ();
-  m_propstrings.clear ();
-
-  //  We will collect the standard properties here:
-  
-  m_propstring_id = m_propname_id = 0;
-  m_proptables_written = false;
-  std::vector<std::pair<std::string, unsigned int> > init_props;
-
   //  write file properties (must happen before any other PROPNAME record since formally the
   //  PROPERTY records are associated with the names rather than the file)
 
@@ -1301,7 +1636,7 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
 
     for (std::vector<std::pair<unsigned long, std::string> >::const_iterator p = rev_pn.begin (); p != rev_pn.end (); ++p) {
       tl_assert (p->first == (unsigned long)(p - rev_pn.begin ()));
-      begin_table (propnames_table_pos);
+      begin_table (m_propnames_table_pos);
       write_record_id (7);
       write_nstring (p->second.c_str ());
     }
@@ -1315,14 +1650,14 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
       const db::Cell &cref (layout.cell (*cell));
 
       if (cref.prop_id () != 0) {
-        begin_table (propnames_table_pos);
+        begin_table (m_propnames_table_pos);
         emit_propname_def (cref.prop_id ());
       }
 
       for (db::Cell::const_iterator inst = cref.begin (); ! inst.at_end (); ++inst) {
         if (inst->has_prop_id () && inst->prop_id () != 0 && prop_ids_done.find (inst->prop_id ()) == prop_ids_done.end ()) {
           prop_ids_done.insert (inst->prop_id ());
-          begin_table (propnames_table_pos);
+          begin_table (m_propnames_table_pos);
           emit_propname_def (inst->prop_id ());
           m_progress.set (mp_stream->pos ());
         }
@@ -1333,7 +1668,7 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
         while (! shape.at_end ()) {
           if (shape->has_prop_id () && shape->prop_id () != 0 && prop_ids_done.find (shape->prop_id ()) == prop_ids_done.end ()) {
             prop_ids_done.insert (shape->prop_id ());
-            begin_table (propnames_table_pos);
+            begin_table (m_propnames_table_pos);
             emit_propname_def (shape->prop_id ());
             m_progress.set (mp_stream->pos ());
           }
@@ -1353,7 +1688,7 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
         if (cref.is_proxy () && ! cref.is_top () && layout.get_context_info (*cell, context_prop_strings)) {
 
           if (m_propnames.insert (std::make_pair (std::string (klayout_context_name), m_propname_id)).second) {
-            begin_table (propnames_table_pos);
+            begin_table (m_propnames_table_pos);
             write_record_id (7);
             write_nstring (klayout_context_name);
             ++m_propname_id;
@@ -1366,7 +1701,7 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
 
     }
 
-    end_table (propnames_table_pos);
+    end_table (m_propnames_table_pos);
 
   }
 
@@ -1383,7 +1718,7 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
 
     for (std::vector<std::pair<unsigned long, std::string> >::const_iterator p = rev_ps.begin (); p != rev_ps.end (); ++p) {
       tl_assert (p->first == (unsigned long)(p - rev_ps.begin ()));
-      begin_table (propstrings_table_pos);
+      begin_table (m_propstrings_table_pos);
       write_record_id (9);
       write_nstring (p->second.c_str ());
     }
@@ -1398,14 +1733,14 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
 
       if (cref.prop_id () != 0 && prop_ids_done.find (cref.prop_id ()) == prop_ids_done.end ()) {
         prop_ids_done.insert (cref.prop_id ());
-        begin_table (propnames_table_pos);
+        begin_table (m_propnames_table_pos);
         emit_propstring_def (cref.prop_id ());
       }
 
       for (db::Cell::const_iterator inst = cref.begin (); ! inst.at_end (); ++inst) {
         if (inst->has_prop_id () && inst->prop_id () != 0 && prop_ids_done.find (inst->prop_id ()) == prop_ids_done.end ()) {
           prop_ids_done.insert (inst->prop_id ());
-          begin_table (propstrings_table_pos);
+          begin_table (m_propstrings_table_pos);
           emit_propstring_def (inst->prop_id ());
           m_progress.set (mp_stream->pos ());
         }
@@ -1416,7 +1751,7 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
         while (! shape.at_end ()) {
           if (shape->has_prop_id () && shape->prop_id () != 0 && prop_ids_done.find (shape->prop_id ()) == prop_ids_done.end ()) {
             prop_ids_done.insert (shape->prop_id ());
-            begin_table (propstrings_table_pos);
+            begin_table (m_propstrings_table_pos);
             emit_propstring_def (shape->prop_id ());
             m_progress.set (mp_stream->pos ());
           }
@@ -1442,7 +1777,7 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
 
             for (std::vector <std::string>::const_iterator c = context_prop_strings.begin (); c != context_prop_strings.end (); ++c) {
               if (m_propstrings.insert (std::make_pair (*c, m_propstring_id)).second) {
-                begin_table (propstrings_table_pos);
+                begin_table (m_propstrings_table_pos);
                 write_record_id (9);
                 write_bstring (c->c_str ());
                 ++m_propstring_id;
@@ -1457,7 +1792,7 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
 
     }
 
-    end_table (propstrings_table_pos);
+    end_table (m_propstrings_table_pos);
 
   }
 
@@ -1468,56 +1803,7 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
   //  end because then we have the cell positions fo S_CELL_OFFSET)
 
   if (! m_options.strict_mode) {
-
-    size_t pos = 0;
-
-    bool sequential = true;
-    for (std::vector<db::cell_index_type>::const_iterator cell = cells_by_index.begin (); cell != cells_by_index.end () && sequential; ++cell) {
-      sequential = (*cell == db::cell_index_type (cell - cells_by_index.begin ()));
-    }
-
-    //  CELLNAME (implicit or explicit)
-    for (std::vector<db::cell_index_type>::const_iterator cell = cells_by_index.begin (); cell != cells_by_index.end (); ++cell) {
-
-      begin_table (pos);
-
-      write_record_id (sequential ? 3 : 4);
-      write_nstring (layout.cell_name (*cell));
-      if (! sequential) {
-        write ((unsigned long) *cell);
-      }
-
-      if (m_options.write_std_properties > 1) {
-
-        reset_modal_variables ();
-
-        //  write S_BOUNDING_BOX entries
-
-        std::vector<tl::Variant> values;
-
-        //  TODO: how to set the "depends on external cells" flag?
-        db::Box bbox = layout.cell (*cell).bbox ();
-        if (bbox.empty ()) {
-          //  empty box 
-          values.push_back (tl::Variant ((unsigned int) 0x2)); 
-          bbox = db::Box (0, 0, 0, 0);
-        } else {
-          values.push_back (tl::Variant ((unsigned int) 0x0)); 
-        }
-
-        values.push_back (tl::Variant (bbox.left ())); 
-        values.push_back (tl::Variant (bbox.bottom ())); 
-        values.push_back (tl::Variant (bbox.width ()));
-        values.push_back (tl::Variant (bbox.height ()));
-
-        write_property_def (s_bounding_box_name, values, true);
-
-      }
-
-    }
-
-    end_table (pos);
-
+    write_cellnames (cells_by_index, m_options.write_std_properties > 1, false);
   }
 
   //  build text string table
@@ -1533,7 +1819,7 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
         db::ShapeIterator shape (cref.shapes (l->first).begin (db::ShapeIterator::Texts));
         while (! shape.at_end ()) {
           if (m_textstrings.insert (std::make_pair (shape->text_string (), id)).second) {
-            begin_table (textstrings_table_pos);
+            begin_table (m_textstrings_table_pos);
             write_record_id (5);
             write_astring (shape->text_string ());
             ++id;
@@ -1545,182 +1831,194 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
 
     }
 
-    end_table (textstrings_table_pos);
+    end_table (m_textstrings_table_pos);
 
   }
 
   //  write layernames table
 
-  {
-
-    for (std::vector <std::pair <unsigned int, db::LayerProperties> >::const_iterator l = layers.begin (); l != layers.end (); ++l) {
-
-      if (! l->second.name.empty ()) {
-
-        begin_table (layernames_table_pos);
-
-        //  write mappings to text layer and shape layers
-        write_record_id (11);
-        write_nstring (l->second.name.c_str ());
-        write_byte (3);
-        write ((unsigned long) l->second.layer);
-        write_byte (3);
-        write ((unsigned long) l->second.datatype);
-
-        write_record_id (12);
-        write_nstring (l->second.name.c_str ());
-        write_byte (3);
-        write ((unsigned long) l->second.layer);
-        write_byte (3);
-        write ((unsigned long) l->second.datatype);
-
-        m_progress.set (mp_stream->pos ());
+  write_layernames (layers);
 
-      }
+  //  compress the cell CBLOCKs in the background if requested
+  if (m_options.write_cblocks && m_options.write_threads > 0) {
+    mp_cblock_compressor = new OASISCBlockCompressor (*mp_stream, m_options.write_threads);
+  }
 
-    }
+  for (std::vector<db::cell_index_type>::const_iterator cell = cells.begin (); cell != cells.end (); ++cell) {
+    write_cell (*cell, layers, &cell_set, options.write_context_info ());
+  }
 
-    end_table (layernames_table_pos);
+  if (mp_cblock_compressor) {
+    mp_cblock_compressor->flush (true);
+    delete mp_cblock_compressor;
+    mp_cblock_compressor = 0;
+  }
 
+  //  write cell table at the end in strict mode (in that mode we need the cell positions
+  //  for the S_CELL_OFFSET properties)
+  
+  if (m_options.strict_mode) {
+    write_cellnames (cells_by_index, m_options.write_std_properties > 1, true);
   }
 
-  std::vector <std::string> context_prop_strings;
+  write_end_record (m_options.strict_mode);
+}
 
-  for (std::vector<db::cell_index_type>::const_iterator cell = cells.begin (); cell != cells.end (); ++cell) {
+void
+OASISWriter::write_cell (db::cell_index_type cell_index, const std::vector <std::pair <unsigned int, db::LayerProperties> > &layers, const std::set <db::cell_index_type> *cell_set, bool write_context_info)
+{
+  m_progress.set (mp_stream->pos ());
 
-    m_progress.set (mp_stream->pos ());
+  //  cell body 
+  const db::Cell &cref (mp_layout->cell (cell_index));
+  mp_cell = &cref;
 
-    //  cell body 
-    const db::Cell &cref (layout.cell (*cell));
-    mp_cell = &cref;
+  //  don't write ghost cells unless they are not empty (any more)
+  //  also don't write proxy cells which are not employed (in streaming mode, the
+  //  hierarchy is not known yet, so we write them always)
+  if ((! cref.is_ghost_cell () || ! cref.empty ()) && (m_streaming || ! cref.is_proxy () || ! cref.is_top ())) {
 
-    //  don't write ghost cells unless they are not empty (any more)
-    //  also don't write proxy cells which are not employed
-    if ((! cref.is_ghost_cell () || ! cref.empty ()) && (! cref.is_proxy () || ! cref.is_top ())) {
+    //  cell header 
 
-      //  cell header 
+    size_t &cell_pos = m_cell_positions.insert (std::make_pair (cell_index, size_t (0))).first->second;
+    if (mp_cblock_compressor) {
+      mp_cblock_compressor->tell (cell_pos);
+    } else {
+      cell_pos = mp_stream->pos ();
+    }
 
-      cell_positions.insert (std::make_pair (*cell, mp_stream->pos ()));
+    write_record_id (13);  // CELL
+    write ((unsigned long) cell_index);
 
-      write_record_id (13);  // CELL
-      write ((unsigned long) *cell);
+    reset_modal_variables ();
 
-      reset_modal_variables ();
+    if (m_options.write_cblocks) {
+      begin_cblock ();
+    }
 
-      if (m_options.write_cblocks) {
-        begin_cblock ();
-      }
+    //  context information as property named KLAYOUT_CONTEXT
+    if (cref.is_proxy () && write_context_info) {
 
-      //  context information as property named KLAYOUT_CONTEXT
-      if (cref.is_proxy () && options.write_context_info ()) {
+      std::vector <std::string> context_prop_strings;
 
-        context_prop_strings.clear ();
+      if (mp_layout->get_context_info (cell_index, context_prop_strings)) {
 
-        if (layout.get_context_info (*cell, context_prop_strings)) {
+        write_record_id (28);
 
-          write_record_id (28);
+        //  in streaming mode, the name tables are written at the end of the file. As the reader
+        //  needs to identify the context property immediately, we use explicit strings then.
+        if (m_streaming) {
+          write_byte (char (0xf4)); 
+          write_nstring (klayout_context_name);
+        } else {
           write_byte (char (0xf6)); 
           std::map <std::string, unsigned long>::const_iterator pni = m_propnames.find (klayout_context_name);
           tl_assert (pni != m_propnames.end ());
           write (pni->second);
+        }
 
-          write ((unsigned long) context_prop_strings.size ());
+        write ((unsigned long) context_prop_strings.size ());
 
-          for (std::vector <std::string>::const_iterator c = context_prop_strings.begin (); c != context_prop_strings.end (); ++c) {
+        for (std::vector <std::string>::const_iterator c = context_prop_strings.begin (); c != context_prop_strings.end (); ++c) {
+          if (m_streaming) {
+            write_byte (11); // b-string
+            write_bstring (c->c_str ());
+          } else {
             write_byte (14); // b-string by reference number
             std::map <std::string, unsigned long>::const_iterator psi = m_propstrings.find (*c);
             tl_assert (psi != m_propstrings.end ());
             write (psi->second);
           }
-
-          mm_last_property_name = klayout_context_name;
-          mm_last_property_is_sprop = false;
-          mm_last_value_list.reset ();
-
         }
 
-      }
+        mm_last_property_name = klayout_context_name;
+        mm_last_property_is_sprop = false;
+        mm_last_value_list.reset ();
 
-      if (cref.prop_id () != 0) {
-        write_props (cref.prop_id ());
       }
 
-      //  instances
-      if (cref.cell_instances () > 0) {
-        write_insts (cell_set);
-      }
+    }
 
-      //  shapes
-      for (std::vector <std::pair <unsigned int, db::LayerProperties> >::const_iterator l = layers.begin (); l != layers.end (); ++l) {
-        const db::Shapes &shapes = cref.shapes (l->first);
-        if (! shapes.empty ()) {
-          write_shapes (l->second, shapes);
-          m_progress.set (mp_stream->pos ());
-        }
+    if (cref.prop_id () != 0) {
+      write_props (cref.prop_id ());
+    }
+
+    //  instances
+    if (cref.cell_instances () > 0) {
+      write_insts (cell_set);
+    }
+
+    //  shapes
+    for (std::vector <std::pair <unsigned int, db::LayerProperties> >::const_iterator l = layers.begin (); l != layers.end (); ++l) {
+      const db::Shapes &shapes = cref.shapes (l->first);
+      if (! shapes.empty ()) {
+        write_shapes (l->second, shapes);
+        m_progress.set (mp_stream->pos ());
       }
+    }
 
-      //  end CBLOCK if required
-      if (m_options.write_cblocks) {
-        end_cblock ();
-      } 
+    //  end CBLOCK if required
+    if (m_options.write_cblocks) {
+      end_cblock ();
+    } 
 
-      //  end of cell
+    //  end of cell
 
-    }
+  }
+
+}
 
+void
+OASISWriter::write_cellnames (const std::vector <db::cell_index_type> &cells_by_index, bool with_bboxes, bool with_offsets)
+{
+  bool sequential = true;
+  for (std::vector<db::cell_index_type>::const_iterator cell = cells_by_index.begin (); cell != cells_by_index.end () && sequential; ++cell) {
+    sequential = (*cell == db::cell_index_type (cell - cells_by_index.begin ()));
   }
 
-  //  write cell table at the end in strict mode (in that mode we need the cell positions
-  //  for the S_CELL_OFFSET properties)
-  
-  if (m_options.strict_mode) {
+  for (std::vector<db::cell_index_type>::const_iterator cell = cells_by_index.begin (); cell != cells_by_index.end (); ++cell) {
+
+    begin_table (m_cellnames_table_pos);
 
-    bool sequential = true;
-    for (std::vector<db::cell_index_type>::const_iterator cell = cells_by_index.begin (); cell != cells_by_index.end () && sequential; ++cell) {
-      sequential = (*cell == db::cell_index_type (cell - cells_by_index.begin ()));
+    //  CELLNAME (implicit or explicit)
+    write_record_id (sequential ? 3 : 4);
+    write_nstring (mp_layout->cell_name (*cell));
+    if (! sequential) {
+      write ((unsigned long) *cell);
     }
 
-    for (std::vector<db::cell_index_type>::const_iterator cell = cells_by_index.begin (); cell != cells_by_index.end (); ++cell) {
-      
-      begin_table (cellnames_table_pos);
+    reset_modal_variables ();
 
-      //  CELLNAME (explicit)
-      write_record_id (sequential ? 3 : 4);
-      write_nstring (layout.cell_name (*cell));
-      if (! sequential) {
-        write ((unsigned long) *cell);
-      }
+    if (with_bboxes) {
 
-      reset_modal_variables ();
+      //  write S_BOUNDING_BOX entries
 
-      if (m_options.write_std_properties > 1) {
+      std::vector<tl::Variant> values;
 
-        //  write S_BOUNDING_BOX entries
+      //  TODO: how to set the "depends on external cells" flag?
+      db::Box bbox = mp_layout->cell (*cell).bbox ();
+      if (bbox.empty ()) {
+        //  empty box 
+        values.push_back (tl::Variant ((unsigned int) 0x2)); 
+        bbox = db::Box (0, 0, 0, 0);
+      } else {
+        values.push_back (tl::Variant ((unsigned int) 0x0)); 
+      }
 
-        std::vector<tl::Variant> values;
+      values.push_back (tl::Variant (bbox.left ())); 
+      values.push_back (tl::Variant (bbox.bottom ())); 
+      values.push_back (tl::Variant (bbox.width ()));
+      values.push_back (tl::Variant (bbox.height ()));
 
-        //  TODO: how to set the "depends on external cells" flag?
-        db::Box bbox = layout.cell (*cell).bbox ();
-        if (bbox.empty ()) {
-          //  empty box 
-          values.push_back (tl::Variant ((unsigned int) 0x2)); 
-          bbox = db::Box (0, 0, 0, 0);
-        } else {
-          values.push_back (tl::Variant ((unsigned int) 0x0)); 
-        }
+      write_property_def (s_bounding_box_name, values, true);
 
-        values.push_back (tl::Variant (bbox.left ())); 
-        values.push_back (tl::Variant (bbox.bottom ())); 
-        values.push_back (tl::Variant (bbox.width ()));
-        values.push_back (tl::Variant (bbox.height ()));
+    }
 
-        write_property_def (s_bounding_box_name, values, true);
-
-      }
+    if (with_offsets) {
 
       //  PROPERTY record with S_CELL_OFFSET
-      std::map<db::cell_index_type, size_t>::const_iterator pp = cell_positions.find (*cell);
-      if (pp != cell_positions.end ()) {
+      std::map<db::cell_index_type, size_t>::const_iterator pp = m_cell_positions.find (*cell);
+      if (pp != m_cell_positions.end ()) {
         write_property_def (s_cell_offset_name, tl::Variant (pp->second), true);
       } else {
         write_property_def (s_cell_offset_name, tl::Variant (size_t (0)), true);
@@ -1728,39 +2026,76 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
 
     }
 
-    end_table (cellnames_table_pos);
+  }
+
+  end_table (m_cellnames_table_pos);
+}
+
+void
+OASISWriter::write_layernames (const std::vector <std::pair <unsigned int, db::LayerProperties> > &layers)
+{
+  for (std::vector <std::pair <unsigned int, db::LayerProperties> >::const_iterator l = layers.begin (); l != layers.end (); ++l) {
+
+    if (! l->second.name.empty ()) {
+
+      begin_table (m_layernames_table_pos);
+
+      //  write mappings to text layer and shape layers
+      write_record_id (11);
+      write_nstring (l->second.name.c_str ());
+      write_byte (3);
+      write ((unsigned long) l->second.layer);
+      write_byte (3);
+      write ((unsigned long) l->second.datatype);
+
+      write_record_id (12);
+      write_nstring (l->second.name.c_str ());
+      write_byte (3);
+      write ((unsigned long) l->second.layer);
+      write_byte (3);
+      write ((unsigned long) l->second.datatype);
+
+      m_progress.set (mp_stream->pos ());
+
+    }
 
   }
 
+  end_table (m_layernames_table_pos);
+}
+
+void
+OASISWriter::write_end_record (bool offsets_at_end)
+{
   //  END record
 
   size_t end_record_pos = mp_stream->pos ();
 
   write_record_id (2);
 
-  if (m_options.strict_mode) {
+  if (offsets_at_end) {
 
-    //  offset table for strict mode (write it now since we have the table offsets now)
+    //  offset table for strict and streaming mode (write it now since we have the table offsets now)
 
     //  cellnames
     write_byte (1); 
-    write (cellnames_table_pos);
+    write (m_cellnames_table_pos);
 
     //  textstrings
     write_byte (1); 
-    write (textstrings_table_pos);
+    write (m_textstrings_table_pos);
 
     //  propnames
     write_byte (1); 
-    write (propnames_table_pos);
+    write (m_propnames_table_pos);
 
     //  propstrings
     write_byte (1); 
-    write (propstrings_table_pos);
+    write (m_propstrings_table_pos);
 
     //  layernames
     write_byte (1); 
-    write (layernames_table_pos);
+    write (m_layernames_table_pos);
 
     //  xnames (not used)
     write_byte (1); 
@@ -1781,6 +2116,124 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
   m_progress.set (mp_stream->pos ());
 }
 
+void
+OASISWriter::begin_cell_streaming (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options)
+{
+  typedef db::coord_traits<db::Coord>::distance_type coord_distance_type;
+
+  double dbu = prepare_write (layout, stream, options);
+
+  m_streaming = true;
+  m_save_options = options;
+
+  //  in streaming mode, the tables are written at the end, so the offsets are stored in the END record
+
+  write_start_record (dbu, true);
+
+  reset_modal_variables ();
+
+  //  S_TOP_CELL and S_BOUNDING_BOX(ES_AVAILABLE) cannot be provided as we don't know the hierarchy yet
+
+  if (m_options.write_std_properties > 0) {
+    write_property_def (s_max_signed_integer_width_name, tl::Variant (sizeof (db::Coord)), true);
+    write_property_def (s_max_unsigned_integer_width_name, tl::Variant (sizeof (coord_distance_type)), true);
+  }
+
+  if (layout.prop_id () != 0) {
+    write_props (layout.prop_id ());
+  }
+
+  //  compress the cell CBLOCKs in the background if requested
+  if (m_options.write_cblocks && m_options.write_threads > 0) {
+    mp_cblock_compressor = new OASISCBlockCompressor (*mp_stream, m_options.write_threads);
+  }
+}
+
+void
+OASISWriter::write_cell_streaming (db::cell_index_type cell_index)
+{
+  tl_assert (m_streaming);
+
+  //  NOTE: layers may be created while reading, so we need to determine the layers for each cell
+  std::vector <std::pair <unsigned int, db::LayerProperties> > layers;
+  m_save_options.get_valid_layers (*mp_layout, layers, db::SaveLayoutOptions::LP_AssignNumber);
+
+  write_cell (cell_index, layers, 0, m_save_options.write_context_info ());
+}
+
+void
+OASISWriter::end_cell_streaming ()
+{
+  tl_assert (m_streaming);
+
+  std::vector <std::pair <unsigned int, db::LayerProperties> > layers;
+  m_save_options.get_valid_layers (*mp_layout, layers, db::SaveLayoutOptions::LP_AssignNumber);
+
+  //  write the cells which have not been delivered (e.g. library proxies created by the reader)
+
+  std::vector <db::cell_index_type> cells_by_index;
+
+  for (db::Layout::const_iterator cell = mp_layout->begin (); cell != mp_layout->end (); ++cell) {
+    cells_by_index.push_back (cell->cell_index ());
+    if (m_cell_positions.find (cell->cell_index ()) == m_cell_positions.end ()) {
+      write_cell (cell->cell_index (), layers, 0, m_save_options.write_context_info ());
+    }
+  }
+
+  if (mp_cblock_compressor) {
+    mp_cblock_compressor->flush (true);
+    delete mp_cblock_compressor;
+    mp_cblock_compressor = 0;
+  }
+
+  //  write the name tables: the cell names first as they may add new property names
+
+  write_cellnames (cells_by_index, false, m_options.strict_mode);
+  write_name_table (m_textstrings, 5, m_textstrings_table_pos);
+  write_name_table (m_propnames, 7, m_propnames_table_pos);
+  write_name_table (m_propstrings, 9, m_propstrings_table_pos);
+  m_proptables_written = true;
+
+  write_layernames (layers);
+
+  write_end_record (true);
+
+  m_streaming = false;
+  m_save_options = db::SaveLayoutOptions ();
+}
+
+void
+OASISWriter::write_name_table (const std::map <std::string, unsigned long> &names, char record_id, size_t &table_pos)
+{
+  //  write the names in the order of the ID's
+  std::vector<std::pair<unsigned long, std::string> > rev;
+  rev.reserve (names.size ());
+  for (std::map <std::string, unsigned long>::const_iterator n = names.begin (); n != names.end (); ++n) {
+    rev.push_back (std::make_pair (n->second, n->first));
+  }
+  std::sort (rev.begin (), rev.end ());
+
+  for (std::vector<std::pair<unsigned long, std::string> >::const_iterator n = rev.begin (); n != rev.end (); ++n) {
+
+    tl_assert (n->first == (unsigned long)(n - rev.begin ()));
+
+    begin_table (table_pos);
+    write_record_id (record_id);
+    if (record_id == 5) {
+      write_astring (n->second.c_str ());
+    } else if (record_id == 7) {
+      write_nstring (n->second.c_str ());
+    } else {
+      write_bstring (n->second.c_str ());
+    }
+
+    m_progress.set (mp_stream->pos ());
+
+  }
+
+  end_table (table_pos);
+}
+
 void 
 OASISWriter::write (const Repetition &rep)
 {
@@ -2014,7 +2467,7 @@ OASISWriter::write (const db::CellInstArray &inst, db::properties_id_type prop_i
 }
 
 void 
-OASISWriter::write_insts (const std::set <db::cell_index_type> &cell_set)
+OASISWriter::write_insts (const std::set <db::cell_index_type> *cell_set)
 {
   int level = m_options.compression_level;
 
@@ -2028,7 +2481,7 @@ OASISWriter::write_insts (const std::set <db::cell_index_type> &cell_set)
   //  Collect all instances 
   for (db::Cell::const_iterator inst_iterator = mp_cell->begin (); ! inst_iterator.at_end (); ++inst_iterator) {
 
-    if (cell_set.find (inst_iterator->cell_index ()) != cell_set.end ()) {
+    if (! cell_set || cell_set->find (inst_iterator->cell_index ()) != cell_set->end ()) {
 
       db::properties_id_type prop_id = inst_iterator->prop_id ();
 
@@ -2142,8 +2595,8 @@ OASISWriter::write_property_def (const char *name_str, const std::vector<tl::Var
       std::map <std::string, unsigned long>::const_iterator pni = m_propnames.find (name_str);
 
       //  In strict mode always write property ID's: before we have issued the table we can 
-      //  create new ID's.
-      if (pni == m_propnames.end () && m_options.strict_mode) {
+      //  create new ID's. In streaming mode, the tables are written at the end.
+      if (pni == m_propnames.end () && (m_options.strict_mode || m_streaming)) {
         tl_assert (! m_proptables_written);
         pni = m_propnames.insert (std::make_pair (name_str, m_propname_id++)).first;
       }
@@ -2205,8 +2658,8 @@ OASISWriter::write_property_def (const char *name_str, const std::vector<tl::Var
           std::map <std::string, unsigned long>::const_iterator pvi = m_propstrings.find (pvs);
 
           //  In strict mode always write property string ID's: before we have issued the table we can 
-          //  create new ID's.
-          if (pvi == m_propstrings.end () && m_options.strict_mode) {
+          //  create new ID's. In streaming mode, the tables are written at the end.
+          if (pvi == m_propstrings.end () && (m_options.strict_mode || m_streaming)) {
             tl_assert (! m_proptables_written);
             pvi = m_propstrings.insert (std::make_pair (pvs, m_propstring_id++)).first;
           }
@@ -2326,6 +2779,10 @@ OASISWriter::write (const db::Text &text, db::properties_id_type prop_id, const
 
   db::Trans trans = text.trans ();
   std::map <std::string, unsigned long>::const_iterator ts = m_textstrings.find (text.string ());
+  if (ts == m_textstrings.end () && m_streaming) {
+    //  in streaming mode, the TEXTSTRING table is written at the end
+    ts = m_textstrings.insert (std::make_pair (std::string (text.string ()), (unsigned long) m_textstrings.size ())).first;
+  }
   tl_assert (ts != m_textstrings.end ());
   unsigned long text_id = ts->second;
 
@@ -47,6 +47,7 @@ namespace db
 class Layout;
 class SaveLayoutOptions;
 class OASISWriter;
+class OASISCBlockCompressor;
 
 /**
  *  @brief A displacement list compactor
@@ -107,11 +108,43 @@ public:
    */
   OASISWriter ();
 
+  /**
+   *  @brief Destructor
+   */
+  ~OASISWriter ();
+
   /**
    *  @brief Write the layout object
    */
   void write (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options);
 
+  /**
+   *  @brief The OASIS writer supports cell-by-cell streaming
+   *
+   *  In streaming mode, the name tables are written at the end of the file and
+   *  the S_TOP_CELL and S_BOUNDING_BOX standard properties are not provided.
+   *  Cell selection options are ignored.
+   */
+  virtual bool supports_cell_streaming () const
+  {
+    return true;
+  }
+
+  /**
+   *  @brief Starts cell-by-cell streaming
+   */
+  virtual void begin_cell_streaming (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options);
+
+  /**
+   *  @brief Writes a single cell in streaming mode
+   */
+  virtual void write_cell_streaming (db::cell_index_type cell_index);
+
+  /**
+   *  @brief Finishes cell-by-cell streaming
+   */
+  virtual void end_cell_streaming ();
+
   void write (const db::CellInstArray &inst_array, const db::Repetition &rep)
   {
     write (inst_array, 0, rep);
@@ -207,9 +240,19 @@ private:
   tl::OutputMemoryStream m_cblock_buffer;
   tl::OutputMemoryStream m_cblock_compressed;
   bool m_in_cblock;
+  OASISCBlockCompressor *mp_cblock_compressor;
   unsigned long m_propname_id;
   unsigned long m_propstring_id;
   bool m_proptables_written;
+  bool m_streaming;
+  db::SaveLayoutOptions m_save_options;
+
+  size_t m_cellnames_table_pos;
+  size_t m_textstrings_table_pos;
+  size_t m_propnames_table_pos;
+  size_t m_propstrings_table_pos;
+  size_t m_layernames_table_pos;
+  std::map <db::cell_index_type, size_t> m_cell_positions;
 
   std::map <std::string, unsigned long> m_textstrings;
   std::map <std::string, unsigned long> m_propnames;
@@ -296,9 +339,17 @@ private:
 
   void reset_modal_variables ();
 
+  double prepare_write (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options);
+  void write_start_record (double dbu, bool offsets_at_end);
+  void write_end_record (bool offsets_at_end);
+  void write_cell (db::cell_index_type cell_index, const std::vector <std::pair <unsigned int, db::LayerProperties> > &layers, const std::set <db::cell_index_type> *cell_set, bool write_context_info);
+  void write_cellnames (const std::vector <db::cell_index_type> &cells_by_index, bool with_bboxes, bool with_offsets);
+  void write_layernames (const std::vector <std::pair <unsigned int, db::LayerProperties> > &layers);
+  void write_name_table (const std::map <std::string, unsigned long> &names, char record_id, size_t &table_pos);
+
   void emit_propname_def (db::properties_id_type prop_id);
   void emit_propstring_def (db::properties_id_type prop_id);
-  void write_insts (const std::set <db::cell_index_type> &cell_set);
+  void write_insts (const std::set <db::cell_index_type> *cell_set);
 
   void write_shapes (const db::LayerProperties &lprops, const db::Shapes &shapes);
 
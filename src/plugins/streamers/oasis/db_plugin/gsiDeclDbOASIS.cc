@@ -53,6 +53,26 @@ static int get_oasis_expect_strict_mode (const db::LoadLayoutOptions *options)
   return options->get_options<db::OASISReaderOptions> ().expect_strict_mode;
 }
 
+static void set_oasis_read_threads (db::LoadLayoutOptions *options, int n)
+{
+  options->get_options<db::OASISReaderOptions> ().read_threads = n;
+}
+
+static int get_oasis_read_threads (const db::LoadLayoutOptions *options)
+{
+  return options->get_options<db::OASISReaderOptions> ().read_threads;
+}
+
+static void set_oasis_lazy_loading (db::LoadLayoutOptions *options, bool f)
+{
+  options->get_options<db::OASISReaderOptions> ().lazy_loading = f;
+}
+
+static bool get_oasis_lazy_loading (const db::LoadLayoutOptions *options)
+{
+  return options->get_options<db::OASISReaderOptions> ().lazy_loading;
+}
+
 //  extend lay::LoadLayoutOptions with the OASIS options
 static
 gsi::ClassExt<db::LoadLayoutOptions> oasis_reader_options (
@@ -71,6 +91,36 @@ gsi::ClassExt<db::LoadLayoutOptions> oasis_reader_options (
   gsi::method_ext ("oasis_expect_strict_mode?", &get_oasis_expect_strict_mode,
     //  this method is mainly provided as access point for the generic interface
     "@hide"
+  ) +
+  gsi::method_ext ("oasis_read_threads=", &set_oasis_read_threads, gsi::arg ("n"),
+    "@brief Specifies the number of threads used for decompressing CBLOCKs\n"
+    "If this value is larger than 0, compressed blocks (CBLOCKs) are inflated in the background by the "
+    "given number of threads while the reader is busy with building the layout. This accelerates reading "
+    "of compressed OASIS files. A value of 0 (the default) will make the reader decompress the blocks inline.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("oasis_read_threads", &get_oasis_read_threads,
+    "@brief Gets the number of threads used for decompressing CBLOCKs\n"
+    "See \\oasis_read_threads= method for a description of this attribute."
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("oasis_lazy_loading=", &set_oasis_lazy_loading, gsi::arg ("flag"),
+    "@brief Specifies whether the shapes are loaded on request\n"
+    "If this flag is set, the OASIS reader builds the cell hierarchy, the layers and the name tables, "
+    "but does not create the shapes of the cells. The shapes of a cell are loaded when they are accessed first "
+    "as long as the \\LayoutReader object used for reading is alive (see \\LayoutReader#load_cell). "
+    "\\Layout#read loads all shapes before it returns. Inputs which cannot be read twice (e.g. pipes) "
+    "are loaded completely with a warning.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("oasis_lazy_loading?", &get_oasis_lazy_loading,
+    "@brief Gets a value indicating whether the shapes are loaded on request\n"
+    "See \\oasis_lazy_loading= method for a description of this attribute."
+    "\n"
+    "This method has been introduced in version 0.27."
   ),
   ""
 );
@@ -168,6 +218,16 @@ static bool get_oasis_strict_mode (const db::SaveLayoutOptions *options)
   return options->get_options<db::OASISWriterOptions> ().strict_mode;
 }
 
+static void set_oasis_write_threads (db::SaveLayoutOptions *options, int n)
+{
+  options->get_options<db::OASISWriterOptions> ().write_threads = n;
+}
+
+static int get_oasis_write_threads (const db::SaveLayoutOptions *options)
+{
+  return options->get_options<db::OASISWriterOptions> ().write_threads;
+}
+
 static void set_oasis_subst_char (db::SaveLayoutOptions *options, const std::string &sc)
 {
   options->get_options<db::OASISWriterOptions> ().subst_char = sc;
@@ -188,6 +248,21 @@ gsi::ClassExt<db::SaveLayoutOptions> oasis_writer_options (
   gsi::method_ext ("oasis_write_cblocks?", &get_oasis_write_cblocks,
     "@brief Gets a value indicating whether to write compressed CBLOCKS per cell\n"
   ) +
+  gsi::method_ext ("oasis_write_threads=", &set_oasis_write_threads, gsi::arg ("n"),
+    "@brief Sets the number of threads used for CBLOCK compression\n"
+    "If this value is larger than 0 and CBLOCKs are written (see \\oasis_write_cblocks=), the "
+    "cells are compressed by the given number of background threads while the writer continues "
+    "with the next cells. The file produced is the same as without background compression. "
+    "The default is 0 which means the compression is done by the writer itself.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("oasis_write_threads", &get_oasis_write_threads,
+    "@brief Gets the number of threads used for CBLOCK compression\n"
+    "See \\oasis_write_threads= method for a description of this attribute."
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
   gsi::method_ext ("oasis_strict_mode=", &set_oasis_strict_mode, gsi::arg ("flag"),
     "@brief Sets a value indicating whether to write strict-mode OASIS files\n"
     "Setting this property clears all format specific options for other formats such as GDS.\n"
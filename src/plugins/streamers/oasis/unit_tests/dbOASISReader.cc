@@ -24,6 +24,7 @@
 #include "dbOASISReader.h"
 #include "dbTextWriter.h"
 #include "dbTestSupport.h"
+#include "dbLayoutDiff.h"
 #include "tlLog.h"
 #include "tlUnitTest.h"
 #include "tlStream.h"
@@ -79,7 +80,7 @@ compare_ref (tl::TestBase *_this, const char *test, const db::Layout &layout)
 }
 
 void
-run_test (tl::TestBase *_this, const char *test)
+run_test (tl::TestBase *_this, const char *test, int read_threads = 0, bool map_file = false)
 {
   db::Manager m (false);
   db::Layout layout (&m);
@@ -87,13 +88,18 @@ run_test (tl::TestBase *_this, const char *test)
   fn += "/testdata/oasis/t";
   fn += test;
   fn += ".oas";
-  tl::InputStream stream (fn);
+  tl::InputStream stream (fn, map_file);
   db::Reader reader (stream);
   reader.set_warnings_as_errors (true);
 
+  db::LoadLayoutOptions options;
+  db::OASISReaderOptions oasis_options;
+  oasis_options.read_threads = read_threads;
+  options.set_options (oasis_options);
+
   bool error = false;
   try {
-    reader.read (layout);
+    reader.read (layout, options);
   } catch (tl::Exception &ex) {
     tl::error << ex.msg ();
     error = true;
@@ -103,6 +109,73 @@ run_test (tl::TestBase *_this, const char *test)
   compare_ref (_this, test, layout);
 }
 
+static void
+compare_bboxes (tl::TestBase *_this, const db::Layout &ref, const db::Layout &layout)
+{
+  for (db::Layout::const_iterator c = ref.begin (); c != ref.end (); ++c) {
+
+    std::pair<bool, db::cell_index_type> cc = layout.cell_by_name (ref.cell_name (c->cell_index ()));
+    EXPECT_EQ (cc.first, true);
+    if (! cc.first) {
+      continue;
+    }
+
+    const db::Cell &cell = layout.cell (cc.second);
+    EXPECT_EQ (cell.bbox ().to_string (), c->bbox ().to_string ());
+
+    for (db::Layout::layer_iterator l = ref.begin_layers (); l != ref.end_layers (); ++l) {
+      for (db::Layout::layer_iterator ll = layout.begin_layers (); ll != layout.end_layers (); ++ll) {
+        if ((*ll).second->log_equal (*(*l).second)) {
+          EXPECT_EQ (cell.bbox ((*ll).first).to_string (), c->bbox ((*l).first).to_string ());
+        }
+      }
+    }
+
+  }
+}
+
+void
+run_test_lazy (tl::TestBase *_this, const char *test)
+{
+  db::Manager m (false);
+  db::Layout layout (&m);
+  std::string fn (tl::testsrc ());
+  fn += "/testdata/oasis/t";
+  fn += test;
+  fn += ".oas";
+  tl::InputStream stream (fn);
+  db::OASISReader reader (stream);
+  reader.set_warnings_as_errors (true);
+
+  db::LoadLayoutOptions options;
+  db::OASISReaderOptions oasis_options;
+  oasis_options.lazy_loading = true;
+  options.set_options (oasis_options);
+
+  db::Layout ref;
+  {
+    tl::InputStream ref_stream (fn);
+    db::Reader ref_reader (ref_stream);
+    ref_reader.read (ref);
+  }
+
+  bool error = false;
+  try {
+    reader.read (layout, options);
+    //  the bounding boxes are available before the shapes are loaded
+    compare_bboxes (_this, ref, layout);
+    reader.load_all_cells (layout);
+  } catch (tl::Exception &ex) {
+    tl::error << ex.msg ();
+    error = true;
+  }
+  EXPECT_EQ (error, false)
+  EXPECT_EQ (reader.has_deferred_cells (), false);
+
+  compare_ref (_this, test, layout);
+  compare_bboxes (_this, ref, layout);
+}
+
 void
 run_test_error (tl::TestBase *_this, const char *test, const char *msg_au)
 {
@@ -234,6 +307,17 @@ TEST(14_1)
   run_test (_this, "14.1");
 }
 
+TEST(14_1_threaded)
+{
+  run_test (_this, "14.1", 2);
+}
+
+TEST(14_1_mapped)
+{
+  run_test (_this, "14.1", 0, true);
+  run_test (_this, "14.1", 2, true);
+}
+
 TEST(2_1)
 {
   run_test (_this, "2.1");
@@ -579,3 +663,305 @@ TEST(Bug_121_2)
   std::string fn_au (tl::testsrc () + "/testdata/oasis/bug_121_au2.gds");
   db::compare_layouts (_this, layout, fn_au, db::WriteGDS2, 1);
 }
+
+TEST(LazyLoading1)
+{
+  run_test_lazy (_this, "1.1");
+  run_test_lazy (_this, "8.8");
+  run_test_lazy (_this, "10.1");
+  run_test_lazy (_this, "11.4");
+  run_test_lazy (_this, "14.1");
+}
+
+TEST(LazyLoading2)
+{
+  db::Layout ref;
+  {
+    tl::InputStream stream (tl::testsrc () + "/testdata/oasis/t10.1.oas");
+    db::Reader reader (stream);
+    reader.read (ref);
+  }
+
+  db::Manager m (false);
+  db::Layout layout (&m);
+
+  tl::InputStream stream (tl::testsrc () + "/testdata/oasis/t10.1.oas");
+  db::OASISReader reader (stream);
+
+  db::LoadLayoutOptions options;
+  db::OASISReaderOptions oasis_options;
+  oasis_options.lazy_loading = true;
+  options.set_options (oasis_options);
+
+  reader.read (layout, options);
+
+  db::cell_index_type ci_a = layout.cell_by_name ("A").second;
+  db::cell_index_type ci_b = layout.cell_by_name ("B").second;
+  db::cell_index_type ci_top = layout.cell_by_name ("TOP").second;
+
+  //  the hierarchy, the layers and the bounding boxes are there, but no shapes
+  EXPECT_EQ (layout.cell (ci_b).cell_instances (), size_t (2));
+  EXPECT_EQ (layout.cell (ci_top).cell_instances (), size_t (1));
+  EXPECT_EQ (layout.layers (), (unsigned int) 2);
+  EXPECT_EQ (reader.is_deferred_cell (ci_a), true);
+  EXPECT_EQ (reader.is_deferred_cell (ci_b), true);
+  EXPECT_EQ (layout.cell (ci_a).has_deferred_shapes (), true);
+  EXPECT_EQ (layout.cell (ci_b).has_deferred_shapes (), true);
+  EXPECT_EQ (layout.cell (ci_top).bbox ().to_string (), ref.cell (ref.cell_by_name ("TOP").second).bbox ().to_string ());
+
+  //  computing the bounding boxes does not load the shapes
+  EXPECT_EQ (reader.is_deferred_cell (ci_a), true);
+
+  reader.load_cell (layout, ci_a);
+  EXPECT_EQ (reader.is_deferred_cell (ci_a), false);
+  EXPECT_EQ (layout.cell (ci_a).has_deferred_shapes (), false);
+  EXPECT_EQ (reader.is_deferred_cell (ci_b), true);
+  EXPECT_EQ (layout.cell (ci_a).shapes (0).size () + layout.cell (ci_a).shapes (1).size (), size_t (8));
+  EXPECT_EQ (reader.is_deferred_cell (ci_b), true);
+
+  //  loading twice does not duplicate the shapes
+  reader.load_cell (layout, ci_a);
+  EXPECT_EQ (layout.cell (ci_a).shapes (0).size () + layout.cell (ci_a).shapes (1).size (), size_t (8));
+
+  //  accessing the shapes loads them
+  const db::Cell &ref_b = ref.cell (ref.cell_by_name ("B").second);
+  EXPECT_EQ (layout.cell (ci_b).shapes (0).size () + layout.cell (ci_b).shapes (1).size (), ref_b.shapes (0).size () + ref_b.shapes (1).size ());
+  EXPECT_EQ (reader.is_deferred_cell (ci_b), false);
+  EXPECT_EQ (layout.cell (ci_b).has_deferred_shapes (), false);
+
+  reader.load_cell_tree (layout, ci_top);
+  EXPECT_EQ (reader.has_deferred_cells (), false);
+  EXPECT_EQ (layout.cell (ci_b).cell_instances (), size_t (2));
+
+  compare_ref (_this, "10.1", layout);
+}
+
+TEST(LazyLoading4_NonResettableStream)
+{
+  //  a pipe cannot be read twice, hence lazy loading falls back to loading everything
+
+  std::string fn = tl::testsrc () + "/testdata/oasis/t10.1.oas";
+
+  db::Manager m (false);
+  db::Layout layout (&m);
+
+  tl::InputPipe pipe ("cat \"" + fn + "\"");
+  tl::InputStream stream (pipe);
+  db::OASISReader reader (stream);
+
+  db::LoadLayoutOptions options;
+  db::OASISReaderOptions oasis_options;
+  oasis_options.lazy_loading = true;
+  options.set_options (oasis_options);
+
+  reader.read (layout, options);
+
+  EXPECT_EQ (reader.has_deferred_cells (), false);
+  EXPECT_EQ (layout.deferred_cell_loader () == 0, true);
+
+  compare_ref (_this, "10.1", layout);
+}
+
+TEST(LazyLoading5_ReaderDestroyed)
+{
+  db::Manager m (false);
+  db::Layout layout (&m);
+
+  db::cell_index_type ci_a, ci_b;
+
+  {
+    tl::InputStream stream (tl::testsrc () + "/testdata/oasis/t10.1.oas");
+    db::OASISReader reader (stream);
+
+    db::LoadLayoutOptions options;
+    db::OASISReaderOptions oasis_options;
+    oasis_options.lazy_loading = true;
+    options.set_options (oasis_options);
+
+    reader.read (layout, options);
+
+    ci_a = layout.cell_by_name ("A").second;
+    ci_b = layout.cell_by_name ("B").second;
+
+    EXPECT_EQ (layout.deferred_cell_loader () == &reader, true);
+    EXPECT_EQ (layout.cell (ci_a).bbox ().empty (), false);
+
+    reader.load_cell (layout, ci_a);
+  }
+
+  //  without the reader, the cells not loaded stay empty
+  EXPECT_EQ (layout.deferred_cell_loader () == 0, true);
+  EXPECT_EQ (layout.cell (ci_a).has_deferred_shapes (), false);
+  EXPECT_EQ (layout.cell (ci_b).has_deferred_shapes (), false);
+  EXPECT_EQ (layout.cell (ci_a).shapes (0).size () + layout.cell (ci_a).shapes (1).size (), size_t (8));
+  EXPECT_EQ (layout.cell (ci_b).shapes (0).size () + layout.cell (ci_b).shapes (1).size (), size_t (0));
+  EXPECT_EQ (layout.cell (ci_a).bbox ().empty (), false);
+}
+
+static void put_uint (std::string &s, unsigned long v)
+{
+  do {
+    unsigned char b = (unsigned char) (v & 0x7f);
+    v >>= 7;
+    if (v) {
+      b |= 0x80;
+    }
+    s += char (b);
+  } while (v);
+}
+
+static void put_sint (std::string &s, long v)
+{
+  put_uint (s, v < 0 ? (((unsigned long) -v) << 1) | 1 : ((unsigned long) v) << 1);
+}
+
+static void put_str (std::string &s, const std::string &str)
+{
+  put_uint (s, str.size ());
+  s += str;
+}
+
+static void put_cell (std::string &s, const std::string &name)
+{
+  s += char (14);  //  CELL with name string
+  put_str (s, name);
+}
+
+static void put_rectangle (std::string &s, unsigned int l, db::Coord x, db::Coord y, db::Coord w, db::Coord h)
+{
+  s += char (20);  //  RECTANGLE
+  s += char (0x7b);  //  W, H, X, Y, D, L
+  put_uint (s, l);
+  put_uint (s, 0);
+  put_uint (s, w);
+  put_uint (s, h);
+  put_sint (s, x);
+  put_sint (s, y);
+}
+
+static void put_placement (std::string &s, const std::string &cell, db::Coord x, db::Coord y)
+{
+  s += char (17);  //  PLACEMENT
+  s += char (0xb0);  //  C, X, Y
+  put_str (s, cell);
+  put_sint (s, x);
+  put_sint (s, y);
+}
+
+static void put_cblock (std::string &s, const std::string &data)
+{
+  //  a DEFLATE stream made from a single uncompressed block
+  std::string comp;
+  comp += char (1);
+  comp += char (data.size () & 0xff);
+  comp += char ((data.size () >> 8) & 0xff);
+  comp += char (~data.size () & 0xff);
+  comp += char ((~data.size () >> 8) & 0xff);
+  comp += data;
+
+  s += char (34);  //  CBLOCK
+  put_uint (s, 0);
+  put_uint (s, data.size ());
+  put_uint (s, comp.size ());
+  s += comp;
+}
+
+TEST(LazyLoading3_CellsInCBlocks)
+{
+  //  Other writers than KLayout put whole cells including the CELL record into CBLOCKs -
+  //  the bodies of such cells are located by the CBLOCK and the offset inside the inflated data
+
+  std::string oas ("%SEMI-OASIS\015\012");
+  oas += char (1);  //  START
+  put_str (oas, "1.0");
+  put_uint (oas, 0);
+  put_uint (oas, 1000);
+  put_uint (oas, 0);
+  for (int i = 0; i < 12; ++i) {
+    put_uint (oas, 0);
+  }
+
+  std::string cb1;
+  put_cell (cb1, "A");
+  put_rectangle (cb1, 1, 0, 0, 100, 200);
+  put_rectangle (cb1, 2, 0, 0, 50, 50);
+  put_cell (cb1, "B");
+  put_placement (cb1, "A", 1000, 0);
+  put_rectangle (cb1, 1, 0, 0, 300, 300);
+  put_cell (cb1, "C");
+  put_rectangle (cb1, 2, 10, 20, 30, 40);
+  put_cblock (oas, cb1);
+
+  //  a cell outside a CBLOCK
+  put_cell (oas, "D");
+  put_rectangle (oas, 1, -100, -200, 10, 10);
+
+  std::string cb2;
+  put_cell (cb2, "TOP");
+  put_placement (cb2, "B", 0, 2000);
+  put_placement (cb2, "C", 0, 0);
+  put_placement (cb2, "D", 0, 0);
+  put_rectangle (cb2, 2, 0, 0, 5000, 5000);
+  put_cblock (oas, cb2);
+
+  oas += char (2);  //  END
+  oas += std::string (255, char (0));
+
+  std::string tmp_file = _this->tmp_file ("tmp_lazy3.oas");
+  {
+    tl::OutputStream os (tmp_file);
+    os.put (oas.c_str (), oas.size ());
+  }
+
+  db::Layout ref;
+  {
+    tl::InputStream stream (tmp_file);
+    db::Reader reader (stream);
+    reader.read (ref);
+  }
+
+  EXPECT_EQ (ref.cells (), size_t (5));
+
+  db::LoadLayoutOptions options;
+  db::OASISReaderOptions oasis_options;
+  oasis_options.lazy_loading = true;
+  options.set_options (oasis_options);
+
+  db::Layout layout;
+  tl::InputStream stream (tmp_file);
+  db::Reader reader (stream);
+  reader.read (layout, options);
+
+  db::cell_index_type ci_a = layout.cell_by_name ("A").second;
+  db::cell_index_type ci_b = layout.cell_by_name ("B").second;
+  db::cell_index_type ci_c = layout.cell_by_name ("C").second;
+  db::cell_index_type ci_d = layout.cell_by_name ("D").second;
+  db::cell_index_type ci_top = layout.cell_by_name ("TOP").second;
+
+  //  all cells are deferred, including the ones inside CBLOCKs
+  EXPECT_EQ (reader.is_deferred_cell (ci_a), true);
+  EXPECT_EQ (reader.is_deferred_cell (ci_b), true);
+  EXPECT_EQ (reader.is_deferred_cell (ci_c), true);
+  EXPECT_EQ (reader.is_deferred_cell (ci_d), true);
+  EXPECT_EQ (reader.is_deferred_cell (ci_top), true);
+  EXPECT_EQ (layout.cell (ci_top).cell_instances (), size_t (3));
+  EXPECT_EQ (layout.cell (ci_b).bbox ().to_string (), ref.cell (ref.cell_by_name ("B").second).bbox ().to_string ());
+  EXPECT_EQ (layout.cell (ci_top).bbox ().to_string (), ref.cell (ref.cell_by_name ("TOP").second).bbox ().to_string ());
+
+  //  loading a cell in the middle of a CBLOCK
+  reader.load_cell (layout, ci_b);
+  EXPECT_EQ (reader.is_deferred_cell (ci_b), false);
+  EXPECT_EQ (reader.is_deferred_cell (ci_a), true);
+  EXPECT_EQ (layout.cell (ci_b).shapes (0).size (), size_t (1));
+
+  //  going back to the start of the same CBLOCK
+  reader.load_cell (layout, ci_a);
+  EXPECT_EQ (layout.cell (ci_a).shapes (0).size () + layout.cell (ci_a).shapes (1).size (), size_t (2));
+
+  //  the remaining cells: C inside the first CBLOCK, D outside, TOP in the second CBLOCK
+  reader.load_cell_tree (layout, ci_top);
+  EXPECT_EQ (reader.has_deferred_cells (), false);
+
+  bool equal = db::compare_layouts (ref, layout, db::layout_diff::f_verbose, 0);
+  EXPECT_EQ (equal, true);
+}
@@ -214,6 +214,30 @@ void run_test (tl::TestBase *_this, const char *file, bool scaling_test, int com
       writer.write (layout, stream, options);
     }
 
+    //  compressing CBLOCKs in the background must not change the file
+    std::string tmp_file_mt = _this->tmp_file ("tmp_4mt.oas");
+
+    {
+      tl::OutputStream stream (tmp_file_mt);
+      db::OASISWriter writer;
+      db::SaveLayoutOptions options;
+      db::OASISWriterOptions oasis_options;
+      oasis_options.write_cblocks = true;
+      oasis_options.strict_mode = true;
+      oasis_options.write_std_properties = 2;
+      oasis_options.write_threads = 2;
+      options.set_options (oasis_options);
+      writer.write (layout, stream, options);
+    }
+
+    {
+      tl::InputStream is (tmp_file);
+      tl::InputStream is_mt (tmp_file_mt);
+      if (is.read_all () != is_mt.read_all ()) {
+        _this->raise (tl::sprintf ("Multi-threaded CBLOCK compression produced a different file - see %s vs %s\n", tmp_file, tmp_file_mt));
+      }
+    }
+
     db::Layout layout2 (&m);
 
     {
@@ -1805,3 +1829,77 @@ TEST(119_WithAndWithoutContext)
   }
 
 }
+
+static void run_threaded_read_test (tl::TestBase *_this, const char *file)
+{
+  db::Manager m (false);
+  db::Layout layout (&m);
+
+  {
+    std::string fn (tl::testsrc ());
+    fn += "/testdata/oasis/";
+    fn += file;
+    tl::InputStream stream (fn);
+    db::Reader reader (stream);
+    reader.read (layout);
+  }
+
+  std::string tmp_file = _this->tmp_file ("tmp_threaded_read.oas");
+
+  {
+    tl::OutputStream stream (tmp_file);
+    db::OASISWriter writer;
+    db::SaveLayoutOptions options;
+    db::OASISWriterOptions oasis_options;
+    oasis_options.write_cblocks = true;
+    oasis_options.strict_mode = true;
+    options.set_options (oasis_options);
+    writer.write (layout, stream, options);
+  }
+
+  //  the serial reader provides the reference
+  db::Layout layout_serial (&m);
+
+  {
+    tl::InputStream stream (tmp_file);
+    db::Reader reader (stream);
+    db::LoadLayoutOptions options;
+    db::OASISReaderOptions oasis_options;
+    oasis_options.read_threads = 0;
+    options.set_options (oasis_options);
+    reader.set_warnings_as_errors (true);
+    reader.read (layout_serial, options);
+  }
+
+  for (int threads = 1; threads <= 4; threads *= 2) {
+
+    db::Layout layout_mt (&m);
+
+    {
+      tl::InputStream stream (tmp_file);
+      db::Reader reader (stream);
+      db::LoadLayoutOptions options;
+      db::OASISReaderOptions oasis_options;
+      oasis_options.read_threads = threads;
+      options.set_options (oasis_options);
+      reader.set_warnings_as_errors (true);
+      reader.read (layout_mt, options);
+    }
+
+    CHECKPOINT ();
+    bool equal = db::compare_layouts (layout_serial, layout_mt, db::layout_diff::f_verbose, 0);
+    if (! equal) {
+      _this->raise (tl::sprintf ("Compare of serial and multi-threaded read (%d threads) failed for %s - see %s\n", threads, file, tmp_file));
+    }
+
+  }
+}
+
+TEST(120_MultiThreadedRead)
+{
+  run_threaded_read_test (_this, "t10.1.oas");
+  run_threaded_read_test (_this, "t11.1.oas");
+  run_threaded_read_test (_this, "t14.1.oas");
+  run_threaded_read_test (_this, "t3.1.oas");
+  run_threaded_read_test (_this, "t8.1.oas");
+}
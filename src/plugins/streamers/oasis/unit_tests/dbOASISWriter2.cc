@@ -26,8 +26,10 @@
 #include "dbShapeProcessor.h"
 
 #include "tlUnitTest.h"
+#include "tlTimer.h"
 
 #include <stdlib.h>
+#include <set>
 
 // Test the writer's capabilities to write polygon's with holes
 TEST(1)
@@ -88,3 +90,69 @@ TEST(1)
   }
 }
 
+
+//  A property-heavy layout: each shape carries an individual properties set
+TEST(2)
+{
+  const unsigned int n = 100000;
+
+  db::Manager m (false);
+  db::Layout layout_org (&m);
+
+  db::PropertiesRepository &rep_org = layout_org.properties_repository ();
+  db::property_names_id_type net_name_id = rep_org.prop_name_id (tl::Variant ("NET"));
+  db::property_names_id_type index_id = rep_org.prop_name_id (tl::Variant (1));
+
+  unsigned int l1 = layout_org.insert_layer (db::LayerProperties (1, 0));
+  db::Cell &top_org = layout_org.cell (layout_org.add_cell ("TOP"));
+
+  {
+    tl::SelfTimer timer ("building properties");
+    for (unsigned int i = 0; i < n; ++i) {
+      db::PropertiesRepository::properties_set ps;
+      ps.insert (std::make_pair (net_name_id, tl::Variant (tl::sprintf ("net_%u", i / 2))));
+      ps.insert (std::make_pair (index_id, tl::Variant (i % 2)));
+      db::properties_id_type pid = rep_org.properties_id (ps);
+      top_org.shapes (l1).insert (db::BoxWithProperties (db::Box (i * 10, 0, i * 10 + 5, 100), pid));
+    }
+  }
+
+  //  n distinct sets plus the empty one
+  EXPECT_EQ (rep_org.end_id (), size_t (n + 1));
+
+  std::string tmp_file = tl::TestBase::tmp_file ("tmp_OASISWriter2_2.oas");
+
+  {
+    tl::SelfTimer timer ("writing OASIS");
+    tl::OutputStream stream (tmp_file);
+    db::OASISWriter writer;
+    db::SaveLayoutOptions options;
+    writer.write (layout_org, stream, options);
+  }
+
+  db::Layout layout_read (&m);
+  {
+    tl::SelfTimer timer ("reading OASIS");
+    tl::InputStream file (tmp_file);
+    db::Reader reader (file);
+    reader.read (layout_read);
+  }
+
+  db::PropertiesRepository &rep_read = layout_read.properties_repository ();
+  EXPECT_EQ (rep_read.end_id () >= size_t (n + 1), true);
+
+  std::pair<bool, db::cell_index_type> top_read = layout_read.cell_by_name ("TOP");
+  EXPECT_EQ (top_read.first, true);
+
+  std::set<db::properties_id_type> pids;
+  size_t nshapes = 0;
+  for (db::Layout::layer_iterator l = layout_read.begin_layers (); l != layout_read.end_layers (); ++l) {
+    for (db::ShapeIterator s = layout_read.cell (top_read.second).shapes ((*l).first).begin (db::ShapeIterator::All); ! s.at_end (); ++s) {
+      pids.insert (s->prop_id ());
+      ++nshapes;
+    }
+  }
+
+  EXPECT_EQ (nshapes, size_t (n));
+  EXPECT_EQ (pids.size (), size_t (n));
+}
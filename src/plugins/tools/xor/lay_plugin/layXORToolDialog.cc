@@ -32,6 +32,7 @@
 #include "dbLayoutUtils.h"
 #include "dbRegion.h"
 #include "dbDeepShapeStore.h"
+#include "dbDeepXOR.h"
 #include "tlTimer.h"
 #include "tlProgress.h"
 #include "tlThreadedWorkers.h"
@@ -412,6 +413,7 @@ public:
       m_dbu (dbu),
       m_cva (cva),
       m_cvb (cvb),
+      m_deep_xor (0, &cva->layout (), cva.cell_index (), &cvb->layout (), cvb.cell_index (), dbu),
       m_tolerances (tolerances),
       m_sub_categories (sub_categories),
       m_layer_categories (layer_categories),
@@ -422,6 +424,8 @@ public:
       m_progress (0),
       m_nx (0), m_ny (0)
   {
+    //  identical cells and placements are skipped as far as possible in deep mode
+    m_deep_xor.set_skip_identical (true);
   }
 
   output_mode_t output_mode () const
@@ -467,6 +471,11 @@ public:
     return m_cvb;
   }
 
+  db::DeepXOR &deep_xor ()
+  {
+    return m_deep_xor;
+  }
+
   const std::vector <db::Coord> &tolerances () const
   {
     return m_tolerances;
@@ -611,6 +620,7 @@ private:
   double m_dbu;
   lay::CellView m_cva;
   lay::CellView m_cvb;
+  db::DeepXOR m_deep_xor;
   std::vector <db::Coord> m_tolerances;
   std::vector <rdb::Category *> m_sub_categories;
   std::vector <std::vector <rdb::Category *> > m_layer_categories;
@@ -763,19 +773,8 @@ XORWorker::do_perform_deep (const XORTask *xor_task)
 
           tl::SelfTimer timer (tl::verbosity () >= 21, "Boolean part");
 
-          db::RecursiveShapeIterator s_a (mp_job->cva ()->layout (), mp_job->cva ()->layout ().cell (mp_job->cva ().cell_index ()), la, xor_task->region_a ());
-          db::RecursiveShapeIterator s_b (mp_job->cvb ()->layout (), mp_job->cvb ()->layout ().cell (mp_job->cvb ().cell_index ()), lb, xor_task->region_b ());
-
-          db::Region ra (s_a, dss, db::ICplxTrans (mp_job->cva ()->layout ().dbu () / mp_job->dbu ()));
-          db::Region rb (s_b, dss, db::ICplxTrans (mp_job->cvb ()->layout ().dbu () / mp_job->dbu ()));
-
-          if (mp_job->op () == db::BooleanOp::Xor) {
-            rr = ra ^ rb;
-          } else if (mp_job->op () == db::BooleanOp::ANotB) {
-            rr = ra - rb;
-          } else if (mp_job->op () == db::BooleanOp::BNotA) {
-            rr = rb - ra;
-          }
+          //  the engine and its merged hierarchy are shared by all layers of the job
+          rr = mp_job->deep_xor ().compute (dss, mp_job->op (), la, lb, xor_task->region_a (), xor_task->region_b ());
 
         } else if (mp_job->op () == db::BooleanOp::Xor ||
                    (mp_job->op () == db::BooleanOp::ANotB && !la.empty ()) ||
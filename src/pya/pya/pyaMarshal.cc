@@ -25,6 +25,7 @@
 #include "pyaObject.h"
 #include "pyaConvert.h"
 #include "pyaModule.h"
+#include "pyaUtils.h"
 
 #include "gsiTypes.h"
 #include "gsiObjectHolder.h"
@@ -68,6 +69,41 @@ private:
   PythonPtr m_string;
 };
 
+/**
+ *  @brief An adaptor for a byte array from Python objects
+ *
+ *  Byte arrays can be given as bytes, bytearray or (UTF-8 encoded) str objects.
+ */
+class PythonBasedByteArrayAdaptor
+  : public gsi::ByteArrayAdaptor
+{
+public:
+  PythonBasedByteArrayAdaptor (const PythonPtr &data)
+    : m_data (python2c<std::string> (data.get ())), m_object (data)
+  {
+    //  .. nothing yet ..
+  }
+
+  virtual const char *c_str () const
+  {
+    return m_data.c_str ();
+  }
+
+  virtual size_t size () const
+  {
+    return m_data.size ();
+  }
+
+  virtual void set (const char * /*c_str*/, size_t /*s*/, tl::Heap & /*heap*/)
+  {
+    //  Python bytes objects are immutable
+  }
+
+private:
+  std::string m_data;
+  PythonPtr m_object;
+};
+
 /**
  *  @brief An adaptor for a variant from ruby objects
  */
@@ -303,6 +339,35 @@ struct writer<gsi::StringType>
   }
 };
 
+/**
+ *  @brief Serialization for byte arrays
+ */
+template <>
+struct writer<gsi::ByteArrayType>
+{
+  void operator() (gsi::SerialArgs *aa, PyObject *arg, const gsi::ArgType &atype, tl::Heap *)
+  {
+    //  Cannot pass ownership currently
+    tl_assert (!atype.pass_obj ());
+
+    if (arg == Py_None || arg == NULL) {
+
+      if (! (atype.is_ptr () || atype.is_cptr ())) {
+        //  nil is treated as an empty byte array for references
+        aa->write<void *> ((void *)new gsi::ByteArrayAdaptorImpl<std::vector<char> > (std::vector<char> ()));
+      } else {
+        aa->write<void *> ((void *)0);
+      }
+
+    } else {
+
+      //  NOTE: by convention we pass the ownership to the receiver for adaptors.
+      aa->write<void *> ((void *)new PythonBasedByteArrayAdaptor (arg));
+
+    }
+  }
+};
+
 /**
  *  @brief Specialization for Variant
  */
@@ -533,6 +598,32 @@ struct reader<gsi::StringType>
   }
 };
 
+/**
+ *  @brief Deseralisation wrapper: specialization for byte arrays
+ *
+ *  Byte arrays are delivered as "bytes" objects (Python 3) or "str" objects (Python 2).
+ */
+template <>
+struct reader<gsi::ByteArrayType>
+{
+  void operator() (gsi::SerialArgs *rr, PythonRef *ret, PYAObjectBase * /*self*/, const gsi::ArgType &, tl::Heap *heap)
+  {
+    std::auto_ptr<gsi::ByteArrayAdaptor> a ((gsi::ByteArrayAdaptor *) rr->read<void *>(*heap));
+    if (!a.get ()) {
+      *ret = PythonRef (Py_None, false /*borrowed*/);
+    } else {
+#if PY_MAJOR_VERSION < 3
+      *ret = PythonRef (PyString_FromStringAndSize (a->c_str (), Py_ssize_t (a->size ())));
+#else
+      *ret = PythonRef (PyBytes_FromStringAndSize (a->c_str (), Py_ssize_t (a->size ())));
+#endif
+      if (! *ret) {
+        check_error ();
+      }
+    }
+  }
+};
+
 static
 PyObject *object_from_variant (const tl::Variant &var, PYAObjectBase *self, const gsi::ArgType &atype)
 {
@@ -930,6 +1021,36 @@ struct test_arg_func<gsi::StringType>
   }
 };
 
+template <>
+struct test_arg_func<gsi::ByteArrayType>
+{
+  void operator() (bool *ret, PyObject *arg, const gsi::ArgType &atype, bool)
+  {
+    if ((atype.is_cptr () || atype.is_ptr ()) && arg == Py_None) {
+      //  for ptr or cptr, null is an allowed value
+      *ret = true;
+      return;
+    }
+
+#if PY_MAJOR_VERSION < 3
+    if (PyString_Check (arg)) {
+      *ret = true;
+    } else
+#else
+    if (PyBytes_Check (arg)) {
+      *ret = true;
+    } else
+#endif
+    if (PyByteArray_Check (arg)) {
+      *ret = true;
+    } else if (PyUnicode_Check (arg)) {
+      *ret = true;
+    } else {
+      *ret = false;
+    }
+  }
+};
+
 template <>
 struct test_arg_func<gsi::VectorType>
 {
@@ -182,6 +182,12 @@ inline bool test_type<gsi::StringType> (VALUE rval, bool /*loose*/)
   return TYPE (rval) == T_STRING;
 }
 
+template <>
+inline bool test_type<gsi::ByteArrayType> (VALUE rval, bool /*loose*/)
+{
+  return TYPE (rval) == T_STRING;
+}
+
 template <>
 inline bool test_type<gsi::VariantType> (VALUE /*rval*/, bool /*loose*/)
 {
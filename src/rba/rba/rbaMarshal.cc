@@ -74,6 +74,45 @@ private:
   VALUE m_string;
 };
 
+/**
+ *  @brief An adaptor for a byte array from ruby objects
+ *
+ *  The byte array is taken from the string's raw bytes regardless of the encoding.
+ */
+class RubyBasedByteArrayAdaptor
+  : public gsi::ByteArrayAdaptor
+{
+public:
+  RubyBasedByteArrayAdaptor (VALUE value)
+  {
+    m_bytes = rba_safe_string_value (value);
+    gc_lock_object (m_bytes);
+  }
+
+  ~RubyBasedByteArrayAdaptor ()
+  {
+    gc_unlock_object (m_bytes);
+  }
+
+  virtual const char *c_str () const
+  {
+    return RSTRING_PTR (m_bytes);
+  }
+
+  virtual size_t size () const
+  {
+    return RSTRING_LEN (m_bytes);
+  }
+
+  virtual void set (const char * /*c_str*/, size_t /*s*/, tl::Heap & /*heap*/)
+  {
+    //  TODO: is there a setter for a string?
+  }
+
+private:
+  VALUE m_bytes;
+};
+
 /**
  *  @brief An adaptor for a variant from ruby objects
  */
@@ -214,6 +253,7 @@ struct get_boxed_value_func_error
 
 template <> struct get_boxed_value_func<gsi::VariantType> : get_boxed_value_func_error { };
 template <> struct get_boxed_value_func<gsi::StringType> : get_boxed_value_func_error { };
+template <> struct get_boxed_value_func<gsi::ByteArrayType> : get_boxed_value_func_error { };
 template <> struct get_boxed_value_func<gsi::ObjectType> : get_boxed_value_func_error { };
 template <> struct get_boxed_value_func<gsi::VectorType> : get_boxed_value_func_error { };
 template <> struct get_boxed_value_func<gsi::MapType> : get_boxed_value_func_error { };
@@ -321,6 +361,35 @@ struct writer<gsi::StringType>
   }
 };
 
+/**
+ *  @brief Serialization for byte arrays
+ */
+template <>
+struct writer<gsi::ByteArrayType>
+{
+  void operator() (gsi::SerialArgs *aa, VALUE arg, const gsi::ArgType &atype, tl::Heap *)
+  {
+    //  Cannot pass ownership currently
+    tl_assert (!atype.pass_obj ());
+
+    if (arg == Qnil) {
+
+      if (! (atype.is_ptr () || atype.is_cptr ())) {
+        //  nil is treated as an empty byte array for references
+        aa->write<void *> ((void *)new gsi::ByteArrayAdaptorImpl<std::vector<char> > (std::vector<char> ()));
+      } else {
+        aa->write<void *> ((void *)0);
+      }
+
+    } else {
+
+      //  NOTE: by convention we pass the ownership to the receiver for adaptors.
+      aa->write<void *> ((void *)new RubyBasedByteArrayAdaptor (arg));
+
+    }
+  }
+};
+
 /**
  *  @brief Specialization for Variant
  */
@@ -556,6 +625,25 @@ struct reader<gsi::StringType>
   }
 };
 
+/**
+ *  @brief Deseralisation wrapper: specialization for byte arrays
+ *
+ *  Byte arrays are delivered as binary (ASCII-8BIT) strings.
+ */
+template <>
+struct reader<gsi::ByteArrayType>
+{
+  void operator() (gsi::SerialArgs *rr, VALUE *ret, Proxy * /*self*/, const gsi::ArgType &, tl::Heap *heap)
+  {
+    std::auto_ptr<gsi::ByteArrayAdaptor> a ((gsi::ByteArrayAdaptor *) rr->read<void *>(*heap));
+    if (!a.get ()) {
+      *ret = Qnil;
+    } else {
+      *ret = rb_str_new (a->c_str (), long (a->size ()));
+    }
+  }
+};
+
 static VALUE object_from_variant (const tl::Variant &var, Proxy *self, const gsi::ArgType &atype)
 {
   if (var.is_user()) {
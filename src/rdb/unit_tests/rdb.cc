@@ -24,7 +24,9 @@
 #include "tlUnitTest.h"
 #include "dbBox.h"
 #include "dbEdge.h"
+#include "dbPolygon.h"
 #include "tlXMLParser.h"
+#include "tlTimer.h"
 
 TEST(1) 
 {
@@ -551,4 +553,35 @@ TEST(6)
   EXPECT_EQ (db.variants ("c2")[5], c2e->id ());
 }
 
+//  A large marker database (long runner)
+TEST(7)
+{
+  test_is_long_runner ();
+
+  std::string tmp_file = tl::TestBase::tmp_file ("tmp_7.lyrdb");
+
+  const int n = 100000;
+
+  {
+    rdb::Database db;
+
+    rdb::Category *cath = db.create_category ("cath");
+    rdb::Cell *c1 = db.create_cell ("c1");
+
+    for (int i = 0; i < n; ++i) {
+      rdb::Item *item = db.create_item (c1->id (), cath->id ());
+      item->values ().add (new rdb::Value<db::DPolygon> (db::DPolygon (db::DBox (i * 0.5, 0.0, i * 0.5 + 0.25, 1.0))));
+    }
 
+    db.save (tmp_file);
+  }
+
+  rdb::Database db2;
+
+  {
+    tl::SelfTimer timer (tl::sprintf ("Loading %d markers", n));
+    db2.load (tmp_file);
+  }
+
+  EXPECT_EQ (db2.num_items (), size_t (n));
+}
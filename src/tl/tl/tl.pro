@@ -30,6 +30,7 @@ SOURCES = \
     tlStream.cc \
     tlString.cc \
     tlTimer.cc \
+    tlProfiler.cc \
     tlVariant.cc \
     tlFileUtils.cc \
     tlArch.cc \
@@ -37,6 +38,7 @@ SOURCES = \
     tlUnitTest.cc \
     tlInt128Support.cc \
     tlXMLParser.cc \
+    tlXMLPullParser.cc \
     tlXMLWriter.cc \
     tlThreadedWorkers.cc \
     tlThreads.cc \
@@ -80,6 +82,7 @@ HEADERS = \
     tlStream.h \
     tlString.h \
     tlTimer.h \
+    tlProfiler.h \
     tlTypeTraits.h \
     tlUtils.h \
     tlVariant.h \
@@ -95,6 +98,7 @@ HEADERS = \
     tlInt128Support.h \
     tlDefs.h \
     tlXMLParser.h \
+    tlXMLPullParser.h \
     tlXMLWriter.h \
     tlThreadedWorkers.h \
     tlThreads.h \
@@ -109,6 +113,11 @@ HEADERS = \
     tlSelect.h \
     tlEnv.h
 
+win32 {
+  # for process memory information (tl::Timer::memory_size)
+  LIBS += -lpsapi
+}
+
 equals(HAVE_CURL, "1") {
 
   HEADERS += \
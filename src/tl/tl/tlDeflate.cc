@@ -222,7 +222,7 @@ private:
 
 InflateFilter::InflateFilter (tl::InputStream &input)
   : m_input (input), 
-    m_b_insert (0), m_b_read (0), m_at_end (false),
+    m_b_insert (0), m_b_read (0), m_pos (0), m_at_end (false),
     m_last_block (false), 
     m_uncompressed_length (0)  //  this forces a new block on "process()"
 {
@@ -264,6 +264,7 @@ InflateFilter::get (size_t n)
 
   const char *r = m_buffer + m_b_read;
   m_b_read = (m_b_read + n) % sizeof (m_buffer);
+  m_pos += n;
   return r;
 }
 
@@ -272,6 +273,7 @@ InflateFilter::unget (size_t n)
 {
   tl_assert (m_b_read >= n);
   m_b_read -= (unsigned int) n;
+  m_pos -= n;
 }
 
 bool 
@@ -229,12 +229,21 @@ public:
    */
   bool at_end ();
 
+  /**
+   *  @brief Gets the number of decoded bytes delivered so far
+   */
+  size_t pos () const
+  {
+    return m_pos;
+  }
+
 private:
   BitStream m_input;
 
   char m_buffer[65536];
   unsigned int m_b_insert;
   unsigned int m_b_read;
+  size_t m_pos;
   bool m_at_end;
 
   //  processor state
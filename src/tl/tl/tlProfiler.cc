@@ -0,0 +1,315 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "tlProfiler.h"
+#include "tlString.h"
+#include "tlStream.h"
+#include "tlFileUtils.h"
+#include "tlInternational.h"
+
+#include <algorithm>
+
+namespace tl
+{
+
+// -------------------------------------------------------------
+//  ProfileRecord implementation
+
+ProfileRecord::ProfileRecord ()
+  : wall (0.0), user (0.0), sys (0.0), threads (1),
+    memory_before (0), memory_after (0), memory_peak (0),
+    input_count (0), output_count (0)
+{
+  //  .. nothing yet ..
+}
+
+double
+ProfileRecord::utilization () const
+{
+  if (wall <= 0.0) {
+    return 0.0;
+  } else {
+    return cpu () / (wall * double (std::max ((unsigned int) 1, threads)));
+  }
+}
+
+// -------------------------------------------------------------
+//  Profiler implementation
+
+namespace
+{
+
+/**
+ *  @brief Gets the memory allocated by the operation
+ *  Memory released by the operation does not count.
+ */
+static size_t allocated (const ProfileRecord &r)
+{
+  return r.memory_after > r.memory_before ? r.memory_after - r.memory_before : 0;
+}
+
+struct ProfileRecordCompare
+{
+  ProfileRecordCompare (const std::string &key)
+    : m_key (key)
+  {
+    //  .. nothing yet ..
+  }
+
+  bool operator() (const ProfileRecord &a, const ProfileRecord &b) const
+  {
+    if (m_key == "cpu") {
+      return a.cpu () > b.cpu ();
+    } else if (m_key == "memory") {
+      return allocated (a) > allocated (b);
+    } else if (m_key == "peak") {
+      return a.memory_peak > b.memory_peak;
+    } else if (m_key == "inputs") {
+      return a.input_count > b.input_count;
+    } else if (m_key == "outputs") {
+      return a.output_count > b.output_count;
+    } else {
+      return a.wall > b.wall;
+    }
+  }
+
+private:
+  std::string m_key;
+};
+
+static std::string json_quoted (const std::string &s)
+{
+  std::string res;
+  res.reserve (s.size () + 2);
+  res += "\"";
+  for (const char *cp = s.c_str (); *cp; ++cp) {
+    if (*cp == '"') {
+      res += "\\\"";
+    } else if (*cp == '\\') {
+      res += "\\\\";
+    } else if (*cp == '\n') {
+      res += "\\n";
+    } else if (*cp == '\t') {
+      res += "\\t";
+    } else if ((unsigned char) *cp < 0x20) {
+      res += tl::sprintf ("\\u%04x", int ((unsigned char) *cp));
+    } else {
+      res += *cp;
+    }
+  }
+  res += "\"";
+  return res;
+}
+
+static std::string csv_quoted (const std::string &s)
+{
+  return "\"" + tl::replaced (s, "\"", "\"\"") + "\"";
+}
+
+static double to_mb (size_t bytes)
+{
+  return double (bytes) / (1024.0 * 1024.0);
+}
+
+}
+
+Profiler::Profiler ()
+  : m_enabled (false)
+{
+  //  .. nothing yet ..
+}
+
+Profiler &
+Profiler::instance ()
+{
+  static Profiler s_profiler;
+  return s_profiler;
+}
+
+void
+Profiler::set_enabled (bool f)
+{
+  m_enabled = f;
+}
+
+void
+Profiler::add (const ProfileRecord &record)
+{
+  tl::MutexLocker locker (&m_lock);
+  m_records.push_back (record);
+}
+
+void
+Profiler::clear ()
+{
+  tl::MutexLocker locker (&m_lock);
+  m_records.clear ();
+}
+
+std::vector<ProfileRecord>
+Profiler::records (const std::string &sort_key) const
+{
+  std::vector<ProfileRecord> res;
+  {
+    tl::MutexLocker locker (&m_lock);
+    res = m_records;
+  }
+
+  if (sort_key != "order") {
+    std::stable_sort (res.begin (), res.end (), ProfileRecordCompare (sort_key));
+  }
+
+  return res;
+}
+
+std::string
+Profiler::to_csv (const std::string &sort_key) const
+{
+  std::vector<ProfileRecord> recs = records (sort_key);
+
+  std::string res = "category,description,wall,cpu,user,sys,threads,utilization,memory_before,memory_after,memory_allocated,memory_peak,inputs,outputs\n";
+  for (std::vector<ProfileRecord>::const_iterator r = recs.begin (); r != recs.end (); ++r) {
+    res += csv_quoted (r->category);
+    res += ",";
+    res += csv_quoted (r->description);
+    res += tl::sprintf (",%.3f,%.3f,%.3f,%.3f,%u,%.3f", r->wall, r->cpu (), r->user, r->sys, r->threads, r->utilization ());
+    res += tl::sprintf (",%lu,%lu,%lu,%lu,%lu,%lu\n", r->memory_before, r->memory_after, allocated (*r), r->memory_peak, r->input_count, r->output_count);
+  }
+
+  return res;
+}
+
+std::string
+Profiler::to_json (const std::string &sort_key) const
+{
+  std::vector<ProfileRecord> recs = records (sort_key);
+
+  std::string res = "[";
+  for (std::vector<ProfileRecord>::const_iterator r = recs.begin (); r != recs.end (); ++r) {
+    if (r != recs.begin ()) {
+      res += ",";
+    }
+    res += "\n  {";
+    res += "\"category\": " + json_quoted (r->category) + ", ";
+    res += "\"description\": " + json_quoted (r->description) + ", ";
+    res += tl::sprintf ("\"wall\": %.3f, \"cpu\": %.3f, \"user\": %.3f, \"sys\": %.3f, \"threads\": %u, \"utilization\": %.3f, ", r->wall, r->cpu (), r->user, r->sys, r->threads, r->utilization ());
+    res += tl::sprintf ("\"memory_before\": %lu, \"memory_after\": %lu, \"memory_allocated\": %lu, \"memory_peak\": %lu, ", r->memory_before, r->memory_after, allocated (*r), r->memory_peak);
+    res += tl::sprintf ("\"inputs\": %lu, \"outputs\": %lu}", r->input_count, r->output_count);
+  }
+  res += "\n]\n";
+
+  return res;
+}
+
+std::string
+Profiler::summary (size_t n, const std::string &sort_key) const
+{
+  std::vector<ProfileRecord> recs = records (sort_key);
+
+  double wall_total = 0.0, cpu_total = 0.0;
+  for (std::vector<ProfileRecord>::const_iterator r = recs.begin (); r != recs.end (); ++r) {
+    //  local processor invocations are part of other operations and are not counted
+    if (r->category != "local_processor") {
+      wall_total += r->wall;
+      cpu_total += r->cpu ();
+    }
+  }
+
+  if (n == 0 || n > recs.size ()) {
+    n = recs.size ();
+  }
+
+  std::string res;
+  res += tl::sprintf (tl::to_string (tr ("Operation profile (%lu of %lu records)")), n, recs.size ()) + "\n";
+  res += tl::sprintf ("%10s %10s %6s %10s %10s ", "Wall [s]", "CPU [s]", "Util", "Mem [MB]", "Peak [MB]");
+  res += tl::sprintf ("%12s %12s  %s\n", "Inputs", "Outputs", "Operation");
+
+  for (std::vector<ProfileRecord>::const_iterator r = recs.begin (); r != recs.begin () + n; ++r) {
+    res += tl::sprintf ("%10.3f %10.3f %5.0f%% %10.1f %10.1f %12lu %12lu  ", r->wall, r->cpu (), r->utilization () * 100.0, to_mb (allocated (*r)), to_mb (r->memory_peak), r->input_count, r->output_count);
+    res += "[" + r->category + "] " + r->description + "\n";
+  }
+
+  res += tl::sprintf ("%10.3f %10.3f", wall_total, cpu_total) + "  " + tl::to_string (tr ("Total")) + "\n";
+
+  return res;
+}
+
+void
+Profiler::write (const std::string &path, const std::string &sort_key) const
+{
+  std::string ext = tl::to_lower_case (tl::extension_last (path));
+
+  std::string text;
+  if (ext == "json") {
+    text = to_json (sort_key);
+  } else if (ext == "csv") {
+    text = to_csv (sort_key);
+  } else {
+    text = summary (0, sort_key);
+  }
+
+  tl::OutputStream os (path, tl::OutputStream::OM_Auto, true);
+  os.put (text.c_str (), text.size ());
+}
+
+// -------------------------------------------------------------
+//  ProfileScope implementation
+
+ProfileScope::ProfileScope (const std::string &category, const std::string &description, unsigned int threads)
+  : m_enabled (Profiler::instance ().is_enabled ())
+{
+  if (m_enabled) {
+    m_record.category = category;
+    m_record.description = description;
+    m_record.threads = std::max ((unsigned int) 1, threads);
+    m_record.memory_before = tl::Timer::memory_size ();
+    m_timer.start ();
+  }
+}
+
+ProfileScope::~ProfileScope ()
+{
+  finish ();
+}
+
+void
+ProfileScope::finish ()
+{
+  if (! m_enabled) {
+    return;
+  }
+
+  m_enabled = false;
+
+  m_timer.stop ();
+  m_record.wall = m_timer.sec_wall ();
+  m_record.user = m_timer.sec_user ();
+  m_record.sys = m_timer.sec_sys ();
+  m_record.memory_after = tl::Timer::memory_size ();
+  m_record.memory_peak = tl::Timer::peak_memory_size ();
+
+  Profiler::instance ().add (m_record);
+}
+
+}
+
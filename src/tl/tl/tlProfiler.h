@@ -0,0 +1,208 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_tlProfiler
+#define HDR_tlProfiler
+
+#include "tlCommon.h"
+#include "tlTimer.h"
+#include "tlThreads.h"
+
+#include <string>
+#include <vector>
+
+namespace tl
+{
+
+/**
+ *  @brief A single entry of the operation profile
+ *
+ *  Times are given in seconds, memory sizes in bytes. "threads" is the number of
+ *  threads the operation was allowed to use. Input and output counts are
+ *  the number of objects (i.e. shapes) going into and coming out of the operation.
+ */
+struct TL_PUBLIC ProfileRecord
+{
+  ProfileRecord ();
+
+  std::string category;
+  std::string description;
+  double wall, user, sys;
+  unsigned int threads;
+  size_t memory_before, memory_after, memory_peak;
+  size_t input_count, output_count;
+
+  /**
+   *  @brief Gets the CPU time (user plus system)
+   */
+  double cpu () const
+  {
+    return user + sys;
+  }
+
+  /**
+   *  @brief Gets the thread utilization
+   *
+   *  The utilization is the ratio of CPU time vs. the time available on the given number
+   *  of threads. A value of 1.0 means all threads have been busy all the time.
+   */
+  double utilization () const;
+};
+
+/**
+ *  @brief The operation profiler
+ *
+ *  The profiler collects the profile records of expensive operations. It is
+ *  a singleton and disabled by default. Operations producing profile records
+ *  should check "is_enabled" before collecting the information.
+ *
+ *  The profiler delivers the records as CSV or JSON or as a summary table.
+ *  The records can be sorted by "wall" (wall time, the default), "cpu" (CPU time),
+ *  "memory" (memory allocated by the operation), "peak" (peak process memory after
+ *  the operation), "inputs" (input count), "outputs" (output count) or "order"
+ *  (the order in which the records were taken).
+ *
+ *  Except for "order", records are sorted in descending order.
+ */
+class TL_PUBLIC Profiler
+{
+public:
+  /**
+   *  @brief Gets the singleton instance
+   */
+  static Profiler &instance ();
+
+  /**
+   *  @brief Enables or disables the profiler
+   */
+  void set_enabled (bool f);
+
+  /**
+   *  @brief Gets a value indicating whether the profiler is enabled
+   */
+  bool is_enabled () const
+  {
+    return m_enabled;
+  }
+
+  /**
+   *  @brief Adds a profile record
+   *  This method is thread-safe.
+   */
+  void add (const ProfileRecord &record);
+
+  /**
+   *  @brief Clears all records
+   */
+  void clear ();
+
+  /**
+   *  @brief Gets the records sorted by the given key
+   */
+  std::vector<ProfileRecord> records (const std::string &sort_key = std::string ()) const;
+
+  /**
+   *  @brief Gets the records as CSV text
+   */
+  std::string to_csv (const std::string &sort_key = std::string ()) const;
+
+  /**
+   *  @brief Gets the records as JSON text
+   */
+  std::string to_json (const std::string &sort_key = std::string ()) const;
+
+  /**
+   *  @brief Gets a summary table of the first n records (all if n is 0)
+   */
+  std::string summary (size_t n = 0, const std::string &sort_key = std::string ()) const;
+
+  /**
+   *  @brief Writes the report to the given file
+   *
+   *  The format is derived from the file's suffix: ".json" will produce JSON, ".csv" CSV.
+   *  Other suffixes will produce the summary table.
+   */
+  void write (const std::string &path, const std::string &sort_key = std::string ()) const;
+
+private:
+  Profiler ();
+
+  bool m_enabled;
+  mutable tl::Mutex m_lock;
+  std::vector<ProfileRecord> m_records;
+};
+
+/**
+ *  @brief A profiling scope
+ *
+ *  This object takes the time and memory from construction to "finish" or
+ *  destruction and produces a profile record if the profiler is enabled.
+ *  If the profiler is disabled, this object does nothing.
+ */
+class TL_PUBLIC ProfileScope
+{
+public:
+  ProfileScope (const std::string &category, const std::string &description, unsigned int threads = 1);
+  ~ProfileScope ();
+
+  /**
+   *  @brief Gets a value indicating whether profiling is active for this scope
+   *  Use this method to avoid collecting expensive information if profiling is disabled.
+   */
+  bool is_enabled () const
+  {
+    return m_enabled;
+  }
+
+  /**
+   *  @brief Sets the input count
+   */
+  void set_input_count (size_t n)
+  {
+    m_record.input_count = n;
+  }
+
+  /**
+   *  @brief Sets the output count
+   */
+  void set_output_count (size_t n)
+  {
+    m_record.output_count = n;
+  }
+
+  /**
+   *  @brief Finishes the scope and produces the record
+   *  After "finish", the scope will not produce another record.
+   */
+  void finish ();
+
+private:
+  bool m_enabled;
+  tl::Timer m_timer;
+  ProfileRecord m_record;
+};
+
+}
+
+#endif
+
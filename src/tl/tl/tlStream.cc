@@ -32,6 +32,11 @@
 #include <zlib.h>
 #ifdef _WIN32 
 #  include <io.h>
+#  define NOMINMAX   //  for windows.h -> min/max not defined
+#  include <windows.h>
+#else
+#  include <sys/mman.h>
+#  include <unistd.h>
 #endif
 
 #include "tlStream.h"
@@ -136,27 +141,58 @@ public:
   gzFile zs;
 };
 
+// ---------------------------------------------------------------
+
+/**
+ *  @brief Creates the delegate for a local file
+ *
+ *  If requested, uncompressed files are mapped into memory, so the readers can
+ *  take the data from there. Compressed files and files which cannot be mapped
+ *  are read through zlib.
+ */
+static InputStreamBase *
+open_file (const std::string &path, bool map_file)
+{
+  if (! map_file) {
+    return new InputZLibFile (path);
+  }
+
+  InputMappedFile *mapped_file = new InputMappedFile (path);
+
+  const unsigned char *data = (const unsigned char *) mapped_file->direct_data ();
+  if (data && ! (mapped_file->direct_size () >= 2 && data [0] == 0x1f && data [1] == 0x8b)) {
+    return mapped_file;
+  }
+
+  delete mapped_file;
+  return new InputZLibFile (path);
+}
+
 // ---------------------------------------------------------------
 //  InputStream implementation
 
 InputStream::InputStream (InputStreamBase &delegate)
-  : m_pos (0), mp_bptr (0), mp_delegate (&delegate), m_owns_delegate (false), mp_inflate (0)
+  : m_pos (0), mp_bptr (0), mp_delegate (&delegate), m_owns_delegate (false), m_direct (false), mp_inflate (0), m_inflated_pos (0)
 { 
   m_bcap = 4096; // initial buffer capacity
   m_blen = 0;
   mp_buffer = new char [m_bcap];
+
+  init_direct ();
 }
 
 InputStream::InputStream (InputStreamBase *delegate)
-  : m_pos (0), mp_bptr (0), mp_delegate (delegate), m_owns_delegate (true), mp_inflate (0)
+  : m_pos (0), mp_bptr (0), mp_delegate (delegate), m_owns_delegate (true), m_direct (false), mp_inflate (0), m_inflated_pos (0)
 {
   m_bcap = 4096; // initial buffer capacity
   m_blen = 0;
   mp_buffer = new char [m_bcap];
+
+  init_direct ();
 }
 
-InputStream::InputStream (const std::string &abstract_path)
-  : m_pos (0), mp_bptr (0), mp_delegate (0), m_owns_delegate (false), mp_inflate (0)
+InputStream::InputStream (const std::string &abstract_path, bool map_file)
+  : m_pos (0), mp_bptr (0), mp_delegate (0), m_owns_delegate (false), m_direct (false), mp_inflate (0), m_inflated_pos (0)
 { 
   m_bcap = 4096; // initial buffer capacity
   m_blen = 0;
@@ -197,9 +233,9 @@ InputStream::InputStream (const std::string &abstract_path)
     mp_delegate = new InputPipe (ex.get ());
   } else if (ex.test ("file:")) {
     tl::URI uri (abstract_path);
-    mp_delegate = new InputZLibFile (uri.path ());
+    mp_delegate = open_file (uri.path (), map_file);
   } else {
-    mp_delegate = new InputZLibFile (abstract_path);
+    mp_delegate = open_file (abstract_path, map_file);
   }
 
   if (! mp_buffer) {
@@ -207,6 +243,19 @@ InputStream::InputStream (const std::string &abstract_path)
   }
 
   m_owns_delegate = true;
+
+  init_direct ();
+}
+
+void
+InputStream::init_direct ()
+{
+  //  take the data directly from the delegate's memory if possible
+  if (mp_delegate && mp_delegate->direct_data ()) {
+    m_direct = true;
+    mp_bptr = mp_delegate->direct_data ();
+    m_blen = mp_delegate->direct_size ();
+  }
 }
 
 std::string InputStream::absolute_path (const std::string &abstract_path)
@@ -265,9 +314,24 @@ InputStream::get (size_t n, bool bypass_inflate)
       delete mp_inflate;
       mp_inflate = 0;
     }
-  } 
+  } else if (! m_inflated.empty () && ! bypass_inflate) {
+    if (m_inflated_pos < m_inflated.size ()) {
+
+      if (m_inflated_pos + n > m_inflated.size ()) {
+        throw tl::Exception (tl::to_string (tr ("Unexpected end of file (DEFLATE implementation)")));
+      }
+
+      const char *r = m_inflated.data () + m_inflated_pos;
+      m_inflated_pos += n;
+      return r;
+
+    } else {
+      std::vector<char> ().swap (m_inflated);
+      m_inflated_pos = 0;
+    }
+  }
 
-  if (m_blen < n) {
+  if (m_blen < n && ! m_direct) {
 
     //  to keep move activity low, allocate twice as much as required
     if (m_bcap < n * 2) {
@@ -310,6 +374,9 @@ InputStream::unget (size_t n)
 {
   if (mp_inflate) {
     mp_inflate->unget (n);
+  } else if (! m_inflated.empty ()) {
+    tl_assert (m_inflated_pos >= n);
+    m_inflated_pos -= n;
   } else {
     mp_bptr -= n;
     m_blen += n;
@@ -363,16 +430,67 @@ void InputStream::copy_to (tl::OutputStream &os)
 void
 InputStream::inflate ()
 {
-  tl_assert (mp_inflate == 0);
+  tl_assert (mp_inflate == 0 && m_inflated.empty ());
   mp_inflate = new tl::InflateFilter (*this);
 }
 
+bool
+InputStream::inflate (size_t compressed_size, std::vector<char> &inflated)
+{
+  tl_assert (mp_inflate == 0 && m_inflated.empty ());
+
+  if (! get (compressed_size, true)) {
+    return false;
+  }
+
+  m_inflated.swap (inflated);
+  m_inflated_pos = 0;
+  std::vector<char> ().swap (inflated);
+  return true;
+}
+
+bool
+InputStream::is_resettable () const
+{
+  return m_direct || ! mp_delegate || mp_delegate->is_resettable ();
+}
+
+bool
+InputStream::is_inflating () const
+{
+  return (mp_inflate && ! mp_inflate->at_end ()) || m_inflated_pos < m_inflated.size ();
+}
+
+size_t
+InputStream::inflated_pos () const
+{
+  return mp_inflate ? mp_inflate->pos () : m_inflated_pos;
+}
+
+const char *
+InputStream::peek (size_t n)
+{
+  const char *r = get (n, true);
+  if (r) {
+    mp_bptr -= n;
+    m_blen += n;
+    m_pos -= n;
+  }
+  return r;
+}
+
 void
 InputStream::close ()
 {
   if (mp_delegate) {
     mp_delegate->close ();
   }
+
+  //  the delegate's memory is no longer available
+  if (m_direct) {
+    mp_bptr = 0;
+    m_blen = 0;
+  }
 }
 
 void 
@@ -383,10 +501,18 @@ InputStream::reset ()
     delete mp_inflate;
     mp_inflate = 0;
   } 
+  std::vector<char> ().swap (m_inflated);
+  m_inflated_pos = 0;
+
+  if (m_direct) {
+
+    mp_bptr = mp_delegate->direct_data ();
+    m_blen = mp_bptr ? mp_delegate->direct_size () : 0;
+    m_pos = 0;
 
   //  optimize for a reset in the first m_bcap bytes
   //  -> this reduces the reset calls on mp_delegate which may not support this
-  if (m_pos < m_bcap) {
+  } else if (m_pos < m_bcap) {
 
     m_blen += m_pos;
     mp_bptr = mp_buffer;
@@ -613,6 +739,149 @@ InputFile::filename () const
   return tl::filename (m_source);
 }
 
+// ---------------------------------------------------------------
+//  InputMappedFile implementation
+
+InputMappedFile::InputMappedFile (const std::string &path)
+  : m_fd (-1), mp_data (0), m_size (0), m_pos (0)
+#if defined(_WIN32)
+    , mp_mapping (0)
+#endif
+{
+  m_source = path;
+
+#if defined(_WIN32)
+
+  int fd = _wopen (tl::to_wstring (path).c_str (), _O_BINARY | _O_RDONLY | _O_SEQUENTIAL);
+  if (fd < 0) {
+    throw FileOpenErrorException (m_source, errno);
+  }
+  m_fd = fd;
+
+  struct _stati64 st;
+  if (_fstati64 (m_fd, &st) == 0 && (st.st_mode & _S_IFREG) != 0 && st.st_size > 0 && (unsigned long long) st.st_size <= (unsigned long long) std::numeric_limits<size_t>::max ()) {
+
+    HANDLE mapping = CreateFileMappingW ((HANDLE) _get_osfhandle (m_fd), NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping != NULL) {
+      void *data = MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0);
+      if (data != NULL) {
+        mp_mapping = (void *) mapping;
+        mp_data = (const char *) data;
+        m_size = size_t (st.st_size);
+      } else {
+        CloseHandle (mapping);
+      }
+    }
+
+  }
+
+#else
+
+  int fd = open (path.c_str (), O_RDONLY);
+  if (fd < 0) {
+    throw FileOpenErrorException (m_source, errno);
+  }
+  m_fd = fd;
+
+  struct stat st;
+  if (fstat (m_fd, &st) == 0 && S_ISREG (st.st_mode) && st.st_size > 0 && (unsigned long long) st.st_size <= (unsigned long long) std::numeric_limits<size_t>::max ()) {
+
+    void *data = mmap (0, size_t (st.st_size), PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (data != MAP_FAILED) {
+      mp_data = (const char *) data;
+      m_size = size_t (st.st_size);
+#if defined(MADV_SEQUENTIAL)
+      madvise (data, m_size, MADV_SEQUENTIAL);
+#endif
+    }
+
+  }
+
+#endif
+}
+
+InputMappedFile::~InputMappedFile ()
+{
+  close ();
+}
+
+void
+InputMappedFile::close ()
+{
+  if (mp_data) {
+#if defined(_WIN32)
+    UnmapViewOfFile ((LPCVOID) mp_data);
+    CloseHandle ((HANDLE) mp_mapping);
+    mp_mapping = 0;
+#else
+    munmap ((void *) mp_data, m_size);
+#endif
+    mp_data = 0;
+    m_size = 0;
+  }
+
+  if (m_fd >= 0) {
+#if defined(_WIN32)
+    _close (m_fd);
+#else
+    ::close (m_fd);
+#endif
+    m_fd = -1;
+  }  
+}
+
+size_t 
+InputMappedFile::read (char *b, size_t n)
+{
+  if (mp_data) {
+
+    if (m_pos + n > m_size) {
+      n = m_size - m_pos;
+    }
+    memcpy (b, mp_data + m_pos, n);
+    m_pos += n;
+    return n;
+
+  }
+
+  tl_assert (m_fd >= 0);
+#if defined(_WIN32)
+  ptrdiff_t ret = _read (m_fd, b, (unsigned int) n);
+#else
+  ptrdiff_t ret = ::read (m_fd, b, (unsigned int) n);
+#endif
+  if (ret < 0) {
+    throw FileReadErrorException (m_source, errno);
+  }
+  return size_t (ret);
+}
+
+void 
+InputMappedFile::reset ()
+{
+  m_pos = 0;
+
+  if (m_fd >= 0) {
+#if defined(_WIN32)
+    _lseeki64 (m_fd, 0, SEEK_SET);
+#else
+    lseek (m_fd, 0, SEEK_SET);
+#endif
+  }
+}
+
+std::string
+InputMappedFile::absolute_path () const
+{
+  return tl::absolute_file_path (m_source);
+}
+
+std::string
+InputMappedFile::filename () const
+{
+  return tl::filename (m_source);
+}
+
 // ---------------------------------------------------------------
 //  InputZLibFile implementation
 
@@ -30,6 +30,7 @@
 #include "tlString.h"
 
 #include <string>
+#include <vector>
 #include <sstream>
 #include <cstdio>
 #include <cstring>
@@ -55,7 +56,7 @@ extern TL_PUBLIC bool match_filename_to_format (const std::string &fn, const std
  *  @brief The input stream delegate base class
  *
  *  This class provides the basic input stream functionality.
- *  The actual implementation is provided through InputFile, InputPipe and InputZLibFile.
+ *  The actual implementation is provided through InputFile, InputMappedFile, InputPipe and InputZLibFile.
  */
 
 class TL_PUBLIC InputStreamBase
@@ -82,6 +83,16 @@ public:
    */
   virtual void reset () = 0;
 
+  /**
+   *  @brief Returns true, if the stream can be reset
+   *
+   *  Streams returning false here will throw an exception on "reset".
+   */
+  virtual bool is_resettable () const
+  {
+    return true;
+  }
+
   /**
    *  @brief Closes the channel
    */
@@ -101,6 +112,26 @@ public:
    *  @brief Gets the filename part of the source
    */
   virtual std::string filename () const = 0;
+
+  /**
+   *  @brief Gets the address of the data if the source is available as a memory block
+   *
+   *  If this method delivers a non-null pointer, InputStream will take the data
+   *  directly from this memory block rather than using "read". The block needs
+   *  to stay valid until the delegate is closed or destroyed.
+   */
+  virtual const char *direct_data () const
+  {
+    return 0;
+  }
+
+  /**
+   *  @brief Gets the size of the memory block delivered by "direct_data"
+   */
+  virtual size_t direct_size () const
+  {
+    return 0;
+  }
 };
 
 // ---------------------------------------------------------------------------------
@@ -282,6 +313,72 @@ private:
   int m_fd;
 };
 
+/**
+ *  @brief A memory-mapped input file delegate
+ *
+ *  Implements the reader for ordinary files by mapping them into memory.
+ *  InputStream takes the data from the mapped memory without copying it.
+ *  If the file cannot be mapped (e.g. because it is not a regular file), this
+ *  delegate falls back to reading the file like InputFile does.
+ *  The file must not be truncated while it is mapped.
+ */
+class TL_PUBLIC InputMappedFile
+  : public InputStreamBase
+{
+public:
+  /**
+   *  @brief Open and map the file with the given path
+   *
+   *  The constructor will throw a FileOpenErrorException if the file cannot be opened.
+   *
+   *  @param path The (relative) path of the file to open
+   */
+  InputMappedFile (const std::string &path);
+
+  /**
+   *  @brief Unmap and close the file
+   */
+  virtual ~InputMappedFile ();
+
+  virtual size_t read (char *b, size_t n);
+
+  virtual void reset ();
+
+  virtual void close ();
+
+  virtual std::string source () const
+  {
+    return m_source;
+  }
+
+  virtual std::string absolute_path () const;
+
+  virtual std::string filename () const;
+
+  virtual const char *direct_data () const
+  {
+    return mp_data;
+  }
+
+  virtual size_t direct_size () const
+  {
+    return m_size;
+  }
+
+private:
+  //  no copying
+  InputMappedFile (const InputMappedFile &d);
+  InputMappedFile &operator= (const InputMappedFile &d);
+
+  std::string m_source;
+  int m_fd;
+  const char *mp_data;
+  size_t m_size, m_pos;
+#if defined(_WIN32)
+  void *mp_mapping;
+#endif
+};
+
 /**
  *  @brief A simple pipe input delegate
  *
@@ -321,9 +418,19 @@ public:
 
   /**
    *  @brief Reset to the beginning of the file
+   *
+   *  Pipes cannot be reset - this method will throw an exception.
    */
   virtual void reset ();
 
+  /**
+   *  @brief Pipes cannot be reset
+   */
+  virtual bool is_resettable () const
+  {
+    return false;
+  }
+
   /**
    *  @brief Closes the pipe
    *  This method will wait for the child process to terminate.
@@ -398,8 +505,14 @@ public:
    *
    *  This will automatically create the appropriate delegate and 
    *  delete it later.
+   *
+   *  If "map_file" is true, uncompressed local files are mapped into memory
+   *  and the stream delivers the data directly from there (see \is_direct).
+   *  The file must not be truncated while the stream is open: accessing the
+   *  truncated part of the mapping will terminate the process (SIGBUS) on
+   *  most systems. Hence this mode is not enabled by default.
    */
-  InputStream (const std::string &abstract_path);
+  InputStream (const std::string &abstract_path, bool map_file = false);
 
   /**
    *  @brief Destructor
@@ -464,6 +577,30 @@ public:
    */
   void inflate ();
 
+  /**
+   *  @brief Substitutes the following DEFLATE-compressed block by data inflated already
+   *
+   *  This is an alternative to "inflate" for the case that the compressed block has
+   *  been decoded in advance (e.g. by a worker thread). The stream skips "compressed_size" 
+   *  raw bytes. Subsequent get() calls will deliver the given data until it is consumed.
+   *  After that, the stream continues with the raw data following the compressed block.
+   *  The data is taken over from the given vector which is empty afterwards.
+   *  The stream must not be in inflate state yet.
+   *
+   *  @return False, if the compressed block is not entirely available
+   */
+  bool inflate (size_t compressed_size, std::vector<char> &inflated);
+
+  /**
+   *  @brief Gets the next n raw bytes without consuming them
+   *
+   *  This method bypasses inflating and delivers bytes from the raw stream.
+   *  The returned pointer is valid until the next get or peek call.
+   *
+   *  @return 0 if not enough data can be obtained
+   */
+  const char *peek (size_t n);
+
   /**
    *  @brief Obtain the current file position
    */
@@ -472,6 +609,40 @@ public:
     return m_pos;
   }
 
+  /**
+   *  @brief Returns true, if the stream delivers the data directly from the delegate's memory
+   *
+   *  This is the case for memory-mapped files for example. In this mode, no data is copied
+   *  and the raw data pointers delivered by "get" and "peek" stay valid until the stream
+   *  is closed. This does not apply to inflated data.
+   */
+  bool is_direct () const
+  {
+    return m_direct;
+  }
+
+  /**
+   *  @brief Returns true, if the stream can be reset
+   *
+   *  Resetting the stream is possible always if the data is taken directly from memory.
+   *  Otherwise, this depends on the delegate (for example, pipes cannot be reset).
+   */
+  bool is_resettable () const;
+
+  /**
+   *  @brief Returns true, if the stream is delivering inflated data currently
+   *
+   *  In this state, "pos" does not correspond to the position of the data delivered.
+   */
+  bool is_inflating () const;
+
+  /**
+   *  @brief Gets the number of inflated bytes delivered from the current compressed block
+   *
+   *  This value is only meaningful while "is_inflating" is true.
+   */
+  size_t inflated_pos () const;
+
   /**
    *  @brief Obtain the available number of bytes
    *
@@ -549,16 +720,21 @@ private:
   char *mp_buffer;
   size_t m_bcap;
   size_t m_blen;
-  char *mp_bptr;
+  const char *mp_bptr;
   InputStreamBase *mp_delegate;
   bool m_owns_delegate;
+  bool m_direct;
 
   //  inflate support 
   InflateFilter *mp_inflate;
+  std::vector<char> m_inflated;
+  size_t m_inflated_pos;
 
   //  No copying currently
   InputStream (const InputStream &);
   InputStream &operator= (const InputStream &);
+
+  void init_direct ();
 };
 
 // ---------------------------------------------------------------------------------
@@ -159,17 +159,170 @@ TaskList::put_front (Task *task)
   }
 }
 
+// -----------------------------------------------------------------------------
+//  tl::TaskDeque definition and implementation
+
+/**
+ *  @brief A work-stealing task queue
+ *
+ *  This is a Chase-Lev deque: the owning worker puts and takes tasks at the
+ *  bottom end without locking. Other threads steal tasks from the top end
+ *  using a compare-and-swap operation. Only the owner may call "put" and "take"
+ *  while the workers are running.
+ *
+ *  The buffer grows if required. Old buffers are kept until the deque is
+ *  destroyed because thieves may still read from them.
+ */
+class TaskDeque
+{
+public:
+  TaskDeque ()
+    : m_top (0), m_bottom (0)
+  {
+    mp_buffer = new Buffer (64);
+  }
+
+  ~TaskDeque ()
+  {
+    bool retry = false;
+    Task *task;
+    while ((task = steal (retry)) != 0 || retry) {
+      delete task;
+      retry = false;
+    }
+
+    for (std::vector<Buffer *>::const_iterator b = m_retired.begin (); b != m_retired.end (); ++b) {
+      delete *b;
+    }
+    delete mp_buffer;
+  }
+
+  bool is_empty () const
+  {
+    long t = m_top.load ();
+    long b = m_bottom.load ();
+    return b <= t;
+  }
+
+  void put (Task *task)
+  {
+    long b = m_bottom.load ();
+    long t = m_top.load ();
+
+    Buffer *buffer = mp_buffer;
+    if (b - t >= buffer->size) {
+      buffer = grow (t, b);
+    }
+
+    buffer->set (b, task);
+    m_bottom.store (b + 1);
+  }
+
+  Task *take ()
+  {
+    long b = m_bottom.load () - 1;
+    Buffer *buffer = mp_buffer;
+    m_bottom.store (b);
+
+    long t = m_top.load ();
+    if (t > b) {
+      //  empty
+      m_bottom.store (b + 1);
+      return 0;
+    }
+
+    Task *task = buffer->get (b);
+    if (t == b) {
+      //  the last task: compete with the thieves
+      if (! m_top.compare_exchange (t, t + 1)) {
+        task = 0;
+      }
+      m_bottom.store (b + 1);
+    }
+
+    return task;
+  }
+
+  Task *steal (bool &retry)
+  {
+    long t = m_top.load ();
+    long b = m_bottom.load ();
+    if (t >= b) {
+      return 0;
+    }
+
+    Task *task = mp_buffer->get (t);
+    if (! m_top.compare_exchange (t, t + 1)) {
+      //  lost the race against the owner or another thief
+      retry = true;
+      return 0;
+    }
+
+    return task;
+  }
+
+private:
+  struct Buffer
+  {
+    Buffer (long _size)
+      : size (_size), tasks (new Task * [_size])
+    { }
+
+    ~Buffer ()
+    {
+      delete [] tasks;
+    }
+
+    Task *get (long i) const
+    {
+      return tasks [i & (size - 1)];
+    }
+
+    void set (long i, Task *task)
+    {
+      tasks [i & (size - 1)] = task;
+    }
+
+    long size;
+    Task **tasks;
+  };
+
+  atomic::atomic<long> m_top, m_bottom;
+  Buffer * volatile mp_buffer;
+  std::vector<Buffer *> m_retired;
+
+  Buffer *grow (long t, long b)
+  {
+    Buffer *old_buffer = mp_buffer;
+    Buffer *buffer = new Buffer (old_buffer->size * 2);
+    for (long i = t; i < b; ++i) {
+      buffer->set (i, old_buffer->get (i));
+    }
+
+    m_retired.push_back (old_buffer);
+    mp_buffer = buffer;
+    return buffer;
+  }
+};
+
+/**
+ *  @brief The worker executing the current thread
+ */
+static tl::ThreadStorage<Worker *> s_current_worker;
+
 // -----------------------------------------------------------------------------
 //  tl::JobBase implementation
 
 JobBase::JobBase (int nworkers)
-  : m_nworkers (nworkers), m_idle_workers (0), m_stopping (false), m_running (false)
+  : m_sleeping (0), m_next_initial_task (0), m_nworkers (nworkers), m_idle_workers (0), m_stopping (false), m_running (false)
 {
   if (nworkers > 0) {
     mp_per_worker_task_lists = new TaskList[nworkers];
   } else {
     mp_per_worker_task_lists = 0;
   }
+
+  create_deques ();
 }
 
 JobBase::~JobBase ()
@@ -184,6 +337,25 @@ JobBase::~JobBase ()
     delete[] mp_per_worker_task_lists;
     mp_per_worker_task_lists = 0;
   }
+
+  delete_deques ();
+}
+
+void
+JobBase::create_deques ()
+{
+  for (int i = 0; i < m_nworkers; ++i) {
+    m_deques.push_back (new TaskDeque ());
+  }
+}
+
+void
+JobBase::delete_deques ()
+{
+  for (std::vector<TaskDeque *>::const_iterator d = m_deques.begin (); d != m_deques.end (); ++d) {
+    delete *d;
+  }
+  m_deques.clear ();
 }
 
 void
@@ -237,6 +409,9 @@ JobBase::set_num_workers (int nworkers)
   } else {
     mp_per_worker_task_lists = 0;
   }
+
+  delete_deques ();
+  create_deques ();
 }
 
 void 
@@ -249,7 +424,19 @@ JobBase::start ()
   tl_assert (! m_running);
 
   m_running = true;
-  
+
+  //  The tasks scheduled so far are taken from an array by an atomic index, so the workers don't
+  //  compete for the lock of the common queue while the tasks are still started in the order they
+  //  were scheduled.
+  //  NOTE: the workers are idle now, so it's safe to fill the array.
+  m_initial_tasks.clear ();
+  m_next_initial_task.store (0);
+  if (m_nworkers > 0) {
+    while (! m_task_list.is_empty ()) {
+      m_initial_tasks.push_back (m_task_list.fetch ());
+    }
+  }
+
   //  Add a start task for each worker
   //  This serves as a synchronization measure such that each task gets called once and
   //  the empty queue detection works properly.
@@ -348,6 +535,21 @@ JobBase::stop ()
     delete m_task_list.fetch ();
   }
 
+  //  Taking the initial tasks and stealing is safe from any thread
+  Task *initial_task;
+  while ((initial_task = take_initial_task ()) != 0) {
+    delete initial_task;
+  }
+
+  for (std::vector<TaskDeque *>::const_iterator d = m_deques.begin (); d != m_deques.end (); ++d) {
+    bool retry = false;
+    Task *task;
+    while ((task = (*d)->steal (retry)) != 0 || retry) {
+      delete task;
+      retry = false;
+    }
+  }
+
   if (! mp_workers.empty ()) {
 
     bool any_working = false;
@@ -422,6 +624,15 @@ JobBase::terminate ()
 void 
 JobBase::schedule (Task *task)
 {
+  //  Tasks scheduled by one of our workers go into the worker's own queue
+  if (! m_deques.empty () && m_running && ! m_stopping && s_current_worker.hasLocalData ()) {
+    Worker *worker = s_current_worker.localData ();
+    if (worker && worker->mp_job == this) {
+      schedule_local (worker->m_worker_index, task);
+      return;
+    }
+  }
+
   m_lock.lock ();
 
   if (m_stopping) {
@@ -443,47 +654,124 @@ JobBase::schedule (Task *task)
   m_lock.unlock ();
 }
 
+void
+JobBase::schedule_local (int worker, Task *task)
+{
+  m_deques [worker]->put (task);
+
+  //  wake up sleeping workers so they can steal the task
+  //  NOTE: the sleeping workers announce themselves before they check the queues, so
+  //  either they see the new task or we see them.
+  if (m_sleeping.load () > 0) {
+    m_lock.lock ();
+    m_task_available_condition.wakeAll ();
+    m_lock.unlock ();
+  }
+}
+
+Task *
+JobBase::take_initial_task ()
+{
+  long n = long (m_initial_tasks.size ());
+  if (m_next_initial_task.load () >= n) {
+    return 0;
+  }
+
+  long i = ++m_next_initial_task - 1;
+  return i < n ? m_initial_tasks [i] : 0;
+}
+
+bool
+JobBase::has_queued_tasks () const
+{
+  if (m_next_initial_task.load () < long (m_initial_tasks.size ())) {
+    return true;
+  }
+  for (std::vector<TaskDeque *>::const_iterator d = m_deques.begin (); d != m_deques.end (); ++d) {
+    if (! (*d)->is_empty ()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Task *
+JobBase::steal_task (int worker)
+{
+  int n = int (m_deques.size ());
+
+  bool retry;
+  do {
+    retry = false;
+    for (int i = 1; i < n; ++i) {
+      Task *task = m_deques [(worker + i) % n]->steal (retry);
+      if (task) {
+        return task;
+      }
+    }
+  } while (retry);
+
+  return 0;
+}
+
 Task *
 JobBase::get_task (int worker)
 {
   while (true) {
 
-    m_lock.lock ();
+    //  first try our own queue, then the tasks scheduled before start, then try to steal a task
+    //  from another worker
+    Task *task = m_deques [worker]->take ();
+    if (! task) {
+      task = take_initial_task ();
+    }
+    if (! task) {
+      task = steal_task (worker);
+    }
+
+    if (! task) {
 
-    //  wait for new relevant entries in the task queue
-    while (m_task_list.is_empty () && mp_per_worker_task_lists [worker].is_empty ()) {
+      m_lock.lock ();
 
-      //  if the queue is empty, mark this worker as idle.
-      ++m_idle_workers;
+      ++m_sleeping;
 
-      //  signal empty queue if all workers are waiting
-      if (m_idle_workers == m_nworkers) {
-        if (! m_stopping) {
-          finished ();
+      //  wait for new relevant entries in the task queue
+      while (m_task_list.is_empty () && mp_per_worker_task_lists [worker].is_empty () && ! has_queued_tasks ()) {
+
+        //  if the queue is empty, mark this worker as idle.
+        ++m_idle_workers;
+
+        //  signal empty queue if all workers are waiting
+        if (m_idle_workers == m_nworkers) {
+          if (! m_stopping) {
+            finished ();
+          }
+          m_running = false;
+          m_queue_empty_condition.wakeAll ();
         }
-        m_running = false;
-        m_queue_empty_condition.wakeAll ();
-      }
 
-      //  wait until we receive a task
-      while (m_task_list.is_empty () && mp_per_worker_task_lists [worker].is_empty ()) {
-        mp_workers [worker]->set_idle (true);
-        m_task_available_condition.wait (&m_lock);
-        mp_workers [worker]->set_idle (false);
-      }
+        //  wait until we receive a task
+        while (m_task_list.is_empty () && mp_per_worker_task_lists [worker].is_empty () && ! has_queued_tasks ()) {
+          mp_workers [worker]->set_idle (true);
+          m_task_available_condition.wait (&m_lock);
+          mp_workers [worker]->set_idle (false);
+        }
 
-      --m_idle_workers;
+        --m_idle_workers;
 
-    } 
+      } 
 
-    Task *task = 0;
-    if (! mp_per_worker_task_lists [worker].is_empty ()) {
-      task = mp_per_worker_task_lists [worker].fetch ();
-    } else if (! m_task_list.is_empty ()) {
-      task = m_task_list.fetch ();
-    }
+      --m_sleeping;
 
-    m_lock.unlock ();
+      if (! mp_per_worker_task_lists [worker].is_empty ()) {
+        task = mp_per_worker_task_lists [worker].fetch ();
+      } else if (! m_task_list.is_empty ()) {
+        task = m_task_list.fetch ();
+      }
+
+      m_lock.unlock ();
+
+    }
 
     if (dynamic_cast <ExitTask *> (task) != 0) {
       delete task;
@@ -492,6 +780,9 @@ JobBase::get_task (int worker)
     } else if (dynamic_cast <StartTask *> (task) != 0) {
       delete task;
       //  dummy task for synchronization - wait for new tasks to arrive.
+    } else if (task && m_stopping) {
+      //  discard tasks from the queues while stopping
+      delete task;
     } else if (task) {
       return task;
     }
@@ -582,6 +873,7 @@ void
 Worker::run ()
 {
   WorkerProgressAdaptor progress_adaptor (this);
+  s_current_worker.setLocalData (this);
 
   while (true)
   {
@@ -26,6 +26,7 @@
 
 #include "tlCommon.h"
 #include "tlThreads.h"
+#include "atomic/atomic.h"
 
 #include <set>
 #include <vector>
@@ -58,6 +59,7 @@ namespace tl
 class Boss;
 class Worker;
 class Task;
+class TaskDeque;
 
 /**
  *  @brief A task list
@@ -123,6 +125,12 @@ private:
  *  A job is organised in tasks, which are scheduled to the job. Upon \start,
  *  the job takes the tasks from a queue and sends them to the workers for
  *  being processed.
+ *
+ *  The tasks scheduled before \start are taken by the workers in the order they
+ *  were scheduled without locking. Each worker also has its own task queue. Tasks
+ *  scheduled from within a task are put into the queue of the worker executing
+ *  that task. A worker takes the tasks from its own queue without locking. When
+ *  its queue is empty, it steals tasks from the other worker's queues (work stealing).
  */
 class TL_PUBLIC JobBase
 {
@@ -157,8 +165,11 @@ public:
    *  This does not trigger the actual operation yet. It should be done separately before
    *  \start is called. However, it is possible to schedule jobs while the job is running and
    *  even from within other tasks.
-   *  It is guaranteed that the order of processing of the tasks is maintained. However, 
-   *  it is not guaranteed that previous tasks have been processed already because they
+   *  Tasks scheduled from outside the workers are started in the order they have been
+   *  scheduled. This order is not guaranteed for tasks scheduled from within a task
+   *  (sub-tasks): these are taken by the same worker next, unless they are stolen by an
+   *  idle worker. The job will not finish before all sub-tasks have been processed.
+   *  It is not guaranteed that previous tasks have been processed already because they
    *  might be send to a different thread.
    */
   void schedule (Task *task);
@@ -259,6 +270,10 @@ private:
 
   TaskList m_task_list;
   TaskList *mp_per_worker_task_lists;
+  std::vector<TaskDeque *> m_deques;
+  atomic::atomic<int> m_sleeping;
+  std::vector<Task *> m_initial_tasks;
+  atomic::atomic<long> m_next_initial_task;
 
   int m_nworkers;
   int m_idle_workers;
@@ -275,6 +290,12 @@ private:
   std::vector<std::string> m_error_messages;
 
   Task *get_task (int for_worker);
+  Task *steal_task (int for_worker);
+  Task *take_initial_task ();
+  void schedule_local (int worker, Task *task);
+  bool has_queued_tasks () const;
+  void create_deques ();
+  void delete_deques ();
   void log_error (const std::string &s);
 };
 
@@ -27,6 +27,7 @@
 
 #ifndef _WIN32
 #  include <sys/times.h>
+#  include <sys/resource.h>
 #endif
 
 #include <stdio.h>
@@ -39,6 +40,11 @@
 #  include <Windows.h>
 #endif
 
+#if defined(_WIN32)
+#  include <windows.h>
+#  include <psapi.h>
+#endif
+
 #if defined(__MACH__)
 #  include <mach/clock.h>
 #  include <mach/mach.h>
@@ -186,6 +192,71 @@ Timer::take ()
   m_wall_ms = wall_ms;
 }
 
+size_t
+Timer::memory_size ()
+{
+#if defined(_WIN32)
+
+  PROCESS_MEMORY_COUNTERS mem_info;
+  if (GetProcessMemoryInfo (GetCurrentProcess (), &mem_info, sizeof (mem_info))) {
+    return size_t (mem_info.WorkingSetSize);
+  }
+  return 0;
+
+#elif defined(__MACH__)
+
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info (mach_task_self (), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) == KERN_SUCCESS) {
+    return size_t (info.resident_size);
+  }
+  return 0;
+
+#else
+
+  //  second field of /proc/self/statm is the resident set size in pages
+  size_t res = 0;
+  FILE *statm = fopen ("/proc/self/statm", "r");
+  if (statm) {
+    unsigned long vm_pages = 0, rss_pages = 0;
+    if (fscanf (statm, "%lu %lu", &vm_pages, &rss_pages) == 2) {
+      res = size_t (rss_pages) * size_t (sysconf (_SC_PAGESIZE));
+    }
+    fclose (statm);
+  }
+  return res;
+
+#endif
+}
+
+size_t
+Timer::peak_memory_size ()
+{
+#if defined(_WIN32)
+
+  PROCESS_MEMORY_COUNTERS mem_info;
+  if (GetProcessMemoryInfo (GetCurrentProcess (), &mem_info, sizeof (mem_info))) {
+    return size_t (mem_info.PeakWorkingSetSize);
+  }
+  return 0;
+
+#else
+
+  struct rusage usage;
+  if (getrusage (RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#if defined(__MACH__)
+  //  Mac OS reports bytes
+  return size_t (usage.ru_maxrss);
+#else
+  //  Linux reports kilobytes
+  return size_t (usage.ru_maxrss) * 1024;
+#endif
+
+#endif
+}
+
 void
 SelfTimer::start_report () const
 {
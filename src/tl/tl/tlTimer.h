@@ -28,6 +28,7 @@
 
 #include <string>
 #include <stdint.h>
+#include <stddef.h>
 #include <time.h>
 
 class QDateTime;
@@ -95,6 +96,22 @@ public:
     return (double (m_wall_ms_res) * 0.001);
   }
 
+  /**
+   *  @brief Gets the current memory usage of the process in bytes
+   *
+   *  This is the resident set size of the process. If this value cannot be
+   *  determined on the platform, 0 is returned.
+   */
+  static size_t memory_size ();
+
+  /**
+   *  @brief Gets the peak memory usage of the process in bytes
+   *
+   *  This is the maximum resident set size the process had so far.
+   *  If this value cannot be determined on the platform, 0 is returned.
+   */
+  static size_t peak_memory_size ();
+
 private:
   timer_t m_user_ms, m_sys_ms, m_wall_ms;
   timer_t m_user_ms_res, m_sys_ms_res, m_wall_ms_res;
@@ -26,13 +26,14 @@
 #include "tlLog.h"
 #include "tlAssert.h"
 #include "tlProgress.h"
+#include "tlXMLPullParser.h"
 
 #include <cstring>
 #include <memory>
 
 #if defined(HAVE_EXPAT)
-
 #include <expat.h>
+#endif
 
 namespace tl
 {
@@ -116,6 +117,18 @@ public:
     mp_stream->reset ();
   }
 
+  tl::InputStream &stream ()
+  {
+    return *mp_stream;
+  }
+
+  void update_progress ()
+  {
+    if (mp_progress.get ()) {
+      mp_progress->set (mp_stream->pos ());
+    }
+  }
+
 private:
   std::auto_ptr<tl::InputStream> mp_stream_holder;
   tl::InputStream *mp_stream;
@@ -205,6 +218,13 @@ XMLStreamSource::~XMLStreamSource ()
   //  .. nothing yet ..
 }
 
+}
+
+#if defined(HAVE_EXPAT)
+
+namespace tl
+{
+
 // --------------------------------------------------------------------
 //  XMLParser implementation
 
@@ -376,373 +396,67 @@ XMLParser::is_available ()
 
 }
 
-#elif defined(HAVE_QT)
-
-#include <QFile>
-#include <QIODevice>
-#include <QXmlContentHandler>
+#else
 
 namespace tl
 {
 
 // --------------------------------------------------------------------
-//  A SAX handler for the Qt implementation
-
-class SAXHandler
-  : public QXmlDefaultHandler
-{
-public:
-  SAXHandler (XMLStructureHandler *sh);
-
-  bool characters (const QString &ch);
-  bool endElement (const QString &namespaceURI, const QString &localName, const QString &qName);
-  bool startElement (const QString &namespaceURI, const QString &localName, const QString &qName, const QXmlAttributes &atts);
-  bool error (const QXmlParseException &exception);
-  bool fatalError (const QXmlParseException &exception);
-  bool warning (const QXmlParseException &exception);
-
-  void setDocumentLocator (QXmlLocator *locator);
-
-private:
-  QXmlLocator *mp_locator;
-  XMLStructureHandler *mp_struct_handler;
-};
-
-// --------------------------------------------------------------------------------------------------------
-//  trureHandler implementation
-
-SAXHandler::SAXHandler (XMLStructureHandler *sh)
-  : QXmlDefaultHandler (), mp_locator (0), mp_struct_handler (sh)
-{
-  // .. nothing yet ..
-}
-
-void
-SAXHandler::setDocumentLocator (QXmlLocator *locator)
-{
-  mp_locator = locator;
-}
-
-bool
-SAXHandler::startElement (const QString &qs_uri, const QString &qs_lname, const QString &qs_qname, const QXmlAttributes & /*atts*/)
-{
-  std::string uri (tl::to_string (qs_uri));
-  std::string lname (tl::to_string (qs_lname));
-  std::string qname (tl::to_string (qs_qname));
-
-  try {
-    mp_struct_handler->start_element (uri, lname, qname);
-  } catch (tl::XMLException &ex) {
-    throw tl::XMLLocatedException (ex.raw_msg (), mp_locator->lineNumber (), mp_locator->columnNumber ());
-  } catch (tl::Exception &ex) {
-    throw tl::XMLLocatedException (ex.msg (), mp_locator->lineNumber (), mp_locator->columnNumber ());
-  }
-
-  //  successful
-  return true;
-}
-
-bool
-SAXHandler::endElement (const QString &qs_uri, const QString &qs_lname, const QString &qs_qname)
-{
-  std::string uri (tl::to_string (qs_uri));
-  std::string lname (tl::to_string (qs_lname));
-  std::string qname (tl::to_string (qs_qname));
-
-  try {
-    mp_struct_handler->end_element (uri, lname, qname);
-  } catch (tl::XMLException &ex) {
-    throw tl::XMLLocatedException (ex.raw_msg (), mp_locator->lineNumber (), mp_locator->columnNumber ());
-  } catch (tl::Exception &ex) {
-    throw tl::XMLLocatedException (ex.msg (), mp_locator->lineNumber (), mp_locator->columnNumber ());
-  }
-
-  //  successful
-  return true;
-}
-
-bool
-SAXHandler::characters (const QString &t)
-{
-  try {
-    mp_struct_handler->characters (tl::to_string (t));
-  } catch (tl::XMLException &ex) {
-    throw tl::XMLLocatedException (ex.raw_msg (), mp_locator->lineNumber (), mp_locator->columnNumber ());
-  } catch (tl::Exception &ex) {
-    throw tl::XMLLocatedException (ex.msg (), mp_locator->lineNumber (), mp_locator->columnNumber ());
-  }
-
-  //  successful
-  return true;
-}
-
-bool
-SAXHandler::error (const QXmlParseException &ex)
-{
-  throw tl::XMLLocatedException (tl::to_string (ex.message ()), ex.lineNumber (), ex.columnNumber ());
-}
-
-bool
-SAXHandler::fatalError (const QXmlParseException &ex)
-{
-  throw tl::XMLLocatedException (tl::to_string (ex.message ()), ex.lineNumber (), ex.columnNumber ());
-}
-
-bool
-SAXHandler::warning (const QXmlParseException &ex)
-{
-  tl::XMLLocatedException lex (tl::to_string (ex.message ()), ex.lineNumber (), ex.columnNumber ());
-  tl::warn << lex.msg ();
-  //  continue
-  return true;
-}
-
-// --------------------------------------------------------------------
-//  SourcePrivateData implementation
+//  XMLParser implementation (built-in pull parser)
 
-class XMLSourcePrivateData
-  : public QXmlInputSource
+class XMLParserPrivateData
 {
 public:
-  XMLSourcePrivateData ()
-    : QXmlInputSource ()
-  {
-    //  .. nothing yet ..
-  }
-
-  XMLSourcePrivateData (QIODevice *dev)
-    : QXmlInputSource (dev)
+  XMLParserPrivateData ()
   {
     //  .. nothing yet ..
   }
-};
 
-// --------------------------------------------------------------------
-//  XMLSource implementation
-
-XMLSource::XMLSource ()
-  : mp_source (0)
-{
-  //  .. nothing yet ..
-}
-
-XMLSource::~XMLSource ()
-{
-  delete mp_source;
-  mp_source = 0;
-}
-
-void
-XMLSource::reset ()
-{
-  mp_source->reset ();
-}
-
-// --------------------------------------------------------------------
-//  XMLStringSource implementation
-
-XMLStringSource::XMLStringSource (const std::string &string)
-{
-  XMLSourcePrivateData *source = new XMLSourcePrivateData ();
-  source->setData (QByteArray (string.c_str ()));
-  set_source (source);
-}
-
-XMLStringSource::XMLStringSource (const char *cp)
-{
-  XMLSourcePrivateData *source = new XMLSourcePrivateData ();
-  source->setData (QByteArray (cp));
-  set_source (source);
-}
-
-XMLStringSource::XMLStringSource (const char *cp, size_t len)
-{
-  XMLSourcePrivateData *source = new XMLSourcePrivateData ();
-  source->setData (QByteArray (cp, int (len)));
-  set_source (source);
-}
-
-XMLStringSource::~XMLStringSource ()
-{
-  //  .. nothing yet ..
-}
-
-// --------------------------------------------------------------------
-//  StreamIODevice definition and implementation
-
-class StreamIODevice
-  : public QIODevice
-{
-public:
-  StreamIODevice (tl::InputStream &stream)
-    : mp_stream (&stream),
-      mp_progress (0),
-      m_has_error (false)
+  void parse (tl::XMLSource &source, XMLStructureHandler &struct_handler)
   {
-    open (QIODevice::ReadOnly);
-  }
+    XMLSourcePrivateData *sd = source.source ();
+    XMLPullParser parser (sd->stream ());
 
-  StreamIODevice (tl::InputStream &stream, const std::string &progress_message)
-    : mp_stream (&stream),
-      mp_progress (new AbsoluteProgress (progress_message, 100)),
-      m_has_error (false)
-  {
-    mp_progress->set_format (tl::to_string (tr ("%.0f MB")));
-    mp_progress->set_unit (1024 * 1024);
-    open (QIODevice::ReadOnly);
-  }
+    //  TODO: Provide namespace URI?
+    const std::string uri;
 
-  StreamIODevice (const std::string &path)
-    : mp_stream_holder (new tl::InputStream (path)),
-      mp_progress (0),
-      m_has_error (false)
-  {
-    mp_stream = mp_stream_holder.get ();
-    open (QIODevice::ReadOnly);
-  }
-
-  StreamIODevice (const std::string &path, const std::string &progress_message)
-    : mp_stream_holder (new tl::InputStream (path)),
-      mp_progress (new AbsoluteProgress (progress_message, 100)),
-      m_has_error (false)
-  {
-    mp_stream = mp_stream_holder.get ();
-    mp_progress->set_format (tl::to_string (tr ("%.0f MB")));
-    mp_progress->set_unit (1024 * 1024);
-    open (QIODevice::ReadOnly);
-  }
+    try {
 
-  ~StreamIODevice ()
-  {
-    if (mp_progress) {
-      delete mp_progress;
-      mp_progress = 0;
-    }
-  }
+      size_t n = 0;
 
-  virtual bool isSequential () const
-  {
-    return true;
-  }
+      while (true) {
 
-  qint64 writeData (const char *, qint64) 
-  {
-    tl_assert (false);
-  }
+        XMLPullParser::token_type t = parser.next ();
 
-  qint64 readData (char *data, qint64 n)
-  {
-    try {
+        if (t == XMLPullParser::EndDocument) {
+          break;
+        }
 
-      if (mp_progress) {
-        mp_progress->set (mp_stream->pos ());
-      }
+        if (t == XMLPullParser::StartElement) {
+          m_lname = parser.local_name ();
+          struct_handler.start_element (uri, m_lname, parser.name ());
+        } else if (t == XMLPullParser::EndElement) {
+          m_lname = parser.local_name ();
+          struct_handler.end_element (uri, m_lname, parser.name ());
+        } else if (t == XMLPullParser::Characters) {
+          struct_handler.characters (parser.text ());
+        }
 
-      qint64 n0 = n;
-      for (const char *rd = 0; n > 0 && (rd = mp_stream->get (1)) != 0; ) {
-        //  NOTE: we skip CR to compensate for Windows CRLF line terminators (issue #419).
-        if (*rd != '\r') {
-          *data++ = *rd;
-          --n;
+        if (++n % 10000 == 0) {
+          sd->update_progress ();
         }
-      }
 
-      if (n0 == n) {
-        return -1;
-      } else {
-        return n0 - n;
       }
 
+    } catch (tl::XMLLocatedException &) {
+      throw;
     } catch (tl::Exception &ex) {
-      setErrorString (tl::to_qstring (ex.msg ()));
-      m_has_error = true;
-      return -1;
-    }
-  }
-
-  bool has_error () const
-  {
-    return m_has_error;
-  }
-
-private:
-  tl::InputStream *mp_stream;
-  std::auto_ptr<tl::InputStream> mp_stream_holder;
-  tl::AbsoluteProgress *mp_progress;
-  bool m_has_error;
-};
-
-// --------------------------------------------------------------------
-//  XMLFileSource implementation
-
-class XMLStreamSourcePrivateData
-  : public XMLSourcePrivateData
-{
-public:
-  XMLStreamSourcePrivateData (StreamIODevice *io)
-    : XMLSourcePrivateData (io), mp_io (io)
-  {
-    //  .. nothing yet ..
-  }
-
-  virtual void fetchData ()
-  {
-    QXmlInputSource::fetchData ();
-
-    //  This feature is actually missing in the original implementation: throw an exception on error
-    if (mp_io->has_error ()) {
-      throw tl::Exception (tl::to_string (mp_io->errorString ()));
+      throw tl::XMLLocatedException (ex.msg (), parser.line (), parser.column ());
     }
   }
 
 private:
-  std::auto_ptr<StreamIODevice> mp_io;
-};
-
-// --------------------------------------------------------------------
-//  XMLFileSource implementation
-
-XMLFileSource::XMLFileSource (const std::string &path, const std::string &progress_message)
-{
-  set_source (new XMLStreamSourcePrivateData (new StreamIODevice (path, progress_message)));
-}
-
-XMLFileSource::XMLFileSource (const std::string &path)
-{
-  set_source (new XMLStreamSourcePrivateData (new StreamIODevice (path)));
-}
-
-XMLFileSource::~XMLFileSource ()
-{
-  //  .. nothing yet ..
-}
-
-// --------------------------------------------------------------------
-//  XMLStreamSource implementation
-
-XMLStreamSource::XMLStreamSource (tl::InputStream &s, const std::string &progress_message)
-{
-  set_source (new XMLStreamSourcePrivateData (new StreamIODevice (s, progress_message)));
-}
-
-XMLStreamSource::XMLStreamSource (tl::InputStream &s)
-{
-  set_source (new XMLStreamSourcePrivateData (new StreamIODevice (s)));
-}
-
-XMLStreamSource::~XMLStreamSource ()
-{
-  //  .. nothing yet ..
-}
-
-// --------------------------------------------------------------------
-//  XMLParser implementation
-
-class XMLParserPrivateData
-  : public QXmlSimpleReader
-{
-public:
-  XMLParserPrivateData () : QXmlSimpleReader () { }
+  std::string m_lname;
 };
 
 XMLParser::XMLParser ()
@@ -757,15 +471,10 @@ XMLParser::~XMLParser ()
   mp_data = 0;
 }
 
-void 
+void
 XMLParser::parse (XMLSource &source, XMLStructureHandler &struct_handler)
 {
-  SAXHandler handler (&struct_handler);
-
-  mp_data->setContentHandler (&handler);
-  mp_data->setErrorHandler (&handler);
-
-  mp_data->parse (source.source (), false /*=not incremental*/);
+  mp_data->parse (source, struct_handler);
 }
 
 bool
@@ -776,118 +485,6 @@ XMLParser::is_available ()
 
 }
 
-#else
-
-namespace tl
-{
-
-// --------------------------------------------------------------------
-//  XMLSource implementation
-
-XMLSource::XMLSource ()
-  : mp_source (0)
-{
-  //  .. nothing yet ..
-}
-
-XMLSource::~XMLSource ()
-{
-  //  .. nothing yet ..
-}
-
-void
-XMLSource::reset ()
-{
-  //  .. nothing yet ..
-}
-
-// --------------------------------------------------------------------
-//  XMLStringSource implementation
-
-XMLStringSource::XMLStringSource (const std::string &)
-{
-  tl_assert (false);
-}
-
-XMLStringSource::XMLStringSource (const char *)
-{
-  tl_assert (false);
-}
-
-XMLStringSource::XMLStringSource (const char *, size_t)
-{
-  tl_assert (false);
-}
-
-XMLStringSource::~XMLStringSource ()
-{
-  //  .. nothing yet ..
-}
-
-// --------------------------------------------------------------------
-//  XMLFileSource implementation
-
-XMLFileSource::XMLFileSource (const std::string &, const std::string &)
-{
-  tl_assert (false);
-}
-
-XMLFileSource::XMLFileSource (const std::string &)
-{
-  tl_assert (false);
-}
-
-XMLFileSource::~XMLFileSource ()
-{
-  //  .. nothing yet ..
-}
-
-// --------------------------------------------------------------------
-//  XMLStreamSource implementation
-
-XMLStreamSource::XMLStreamSource (tl::InputStream &, const std::string &)
-{
-  tl_assert (false);
-}
-
-XMLStreamSource::XMLStreamSource (tl::InputStream &)
-{
-  tl_assert (false);
-}
-
-XMLStreamSource::~XMLStreamSource ()
-{
-  //  .. nothing yet ..
-}
-
-// --------------------------------------------------------------------
-//  XMLParser implementation
-
-XMLParser::XMLParser ()
-  : mp_data (0)
-{
-  //  .. nothing yet ..
-}
-
-XMLParser::~XMLParser ()
-{
-  //  .. nothing yet ..
-}
-
-void
-XMLParser::parse (XMLSource &, XMLStructureHandler &)
-{
-  tl_assert (false);
-}
-
-bool
-XMLParser::is_available ()
-{
-  return false;
-}
-
-}
-
 #endif
 
 namespace tl {
@@ -304,8 +304,8 @@ class XMLSourcePrivateData;
  *  @brief A generic XML text source class
  *
  *  This class is the base class providing input for 
- *  the Qt XML parser and basically maps to a QXmlInputSource object
- *  for compatibility with the "libparsifal" branch.
+ *  the XML parser. The parser is either expat (if available) or
+ *  the built-in tl::XMLPullParser.
  */
 
 class TL_PUBLIC XMLSource 
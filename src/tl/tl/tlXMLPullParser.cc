@@ -0,0 +1,692 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "tlXMLPullParser.h"
+#include "tlXMLParser.h"
+#include "tlInternational.h"
+
+#include <cstring>
+
+namespace tl
+{
+
+//  The size of the chunks read from the stream
+const size_t read_chunk_size = 65536;
+
+static inline bool is_space (int c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline bool is_name_start (int c)
+{
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':' || c >= 0x80;
+}
+
+static inline bool is_name_char (int c)
+{
+  return is_name_start (c) || (c >= '0' && c <= '9') || c == '-' || c == '.';
+}
+
+XMLPullParser::XMLPullParser (tl::InputStream &stream)
+  : mp_stream (&stream), mp_ptr (0), mp_end (0), m_at_end (false), m_last_cr (false), m_latin1 (false), m_started (false),
+    m_line (1), m_column (0),
+    m_token (StartElement), m_tag_pending (false), m_end_pending (false), m_had_root (false),
+    m_nattr (0), m_depth (0)
+{
+  //  .. nothing yet ..
+}
+
+bool
+XMLPullParser::fill ()
+{
+  if (m_at_end) {
+    return false;
+  }
+
+  m_buffer = mp_stream->read_all (read_chunk_size);
+  if (m_buffer.empty ()) {
+    m_at_end = true;
+    mp_ptr = mp_end = 0;
+    return false;
+  }
+
+  mp_ptr = m_buffer.c_str ();
+  mp_end = mp_ptr + m_buffer.size ();
+
+  if (! m_started) {
+    m_started = true;
+    check_encoding ();
+  }
+
+  return true;
+}
+
+void
+XMLPullParser::check_encoding ()
+{
+  const unsigned char *p = (const unsigned char *) mp_ptr;
+  size_t n = mp_end - mp_ptr;
+
+  //  skip a UTF-8 byte order mark
+  if (n >= 3 && p [0] == 0xef && p [1] == 0xbb && p [2] == 0xbf) {
+    mp_ptr += 3;
+    return;
+  }
+
+  //  UTF-16 is recognized by the byte order mark or by the zero byte next to the first character
+  if (n >= 2 && ((p [0] == 0xff && p [1] == 0xfe) || (p [0] == 0xfe && p [1] == 0xff) || (p [0] == 0 && p [1] != 0) || (p [0] != 0 && p [1] == 0))) {
+    error (tl::sprintf (tl::to_string (tr ("unsupported encoding '%s'")), "UTF-16"));
+  }
+}
+
+inline int
+XMLPullParser::peek ()
+{
+  while (mp_ptr == mp_end || (m_last_cr && *mp_ptr == '\n')) {
+    if (mp_ptr == mp_end) {
+      if (! fill ()) {
+        return -1;
+      }
+    } else {
+      //  skip the LF of a CR/LF sequence
+      ++mp_ptr;
+      m_last_cr = false;
+    }
+  }
+
+  m_last_cr = false;
+
+  unsigned char c = (unsigned char) *mp_ptr;
+  return c == '\r' ? '\n' : int (c);
+}
+
+inline int
+XMLPullParser::get ()
+{
+  int c = peek ();
+  if (c < 0) {
+    return c;
+  }
+
+  m_last_cr = (*mp_ptr == '\r');
+  ++mp_ptr;
+
+  if (c == '\n') {
+    ++m_line;
+    m_column = 0;
+  } else if ((c & 0xc0) != 0x80 || m_latin1) {
+    ++m_column;
+  }
+
+  return c;
+}
+
+void
+XMLPullParser::error (const std::string &msg) const
+{
+  throw tl::XMLLocatedException (msg, m_line, m_column);
+}
+
+void
+XMLPullParser::expect (char c)
+{
+  int cc = get ();
+  if (cc < 0) {
+    error (tl::to_string (tr ("unexpected end of file")));
+  } else if (cc != (unsigned char) c) {
+    error (tl::sprintf (tl::to_string (tr ("'%s' expected")), std::string (1, c)));
+  }
+}
+
+void
+XMLPullParser::expect (const char *s)
+{
+  while (*s) {
+    expect (*s++);
+  }
+}
+
+bool
+XMLPullParser::skip_whitespace ()
+{
+  bool any = false;
+  int c;
+  while ((c = peek ()) >= 0 && is_space (c)) {
+    get ();
+    any = true;
+  }
+  return any;
+}
+
+void
+XMLPullParser::read_name (std::string &name)
+{
+  name.clear ();
+
+  int c = peek ();
+  if (c < 0) {
+    error (tl::to_string (tr ("unexpected end of file")));
+  } else if (! is_name_start (c)) {
+    error (tl::to_string (tr ("invalid name")));
+  }
+
+  while ((c = peek ()) >= 0 && is_name_char (c)) {
+    name += char (get ());
+  }
+}
+
+void
+XMLPullParser::append_char (std::string &text, int c)
+{
+  if (c < 0x80) {
+    text += char (c);
+  } else if (c < 0x800) {
+    text += char (0xc0 | (c >> 6));
+    text += char (0x80 | (c & 0x3f));
+  } else if (c < 0x10000) {
+    text += char (0xe0 | (c >> 12));
+    text += char (0x80 | ((c >> 6) & 0x3f));
+    text += char (0x80 | (c & 0x3f));
+  } else {
+    text += char (0xf0 | (c >> 18));
+    text += char (0x80 | ((c >> 12) & 0x3f));
+    text += char (0x80 | ((c >> 6) & 0x3f));
+    text += char (0x80 | (c & 0x3f));
+  }
+}
+
+void
+XMLPullParser::read_reference (std::string &text)
+{
+  //  the '&' is already consumed
+  if (peek () == '#') {
+
+    get ();
+
+    int base = 10;
+    if (peek () == 'x') {
+      get ();
+      base = 16;
+    }
+
+    long v = 0;
+    bool any = false;
+    int c;
+    while ((c = get ()) != ';') {
+      int d = -1;
+      if (c >= '0' && c <= '9') {
+        d = c - '0';
+      } else if (base == 16 && c >= 'a' && c <= 'f') {
+        d = c - 'a' + 10;
+      } else if (base == 16 && c >= 'A' && c <= 'F') {
+        d = c - 'A' + 10;
+      }
+      if (d < 0) {
+        error (tl::to_string (tr ("invalid character reference")));
+      }
+      v = v * base + d;
+      if (v > 0x10ffff) {
+        error (tl::to_string (tr ("invalid character reference")));
+      }
+      any = true;
+    }
+
+    if (! any || v == 0) {
+      error (tl::to_string (tr ("invalid character reference")));
+    }
+
+    append_char (text, int (v));
+
+  } else {
+
+    char entity [8];
+    size_t n = 0;
+    int c;
+    while ((c = get ()) != ';') {
+      if (c < 0 || n + 1 >= sizeof (entity) || ! is_name_char (c)) {
+        error (tl::to_string (tr ("invalid entity reference")));
+      }
+      entity [n++] = char (c);
+    }
+    entity [n] = 0;
+
+    if (strcmp (entity, "lt") == 0) {
+      text += '<';
+    } else if (strcmp (entity, "gt") == 0) {
+      text += '>';
+    } else if (strcmp (entity, "amp") == 0) {
+      text += '&';
+    } else if (strcmp (entity, "quot") == 0) {
+      text += '"';
+    } else if (strcmp (entity, "apos") == 0) {
+      text += '\'';
+    } else {
+      error (tl::to_string (tr ("undefined entity")));
+    }
+
+  }
+}
+
+void
+XMLPullParser::read_text ()
+{
+  while (true) {
+
+    if (peek () < 0) {
+      return;
+    }
+
+    //  fast path: take over plain characters from the buffer directly
+    const char *cp = mp_ptr;
+    int column = m_column;
+    while (cp != mp_end) {
+      unsigned char c = (unsigned char) *cp;
+      if (c == '<' || c == '&' || c == '\r' || c == '\n' || (c >= 0x80 && m_latin1)) {
+        break;
+      }
+      if ((c & 0xc0) != 0x80) {
+        ++column;
+      }
+      ++cp;
+    }
+
+    if (cp != mp_ptr) {
+      m_text.append (mp_ptr, cp - mp_ptr);
+      mp_ptr = cp;
+      m_column = column;
+      continue;
+    }
+
+    int c = peek ();
+    if (c == '<') {
+      return;
+    } else if (c == '&') {
+      get ();
+      read_reference (m_text);
+    } else if (c >= 0x80 && m_latin1) {
+      append_char (m_text, get ());
+    } else {
+      m_text += char (get ());
+    }
+
+  }
+}
+
+void
+XMLPullParser::read_cdata ()
+{
+  //  "<![CDATA[" is already consumed
+  int c;
+  while ((c = get ()) >= 0) {
+    if (c == ']' && peek () == ']') {
+      get ();
+      while (peek () == ']') {
+        get ();
+        m_text += ']';
+      }
+      if (peek () == '>') {
+        get ();
+        return;
+      }
+      m_text += "]]";
+    } else if (c >= 0x80 && m_latin1) {
+      append_char (m_text, c);
+    } else {
+      m_text += char (c);
+    }
+  }
+
+  error (tl::to_string (tr ("unexpected end of file in CDATA section")));
+}
+
+void
+XMLPullParser::read_attribute_value (std::string &value)
+{
+  value.clear ();
+
+  int quote = get ();
+  if (quote != '"' && quote != '\'') {
+    error (tl::to_string (tr ("quote expected")));
+  }
+
+  int c;
+  while ((c = get ()) != quote) {
+    if (c < 0) {
+      error (tl::to_string (tr ("unexpected end of file")));
+    } else if (c == '<') {
+      error (tl::to_string (tr ("'<' not allowed in attribute value")));
+    } else if (c == '&') {
+      read_reference (value);
+    } else if (is_space (c)) {
+      value += ' ';
+    } else if (c >= 0x80 && m_latin1) {
+      append_char (value, c);
+    } else {
+      value += char (c);
+    }
+  }
+}
+
+void
+XMLPullParser::skip_comment ()
+{
+  //  "<!-" is already consumed
+  expect ('-');
+
+  int dashes = 0;
+  int c;
+  while ((c = get ()) >= 0) {
+    if (c == '>' && dashes >= 2) {
+      return;
+    }
+    dashes = (c == '-' ? dashes + 1 : 0);
+  }
+
+  error (tl::to_string (tr ("unexpected end of file in comment")));
+}
+
+void
+XMLPullParser::skip_doctype ()
+{
+  //  "<!" is already consumed
+  expect ("DOCTYPE");
+
+  //  skip the declaration including an internal subset in brackets
+  int brackets = 0;
+  int quote = 0;
+  int c;
+  while ((c = get ()) >= 0) {
+    if (quote) {
+      if (c == quote) {
+        quote = 0;
+      }
+    } else if (c == '"' || c == '\'') {
+      quote = c;
+    } else if (c == '[') {
+      ++brackets;
+    } else if (c == ']') {
+      --brackets;
+    } else if (c == '>' && brackets <= 0) {
+      return;
+    }
+  }
+
+  error (tl::to_string (tr ("unexpected end of file in document type declaration")));
+}
+
+void
+XMLPullParser::read_pi ()
+{
+  //  "<?" is already consumed
+  read_name (m_name);
+  bool is_decl = (m_name == "xml");
+
+  m_nattr = 0;
+
+  while (true) {
+
+    skip_whitespace ();
+
+    int c = peek ();
+    if (c < 0) {
+      error (tl::to_string (tr ("unexpected end of file in processing instruction")));
+    } else if (c == '?') {
+      get ();
+      if (peek () == '>') {
+        get ();
+        break;
+      }
+    } else if (is_decl) {
+
+      //  the XML declaration has pseudo attributes
+      if (m_attr.size () <= m_nattr) {
+        m_attr.push_back (std::make_pair (std::string (), std::string ()));
+      }
+      std::pair<std::string, std::string> &a = m_attr [m_nattr++];
+      read_name (a.first);
+      skip_whitespace ();
+      expect ('=');
+      skip_whitespace ();
+      read_attribute_value (a.second);
+
+    } else {
+      get ();
+    }
+
+  }
+
+  if (is_decl) {
+
+    const std::string *enc = attribute ("encoding");
+    if (enc) {
+      std::string e = tl::to_lower_case (*enc);
+      if (e == "iso-8859-1" || e == "latin1" || e == "latin-1" || e == "us-ascii") {
+        m_latin1 = true;
+      } else if (e != "utf-8" && e != "utf8") {
+        error (tl::sprintf (tl::to_string (tr ("unsupported encoding '%s'")), *enc));
+      }
+    }
+
+  }
+
+  m_nattr = 0;
+}
+
+XMLPullParser::token_type
+XMLPullParser::read_tag ()
+{
+  //  "<" is already consumed
+
+  if (peek () == '/') {
+
+    get ();
+
+    read_name (m_name);
+    skip_whitespace ();
+    expect ('>');
+
+    if (m_depth == 0 || m_stack [m_depth - 1] != m_name) {
+      error (tl::to_string (tr ("tag mismatch")));
+    }
+    --m_depth;
+
+    m_nattr = 0;
+    m_token = EndElement;
+    return m_token;
+
+  }
+
+  if (m_depth == 0 && m_had_root) {
+    error (tl::to_string (tr ("unexpected element after document element")));
+  }
+
+  read_name (m_name);
+
+  m_nattr = 0;
+
+  while (true) {
+
+    bool ws = skip_whitespace ();
+
+    int c = peek ();
+    if (c < 0) {
+      error (tl::to_string (tr ("unexpected end of file")));
+    } else if (c == '/') {
+      get ();
+      expect ('>');
+      m_end_pending = true;
+      break;
+    } else if (c == '>') {
+      get ();
+      break;
+    } else if (! ws) {
+      error (tl::to_string (tr ("whitespace expected")));
+    }
+
+    if (m_attr.size () <= m_nattr) {
+      m_attr.push_back (std::make_pair (std::string (), std::string ()));
+    }
+    std::pair<std::string, std::string> &a = m_attr [m_nattr++];
+    read_name (a.first);
+    skip_whitespace ();
+    expect ('=');
+    skip_whitespace ();
+    read_attribute_value (a.second);
+
+  }
+
+  if (! m_end_pending) {
+    if (m_stack.size () <= m_depth) {
+      m_stack.push_back (m_name);
+    } else {
+      m_stack [m_depth] = m_name;
+    }
+    ++m_depth;
+  }
+
+  m_had_root = true;
+
+  m_token = StartElement;
+  return m_token;
+}
+
+XMLPullParser::token_type
+XMLPullParser::next ()
+{
+  if (m_end_pending) {
+    m_end_pending = false;
+    m_nattr = 0;
+    m_token = EndElement;
+    return m_token;
+  }
+
+  if (m_token == EndDocument) {
+    return m_token;
+  }
+
+  if (m_tag_pending) {
+    m_tag_pending = false;
+    return read_tag ();
+  }
+
+  m_text.clear ();
+  m_nattr = 0;
+
+  while (true) {
+
+    int c = peek ();
+    if (c < 0) {
+      break;
+    }
+
+    if (c != '<') {
+      read_text ();
+      continue;
+    }
+
+    get ();
+
+    c = peek ();
+    if (c == '!') {
+
+      get ();
+      c = peek ();
+      if (c == '-') {
+        get ();
+        skip_comment ();
+      } else if (c == '[') {
+        if (m_depth == 0) {
+          error (tl::to_string (tr ("CDATA section outside of document element")));
+        }
+        expect ("[CDATA[");
+        read_cdata ();
+      } else if (m_depth == 0 && ! m_had_root) {
+        skip_doctype ();
+      } else {
+        error (tl::to_string (tr ("invalid markup")));
+      }
+
+    } else if (c == '?') {
+      get ();
+      read_pi ();
+    } else {
+      m_tag_pending = true;
+      break;
+    }
+
+  }
+
+  if (! m_text.empty ()) {
+
+    if (m_depth > 0) {
+      m_token = Characters;
+      return m_token;
+    }
+
+    for (std::string::const_iterator t = m_text.begin (); t != m_text.end (); ++t) {
+      if (! is_space ((unsigned char) *t)) {
+        error (tl::to_string (tr ("text outside of document element")));
+      }
+    }
+
+    m_text.clear ();
+
+  }
+
+  if (m_tag_pending) {
+    m_tag_pending = false;
+    return read_tag ();
+  }
+
+  if (m_depth > 0) {
+    error (tl::to_string (tr ("unexpected end of file")));
+  } else if (! m_had_root) {
+    error (tl::to_string (tr ("no document element")));
+  }
+
+  m_token = EndDocument;
+  return m_token;
+}
+
+const char *
+XMLPullParser::local_name () const
+{
+  const char *cp = m_name.c_str ();
+  const char *colon = strchr (cp, ':');
+  return colon ? colon + 1 : cp;
+}
+
+const std::string *
+XMLPullParser::attribute (const std::string &name) const
+{
+  for (size_t i = 0; i < m_nattr; ++i) {
+    if (m_attr [i].first == name) {
+      return &m_attr [i].second;
+    }
+  }
+  return 0;
+}
+
+}
+
@@ -0,0 +1,210 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_tlXMLPullParser
+#define HDR_tlXMLPullParser
+
+#include "tlCommon.h"
+#include "tlStream.h"
+
+#include <string>
+#include <vector>
+
+namespace tl
+{
+
+/**
+ *  @brief A streaming XML pull parser
+ *
+ *  This parser reads XML from a tl::InputStream and delivers the document
+ *  as a sequence of tokens through "next". It does not depend on Qt or any
+ *  other XML library.
+ *
+ *  The parser supports elements, attributes, character data, CDATA sections,
+ *  comments, processing instructions and character references as well as the
+ *  predefined entities. A document type declaration is skipped. The input is
+ *  taken as UTF-8 unless the XML declaration specifies ISO-8859-1 (Latin-1).
+ *  Line ends are normalized to a single LF character.
+ *
+ *  Names, text and attributes are kept in buffers which are reused. Once the
+ *  buffers have grown to their working size, parsing does not allocate memory
+ *  per element.
+ *
+ *  Errors are reported as tl::XMLLocatedException.
+ */
+class TL_PUBLIC XMLPullParser
+{
+public:
+  /**
+   *  @brief The token types
+   */
+  enum token_type
+  {
+    StartElement,
+    EndElement,
+    Characters,
+    EndDocument
+  };
+
+  /**
+   *  @brief Creates a parser reading from the given stream
+   *
+   *  The stream must stay alive while the parser is used.
+   */
+  XMLPullParser (tl::InputStream &stream);
+
+  /**
+   *  @brief Reads the next token
+   *
+   *  After "EndDocument" was delivered, further calls will deliver "EndDocument" again.
+   *  An empty element ("<a/>") is delivered as a "StartElement" and "EndElement" pair.
+   */
+  token_type next ();
+
+  /**
+   *  @brief Gets the current token
+   */
+  token_type token () const
+  {
+    return m_token;
+  }
+
+  /**
+   *  @brief Gets the qualified name of the element for "StartElement" and "EndElement"
+   */
+  const std::string &name () const
+  {
+    return m_name;
+  }
+
+  /**
+   *  @brief Gets the local name (the name without namespace prefix)
+   *
+   *  The returned pointer is valid until the next token is read.
+   */
+  const char *local_name () const;
+
+  /**
+   *  @brief Gets the text for "Characters"
+   *
+   *  Consecutive character data, CDATA sections and references are combined into
+   *  a single token.
+   */
+  const std::string &text () const
+  {
+    return m_text;
+  }
+
+  /**
+   *  @brief Gets the number of attributes for "StartElement"
+   */
+  size_t attributes () const
+  {
+    return m_nattr;
+  }
+
+  /**
+   *  @brief Gets the name of the attribute with the given index
+   */
+  const std::string &attribute_name (size_t i) const
+  {
+    return m_attr [i].first;
+  }
+
+  /**
+   *  @brief Gets the value of the attribute with the given index
+   */
+  const std::string &attribute_value (size_t i) const
+  {
+    return m_attr [i].second;
+  }
+
+  /**
+   *  @brief Gets the value of the attribute with the given name or 0 if there is no such attribute
+   */
+  const std::string *attribute (const std::string &name) const;
+
+  /**
+   *  @brief Gets the current line number (starting with 1)
+   */
+  int line () const
+  {
+    return m_line;
+  }
+
+  /**
+   *  @brief Gets the current column number
+   *
+   *  This is the number of characters read on the current line.
+   */
+  int column () const
+  {
+    return m_column;
+  }
+
+private:
+  tl::InputStream *mp_stream;
+  const char *mp_ptr, *mp_end;
+  std::string m_tail;
+  bool m_at_end;
+  bool m_last_cr;
+  bool m_latin1;
+  bool m_started;
+  int m_line, m_column;
+
+  token_type m_token;
+  bool m_tag_pending;
+  bool m_end_pending;
+  bool m_had_root;
+  std::string m_name;
+  std::string m_text;
+  std::vector<std::pair<std::string, std::string> > m_attr;
+  size_t m_nattr;
+  std::vector<std::string> m_stack;
+  size_t m_depth;
+  std::string m_buffer;
+
+  bool fill ();
+  void check_encoding ();
+  int peek ();
+  int get ();
+  void error (const std::string &msg) const;
+  void expect (char c);
+  void expect (const char *s);
+  bool skip_whitespace ();
+  void read_name (std::string &name);
+  void read_reference (std::string &text);
+  void append_char (std::string &text, int c);
+  void read_text ();
+  void read_cdata ();
+  void read_attribute_value (std::string &value);
+  void skip_comment ();
+  void skip_doctype ();
+  void read_pi ();
+  token_type read_tag ();
+};
+
+}
+
+#endif
+
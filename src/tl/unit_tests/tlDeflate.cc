@@ -118,3 +118,38 @@ TEST(3)
   delete[] hello;
 }
 
+
+//  Pre-inflated blocks
+TEST(4)
+{
+  const char hello[] = "This is a test \\!";
+
+  tl::OutputStringStream oss;
+  tl::OutputStream os (oss);
+  tl::DeflateFilter fg (os);
+  fg.put (hello, sizeof (hello) - 1);
+  fg.flush ();
+
+  std::string data = "AB" + oss.string () + "CD";
+  tl::InputMemoryStream ims ((const char *) data.c_str (), data.size ());
+  tl::InputStream is (ims);
+
+  EXPECT_EQ (std::string (is.get (2), 2), "AB");
+  EXPECT_EQ (std::string (is.peek (2), 2), std::string (oss.string (), 0, 2));
+  EXPECT_EQ (is.pos (), size_t (2));
+
+  std::vector<char> inflated (hello, hello + sizeof (hello) - 1);
+  EXPECT_EQ (is.inflate (oss.string ().size (), inflated), true);
+  EXPECT_EQ (inflated.empty (), true);
+  EXPECT_EQ (is.pos (), data.size () - 2);
+
+  EXPECT_EQ (std::string (is.get (5), 5), "This ");
+  is.unget (5);
+  EXPECT_EQ (std::string (is.get (7), 7), "This is");
+  EXPECT_EQ (std::string (is.get (10), 10), " a test \\!");
+  EXPECT_EQ (std::string (is.get (2), 2), "CD");
+  EXPECT_EQ (is.get (1) == 0, true);
+
+  std::vector<char> more (hello, hello + 4);
+  EXPECT_EQ (is.inflate (1, more), false);
+}
@@ -0,0 +1,160 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "tlProfiler.h"
+#include "tlUnitTest.h"
+
+namespace
+{
+
+  static tl::ProfileRecord make_record (const std::string &desc, double wall, double user, size_t inputs)
+  {
+    tl::ProfileRecord r;
+    r.category = "test";
+    r.description = desc;
+    r.wall = wall;
+    r.user = user;
+    r.threads = 2;
+    r.memory_before = 1000;
+    r.memory_after = 3000;
+    r.input_count = inputs;
+    r.output_count = inputs / 2;
+    return r;
+  }
+
+  //  enables the profiler temporarily
+  struct ProfilerEnabler
+  {
+    ProfilerEnabler ()
+    {
+      tl::Profiler::instance ().clear ();
+      tl::Profiler::instance ().set_enabled (true);
+    }
+
+    ~ProfilerEnabler ()
+    {
+      tl::Profiler::instance ().set_enabled (false);
+      tl::Profiler::instance ().clear ();
+    }
+  };
+
+}
+
+//  records and sorting
+TEST(1)
+{
+  ProfilerEnabler enabler;
+  tl::Profiler &p = tl::Profiler::instance ();
+
+  p.add (make_record ("a", 1.0, 2.0, 10));
+  p.add (make_record ("b", 3.0, 0.5, 100));
+  p.add (make_record ("c", 2.0, 1.0, 1));
+
+  std::vector<tl::ProfileRecord> r;
+
+  r = p.records ("order");
+  EXPECT_EQ (r.size (), size_t (3));
+  EXPECT_EQ (r[0].description, "a");
+  EXPECT_EQ (r[1].description, "b");
+  EXPECT_EQ (r[2].description, "c");
+
+  r = p.records ();
+  EXPECT_EQ (r[0].description, "b");
+  EXPECT_EQ (r[1].description, "c");
+  EXPECT_EQ (r[2].description, "a");
+
+  r = p.records ("cpu");
+  EXPECT_EQ (r[0].description, "a");
+  EXPECT_EQ (r[1].description, "c");
+  EXPECT_EQ (r[2].description, "b");
+
+  r = p.records ("inputs");
+  EXPECT_EQ (r[0].description, "b");
+  EXPECT_EQ (r[1].description, "a");
+  EXPECT_EQ (r[2].description, "c");
+
+  EXPECT_EQ (tl::to_string (r[1].utilization ()), "1");
+  EXPECT_EQ (tl::to_string (r[0].utilization ()), "0.0833333333333");
+
+  p.clear ();
+  EXPECT_EQ (p.records ().size (), size_t (0));
+}
+
+//  report formats
+TEST(2)
+{
+  ProfilerEnabler enabler;
+  tl::Profiler &p = tl::Profiler::instance ();
+
+  p.add (make_record ("x \"y\"", 1.5, 1.0, 10));
+
+  EXPECT_EQ (p.to_csv (),
+    "category,description,wall,cpu,user,sys,threads,utilization,memory_before,memory_after,memory_allocated,memory_peak,inputs,outputs\n"
+    "\"test\",\"x \"\"y\"\"\",1.500,1.000,1.000,0.000,2,0.333,1000,3000,2000,0,10,5\n"
+  );
+
+  EXPECT_EQ (p.to_json (),
+    "[\n"
+    "  {\"category\": \"test\", \"description\": \"x \\\"y\\\"\", \"wall\": 1.500, \"cpu\": 1.000, \"user\": 1.000, \"sys\": 0.000, \"threads\": 2, \"utilization\": 0.333, "
+    "\"memory_before\": 1000, \"memory_after\": 3000, \"memory_allocated\": 2000, \"memory_peak\": 0, \"inputs\": 10, \"outputs\": 5}\n"
+    "]\n"
+  );
+
+  std::string s = p.summary (1);
+  EXPECT_EQ (s.find ("[test] x \"y\"") != std::string::npos, true);
+  EXPECT_EQ (s.find ("Total") != std::string::npos, true);
+}
+
+//  profile scope
+TEST(3)
+{
+  {
+    tl::ProfileScope scope ("test", "disabled");
+    EXPECT_EQ (scope.is_enabled (), false);
+  }
+  EXPECT_EQ (tl::Profiler::instance ().records ().size (), size_t (0));
+
+  ProfilerEnabler enabler;
+
+  {
+    tl::ProfileScope scope ("test", "enabled", 4);
+    EXPECT_EQ (scope.is_enabled (), true);
+    scope.set_input_count (17);
+    scope.set_output_count (42);
+  }
+
+  std::vector<tl::ProfileRecord> r = tl::Profiler::instance ().records ();
+  EXPECT_EQ (r.size (), size_t (1));
+  EXPECT_EQ (r[0].category, "test");
+  EXPECT_EQ (r[0].description, "enabled");
+  EXPECT_EQ (r[0].threads, (unsigned int) 4);
+  EXPECT_EQ (r[0].input_count, size_t (17));
+  EXPECT_EQ (r[0].output_count, size_t (42));
+  EXPECT_EQ (r[0].wall >= 0.0, true);
+
+#if defined(__linux__)
+  EXPECT_EQ (tl::Timer::memory_size () > 0, true);
+  EXPECT_EQ (tl::Timer::peak_memory_size () >= tl::Timer::memory_size () / 2, true);
+#endif
+}
+
@@ -36,6 +36,7 @@ TEST(InputPipe1)
 {
   tl::InputPipe pipe ("echo HELLOWORLD");
   tl::InputStream str (pipe);
+  EXPECT_EQ (str.is_resettable (), false);
   tl::TextInputStream tstr (str);
   EXPECT_EQ (tstr.get_line (), "HELLOWORLD");
   EXPECT_EQ (pipe.wait (), 0);
@@ -162,3 +163,90 @@ TEST(TextInputStream)
     EXPECT_EQ (tis.read_all (), "Hello, world!\nWith another line\n\nseparated by a LFCR and CRLF.");
   }
 }
+
+TEST(MappedInputStream)
+{
+  std::string fn = tmp_file ("test.txt");
+
+  {
+    tl::OutputStream os (fn, tl::OutputStream::OM_Plain);
+    os << "Hello, world!";
+  }
+
+  //  mapping is not enabled by default
+  {
+    tl::InputStream is (fn);
+    EXPECT_EQ (is.is_direct (), false);
+    EXPECT_EQ (is.is_resettable (), true);
+    EXPECT_EQ (is.read_all (), "Hello, world!");
+  }
+
+  //  memory streams are read through the buffer too
+  {
+    const char data[] = "Hello, world!";
+    tl::InputMemoryStream ms (data, 13);
+    tl::InputStream is (ms);
+    EXPECT_EQ (is.is_direct (), false);
+    EXPECT_EQ (is.read_all (), "Hello, world!");
+  }
+
+  {
+    tl::InputStream is (fn, true);
+    EXPECT_EQ (is.is_direct (), true);
+    EXPECT_EQ (is.blen (), size_t (13));
+
+    const char *b = is.get (5);
+    EXPECT_EQ (std::string (b, 5), "Hello");
+    EXPECT_EQ (is.pos (), size_t (5));
+    const char *b2 = is.get (2);
+    EXPECT_EQ (std::string (b2, 2), ", ");
+    //  pointers stay valid in direct mode
+    EXPECT_EQ (std::string (b, 5), "Hello");
+    is.unget (2);
+    EXPECT_EQ (is.get (9) == 0, true);
+    EXPECT_EQ (is.read_all (), ", world!");
+    EXPECT_EQ (is.get (1) == 0, true);
+
+    is.reset ();
+    EXPECT_EQ (is.pos (), size_t (0));
+    EXPECT_EQ (is.read_all (), "Hello, world!");
+  }
+
+  {
+    tl::InputMappedFile file (fn);
+    EXPECT_EQ (file.direct_size (), size_t (13));
+    char b[20];
+    EXPECT_EQ (file.read (b, sizeof (b)), size_t (13));
+    EXPECT_EQ (std::string (b, 13), "Hello, world!");
+    EXPECT_EQ (file.read (b, sizeof (b)), size_t (0));
+  }
+
+  //  compressed files are not mapped
+
+  std::string fn_gz = tmp_file ("test.txt.gz");
+
+  {
+    tl::OutputStream os (fn_gz, tl::OutputStream::OM_Zlib);
+    os << "Hello, world!";
+  }
+
+  {
+    tl::InputStream is (fn_gz, true);
+    EXPECT_EQ (is.is_direct (), false);
+    EXPECT_EQ (is.read_all (), "Hello, world!");
+  }
+
+  //  empty files cannot be mapped, but can be read
+
+  std::string fn_empty = tmp_file ("empty.txt");
+
+  {
+    tl::OutputStream os (fn_empty, tl::OutputStream::OM_Plain);
+  }
+
+  {
+    tl::InputStream is (fn_empty, true);
+    EXPECT_EQ (is.is_direct (), false);
+    EXPECT_EQ (is.get (1) == 0, true);
+  }
+}
@@ -28,6 +28,8 @@
 #include "tlThreads.h"
 
 #include <stdio.h>
+#include <vector>
+#include <algorithm>
 
 #if defined(WIN32)
 #include <windows.h>
@@ -80,6 +82,24 @@ public:
   int m_n;
 };
 
+class TreeTask : public tl::Task
+{
+public:
+  TreeTask (tl::JobBase *job, int depth) : mp_job (job), m_depth (depth) { }
+  tl::JobBase *mp_job;
+  int m_depth;
+};
+
+class OrderTask : public tl::Task
+{
+public:
+  OrderTask (int id) : m_id (id) { }
+  int m_id;
+};
+
+static tl::Mutex s_order_lock;
+static std::vector<int> s_order[4];
+
 class MyWorker : public tl::Worker
 {
 public:
@@ -105,6 +125,22 @@ protected:
           schtask->mp_job->schedule (new MyTask (schtask->m_n));
         }
       }
+      OrderTask *ordertask = dynamic_cast<OrderTask *> (task);
+      if (ordertask) {
+        s_order_lock.lock ();
+        s_order[worker_index () >= 0 ? worker_index () : 0].push_back (ordertask->m_id);
+        s_order_lock.unlock ();
+      }
+      TreeTask *treetask = dynamic_cast<TreeTask *> (task);
+      if (treetask) {
+        if (treetask->m_depth == 0) {
+          s_sum[worker_index () >= 0 ? worker_index () : 0].add (1);
+        } else {
+          //  spawns two sub-tasks
+          treetask->mp_job->schedule (new TreeTask (treetask->mp_job, treetask->m_depth - 1));
+          treetask->mp_job->schedule (new TreeTask (treetask->mp_job, treetask->m_depth - 1));
+        }
+      }
     }
   }
 };
@@ -639,3 +675,109 @@ TEST(29)
   }
 }
 
+TEST(30)
+{
+  tl::SelfTimer timer ("4 threads, 100 task trees with 4096 leaves");
+  MyJob job (4);
+
+  for (int l = 0; l < 100; ++l) {
+
+    s_sum[0].reset ();
+    s_sum[1].reset ();
+    s_sum[2].reset ();
+    s_sum[3].reset ();
+
+    job.schedule (new TreeTask (&job, 12));
+
+    job.start ();
+    job.wait ();
+    EXPECT_EQ (job.is_running (), false);
+
+    EXPECT_EQ (s_sum[0].sum () + s_sum[1].sum() + s_sum[2].sum() + s_sum[3].sum (), 4096);
+
+  }
+}
+
+TEST(31)
+{
+  tl::SelfTimer timer ("0 threads, task tree with 4096 leaves");
+  MyJob job (0);
+
+  s_sum[0].reset ();
+
+  job.schedule (new TreeTask (&job, 12));
+
+  job.start ();
+  job.wait ();
+  EXPECT_EQ (job.is_running (), false);
+
+  EXPECT_EQ (s_sum[0].sum (), 4096);
+}
+
+TEST(32)
+{
+  //  stopping a job while sub-tasks are pending
+  MyJob job (4);
+
+  for (int l = 0; l < 10; ++l) {
+
+    job.schedule (new TreeTask (&job, 20));
+    job.schedule (new SchedulerTask (&job, 10000, 1000));
+
+    job.start ();
+    usleep (10000);
+    job.stop ();
+    EXPECT_EQ (job.is_running (), false);
+
+  }
+
+  //  the job can be reused after stopping
+  s_sum[0].reset ();
+  s_sum[1].reset ();
+  s_sum[2].reset ();
+  s_sum[3].reset ();
+
+  job.schedule (new TreeTask (&job, 10));
+
+  job.start ();
+  job.wait ();
+
+  EXPECT_EQ (s_sum[0].sum () + s_sum[1].sum() + s_sum[2].sum() + s_sum[3].sum (), 1024);
+}
+
+TEST(33)
+{
+  //  tasks scheduled from outside are started in the order they were scheduled
+  MyJob job (4);
+
+  for (int l = 0; l < 20; ++l) {
+
+    for (int i = 0; i < 4; ++i) {
+      s_order[i].clear ();
+    }
+
+    for (int i = 0; i < 1000; ++i) {
+      job.schedule (new OrderTask (i));
+    }
+
+    job.start ();
+    job.wait ();
+    EXPECT_EQ (job.is_running (), false);
+
+    std::vector<bool> seen (1000, false);
+    size_t n = 0;
+    for (int i = 0; i < 4; ++i) {
+      for (size_t j = 0; j < s_order[i].size (); ++j) {
+        if (j > 0) {
+          EXPECT_EQ (s_order[i][j - 1] < s_order[i][j], true);
+        }
+        seen [s_order[i][j]] = true;
+        ++n;
+      }
+    }
+
+    EXPECT_EQ (n, size_t (1000));
+    EXPECT_EQ (std::find (seen.begin (), seen.end (), false) == seen.end (), true);
+
+  }
+}
@@ -23,8 +23,6 @@
 #include "tlXMLParser.h"
 #include "tlUnitTest.h"
 
-#if defined(HAVE_QT) || defined(HAVE_EXPAT)
-
 #include <sstream>
 #include <cmath>
 
@@ -652,4 +650,3 @@ TEST (13)
   EXPECT_EQ (child.txt, "H\xc3\xa4llo");
 }
 
-#endif
@@ -0,0 +1,151 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "tlXMLPullParser.h"
+#include "tlXMLParser.h"
+#include "tlTimer.h"
+#include "tlUnitTest.h"
+
+
+//  Produces a compact listing of the tokens
+static std::string tokens (const std::string &xml)
+{
+  tl::InputMemoryStream ms (xml.c_str (), xml.size ());
+  tl::InputStream is (ms);
+  tl::XMLPullParser parser (is);
+
+  std::string res;
+  while (true) {
+    tl::XMLPullParser::token_type t = parser.next ();
+    if (t == tl::XMLPullParser::EndDocument) {
+      break;
+    } else if (t == tl::XMLPullParser::StartElement) {
+      res += "<" + parser.name ();
+      for (size_t i = 0; i < parser.attributes (); ++i) {
+        res += " " + parser.attribute_name (i) + "=" + parser.attribute_value (i);
+      }
+      res += ">";
+    } else if (t == tl::XMLPullParser::EndElement) {
+      res += "</" + std::string (parser.local_name ()) + ">";
+    } else if (t == tl::XMLPullParser::Characters) {
+      res += "[" + parser.text () + "]";
+    }
+  }
+
+  return res;
+}
+
+static std::string error (const std::string &xml)
+{
+  try {
+    tokens (xml);
+    return std::string ();
+  } catch (tl::XMLLocatedException &ex) {
+    return ex.msg ();
+  }
+}
+
+TEST(1_Basic)
+{
+  EXPECT_EQ (tokens ("<a/>"), "<a></a>");
+  EXPECT_EQ (tokens ("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<a>x<b c='1' d = \"2 3\">y</b>z</a>\n"), "<a>[x]<b c=1 d=2 3>[y]</b>[z]</a>");
+  EXPECT_EQ (tokens ("<ns:a><b/></ns:a>"), "<ns:a><b></b></a>");
+  EXPECT_EQ (tokens ("<a>&lt;&gt;&amp;&quot;&apos;&#65;&#x42;&#xe4;</a>"), "<a>[<>&\"'AB\xc3\xa4]</a>");
+  EXPECT_EQ (tokens ("<a v='&lt;x&#10;y'/>"), "<a v=<x\ny></a>");
+  EXPECT_EQ (tokens ("<a v='x\ny'/>"), "<a v=x y></a>");
+  EXPECT_EQ (tokens ("<a>x<!-- comment - -- -->y<![CDATA[<&]]>z</a>"), "<a>[xy<&z]</a>");
+  EXPECT_EQ (tokens ("<a><![CDATA[]]]]></a>"), "<a>[]]]</a>");
+  EXPECT_EQ (tokens ("<!DOCTYPE a [ <!ELEMENT a (#PCDATA)> ]>\n<!-- x -->\n<a> </a>\n<?pi x?>"), "<a>[ ]</a>");
+  EXPECT_EQ (tokens ("<a>x\r\ny\rz</a>"), "<a>[x\ny\nz]</a>");
+  EXPECT_EQ (tokens ("<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?><a>\xe4</a>"), "<a>[\xc3\xa4]</a>");
+  //  UTF-8 byte order mark
+  EXPECT_EQ (tokens ("\xef\xbb\xbf<a>x</a>"), "<a>[x]</a>");
+}
+
+TEST(2_Errors)
+{
+  EXPECT_EQ (error ("<a></b>"), "XML parser error: tag mismatch in line 1, column 7");
+  EXPECT_EQ (error ("<a>\n<b>"), "XML parser error: unexpected end of file in line 2, column 3");
+  EXPECT_EQ (error ("<a>&x;</a>"), "XML parser error: undefined entity in line 1, column 6");
+  EXPECT_EQ (error ("<a b=c/>"), "XML parser error: quote expected in line 1, column 6");
+  EXPECT_EQ (error ("<a/><b/>"), "XML parser error: unexpected element after document element in line 1, column 5");
+  EXPECT_EQ (error ("x<a/>"), "XML parser error: text outside of document element in line 1, column 2");
+  EXPECT_EQ (error (""), "XML parser error: no document element in line 1, column 0");
+  EXPECT_EQ (error ("<?xml version=\"1.0\" encoding=\"UTF-16\"?><a/>"), "XML parser error: unsupported encoding 'UTF-16' in line 1, column 39");
+  //  UTF-16 input with and without byte order mark
+  EXPECT_EQ (error (std::string ("\xff\xfe<\0a\0/\0>\0", 10)), "XML parser error: unsupported encoding 'UTF-16' in line 1, column 0");
+  EXPECT_EQ (error (std::string ("\0<\0a\0/\0>", 8)), "XML parser error: unsupported encoding 'UTF-16' in line 1, column 0");
+}
+
+namespace
+{
+
+struct Marker
+{
+  Marker () : id (0) { }
+  int id;
+  std::string value;
+};
+
+struct Markers
+{
+  std::vector<Marker> markers;
+  void add (const Marker &m) { markers.push_back (m); }
+  std::vector<Marker>::const_iterator begin () const { return markers.begin (); }
+  std::vector<Marker>::const_iterator end () const { return markers.end (); }
+};
+
+}
+
+//  A large document similar to a marker database (long runner)
+TEST(3_Large)
+{
+  test_is_long_runner ();
+
+  const size_t n = 200000;
+
+  std::string xml = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<markers>\n";
+  for (size_t i = 0; i < n; ++i) {
+    xml += tl::sprintf (" <marker>\n  <id>%d</id>\n  <value>polygon: (%d,0;%d,100;%d,100;%d,0)</value>\n </marker>\n", int (i), int (i), int (i), int (i + 10), int (i + 10));
+  }
+  xml += "</markers>\n";
+
+  tl::XMLStruct<Markers> structure ("markers",
+    tl::make_element (&Markers::begin, &Markers::end, &Markers::add, "marker",
+      tl::make_member (&Marker::id, "id") +
+      tl::make_member (&Marker::value, "value")
+    )
+  );
+
+  Markers markers;
+
+  {
+    tl::SelfTimer timer (tl::sprintf ("Reading %d markers (%d MB)", int (n), int (xml.size () / (1024 * 1024))));
+    tl::XMLStringSource source (xml);
+    structure.parse (source, markers);
+  }
+
+  EXPECT_EQ (markers.markers.size (), n);
+  EXPECT_EQ (markers.markers.back ().id, int (n - 1));
+  EXPECT_EQ (markers.markers.back ().value, "polygon: (199999,0;199999,100;200009,100;200009,0)");
+}
@@ -21,6 +21,7 @@ SOURCES = \
   tlKDTree.cc \
   tlMath.cc \
   tlObject.cc \
+  tlProfilerTests.cc \
   tlReuseVector.cc \
   tlStableVector.cc \
   tlString.cc \
@@ -29,6 +30,7 @@ SOURCES = \
   tlUtils.cc \
   tlVariant.cc \
   tlXMLParser.cc \
+  tlXMLPullParserTests.cc \
   tlStreamTests.cc \
   tlWebDAV.cc \
   tlHttpStream.cc \
@@ -203,6 +203,10 @@ class BasicTest(unittest.TestCase):
       self.assertEqual( a.a3_qba("ab"), 2 )
       self.assertEqual( a.a3_qba("µ"), 2 )  # two UTF8 bytes
     self.assertEqual( a.a3(""), 0 )
+    self.assertEqual( a.a3_ba("ab"), 2 )
+    self.assertEqual( a.a3_ba("µ"), 2 )  # two UTF8 bytes
+    self.assertEqual( a.a3_ba(b"\x00\xff\x01"), 3 )
+    self.assertEqual( a.a3_ba(bytearray(b"ab")), 2 )
 
     self.assertEqual( a.a4([1]), 1.0 )
     t = (1,)
@@ -432,6 +436,7 @@ class BasicTest(unittest.TestCase):
     self.assertEqual( a1.a11_ui(0xffffffff), 4294967295 )
     self.assertEqual( a1.a11_ul(0xffffffff), 4294967295 )
     self.assertEqual( a1.a11_ull(0xffffffff), 4294967295 )
+    self.assertEqual( a1.a10_d_ba(5.2), b"5.2" )
     if "a10_d_qstr" in a1.__dict__:
       self.assertEqual( a1.a10_d_qstr(5.25), "5.25" )
       self.assertEqual( a1.a10_d_qstrref(5.2), "5.2" )
@@ -20,6 +20,7 @@ import pya
 import unittest
 import sys
 import os
+import struct
 
 class DBRegionTest(unittest.TestCase):
 
@@ -40,6 +41,44 @@ class DBRegionTest(unittest.TestCase):
     r.merge()
     self.assertEqual(str(r), "(0,100;0,300;50,300;50,350;250,350;250,150;200,150;200,100)")
 
+  def test_2_PolygonArrays(self):
+
+    r = pya.Region()
+    r.insert(pya.Box(0, 0, 100, 200))
+    r.insert(pya.Box(500, 0, 600, 200))
+
+    pa = r.polygon_arrays()
+    self.assertEqual(pa.size(), 2)
+    self.assertEqual(pa.coordinates(), [ 0, 0, 0, 200, 100, 200, 100, 0, 500, 0, 500, 200, 600, 200, 600, 0 ])
+    self.assertEqual(pa.contour_offsets(), [ 0, 4, 8 ])
+    self.assertEqual(pa.polygon_offsets(), [ 0, 1, 2 ])
+
+    r2 = pya.Region()
+    r2.insert(pya.PolygonArrays(pa.coordinates(), pa.contour_offsets(), pa.polygon_offsets()))
+    self.assertEqual(str(r2), str(r))
+
+    # packed form
+    data = struct.pack("<13i", 1, 1, 3, 0, 1, 0, 3, -10, 0, 0, 100, 100, 100)
+    r3 = pya.Region()
+    r3.insert_polygon_arrays_packed(data)
+    self.assertEqual(str(r3), "(-10,0;0,100;100,100)")
+
+    r3 = pya.Region()
+    r3.insert_polygon_arrays_packed(bytearray(data))
+    self.assertEqual(str(r3), "(-10,0;0,100;100,100)")
+
+    data = r.polygon_arrays_packed()
+    self.assertEqual(type(data), bytes)
+    self.assertEqual(data, pa.packed())
+    values = struct.unpack("<%di" % (len(data) // 4), data)
+    self.assertEqual(values[0:3], (2, 2, 8))
+    self.assertEqual(values[-8:], (500, 0, 500, 200, 600, 200, 600, 0))
+
+    r3 = pya.Region()
+    r3.insert_polygon_arrays_packed(data)
+    self.assertEqual(str(r3), str(r))
+    self.assertEqual(str(pya.PolygonArrays.from_packed(data).polygon(1)), str(pa.polygon(1)))
+
   def test_deep1(self):
 
     ut_testsrc = os.getenv("TESTSRC")
@@ -98,6 +98,9 @@ class Basic_TestClass < TestBase
       assert_equal( a.a3_qba("µ"), 2 )  # two UTF8 bytes
     end
     assert_equal( a.a3(""), 0 )
+    assert_equal( a.a3_ba("ab"), 2 )
+    assert_equal( a.a3_ba("µ"), 2 )  # two UTF8 bytes
+    assert_equal( a.a3_ba([ 0, 255, 1 ].pack("C*")), 3 )
 
     assert_equal( a.a4([1]), 1.0 )
     assert_equal( a.a4([1, 125e-3]), 0.125 )
@@ -330,6 +333,8 @@ class Basic_TestClass < TestBase
     assert_equal( a1.a11_ull(0xffffffff), 4294967295 )
 
     assert_equal( a1.a10_d(5.2), "5.2" )
+    assert_equal( a1.a10_d_ba(5.2), "5.2" )
+    assert_equal( a1.a10_d_ba(5.2).encoding, Encoding::ASCII_8BIT )
     if a1.respond_to?(:a10_d_qstr)
       assert_equal( a1.a10_d_qstr(5.25), "5.25" )
       assert_equal( a1.a10_d_qstrref(5.2), "5.2" )
@@ -602,6 +602,46 @@ class DBEdges_TestClass < TestBase
 
   end
 
+  # flat coordinate arrays
+  def test_10
+
+    r = RBA::Edges::new
+    r.insert(RBA::Edge::new(0, 0, 100, 200))
+    r.insert(RBA::Edge::new(10, 20, 30, 40))
+    assert_equal(r.coordinates.join(","), "0,0,100,200,10,20,30,40")
+
+    r2 = RBA::Edges::new
+    r2.insert_coordinates(r.coordinates)
+    assert_equal(r2.to_s, r.to_s)
+
+    begin
+      r2.insert_coordinates([ 0, 1, 2 ])
+      assert_equal(true, false)
+    rescue => ex
+    end
+
+    # packed form
+    data = r.coordinates_packed
+    assert_equal(data.size, 32)
+    assert_equal(data.encoding, Encoding::ASCII_8BIT)
+    assert_equal(data.unpack("l<*").join(","), "0,0,100,200,10,20,30,40")
+
+    r3 = RBA::Edges::new
+    r3.insert_coordinates_packed([ -1, 0, 100, -200 ].pack("l<*"))
+    assert_equal(r3.to_s, "(-1,0;100,-200)")
+
+    r3 = RBA::Edges::new
+    r3.insert_coordinates_packed(data)
+    assert_equal(r3.to_s, r.to_s)
+
+    begin
+      r3.insert_coordinates_packed([ 0, 1, 2 ].pack("l<*"))
+      assert_equal(true, false)
+    rescue => ex
+    end
+
+  end
+
 end
 
 load("test_epilogue.rb")
@@ -83,7 +83,37 @@ class DBReaders_TestClass < TestBase
   # OASIS Options
   def test_oasis_options
 
-    # none yet.
+    opt = RBA::LoadLayoutOptions::new
+
+    assert_equal(opt.oasis_lazy_loading?, false)
+    opt.oasis_lazy_loading = true
+    assert_equal(opt.oasis_lazy_loading?, true)
+
+    fn = ENV["TESTSRC"] + "/testdata/oasis/t10.1.oas"
+
+    ly = RBA::Layout::new
+    reader = RBA::LayoutReader::new(fn)
+    reader.read(ly, opt)
+    assert_equal(reader.format, "OASIS")
+    assert_equal(reader.has_deferred_cells?, true)
+
+    ci_a = ly.cell("A").cell_index
+    ci_top = ly.cell("TOP").cell_index
+    assert_equal(reader.is_deferred_cell?(ci_a), true)
+    assert_equal(ly.cell(ci_a).shapes(0).size + ly.cell(ci_a).shapes(1).size, 0)
+
+    reader.load_cell(ly, ci_a)
+    assert_equal(reader.is_deferred_cell?(ci_a), false)
+    assert_equal(ly.cell(ci_a).shapes(0).size + ly.cell(ci_a).shapes(1).size, 8)
+
+    reader.load_cell_tree(ly, ci_top)
+    assert_equal(reader.has_deferred_cells?, false)
+
+    # Layout#read loads all cells
+    ly2 = RBA::Layout::new
+    ly2.read(fn, opt)
+    ci_a = ly2.cell("A").cell_index
+    assert_equal(ly2.cell(ci_a).shapes(0).size + ly2.cell(ci_a).shapes(1).size, 8)
 
   end
 
@@ -838,6 +838,58 @@ class DBRegion_TestClass < TestBase
   end
 
   # deep region tests
+  # polygon arrays
+  def test_16
+
+    r = RBA::Region::new
+    r.insert(RBA::Box::new(0, 0, 100, 200))
+    p = RBA::Polygon::new(RBA::Box::new(0, 0, 1000, 1000))
+    p.insert_hole(RBA::Box::new(100, 100, 200, 200))
+    r.insert(p)
+
+    pa = r.polygon_arrays
+    assert_equal(pa.size, 2)
+    assert_equal(pa.coordinates.join(","), "0,0,0,200,100,200,100,0,0,0,0,1000,1000,1000,1000,0,100,100,200,100,200,200,100,200")
+    assert_equal(pa.contour_offsets.join(","), "0,4,8,12")
+    assert_equal(pa.polygon_offsets.join(","), "0,1,3")
+    assert_equal(pa.polygon(1).to_s, "(0,0;0,1000;1000,1000;1000,0/100,100;200,100;200,200;100,200)")
+
+    pa2 = RBA::PolygonArrays::new(pa.coordinates, pa.contour_offsets, pa.polygon_offsets)
+    r2 = RBA::Region::new
+    r2.insert(pa2)
+    assert_equal(r2.to_s, r.to_s)
+
+    begin
+      RBA::PolygonArrays::new([ 0, 0, 0, 100, 100, 100 ], [ 0, 2 ], [ 0, 1 ])
+      assert_equal(true, false)
+    rescue => ex
+    end
+
+    pa3 = RBA::PolygonArrays::new([ 0, 0, 0, 100, 100, 100 ], [ 0, 3 ], [ 0, 1 ])
+    assert_equal(pa3.polygon(0).to_s, "(0,0;0,100;100,100)")
+
+    # packed form
+    data = r.polygon_arrays_packed
+    assert_equal(data, pa.packed)
+    assert_equal(data.unpack("l<*").join(","), "2,3,12,0,1,3,0,4,8,12," + pa.coordinates.join(","))
+
+    r3 = RBA::Region::new
+    r3.insert_polygon_arrays_packed(data)
+    assert_equal(r3.to_s, r.to_s)
+    assert_equal(RBA::PolygonArrays::from_packed(data).polygon(1).to_s, pa.polygon(1).to_s)
+
+    r3 = RBA::Region::new
+    r3.insert_polygon_arrays_packed([ 1, 1, 3, 0, 1, 0, 3, -10, 0, 0, 100, 100, 100 ].pack("l<*"))
+    assert_equal(r3.to_s, "(-10,0;0,100;100,100)")
+
+    begin
+      r3.insert_polygon_arrays_packed(data[0..-5])
+      assert_equal(true, false)
+    rescue => ex
+    end
+
+  end
+
   def test_deep1
 
     # construction/destruction magic ...
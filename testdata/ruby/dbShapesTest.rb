@@ -1514,6 +1514,39 @@ class DBShapes_TestClass < TestBase
 
   end
 
+  # polygon arrays
+  def test_11
+
+    ly = RBA::Layout::new
+    shapes = ly.create_cell("TOP").shapes(ly.layer(1, 0))
+    shapes.insert(RBA::Box::new(0, 0, 100, 200))
+    shapes.insert(RBA::Text::new("T", RBA::Trans::new))
+    shapes.insert(RBA::Path::new([ RBA::Point::new(0, 0), RBA::Point::new(100, 0) ], 20))
+
+    pa = shapes.polygon_arrays(RBA::Shapes::SAll)
+    assert_equal(pa.size, 2)
+    assert_equal(pa.polygon(0).to_s, "(0,0;0,200;100,200;100,0)")
+    assert_equal(pa.polygon(1).to_s, "(0,-10;0,10;100,10;100,-10)")
+
+    pa = shapes.polygon_arrays(RBA::Shapes::SBoxes)
+    assert_equal(pa.size, 1)
+
+    shapes2 = ly.create_cell("C2").shapes(ly.layer(1, 0))
+    shapes2.insert(shapes.polygon_arrays(RBA::Shapes::SAll))
+    assert_equal(shapes2.size, 2)
+    assert_equal(shapes2.each.collect { |s| s.to_s }.join(";"), "polygon (0,0;0,200;100,200;100,0);polygon (0,-10;0,10;100,10;100,-10)")
+
+    # packed form
+    data = shapes.polygon_arrays_packed(RBA::Shapes::SAll)
+    assert_equal(data, shapes.polygon_arrays(RBA::Shapes::SAll).packed)
+    assert_equal(data.unpack("l<3").join(","), "2,2,8")
+
+    shapes3 = ly.create_cell("C3").shapes(ly.layer(1, 0))
+    shapes3.insert_polygon_arrays_packed(data)
+    assert_equal(shapes3.each.collect { |s| s.to_s }.join(";"), "polygon (0,0;0,200;100,200;100,0);polygon (0,-10;0,10;100,10;100,-10)")
+
+  end
+
 end
 
 load("test_epilogue.rb")
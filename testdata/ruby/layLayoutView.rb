@@ -406,6 +406,65 @@ class LAYLayoutView_TestClass < TestBase
 
   end
 
+  def test_4
+
+    # batch image rendering vs. single images
+    lv = RBA::LayoutView::new
+
+    cv = lv.cellview(lv.create_layout(1))
+    ly = cv.layout
+    top = ly.create_cell("TOP")
+    cv.cell = top
+
+    l1 = ly.layer(1, 0)
+    l2 = ly.layer(2, 0)
+    top.shapes(l1).insert(RBA::Box::new(0, 0, 10000, 20000))
+    top.shapes(l2).insert(RBA::Polygon::new([ RBA::Point::new(0, 0), RBA::Point::new(5000, 15000), RBA::Point::new(12000, 3000) ]))
+    lv.add_missing_layers
+    lv.zoom_fit
+
+    targets = [ RBA::DBox::new(0, 0, 10, 10), RBA::DBox::new(2, 3, 9, 14), RBA::DBox::new, RBA::DBox::new(-5, -5, 30, 30) ]
+    files = (0 .. targets.size - 1).collect { |i| File::join($ut_testtmp, "tmp_batch_#{i}.png") }
+    files_au = (0 .. targets.size - 1).collect { |i| File::join($ut_testtmp, "tmp_single_#{i}.png") }
+
+    targets.each_with_index do |t, i|
+      lv.save_image_with_options(files_au[i], 200, 150, 0, 1, 0, t, false)
+    end
+
+    [ 0, 1, 3 ].each do |threads|
+
+      lv.save_images_with_options(files, 200, 150, 0, 1, 0, targets, false, threads)
+
+      files.each_with_index do |f, i|
+        assert_equal(File::size(f) > 0, true)
+        if RBA.constants.member?(:QImage)
+          # NOTE: the files differ in the "Rect" text, so the images are compared
+          assert_equal(RBA::QImage::new(f) == RBA::QImage::new(files_au[i]), true)
+        end
+        File::unlink(f)
+      end
+
+    end
+
+    begin
+      lv.save_images_with_options(files[0 .. 1], 200, 150, 0, 1, 0, targets, false)
+      assert_equal(true, false)
+    rescue => ex
+    end
+
+    if RBA.constants.member?(:QImage)
+
+      images = lv.get_images_with_options(200, 150, 0, 1, 0, targets, true, 2)
+      assert_equal(images.size, targets.size)
+
+      targets.each_with_index do |t, i|
+        assert_equal(images[i] == lv.get_image_with_options(200, 150, 0, 1, 0, t, true), true)
+      end
+
+    end
+
+  end
+
 end
 
 load("test_epilogue.rb")
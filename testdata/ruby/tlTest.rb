@@ -300,6 +300,41 @@ class Tl_TestClass < TestBase
 
   end
 
+  # Profiler
+  def test_5_Profiler
+
+    RBA::Profiler::clear
+    assert_equal(RBA::Profiler::enabled?, false)
+
+    ps = RBA::ProfileScope::new("test", "disabled")
+    assert_equal(ps.enabled?, false)
+    ps.finish
+    assert_equal(RBA::Profiler::count, 0)
+
+    RBA::Profiler::enabled = true
+
+    ps = RBA::ProfileScope::new("test", "op1", 2)
+    assert_equal(ps.enabled?, true)
+    ps.input_count = 17
+    ps.output_count = 42
+    ps.finish
+    assert_equal(ps.enabled?, false)
+    assert_equal(RBA::Profiler::count, 1)
+
+    RBA::Profiler::enabled = false
+
+    assert_equal(RBA::Profiler::to_csv.split("\n")[1] =~ /^"test","op1",.*,2,[^,]*,\d+,\d+,\d+,\d+,17,42$/, 0)
+    assert_equal(RBA::Profiler::to_json =~ /"description": "op1"/ ? true : false, true)
+    assert_equal(RBA::Profiler::summary(1) =~ /\[test\] op1/ ? true : false, true)
+
+    RBA::Profiler::clear
+    assert_equal(RBA::Profiler::count, 0)
+
+    assert_equal(RBA::Timer::memory_size >= 0, true)
+    assert_equal(RBA::Timer::peak_memory_size >= 0, true)
+
+  end
+
 end
 
 load("test_epilogue.rb")